@@ -15,15 +15,18 @@
 #include "../../Source/Core/Audio/BuiltIn/MetronomeSynthAudioPlugin.cpp"
 #include "../../Source/Core/Audio/BuiltIn/MetronomeSynth.cpp"
 #include "../../Source/Core/Audio/Instruments/Instrument.cpp"
+#include "../../Source/Core/Audio/Instruments/InstrumentsMixer.cpp"
 #include "../../Source/Core/Audio/Instruments/OrchestraPit.cpp"
 #include "../../Source/Core/Audio/Instruments/PluginScanner.cpp"
 #include "../../Source/Core/Audio/Instruments/SerializablePluginDescription.cpp"
 #include "../../Source/Core/Audio/Monitoring/AudioMonitor.cpp"
+#include "../../Source/Core/Audio/Monitoring/LatencyMeter.cpp"
 #include "../../Source/Core/Audio/Monitoring/SpectrumAnalyzer.cpp"
 #include "../../Source/Core/Audio/Transport/MidiRecorder.cpp"
 #include "../../Source/Core/Audio/Transport/PlayerThread.cpp"
 #include "../../Source/Core/Audio/Transport/RendererThread.cpp"
 #include "../../Source/Core/Audio/Transport/Transport.cpp"
+#include "../../Source/Core/Audio/Transport/WaveformPeaks.cpp"
 #include "../../Source/Core/Audio/AudioCore.cpp"
 #include "../../Source/Core/Configuration/Resources/Models/Arpeggiator.cpp"
 #include "../../Source/Core/Configuration/Resources/Models/Chord.cpp"
@@ -67,6 +70,7 @@
 #include "../../Source/Core/Midi/Sequences/PianoSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/TimeSignaturesSequence.cpp"
 #include "../../Source/Core/Midi/Sequences/TimeSignaturesAggregator.cpp"
+#include "../../Source/Core/Midi/MidiFileWriter.cpp"
 #include "../../Source/Core/Midi/MidiTrack.cpp"
 #include "../../Source/Core/Network/Requests/BackendRequest.cpp"
 #include "../../Source/Core/Network/Requests/UserConfigSyncThread.cpp"
@@ -133,6 +137,10 @@
 #include "../../Source/Core/Workspace/UserProfile.cpp"
 #include "../../Source/Core/Workspace/Workspace.cpp"
 #include "../../Source/Core/App.cpp"
+#include "../../Source/Core/HeadlessRender.cpp"
+#include "../../Source/Core/Tracing.cpp"
+#include "../../Source/Core/RealtimeChecks.cpp"
+#include "../../Source/Core/ParallelTasks.cpp"
 #include "../../Source/UI/Common/AudioMonitors/SpectrogramAudioMonitorComponent.cpp"
 #include "../../Source/UI/Common/AudioMonitors/WaveformAudioMonitorComponent.cpp"
 #include "../../Source/UI/Common/Origami/Origami.cpp"
@@ -234,6 +242,7 @@
 #include "../../Source/UI/Sequencer/Header/RollHeader.cpp"
 #include "../../Source/UI/Sequencer/Header/Playhead.cpp"
 #include "../../Source/UI/Sequencer/Helpers/CutPointMark.cpp"
+#include "../../Source/UI/Sequencer/Helpers/FrameScheduler.cpp"
 #include "../../Source/UI/Sequencer/Helpers/RollExpandMark.cpp"
 #include "../../Source/UI/Sequencer/Helpers/KnifeToolHelper.cpp"
 #include "../../Source/UI/Sequencer/Helpers/MergingEventsConnector.cpp"
@@ -243,7 +252,6 @@
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationCurveClip/AutomationCurveClipComponent.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationCurveClip/AutomationCurveHelper.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationCurveClip/AutomationCurveEventComponent.cpp"
-#include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationCurveClip/AutomationCurveEventsConnector.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationStepsClip/AutomationStepsClipComponent.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationStepsClip/AutomationStepEventComponent.cpp"
 #include "../../Source/UI/Sequencer/PatternRoll/ClipComponents/AutomationStepsClip/AutomationStepEventsConnector.cpp"
@@ -81,6 +81,16 @@ struct IdentifierHash
     }
 };
 
+struct UuidHash
+{
+    inline HashCode operator()(const juce::Uuid &key) const noexcept
+    {
+        uint64 halves[2];
+        memcpy(halves, key.getRawData(), sizeof(halves));
+        return static_cast<HashCode>(halves[0] ^ halves[1]);
+    }
+};
+
 //===----------------------------------------------------------------------===//
 // Various helpers
 //===----------------------------------------------------------------------===//
@@ -131,7 +141,16 @@ inline float roundf(float x)
             return nullptr; \
         }, this)
 
-#define findDefaultColour(x) LookAndFeel::getDefaultLookAndFeel().findColour(x)
+// see HelioTheme::findPaletteColour
+Colour findThemeColour(int colourId) noexcept;
+#define findDefaultColour(x) findThemeColour(x)
+
+// PhaseLog, and TRACE_ZONE and the playback timing stats
+// compiled out unless built with HELIO_TRACING=1
+#include "Tracing.h"
+
+// REALTIME_SCOPE, compiled out unless built with HELIO_REALTIME_CHECKS=1
+#include "RealtimeChecks.h"
 
 constexpr uint32 fnv1a32val = 0x811c9dc5;
 constexpr uint64 fnv1a32prime = 0x1000193;
@@ -147,6 +166,9 @@ namespace juce
     {
         // declare an additional category for all our tests 
         static const String helio { "Helio" };
+
+        // and one more for the benchmarks, which are not run with the tests
+        static const String benchmarks { "Helio Benchmarks" };
     }
 }
 #endif
@@ -17,6 +17,7 @@
 
 #include "Common.h"
 #include "AudioCore.h"
+#include "MetronomeSynth.h"
 #include "Network.h"
 #include "HelioTheme.h"
 #include "Config.h"
@@ -28,9 +29,21 @@
 #include "SerializablePluginDescription.h"
 
 #include "MainLayout.h"
+#include "Origami.h"
 #include "ScaledComponentProxy.h"
 #include "Workspace.h"
 #include "RootNode.h"
+#include "Benchmark.h"
+#include "HeadlessRender.h"
+#include "FrameScheduler.h"
+
+static Atomic<bool> isAppInForeground = true;
+
+static void setAppInForeground(bool isInForeground)
+{
+    isAppInForeground = isInForeground;
+    FrameScheduler::getInstance().setPaused(!isInForeground);
+}
 
 //===----------------------------------------------------------------------===//
 // Window
@@ -50,8 +63,9 @@ public:
 
 #if PLATFORM_DESKTOP
 
-        //this->setResizeLimits(568, 320, 8192, 8192); // phone size test
-        this->setResizeLimits(1024, 650, 8192, 8192); // production
+        //this->liveResizeConstrainer.setSizeLimits(568, 320, 8192, 8192); // phone size test
+        this->liveResizeConstrainer.setSizeLimits(1024, 650, 8192, 8192); // production
+        this->setConstrainer(&this->liveResizeConstrainer);
 
         const bool hasResizableCorner = !useNativeTitleBar;
         this->setResizable(true, hasResizableCorner);
@@ -141,6 +155,11 @@ private:
         JUCEApplication::getInstance()->systemRequestedQuit();
     }
 
+    void minimisationStateChanged(bool isNowMinimised) override
+    {
+        setAppInForeground(!isNowMinimised);
+    }
+
     void attachOpenGLContext()
     {
         DBG("Attaching OpenGL context.");
@@ -203,6 +222,17 @@ private:
 
     UniquePointer<MainLayout> layout;
     UniquePointer<OpenGLContext> openGLContext;
+
+    // the window's corner and border, and some of the native title bars,
+    // report the resize drags here, and the origamis defer the relayouts
+    class LiveResizeConstrainer final : public ComponentBoundsConstrainer
+    {
+    public:
+        void resizeStart() override { Origami::beginLiveResize(); }
+        void resizeEnd() override { Origami::endLiveResize(); }
+    };
+
+    LiveResizeConstrainer liveResizeConstrainer;
     
     friend class App;
 
@@ -264,6 +294,8 @@ class Config &App::Config() noexcept
 
 class Network &App::Network() noexcept
 {
+    // see the comment in App::initialise
+    jassert(static_cast<App *>(getInstance())->network != nullptr);
     return *static_cast<App *>(getInstance())->network;
 }
 
@@ -306,6 +338,11 @@ bool App::isRunningOnDesktop()
 #endif
 }
 
+bool App::isInForeground() noexcept
+{
+    return isAppInForeground.get();
+}
+
 String App::getDeviceId()
 {
     static String kDeviceId;
@@ -507,21 +544,29 @@ void App::setTitleBarComponent(WeakReference<Component> component)
 
 void App::initialise(const String &commandLine)
 {
+    const auto args = StringArray::fromTokens(commandLine, true);
+
     if (commandLine.isNotEmpty() &&
         DocumentHelpers::getTempSlot(commandLine).existsAsFile())
     {
         this->runMode = RunMode::PluginCheck;
     }
+    else if (HeadlessRender::isRequested(args))
+    {
+        this->runMode = RunMode::Render;
+    }
 
     if (this->runMode == RunMode::Normal)
     {
         DBG("Helio v" + App::getAppReadableVersion());
+        PhaseLog startupLog("Startup");
 
         const auto album = Desktop::rotatedClockwise + Desktop::rotatedAntiClockwise;
         Desktop::getInstance().setOrientationsEnabled(album);
         
         this->config = make<class Config>();
         this->config->initResources();
+        startupLog.endPhase("config");
 
         auto helioTheme = make<HelioTheme>();
         helioTheme->initResources();
@@ -529,6 +574,7 @@ void App::initialise(const String &commandLine)
 
         this->theme = move(helioTheme);
         LookAndFeel::setDefaultLookAndFeel(this->theme.get());
+        startupLog.endPhase("theme");
 
 #if JUCE_UNIT_TESTS
 
@@ -538,8 +584,19 @@ void App::initialise(const String &commandLine)
         // (we don't need a window, workspace and network services though)
         UnitTestRunner runner;
 
+        // the benchmarks are run instead of the tests, if asked to:
+        const bool shouldRunBenchmarks = args.contains("--benchmark");
+        for (const auto &arg : args)
+        {
+            if (arg.startsWith("--benchmark-size="))
+            {
+                Benchmark::setSize(arg.fromFirstOccurrenceOf("=", false, false).getIntValue());
+            }
+        }
+
         // we don't want to run JUCE's unit tests, just the ones in our category:
-        runner.runTestsInCategory(UnitTestCategories::helio,
+        runner.runTestsInCategory(shouldRunBenchmarks ?
+            UnitTestCategories::benchmarks : UnitTestCategories::helio,
             Random::getSystemRandom().nextInt64());
 
         for (int i = 0; i < runner.getNumResults(); ++i)
@@ -572,8 +629,7 @@ void App::initialise(const String &commandLine)
 
         this->window = make<MainWindow>();
         this->window->init(shouldEnableOpenGL, shouldUseNativeTitleBar);
-
-        this->network = make<class Network>(*this->workspace.get());
+        startupLog.endPhase("main window");
 
         this->config->getUiFlags()->addListener(this);
         
@@ -582,9 +638,17 @@ void App::initialise(const String &commandLine)
         // desktop versions will be initialised by InitScreen component.
         App::Workspace().init();
         App::Layout().setVisible(true);
+        startupLog.endPhase("workspace");
 
 #   endif
 
+        // the network services are not needed for the first frame,
+        // so they are created when the message loop is running:
+        MessageManager::callAsync([this]()
+        {
+            this->network = make<class Network>(*this->workspace.get());
+        });
+
 #endif
     }
     else if (this->runMode == RunMode::PluginCheck)
@@ -592,6 +656,28 @@ void App::initialise(const String &commandLine)
         this->checkPlugin(commandLine);
         this->quit();
     }
+    else if (this->runMode == RunMode::Render)
+    {
+        this->config = make<class Config>();
+        this->config->initResources();
+
+        // the project pages are still created, even if never shown
+        auto helioTheme = make<HelioTheme>();
+        helioTheme->initResources();
+        helioTheme->initColours(this->config->getColourSchemes()->getCurrent());
+        this->theme = move(helioTheme);
+        LookAndFeel::setDefaultLookAndFeel(this->theme.get());
+
+        this->workspace = make<class Workspace>();
+        this->workspace->initHeadless();
+
+        this->headlessRender = make<HeadlessRender>(*this->workspace);
+        if (!this->headlessRender->start(args))
+        {
+            this->setApplicationReturnValue(1);
+            this->quit();
+        }
+    }
 }
 
 void App::shutdown()
@@ -623,7 +709,34 @@ void App::shutdown()
         // Clear cache to avoid leak check to fire.
         Icons::clearPrerenderedCache();
         Icons::clearBuiltInImages();
+        MetronomeSynth::clearSharedSounds();
+
+#if HELIO_TRACING
+        Tracing::saveChromeTrace(DocumentHelpers::getConfigSlot("trace.json"));
+#endif
+    }
+    else if (this->runMode == RunMode::Render)
+    {
+        this->headlessRender = nullptr;
+
+        if (this->workspace != nullptr)
+        {
+            this->workspace->shutdown();
+            this->workspace = nullptr;
+        }
+
+        this->theme = nullptr;
+        this->config = nullptr;
+
+        // the temporary folder is not cleaned up here,
+        // since it may be used by the other running instances
+        Icons::clearPrerenderedCache();
+        Icons::clearBuiltInImages();
+        MetronomeSynth::clearSharedSounds();
     }
+
+    // the config and the projects are saved by now
+    DocumentHelpers::shutdownBackgroundSaves();
 }
 
 const String App::getApplicationName()
@@ -632,6 +745,10 @@ const String App::getApplicationName()
     {
         return "Helio Plugin Check";
     }
+    else if (this->runMode == RunMode::Render)
+    {
+        return "Helio Render";
+    }
 
     return "Helio";
 }
@@ -643,7 +760,7 @@ const String App::getApplicationVersion()
 
 bool App::moreThanOneInstanceAllowed()
 {
-    return true; // to be able to check plugins
+    return true; // to be able to check plugins and run renders
 }
 
 void App::anotherInstanceStarted(const String &commandLine)
@@ -665,11 +782,17 @@ void App::systemRequestedQuit()
 
 void App::suspended()
 {
+    setAppInForeground(false);
+
     if (this->workspace != nullptr)
     {
         this->workspace->stopPlaybackForAllProjects();
-        this->workspace->getAudioCore().setCanSleepAfter(0);
+        this->workspace->getAudioCore().setDisconnected();
         this->workspace->autosave();
+#if PLATFORM_MOBILE
+        // the suspended apps are the first ones to be killed
+        this->workspace->releaseMemory();
+#endif
     }
     
 #if JUCE_ANDROID
@@ -679,6 +802,8 @@ void App::suspended()
 
 void App::resumed()
 {
+    setAppInForeground(true);
+
     if (this->workspace != nullptr)
     {
         this->workspace->getAudioCore().setAwake();
@@ -689,6 +814,15 @@ void App::resumed()
 #endif
 }
 
+void App::memoryWarningReceived()
+{
+    DBG("Memory warning received");
+    if (this->workspace != nullptr)
+    {
+        this->workspace->releaseMemory();
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Private
 //===----------------------------------------------------------------------===//
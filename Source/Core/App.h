@@ -64,6 +64,11 @@ public:
     static bool isRunningOnTablet();
     static bool isRunningOnDesktop();
 
+    // false while the app is suspended or the window is minimized,
+    // so that the animations and the visualizers can stop meanwhile;
+    // it is also checked by the visualizers' threads, hence atomic
+    static bool isInForeground() noexcept;
+
     static String getDeviceId();
     static String getAppReadableVersion();
     static String getHumanReadableDate(const Time &date);
@@ -99,6 +104,7 @@ private:
     void systemRequestedQuit() override;
     void suspended() override;
     void resumed() override;
+    void memoryWarningReceived() override;
 
 private:
 
@@ -109,6 +115,7 @@ private:
     UniquePointer<class Workspace> workspace;
     UniquePointer<class MainWindow> window;
     UniquePointer<class Network> network;
+    UniquePointer<class HeadlessRender> headlessRender;
 
 private:
 
@@ -127,7 +134,8 @@ private:
     enum class RunMode
     {
         Normal,
-        PluginCheck
+        PluginCheck,
+        Render
     };
 
     RunMode runMode = RunMode::Normal;
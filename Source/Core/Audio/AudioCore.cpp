@@ -23,6 +23,8 @@
 #include "MetronomeSynthAudioPlugin.h"
 #include "SerializationKeys.h"
 #include "AudioMonitor.h"
+#include "LatencyMeter.h"
+#include "InstrumentsMixer.h"
 
 void AudioCore::initAudioFormats(AudioPluginFormatManager &formatManager)
 {
@@ -31,40 +33,151 @@ void AudioCore::initAudioFormats(AudioPluginFormatManager &formatManager)
     formatManager.addFormat(new BuiltInSynthsPluginFormat());
 }
 
+class AudioCore::LatencyCompensationTimer final : private Timer
+{
+public:
+
+    explicit LatencyCompensationTimer(AudioCore &audioCore) : audioCore(audioCore)
+    {
+        this->startTimer(LatencyCompensationTimer::intervalMs);
+    }
+
+private:
+
+    static constexpr auto intervalMs = 500;
+
+    void timerCallback() override
+    {
+        this->audioCore.updateLatencyCompensation();
+        this->audioCore.updateBufferSizeStats(LatencyCompensationTimer::intervalMs);
+    }
+
+    AudioCore &audioCore;
+};
+
+class AudioCore::DeviceSetupThread final : public Thread
+{
+public:
+
+    DeviceSetupThread(AudioCore &audioCore, const SerializedData &settings) :
+        Thread("DeviceSetupThread"),
+        audioCore(audioCore),
+        settings(settings.createCopy()) {}
+
+    const SerializedData &getSettings() const noexcept
+    {
+        return this->settings;
+    }
+
+    bool hasOpenedSavedDevice() const noexcept
+    {
+        return this->openedSavedDevice.get();
+    }
+
+private:
+
+    void run() override
+    {
+        this->openedSavedDevice = this->audioCore.openSavedAudioDevice(this->settings);
+        if (!this->openedSavedDevice.get())
+        {
+            this->audioCore.openDefaultAudioDevice();
+        }
+
+        this->audioCore.triggerAsyncUpdate();
+    }
+
+    AudioCore &audioCore;
+    const SerializedData settings;
+    Atomic<bool> openedSavedDevice = false;
+};
+
 AudioCore::AudioCore()
 {
     this->audioMonitor = make<AudioMonitor>();
     this->deviceManager.addAudioCallback(this->audioMonitor.get());
+    this->instrumentsMixer = make<InstrumentsMixer>();
+    this->deviceManager.addAudioCallback(this->instrumentsMixer.get());
     AudioCore::initAudioFormats(this->formatManager);
+    this->latencyCompensationTimer = make<LatencyCompensationTimer>(*this);
 }
 
 AudioCore::~AudioCore()
 {
+    if (this->deviceSetupThread != nullptr)
+    {
+        this->deviceSetupThread->waitForThreadToExit(-1);
+        this->deviceSetupThread = nullptr;
+    }
+
+    this->latencyCompensationTimer = nullptr;
+
+    if (this->latencyMeter != nullptr)
+    {
+        this->deviceManager.removeAudioCallback(this->latencyMeter.get());
+        this->latencyMeter = nullptr;
+    }
+
     this->deviceManager.removeAudioCallback(this->audioMonitor.get());
     this->audioMonitor = nullptr;
+
+    for (auto *instrument : this->instruments)
+    {
+        this->removeInstrumentFromAudioDevice(instrument);
+    }
+
+    this->deviceManager.removeAudioCallback(this->instrumentsMixer.get());
+    this->instrumentsMixer = nullptr;
     this->deviceManager.closeAudioDevice();
+
+    this->setMidiOutputDevice({});
 }
 
 bool AudioCore::canSleepNow() noexcept
 {
-    // SleepTimer is used to disconnect all callbacks after some delay (i.e. sleep mode),
+    // SleepTimer is used to put all callbacks to sleep after some delay,
     // but first we make sure the device is not making any sound, otherwise we'll wait more:
     return this->deviceManager.getOutputLevelGetter()->getCurrentLevel() == 0.0;
 }
 
+// the callbacks and the device stay connected while sleeping, and
+// only skip processing, so that waking up takes no reconnection,
+// and the first note after a long pause plays without a delay
 void AudioCore::sleepNow()
 {
-    DBG("Audio core sleeps");
+    if (!this->isSleeping.get())
+    {
+        DBG("Audio core sleeps");
+        this->isSleeping = true;
+        for (auto *instrument : this->instruments)
+        {
+            instrument->getProcessorPlayer().setSleeping(true);
+        }
+    }
+}
+
+void AudioCore::disconnectNow()
+{
+    this->sleepNow();
     this->disconnectAllAudioCallbacks();
 }
 
 void AudioCore::awakeNow()
 {
     this->reconnectAllAudioCallbacks();
+
+    // the instruments may have been woken up by their MIDI input
+    this->isSleeping = false;
+    for (auto *instrument : this->instruments)
+    {
+        instrument->getProcessorPlayer().setSleeping(false);
+    }
 }
 
 void AudioCore::disconnectAllAudioCallbacks()
 {
+    this->waitForDeviceSetup();
+
     if (!this->isMuted.get())
     {
         this->isMuted = true;
@@ -81,6 +194,8 @@ void AudioCore::disconnectAllAudioCallbacks()
 
 void AudioCore::reconnectAllAudioCallbacks()
 {
+    this->waitForDeviceSetup();
+
     if (this->isMuted.get())
     {
         for (auto *instrument : this->instruments)
@@ -96,9 +211,155 @@ void AudioCore::reconnectAllAudioCallbacks()
 
 AudioDeviceManager &AudioCore::getDevice() noexcept
 {
+    this->waitForDeviceSetup();
     return this->deviceManager;
 }
 
+//===----------------------------------------------------------------------===//
+// Latency
+//===----------------------------------------------------------------------===//
+
+double AudioCore::getOutputLatencyMs()
+{
+    this->waitForDeviceSetup();
+
+    auto *device = this->deviceManager.getCurrentAudioDevice();
+    if (device == nullptr || device->getCurrentSampleRate() <= 0.0)
+    {
+        return 0.0;
+    }
+
+    this->resetStatsIfDeviceChanged(*device);
+
+    const auto reportedMs = device->getOutputLatencyInSamples() * 1000.0 / device->getCurrentSampleRate();
+    return jmax(0.0, reportedMs + this->latencyCorrectionMs / 2.0);
+}
+
+void AudioCore::measureLatency(Function<void(double roundTripMs)> callback)
+{
+    this->waitForDeviceSetup();
+
+    auto *device = this->deviceManager.getCurrentAudioDevice();
+    if (device == nullptr || this->latencyMeter != nullptr ||
+        device->getActiveInputChannels().isZero())
+    {
+        callback(-1.0);
+        return;
+    }
+
+    const auto sampleRate = device->getCurrentSampleRate();
+    const auto reportedSamples = device->getInputLatencyInSamples() + device->getOutputLatencyInSamples();
+
+    WeakReference<AudioCore> weakThis(this);
+    this->latencyMeter = make<LatencyMeter>([weakThis, sampleRate, reportedSamples, callback](int roundTripSamples)
+    {
+        if (weakThis == nullptr)
+        {
+            return;
+        }
+
+        // the meter is still running this callback, so it's deleted later
+        weakThis->deviceManager.removeAudioCallback(weakThis->latencyMeter.get());
+        MessageManager::callAsync([weakThis]()
+        {
+            if (weakThis != nullptr)
+            {
+                weakThis->latencyMeter = nullptr;
+            }
+        });
+
+        auto *currentDevice = weakThis->deviceManager.getCurrentAudioDevice();
+        if (roundTripSamples < 0 || currentDevice == nullptr)
+        {
+            callback(-1.0);
+            return;
+        }
+
+        weakThis->resetStatsIfDeviceChanged(*currentDevice);
+        weakThis->latencyCorrectionMs = (roundTripSamples - reportedSamples) * 1000.0 / sampleRate;
+        callback(roundTripSamples * 1000.0 / sampleRate);
+    });
+
+    this->deviceManager.addAudioCallback(this->latencyMeter.get());
+}
+
+bool AudioCore::isMeasuringLatency() const noexcept
+{
+    return this->latencyMeter != nullptr;
+}
+
+int AudioCore::getSuggestedBufferSize() const
+{
+    int result = 0;
+    for (const auto bufferSize : this->stableBufferSizes)
+    {
+        result = (result == 0) ? bufferSize : jmin(result, bufferSize);
+    }
+
+    return result;
+}
+
+// the buffer size only counts as stable after it has been processing
+// for a while, i.e. not sleeping, with no overruns of the instruments'
+// callbacks (see Instrument::AudioCallback::getLoad), and no xruns
+// reported by the device; any overrun makes it unstable again
+void AudioCore::updateBufferSizeStats(int elapsedMs)
+{
+    if (this->deviceSetupThread != nullptr)
+    {
+        return;
+    }
+
+    auto *device = this->deviceManager.getCurrentAudioDevice();
+    if (device == nullptr || !device->isPlaying() || this->isSleeping.get())
+    {
+        return;
+    }
+
+    this->resetStatsIfDeviceChanged(*device);
+    const auto bufferSize = device->getCurrentBufferSizeSamples();
+
+    int numOverruns = jmax(0, device->getXRunCount());
+    for (const auto *instrument : this->instruments)
+    {
+        numOverruns += instrument->getProcessorPlayer().getLoad().numOverruns;
+    }
+
+    // the counters might have been reset, or the device restarted
+    if (bufferSize != this->observedBufferSize || numOverruns < this->observedNumOverruns)
+    {
+        this->observedBufferSize = bufferSize;
+        this->observedNumOverruns = numOverruns;
+        this->observedStableMs = 0;
+        return;
+    }
+
+    if (numOverruns > this->observedNumOverruns)
+    {
+        this->observedNumOverruns = numOverruns;
+        this->observedStableMs = 0;
+        this->stableBufferSizes.removeFirstMatchingValue(bufferSize);
+        return;
+    }
+
+    this->observedStableMs += elapsedMs;
+    if (this->observedStableMs >= AudioCore::stableBufferSizeTimeoutMs)
+    {
+        this->stableBufferSizes.addIfNotAlreadyThere(bufferSize);
+    }
+}
+
+void AudioCore::resetStatsIfDeviceChanged(const AudioIODevice &device)
+{
+    if (this->statsDeviceName != device.getName())
+    {
+        this->statsDeviceName = device.getName();
+        this->latencyCorrectionMs = 0.0;
+        this->stableBufferSizes.clearQuick();
+        this->observedBufferSize = 0;
+    }
+}
+
 AudioPluginFormatManager &AudioCore::getFormatManager() noexcept
 {
     return this->formatManager;
@@ -126,6 +387,7 @@ void AudioCore::addInstrument(const PluginDescription &pluginDescription,
             {
                 callback(instrument);
             }
+            this->isInstrumentsIndexOutdated = true;
             this->broadcastAddInstrument(instrument);
             DBG("Loaded " + instrument->getName());
         });
@@ -139,6 +401,7 @@ void AudioCore::removeInstrument(Instrument *instrument)
     this->removeInstrumentFromMidiDevice(instrument);
 
     this->instruments.removeObject(instrument, true);
+    this->isInstrumentsIndexOutdated = true;
 
     this->broadcastPostRemoveInstrument();
 }
@@ -192,27 +455,179 @@ void AudioCore::setFilteringMidiInput(bool isOn) noexcept
     this->isReadjustingMidiInput = isOn;
 }
 
+//===----------------------------------------------------------------------===//
+// Playback scheduling
+//===----------------------------------------------------------------------===//
+
+bool AudioCore::isSampleAccuratePlaybackEnabled() const noexcept
+{
+    return this->isSampleAccuratePlayback.get();
+}
+
+void AudioCore::setSampleAccuratePlaybackEnabled(bool isOn) noexcept
+{
+    this->isSampleAccuratePlayback = isOn;
+}
+
+//===----------------------------------------------------------------------===//
+// MIDI output
+//===----------------------------------------------------------------------===//
+
+void AudioCore::setMidiOutputDevice(const String &deviceId)
+{
+    if (deviceId == this->getMidiOutputDeviceId())
+    {
+        return;
+    }
+
+    MidiOutputDevice::Ptr newOutput;
+    if (deviceId.isNotEmpty())
+    {
+        if (auto output = MidiOutput::openDevice(deviceId))
+        {
+            newOutput = new MidiOutputDevice(move(output));
+        }
+        else
+        {
+            DBG("Failed to open MIDI output " + deviceId);
+        }
+    }
+
+    // the old device is closed when the running playback releases it
+    const SpinLock::ScopedLockType lock(this->midiOutputLock);
+    std::swap(this->midiOutput, newOutput);
+}
+
+String AudioCore::getMidiOutputDeviceId() const
+{
+    const auto output = this->getMidiOutput();
+    return output != nullptr ? output->getOutput().getIdentifier() : String();
+}
+
+AudioCore::MidiOutputDevice::Ptr AudioCore::getMidiOutput() const
+{
+    const SpinLock::ScopedLockType lock(this->midiOutputLock);
+    return this->midiOutput;
+}
+
+bool AudioCore::isParallelProcessingEnabled() const noexcept
+{
+    return this->isParallelProcessing.get();
+}
+
+void AudioCore::setParallelProcessingEnabled(bool isOn)
+{
+    if (this->isParallelProcessing.get() == isOn)
+    {
+        return;
+    }
+
+    // move all instruments' callbacks between the device and the mixer
+    const bool wasMuted = this->isMuted.get();
+    this->disconnectAllAudioCallbacks();
+    this->isParallelProcessing = isOn;
+
+    if (!wasMuted)
+    {
+        this->reconnectAllAudioCallbacks();
+    }
+}
+
+bool AudioCore::isIdleSuspensionEnabled() const noexcept
+{
+    return this->isIdleSuspension.get();
+}
+
+void AudioCore::setIdleSuspensionEnabled(bool isOn)
+{
+    this->isIdleSuspension = isOn;
+    this->updateIdleTimeouts();
+}
+
+void AudioCore::setInstrumentsInUse(const Array<Instrument *> &instruments)
+{
+    this->instrumentsInUse.clearQuick();
+    for (auto *instrument : instruments)
+    {
+        this->instrumentsInUse.add(instrument);
+    }
+
+    this->updateIdleTimeouts();
+}
+
+void AudioCore::updateIdleTimeouts()
+{
+    for (auto *instrument : this->instruments)
+    {
+        bool isInUse = false;
+        for (const auto &usedInstrument : this->instrumentsInUse)
+        {
+            isInUse = isInUse || usedInstrument == instrument;
+        }
+
+        const auto timeout = !this->isIdleSuspension.get() ? -1.f :
+            (isInUse ? AudioCore::idleTimeoutSeconds : AudioCore::unusedIdleTimeoutSeconds);
+
+        instrument->getProcessorPlayer().setIdleTimeout(timeout);
+    }
+}
+
+void AudioCore::updateLatencyCompensation()
+{
+    // frozen instruments play their pre-rendered audio,
+    // which the renderer has already compensated
+    const auto getLatency = [](Instrument *instrument)
+    {
+        return instrument->getProcessorPlayer().isFrozen() ?
+            0 : instrument->getLatencySamples();
+    };
+
+    int maxLatency = 0;
+    for (auto *instrument : this->instruments)
+    {
+        maxLatency = jmax(maxLatency, getLatency(instrument));
+    }
+
+    for (auto *instrument : this->instruments)
+    {
+        instrument->getProcessorPlayer().setLatencyCompensation(maxLatency - getLatency(instrument));
+    }
+}
+
 void AudioCore::addInstrumentToMidiDevice(Instrument *instrument,
     int periodSize, Scale::Ptr chromaticMapping)
 {
-    this->addFilteredMidiInputCallback(
-        &instrument->getProcessorPlayer().getMidiMessageCollector(),
+    this->addFilteredMidiInputCallback(&instrument->getProcessorPlayer(),
         periodSize, chromaticMapping);
 }
 
 void AudioCore::removeInstrumentFromMidiDevice(Instrument *instrument)
 {
-    this->removeFilteredMidiInputCallback(
-        &instrument->getProcessorPlayer().getMidiMessageCollector());
+    this->removeFilteredMidiInputCallback(&instrument->getProcessorPlayer());
 }
 
 void AudioCore::addInstrumentToAudioDevice(Instrument *instrument)
 {
-    this->deviceManager.addAudioCallback(&instrument->getProcessorPlayer());
+    this->waitForDeviceSetup();
+
+    instrument->getProcessorPlayer().setSleeping(this->isSleeping.get());
+
+    if (this->isParallelProcessing.get())
+    {
+        this->instrumentsMixer->addCallback(&instrument->getProcessorPlayer());
+    }
+    else
+    {
+        this->deviceManager.addAudioCallback(&instrument->getProcessorPlayer());
+    }
 }
 
 void AudioCore::removeInstrumentFromAudioDevice(Instrument *instrument)
 {
+    this->waitForDeviceSetup();
+
+    // removing the callback which is not there is fine for both
+    this->instrumentsMixer->removeCallback(&instrument->getProcessorPlayer());
     this->deviceManager.removeAudioCallback(&instrument->getProcessorPlayer());
 }
 
@@ -283,6 +698,28 @@ Array<Instrument *> AudioCore::getInstrumentsExceptInternal() const
 
 Instrument *AudioCore::findInstrumentById(const String &id) const
 {
+    this->rebuildInstrumentsIndexIfNeeded();
+
+    if (this->instrumentIdLength > 0 && id.length() >= this->instrumentIdLength)
+    {
+        const auto foundById = this->instrumentsByIdCache.find(id.substring(0, this->instrumentIdLength));
+        if (foundById != this->instrumentsByIdCache.end() && foundById->second != nullptr)
+        {
+            return foundById->second.get();
+        }
+
+        const auto hash = id.substring(this->instrumentIdLength);
+        const auto foundByHash = this->instrumentsByHashCache.find(hash);
+        if (foundByHash != this->instrumentsByHashCache.end() &&
+            foundByHash->second != nullptr &&
+            foundByHash->second->getInstrumentHash() == hash)
+        {
+            return foundByHash->second.get();
+        }
+    }
+
+    // the slow path for the ids in some other format, or the changed hashes:
+
     // check by ids
     for (int i = 0; i < this->instruments.size(); ++i)
     {
@@ -308,6 +745,35 @@ Instrument *AudioCore::findInstrumentById(const String &id) const
     return nullptr;
 }
 
+void AudioCore::rebuildInstrumentsIndexIfNeeded() const
+{
+    if (!this->isInstrumentsIndexOutdated)
+    {
+        return;
+    }
+
+    this->instrumentsByIdCache.clear();
+    this->instrumentsByHashCache.clear();
+    this->instrumentIdLength = 0;
+
+    for (auto *instrument : this->instruments)
+    {
+        const auto instrumentId = instrument->getInstrumentId();
+        jassert(this->instrumentIdLength == 0 || this->instrumentIdLength == instrumentId.length());
+        this->instrumentIdLength = instrumentId.length();
+        this->instrumentsByIdCache[instrumentId] = instrument;
+
+        // same as the linear search, the first one wins for the instruments with equal hashes:
+        const auto hash = instrument->getInstrumentHash();
+        if (hash.isNotEmpty() && !this->instrumentsByHashCache.contains(hash))
+        {
+            this->instrumentsByHashCache[hash] = instrument;
+        }
+    }
+
+    this->isInstrumentsIndexOutdated = false;
+}
+
 Instrument *AudioCore::getDefaultInstrument() const noexcept
 {
     jassert(this->defaultInstrument != nullptr || !this->instruments.isEmpty());
@@ -363,8 +829,12 @@ void AudioCore::initBuiltInInstrumentsIfNeeded()
 
 bool AudioCore::autodetectAudioDeviceSetup()
 {
-    //DBG("AudioCore::autodetectDeviceSetup");
-    
+    this->waitForDeviceSetup();
+    return this->openDefaultAudioDevice();
+}
+
+bool AudioCore::openDefaultAudioDevice()
+{
     // requesting 0 inputs and only 2 outputs because of freaking alsa
     this->deviceManager.initialise(0, 2, nullptr, true);
 
@@ -399,7 +869,7 @@ bool AudioCore::autodetectAudioDeviceSetup()
 
 bool AudioCore::autodetectMidiDeviceSetup()
 {
-    //DBG("AudioCore::autodetectMidiDeviceSetup");
+    this->waitForDeviceSetup();
 
     int numEnabledDevices = 0;
     const auto allDevices = MidiInput::getAvailableDevices();
@@ -440,6 +910,17 @@ SerializedData AudioCore::serializeDeviceManager() const
 {
     using namespace Serialization;
 
+    // the device is still being opened, so its settings are the saved ones
+    if (this->deviceSetupThread != nullptr)
+    {
+        auto tree = this->deviceSetupThread->getSettings().createCopy();
+        tree.setProperty(Audio::midiInputReadjusting, this->isReadjustingMidiInput.get());
+        tree.setProperty(Audio::sampleAccuratePlayback, this->isSampleAccuratePlayback.get());
+        tree.setProperty(Audio::parallelProcessing, this->isParallelProcessing.get());
+        tree.setProperty(Audio::idleSuspension, this->isIdleSuspension.get());
+        return tree;
+    }
+
     SerializedData tree(Audio::audioDevice);
     AudioDeviceManager::AudioDeviceSetup currentSetup;
     this->deviceManager.getAudioDeviceSetup(currentSetup);
@@ -488,10 +969,35 @@ SerializedData AudioCore::serializeDeviceManager() const
     tree.setProperty(Audio::midiInputReadjusting,
         this->isReadjustingMidiInput.get());
 
-    if (auto *midiOutput = this->deviceManager.getDefaultMidiOutput())
+    tree.setProperty(Audio::sampleAccuratePlayback,
+        this->isSampleAccuratePlayback.get());
+
+    tree.setProperty(Audio::parallelProcessing,
+        this->isParallelProcessing.get());
+
+    tree.setProperty(Audio::idleSuspension,
+        this->isIdleSuspension.get());
+
+    if (this->latencyCorrectionMs != 0.0)
+    {
+        tree.setProperty(Audio::latencyCorrection, this->latencyCorrectionMs);
+    }
+
+    if (!this->stableBufferSizes.isEmpty())
+    {
+        StringArray stableBufferSizes;
+        for (const auto bufferSize : this->stableBufferSizes)
+        {
+            stableBufferSizes.add(String(bufferSize));
+        }
+
+        tree.setProperty(Audio::stableBufferSizes, stableBufferSizes.joinIntoString(" "));
+    }
+
+    if (const auto midiOutput = this->getMidiOutput())
     {
-        tree.setProperty(Audio::midiOutputName, midiOutput->getName());
-        tree.setProperty(Audio::midiOutputId, midiOutput->getIdentifier());
+        tree.setProperty(Audio::midiOutputName, midiOutput->getOutput().getName());
+        tree.setProperty(Audio::midiOutputId, midiOutput->getOutput().getIdentifier());
     }
 
     return tree;
@@ -511,6 +1017,51 @@ void AudioCore::deserializeDeviceManager(const SerializedData &tree)
         return;
     }
 
+    this->waitForDeviceSetup();
+    this->deviceSetupThread = make<DeviceSetupThread>(*this, root);
+    this->deviceSetupThread->startThread();
+}
+
+void AudioCore::deserializeProcessingSettings(const SerializedData &tree)
+{
+    using namespace Serialization;
+
+    const auto root = tree.hasType(Audio::audioDevice) ?
+        tree : tree.getChildWithName(Audio::audioDevice);
+
+    if (!root.isValid())
+    {
+        return;
+    }
+
+    this->isReadjustingMidiInput = root.getProperty(Audio::midiInputReadjusting,
+        this->isReadjustingMidiInput.get());
+
+    this->isSampleAccuratePlayback = root.getProperty(Audio::sampleAccuratePlayback,
+        this->isSampleAccuratePlayback.get());
+
+    this->setParallelProcessingEnabled(root.getProperty(Audio::parallelProcessing,
+        this->isParallelProcessing.get()));
+
+    this->setIdleSuspensionEnabled(root.getProperty(Audio::idleSuspension,
+        this->isIdleSuspension.get()));
+
+    this->statsDeviceName = root.getProperty(Audio::audioOutputDeviceName);
+    this->latencyCorrectionMs = root.getProperty(Audio::latencyCorrection, 0.0);
+
+    this->stableBufferSizes.clearQuick();
+    const auto stableBufferSizes = StringArray::fromTokens(
+        root.getProperty(Audio::stableBufferSizes).toString(), false);
+    for (const auto &bufferSize : stableBufferSizes)
+    {
+        this->stableBufferSizes.addIfNotAlreadyThere(bufferSize.getIntValue());
+    }
+}
+
+bool AudioCore::openSavedAudioDevice(const SerializedData &root)
+{
+    using namespace Serialization;
+
     // A hack: this will call scanDevicesIfNeeded():
     const auto &availableDeviceTypes = this->deviceManager.getAvailableDeviceTypes();
 
@@ -536,9 +1087,7 @@ void AudioCore::deserializeDeviceManager(const SerializedData &tree)
 
     if (!settingsSeemValid)
     {
-        this->autodetectAudioDeviceSetup();
-        this->autodetectMidiDeviceSetup();
-        return;
+        return false;
     }
 
     this->deviceManager.setCurrentAudioDeviceType(currentDeviceType, true);
@@ -553,19 +1102,16 @@ void AudioCore::deserializeDeviceManager(const SerializedData &tree)
     setup.useDefaultOutputChannels = !root.hasProperty(Audio::audioDeviceOutputChannels);
 
     const auto initError = this->deviceManager.setAudioDeviceSetup(setup, true);
-    if (initError.isNotEmpty())
-    {
-        this->autodetectAudioDeviceSetup();
-        this->autodetectMidiDeviceSetup();
-        return;
-    }
+    return initError.isEmpty();
+}
+
+void AudioCore::deserializeMidiDevices(const SerializedData &root)
+{
+    using namespace Serialization;
 
     const auto midiInputId = root.getProperty(Audio::midiInputId).toString();
     const auto midiInputName = root.getProperty(Audio::midiInputName).toString();
 
-    this->isReadjustingMidiInput = root.getProperty(Audio::midiInputReadjusting,
-        this->isReadjustingMidiInput.get());
-    
     // first, try to match by device id; if failed, search by name
     bool hasFoundMidiInById = false;
     const auto allMidiInputs = MidiInput::getAvailableDevices();
@@ -602,7 +1148,7 @@ void AudioCore::deserializeDeviceManager(const SerializedData &tree)
         {
             if (midiOut.identifier == midiOutputId)
             {
-                this->deviceManager.setDefaultMidiOutputDevice(midiOut.identifier);
+                this->setMidiOutputDevice(midiOut.identifier);
                 hasFoundMidiOutById = true;
                 break;
             }
@@ -615,13 +1161,46 @@ void AudioCore::deserializeDeviceManager(const SerializedData &tree)
         {
             if (midiOut.name == midiOutputName)
             {
-                this->deviceManager.setDefaultMidiOutputDevice(midiOut.identifier);
+                this->setMidiOutputDevice(midiOut.identifier);
                 break;
             }
         }
     }
 }
 
+void AudioCore::waitForDeviceSetup()
+{
+    if (this->deviceSetupThread == nullptr)
+    {
+        return;
+    }
+
+    // at worst, this blocks for as long as opening the device synchronously
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+    this->deviceSetupThread->waitForThreadToExit(-1);
+    this->cancelPendingUpdate();
+
+    const auto openedSavedDevice = this->deviceSetupThread->hasOpenedSavedDevice();
+    const auto settings = this->deviceSetupThread->getSettings();
+    this->deviceSetupThread = nullptr;
+
+    // the MIDI devices are quick to open, and they are restored
+    // on the message thread, since they are connected to the instruments
+    if (openedSavedDevice)
+    {
+        this->deserializeMidiDevices(settings);
+    }
+    else
+    {
+        this->autodetectMidiDeviceSetup();
+    }
+}
+
+void AudioCore::handleAsyncUpdate()
+{
+    this->waitForDeviceSetup();
+}
+
 //===----------------------------------------------------------------------===//
 // Serializable
 //===----------------------------------------------------------------------===//
@@ -663,7 +1242,7 @@ void AudioCore::deserialize(const SerializedData &data)
         return;
     }
 
-    this->deserializeDeviceManager(root);
+    this->deserializeProcessingSettings(root);
 
     const auto orchestra = root.getChildWithName(Audio::orchestra);
     if (orchestra.isValid())
@@ -695,6 +1274,7 @@ void AudioCore::deserialize(const SerializedData &data)
                 }
 
                 this->instruments.add(instrument.release());
+                this->isInstrumentsIndexOutdated = true;
                 this->broadcastAddInstrument(this->instruments.getLast());
             }
         }
@@ -702,6 +1282,10 @@ void AudioCore::deserialize(const SerializedData &data)
 
     // add the required built-in instruments if they haven't been found already
     this->initBuiltInInstrumentsIfNeeded();
+
+    // the instruments are connected by now, so they will
+    // be prepared to play as soon as the device is opened
+    this->deserializeDeviceManager(root);
 }
 
 void AudioCore::reset()
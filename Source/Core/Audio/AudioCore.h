@@ -18,6 +18,8 @@
 #pragma once
 
 class AudioMonitor;
+class LatencyMeter;
+class InstrumentsMixer;
 
 #include "Instrument.h"
 #include "OrchestraPit.h"
@@ -51,10 +53,19 @@ public:
         this->awakeNow();
     }
 
+    // unlike sleeping, which is cheap to wake up from, also disconnects
+    // everything, e.g. while the renderer is using the instruments
+    void setDisconnected()
+    {
+        this->stopTimer();
+        this->disconnectNow();
+    }
+
 protected:
 
     virtual bool canSleepNow() = 0;
     virtual void sleepNow() = 0;
+    virtual void disconnectNow() = 0;
     virtual void awakeNow() = 0;
 
 private:
@@ -73,7 +84,8 @@ class AudioCore final :
     public Serializable,
     public ChangeBroadcaster,
     public OrchestraPit,
-    public SleepTimer
+    public SleepTimer,
+    private AsyncUpdater
 {
 public:
 
@@ -118,6 +130,24 @@ public:
     AudioPluginFormatManager &getFormatManager() noexcept;
     AudioMonitor *getMonitor() const noexcept;
 
+    //===------------------------------------------------------------------===//
+    // Latency
+    //===------------------------------------------------------------------===//
+
+    // the delay between processing a block and hearing it, as reported
+    // by the driver, plus the half of what the loopback measurement has
+    // found unreported, assuming it's split evenly between input and output
+    double getOutputLatencyMs();
+
+    // needs a cable from an output to an input, see LatencyMeter;
+    // the callback gets the measured round trip, or a negative value
+    void measureLatency(Function<void(double roundTripMs)> callback);
+    bool isMeasuringLatency() const noexcept;
+
+    // the smallest buffer size, which has been running for a while
+    // with no instrument overruns and no device xruns reported, or 0
+    int getSuggestedBufferSize() const;
+
     //===------------------------------------------------------------------===//
     // MIDI input filtering
     //===------------------------------------------------------------------===//
@@ -128,6 +158,71 @@ public:
     bool isFilteringMidiInput() const noexcept;
     void setFilteringMidiInput(bool isOn) noexcept;
 
+    //===------------------------------------------------------------------===//
+    // Playback scheduling
+    //===------------------------------------------------------------------===//
+
+    // when enabled, the player schedules events at exact sample
+    // positions of the instruments' audio callbacks, otherwise
+    // it sends them at the moment its thread wakes up
+    bool isSampleAccuratePlaybackEnabled() const noexcept;
+    void setSampleAccuratePlaybackEnabled(bool isOn) noexcept;
+
+    // when enabled, the instruments are processed in parallel by the
+    // single mixing audio callback, see InstrumentsMixer, otherwise
+    // each of them is the device callback, processed one after another
+    bool isParallelProcessingEnabled() const noexcept;
+    void setParallelProcessingEnabled(bool isOn);
+
+    // lines up the instruments' outputs by delaying the ones with less
+    // latency than the slowest one; this is also done periodically,
+    // since plugins may change their latencies at any time
+    void updateLatencyCompensation();
+
+    // the instruments which are silent for a while, and receive no messages
+    // or audio input, skip processing until they do, see Instrument::AudioCallback;
+    // the ones not used by any track of the active project are suspended sooner
+    bool isIdleSuspensionEnabled() const noexcept;
+    void setIdleSuspensionEnabled(bool isOn);
+    void setInstrumentsInUse(const Array<Instrument *> &instruments);
+
+    //===------------------------------------------------------------------===//
+    // MIDI output
+    //===------------------------------------------------------------------===//
+
+    // The hardware output is not the device manager's default one, since
+    // the player thread sends it the events of the instruments routed to
+    // the MIDI output node (see Instrument::isRoutedToMidiOutput) ahead of
+    // time with the exact timestamps, and the output's own thread sends
+    // them out when they are due, so that the external gear doesn't depend
+    // on the audio block size; it is reference-counted, so that changing
+    // the device in the settings never pulls it out from under the player
+    class MidiOutputDevice final : public ReferenceCountedObject
+    {
+    public:
+
+        using Ptr = ReferenceCountedObjectPtr<MidiOutputDevice>;
+
+        explicit MidiOutputDevice(UniquePointer<MidiOutput> output) :
+            output(move(output))
+        {
+            this->output->startBackgroundThread();
+        }
+
+        MidiOutput &getOutput() noexcept { return *this->output; }
+
+    private:
+
+        UniquePointer<MidiOutput> output;
+
+        JUCE_DECLARE_NON_COPYABLE(MidiOutputDevice)
+    };
+
+    // an empty id closes the output
+    void setMidiOutputDevice(const String &deviceId);
+    String getMidiOutputDeviceId() const;
+    MidiOutputDevice::Ptr getMidiOutput() const;
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -173,6 +268,7 @@ private:
 
     bool canSleepNow() noexcept override;
     void sleepNow() override;
+    void disconnectNow() override;
     void awakeNow() override;
     void disconnectAllAudioCallbacks();
     void reconnectAllAudioCallbacks();
@@ -186,18 +282,64 @@ private:
 
     SerializedData serializeDeviceManager() const;
     void deserializeDeviceManager(const SerializedData &tree);
+    void deserializeProcessingSettings(const SerializedData &tree);
+    void deserializeMidiDevices(const SerializedData &tree);
+
+    // probing and opening the audio devices may take seconds, so at the
+    // workspace load, the device is opened in a background thread after
+    // the instruments are connected; meanwhile, anything touching the
+    // device manager on the message thread waits for that to finish
+    class DeviceSetupThread;
+    UniquePointer<DeviceSetupThread> deviceSetupThread;
+    void waitForDeviceSetup();
+    void handleAsyncUpdate() override;
+
+    // these two may be called from the device setup thread
+    bool openSavedAudioDevice(const SerializedData &tree);
+    bool openDefaultAudioDevice();
 
     OwnedArray<Instrument> instruments;
 
+    // tracks refer to instruments by id and hash (see Instrument::getIdAndHash),
+    // so findInstrumentById first tries exact lookups by these parts; instruments'
+    // hashes may change when editing their graphs, so found ones are re-checked:
+    mutable bool isInstrumentsIndexOutdated = true;
+    mutable int instrumentIdLength = 0;
+    mutable FlatHashMap<String, WeakReference<Instrument>, StringHash> instrumentsByIdCache;
+    mutable FlatHashMap<String, WeakReference<Instrument>, StringHash> instrumentsByHashCache;
+    void rebuildInstrumentsIndexIfNeeded() const;
+
     WeakReference<Instrument> defaultInstrument;
     WeakReference<Instrument> metronomeInstrument;
 
     UniquePointer<AudioMonitor> audioMonitor;
+    UniquePointer<InstrumentsMixer> instrumentsMixer;
+
+    class LatencyCompensationTimer;
+    UniquePointer<LatencyCompensationTimer> latencyCompensationTimer;
+
+    UniquePointer<LatencyMeter> latencyMeter;
+    double latencyCorrectionMs = 0.0;
+
+    // both the latency correction and the stable buffer sizes
+    // only make sense for the device they were found with
+    String statsDeviceName;
+    void resetStatsIfDeviceChanged(const AudioIODevice &device);
+
+    // the stats of the current buffer size, updated with the
+    // latency compensation, which is done periodically anyway
+    static constexpr auto stableBufferSizeTimeoutMs = 60 * 1000;
+    Array<int> stableBufferSizes;
+    int observedBufferSize = 0;
+    int observedNumOverruns = 0;
+    int observedStableMs = 0;
+    void updateBufferSizeStats(int elapsedMs);
 
     AudioPluginFormatManager formatManager;
     AudioDeviceManager deviceManager;
 
     Atomic<bool> isMuted = false;
+    Atomic<bool> isSleeping = false;
 
 private:
 
@@ -243,12 +385,14 @@ private:
             if (message.isNoteOn())
             {
                 mappedMessage = MidiMessage::noteOn(message.getChannel(),
-                    this->getMappedKey(message.getNoteNumber()), message.getVelocity());
+                    this->getMappedKey(message.getNoteNumber()), message.getVelocity())
+                    .withTimeStamp(message.getTimeStamp());
             }
             else if (message.isNoteOff())
             {
                 mappedMessage = MidiMessage::noteOff(message.getChannel(),
-                    this->getMappedKey(message.getNoteNumber()), message.getVelocity());
+                    this->getMappedKey(message.getNoteNumber()), message.getVelocity())
+                    .withTimeStamp(message.getTimeStamp());
             }
 
             this->targetInstrumentCallback->handleIncomingMidiMessage(source, mappedMessage);
@@ -271,6 +415,18 @@ private:
 
     Array<FilteredMidiCallback> filteredMidiCallbacks;
     Atomic<bool> isReadjustingMidiInput = true;
+    Atomic<bool> isSampleAccuratePlayback = true;
+    Atomic<bool> isParallelProcessing = false;
+    Atomic<bool> isIdleSuspension = true;
+
+    // set on the message thread, read by the player thread
+    MidiOutputDevice::Ptr midiOutput;
+    SpinLock midiOutputLock;
+
+    static constexpr auto idleTimeoutSeconds = 10.f;
+    static constexpr auto unusedIdleTimeoutSeconds = 1.f;
+    Array<WeakReference<Instrument>> instrumentsInUse;
+    void updateIdleTimeouts();
 
     struct MidiPlayerInfo final
     {
@@ -22,7 +22,9 @@
 // Voice
 //===----------------------------------------------------------------------===//
 
-DefaultSynth::Voice::Voice()
+DefaultSynth::Voice::Voice(const double *phaseDeltas, VoicePool &pool) :
+    phaseDeltas(phaseDeltas),
+    pool(pool)
 {
     ADSR::Parameters ap;
     ap.attack = 0.001f;
@@ -30,15 +32,6 @@ DefaultSynth::Voice::Voice()
     ap.sustain = 0.2f;
     ap.release = 0.5f;
     this->adsr.setParameters(ap);
-
-    Reverb::Parameters rp;
-    rp.roomSize = 0.0f;
-    rp.damping = 0.0f;
-    rp.wetLevel = 0.23f;
-    rp.dryLevel = 0.73f;
-    rp.width = 0.0f;
-    rp.freezeMode = 0.4f;
-    this->reverb.setParameters(rp);
 }
 
 bool DefaultSynth::Voice::canPlaySound(SynthesiserSound *)
@@ -51,7 +44,6 @@ void DefaultSynth::Voice::setCurrentPlaybackSampleRate(double sampleRate)
     if (sampleRate > 0)
     {
         this->adsr.setSampleRate(sampleRate);
-        this->reverb.setSampleRate(sampleRate);
         SynthesiserVoice::setCurrentPlaybackSampleRate(sampleRate);
     }
 }
@@ -62,14 +54,11 @@ void DefaultSynth::Voice::startNote(int midiNoteNumber, float velocity, Synthesi
     const int realNoteNumber = midiNoteNumber +
         Globals::twelveToneKeyboardSize * (channel - 1);
 
-    this->currentAngle = 0.0;
-    this->level = velocity * 0.15;
-
-    const auto cyclesPerSecond = this->getNoteInHertz(realNoteNumber);
-    const auto cyclesPerSample = cyclesPerSecond / this->getSampleRate();
-
-    this->angleDelta = cyclesPerSample * MathConstants<double>::twoPi;
+    this->phase = 0.0;
+    this->level = velocity * 0.15f;
+    this->phaseDelta = this->phaseDeltas[jlimit(0, DefaultSynth::numKeys - 1, realNoteNumber)];
 
+    this->pool.acquire(this, channel);
     this->adsr.noteOn();
 }
 
@@ -81,48 +70,86 @@ void DefaultSynth::Voice::stopNote(float, bool allowTailOff)
     }
     else
     {
-        this->clearCurrentNote();
+        this->clearNote();
         this->adsr.reset();
-        this->reverb.reset();
     }
 }
 
+const float *DefaultSynth::Voice::getSineTable() noexcept
+{
+    // one extra sample at the end for the interpolation
+    struct SineTable final
+    {
+        SineTable()
+        {
+            for (int i = 0; i <= Voice::sineTableSize; ++i)
+            {
+                this->data[i] = float(std::sin(MathConstants<double>::twoPi * i / Voice::sineTableSize));
+            }
+        }
+
+        float data[Voice::sineTableSize + 1];
+    };
+
+    static const SineTable table;
+    return table.data;
+}
+
 void DefaultSynth::Voice::renderNextBlock(AudioBuffer<float> &outputBuffer, int startSample, int numSamples)
 {
-    if (this->adsr.isActive())
+    if (!this->adsr.isActive())
     {
-        while (--numSamples >= 0)
+        return;
+    }
+
+    const auto *sineTable = Voice::getSineTable();
+    float *chunkChannels[] = { this->chunk };
+
+    while (numSamples > 0)
+    {
+        const auto chunkSize = jmin(numSamples, Voice::maxChunkSize);
+
+        for (int i = 0; i < chunkSize; ++i)
         {
-            const auto amplitude = this->adsr.getNextSample();
-            auto currentSample = (float)(std::sin(currentAngle) * level * amplitude);
-            this->reverb.processMono(&currentSample, 1);
+            const auto index = int(this->phase);
+            const auto fraction = float(this->phase - index);
+            const auto a = sineTable[index];
+            const auto b = sineTable[index + 1];
+            this->chunk[i] = a + fraction * (b - a);
 
-            for (auto i = outputBuffer.getNumChannels(); i --> 0 ;)
+            this->phase += this->phaseDelta;
+            if (this->phase >= Voice::sineTableSize)
             {
-                outputBuffer.addSample(i, startSample, currentSample);
+                this->phase -= Voice::sineTableSize;
             }
+        }
+
+        FloatVectorOperations::multiply(this->chunk, this->level, chunkSize);
+
+        AudioBuffer<float> chunkBuffer(chunkChannels, 1, chunkSize);
+        this->adsr.applyEnvelopeToBuffer(chunkBuffer, 0, chunkSize);
 
-            this->currentAngle += this->angleDelta;
-            ++startSample;
+        for (int i = 0; i < outputBuffer.getNumChannels(); ++i)
+        {
+            FloatVectorOperations::add(outputBuffer.getWritePointer(i, startSample),
+                this->chunk, chunkSize);
         }
-    }
-}
 
-void DefaultSynth::Voice::setPeriodSize(int size) noexcept
-{
-    this->periodSize = size;
-    this->middleC = Temperament::periodNumForMiddleC * this->periodSize;
-}
+        startSample += chunkSize;
+        numSamples -= chunkSize;
+    }
 
-void DefaultSynth::Voice::setPeriodRange(double periodRange) noexcept
-{
-    this->periodRange = periodRange;
+    // the release is over, so the voice can be reused
+    if (!this->adsr.isActive())
+    {
+        this->clearNote();
+    }
 }
 
-double DefaultSynth::Voice::getNoteInHertz(int noteNumber, double frequencyOfA /*= 440.0*/) noexcept
+void DefaultSynth::Voice::clearNote() noexcept
 {
-    return frequencyOfA * std::pow(this->periodRange,
-        (noteNumber - this->middleC) / double(this->periodSize));
+    this->clearCurrentNote();
+    this->pool.release(this);
 }
 
 int DefaultSynth::Voice::getCurrentChannel() const noexcept
@@ -140,31 +167,227 @@ int DefaultSynth::Voice::getCurrentChannel() const noexcept
     return 1;
 }
 
+//===----------------------------------------------------------------------===//
+// VoicePool
+//===----------------------------------------------------------------------===//
+
+void DefaultSynth::VoicePool::acquire(Voice *voice, int channel) noexcept
+{
+    if (voice->freeListIndex >= 0)
+    {
+        // swap with the last one to remove in O(1)
+        auto *lastVoice = this->freeVoices.getLast();
+        this->freeVoices.set(voice->freeListIndex, lastVoice);
+        lastVoice->freeListIndex = voice->freeListIndex;
+        this->freeVoices.removeLast();
+        voice->freeListIndex = -1;
+    }
+
+    if (voice->channel > 0)
+    {
+        this->voicesPerChannel[voice->channel]--;
+    }
+
+    voice->channel = jlimit(1, Globals::numChannels, channel);
+    this->voicesPerChannel[voice->channel]++;
+}
+
+void DefaultSynth::VoicePool::release(Voice *voice) noexcept
+{
+    if (voice->channel > 0)
+    {
+        this->voicesPerChannel[voice->channel]--;
+        voice->channel = 0;
+    }
+
+    if (voice->freeListIndex < 0)
+    {
+        voice->freeListIndex = this->freeVoices.size();
+        this->freeVoices.add(voice);
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // DefaultSynth
 //===----------------------------------------------------------------------===//
 
 DefaultSynth::DefaultSynth()
 {
+    this->voicePool.freeVoices.ensureStorageAllocated(DefaultSynth::numVoices);
+
     for (int i = DefaultSynth::numVoices; i --> 0 ;)
     {
-        this->addVoice(new DefaultSynth::Voice());
+        auto *voice = new DefaultSynth::Voice(this->phaseDeltas, this->voicePool);
+        this->addVoice(voice);
+        this->voicePool.release(voice);
     }
 
     this->addSound(new DefaultSynth::Sound());
+
+    Reverb::Parameters rp;
+    rp.roomSize = 0.0f;
+    rp.damping = 0.0f;
+    rp.wetLevel = 0.23f;
+    rp.dryLevel = 0.73f;
+    rp.width = 0.0f;
+    rp.freezeMode = 0.4f;
+    this->reverb.setParameters(rp);
+}
+
+void DefaultSynth::setCurrentPlaybackSampleRate(double sampleRate)
+{
+    if (sampleRate > 0)
+    {
+        this->reverb.setSampleRate(sampleRate);
+        this->reverb.reset();
+    }
+
+    Synthesiser::setCurrentPlaybackSampleRate(sampleRate);
+
+    const ScopedLock sl(this->lock);
+    this->updatePhaseDeltas();
+}
+
+void DefaultSynth::renderVoices(AudioBuffer<float> &outputAudio, int startSample, int numSamples)
+{
+    Synthesiser::renderVoices(outputAudio, startSample, numSamples);
+
+    // all voices are mono, so the channels are the same before the reverb
+    if (outputAudio.getNumChannels() >= 2)
+    {
+        this->reverb.processStereo(outputAudio.getWritePointer(0, startSample),
+            outputAudio.getWritePointer(1, startSample), numSamples);
+
+        for (int i = 2; i < outputAudio.getNumChannels(); ++i)
+        {
+            outputAudio.copyFrom(i, startSample, outputAudio, 0, startSample, numSamples);
+        }
+    }
+    else if (outputAudio.getNumChannels() == 1)
+    {
+        this->reverb.processMono(outputAudio.getWritePointer(0, startSample), numSamples);
+    }
+}
+
+void DefaultSynth::setVoiceStealing(VoiceStealing stealing) noexcept
+{
+    const ScopedLock sl(this->lock);
+    this->voiceStealing = stealing;
+}
+
+void DefaultSynth::setMaxVoicesPerChannel(int maxVoices) noexcept
+{
+    const ScopedLock sl(this->lock);
+    this->maxVoicesPerChannel = jmax(0, maxVoices);
+}
+
+SynthesiserVoice *DefaultSynth::findFreeVoice(SynthesiserSound *sound,
+    int midiChannel, int midiNoteNumber, bool stealIfNoneAvailable) const
+{
+    const ScopedLock sl(this->lock);
+
+    const auto channel = jlimit(1, Globals::numChannels, midiChannel);
+    const bool channelIsFull = this->maxVoicesPerChannel > 0 &&
+        this->voicePool.voicesPerChannel[channel] >= this->maxVoicesPerChannel;
+
+    if (!channelIsFull && !this->voicePool.freeVoices.isEmpty())
+    {
+        return this->voicePool.freeVoices.getLast();
+    }
+
+    if (stealIfNoneAvailable)
+    {
+        return this->findVoiceToSteal(sound, midiChannel, midiNoteNumber);
+    }
+
+    return nullptr;
+}
+
+SynthesiserVoice *DefaultSynth::findVoiceToSteal(SynthesiserSound *,
+    int midiChannel, int) const
+{
+    // stealing only happens when the voices are exhausted,
+    // or when the channel's limit is reached, and then
+    // the voice is only taken from that same channel
+    const auto channel = jlimit(1, Globals::numChannels, midiChannel);
+    const bool channelIsFull = this->maxVoicesPerChannel > 0 &&
+        this->voicePool.voicesPerChannel[channel] >= this->maxVoicesPerChannel;
+
+    Voice *result = nullptr;
+    for (auto *v : this->voices)
+    {
+        auto *voice = static_cast<Voice *>(v);
+        if (channelIsFull && voice->getChannel() != channel)
+        {
+            continue;
+        }
+
+        if (result == nullptr)
+        {
+            result = voice;
+            continue;
+        }
+
+        const auto isReleased = voice->isPlayingButReleased();
+        const auto resultIsReleased = result->isPlayingButReleased();
+        if (isReleased != resultIsReleased)
+        {
+            result = isReleased ? voice : result;
+            continue;
+        }
+
+        if (this->voiceStealing == VoiceStealing::Quietest &&
+            voice->getLevel() != result->getLevel())
+        {
+            result = voice->getLevel() < result->getLevel() ? voice : result;
+            continue;
+        }
+
+        if (voice->wasStartedBefore(*result))
+        {
+            result = voice;
+        }
+    }
+
+    return result;
 }
 
 void DefaultSynth::setPeriodSizeAndRange(int periodSize, double periodRange)
 {
+    if (this->periodSize == periodSize && this->periodRange == periodRange)
+    {
+        return;
+    }
+
     //DBG("Setting octave size for the default synth: " + String(periodSize));
+    const ScopedLock sl(this->lock);
+
     for (int i = 0; i < this->getNumVoices(); ++i)
     {
-        if (auto *voice = dynamic_cast<DefaultSynth::Voice *>(this->getVoice(i)))
-        {
-            voice->stopNote(1.f, false);
-            voice->setPeriodSize(periodSize);
-            voice->setPeriodRange(periodRange);
-        }
+        this->getVoice(i)->stopNote(1.f, false);
+    }
+
+    this->periodSize = periodSize;
+    this->periodRange = periodRange;
+    this->updatePhaseDeltas();
+}
+
+void DefaultSynth::updatePhaseDeltas() noexcept
+{
+    const auto sampleRate = this->getSampleRate();
+    if (sampleRate <= 0.0)
+    {
+        return;
+    }
+
+    constexpr auto frequencyOfA = 440.0;
+    const auto middleC = Temperament::periodNumForMiddleC * this->periodSize;
+    const auto phaseDeltaOfA = frequencyOfA / sampleRate * Voice::sineTableSize;
+
+    for (int i = 0; i < DefaultSynth::numKeys; ++i)
+    {
+        this->phaseDeltas[i] = phaseDeltaOfA *
+            std::pow(this->periodRange, (i - middleC) / double(this->periodSize));
     }
 }
 
@@ -37,19 +37,68 @@ public:
     // a better approach, or just get rid of this hack;
     void setPeriodSizeAndRange(int periodSize, double periodRange);
 
+    void setCurrentPlaybackSampleRate(double sampleRate) override;
+
+    // which playing voice to cut off, when a new note needs one,
+    // and there are no free voices, or the channel's limit is reached;
+    // released voices are always stolen before the held ones
+    enum class VoiceStealing : int8
+    {
+        Oldest,
+        Quietest
+    };
+
+    void setVoiceStealing(VoiceStealing stealing) noexcept;
+
+    // 0 means no limit, i.e. one channel can use all the voices
+    void setMaxVoicesPerChannel(int maxVoices) noexcept;
+
 protected:
 
+    SynthesiserVoice *findFreeVoice(SynthesiserSound *sound,
+        int midiChannel, int midiNoteNumber, bool stealIfNoneAvailable) const override;
+
+    SynthesiserVoice *findVoiceToSteal(SynthesiserSound *sound,
+        int midiChannel, int midiNoteNumber) const override;
+
+    // the reverb is a send bus shared by all voices, processed once
+    // for each rendered range after all voices are summed up,
+    // so that its cost doesn't grow with the polyphony
+    void renderVoices(AudioBuffer<float> &outputAudio, int startSample, int numSamples) override;
+    Reverb reverb;
+
     struct Sound final : public SynthesiserSound
     {
         bool appliesToNote(int midiNoteNumber) override { return true; }
         bool appliesToChannel(int midiChannel) override { return true; }
     };
 
+    class Voice;
+
+    // keeps the voices which are not playing anything, so that a free one
+    // is found in O(1) instead of searching all of them for each note-on,
+    // and counts the voices playing on each channel; it is only accessed
+    // from the voices' note start and stop callbacks and from the voice
+    // search, all of which are called under the synth's lock
+    struct VoicePool final
+    {
+        void acquire(Voice *voice, int channel) noexcept;
+        void release(Voice *voice) noexcept;
+
+        Array<Voice *> freeVoices;
+        int voicesPerChannel[Globals::numChannels + 1] = {};
+    };
+
+    VoicePool voicePool;
+
+    VoiceStealing voiceStealing = VoiceStealing::Oldest;
+    int maxVoicesPerChannel = 0;
+
     class Voice final : public SynthesiserVoice
     {
     public:
 
-        Voice();
+        Voice(const double *phaseDeltas, VoicePool &pool);
 
         bool canPlaySound(SynthesiserSound *) override;
         void setCurrentPlaybackSampleRate(double sampleRate) override;
@@ -61,30 +110,54 @@ protected:
 
         using SynthesiserVoice::renderNextBlock;
 
-        void setPeriodSize(int size) noexcept;
-        void setPeriodRange(double periodRange) noexcept;
+        float getLevel() const noexcept { return this->level; }
+        int getChannel() const noexcept { return this->channel; }
 
     private:
 
-        double currentAngle = 0.0;
-        double angleDelta = 0.0;
-        double level = 0.0;
+        // the oscillator is a phase accumulator over the shared sine table;
+        // each block is rendered in chunks into the scratch buffer, which is
+        // enveloped and then added to all output channels
+        static constexpr auto sineTableSize = 2048; // a power of two
+        static const float *getSineTable() noexcept;
+
+        static constexpr auto maxChunkSize = 256;
+        float chunk[maxChunkSize];
+
+        double phase = 0.0; // in the table samples
+        double phaseDelta = 0.0;
+        float level = 0.f;
 
-        int periodSize = Globals::twelveTonePeriodSize;
-        double periodRange = 2.0;
-        int middleC = Temperament::periodNumForMiddleC * Globals::twelveTonePeriodSize;
+        // owned by the synth and shared by all voices
+        const double *phaseDeltas = nullptr;
+
+        VoicePool &pool;
+        int channel = 0; // 0 when free
+        int freeListIndex = -1; // -1 when playing
+
+        friend struct VoicePool;
 
         ADSR adsr;
-        Reverb reverb;
 
-        double getNoteInHertz(int noteNumber, double frequencyOfA = 440.0) noexcept;
+        void clearNote() noexcept;
         int getCurrentChannel() const noexcept;
     };
 
+    // phase increments for all keys of all channels, in the sine table
+    // samples per output sample, computed only when the temperament
+    // or the sample rate changes, so that note-ons are just lookups
+    static constexpr auto numKeys = Globals::twelveToneKeyboardSize * Globals::numChannels;
+    double phaseDeltas[numKeys] = {};
+
+    int periodSize = Globals::twelveTonePeriodSize;
+    double periodRange = 2.0;
+
+    void updatePhaseDeltas() noexcept;
+
     void handleSustainPedal(int midiChannel, bool isDown) override;
     void handleSostenutoPedal(int midiChannel, bool isDown) override;
 
-    static constexpr auto numVoices = 16;
+    static constexpr auto numVoices = 64;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DefaultSynth)
 };
@@ -72,6 +72,17 @@ AudioFormatReader *MetronomeSynth::TickSample::createReader()
     return nullptr;
 }
 
+String MetronomeSynth::TickSample::getCacheKey() const
+{
+    // the custom samples are re-decoded if the file has been changed
+    const auto source = this->sourceData != nullptr ?
+        String::toHexString(pointer_sized_int(this->sourceData)) :
+        this->customSamplePath + ":" +
+            String(File(this->customSamplePath).getLastModificationTime().toMilliseconds());
+
+    return source + ":" + String(this->midiNoteForNormalPitch);
+}
+
 //===----------------------------------------------------------------------===//
 // MetronomeSynth
 //===----------------------------------------------------------------------===//
@@ -135,17 +146,55 @@ void MetronomeSynth::initSampler(const SamplerParameters &params)
 
     for (auto &sample : samples)
     {
-        UniquePointer<AudioFormatReader> sampleSoundReader(sample.createReader());
-        if (sampleSoundReader != nullptr)
+        if (auto sound = MetronomeSynth::getSharedSound(sample))
         {
-            this->addSound(new SamplerSound({}, *sampleSoundReader,
-                sample.midiNotes, sample.midiNoteForNormalPitch,
-                TickSample::attackTime, TickSample::releaseTime,
-                TickSample::maxPlaybackTime));
+            this->addSound(sound);
         }
     }
 }
 
+MetronomeSynth::SharedSounds &MetronomeSynth::getSharedSounds()
+{
+    static SharedSounds sharedSounds;
+    return sharedSounds;
+}
+
+void MetronomeSynth::clearSharedSounds()
+{
+    auto &cache = MetronomeSynth::getSharedSounds();
+    const ScopedLock lock(cache.lock);
+    cache.sounds.clear();
+}
+
+SynthesiserSound::Ptr MetronomeSynth::getSharedSound(TickSample &sample)
+{
+    auto &cache = MetronomeSynth::getSharedSounds();
+    const auto key = sample.getCacheKey();
+
+    const ScopedLock lock(cache.lock);
+    const auto found = cache.sounds.find(key);
+    if (found != cache.sounds.end())
+    {
+        return found->second;
+    }
+
+    UniquePointer<AudioFormatReader> sampleSoundReader(sample.createReader());
+    if (sampleSoundReader == nullptr)
+    {
+        return nullptr;
+    }
+
+    // the sampler sounds are only read when rendering,
+    // so it's safe to share them between the synths
+    SynthesiserSound::Ptr sound(new SamplerSound({}, *sampleSoundReader,
+        sample.midiNotes, sample.midiNoteForNormalPitch,
+        TickSample::attackTime, TickSample::releaseTime,
+        TickSample::maxPlaybackTime));
+
+    cache.sounds[key] = sound;
+    return sound;
+}
+
 void MetronomeSynth::handleSustainPedal(int midiChannel, bool isDown) {}
 void MetronomeSynth::handleSostenutoPedal(int midiChannel, bool isDown) {}
 
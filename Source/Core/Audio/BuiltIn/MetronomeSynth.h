@@ -41,6 +41,9 @@ public:
 
     static Note::Key getKeyForSyllable(MetronomeScheme::Syllable syllable);
 
+    // called at shutdown, to avoid the leak check firing
+    static void clearSharedSounds();
+
 protected:
 
     void handleSustainPedal(int midiChannel, bool isDown) override;
@@ -59,6 +62,7 @@ protected:
         TickSample(int rootKey, const String &customSample);
 
         AudioFormatReader *createReader();
+        String getCacheKey() const;
 
         const char *sourceData = nullptr;
         const int sourceDataSize = 0;
@@ -71,5 +75,20 @@ protected:
         JUCE_LEAK_DETECTOR(TickSample)
     };
 
+    // the decoded samples are shared by all metronome instances, and kept
+    // until the app quits, so that neither opening another project, nor
+    // switching the custom samples back and forth decodes them again
+    static SynthesiserSound::Ptr getSharedSound(TickSample &sample);
+
+    struct SharedSounds final
+    {
+        // initSampler is called both from the message thread and,
+        // for the lazy initialization, from the audio threads
+        CriticalSection lock;
+        FlatHashMap<String, SynthesiserSound::Ptr, StringHash> sounds;
+    };
+
+    static SharedSounds &getSharedSounds();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MetronomeSynth)
 };
@@ -0,0 +1,78 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A fixed delay of a multichannel signal: instruments with different
+// processing latencies are lined up by delaying the faster ones' outputs
+// by the difference with the slowest one; the buffer is allocated upfront,
+// so processing is realtime-safe, but changing the delay means a new object
+template <typename SampleType>
+class CompensationDelay final
+{
+public:
+
+    CompensationDelay(int numChannels, int delaySamples) :
+        buffer(jmax(1, numChannels), jmax(1, delaySamples)),
+        delay(jmax(0, delaySamples))
+    {
+        this->buffer.clear();
+    }
+
+    int getDelay() const noexcept
+    {
+        return this->delay;
+    }
+
+    void process(SampleType *const *channels, int numChannels, int numSamples) noexcept
+    {
+        if (this->delay == 0)
+        {
+            return;
+        }
+
+        // each sample is swapped with the one written (delay) samples ago
+        const auto numDelayedChannels = jmin(numChannels, this->buffer.getNumChannels());
+        int numDone = 0;
+        while (numDone < numSamples)
+        {
+            const auto length = jmin(numSamples - numDone, this->delay - this->position);
+            for (int c = 0; c < numDelayedChannels; ++c)
+            {
+                std::swap_ranges(channels[c] + numDone, channels[c] + numDone + length,
+                    this->buffer.getWritePointer(c, this->position));
+            }
+
+            numDone += length;
+            this->position = (this->position + length) % this->delay;
+        }
+    }
+
+    void reset() noexcept
+    {
+        this->buffer.clear();
+        this->position = 0;
+    }
+
+private:
+
+    AudioBuffer<SampleType> buffer;
+    const int delay;
+    int position = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompensationDelay)
+};
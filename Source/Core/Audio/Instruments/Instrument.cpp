@@ -86,6 +86,11 @@ bool Instrument::isValid() const noexcept
         this->lastValidStateFallback.isEmpty();
 }
 
+bool Instrument::isLoading() const noexcept
+{
+    return this->numPendingDeserializations > 0;
+}
+
 bool Instrument::isDefaultInstrument() const noexcept
 {
     const auto mainNode = this->findMainPluginNode();
@@ -108,6 +113,28 @@ bool Instrument::isMetronomeInstrument() const noexcept
     return dynamic_cast<MetronomeSynthAudioPlugin *>(mainNode->getProcessor()) != nullptr;
 }
 
+bool Instrument::isRoutedToMidiOutput() const
+{
+    for (const auto &c : this->getConnections())
+    {
+        if (c.destination.channelIndex != Instrument::midiChannelNumber)
+        {
+            continue;
+        }
+
+        const auto node = this->getNodeForId(c.destination.nodeID);
+        const auto *io = (node != nullptr) ?
+            dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor *>(node->getProcessor()) : nullptr;
+
+        if (io != nullptr && io->getType() == AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void Instrument::initializeFrom(const PluginDescription &pluginDescription, InitializationCallback initCallback)
 {
     this->processorGraph->clear();
@@ -333,6 +360,59 @@ bool Instrument::isNodeStandardIOProcessor(AudioProcessorGraph::Node::Ptr node)
     return (nullptr != dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor *>(node->getProcessor()));
 }
 
+static int getNodeOutputLatency(const Instrument &instrument,
+    const std::vector<AudioProcessorGraph::Connection> &connections,
+    AudioProcessorGraph::NodeID nodeId, FlatHashMap<uint32, int> &cache, int depth)
+{
+    const auto found = cache.find(nodeId.uid);
+    if (found != cache.end())
+    {
+        return found->second;
+    }
+
+    // the graph doesn't allow cycles, but just in case
+    if (depth > instrument.getNumNodes())
+    {
+        return 0;
+    }
+
+    int inputLatency = 0;
+    for (const auto &c : connections)
+    {
+        if (c.destination.nodeID == nodeId)
+        {
+            inputLatency = jmax(inputLatency, getNodeOutputLatency(instrument,
+                connections, c.source.nodeID, cache, depth + 1));
+        }
+    }
+
+    const auto node = instrument.getNodeForId(nodeId);
+    const auto result = inputLatency +
+        ((node != nullptr) ? jmax(0, node->getProcessor()->getLatencySamples()) : 0);
+
+    cache[nodeId.uid] = result;
+    return result;
+}
+
+int Instrument::getLatencySamples() const
+{
+    const auto connections = this->getConnections();
+    FlatHashMap<uint32, int> cache;
+
+    int latency = 0;
+    for (int i = 0; i < this->getNumNodes(); ++i)
+    {
+        const auto node = this->getNode(i);
+        const auto *io = dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor *>(node->getProcessor());
+        if (io != nullptr && io->getType() == AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode)
+        {
+            latency = jmax(latency, getNodeOutputLatency(*this, connections, node->nodeID, cache, 0));
+        }
+    }
+
+    return latency;
+}
+
 Array<AudioProcessorGraph::Node::Ptr> Instrument::findMidiAcceptors() const
 {
     Array<AudioProcessorGraph::Node::Ptr> nodes;
@@ -642,8 +722,11 @@ void Instrument::deserialize(const SerializedData &data)
         }
     }
 
+    this->numPendingDeserializations++;
     this->deserializeNodesAsync(nodesToDeserializeAsync, [this, connectionDescriptions]()
     {
+        this->numPendingDeserializations--;
+
         for (const auto &connectionInfo : connectionDescriptions)
         {
             this->addConnection(AudioProcessorGraph::NodeID(connectionInfo.sourceNodeId),
@@ -676,6 +759,18 @@ void Instrument::deserialize(const SerializedData &data)
     });
 }
 
+// all nodes are requested at once instead of one after another, so that
+// the formats which create their instances asynchronously load them at the
+// same time, and the others don't make the following nodes (and instruments)
+// wait in line; the graph is to be wired up when the last node is ready,
+// and the order of adding them doesn't matter, since they keep their ids
+struct PendingNodes final : public ReferenceCountedObject
+{
+    using Ptr = ReferenceCountedObjectPtr<PendingNodes>;
+    int numPendingNodes = 0;
+    Function<void()> allDoneCallback;
+};
+
 void Instrument::deserializeNodesAsync(Array<SerializedData> nodesToDeserialize,
     DeserializeNodesCallback allDoneCallback)
 {
@@ -686,22 +781,32 @@ void Instrument::deserializeNodesAsync(Array<SerializedData> nodesToDeserialize,
         return;
     }
 
-    const auto tree = nodesToDeserialize.removeAndReturn(0);
+    PendingNodes::Ptr pendingNodes(new PendingNodes());
+    pendingNodes->numPendingNodes = nodesToDeserialize.size();
+    pendingNodes->allDoneCallback = allDoneCallback;
 
-    SerializablePluginDescription desc;
-    desc.deserialize(tree.getChild(0)); // "node"/"plugin"
-    
-    const auto callback = [this, nodesToDeserialize, tree, allDoneCallback]
-    (UniquePointer<AudioPluginInstance> instance, const String &error)
+    for (const auto &tree : nodesToDeserialize)
     {
-        this->addNode(move(instance), tree);
-        this->deserializeNodesAsync(nodesToDeserialize, allDoneCallback);
-    };
+        SerializablePluginDescription desc;
+        desc.deserialize(tree.getChild(0)); // "node"/"plugin"
 
-    this->formatManager.createPluginInstanceAsync(desc,
-        this->processorGraph->getSampleRate(),
-        this->processorGraph->getBlockSize(),
-        callback);
+        // the async instantiation callbacks are always called on the message thread
+        const auto callback = [this, tree, pendingNodes]
+        (UniquePointer<AudioPluginInstance> instance, const String &error)
+        {
+            this->addNode(move(instance), tree);
+
+            if (--pendingNodes->numPendingNodes == 0)
+            {
+                pendingNodes->allDoneCallback();
+            }
+        };
+
+        this->formatManager.createPluginInstanceAsync(desc,
+            this->processorGraph->getSampleRate(),
+            this->processorGraph->getBlockSize(),
+            callback);
+    }
 }
 
 AudioProcessorGraph::Node::Ptr Instrument::addNode(const PluginDescription &desc, double x, double y)
@@ -796,7 +901,7 @@ void Instrument::configureNode(AudioProcessorGraph::Node::Ptr node,
 
 void Instrument::AudioCallback::setProcessor(AudioProcessor *const newOne)
 {
-    if (this->processor != newOne)
+    if (this->processor.get() != newOne)
     {
         if (newOne != nullptr && this->sampleRate > 0 && this->blockSize > 0)
         {
@@ -808,12 +913,15 @@ void Instrument::AudioCallback::setProcessor(AudioProcessor *const newOne)
         AudioProcessor *oldOne;
 
         {
-            const ScopedLock sl(lock);
-            oldOne = this->isPrepared ? this->processor : nullptr;
+            const ScopedLock sl(this->lock);
+            oldOne = this->isPrepared ? this->processor.get() : nullptr;
             this->processor = newOne;
             this->isPrepared = true;
         }
 
+        // the audio thread might still be processing the old one
+        this->waitForCallbackToFinish();
+
         if (oldOne != nullptr)
         {
             oldOne->releaseResources();
@@ -821,17 +929,202 @@ void Instrument::AudioCallback::setProcessor(AudioProcessor *const newOne)
     }
 }
 
+// The audio thread never takes any locks here, so before releasing anything
+// it might be using, the other threads should make sure it has left the callback;
+// the flag is set before the pointers are read by the audio thread, and the other
+// threads swap the pointers before checking the flag (all sequentially consistent),
+// so the audio thread either sees the new pointers, or gets waited for
+void Instrument::AudioCallback::waitForCallbackToFinish() const
+{
+    while (this->isInsideCallback.get())
+    {
+        Thread::yield();
+    }
+}
+
 void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputChannelData,
     const int numInputChannels, float **const outputChannelData,
     const int numOutputChannels, const int numSamples)
+{
+    REALTIME_SCOPE();
+    this->isInsideCallback = true;
+
+    if (this->sleeping.get() &&
+        this->scheduledReadIndex.get() == this->scheduledWriteIndex.get())
+    {
+        for (int i = 0; i < numOutputChannels; ++i)
+        {
+            FloatVectorOperations::clear(outputChannelData[i], numSamples);
+        }
+
+        // keep the clock running for the player and waitForMessagesFlush
+        this->samplePosition = this->samplePosition.get() + numSamples;
+        this->isInsideCallback = false;
+        return;
+    }
+
+    this->sleeping = false;
+
+    const auto startTicks = Time::getHighResolutionTicks();
+
+    this->processNextBlock(inputChannelData, numInputChannels,
+        outputChannelData, numOutputChannels, numSamples);
+
+    if (auto *delay = this->compensationDelay.get())
+    {
+        delay->process(outputChannelData, numOutputChannels, numSamples);
+    }
+
+    this->updateLoad(startTicks, numSamples);
+
+    this->isInsideCallback = false;
+}
+
+void Instrument::AudioCallback::updateLoad(int64 startTicks, int numSamples) noexcept
+{
+    if (this->sampleRate <= 0 || numSamples <= 0)
+    {
+        return;
+    }
+
+    const auto processingMs = float(Time::highResolutionTicksToSeconds(
+        Time::getHighResolutionTicks() - startTicks) * 1000.0);
+    const auto blockMs = float(numSamples * 1000.0 / this->sampleRate);
+    const auto load = processingMs / blockMs;
+
+    if (this->shouldResetLoad.compareAndSetBool(false, true))
+    {
+        this->averageProcessingMs = processingMs;
+        this->maxProcessingMs = 0.f;
+        this->averageLoad = load;
+        this->maxLoad = 0.f;
+        this->numOverruns = 0;
+    }
+
+    // the moving average over roughly the last hundred blocks
+    constexpr auto smoothing = 0.01f;
+    const auto averageMs = this->averageProcessingMs.get();
+    this->averageProcessingMs = averageMs + (processingMs - averageMs) * smoothing;
+    const auto average = this->averageLoad.get();
+    this->averageLoad = average + (load - average) * smoothing;
+
+    this->maxProcessingMs = jmax(this->maxProcessingMs.get(), processingMs);
+    this->maxLoad = jmax(this->maxLoad.get(), load);
+
+    if (load > 1.f)
+    {
+        this->numOverruns += 1;
+    }
+}
+
+Instrument::AudioCallback::Load Instrument::AudioCallback::getLoad() const noexcept
+{
+    Load result;
+    result.averageMs = this->averageProcessingMs.get();
+    result.maxMs = this->maxProcessingMs.get();
+    result.averageLoad = this->averageLoad.get();
+    result.maxLoad = this->maxLoad.get();
+    result.numOverruns = this->numOverruns.get();
+    return result;
+}
+
+void Instrument::AudioCallback::setLatencyCompensation(int numSamples)
+{
+    const ScopedLock sl(this->lock);
+
+    if (this->latencyCompensation.get() != numSamples)
+    {
+        this->latencyCompensation = numSamples;
+        this->updateCompensationDelay();
+    }
+}
+
+// the delay has as many channels as the device, so it is recreated
+// when the device restarts, and the old one is released the same
+// way as the old processor, after the audio thread is done with it
+void Instrument::AudioCallback::updateCompensationDelay()
+{
+    const auto numSamples = this->latencyCompensation.get();
+
+    UniquePointer<CompensationDelay<float>> newDelay;
+    if (numSamples > 0 && this->numOutputChans > 0)
+    {
+        newDelay = make<CompensationDelay<float>>(this->numOutputChans, numSamples);
+    }
+
+    this->compensationDelay = newDelay.get();
+    this->waitForCallbackToFinish();
+    this->compensationDelayHolder = move(newDelay);
+}
+
+void Instrument::AudioCallback::processNextBlock(const float **inputChannelData,
+    int numInputChannels, float **outputChannelData, int numOutputChannels, int numSamples)
 {
     jassert(this->sampleRate > 0 && this->blockSize > 0);
 
     this->incomingMidi.clear();
     this->messageCollector.removeNextBlockOfMessages(this->incomingMidi, numSamples);
+    this->addCarriedOverMidi();
+    this->readLiveMessages(numSamples);
+
+    const auto blockStart = this->samplePosition.get();
+    const auto blockEnd = blockStart + numSamples;
+    this->samplePosition = blockEnd;
+
+    {
+        // the cancel mark never gets ahead of the write index, so it's read
+        // first: otherwise, a message scheduled and cancelled between the two
+        // reads would move the cancel mark past the write index snapshot
+        const auto cancelIndex = this->scheduledCancelIndex.get();
+        const auto writeIndex = this->scheduledWriteIndex.get();
+        auto readIndex = this->scheduledReadIndex.get();
+
+        if (int(cancelIndex - readIndex) > 0)
+        {
+            readIndex = cancelIndex;
+        }
+
+        while (int(writeIndex - readIndex) > 0)
+        {
+            const auto &scheduled = this->scheduledQueue[readIndex & (scheduledQueueSize - 1)];
+            if (scheduled.samplePosition >= blockEnd)
+            {
+                break;
+            }
+
+            // messages which came too late are played at the block start
+            const auto offset = jmax(int64(0), scheduled.samplePosition - blockStart);
+            this->incomingMidi.addEvent(scheduled.data, scheduled.size, int(offset));
+            readIndex++;
+        }
+
+        this->scheduledReadIndex = readIndex;
+    }
+
+    if (this->renderFrozenAudio(outputChannelData, numOutputChannels, numSamples, blockStart))
+    {
+        return;
+    }
+
+    auto *currentProcessor = this->processor.get();
+
+    // the fast path for the instruments with no audio inputs, e.g. synths:
+    // no need to copy the input channels into the output buffers
+    const bool needsInputs = numInputChannels > 0 &&
+        currentProcessor != nullptr && currentProcessor->getTotalNumInputChannels() > 0;
+
     int totalNumChans = 0;
 
-    if (numInputChannels > numOutputChannels)
+    if (!needsInputs)
+    {
+        for (int i = 0; i < numOutputChannels; ++i)
+        {
+            this->channels[totalNumChans] = outputChannelData[i];
+            FloatVectorOperations::clear(this->channels[totalNumChans], numSamples);
+            ++totalNumChans;
+        }
+    }
+    else if (numInputChannels > numOutputChannels)
     {
         this->tempBuffer.setSize(numInputChannels - numOutputChannels, numSamples, false, false, true);
 
@@ -868,17 +1161,159 @@ void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputC
 
     AudioBuffer<float> buffer(this->channels, totalNumChans, numSamples);
 
+    if (currentProcessor != nullptr)
     {
-        const ScopedLock sl(this->lock);
+        // the callback lock is only held by the offline renderer and
+        // while the graph is being suspended, and instead of waiting
+        // for it (and risking the priority inversion) we just skip the block
+        const ScopedTryLock sl(currentProcessor->getCallbackLock());
+
+        if (sl.isLocked() && !currentProcessor->isSuspended() &&
+            !this->updateSuspendedState(needsInputs ? inputChannelData : nullptr,
+                numInputChannels, numSamples))
+        {
+            currentProcessor->processBlock(buffer, this->incomingMidi);
+            this->updateSilenceState(outputChannelData, numOutputChannels, numSamples);
+            return;
+        }
+    }
+
+    this->carryOverUnprocessedMidi();
+
+    for (int i = 0; i < numOutputChannels; ++i)
+    {
+        FloatVectorOperations::clear(outputChannelData[i], numSamples);
+    }
+}
 
-        if (this->processor != nullptr)
+void Instrument::AudioCallback::carryOverUnprocessedMidi()
+{
+    for (const auto metadata : this->incomingMidi)
+    {
+        // playing the note-ons late would be worse than not playing them
+        const auto *data = metadata.data;
+        const bool isNoteOn = metadata.numBytes == 3 && (data[0] & 0xf0) == 0x90 && data[2] != 0;
+        if (isNoteOn)
         {
-            const ScopedLock sl2(this->processor->getCallbackLock());
+            continue;
+        }
 
-            if (!this->processor->isSuspended())
+        if (this->carriedOverMidi.getNumEvents() >= maxCarriedOverMessages)
+        {
+            this->needsAllNotesOff = true;
+            return;
+        }
+
+        this->carriedOverMidi.addEvent(data, metadata.numBytes, 0);
+    }
+}
+
+void Instrument::AudioCallback::addCarriedOverMidi()
+{
+    if (!this->carriedOverMidi.isEmpty())
+    {
+        this->incomingMidi.addEvents(this->carriedOverMidi, 0, -1, 0);
+        this->carriedOverMidi.clear();
+    }
+
+    if (this->needsAllNotesOff)
+    {
+        for (int channel = 1; channel <= 16; ++channel)
+        {
+            this->incomingMidi.addEvent(MidiMessage::allNotesOff(channel), 0);
+        }
+
+        this->needsAllNotesOff = false;
+    }
+}
+
+static constexpr auto idleSilenceThreshold = 0.00001f; // -100 dB
+
+static bool isSilent(const float *const *channelData, int numChannels, int numSamples) noexcept
+{
+    for (int i = 0; i < numChannels; ++i)
+    {
+        const auto range = FloatVectorOperations::findMinAndMax(channelData[i], numSamples);
+        if (jmax(range.getEnd(), -range.getStart()) > idleSilenceThreshold)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Instrument::AudioCallback::updateSuspendedState(const float **inputChannelData,
+    int numInputChannels, int numSamples)
+{
+    const auto timeoutSeconds = this->idleTimeoutSeconds.get();
+
+    const bool hasActivity = timeoutSeconds < 0.f ||
+        this->shouldWakeUp.exchange(false) ||
+        !this->incomingMidi.isEmpty() ||
+        (inputChannelData != nullptr && !isSilent(inputChannelData, numInputChannels, numSamples));
+
+    if (hasActivity)
+    {
+        this->numSilentSamples = 0;
+        this->suspended = false;
+        return false;
+    }
+
+    if (this->numSilentSamples >= int64(timeoutSeconds * this->sampleRate))
+    {
+        this->suspended = true;
+        return true;
+    }
+
+    return false;
+}
+
+void Instrument::AudioCallback::updateSilenceState(float **outputChannelData,
+    int numOutputChannels, int numSamples)
+{
+    if (this->idleTimeoutSeconds.get() < 0.f)
+    {
+        return;
+    }
+
+    if (isSilent(outputChannelData, numOutputChannels, numSamples))
+    {
+        this->numSilentSamples += numSamples;
+    }
+    else
+    {
+        this->numSilentSamples = 0;
+    }
+}
+
+bool Instrument::AudioCallback::renderFrozenAudio(float **outputChannelData,
+    int numOutputChannels, int numSamples, int64 blockStart)
+{
+    const auto *audio = this->frozenAudio.get();
+    if (audio == nullptr || audio->sampleRate != this->sampleRate)
+    {
+        return false;
+    }
+
+    // the seek commands are only picked up if the lock is free,
+    // otherwise, they will be in the next block
+    {
+        const SpinLock::ScopedTryLockType sl(this->frozenSeekLock);
+        if (sl.isLocked())
+        {
+            if (this->shouldStopFrozenAudio)
+            {
+                this->isFrozenAudioPlaying = false;
+                this->currentFrozenSeekPosition = -1;
+                this->shouldStopFrozenAudio = false;
+            }
+
+            if (this->nextFrozenSeekPosition >= 0)
             {
-                this->processor->processBlock(buffer, this->incomingMidi);
-                return;
+                this->currentFrozenSeekPosition = this->nextFrozenSeekPosition;
+                this->currentFrozenSeekFrame = this->nextFrozenSeekFrame;
+                this->nextFrozenSeekPosition = -1;
             }
         }
     }
@@ -887,6 +1322,176 @@ void Instrument::AudioCallback::audioDeviceIOCallback(const float** const inputC
     {
         FloatVectorOperations::clear(outputChannelData[i], numSamples);
     }
+
+    auto &reader = *audio->reader;
+    const auto numSourceChannels = jmin(numOutputChannels,
+        int(reader.numChannels), FrozenAudio::maxNumChannels);
+    float *destChannels[FrozenAudio::maxNumChannels];
+
+    // the block is split in two, if the pending seek happens within it
+    int start = 0;
+    while (start < numSamples)
+    {
+        int end = numSamples;
+        if (this->currentFrozenSeekPosition >= 0)
+        {
+            const auto seekOffset = this->currentFrozenSeekPosition - blockStart;
+            if (seekOffset <= start)
+            {
+                this->frozenFrameOffset = this->currentFrozenSeekFrame - this->currentFrozenSeekPosition;
+                this->isFrozenAudioPlaying = true;
+                this->currentFrozenSeekPosition = -1;
+            }
+            else if (seekOffset < numSamples)
+            {
+                end = int(seekOffset);
+            }
+        }
+
+        if (this->isFrozenAudioPlaying)
+        {
+            const auto frame = blockStart + start + this->frozenFrameOffset;
+            const auto from = jmax(int64(0), frame);
+            const auto to = jmin(reader.lengthInSamples, frame + (end - start));
+            if (to > from)
+            {
+                for (int i = 0; i < numSourceChannels; ++i)
+                {
+                    destChannels[i] = outputChannelData[i] + start + int(from - frame);
+                }
+
+                // the whole file is mapped, so this is just a copy
+                reader.read(destChannels, numSourceChannels, from, int(to - from));
+            }
+        }
+
+        start = end;
+    }
+
+    return true;
+}
+
+Instrument::AudioCallback::FrozenAudio::Ptr
+    Instrument::AudioCallback::FrozenAudio::loadFrom(const File &file, double startTimeMs)
+{
+    WavAudioFormat wavFormat;
+    UniquePointer<MemoryMappedAudioFormatReader> reader(wavFormat.createMemoryMappedReader(file));
+    if (reader == nullptr || !reader->usesFloatingPointData || !reader->mapEntireFile())
+    {
+        return nullptr;
+    }
+
+    FrozenAudio::Ptr audio(new FrozenAudio());
+    audio->file = file;
+    audio->sampleRate = reader->sampleRate;
+    audio->startTimeMs = startTimeMs;
+    audio->peaks = WaveformPeaks::loadFor(file);
+    audio->reader = move(reader);
+    return audio;
+}
+
+void Instrument::AudioCallback::setFrozenAudio(FrozenAudio::Ptr audio)
+{
+    FrozenAudio::Ptr oldOne;
+
+    {
+        const ScopedLock sl(this->lock);
+        oldOne = this->frozenAudioHolder;
+        this->frozenAudioHolder = audio;
+        this->frozenAudio = audio.get();
+        this->frozen = audio != nullptr;
+    }
+
+    this->stopFrozenAudio();
+
+    // the old buffer is released here, not in the audio thread
+    this->waitForCallbackToFinish();
+    oldOne = nullptr;
+}
+
+Instrument::AudioCallback::FrozenAudio::Ptr Instrument::AudioCallback::getFrozenAudio() const
+{
+    const ScopedLock sl(this->lock);
+    return this->frozenAudioHolder;
+}
+
+void Instrument::AudioCallback::seekFrozenAudio(int64 position, int64 frame)
+{
+    const SpinLock::ScopedLockType sl(this->frozenSeekLock);
+    this->nextFrozenSeekPosition = position;
+    this->nextFrozenSeekFrame = frame;
+}
+
+void Instrument::AudioCallback::stopFrozenAudio()
+{
+    const SpinLock::ScopedLockType sl(this->frozenSeekLock);
+    this->shouldStopFrozenAudio = true;
+    this->nextFrozenSeekPosition = -1;
+}
+
+bool Instrument::AudioCallback::scheduleMessage(const MidiMessage &message, int64 position)
+{
+    const auto size = message.getRawDataSize();
+    if (size > int(sizeof(ScheduledMessage::data)))
+    {
+        return false;
+    }
+
+    const SpinLock::ScopedLockType sl(this->scheduledProducerLock);
+
+    // the player sends the messages in time order, so the audio
+    // thread can stop draining at the first message of a future block
+    const auto writeIndex = this->scheduledWriteIndex.get();
+    if (writeIndex - this->scheduledReadIndex.get() >= scheduledQueueSize)
+    {
+        return false;
+    }
+
+    auto &scheduled = this->scheduledQueue[writeIndex & (scheduledQueueSize - 1)];
+    scheduled.samplePosition = position;
+    scheduled.size = uint8(size);
+    memcpy(scheduled.data, message.getRawData(), size_t(size));
+
+    this->scheduledWriteIndex = writeIndex + 1;
+
+    // wake up ahead of time, so that the processor
+    // has a few blocks to settle before the message
+    this->shouldWakeUp = true;
+    return true;
+}
+
+void Instrument::AudioCallback::cancelScheduledMessages()
+{
+    // both indices are only written under the producer lock, and the cancel
+    // mark is only set to an already published write index, so it never gets
+    // ahead of the write index, which the audio thread relies on when draining
+    const SpinLock::ScopedLockType sl(this->scheduledProducerLock);
+    this->scheduledCancelIndex = this->scheduledWriteIndex.get();
+}
+
+bool Instrument::AudioCallback::waitForMessagesFlush(int timeoutMs) const
+{
+    const auto deadline = Time::getMillisecondCounter() + uint32(timeoutMs);
+
+    // the block which is being processed right now might
+    // have been started before the messages were queued,
+    // so we need to see the sample clock advance twice
+    for (int i = 0; i < 2; ++i)
+    {
+        const auto lastPosition = this->samplePosition.get();
+        while (this->samplePosition.get() == lastPosition)
+        {
+            if (this->sampleRate <= 0.0 ||
+                int(deadline - Time::getMillisecondCounter()) <= 0)
+            {
+                return false;
+            }
+
+            Thread::sleep(1);
+        }
+    }
+
+    return true;
 }
 
 void Instrument::AudioCallback::audioDeviceAboutToStart(AudioIODevice *const device)
@@ -904,16 +1509,19 @@ void Instrument::AudioCallback::audioDeviceAboutToStart(AudioIODevice *const dev
     this->numOutputChans = numChansOut;
 
     this->messageCollector.reset(sampleRate);
+    this->lastBlockStartSeconds = 0.0;
+    this->carriedOverMidi.ensureSize(maxCarriedOverMessages * 16);
     this->channels.calloc(jmax(numChansIn, numChansOut) + 2);
 
-    if (this->processor != nullptr)
+    this->updateCompensationDelay();
+
+    if (auto *oldProcessor = this->processor.get())
     {
         if (this->isPrepared)
         {
-            this->processor->releaseResources();
+            oldProcessor->releaseResources();
         }
 
-        auto *oldProcessor = this->processor;
         this->setProcessor(nullptr);
         this->setProcessor(oldProcessor);
     }
@@ -923,9 +1531,9 @@ void Instrument::AudioCallback::audioDeviceStopped()
 {
     const ScopedLock sl(this->lock);
 
-    if (this->processor != nullptr && this->isPrepared)
+    if (this->processor.get() != nullptr && this->isPrepared)
     {
-        this->processor->releaseResources();
+        this->processor.get()->releaseResources();
     }
 
     this->sampleRate = 0.0;
@@ -936,5 +1544,68 @@ void Instrument::AudioCallback::audioDeviceStopped()
 
 void Instrument::AudioCallback::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
 {
-    this->messageCollector.addMessageToQueue(message);
+    const auto size = message.getRawDataSize();
+    if (size > int(sizeof(LiveMessage::data)))
+    {
+        // sysex and such are rare, and not timing-critical
+        this->messageCollector.addMessageToQueue(message);
+        this->sleeping = false;
+        return;
+    }
+
+    {
+        const SpinLock::ScopedLockType sl(this->liveProducerLock);
+
+        const auto writeIndex = this->liveWriteIndex.get();
+        if (writeIndex - this->liveReadIndex.get() >= liveQueueSize)
+        {
+            return; // the audio thread is stuck, dropping the input is fine
+        }
+
+        auto &live = this->liveQueue[writeIndex & (liveQueueSize - 1)];
+        live.timeStamp = message.getTimeStamp();
+        live.size = uint8(size);
+        memcpy(live.data, message.getRawData(), size_t(size));
+
+        this->liveWriteIndex = writeIndex + 1;
+    }
+
+    this->sleeping = false;
+}
+
+void Instrument::AudioCallback::readLiveMessages(int numSamples)
+{
+    const auto blockStartSeconds = Time::getMillisecondCounterHiRes() * 0.001;
+    const auto previousBlockSeconds = blockStartSeconds - this->lastBlockStartSeconds;
+    const auto previousBlockStartSeconds = this->lastBlockStartSeconds;
+    this->lastBlockStartSeconds = blockStartSeconds;
+
+    const auto writeIndex = this->liveWriteIndex.get();
+    auto readIndex = this->liveReadIndex.get();
+    if (readIndex == writeIndex)
+    {
+        return;
+    }
+
+    // the previous block is unknown after the device restart or sleeping,
+    // and then the messages just go to the start of this block
+    const bool hasPreviousBlock = previousBlockSeconds > 0.0 &&
+        previousBlockSeconds < 4.0 * numSamples / this->sampleRate;
+
+    while (readIndex != writeIndex)
+    {
+        const auto &live = this->liveQueue[readIndex & (liveQueueSize - 1)];
+
+        int offset = 0;
+        if (hasPreviousBlock)
+        {
+            offset = jlimit(0, numSamples - 1, int((live.timeStamp - previousBlockStartSeconds) /
+                previousBlockSeconds * double(numSamples)));
+        }
+
+        this->incomingMidi.addEvent(live.data, live.size, offset);
+        readIndex++;
+    }
+
+    this->liveReadIndex = readIndex;
 }
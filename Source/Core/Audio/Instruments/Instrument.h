@@ -19,6 +19,9 @@
 
 class KeyboardMapping;
 
+#include "CompensationDelay.h"
+#include "WaveformPeaks.h"
+
 class Instrument final :
     public Serializable,
     public ChangeBroadcaster // notifies InstrumentEditor
@@ -35,9 +38,18 @@ public:
     String getIdAndHash() const;
     bool isValid() const noexcept;
 
+    // true while the deserialized nodes are being created asynchronously,
+    // and the graph is not wired up yet, so it shouldn't be rendered
+    bool isLoading() const noexcept;
+
     bool isDefaultInstrument() const noexcept;
     bool isMetronomeInstrument() const noexcept;
 
+    // true if anything is connected to the graph's MIDI output node:
+    // the player sends the events of such instruments to the hardware
+    // MIDI output directly, see AudioCore::getMidiOutput
+    bool isRoutedToMidiOutput() const;
+
     using InitializationCallback = Function<void(Instrument *)>;
 
     void initializeFrom(const PluginDescription &pluginDescription, InitializationCallback initCallback);
@@ -55,11 +67,121 @@ public:
         void audioDeviceIOCallback(const float **, int, float **, int, int) override;
         void audioDeviceAboutToStart(AudioIODevice *) override;
         void audioDeviceStopped() override;
+
+        // the live input from the MIDI devices goes through a ring of its own,
+        // apart from the message collector and the scheduled messages, so that
+        // playing along never contends with the player thread; the messages
+        // are placed into the next block at the same offsets, at which they
+        // arrived during the previous one, so the timing is kept intact
         void handleIncomingMidiMessage(MidiInput *, const MidiMessage&) override;
 
+        // the sample clock is the number of samples processed since
+        // the device has started; the player thread schedules messages
+        // ahead of time at the absolute positions of this clock,
+        // and they are placed into the blocks with exact sample offsets
+        int64 getSamplePosition() const noexcept { return this->samplePosition.get(); }
+        double getSampleRate() const noexcept { return this->sampleRate; }
+
+        // the scheduled messages go through a single-producer/single-consumer
+        // ring, so the audio thread never waits for a lock to drain them;
+        // returns false if the message is too long or the ring is full,
+        // in which case the caller should use the message collector instead
+        bool scheduleMessage(const MidiMessage &message, int64 samplePosition);
+        void cancelScheduledMessages();
+
+        // waits until the audio thread starts a block after everything
+        // queued before this call is processed, e.g. to make sure
+        // the playback stop messages are delivered; returns false
+        // on timeout, which happens if the device has stopped
+        bool waitForMessagesFlush(int timeoutMs) const;
+
+        // The pre-rendered output of a frozen instrument: while it is set,
+        // the processor is bypassed, the incoming messages are ignored, and
+        // the player thread tells which frame of the audio is played at which
+        // position of the sample clock; frame 0 is at startTimeMs of the timeline;
+        // the audio is memory-mapped from the cached file instead of being kept
+        // in the heap, so that the system can page it out when it's not played
+        struct FrozenAudio final : public ReferenceCountedObject
+        {
+            using Ptr = ReferenceCountedObjectPtr<FrozenAudio>;
+
+            // expects a 32-bit float WAV, which is read without conversion;
+            // returns nullptr if the file is missing or cannot be mapped
+            static FrozenAudio::Ptr loadFrom(const File &file, double startTimeMs);
+
+            File file;
+            UniquePointer<MemoryMappedAudioFormatReader> reader;
+            double sampleRate = 0.0;
+            double startTimeMs = 0.0;
+            WaveformPeaks::Ptr peaks; // for drawing
+
+            static constexpr auto maxNumChannels = 64;
+        };
+
+        void setFrozenAudio(FrozenAudio::Ptr audio);
+        FrozenAudio::Ptr getFrozenAudio() const;
+        bool isFrozen() const noexcept { return this->frozen.get(); }
+
+        void seekFrozenAudio(int64 samplePosition, int64 frame);
+        void stopFrozenAudio();
+
+        // how long the output is delayed to match the slowest instrument
+        void setLatencyCompensation(int numSamples);
+        int getLatencyCompensation() const noexcept { return this->latencyCompensation.get(); }
+
+        // after being silent for that long, while receiving no messages and
+        // no audio input, the processor is suspended, i.e. skips its blocks,
+        // until any of these arrive; a negative timeout disables that
+        void setIdleTimeout(float seconds) noexcept { this->idleTimeoutSeconds = seconds; }
+        bool isSuspended() const noexcept { return this->suspended.get(); }
+
+        // the lighter version of disconnecting the callback from the device:
+        // while sleeping, it stays registered, but outputs silence without
+        // running the processor, so waking up is instant; any MIDI input
+        // or a scheduled message also wakes it up
+        void setSleeping(bool shouldSleep) noexcept { this->sleeping = shouldSleep; }
+        bool isSleeping() const noexcept { return this->sleeping.get(); }
+
+        // the processing time of the blocks, measured by the audio thread
+        // and read without locks, to find the instruments causing dropouts;
+        // the load is the time spent on a block relative to its duration,
+        // so the blocks with the load above 1 are the overruns
+        struct Load final
+        {
+            float averageMs = 0.f;
+            float maxMs = 0.f;
+            float averageLoad = 0.f;
+            float maxLoad = 0.f;
+            int numOverruns = 0;
+        };
+
+        Load getLoad() const noexcept;
+        void resetLoad() noexcept { this->shouldResetLoad = true; }
+
     private:
 
-        AudioProcessor *processor = nullptr;
+        // returns true if the block can be skipped
+        bool updateSuspendedState(const float **inputChannelData,
+            int numInputChannels, int numSamples);
+        void updateSilenceState(float **outputChannelData,
+            int numOutputChannels, int numSamples);
+
+        void updateCompensationDelay();
+
+        void processNextBlock(const float **inputChannelData, int numInputChannels,
+            float **outputChannelData, int numOutputChannels, int numSamples);
+
+        // returns false if not frozen
+        bool renderFrozenAudio(float **outputChannelData,
+            int numOutputChannels, int numSamples, int64 blockStart);
+
+        // the processor is swapped atomically, and the old one
+        // is only released when the audio thread is done with it
+        Atomic<AudioProcessor *> processor = nullptr;
+        Atomic<bool> isInsideCallback = false;
+        void waitForCallbackToFinish() const;
+
+        // serializes the setup changes, never taken by the audio thread
         CriticalSection lock;
         double sampleRate = 0;
         int blockSize = 0;
@@ -73,6 +195,96 @@ public:
         MidiBuffer incomingMidi;
         MidiMessageCollector messageCollector;
 
+        struct ScheduledMessage final
+        {
+            int64 samplePosition;
+            uint8 data[6]; // enough for short messages and tempo meta events
+            uint8 size;
+        };
+
+        static constexpr uint32 scheduledQueueSize = 4096; // a power of two
+        HeapBlock<ScheduledMessage> scheduledQueue { scheduledQueueSize };
+
+        // both indices are ever-increasing, and each one only has one writer:
+        // the write index is advanced by the player, the read index by the
+        // audio thread; cancelling only moves the cancel mark forward, which
+        // the audio thread then uses to skip everything scheduled before it
+        Atomic<uint32> scheduledWriteIndex = 0;
+        Atomic<uint32> scheduledReadIndex = 0;
+        Atomic<uint32> scheduledCancelIndex = 0;
+
+        // only serializes the producers, e.g. a stopping player thread
+        // and the new one, the audio thread never takes it
+        SpinLock scheduledProducerLock;
+
+        struct LiveMessage final
+        {
+            double timeStamp; // in seconds, see Time::getMillisecondCounterHiRes
+            uint8 data[3];
+            uint8 size;
+        };
+
+        static constexpr uint32 liveQueueSize = 512; // a power of two
+        HeapBlock<LiveMessage> liveQueue { liveQueueSize };
+        Atomic<uint32> liveWriteIndex = 0;
+        Atomic<uint32> liveReadIndex = 0;
+
+        // several devices may send messages at once
+        SpinLock liveProducerLock;
+
+        // only used by the audio thread
+        double lastBlockStartSeconds = 0.0;
+        void readLiveMessages(int numSamples);
+
+        // when a block is skipped, e.g. while the offline renderer holds
+        // the processor's callback lock, its messages are already drained,
+        // so everything except the note-ons is played in the next processed
+        // block, to avoid the stuck notes; the buffer is preallocated, and
+        // if it overflows, all notes are turned off instead
+        MidiBuffer carriedOverMidi;
+        bool needsAllNotesOff = false;
+        static constexpr auto maxCarriedOverMessages = 256;
+        void carryOverUnprocessedMidi();
+        void addCarriedOverMidi();
+
+        Atomic<int64> samplePosition = 0;
+
+        Atomic<bool> frozen = false;
+        FrozenAudio::Ptr frozenAudioHolder;
+        Atomic<FrozenAudio *> frozenAudio = nullptr;
+
+        // the seek commands from the player thread
+        SpinLock frozenSeekLock;
+        int64 nextFrozenSeekPosition = -1;
+        int64 nextFrozenSeekFrame = 0;
+        bool shouldStopFrozenAudio = false;
+
+        // only used by the audio thread
+        bool isFrozenAudioPlaying = false;
+        int64 frozenFrameOffset = 0; // the frame minus the sample position
+        int64 currentFrozenSeekPosition = -1;
+        int64 currentFrozenSeekFrame = 0;
+
+        // swapped the same way as the processor
+        Atomic<int> latencyCompensation = 0;
+        UniquePointer<CompensationDelay<float>> compensationDelayHolder;
+        Atomic<CompensationDelay<float> *> compensationDelay = nullptr;
+
+        Atomic<float> idleTimeoutSeconds = -1.f;
+        Atomic<bool> suspended = false;
+        Atomic<bool> shouldWakeUp = false; // a message is scheduled
+        Atomic<bool> sleeping = false;
+        int64 numSilentSamples = 0; // only used by the audio thread
+
+        // only written by the audio thread, the reset is just a request
+        void updateLoad(int64 startTicks, int numSamples) noexcept;
+        Atomic<float> averageProcessingMs = 0.f;
+        Atomic<float> maxProcessingMs = 0.f;
+        Atomic<float> averageLoad = 0.f;
+        Atomic<float> maxLoad = 0.f;
+        Atomic<int> numOverruns = 0;
+        Atomic<bool> shouldResetLoad = false;
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioCallback)
     };
 
@@ -116,6 +328,11 @@ public:
     bool isNodeStandardIOProcessor(AudioProcessorGraph::NodeID nodeId) const;
     bool isNodeStandardIOProcessor(AudioProcessorGraph::Node::Ptr node) const;
 
+    // the longest path of the nodes' reported latencies up to the audio output,
+    // the graph itself lines up the parallel paths, but the instruments
+    // are lined up with each other by the audio core, see CompensationDelay
+    int getLatencySamples() const;
+
     // Standard IO nodes included:
     Array<AudioProcessorGraph::Node::Ptr> findMidiAcceptors() const;
     Array<AudioProcessorGraph::Node::Ptr> findMidiProducers() const;
@@ -183,6 +400,10 @@ private:
 
     SerializedData lastValidStateFallback;
 
+    // the deserializations which haven't finished yet; only accessed
+    // on the message thread, where the async nodes are created
+    int numPendingDeserializations = 0;
+
 private:
 
     UniquePointer<KeyboardMapping> keyboardMapping;
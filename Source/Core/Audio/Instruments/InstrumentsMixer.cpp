@@ -0,0 +1,319 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "InstrumentsMixer.h"
+
+class InstrumentsMixer::Worker final : public Thread
+{
+public:
+
+    explicit Worker(InstrumentsMixer &mixer) :
+        Thread("InstrumentsMixerWorker"), mixer(mixer) {}
+
+    void run() override
+    {
+        while (!this->threadShouldExit())
+        {
+            if (this->blockStarted.wait(100) && !this->threadShouldExit())
+            {
+                REALTIME_SCOPE();
+                this->mixer.processPendingChannels();
+            }
+        }
+    }
+
+    InstrumentsMixer &mixer;
+    WaitableEvent blockStarted;
+};
+
+InstrumentsMixer::InstrumentsMixer() = default;
+
+InstrumentsMixer::~InstrumentsMixer()
+{
+    jassert(this->channels.isEmpty());
+
+    // the channels are only deleted when the audio thread can't see them
+    OwnedArray<Channel> removedChannels;
+
+    {
+        const ScopedLock sl(this->lock);
+        removedChannels.swapWith(this->channels);
+    }
+
+    this->updateWorkers();
+}
+
+void InstrumentsMixer::addCallback(AudioIODeviceCallback *callback)
+{
+    jassert(callback != nullptr);
+
+    {
+        const ScopedLock sl(this->lock);
+        for (const auto *channel : this->channels)
+        {
+            if (channel->callback == callback)
+            {
+                return;
+            }
+        }
+    }
+
+    // same as the device manager does, it is prepared before being added,
+    // and the device can only be restarted from the message thread
+    if (this->currentDevice != nullptr)
+    {
+        callback->audioDeviceAboutToStart(this->currentDevice);
+    }
+
+    auto channel = make<Channel>();
+    channel->callback = callback;
+    this->prepareChannel(*channel);
+
+    {
+        const ScopedLock sl(this->lock);
+        // the channel index is packed into 16 bits, see nextWork
+        jassert(this->channels.size() < 0xffff);
+        this->channels.add(channel.release());
+    }
+
+    this->updateWorkers();
+}
+
+void InstrumentsMixer::removeCallback(AudioIODeviceCallback *callback)
+{
+    UniquePointer<Channel> removedChannel;
+
+    {
+        const ScopedLock sl(this->lock);
+        for (int i = 0; i < this->channels.size(); ++i)
+        {
+            if (this->channels.getUnchecked(i)->callback == callback)
+            {
+                removedChannel.reset(this->channels.removeAndReturn(i));
+                break;
+            }
+        }
+    }
+
+    if (removedChannel != nullptr)
+    {
+        // publishes the snapshot without the channel and waits
+        // until the audio thread is done with the old one
+        this->updateWorkers();
+
+        if (this->currentDevice != nullptr)
+        {
+            callback->audioDeviceStopped();
+        }
+    }
+}
+
+// the calling thread is also processing, so it needs one worker less
+void InstrumentsMixer::updateWorkers()
+{
+    const auto numWorkersNeeded = jlimit(0,
+        SystemStats::getNumCpus() - 1, this->channels.size() - 1);
+
+    OwnedArray<Worker> removedWorkers;
+    while (this->workers.size() > numWorkersNeeded)
+    {
+        removedWorkers.add(this->workers.removeAndReturn(this->workers.size() - 1));
+    }
+
+    while (this->workers.size() < numWorkersNeeded)
+    {
+        auto worker = make<Worker>(*this);
+        worker->startThread(10);
+        this->workers.add(worker.release());
+    }
+
+    this->publishSnapshot();
+
+    for (auto *worker : removedWorkers)
+    {
+        worker->signalThreadShouldExit();
+        worker->blockStarted.signal();
+        worker->stopThread(1000);
+    }
+}
+
+void InstrumentsMixer::publishSnapshot()
+{
+    auto newSnapshot = make<Snapshot>();
+
+    {
+        const ScopedLock sl(this->lock);
+        newSnapshot->channels.addArray(this->channels);
+    }
+
+    newSnapshot->workers.addArray(this->workers);
+
+    UniquePointer<Snapshot> oldSnapshot(this->snapshot.release());
+    this->snapshot = move(newSnapshot);
+    this->currentSnapshot = this->snapshot.get();
+
+    // the audio thread might still be processing a block with the old one,
+    // and it can't pick it up again, see audioDeviceIOCallback
+    while (oldSnapshot != nullptr && this->snapshotInUse.get() == oldSnapshot.get())
+    {
+        Thread::sleep(1);
+    }
+}
+
+void InstrumentsMixer::prepareChannel(Channel &channel) const
+{
+    channel.outputBuffer.setSize(jmax(1, this->numOutputChannels),
+        jmax(1, this->blockSize), false, true, false);
+}
+
+//===----------------------------------------------------------------------===//
+// AudioIODeviceCallback
+//===----------------------------------------------------------------------===//
+
+void InstrumentsMixer::audioDeviceIOCallback(const float **inputChannelData,
+    int numInputChannels, float **outputChannelData, int numOutputChannels, int numSamples)
+{
+    REALTIME_SCOPE();
+
+    for (int i = 0; i < numOutputChannels; ++i)
+    {
+        FloatVectorOperations::clear(outputChannelData[i], numSamples);
+    }
+
+    // the snapshot is marked as used first, and then checked to be still
+    // the current one, so that if the message thread has replaced it in
+    // the meantime, and might have already deleted it, it's not used
+    Snapshot *snapshot = nullptr;
+    do
+    {
+        snapshot = this->currentSnapshot.get();
+        this->snapshotInUse = snapshot;
+    } while (snapshot != this->currentSnapshot.get());
+
+    if (snapshot != nullptr && !snapshot->channels.isEmpty())
+    {
+        this->processBlock(*snapshot, inputChannelData, numInputChannels,
+            outputChannelData, numOutputChannels, numSamples);
+    }
+
+    this->snapshotInUse = nullptr;
+}
+
+void InstrumentsMixer::processBlock(const Snapshot &snapshot, const float **inputChannelData,
+    int numInputChannels, float **outputChannelData, int numOutputChannels, int numSamples)
+{
+    this->blockSnapshot = &snapshot;
+    this->currentInputs = inputChannelData;
+    this->currentNumInputs = numInputChannels;
+    this->currentNumOutputs = numOutputChannels;
+    this->currentNumSamples = numSamples;
+
+    for (auto *channel : snapshot.channels)
+    {
+        // should not normally happen, the device's block size is fixed
+        if (channel->outputBuffer.getNumChannels() < numOutputChannels ||
+            channel->outputBuffer.getNumSamples() < numSamples)
+        {
+            channel->outputBuffer.setSize(numOutputChannels, numSamples, false, false, true);
+        }
+    }
+
+    const auto numChannels = snapshot.channels.size();
+    this->numProcessedChannels = 0;
+    this->blockGeneration++;
+    this->nextWork = (uint64(this->blockGeneration) << 32) | (uint64(numChannels) << 16);
+
+    for (auto *worker : snapshot.workers)
+    {
+        worker->blockStarted.signal();
+    }
+
+    this->processPendingChannels();
+
+    while (this->numProcessedChannels.get() < numChannels)
+    {
+        this->blockFinished.wait(1);
+    }
+
+    for (const auto *channel : snapshot.channels)
+    {
+        for (int i = 0; i < numOutputChannels; ++i)
+        {
+            FloatVectorOperations::add(outputChannelData[i],
+                channel->outputBuffer.getReadPointer(i), numSamples);
+        }
+    }
+}
+
+void InstrumentsMixer::processPendingChannels()
+{
+    while (true)
+    {
+        // the claim only succeeds while the block it was read from is
+        // still in progress, and then the block state is stable
+        const auto work = this->nextWork.get();
+        const auto numChannels = int((work >> 16) & 0xffff);
+        const auto index = int(work & 0xffff);
+        if (index >= numChannels)
+        {
+            return;
+        }
+
+        if (!this->nextWork.compareAndSetBool(work + 1, work))
+        {
+            continue;
+        }
+
+        auto *channel = this->blockSnapshot->channels.getUnchecked(index);
+        channel->callback->audioDeviceIOCallback(this->currentInputs, this->currentNumInputs,
+            channel->outputBuffer.getArrayOfWritePointers(),
+            this->currentNumOutputs, this->currentNumSamples);
+
+        if (++this->numProcessedChannels == numChannels)
+        {
+            this->blockFinished.signal();
+        }
+    }
+}
+
+void InstrumentsMixer::audioDeviceAboutToStart(AudioIODevice *device)
+{
+    const ScopedLock sl(this->lock);
+
+    this->currentDevice = device;
+    this->numOutputChannels = device->getActiveOutputChannels().countNumberOfSetBits();
+    this->blockSize = device->getCurrentBufferSizeSamples();
+
+    for (auto *channel : this->channels)
+    {
+        this->prepareChannel(*channel);
+        channel->callback->audioDeviceAboutToStart(device);
+    }
+}
+
+void InstrumentsMixer::audioDeviceStopped()
+{
+    const ScopedLock sl(this->lock);
+
+    for (auto *channel : this->channels)
+    {
+        channel->callback->audioDeviceStopped();
+    }
+
+    this->currentDevice = nullptr;
+}
@@ -0,0 +1,110 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// When each instrument's callback is registered in the device manager,
+// they are called one after another on the device thread, so the playback
+// of many heavy instruments is bound to a single core; this class is the
+// only device callback instead, and it processes the instruments' blocks
+// in parallel with a pool of high-priority workers, then sums them up
+class InstrumentsMixer final : public AudioIODeviceCallback
+{
+public:
+
+    InstrumentsMixer();
+    ~InstrumentsMixer() override;
+
+    void addCallback(AudioIODeviceCallback *callback);
+    void removeCallback(AudioIODeviceCallback *callback);
+
+    //===------------------------------------------------------------------===//
+    // AudioIODeviceCallback
+    //===------------------------------------------------------------------===//
+
+    void audioDeviceIOCallback(const float **inputChannelData, int numInputChannels,
+        float **outputChannelData, int numOutputChannels, int numSamples) override;
+    void audioDeviceAboutToStart(AudioIODevice *device) override;
+    void audioDeviceStopped() override;
+
+private:
+
+    struct Channel final
+    {
+        AudioIODeviceCallback *callback = nullptr;
+        AudioBuffer<float> outputBuffer;
+    };
+
+    class Worker;
+
+    // an immutable list of the channels and the workers, which the audio
+    // thread picks up at the start of each block without taking any locks;
+    // the message thread publishes a new one on every change, and deletes
+    // the old one, and whatever was removed, when it's no longer in use
+    struct Snapshot final
+    {
+        Array<Channel *> channels;
+        Array<Worker *> workers;
+    };
+
+    void publishSnapshot();
+
+    void processBlock(const Snapshot &snapshot, const float **inputChannelData,
+        int numInputChannels, float **outputChannelData, int numOutputChannels, int numSamples);
+    void processPendingChannels();
+
+    void prepareChannel(Channel &channel) const;
+
+    OwnedArray<Worker> workers;
+    void updateWorkers();
+
+    // the channels and the device state are only modified under this lock,
+    // which is only taken by the message thread and the device start/stop
+    // notifications, but never by the audio callback
+    CriticalSection lock;
+
+    OwnedArray<Channel> channels;
+
+    AudioIODevice *currentDevice = nullptr;
+    int numOutputChannels = 0;
+    int blockSize = 0;
+
+    // only accessed by the message thread
+    UniquePointer<Snapshot> snapshot;
+
+    Atomic<Snapshot *> currentSnapshot = nullptr;
+    Atomic<Snapshot *> snapshotInUse = nullptr;
+
+    // the block currently being processed, written by the audio thread
+    // before the block is published in nextWork, and stable until
+    // all of its channels are processed
+    const Snapshot *blockSnapshot = nullptr;
+    const float **currentInputs = nullptr;
+    int currentNumInputs = 0;
+    int currentNumOutputs = 0;
+    int currentNumSamples = 0;
+
+    // the block generation, the number of channels and the next channel index
+    // packed together, so that a worker which wakes up late can only claim
+    // a channel of the block which is still being processed
+    Atomic<uint64> nextWork = 0;
+    Atomic<int> numProcessedChannels = 0;
+    uint32 blockGeneration = 0;
+    WaitableEvent blockFinished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InstrumentsMixer)
+};
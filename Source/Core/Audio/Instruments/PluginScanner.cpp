@@ -107,6 +107,8 @@ void PluginScanner::runInitialScan()
         return;
     }
 
+    this->loadPendingScanCache();
+
     if (!this->isThreadRunning())
     {
         this->startThread(0);
@@ -155,6 +157,8 @@ void PluginScanner::scanFolderAndAddResults(const File &dir)
         return;
     }
 
+    this->loadPendingScanCache();
+
     if (!this->isThreadRunning())
     {
         this->startThread(0);
@@ -212,112 +216,323 @@ void PluginScanner::run()
             }
         }
 
-        try
+        StringArray filesToCheck;
+        for (const auto &pluginPath : this->filesToScan)
         {
-            const auto myPath(File::getSpecialLocation(File::currentExecutableFile).getFullPathName());
-
-            for (const auto &pluginPath : this->filesToScan)
+            if (!this->addCachedTypes(pluginPath))
             {
-                if (this->cancelled.get())
-                {
-                    DBG("Plugin scanning canceled");
-                    break;
-                }
+                filesToCheck.addIfNotAlreadyThere(pluginPath);
+            }
+        }
+
+        DBG("Plugin files to check: " + String(filesToCheck.size()) +
+            ", unchanged: " + String(this->filesToScan.size() - filesToCheck.size()));
 
+        this->sendChangeMessage();
+
+        try
+        {
 #if SAFE_SCAN
-                DBG("Safe scanning: " + pluginPath);
+            this->checkFilesInChildProcesses(filesToCheck);
+#else
+            this->checkFilesInProcess(filesToCheck, formatManager);
+#endif
+        }
+        catch (...) {}
 
-                const Uuid tempFileName;
-                const File tempFile(DocumentHelpers::getTempSlot(tempFileName.toString()));
-                tempFile.appendText(pluginPath, false, false);
+        {
+            this->cancelled = false;
+            this->working = false;
+            
+            DBG("Done scanning for audio plugins");
+            this->sendChangeMessage();
+        }
+        
+        WaitableEvent::wait();
+    }
+}
 
-                Thread::sleep(50);
+// runs the app itself in the plugin check mode, see App::checkPlugin:
+// it reads the plugin path from the temp file, deletes it right away,
+// and writes the found types into it, if it hasn't crashed
+class PluginScanner::CheckerProcess final
+{
+public:
 
-                ChildProcess checkerProcess;
-                const String commandLine(myPath + " " + tempFileName.toString());
-                checkerProcess.start(commandLine);
+    CheckerProcess(const String &executablePath, const String &pluginPath) :
+        pluginPath(pluginPath),
+        tempFile(DocumentHelpers::getTempSlot(tempFileName.toString()))
+    {
+        this->tempFile.appendText(pluginPath, false, false);
+        this->process.start(executablePath + " " + this->tempFileName.toString());
+    }
 
-                if (!checkerProcess.waitForProcessToFinish(60000))
-                {
-                    checkerProcess.kill();
-                }
-                else
-                {
-                    if (this->cancelled.get())
-                    {
-                        DBG("Plugin scanning canceled");
-                        tempFile.deleteFile();
-                        break;
-                    }
+    ~CheckerProcess()
+    {
+        if (this->process.isRunning())
+        {
+            this->process.kill();
+        }
 
-                    Thread::sleep(50);
+        this->tempFile.deleteFile();
+    }
 
-                    if (tempFile.existsAsFile())
-                    {
-                        try
-                        {
-                            const auto tree(DocumentHelpers::load<XmlSerializer>(tempFile));
-                            if (tree.isValid())
-                            {
-                                forEachChildWithType(tree, e, Serialization::Audio::plugin)
-                                {
-                                    SerializablePluginDescription pluginDescription;
-                                    pluginDescription.deserialize(e);
-                                    this->pluginsList.addType(pluginDescription);
-                                }
-                                    
-                                this->sendChangeMessage();
-                            }
-                        }
-                        catch (...) {}
-                    }
-                }
+    const String &getPluginPath() const noexcept
+    {
+        return this->pluginPath;
+    }
 
-                tempFile.deleteFile();
-#else
-                DBG("Unsafe scanning: " + pluginPath);
+    bool isRunning() const
+    {
+        return this->process.isRunning();
+    }
+
+    bool isTimedOut() const noexcept
+    {
+        return int(Time::getMillisecondCounter() - this->startTimeMs) > PluginScanner::checkerTimeoutMs;
+    }
+
+    Array<PluginDescription> readResults() const
+    {
+        Array<PluginDescription> types;
 
-                KnownPluginList knownPluginList;
-                OwnedArray<PluginDescription> typesFound;
-                    
-                try
+        if (this->tempFile.existsAsFile())
+        {
+            try
+            {
+                const auto tree(DocumentHelpers::load<XmlSerializer>(this->tempFile));
+                if (tree.isValid())
                 {
-                    for (int j = 0; j < formatManager.getNumFormats(); ++j)
+                    forEachChildWithType(tree, e, Serialization::Audio::plugin)
                     {
-                        AudioPluginFormat *format = formatManager.getFormat(j);
-                        knownPluginList.scanAndAddFile(pluginPath, false, typesFound, *format);
+                        SerializablePluginDescription pluginDescription;
+                        pluginDescription.deserialize(e);
+                        types.add(pluginDescription);
                     }
                 }
-                catch (...) {}
-                    
-                // at this point we are still alive and plugin haven't crashed the app
-                if (typesFound.size() != 0)
+            }
+            catch (...) {}
+        }
+
+        return types;
+    }
+
+private:
+
+    const String pluginPath;
+    const Uuid tempFileName;
+    const File tempFile;
+    const uint32 startTimeMs = Time::getMillisecondCounter();
+
+    mutable ChildProcess process;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CheckerProcess)
+};
+
+void PluginScanner::checkFilesInChildProcesses(const StringArray &files)
+{
+    const auto myPath(File::getSpecialLocation(File::currentExecutableFile).getFullPathName());
+    const auto numProcesses = jlimit(1, PluginScanner::maxNumCheckerProcesses, SystemStats::getNumCpus());
+
+    OwnedArray<CheckerProcess> checkers;
+    int nextFileIndex = 0;
+
+    // the remaining checkers are killed when deleted
+    while (!this->threadShouldExit() && !this->cancelled.get())
+    {
+        while (checkers.size() < numProcesses && nextFileIndex < files.size())
+        {
+            DBG("Safe scanning: " + files[nextFileIndex]);
+            checkers.add(new CheckerProcess(myPath, files[nextFileIndex++]));
+        }
+
+        if (checkers.isEmpty())
+        {
+            break;
+        }
+
+        bool hasNewTypes = false;
+
+        for (int i = checkers.size(); --i >= 0;)
+        {
+            const auto *checker = checkers.getUnchecked(i);
+            if (checker->isRunning() && !checker->isTimedOut())
+            {
+                continue;
+            }
+
+            // the hanging ones are not cached, and will be re-checked next time
+            if (!checker->isRunning())
+            {
+                const auto types = checker->readResults();
+                for (const auto &type : types)
                 {
-                    for (auto *type : typesFound)
-                    {
-                        this->pluginsList.addType(*type);
-                    }
+                    this->pluginsList.addType(type);
                 }
-                    
-                this->sendChangeMessage();
-                Thread::sleep(150);
-#endif
+
+                this->updateScanCache(checker->getPluginPath(), types);
+                hasNewTypes = hasNewTypes || !types.isEmpty();
             }
+
+            checkers.remove(i);
         }
-        catch (...) {}
 
+        if (hasNewTypes)
         {
-            this->cancelled = false;
-            this->working = false;
-            
-            DBG("Done scanning for audio plugins");
             this->sendChangeMessage();
         }
-        
-        WaitableEvent::wait();
+
+        Thread::sleep(10);
+    }
+
+    if (this->cancelled.get())
+    {
+        DBG("Plugin scanning canceled");
+    }
+}
+
+void PluginScanner::checkFilesInProcess(const StringArray &files,
+    AudioPluginFormatManager &formatManager)
+{
+    for (const auto &pluginPath : files)
+    {
+        if (this->cancelled.get() || this->threadShouldExit())
+        {
+            DBG("Plugin scanning canceled");
+            break;
+        }
+
+        DBG("Unsafe scanning: " + pluginPath);
+
+        KnownPluginList knownPluginList;
+        OwnedArray<PluginDescription> typesFound;
+            
+        try
+        {
+            for (int j = 0; j < formatManager.getNumFormats(); ++j)
+            {
+                AudioPluginFormat *format = formatManager.getFormat(j);
+                knownPluginList.scanAndAddFile(pluginPath, false, typesFound, *format);
+            }
+        }
+        catch (...) {}
+            
+        // at this point we are still alive and plugin haven't crashed the app
+        Array<PluginDescription> types;
+        for (auto *type : typesFound)
+        {
+            this->pluginsList.addType(*type);
+            types.add(*type);
+        }
+
+        this->updateScanCache(pluginPath, types);
+        this->sendChangeMessage();
     }
 }
 
+//===----------------------------------------------------------------------===//
+// Scan cache
+//===----------------------------------------------------------------------===//
+
+// only the actual files and bundles are cached, not the identifiers
+// of the built-in plugins or of the formats without plugin files
+static bool getPluginFileSignature(const String &pluginPath, int64 &modificationTime, int64 &size)
+{
+    if (!File::isAbsolutePath(pluginPath))
+    {
+        return false;
+    }
+
+    const File file(pluginPath);
+    if (!file.exists())
+    {
+        return false;
+    }
+
+    modificationTime = file.getLastModificationTime().toMilliseconds();
+    size = file.isDirectory() ? 0 : file.getSize();
+    return true;
+}
+
+bool PluginScanner::addCachedTypes(const String &pluginPath)
+{
+    int64 modificationTime = 0;
+    int64 size = 0;
+    if (!getPluginFileSignature(pluginPath, modificationTime, size))
+    {
+        return false;
+    }
+
+    Array<PluginDescription> types;
+
+    {
+        const ScopedLock lock(this->scanCacheLock);
+        const auto found = this->scanCache.find(pluginPath);
+        if (found == this->scanCache.end() ||
+            found->second.modificationTime != modificationTime ||
+            found->second.size != size)
+        {
+            return false;
+        }
+
+        types = found->second.types;
+    }
+
+    for (const auto &type : types)
+    {
+        this->pluginsList.addType(type);
+    }
+
+    return true;
+}
+
+void PluginScanner::updateScanCache(const String &pluginPath, const Array<PluginDescription> &types)
+{
+    ScannedFile scannedFile;
+    if (!getPluginFileSignature(pluginPath, scannedFile.modificationTime, scannedFile.size))
+    {
+        return;
+    }
+
+    scannedFile.types = types;
+
+    const ScopedLock lock(this->scanCacheLock);
+    this->scanCache[pluginPath] = scannedFile;
+}
+
+void PluginScanner::loadPendingScanCache()
+{
+    if (!this->pendingScanCache.isValid())
+    {
+        return;
+    }
+
+    const ScopedLock lock(this->scanCacheLock);
+    forEachChildWithType(this->pendingScanCache, fileNode, Serialization::Audio::scannedFile)
+    {
+        ScannedFile scannedFile;
+        scannedFile.modificationTime = fileNode.getProperty(
+            Serialization::Audio::scannedFileModTime).toString().getHexValue64();
+        scannedFile.size = fileNode.getProperty(
+            Serialization::Audio::scannedFileSize).toString().getHexValue64();
+
+        forEachChildWithType(fileNode, typeNode, Serialization::Audio::plugin)
+        {
+            SerializablePluginDescription pluginDescription;
+            pluginDescription.deserialize(typeNode);
+            if (pluginDescription.isValid())
+            {
+                scannedFile.types.add(pluginDescription);
+            }
+        }
+
+        const String path = fileNode.getProperty(Serialization::Audio::scannedFilePath);
+        this->scanCache[path] = scannedFile;
+    }
+
+    this->pendingScanCache = {};
+}
+
 FileSearchPath PluginScanner::getTypicalFolders()
 {
     FileSearchPath folders;
@@ -396,6 +611,37 @@ SerializedData PluginScanner::serialize() const
         tree.appendChild(pd.serialize());
     }
 
+    if (this->pendingScanCache.isValid())
+    {
+        tree.appendChild(this->pendingScanCache.createCopy());
+        return tree;
+    }
+
+    SerializedData cacheNode(Serialization::Audio::pluginsScanCache);
+
+    {
+        const ScopedLock lock(this->scanCacheLock);
+        for (const auto &it : this->scanCache)
+        {
+            SerializedData fileNode(Serialization::Audio::scannedFile);
+            fileNode.setProperty(Serialization::Audio::scannedFilePath, it.first);
+            fileNode.setProperty(Serialization::Audio::scannedFileModTime,
+                String::toHexString(it.second.modificationTime));
+            fileNode.setProperty(Serialization::Audio::scannedFileSize,
+                String::toHexString(it.second.size));
+
+            for (const auto &type : it.second.types)
+            {
+                const SerializablePluginDescription pd(type);
+                fileNode.appendChild(pd.serialize());
+            }
+
+            cacheNode.appendChild(fileNode);
+        }
+    }
+
+    tree.appendChild(cacheNode);
+
     return tree;
 }
 
@@ -408,7 +654,7 @@ void PluginScanner::deserialize(const SerializedData &data)
 
     if (!root.isValid()) { return; }
     
-    for (const auto &child : root)
+    forEachChildWithType(root, child, Serialization::Audio::plugin)
     {
         SerializablePluginDescription pluginDescription;
         pluginDescription.deserialize(child);
@@ -418,11 +664,20 @@ void PluginScanner::deserialize(const SerializedData &data)
         }
     }
 
+    this->pendingScanCache = root.getChildWithName(Serialization::Audio::pluginsScanCache);
+
     this->sendChangeMessage();
 }
 
 void PluginScanner::reset()
 {
     this->pluginsList.clear();
+    this->pendingScanCache = {};
+
+    {
+        const ScopedLock lock(this->scanCacheLock);
+        this->scanCache.clear();
+    }
+
     this->sendChangeMessage();
 }
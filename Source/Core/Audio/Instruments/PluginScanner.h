@@ -74,6 +74,37 @@ private:
     FileSearchPath searchPath;
     StringArray filesToScan;
 
+    // in the safe mode, several plugin files are checked at
+    // the same time, each one in its own child process:
+    class CheckerProcess;
+    static constexpr auto maxNumCheckerProcesses = 8;
+    static constexpr auto checkerTimeoutMs = 60000;
+    void checkFilesInChildProcesses(const StringArray &files);
+    void checkFilesInProcess(const StringArray &files,
+        AudioPluginFormatManager &formatManager);
+
+    // the results of checking each file, including the ones where
+    // nothing was found, or the checker crashed, so that rescans skip
+    // the files which haven't changed since they were last checked
+    struct ScannedFile final
+    {
+        int64 modificationTime = 0;
+        int64 size = 0;
+        Array<PluginDescription> types;
+    };
+
+    FlatHashMap<String, ScannedFile, StringHash> scanCache;
+    CriticalSection scanCacheLock;
+
+    // the scan cache is only needed for rescanning, so it's not parsed
+    // at startup, but kept as is until the first scan, or saved back
+    SerializedData pendingScanCache;
+    void loadPendingScanCache();
+
+    // returns false if the file is not in the cache, or has changed
+    bool addCachedTypes(const String &pluginPath);
+    void updateScanCache(const String &pluginPath, const Array<PluginDescription> &types);
+
     FileSearchPath getTypicalFolders();
     void scanPossibleSubfolders(const StringArray &possibleSubfolders,
         const File &currentSystemFolder, FileSearchPath &foldersOut);
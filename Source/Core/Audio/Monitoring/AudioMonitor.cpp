@@ -59,12 +59,39 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OversaturationWarningAsyncCallback)
 };
 
-AudioMonitor::AudioMonitor() : fft()
+AudioMonitor::AudioMonitor()
 {
+    this->setSpectrumSettings(SpectrumFFT::defaultOrder,
+        AudioMonitor::defaultSpectrumOverlap);
+
     this->asyncClippingWarning = make<ClippingWarningAsyncCallback>(*this);
     this->asyncOversaturationWarning = make<OversaturationWarningAsyncCallback>(*this);
 }
 
+// four independent accumulators let the compiler pack the loop
+// into vector registers, which it wouldn't do for a single running sum
+// without fast-math, since that would change the order of additions
+static float getSumOfSquares(const float *data, int numSamples) noexcept
+{
+    float sums[4] = { 0.f, 0.f, 0.f, 0.f };
+
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        sums[0] += data[i] * data[i];
+        sums[1] += data[i + 1] * data[i + 1];
+        sums[2] += data[i + 2] * data[i + 2];
+        sums[3] += data[i + 3] * data[i + 3];
+    }
+
+    for (; i < numSamples; ++i)
+    {
+        sums[0] += data[i] * data[i];
+    }
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
 //===----------------------------------------------------------------------===//
 // AudioIODeviceCallback
 //===----------------------------------------------------------------------===//
@@ -77,30 +104,30 @@ void AudioMonitor::audioDeviceAboutToStart(AudioIODevice *device)
 void AudioMonitor::audioDeviceIOCallback(const float **inputChannelData, int numInputChannels,
     float **outputChannelData, int numOutputChannels, int numSamples)
 {
+    REALTIME_SCOPE();
     const int minNumChannels = jmin(AudioMonitor::numChannels, numOutputChannels);
-    
-    for (int channel = 0; channel < minNumChannels; ++channel)
+
+    if (this->numSpectrumSubscribers.get() > 0 && minNumChannels > 0)
     {
-        this->fft.computeSpectrum(outputChannelData[channel], 0, numSamples,
-            this->spectrum[channel], AudioMonitor::spectrumSize,
-            channel, numOutputChannels);
+        this->pushSpectrumSamples(outputChannelData, minNumChannels, numSamples);
     }
-    
-    for (int channel = 0; channel < minNumChannels; ++channel)
+
+    float channelPeaks[AudioMonitor::numChannels] = { 0.f, 0.f };
+    float channelRms[AudioMonitor::numChannels] = { 0.f, 0.f };
+
+    for (int channel = 0; channel < minNumChannels && numSamples > 0; ++channel)
     {
-        float pcmSquaresSum = 0.f;
-        float pcmPeak = 0.f;
-        for (int samplePosition = 0; samplePosition < numSamples; ++samplePosition)
-        {
-            const float &pcmData = outputChannelData[channel][samplePosition];
-            pcmSquaresSum += (pcmData * pcmData);
-            pcmPeak = jmax(pcmPeak, pcmData);
-        }
-        
+        const float *pcmData = outputChannelData[channel];
+
+        // peaks of both polarities count for clipping
+        const auto range = FloatVectorOperations::findMinAndMax(pcmData, numSamples);
+        const float pcmPeak = jmax(range.getEnd(), -range.getStart());
+
+        const float pcmSquaresSum = getSumOfSquares(pcmData, numSamples);
         const float rootMeanSquare = sqrtf(pcmSquaresSum / numSamples);
-        this->rms[channel] = rootMeanSquare;
-        this->peak[channel] = pcmPeak;
-        
+        channelRms[channel] = rootMeanSquare;
+        channelPeaks[channel] = pcmPeak;
+
         if (pcmPeak > AudioMonitor::clipThreshold)
         {
             this->asyncClippingWarning->triggerAsyncUpdate();
@@ -113,29 +140,182 @@ void AudioMonitor::audioDeviceIOCallback(const float **inputChannelData, int num
         }
     }
 
+    ++this->volumeVersion;
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+    {
+        this->peak[channel] = channelPeaks[channel];
+        this->rms[channel] = channelRms[channel];
+    }
+    ++this->volumeVersion;
+
     for (int i = 0; i < numOutputChannels; ++i)
     {
         FloatVectorOperations::clear(outputChannelData[i], numSamples);
     }
 }
 
+void AudioMonitor::pushSpectrumSamples(float **channelData, int numChannels, int numSamples)
+{
+    int start1, size1, start2, size2;
+    // if the analysis can't keep up, just drop the samples that don't fit
+    this->spectrumFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+    {
+        // mono output is analyzed as both channels
+        const auto *source = channelData[jmin(channel, numChannels - 1)];
+
+        if (size1 > 0)
+        {
+            this->spectrumFifoBuffer.copyFrom(channel, start1, source, size1);
+        }
+
+        if (size2 > 0)
+        {
+            this->spectrumFifoBuffer.copyFrom(channel, start2, source + size1, size2);
+        }
+    }
+
+    this->spectrumFifo.finishedWrite(size1 + size2);
+}
+
 //===----------------------------------------------------------------------===//
 // Spectrum data
 //===----------------------------------------------------------------------===//
 
+void AudioMonitor::addSpectrumSubscriber()
+{
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+    if (++this->numSpectrumSubscribers == 1)
+    {
+        this->startTimerHz(AudioMonitor::spectrumUpdateHz);
+    }
+}
+
+void AudioMonitor::removeSpectrumSubscriber()
+{
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+    jassert(this->numSpectrumSubscribers.get() > 0);
+    if (--this->numSpectrumSubscribers == 0)
+    {
+        this->stopTimer();
+        this->resetSpectrum();
+    }
+}
+
+void AudioMonitor::setSpectrumSettings(int fftOrder, int overlap)
+{
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    this->fft = make<SpectrumFFT>(fftOrder);
+    this->spectrumOverlap = jlimit(1, AudioMonitor::maxSpectrumOverlap, overlap);
+
+    this->analysisBuffer.setSize(AudioMonitor::numChannels, this->fft->getSize());
+    this->analysisBuffer.clear();
+    this->analysisPosition = 0;
+    this->numSamplesSinceLastFrame = 0;
+
+    this->tickSpectrum.clear();
+    this->hasNewSpectrum = false;
+
+    this->resetSpectrum();
+    this->numSpectrumBins = this->fft->getNumBins();
+}
+
+void AudioMonitor::resetSpectrum()
+{
+    for (auto &channelSpectrum : this->spectrum)
+    {
+        for (auto &value : channelSpectrum)
+        {
+            value = 0.f;
+        }
+    }
+}
+
+void AudioMonitor::timerCallback()
+{
+    int start1, size1, start2, size2;
+    const auto numReady = this->spectrumFifo.getNumReady();
+    this->spectrumFifo.prepareToRead(numReady, start1, size1, start2, size2);
+    this->pullSpectrumSamples(start1, size1);
+    this->pullSpectrumSamples(start2, size2);
+    this->spectrumFifo.finishedRead(size1 + size2);
+
+    if (!this->hasNewSpectrum)
+    {
+        return;
+    }
+
+    const auto numBins = this->fft->getNumBins();
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+    {
+        const auto *tickData = this->tickSpectrum.getReadPointer(channel);
+        for (int i = 0; i < numBins; ++i)
+        {
+            this->spectrum[channel][i] = tickData[i];
+        }
+    }
+
+    this->tickSpectrum.clear();
+    this->hasNewSpectrum = false;
+}
+
+void AudioMonitor::pullSpectrumSamples(int fifoStart, int numSamples)
+{
+    const auto fftSize = this->fft->getSize();
+    const auto hopSize = fftSize / this->spectrumOverlap;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+        {
+            this->analysisBuffer.setSample(channel, this->analysisPosition,
+                this->spectrumFifoBuffer.getSample(channel, fifoStart + i));
+        }
+
+        this->analysisPosition = (this->analysisPosition + 1) % fftSize;
+
+        if (++this->numSamplesSinceLastFrame >= hopSize)
+        {
+            this->numSamplesSinceLastFrame = 0;
+            this->analyzeSpectrumFrame();
+        }
+    }
+}
+
+void AudioMonitor::analyzeSpectrumFrame()
+{
+    const auto numBins = this->fft->getNumBins();
+    auto *frameData = this->frameSpectrum.getWritePointer(0);
+
+    for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+    {
+        // the ring buffer starts from the oldest sample at the current position
+        this->fft->computeSpectrum(this->analysisBuffer.getReadPointer(channel),
+            this->analysisPosition, this->fft->getSize(), frameData);
+
+        FloatVectorOperations::max(this->tickSpectrum.getWritePointer(channel),
+            this->tickSpectrum.getReadPointer(channel), frameData, numBins);
+    }
+
+    this->hasNewSpectrum = true;
+}
+
 float AudioMonitor::getInterpolatedSpectrumAtFrequency(float frequency) const
 {
+    const int numBins = this->numSpectrumBins.get();
     const float resolution = 
-        float(this->sampleRate.get() / 2.f) / float(AudioMonitor::spectrumSize);
+        float(this->sampleRate.get() / 2.f) / float(numBins);
     
     const int index1 = roundToInt(frequency / resolution);
-    const int safeIndex1 = jlimit(0, AudioMonitor::spectrumSize, index1);
+    const int safeIndex1 = jlimit(0, numBins - 1, index1);
     const float f1 = index1 * resolution;
     const float y1 = (this->spectrum[0][safeIndex1].get() +
                       this->spectrum[1][safeIndex1].get()) / 2.f;
     
     const int index2 = index1 + 1;
-    const int safeIndex2 = jlimit(0, AudioMonitor::spectrumSize, index2);
+    const int safeIndex2 = jlimit(0, numBins - 1, index2);
     const float f2 = index2 * resolution;
     const float y2 = (this->spectrum[0][safeIndex2].get() +
                       this->spectrum[1][safeIndex2].get()) / 2.f;
@@ -167,6 +347,32 @@ ListenerList<AudioMonitor::ClippingListener> &AudioMonitor::getListeners() noexc
 // Volume data
 //===----------------------------------------------------------------------===//
 
+AudioMonitor::VolumeSnapshot AudioMonitor::getVolumeSnapshot() const noexcept
+{
+    VolumeSnapshot snapshot;
+
+    while (true)
+    {
+        const auto versionBefore = this->volumeVersion.get();
+        if ((versionBefore & 1) != 0)
+        {
+            Thread::yield();
+            continue;
+        }
+
+        for (int channel = 0; channel < AudioMonitor::numChannels; ++channel)
+        {
+            snapshot.peak[channel] = this->peak[channel].get();
+            snapshot.rms[channel] = this->rms[channel].get();
+        }
+
+        if (this->volumeVersion.get() == versionBefore)
+        {
+            return snapshot;
+        }
+    }
+}
+
 float AudioMonitor::getPeak(int channel) const
 {
     return this->peak[channel].get();
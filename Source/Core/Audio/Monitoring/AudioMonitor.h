@@ -19,7 +19,7 @@
 
 #include "SpectrumAnalyzer.h"
 
-class AudioMonitor final : public AudioIODeviceCallback
+class AudioMonitor final : public AudioIODeviceCallback, private Timer
 {
 public:
     
@@ -55,6 +55,15 @@ public:
     // Volume data
     //===------------------------------------------------------------------===//
     
+    struct VolumeSnapshot final
+    {
+        float peak[2] = { 0.f, 0.f };
+        float rms[2] = { 0.f, 0.f };
+    };
+
+    // per-block values of both channels, consistent with each other
+    VolumeSnapshot getVolumeSnapshot() const noexcept;
+
     float getPeak(int channel) const;
     float getRootMeanSquare(int channel) const;
     
@@ -63,25 +72,67 @@ public:
     //===------------------------------------------------------------------===//
     
     float getInterpolatedSpectrumAtFrequency(float frequency) const;
+
+    // the spectrum is only analyzed while anyone is subscribed,
+    // both methods are to be called from the message thread
+    void addSpectrumSubscriber();
+    void removeSpectrumSubscriber();
+
+    // the window is (1 << fftOrder) samples, and the overlap is how many
+    // windows are analyzed per window length, the loudest one being displayed,
+    // so that short transients between the timer ticks are not missed;
+    // to be called from the message thread
+    void setSpectrumSettings(int fftOrder, int overlap);
     
 private:
 
-    SpectrumFFT fft;
+    void timerCallback() override;
+
+    void pushSpectrumSamples(float **channelData, int numChannels, int numSamples);
+    void pullSpectrumSamples(int fifoStart, int numSamples);
+    void analyzeSpectrumFrame();
+    void resetSpectrum();
 
-    // 256*2 == we just need quite a small resolution on a spectrum
-    static constexpr auto spectrumSize = 256;
     static constexpr auto numChannels = 2;
+    static_assert(numChannels == 2, "VolumeSnapshot assumes stereo");
+
+    static constexpr auto defaultSpectrumOverlap = 2;
+    static constexpr auto maxSpectrumOverlap = 8;
 
-    static_assert((numChannels * spectrumSize) <= SpectrumFFT::maxSpectrumSize, "Oh no");
+    UniquePointer<SpectrumFFT> fft;
+    int spectrumOverlap = defaultSpectrumOverlap;
+    Atomic<int> numSpectrumBins = 0;
 
     static constexpr auto defaultSampleRate = 44100;
     static constexpr auto clipThreshold = 0.995f;
     static constexpr auto oversaturationThreshold = 0.5f;
     static constexpr auto oversaturationRate = 4.f;
 
-    Atomic<float> spectrum[numChannels][spectrumSize];
+    Atomic<float> spectrum[numChannels][SpectrumFFT::maxNumBins];
+
+    // the audio thread only copies its output into this fifo,
+    // and the analysis runs on a timer on the message thread
+    static constexpr auto spectrumFifoSize = 8192;
+    static constexpr auto spectrumUpdateHz = 30;
+    AbstractFifo spectrumFifo { spectrumFifoSize };
+    AudioBuffer<float> spectrumFifoBuffer { numChannels, spectrumFifoSize };
+    Atomic<int> numSpectrumSubscribers = 0;
+
+    // the latest samples as a ring buffer, only used by the timer
+    AudioBuffer<float> analysisBuffer;
+    int analysisPosition = 0;
+    int numSamplesSinceLastFrame = 0;
+
+    // the loudest bins of all frames analyzed within one timer tick
+    AudioBuffer<float> frameSpectrum { 1, SpectrumFFT::maxNumBins };
+    AudioBuffer<float> tickSpectrum { numChannels, SpectrumFFT::maxNumBins };
+    bool hasNewSpectrum = false;
+
+    // published by the audio thread once per block as a seqlock:
+    // the version is odd while writing, and readers retry if it changes
     Atomic<float> peak[numChannels];
     Atomic<float> rms[numChannels];
+    Atomic<uint32> volumeVersion = 0;
 
     Atomic<double> sampleRate = defaultSampleRate;
 
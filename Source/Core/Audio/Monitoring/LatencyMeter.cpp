@@ -0,0 +1,119 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "LatencyMeter.h"
+
+LatencyMeter::LatencyMeter(Callback callback) :
+    callback(callback)
+{
+    this->startTimeMs = Time::getMillisecondCounter();
+    this->startTimerHz(20);
+}
+
+void LatencyMeter::audioDeviceAboutToStart(AudioIODevice *device)
+{
+    this->pingIntervalSamples = int(device->getCurrentSampleRate() * LatencyMeter::pingIntervalSeconds);
+    this->lastPingPosition = -1;
+    this->isWaitingForEcho = false;
+}
+
+void LatencyMeter::audioDeviceIOCallback(const float **inputChannelData, int numInputChannels,
+    float **outputChannelData, int numOutputChannels, int numSamples)
+{
+    for (int i = 0; i < numOutputChannels; ++i)
+    {
+        FloatVectorOperations::clear(outputChannelData[i], numSamples);
+    }
+
+    if (this->pingIntervalSamples <= 0)
+    {
+        return;
+    }
+
+    for (int s = 0; s < numSamples; ++s)
+    {
+        const auto position = this->samplePosition + s;
+
+        if (this->isWaitingForEcho)
+        {
+            for (int i = 0; i < numInputChannels; ++i)
+            {
+                if (std::abs(inputChannelData[i][s]) > LatencyMeter::echoThreshold)
+                {
+                    const auto index = this->numDelays.get();
+                    this->delays[index] = int(position - this->lastPingPosition);
+                    this->numDelays = index + 1;
+                    this->isWaitingForEcho = false;
+                    break;
+                }
+            }
+        }
+
+        const auto numPingsSent = this->numPingsSent.get();
+        if (numPingsSent < LatencyMeter::numPings &&
+            (this->lastPingPosition < 0 ||
+                position - this->lastPingPosition >= this->pingIntervalSamples))
+        {
+            // the echo of the previous ping is lost,
+            // hopefully, the next one will do better
+            this->lastPingPosition = position;
+            this->isWaitingForEcho = true;
+            this->numPingsSent = numPingsSent + 1;
+        }
+
+        if (this->lastPingPosition >= 0 &&
+            position - this->lastPingPosition < LatencyMeter::pingLength)
+        {
+            for (int i = 0; i < numOutputChannels; ++i)
+            {
+                outputChannelData[i][s] = LatencyMeter::pingLevel;
+            }
+        }
+    }
+
+    this->samplePosition += numSamples;
+}
+
+void LatencyMeter::timerCallback()
+{
+    const auto numDelays = this->numDelays.get();
+    const auto hasSentAllPings = this->numPingsSent.get() == LatencyMeter::numPings;
+    const auto timeoutMs = uint32((LatencyMeter::numPings + 2) * LatencyMeter::pingIntervalSeconds * 1000.0);
+    const auto hasTimedOut = Time::getMillisecondCounter() - this->startTimeMs > timeoutMs;
+
+    if (!hasTimedOut && !(hasSentAllPings && numDelays == LatencyMeter::numPings))
+    {
+        return;
+    }
+
+    this->stopTimer();
+
+    // the median is robust to a couple of false detections, e.g. clicks
+    // picked up by the mic instead of the cable, but at least half of
+    // the pings should be detected for the result to make any sense
+    int result = -1;
+    if (numDelays >= LatencyMeter::numPings / 2)
+    {
+        Array<int> sortedDelays(this->delays, numDelays);
+        sortedDelays.sort();
+        result = sortedDelays[numDelays / 2];
+    }
+
+    DBG("Measured round-trip latency: " + String(result) + " samples");
+    this->callback(result);
+}
@@ -0,0 +1,70 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Measures the real round-trip latency of the audio device, which needs
+// a loopback, i.e. a cable from an output to an input: it sends a few clicks,
+// finds each of them in the input, and reports the median delay, which also
+// includes what the drivers don't report, like the converters' latency
+
+class LatencyMeter final : public AudioIODeviceCallback, private Timer
+{
+public:
+
+    // called on the message thread, with a negative value
+    // if the clicks could not be found in the input
+    using Callback = Function<void(int roundTripSamples)>;
+
+    explicit LatencyMeter(Callback callback);
+
+    //===------------------------------------------------------------------===//
+    // AudioIODeviceCallback
+    //===------------------------------------------------------------------===//
+
+    void audioDeviceAboutToStart(AudioIODevice *device) override;
+    void audioDeviceIOCallback(const float **inputChannelData, int numInputChannels,
+        float **outputChannelData, int numOutputChannels, int numSamples) override;
+    void audioDeviceStopped() override {}
+
+private:
+
+    void timerCallback() override;
+
+    Callback callback;
+
+    static constexpr auto numPings = 8;
+    static constexpr auto pingIntervalSeconds = 0.3;
+    static constexpr auto pingLength = 4;
+    static constexpr auto pingLevel = 0.5f;
+    static constexpr auto echoThreshold = 0.05f; // about -26 dB
+
+    // only used by the audio thread
+    int pingIntervalSamples = 0;
+    int64 samplePosition = 0;
+    int64 lastPingPosition = -1;
+    bool isWaitingForEcho = false;
+
+    // written by the audio thread before the counters are updated
+    int delays[LatencyMeter::numPings] = {};
+    Atomic<int> numDelays = 0;
+    Atomic<int> numPingsSent = 0;
+
+    uint32 startTimeMs = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LatencyMeter)
+};
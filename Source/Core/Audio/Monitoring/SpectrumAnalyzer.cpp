@@ -18,141 +18,114 @@
 #include "Common.h"
 #include "SpectrumAnalyzer.h"
 
-SpectrumFFT::SpectrumFFT()
+SpectrumFFT::SpectrumFFT(int fftOrder) :
+    order(jlimit(SpectrumFFT::minOrder, SpectrumFFT::maxOrder, fftOrder)),
+    size(1 << this->order)
 {
-    for (int count = 0; count < SpectrumFFT::cosTableSize; count++)
+    const auto halfSize = this->size / 2;
+
+    this->window.malloc(this->size);
+    this->twiddles.malloc(halfSize);
+    this->bitReversed.malloc(halfSize);
+    this->buffer.malloc(halfSize);
+
+    for (int i = 0; i < this->size; ++i)
     {
-        this->costab[count] = cosf(MathConstants<float>::halfPi *
-            static_cast<float>(count) / static_cast<float>(SpectrumFFT::cosTableSize));
+        this->window[i] = 0.5f * (1.f - cosf(MathConstants<float>::twoPi *
+            float(i) / float(this->size)));
     }
-}
 
-inline float SpectrumFFT::cosine(float x) const noexcept
-{
-    int y;
-    
-    x *= SpectrumFFT::tableRange;
-    y = static_cast<int>(x);
-    if (y < 0)
+    for (int i = 0; i < halfSize; ++i)
     {
-        y = -y;
+        const auto phase = -MathConstants<double>::twoPi * double(i) / double(this->size);
+        this->twiddles[i].re = float(cos(phase));
+        this->twiddles[i].im = float(sin(phase));
     }
 
-    y &= SpectrumFFT::tableMask;
-    switch (y >> SpectrumFFT::cosTableBits)
+    const auto halfBits = this->order - 1;
+    for (int i = 0; i < halfSize; ++i)
     {
-        case 0 : return  this->costab[y];
-        case 1 : return -this->costab[(SpectrumFFT::cosTableSize - 1) - (y - (SpectrumFFT::cosTableSize * 1))];
-        case 2 : return -this->costab[                                  (y - (SpectrumFFT::cosTableSize * 2))];
-        case 3 : return  this->costab[(SpectrumFFT::cosTableSize - 1) - (y - (SpectrumFFT::cosTableSize * 3))];
+        int reversed = 0;
+        for (int bit = 0; bit < halfBits; ++bit)
+        {
+            reversed |= ((i >> bit) & 1) << (halfBits - 1 - bit);
+        }
+
+        this->bitReversed[i] = reversed;
     }
-    
-    return 0.f;
 }
 
-inline float SpectrumFFT::sine(float x) const noexcept
+// an in-place iterative radix-2 transform of (size / 2) complex values,
+// expects the input to be already in the bit-reversed order
+inline void SpectrumFFT::process() noexcept
 {
-    return this->cosine(x - 0.25f);
-}
+    const auto halfSize = this->size / 2;
+    auto *data = this->buffer.get();
 
-inline unsigned int SpectrumFFT::reverse(unsigned int val, int bits) const noexcept
-{
-    unsigned int retn = 0;
-    
-    while (bits--)
+    for (int length = 2; length <= halfSize; length <<= 1)
     {
-        retn <<= 1;
-        retn |= (val & 1);
-        val >>= 1;
-    }
-    
-    return (retn);
-}
+        const auto halfLength = length / 2;
+        // the twiddles table is made for the full size, hence the doubled step
+        const auto twiddleStep = (halfSize / length) * 2;
 
-inline void SpectrumFFT::process(int bits)
-{
-    int count, count2, count3;
-    int fftlen = 1 << bits;
-    unsigned i1 = fftlen / 2;
-    int i2 = 1, i3, i4, y;
-    float a1, a2, b1, b2, z1, z2;
-    float oneOverN = 1.0f / fftlen;
-    
-    for (count = 0; count < bits; count++)
-    {
-        i3 = 0;
-        i4 = i1;
-        
-        for (count2 = 0; count2 < i2; count2++)
+        for (int i = 0; i < halfSize; i += length)
         {
-            y  = this->reverse(i3 / static_cast<int>(i1), bits);
-            z1 = this->cosine(static_cast<float>(y) * oneOverN);
-            z2 = -this->sine(static_cast<float>(y) * oneOverN);
-
-            for (count3 = i3; count3 < i4; count3++)
+            for (int j = 0; j < halfLength; ++j)
             {
-                a1 = this->buffer[count3].re;
-                a2 = this->buffer[count3].im;
-                
-                b1 = (z1 * this->buffer[count3 + i1].re) - (z2 * this->buffer[count3 + i1].im);
-                b2 = (z2 * this->buffer[count3 + i1].re) + (z1 * this->buffer[count3 + i1].im);
-                
-                this->buffer[count3].re = a1 + b1;
-                this->buffer[count3].im = a2 + b2;
-                
-                this->buffer[count3 + i1].re = a1 - b1;
-                this->buffer[count3 + i1].im = a2 - b2;
+                const auto &w = this->twiddles[j * twiddleStep];
+                auto &a = data[i + j];
+                auto &b = data[i + j + halfLength];
+
+                const auto re = (b.re * w.re) - (b.im * w.im);
+                const auto im = (b.re * w.im) + (b.im * w.re);
+
+                b.re = a.re - re;
+                b.im = a.im - im;
+                a.re += re;
+                a.im += im;
             }
-            
-            i3 += (i1 << 1);
-            i4 += (i1 << 1);
         }
-        
-        i1 >>= 1;
-        i2 <<= 1;
     }
 }
 
-void SpectrumFFT::computeSpectrum(float *pcmBuffer,
-    unsigned int pcmPosition, unsigned int pcmLength,
-    Atomic<float> *spectrum, int length,
-    int channel, int numchannels)
+void SpectrumFFT::computeSpectrum(const float *pcmBuffer,
+    int pcmPosition, int pcmLength, float *spectrum) noexcept
 {
-    int count, bits, bitslength, nyquist;
-    
-    bitslength = length;
-    bits = 0;
-    while (bitslength > 1)
-    {
-        bitslength >>= 1;
-        bits++;
-    }
-    
-    // Apply Hanning window
-    for (count = 0; count < length; count++)
+    jassert(pcmLength >= this->size);
+
+    const auto halfSize = this->size / 2;
+
+    // pack even and odd windowed samples as real and imaginary parts
+    for (int i = 0; i < halfSize; ++i)
     {
-        const float percent = static_cast<float>(count) / static_cast<float>(length);
-        const float window = 0.5f * (1.0f  - this->cosine(percent));
-        
-        this->buffer[count].re = pcmBuffer[pcmPosition] * window;
-        this->buffer[count].re /= static_cast<float>(length);
-        this->buffer[count].im = 0.00000001f;
-        
-        pcmPosition++;
-        if (pcmPosition >= pcmLength)
-        {
-            pcmPosition = 0;
-        }
+        const auto i1 = (pcmPosition + i * 2) % pcmLength;
+        const auto i2 = (i1 + 1) % pcmLength;
+
+        auto &target = this->buffer[this->bitReversed[i]];
+        target.re = pcmBuffer[i1] * this->window[i * 2];
+        target.im = pcmBuffer[i2] * this->window[i * 2 + 1];
     }
 
-    this->process(bits);
+    this->process();
+
+    // same scaling as the visualizers always had
+    const auto scale = 2.5f / float(this->size);
 
-    nyquist = (length / 2);
-    for (count = 0; count < (nyquist - 1); ++count)
+    for (int k = 0; k < halfSize; ++k)
     {
-        const auto n = this->reverse(count, bits);
-        spectrum[count] = jmin(1.0f, 2.5f *
-            (sqrtf((this->buffer[n].re * this->buffer[n].re)
-                + (this->buffer[n].im * this->buffer[n].im))));
+        const auto &z1 = this->buffer[k];
+        const auto &z2 = this->buffer[(halfSize - k) % halfSize];
+
+        // even part is (z1 + conj(z2)) / 2, odd part is (z1 - conj(z2)) / 2i
+        const auto evenRe = (z1.re + z2.re) * 0.5f;
+        const auto evenIm = (z1.im - z2.im) * 0.5f;
+        const auto oddRe = (z1.im + z2.im) * 0.5f;
+        const auto oddIm = (z2.re - z1.re) * 0.5f;
+
+        const auto &w = this->twiddles[k];
+        const auto re = evenRe + (oddRe * w.re) - (oddIm * w.im);
+        const auto im = evenIm + (oddRe * w.im) + (oddIm * w.re);
+
+        spectrum[k] = jmin(1.f, scale * sqrtf((re * re) + (im * im)));
     }
 }
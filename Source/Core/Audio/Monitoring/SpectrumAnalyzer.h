@@ -17,40 +17,48 @@
 
 #pragma once
 
+// A real-input FFT with a Hann window, tables are precomputed for a given size:
+// the input is packed into a half-size complex transform, which is then split
+// into the real signal's bins, so it costs about half of a complex FFT
 class SpectrumFFT final
 {
 public:
-    
-    SpectrumFFT();
-    
-    void computeSpectrum(float *pcmBuffer,
-        unsigned int pcmPosition, unsigned int pcmLength,
-        Atomic<float> *spectrum, int length,
-        int channel, int numchannels);
 
-    // please make sure no consumer ever asks for a spectrum larger than that:
-    static constexpr auto maxSpectrumSize = 512;
+    // the size is 1 << order samples, which gives (size / 2) bins
+    explicit SpectrumFFT(int order = SpectrumFFT::defaultOrder);
 
-private:
+    static constexpr auto minOrder = 6;
+    static constexpr auto maxOrder = 13;
+    static constexpr auto defaultOrder = 10;
+
+    static constexpr auto maxSize = 1 << maxOrder;
+    static constexpr auto maxNumBins = maxSize / 2;
+
+    int getSize() const noexcept { return this->size; }
+    int getNumBins() const noexcept { return this->size / 2; }
 
-    static constexpr auto cosTableBits = 13;
-    static constexpr auto cosTableSize = 1 << cosTableBits;
-    static constexpr auto tableRange = cosTableSize * 4;
-    static constexpr auto tableMask = tableRange - 1;
+    // reads getSize() samples from a ring buffer, starting from the oldest one,
+    // and writes getNumBins() magnitudes, more or less normalized to 0..1
+    void computeSpectrum(const float *pcmBuffer,
+        int pcmPosition, int pcmLength, float *spectrum) noexcept;
+
+private:
 
     struct FftComplex final
     {
         float re = 0.f;
         float im = 0.f;
     };
-    
-    FftComplex buffer[maxSpectrumSize];
-    float costab[cosTableSize];
-    
-    inline float cosine(float x) const noexcept;
-    inline float sine(float x) const noexcept;
-    inline unsigned int reverse(unsigned int val, int bits) const noexcept;
-    inline void process(int bits);
-    
+
+    const int order;
+    const int size;
+
+    HeapBlock<float> window;
+    HeapBlock<FftComplex> twiddles; // e^(-2*pi*i*k/size) for k < size / 2
+    HeapBlock<int> bitReversed; // for the half-size transform
+    HeapBlock<FftComplex> buffer;
+
+    inline void process() noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumFFT)
 };
@@ -61,10 +61,9 @@ void MidiRecorder::setTargetScope(const Clip *clip, const String &instrumentId)
 
     if (this->activeTrack != track || this->activeClip != clip)
     {
-        if (this->activeTrack != nullptr)
-        {
-            this->finaliseAllHoldingNotes();
-        }
+        // the recorded notes belong to the previous track
+        this->commitRecordedNotes();
+        this->clearTakes();
 
         this->activeTrack = track;
         this->activeClip = clip;
@@ -84,7 +83,10 @@ void MidiRecorder::onSeek(float beatPosition, double, double) noexcept
         MessageManagerLock mml(Thread::getCurrentThread());
         jassert(mml.lockWasGained());
 
+        // the events still in the queue belong to the finished pass
+        this->commitRecordedEvents(false);
         this->finaliseAllHoldingNotes();
+        this->finishTake();
     }
 
     this->lastCorrectPosition = beatPosition;
@@ -103,9 +105,11 @@ void MidiRecorder::onRecord()
     {
         this->isRecording = true;
         this->shouldCheckpoint = true;
+        this->clearTakes();
 
         auto temperament = this->project.getProjectInfo()->getTemperament();
         auto &audioCore = App::Workspace().getAudioCore();
+        this->outputLatencyMs = audioCore.getOutputLatencyMs();
         audioCore.addFilteredMidiInputCallback(this,
             temperament->getPeriodSize(), temperament->getChromaticMap());
 
@@ -141,11 +145,12 @@ void MidiRecorder::onStop()
 
         this->isRecording = false;
 
-        // fixme handle buffers?
-        jassert(this->noteOnsBuffer.isEmpty());
-        jassert(this->noteOffsBuffer.isEmpty());
+        // commit whatever is still in the queue,
+        // but don't restart the playback we're stopping
+        this->cancelPendingUpdate();
+        this->commitRecordedEvents(false);
 
-        this->holdingNotes.clear();
+        this->commitRecordedNotes();
     }
 
     this->isPlaying = false;
@@ -173,22 +178,40 @@ static SerializedData createPianoTrackTemplate(const String &name,
 }
 
 // called from the message thread, so we can insert new midi events
-// (note that the track selection may change during recording);
-// the main recording logic goes here:
+// (note that the track selection may change during recording):
 void MidiRecorder::handleAsyncUpdate()
 {
-    if (this->noteOnsBuffer.isEmpty() &&
-        this->noteOffsBuffer.isEmpty())
+    this->commitRecordedEvents(true);
+}
+
+// the main recording logic goes here:
+void MidiRecorder::commitRecordedEvents(bool canStartPlayback)
+{
+    Array<RecordedEvent> batch;
+
+    {
+        const auto scope = this->recordedEventsFifo.read(this->recordedEventsFifo.getNumReady());
+        batch.ensureStorageAllocated(scope.blockSize1 + scope.blockSize2);
+        batch.addArray(this->recordedEvents + scope.startIndex1, scope.blockSize1);
+        batch.addArray(this->recordedEvents + scope.startIndex2, scope.blockSize2);
+    }
+
+    if (batch.isEmpty())
     {
         // nothing to do
         return;
     }
 
+    // the events from different devices may come slightly out of order,
+    // the stable sort keeps the order of note-offs and note-ons at the same beat
+    std::stable_sort(batch.begin(), batch.end(),
+        [](const RecordedEvent &a, const RecordedEvent &b) { return a.beat < b.beat; });
+
     // a neat helper: start playback, if still not playing,
     // yet have received some midi events;
     // we do it before inserting any events,
     // so that the first note doesn't sound twice
-    if (!this->isPlaying.get())
+    if (canStartPlayback && !this->isPlaying.get())
     {
         this->getTransport().startPlayback();
     }
@@ -227,7 +250,7 @@ void MidiRecorder::handleAsyncUpdate()
 
         String outTrackId;
         const auto trackTemplate = createPianoTrackTemplate(newName,
-            this->lastCorrectPosition.get(), this->lastValidInstrumentId, outTrackId);
+            float(batch.getFirst().beat), this->lastValidInstrumentId, outTrackId);
 
         this->project.getUndoStack()->perform(
             new PianoTrackInsertAction(this->project,
@@ -237,78 +260,89 @@ void MidiRecorder::handleAsyncUpdate()
         this->activeClip = this->activeTrack->getPattern()->getUnchecked(0);
         this->shouldCheckpoint = false;
     }
-    
-    // handle note offs and fill unhandledNoteOffs
-    while (!this->noteOffsBuffer.isEmpty())
+
+    // the events are sorted, so they can be simply replayed in order
+    for (const auto &event : batch)
     {
-        const auto last = this->noteOffsBuffer.size() - 1;
-        const auto i = this->noteOffsBuffer.removeAndReturn(last);
-        const bool wasHandled = this->finaliseHoldingNote(i.getNoteNumber());
-        if (!wasHandled)
+        if (event.isNoteOn)
+        {
+            this->startHoldingNote(event.key, event.beat, event.velocity);
+        }
+        else
         {
-            this->unhandledNoteOffs.add(i);
+            this->finaliseHoldingNote(event.key, event.beat);
         }
     }
+}
 
-    // handle note ons
-    while (!this->noteOnsBuffer.isEmpty())
+// called from the high-priority system thread:
+void MidiRecorder::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
+{
+    if (!message.isNoteOnOrOff())
     {
-        const auto last = this->noteOnsBuffer.size() - 1;
-        const auto i = this->noteOnsBuffer.removeAndReturn(last);
-        this->startHoldingNote(i);
+        return;
     }
 
-    // handle unhandledNoteOffs and clean
-    for (const auto &i : this->unhandledNoteOffs)
-    {
-        this->finaliseHoldingNote(i.getNoteNumber());
-    }
+    // the device timestamp is in the same time base as
+    // Time::getMillisecondCounterHiRes, in seconds;
+    // some drivers don't provide it, or provide it with a jitter
+    // that puts it in the future, so fall back to the current time:
+    const auto nowMs = Time::getMillisecondCounterHiRes();
+    const auto deviceTimeMs = message.getTimeStamp() * 1000.0;
+    const auto eventTimeMs = (deviceTimeMs > 0.0 && deviceTimeMs <= nowMs) ? deviceTimeMs : nowMs;
+
+    RecordedEvent event;
+    event.beat = this->getEstimatedPosition(eventTimeMs);
+    event.key = message.getNoteNumber();
+    event.velocity = float(message.getVelocity()) / 128.f;
+    event.isNoteOn = message.isNoteOn();
+    this->pushRecordedEvent(event);
 
-    this->unhandledNoteOffs.clearQuick();
+    this->triggerAsyncUpdate();
 }
 
-struct SortMidiMessagesByTimestamp final
+void MidiRecorder::pushRecordedEvent(const RecordedEvent &event)
 {
-    static int compareElements(const MidiMessage &first, const MidiMessage &second)
+    const SpinLock::ScopedLockType lock(this->recordedEventsWriterLock);
+
+    const auto scope = this->recordedEventsFifo.write(1);
+    if (scope.blockSize1 > 0)
     {
-        return int(first.getTimeStamp() - second.getTimeStamp());
+        this->recordedEvents[scope.startIndex1] = event;
     }
-};
-
-static SortMidiMessagesByTimestamp tsSort;
-
-// called from the high-priority system thread:
-void MidiRecorder::handleIncomingMidiMessage(MidiInput *, const MidiMessage &message)
-{
-    if (message.isNoteOn())
+    else if (scope.blockSize2 > 0)
     {
-        this->noteOnsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        this->recordedEvents[scope.startIndex2] = event;
     }
-    else if (message.isNoteOff())
+    else
     {
-        this->noteOffsBuffer.addSorted(tsSort,
-            message.withTimeStamp(this->getEstimatedPosition()));
+        DBG("Recorded events queue overflow, the message thread is stuck?");
     }
-
-    this->triggerAsyncUpdate();
 }
 
 // current beat, estimated since the last known
 // midi event, including the tempo change events:
-double MidiRecorder::getEstimatedPosition() const
+double MidiRecorder::getEstimatedPosition(double timeMs) const
 {
     if (!this->isPlaying.get())
     {
         return this->lastCorrectPosition.get();
     }
 
-    const double timeOffsetMs = Time::getMillisecondCounterHiRes() - this->lastUpdateTime.get();
+    // the event might have happened before the last seek callback
+    // has arrived, which is still fine for the linear estimation
+    const double timeOffsetMs = timeMs -
+        this->outputLatencyMs.get() - this->lastUpdateTime.get();
     const double positionOffset = timeOffsetMs / this->msPerQuarterNote.get();
     const double estimatedPosition = this->lastCorrectPosition.get() + positionOffset;
     return estimatedPosition;
 }
 
+double MidiRecorder::getEstimatedPosition() const
+{
+    return this->getEstimatedPosition(Time::getMillisecondCounterHiRes());
+}
+
 void MidiRecorder::timerCallback()
 {
     if (this->activeTrack != nullptr)
@@ -317,41 +351,67 @@ void MidiRecorder::timerCallback()
     }
 }
 
+//===----------------------------------------------------------------------===//
+// Recording preview
+//===----------------------------------------------------------------------===//
+
+void MidiRecorder::addListener(Listener *listener)
+{
+    jassert(MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+    this->listeners.add(listener);
+}
+
+void MidiRecorder::removeListener(Listener *listener)
+{
+    jassert(MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+    this->listeners.remove(listener);
+}
+
+const Clip *MidiRecorder::getRecordingClip() const noexcept
+{
+    return this->activeClip;
+}
+
+const Array<Note> &MidiRecorder::getRecordedNotes() const noexcept
+{
+    return this->recordedNotes;
+}
+
 //===----------------------------------------------------------------------===//
 // Helpers
 //===----------------------------------------------------------------------===//
 
-void MidiRecorder::startHoldingNote(MidiMessage message)
+void MidiRecorder::startHoldingNote(int key, double beat, float velocity)
 {
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
-    const auto key = message.getNoteNumber();
-    
     if (this->holdingNotes.contains(key))
     {
         DBG("Found weird note-on/note-off order");
-        this->finaliseHoldingNote(key);
+        this->finaliseHoldingNote(key, beat);
     }
 
     const Note noteParams(this->activeTrack->getSequence(),
         key - this->activeClip->getKey(),
-        roundBeat(float(message.getTimeStamp()) - this->activeClip->getBeat()),
+        roundBeat(float(beat) - this->activeClip->getBeat()),
         Globals::minNoteLength,
-        float(message.getVelocity()) / 128.f);
+        velocity);
+
+    this->holdingNotes[key] = this->recordedNotes.size();
+    this->recordedNotes.add(noteParams);
 
-    this->getPianoSequence()->insert(noteParams, true);
-    this->holdingNotes[key] = noteParams;
+    const Array<Note> changedNotes(noteParams);
+    this->listeners.call(&Listener::onChangeRecordedNotes, changedNotes, changedNotes);
 }
 
-void MidiRecorder::updateLengthsOfHoldingNotes() const
+void MidiRecorder::updateLengthsOfHoldingNotes()
 {
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
     if (this->holdingNotes.empty())
     {
-        //DBG("Skip 1");
         return;
     }
 
@@ -363,18 +423,22 @@ void MidiRecorder::updateLengthsOfHoldingNotes() const
 
     for (const auto &i : this->holdingNotes)
     {
-        const auto newLength = roundBeat(currentBeat - i.second.getBeat());
-        if (i.second.getLength() == newLength)
+        auto &note = this->recordedNotes.getReference(i.second);
+        const auto newLength = jmax(Globals::minNoteLength,
+            roundBeat(currentBeat - note.getBeat()));
+
+        if (note.getLength() != newLength)
         {
-            //DBG("Skip 2");
-            return;
+            groupBefore.add(note);
+            note = note.withLength(newLength);
+            groupAfter.add(note);
         }
-
-        groupBefore.add(i.second);
-        groupAfter.add(i.second.withLength(newLength));
     }
 
-    this->getPianoSequence()->changeGroup(groupBefore, groupAfter, true);
+    if (!groupAfter.isEmpty())
+    {
+        this->listeners.call(&Listener::onChangeRecordedNotes, groupBefore, groupAfter);
+    }
 }
 
 void MidiRecorder::finaliseAllHoldingNotes()
@@ -387,24 +451,138 @@ void MidiRecorder::finaliseAllHoldingNotes()
     this->holdingNotes.clear();
 }
 
-bool MidiRecorder::finaliseHoldingNote(int key)
+bool MidiRecorder::finaliseHoldingNote(int key, double beat)
 {
     jassert(this->activeClip != nullptr);
     jassert(this->activeTrack != nullptr);
 
-    const auto currentBeat =
-        float(this->getEstimatedPosition() - this->activeClip->getBeat());
+    const auto noteOffBeat = float(beat) - this->activeClip->getBeat();
 
-    if (this->holdingNotes.contains(key))
+    const auto found = this->holdingNotes.find(key);
+    if (found == this->holdingNotes.end())
     {
-        const auto &note = this->holdingNotes[key];
-        const auto newLength = roundBeat(currentBeat - note.getBeat());
-        this->getPianoSequence()->change(note, note.withLength(newLength), true);
-        this->holdingNotes.erase(key);
-        return true;
+        return false;
     }
 
-    return false;
+    auto &note = this->recordedNotes.getReference(found->second);
+    const auto newLength = jmax(Globals::minNoteLength,
+        roundBeat(noteOffBeat - note.getBeat()));
+
+    const Array<Note> notesBefore(note);
+    note = note.withLength(newLength);
+    const Array<Note> notesAfter(note);
+
+    this->holdingNotes.erase(found);
+    this->listeners.call(&Listener::onChangeRecordedNotes, notesBefore, notesAfter);
+    return true;
+}
+
+// all recorded notes of the last take go into one group insert action,
+// so that the sequence and all project listeners only
+// get updated once, and it's a single step to undo
+void MidiRecorder::commitRecordedNotes()
+{
+    this->finaliseAllHoldingNotes();
+    this->finishTake();
+
+    if (this->takes.isEmpty() || this->committedTakeIndex >= 0)
+    {
+        return;
+    }
+
+    if (this->activeTrack != nullptr)
+    {
+        auto notes = this->takes.getLast();
+        this->getPianoSequence()->insertGroup(notes, true);
+        this->committedTakeIndex = this->takes.size() - 1;
+        this->takesTrack = this->activeTrack;
+    }
+    else
+    {
+        this->takes.clearQuick();
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Loop recording takes
+//===----------------------------------------------------------------------===//
+
+int MidiRecorder::getNumTakes() const noexcept
+{
+    return this->takes.size();
+}
+
+int MidiRecorder::getCommittedTakeIndex() const noexcept
+{
+    return this->committedTakeIndex;
+}
+
+const MidiTrack *MidiRecorder::getTakesTrack() const noexcept
+{
+    return this->takesTrack.get();
+}
+
+bool MidiRecorder::pickTake(int takeIndex)
+{
+    if (this->isRecording.get() || this->takesTrack == nullptr ||
+        !isPositiveAndBelow(takeIndex, this->takes.size()))
+    {
+        return false;
+    }
+
+    auto *sequence = static_cast<PianoSequence *>(this->takesTrack->getSequence());
+
+    // whatever take is in the sequence now (the notes might have been edited,
+    // or the picking might have been undone), it's found by the note ids
+    FlatHashSet<MidiEvent::Id> takesNoteIds;
+    for (const auto &take : this->takes)
+    {
+        for (const auto &note : take)
+        {
+            takesNoteIds.insert(note.getId());
+        }
+    }
+
+    Array<Note> notesToRemove;
+    for (const auto *event : *sequence)
+    {
+        if (takesNoteIds.contains(event->getId()))
+        {
+            notesToRemove.add(*static_cast<const Note *>(event));
+        }
+    }
+
+    auto notesToInsert = this->takes.getReference(takeIndex);
+
+    sequence->checkpoint();
+
+    if (!notesToRemove.isEmpty())
+    {
+        sequence->removeGroup(notesToRemove, true);
+    }
+
+    sequence->insertGroup(notesToInsert, true);
+    this->committedTakeIndex = takeIndex;
+    return true;
+}
+
+void MidiRecorder::finishTake()
+{
+    if (this->recordedNotes.isEmpty())
+    {
+        return;
+    }
+
+    this->takes.add(move(this->recordedNotes));
+    this->recordedNotes.clearQuick();
+    this->listeners.call(&Listener::onClearRecordedNotes);
+}
+
+void MidiRecorder::clearTakes()
+{
+    this->takes.clearQuick();
+    this->committedTakeIndex = -1;
+    this->takesTrack = nullptr;
 }
 
 PianoSequence *MidiRecorder::getPianoSequence() const
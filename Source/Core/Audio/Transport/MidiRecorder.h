@@ -39,6 +39,49 @@ public:
 
     void setTargetScope(const Clip *clip, const String &instrumentId);
 
+    //===------------------------------------------------------------------===//
+    // Recording preview
+    //===------------------------------------------------------------------===//
+
+    // while recording, the notes are not inserted into the sequence
+    // one by one, but are kept in the staging buffer, and committed as
+    // a single undo action when the recording stops or the target changes;
+    // until then, the editors may display them as a lightweight overlay:
+    class Listener
+    {
+    public:
+
+        virtual ~Listener() = default;
+
+        // the note bounds before and after the change,
+        // so that listeners can repaint only the affected areas
+        virtual void onChangeRecordedNotes(const Array<Note> &notesBefore,
+            const Array<Note> &notesAfter) = 0;
+
+        virtual void onClearRecordedNotes() = 0;
+    };
+
+    void addListener(Listener *listener);
+    void removeListener(Listener *listener);
+
+    const Clip *getRecordingClip() const noexcept;
+    const Array<Note> &getRecordedNotes() const noexcept;
+
+    //===------------------------------------------------------------------===//
+    // Loop recording takes
+    //===------------------------------------------------------------------===//
+
+    // in the loop mode, each pass is recorded into a separate take,
+    // which is never a part of the sequence (and the playback cache),
+    // and when the recording stops, only the last take is inserted;
+    // any other take can be picked instead afterwards, which replaces
+    // the notes of the committed one in that single track
+
+    int getNumTakes() const noexcept;
+    int getCommittedTakeIndex() const noexcept;
+    const MidiTrack *getTakesTrack() const noexcept;
+    bool pickTake(int takeIndex);
+
 private:
 
     //===------------------------------------------------------------------===//
@@ -84,17 +127,56 @@ private:
 
     PianoSequence *getPianoSequence() const;
 
-    Array<MidiMessage, CriticalSection> noteOnsBuffer;
-    Array<MidiMessage, CriticalSection> noteOffsBuffer;
-    Array<MidiMessage> unhandledNoteOffs;
-
-    FlatHashMap<int, Note> holdingNotes;
-    void startHoldingNote(MidiMessage message);
-    void updateLengthsOfHoldingNotes() const;
+    // note events are stamped with their beat position on the midi thread,
+    // using the device timestamp, and pushed into this fixed-size queue,
+    // so that the recorded timing doesn't depend on the message thread's load;
+    // the message thread then commits them to the sequence in batches
+    struct RecordedEvent final
+    {
+        double beat = 0.0;
+        int key = 0;
+        float velocity = 0.f;
+        bool isNoteOn = false;
+    };
+
+    static constexpr auto maxNumRecordedEvents = 1024;
+    RecordedEvent recordedEvents[MidiRecorder::maxNumRecordedEvents];
+    AbstractFifo recordedEventsFifo { MidiRecorder::maxNumRecordedEvents };
+
+    // the fifo only supports a single writer, but different devices
+    // may call back from different threads; this lock is never taken
+    // by the reader, so the contention is limited to the midi threads
+    SpinLock recordedEventsWriterLock;
+
+    void pushRecordedEvent(const RecordedEvent &event);
+    void commitRecordedEvents(bool canStartPlayback);
+
+    // all notes recorded since the last commit, including the holding ones,
+    // which are referred to by their index in this array
+    Array<Note> recordedNotes;
+    FlatHashMap<int, int> holdingNotes;
+    void startHoldingNote(int key, double beat, float velocity);
+    void updateLengthsOfHoldingNotes();
     void finaliseAllHoldingNotes();
-    bool finaliseHoldingNote(int key);
+    bool finaliseHoldingNote(int key, double beat);
+
+    void commitRecordedNotes();
+
+    // the notes of the finished passes, since the recording has started
+    Array<Array<Note>> takes;
+    int committedTakeIndex = -1;
+    WeakReference<MidiTrack> takesTrack;
+    void finishTake();
+    void clearTakes();
+
+    ListenerList<Listener> listeners;
 
+    // the beat heard at a given point of Time::getMillisecondCounterHiRes(),
+    // i.e. the beat played that long before, as the output latency, since
+    // that's what the musician is playing along with
+    double getEstimatedPosition(double timeMs) const;
     double getEstimatedPosition() const;
+    Atomic<double> outputLatencyMs = 0.0;
 
     // no need for updating too often, I guess:
     static constexpr auto updateTimeHz = 15;
@@ -18,28 +18,117 @@
 #include "Common.h"
 
 #include "PlayerThread.h"
+#include "Workspace.h"
 
 PlayerThread::PlayerThread(Transport &transport) :
     Thread("PlayerThread"),
-    transport(transport) {}
+    transport(transport)
+{
+    this->startThread(10);
+}
 
 PlayerThread::~PlayerThread()
 {
+    this->signalThreadShouldExit();
+    this->notify();
     this->stopThread(PlayerThread::minStopCheckTimeMs * 2);
+
+    delete this->pendingCommand.exchange(nullptr);
 }
 
 //===----------------------------------------------------------------------===//
-// Thread
+// Commands
 //===----------------------------------------------------------------------===//
 
-void PlayerThread::startPlayback(Transport::PlaybackContext::Ptr context)
+void PlayerThread::startPlayback(float startBeat, float rewindBeat, float endBeat, bool loopMode)
 {
-    this->context = context;
-    this->sequences = this->transport.getPlaybackCache();
-    this->startThread(10);
+    auto playbackContext = this->transport.fillPlaybackContextAt(startBeat);
+    playbackContext->endBeat = endBeat;
+    playbackContext->rewindBeat = rewindBeat;
+    playbackContext->playbackLoopMode = loopMode;
+
+    // let listeners know about the tempo before the playback starts
+    this->transport.broadcastTempoChanged(playbackContext->startBeatTempo);
+
+    // the copy is cheap, since the merged timeline is shared between copies
+    auto *command = new Command();
+    command->context = playbackContext;
+    command->sequences = this->transport.getPlaybackCache();
+
+    // the instruments' graphs are only safe to inspect on the message thread
+    command->midiOutput = App::Workspace().getAudioCore().getMidiOutput();
+    if (command->midiOutput != nullptr)
+    {
+        for (int i = 0; i < command->sequences.getNumTargets(); ++i)
+        {
+            command->midiOutputTargets.add(command->sequences
+                .getTargetInstrument(i)->isRoutedToMidiOutput());
+        }
+    }
+
+    this->isPlaybackRunning = true;
+    this->sendCommand(command);
+}
+
+void PlayerThread::stopPlayback()
+{
+    // the thread might be waiting for the next midi event,
+    // so it will only stop when it wakes up
+    this->isPlaybackRunning = false;
+    this->sendCommand(new Command());
+}
+
+bool PlayerThread::isPlaying() const noexcept
+{
+    return this->isPlaybackRunning.get();
+}
+
+void PlayerThread::sendCommand(Command *command)
+{
+    // if the previous command has not been picked up yet, it's just
+    // outdated (e.g. while scrubbing), so only the latest one is kept
+    delete this->pendingCommand.exchange(command);
+    this->notify();
+}
+
+bool PlayerThread::shouldInterruptPlayback() const
+{
+    return this->pendingCommand.get() != nullptr || this->threadShouldExit();
 }
 
+//===----------------------------------------------------------------------===//
+// Thread
+//===----------------------------------------------------------------------===//
+
 void PlayerThread::run()
+{
+    while (!this->threadShouldExit())
+    {
+        UniquePointer<Command> command(this->pendingCommand.exchange(nullptr));
+        if (command == nullptr)
+        {
+            this->wait(PlayerThread::minStopCheckTimeMs);
+            continue;
+        }
+
+        if (command->context != nullptr)
+        {
+            this->context = command->context;
+            this->sequences = move(command->sequences);
+            this->midiOutput = move(command->midiOutput);
+            this->midiOutputTargets = move(command->midiOutputTargets);
+            this->play();
+            this->context = nullptr;
+            this->midiOutput = nullptr;
+
+#if HELIO_TRACING
+            DBG("Playback timing: " + this->timingStats.toString());
+#endif
+        }
+    }
+}
+
+void PlayerThread::play()
 {
     Array<Instrument *> uniqueInstruments;
     uniqueInstruments.addArray(this->sequences.getUniqueInstruments());
@@ -53,21 +142,41 @@ void PlayerThread::run()
 
     const bool isLooped = this->context->playbackLoopMode;
 
-    this->sequences.seekToTime(this->context->startBeat);
+    this->sequences.seekToBeat(this->context->startBeat);
 
     Atomic<float> previousEventBeat = this->context->startBeat;
     broadcastSeek(previousEventBeat);
 
     // This hack is here to keep track of still playing events
-    // to be able to send noteOff's when playback interrupts.
-    struct HoldingNote final
+    // to be able to send noteOff's when playback interrupts
+    // (some plugins just don't understand allNotesOff message);
+    // each target's notes are bits indexed by channel and key,
+    // so adding and removing a note is O(1):
+    static constexpr auto numKeys = 128;
+    const auto numTargets = this->sequences.getNumTargets();
+    Array<BigInteger> holdingNotes;
+    holdingNotes.resize(numTargets);
+    for (auto &notes : holdingNotes)
     {
-        int key;
-        int channel;
-        MidiMessageCollector *listener;
+        notes.setRange(0, Globals::numChannels * numKeys, false);
+    }
+
+    auto getHoldingNoteBit = [](int channel, int key)
+    {
+        return (channel - 1) * numKeys + key;
     };
-    // (some plugins just don't understand allNotesOff message)
-    Array<HoldingNote> holdingNotes;
+
+    // In the sample-accurate mode, the note-offs are scheduled up to
+    // the lookahead time ahead, and the stop cancels the ones not yet due,
+    // so they are kept here, in the order of their times, until they are played:
+    struct PendingNoteOff final
+    {
+        int targetIndex;
+        int bit;
+        double timeMs;
+    };
+
+    Array<PendingNoteOff> pendingNotesOff;
     
     // Some shorthands:
     auto sendMidiStart = [&uniqueInstruments]()
@@ -102,13 +211,165 @@ void PlayerThread::run()
         }
     };
 
-    auto sendHoldingNotesOffAndMidiStop = [&holdingNotes, &uniqueInstruments]()
+    // In the sample-accurate mode, each instrument's sample clock is anchored
+    // at the playback start plus the lookahead time, and all events are
+    // scheduled at the sample positions computed from their time offsets;
+    // this mode needs all instruments' audio callbacks to be running:
+    bool sampleAccurate = this->context->sampleAccurateMode;
+    for (auto &instrument : uniqueInstruments)
     {
-        for (const auto &holding : holdingNotes)
+        sampleAccurate = sampleAccurate &&
+            instrument->getProcessorPlayer().getSampleRate() > 0.0;
+    }
+
+    Array<int64> sampleAnchors;
+    if (sampleAccurate)
+    {
+        for (int i = 0; i < numTargets; ++i)
+        {
+            auto &player = this->sequences.getTargetInstrument(i)->getProcessorPlayer();
+            sampleAnchors.add(player.getSamplePosition() + int64(player.getSampleRate() *
+                PlayerThread::sampleAccurateLookaheadMs * 0.001));
+        }
+    }
+
+    // The frozen instruments play their pre-rendered audio instead of the events,
+    // so they only need to know which frame to play at which sample position,
+    // which is set at the playback start and at each rewind
+    Array<Instrument *> frozenInstruments;
+    Array<int64> frozenAnchors;
+    for (auto &instrument : uniqueInstruments)
+    {
+        auto &player = instrument->getProcessorPlayer();
+        if (player.isFrozen())
+        {
+            frozenInstruments.add(instrument);
+            frozenAnchors.add(player.getSamplePosition() + int64(player.getSampleRate() *
+                PlayerThread::sampleAccurateLookaheadMs * 0.001));
+        }
+    }
+
+    const auto &tempoMap = this->sequences.getTempoMap();
+    auto seekFrozenAudio = [&frozenInstruments, &frozenAnchors, &tempoMap, sampleAccurate]
+        (float beat, double offsetMs)
+    {
+        for (int i = 0; i < frozenInstruments.size(); ++i)
+        {
+            auto &player = frozenInstruments.getUnchecked(i)->getProcessorPlayer();
+            const auto frozenAudio = player.getFrozenAudio();
+            if (frozenAudio == nullptr)
+            {
+                continue;
+            }
+
+            // without the sample-accurate scheduling, the events are played
+            // as soon as possible, and so should be the frozen audio
+            const auto sampleRate = player.getSampleRate();
+            const auto position = sampleAccurate ?
+                frozenAnchors[i] + int64(offsetMs * 0.001 * sampleRate) :
+                player.getSamplePosition();
+
+            const auto frame = tempoMap.getSamplePositionAt(beat, frozenAudio->startTimeMs, sampleRate);
+            player.seekFrozenAudio(position, frame);
+        }
+    };
+
+    const auto playbackStartTime = Time::getMillisecondCounter();
+#if HELIO_TRACING
+    this->timingStats.reset(sampleAccurate);
+#endif
+
+    auto scheduleMessage = [this, &sampleAnchors]
+        (const MidiMessage &message, int targetIndex, double offsetMs)
+    {
+        auto &player = this->sequences.getTargetInstrument(targetIndex)->getProcessorPlayer();
+        const auto offsetSamples = int64(offsetMs * 0.001 * player.getSampleRate());
+        if (!player.scheduleMessage(message, sampleAnchors[targetIndex] + offsetSamples))
+        {
+            // the schedule queue is full, so just play it as soon as possible
+            player.getMidiMessageCollector().addMessageToQueue(message);
+        }
+    };
+
+    // The events of the instruments routed to the MIDI output node are also
+    // sent to the hardware output, timestamped at the same moments as they
+    // are scheduled for the audio clocks, and the output's thread sends them
+    // when they are due; the meta events only make sense for the plugins
+    auto *hardwareOutput = (this->midiOutput != nullptr &&
+        this->midiOutputTargets.contains(true)) ? &this->midiOutput->getOutput() : nullptr;
+
+    const auto midiOutputStartTimeMs = double(playbackStartTime) +
+        (sampleAccurate ? double(PlayerThread::sampleAccurateLookaheadMs) : 0.0);
+
+    auto sendToMidiOutput = [this, hardwareOutput, midiOutputStartTimeMs]
+        (const MidiMessage &message, int targetIndex, double offsetMs)
+    {
+        if (hardwareOutput == nullptr || message.isMetaEvent() ||
+            !this->midiOutputTargets[targetIndex])
+        {
+            return;
+        }
+
+        MidiBuffer buffer;
+        buffer.addEvent(message, 0);
+        // with 1000 samples per second, the buffer's positions are milliseconds
+        hardwareOutput->sendBlockOfMessages(buffer, midiOutputStartTimeMs + offsetMs, 1000.0);
+    };
+
+    auto sendHoldingNotesOffAndMidiStop = [this, &holdingNotes, &pendingNotesOff, hardwareOutput,
+        &uniqueInstruments, &frozenInstruments, numTargets, sampleAccurate]()
+    {
+        for (auto *instrument : frozenInstruments)
+        {
+            instrument->getProcessorPlayer().stopFrozenAudio();
+        }
+
+        if (sampleAccurate)
+        {
+            for (auto &instrument : uniqueInstruments)
+            {
+                instrument->getProcessorPlayer().cancelScheduledMessages();
+            }
+
+            // the cancelled note-offs are sent along with the holding notes;
+            // some of them might have been played already, which is harmless
+            const auto nowMs = Time::getMillisecondCounterHiRes();
+            for (const auto &noteOff : pendingNotesOff)
+            {
+                if (noteOff.timeMs > nowMs)
+                {
+                    holdingNotes.getReference(noteOff.targetIndex).setBit(noteOff.bit);
+                }
+            }
+
+            pendingNotesOff.clearQuick();
+        }
+
+        for (int i = 0; i < numTargets; ++i)
+        {
+            auto *listener = this->sequences.getTargetListener(i);
+            const auto &notes = holdingNotes.getReference(i);
+            for (int bit = notes.findNextSetBit(0); bit >= 0; bit = notes.findNextSetBit(bit + 1))
+            {
+                const auto channel = bit / numKeys + 1;
+                const auto key = bit % numKeys;
+                MidiMessage noteOff(MidiMessage::noteOff(channel, key, 0.f));
+                noteOff.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
+                listener->addMessageToQueue(noteOff);
+            }
+        }
+
+        if (hardwareOutput != nullptr)
         {
-            MidiMessage noteOff(MidiMessage::noteOff(holding.channel, holding.key, 0.f));
-            noteOff.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
-            holding.listener->addMessageToQueue(noteOff);
+            // the pending note-offs are dropped as well, but unlike
+            // the plugins, the hardware understands all-notes-off
+            hardwareOutput->clearAllPendingMessages();
+            for (int channel = 1; channel <= Globals::numChannels; ++channel)
+            {
+                hardwareOutput->sendMessageNow(MidiMessage::allNotesOff(channel));
+            }
+
+            hardwareOutput->sendMessageNow(MidiMessage::midiStop());
         }
         
         MidiMessage stopPlayback(MidiMessage::midiStop());
@@ -121,23 +382,73 @@ void PlayerThread::run()
         }
         
         // Wait until all plugins process the messages in their queues
-        Thread::sleep(50);
+        for (auto &instrument : uniqueInstruments)
+        {
+            instrument->getProcessorPlayer().waitForMessagesFlush(PlayerThread::maxFlushWaitTimeMs);
+        }
     };
     
-    auto sendTempoChangeToEverybody =
-        [&uniqueInstruments](const MidiMessage &tempoEvent)
+    auto sendTempoChangeToEverybody = [this, &scheduleMessage, numTargets,
+        sampleAccurate](const MidiMessage &tempoEvent, double offsetMs)
     {
-        for (auto &instrument : uniqueInstruments)
+        for (int i = 0; i < numTargets; ++i)
+        {
+            if (sampleAccurate)
+            {
+                scheduleMessage(tempoEvent, i, offsetMs);
+            }
+            else
+            {
+                this->sequences.getTargetListener(i)->addMessageToQueue(tempoEvent);
+            }
+        }
+    };
+
+    // Sleeps until the given millisecond counter value, waking up
+    // as soon as a new command arrives, and then spins for the last
+    // couple of milliseconds which the wait might oversleep;
+    // returns false if the playback should be interrupted
+    auto waitUntil = [this](uint32 targetTime)
+    {
+        int timeLeft = int(targetTime - Time::getMillisecondCounter());
+        while (timeLeft > PlayerThread::minWaitTimeMs)
         {
-            instrument->getProcessorPlayer().
-                getMidiMessageCollector().addMessageToQueue(tempoEvent);
+            this->wait(timeLeft - PlayerThread::minWaitTimeMs);
+            if (this->shouldInterruptPlayback())
+            {
+                return false;
+            }
+
+            timeLeft = int(targetTime - Time::getMillisecondCounter());
         }
+
+        Time::waitForMillisecondCounter(targetTime);
+        return !this->shouldInterruptPlayback();
+    };
+
+    // The wall clock wake-up time for the event: in the default mode, it is
+    // relative to the previous event, so the timing errors are accumulated;
+    // in the sample-accurate mode, it only needs to be roughly in time
+    // to schedule the event ahead, and it's counted from the playback start
+    const auto startBeatTimeMs = this->context->startBeatTimeMs;
+    auto getTargetTime = [playbackStartTime, startBeatTimeMs, sampleAccurate]
+        (double nextEventTimeMs, double nextEventTimeDelta)
+    {
+        return sampleAccurate ?
+            playbackStartTime + uint32(nextEventTimeMs - startBeatTimeMs) :
+            Time::getMillisecondCounter() + uint32(nextEventTimeDelta);
     };
 
     // And here we go.
 
     sendMidiStart();
+    if (hardwareOutput != nullptr)
+    {
+        hardwareOutput->sendMessageNow(MidiMessage::midiStart());
+    }
+
     sendControllerStates();
+    seekFrozenAudio(this->context->startBeat, 0.0);
 
     double nextEventTimeDelta = 0.0;
     auto currentTimeMs = this->context->startBeatTimeMs;
@@ -152,41 +463,32 @@ void PlayerThread::run()
         {
             nextEventTimeDelta = currentTempo.get() *
                 (this->context->endBeat - previousEventBeat.get());
+            currentTimeMs += nextEventTimeDelta;
 
-            const uint32 targetTime =
-                Time::getMillisecondCounter() + uint32(nextEventTimeDelta);
-
-            // Give thread a chance to exit by checking at least once a, say, second
-            while (nextEventTimeDelta > PlayerThread::minStopCheckTimeMs)
+            if (!waitUntil(getTargetTime(currentTimeMs, nextEventTimeDelta)))
             {
-                nextEventTimeDelta -= PlayerThread::minStopCheckTimeMs;
-                Thread::sleep(PlayerThread::minStopCheckTimeMs);
-                if (this->threadShouldExit())
-                {
-                    sendHoldingNotesOffAndMidiStop();
-                    return; // the transport have already stopped
-                }
+                sendHoldingNotesOffAndMidiStop();
+                return; // the transport have already stopped
             }
 
-            Time::waitForMillisecondCounter(targetTime);
-
             if (isLooped)
             {
-                this->sequences.seekToTime(this->context->rewindBeat);
+                this->sequences.seekToBeat(this->context->rewindBeat);
                 previousEventBeat = this->context->rewindBeat;
+                seekFrozenAudio(this->context->rewindBeat, currentTimeMs - startBeatTimeMs);
                 broadcastSeek(previousEventBeat);
                 continue;
             }
             else
             {
-                while (this->transport.isRecording() && !this->threadShouldExit())
+                while (this->transport.isRecording() && !this->shouldInterruptPlayback())
                 {
-                    Thread::sleep(PlayerThread::minStopCheckTimeMs);
+                    this->wait(PlayerThread::minStopCheckTimeMs);
                 }
 
                 sendHoldingNotesOffAndMidiStop();
 
-                if (this->threadShouldExit())
+                if (this->shouldInterruptPlayback())
                 {
                     return; // the transport have already stopped
                 }
@@ -215,21 +517,7 @@ void PlayerThread::run()
         // Zero-delay check (we're playing a chord or so)
         if (uint32(nextEventTimeDelta) != 0)
         {
-            const uint32 targetTime = Time::getMillisecondCounter() + uint32(nextEventTimeDelta);
-            while (nextEventTimeDelta > PlayerThread::minStopCheckTimeMs)
-            {
-                nextEventTimeDelta -= PlayerThread::minStopCheckTimeMs;
-                Thread::sleep(PlayerThread::minStopCheckTimeMs);
-                if (this->threadShouldExit())
-                {
-                    sendHoldingNotesOffAndMidiStop();
-                    return;
-                }
-            }
-
-            Time::waitForMillisecondCounter(targetTime);
-
-            if (this->threadShouldExit())
+            if (!waitUntil(getTargetTime(currentTimeMs, nextEventTimeDelta)))
             {
                 sendHoldingNotesOffAndMidiStop();
                 return;
@@ -240,15 +528,22 @@ void PlayerThread::run()
         
         if (shouldRewind)
         {
-            this->sequences.seekToTime(this->context->rewindBeat);
+            this->sequences.seekToBeat(this->context->rewindBeat);
             previousEventBeat = this->context->rewindBeat;
+            seekFrozenAudio(this->context->rewindBeat, currentTimeMs - startBeatTimeMs);
             broadcastSeek(previousEventBeat);
         }
         else
         {
             const int key = wrapper.message.getNoteNumber();
             const int channel = wrapper.message.getChannel();
-            wrapper.message.setTimeStamp(Time::getMillisecondCounterHiRes() * 0.001);
+            const auto enqueueTimeMs = Time::getMillisecondCounterHiRes();
+            wrapper.message.setTimeStamp(enqueueTimeMs * 0.001);
+
+#if HELIO_TRACING
+            this->timingStats.addEvent(currentTimeMs - startBeatTimeMs,
+                enqueueTimeMs - double(playbackStartTime));
+#endif
             
             // Master tempo event is sent to everybody
             if (wrapper.message.isTempoMetaEvent())
@@ -257,29 +552,41 @@ void PlayerThread::run()
                 this->transport.broadcastTempoChanged(currentTempo.get());
 
                 // Sends this to everybody (need to do that for drum-machines) - TODO test
-                sendTempoChangeToEverybody(wrapper.message);
+                sendTempoChangeToEverybody(wrapper.message, currentTimeMs - startBeatTimeMs);
+            }
+            else if (sampleAccurate)
+            {
+                scheduleMessage(wrapper.message, wrapper.targetIndex, currentTimeMs - startBeatTimeMs);
             }
             else
             {
                 wrapper.listener->addMessageToQueue(wrapper.message);
             }
+
+            sendToMidiOutput(wrapper.message, wrapper.targetIndex, currentTimeMs - startBeatTimeMs);
             
             if (wrapper.message.isNoteOn())
             {
-                holdingNotes.add({ key, channel, wrapper.listener });
+                holdingNotes.getReference(wrapper.targetIndex)
+                    .setBit(getHoldingNoteBit(channel, key));
             }
-            
-            if (wrapper.message.isNoteOff())
+            else if (wrapper.message.isNoteOff())
             {
-                for (int i = 0; i < holdingNotes.size(); ++i)
+                holdingNotes.getReference(wrapper.targetIndex)
+                    .clearBit(getHoldingNoteBit(channel, key));
+
+                if (sampleAccurate)
                 {
-                    if (holdingNotes[i].key == key &&
-                        holdingNotes[i].channel == channel &&
-                        holdingNotes[i].listener == wrapper.listener)
+                    int numPlayed = 0;
+                    while (numPlayed < pendingNotesOff.size() &&
+                        pendingNotesOff.getReference(numPlayed).timeMs <= enqueueTimeMs)
                     {
-                        holdingNotes.remove(i);
-                        break;
+                        numPlayed++;
                     }
+
+                    pendingNotesOff.removeRange(0, numPlayed);
+                    pendingNotesOff.add({ wrapper.targetIndex, getHoldingNoteBit(channel, key),
+                        midiOutputStartTimeMs + currentTimeMs - startBeatTimeMs });
                 }
             }
         }
@@ -287,3 +594,68 @@ void PlayerThread::run()
     
     jassertfalse;
 }
+
+//===----------------------------------------------------------------------===//
+// Timing stats
+//===----------------------------------------------------------------------===//
+
+void PlayerThread::TimingStats::reset(bool isSampleAccurate) noexcept
+{
+    zeromem(this->histogram, sizeof(this->histogram));
+    this->numEvents = 0;
+    this->totalDifferenceMs = 0.0;
+    this->maxLatenessMs = 0.0;
+    this->maxEarlinessMs = 0.0;
+    this->sampleAccurate = isSampleAccurate;
+}
+
+void PlayerThread::TimingStats::addEvent(double scheduledTimeMs, double actualTimeMs) noexcept
+{
+    auto differenceMs = actualTimeMs - scheduledTimeMs;
+
+    // in the sample-accurate mode, the events are scheduled ahead, so the ones
+    // sent early, or up to the lookahead time late, are still played in time
+    if (this->sampleAccurate)
+    {
+        differenceMs = jmax(0.0, differenceMs - double(PlayerThread::sampleAccurateLookaheadMs));
+    }
+
+    const auto bin = jmin(TimingStats::numBins - 1,
+        int(std::abs(differenceMs) / TimingStats::binSizeMs));
+
+    this->histogram[bin]++;
+    this->numEvents++;
+    this->totalDifferenceMs += std::abs(differenceMs);
+    this->maxLatenessMs = jmax(this->maxLatenessMs, differenceMs);
+    this->maxEarlinessMs = jmax(this->maxEarlinessMs, -differenceMs);
+}
+
+String PlayerThread::TimingStats::toString() const
+{
+    String result;
+    result << (this->sampleAccurate ? "sample-accurate" : "default") << " mode, "
+        << this->numEvents << " events";
+
+    if (this->numEvents == 0)
+    {
+        return result;
+    }
+
+    // in the sample-accurate mode, only the lateness beyond the lookahead is counted
+    result << ", mean " << String(this->totalDifferenceMs / this->numEvents, 2) << " ms"
+        << ", worst late " << String(this->maxLatenessMs, 2) << " ms"
+        << ", worst early " << String(this->maxEarlinessMs, 2) << " ms"
+        << ", histogram:";
+
+    for (int i = 0; i < TimingStats::numBins; ++i)
+    {
+        if (this->histogram[i] > 0)
+        {
+            const auto binStartMs = String(i * TimingStats::binSizeMs, 1);
+            result << " " << binStartMs << (i < TimingStats::numBins - 1 ? "" : "+")
+                << " ms: " << this->histogram[i];
+        }
+    }
+
+    return result;
+}
@@ -18,27 +18,96 @@
 #pragma once
 
 #include "Transport.h"
+#include "AudioCore.h"
 
-class PlayerThread final : public Thread
+// A single long-lived playback scheduler: the transport sends it
+// start (also used for seeking and looping) and stop commands,
+// and it never gets restarted or recreated between playbacks
+class PlayerThread final : private Thread
 {
 public:
 
     explicit PlayerThread(Transport &transport);
     ~PlayerThread() override;
 
-    void startPlayback(Transport::PlaybackContext::Ptr context);
+    void startPlayback(float startBeat, float rewindBeat, float endBeat, bool loopMode);
+    void stopPlayback();
+    bool isPlaying() const noexcept;
 
 private:
 
+    // a stop command has no context
+    struct Command final
+    {
+        Transport::PlaybackContext::Ptr context;
+        TransportPlaybackCache sequences;
+
+        // the hardware output, and which of the sequences'
+        // targets are sent to it, see AudioCore::getMidiOutput
+        AudioCore::MidiOutputDevice::Ptr midiOutput;
+        Array<bool> midiOutputTargets;
+    };
+
+    void sendCommand(Command *command);
+    bool shouldInterruptPlayback() const;
+
     void run() override;
+    void play();
+
+    // the differences between the events' scheduled times and the times
+    // they are actually sent to the instruments, collected during each
+    // playback and logged when it stops, to see how sloppy the timing is;
+    // only used in the builds with HELIO_TRACING=1
+    class TimingStats final
+    {
+    public:
+
+        void reset(bool sampleAccurate) noexcept;
+        void addEvent(double scheduledTimeMs, double actualTimeMs) noexcept;
+        String toString() const;
+
+    private:
+
+        static constexpr auto numBins = 16;
+        static constexpr auto binSizeMs = 0.5;
+
+        // binned by the absolute difference,
+        // the last bin also counts everything beyond it
+        int histogram[numBins] = {};
+
+        int numEvents = 0;
+        double totalDifferenceMs = 0.0;
+        double maxLatenessMs = 0.0;
+        double maxEarlinessMs = 0.0;
+        bool sampleAccurate = false;
+    };
 
     Transport &transport;
-    TransportPlaybackCache sequences;
 
+    // the command mailbox is lock-free: senders replace the pending
+    // command, and the thread takes it by exchanging it with nullptr
+    Atomic<Command *> pendingCommand = nullptr;
+    Atomic<bool> isPlaybackRunning = false;
+
+    // only accessed by the thread itself
+    TransportPlaybackCache sequences;
     Transport::PlaybackContext::Ptr context;
+    AudioCore::MidiOutputDevice::Ptr midiOutput;
+    Array<bool> midiOutputTargets;
+    TimingStats timingStats;
 
     // checking if the thread needs to stop at least once a second
     static constexpr auto minStopCheckTimeMs = 1000;
 
+    // Thread::wait might oversleep, so the last few milliseconds are spinned
+    static constexpr auto minWaitTimeMs = 2;
+
+    // in the sample-accurate mode, events are scheduled this much ahead
+    // of the audio clock, so that the thread's wake-up jitter is hidden
+    static constexpr auto sampleAccurateLookaheadMs = 50;
+
+    // how long to wait for the audio thread to process the stop messages
+    static constexpr auto maxFlushWaitTimeMs = 100;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlayerThread)
 };
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "WaveformPeaks.h"
+
 enum class RenderFormat : int8
 {
     FLAC,
@@ -33,3 +35,61 @@ inline String getExtensionForRenderFormat(RenderFormat format) noexcept
 
     return {};
 }
+
+// the result of rendering to memory, see Transport::startRenderToMemory
+struct RenderedAudio final : public ReferenceCountedObject
+{
+    using Ptr = ReferenceCountedObjectPtr<RenderedAudio>;
+    using Callback = Function<void(RenderedAudio::Ptr)>;
+
+    AudioBuffer<float> buffer;
+    double sampleRate = 0.0;
+    double startTimeMs = 0.0; // the buffer start on the project timeline
+    WaveformPeaks::Ptr peaks;
+};
+
+struct RenderOptions final
+{
+    // larger blocks mean less per-block overhead in offline rendering
+    static constexpr int minBlockSize = 512;
+    static constexpr int maxBlockSize = 16384;
+
+    int blockSize = minBlockSize;
+
+    // only used for the graphs that support it,
+    // the others are still rendered in single precision
+    bool doublePrecision = false;
+
+    // 16 or 24-bit integer, or 32-bit float samples (WAV only);
+    // the samples are converted to this format once, by the writer
+    int bitDepth = 16;
+
+    // renders only this range, e.g. the playback loop, instead of the whole project;
+    // the prefix is not rendered, instead, the controller states at the start beat
+    // are sent, and the graphs are run on silence for the warm-up time:
+    float startBeat = 0.f;
+    float endBeat = 0.f;
+    double warmUpSeconds = 1.0;
+
+    bool hasRange() const noexcept
+    {
+        return this->endBeat > this->startBeat;
+    }
+
+    // keep rendering past the project end to capture reverb tails etc,
+    // until the mix gets silent, but no longer than the maximum tail
+    bool renderTail = false;
+    float silenceThresholdDb = -90.f;
+    double maxTailSeconds = 10.0;
+    // a single quiet block (e.g. a pause between delay repeats)
+    // doesn't end the tail, the mix has to stay silent for a while
+    double minSilenceSeconds = 0.5;
+
+    // if set, only the tracks of this instrument are rendered,
+    // see Instrument::getIdAndHash; used to freeze instruments
+    String instrumentId;
+
+    // also write each instrument into its own file next to the mixdown,
+    // in the same pass, named like "<mixdown name> - <n> <instrument name>"
+    bool stems = false;
+};
@@ -34,13 +34,36 @@ float RendererThread::getPercentsComplete() const noexcept
     return this->percentsDone.get();
 }
 
+float RendererThread::getRealtimeFactor() const noexcept
+{
+    return this->realtimeFactor.get();
+}
+
+bool RendererThread::hasSucceeded() const noexcept
+{
+    return this->succeeded.get();
+}
+
 bool RendererThread::startRendering(const URL &target, RenderFormat format,
-    Transport::PlaybackContext::Ptr playbackContext)
+    RenderOptions renderOptions, Transport::PlaybackContext::Ptr playbackContext,
+    Function<void()> onComplete)
 {
     this->stop();
+    this->succeeded = false;
 
     this->format = format;
+    this->options = renderOptions;
+    this->options.blockSize = jlimit(RenderOptions::minBlockSize,
+        RenderOptions::maxBlockSize, this->options.blockSize);
+
+    // FLAC has no floating point samples
+    if (this->options.bitDepth != 24 &&
+        (this->options.bitDepth != 32 || this->format == RenderFormat::FLAC))
+    {
+        this->options.bitDepth = 16;
+    }
     this->context = playbackContext;
+    this->sequences = this->transport.getRenderCache();
 
     // keep the url copy alive while rendering,
     // since on iOS it contains a security bookmark:
@@ -59,47 +82,83 @@ bool RendererThread::startRendering(const URL &target, RenderFormat format,
     if (auto outStream = this->renderTarget.createOutputStream())
     {
         this->percentsDone = 0.f;
-        
-        // 16 bits per sample should be enough for anybody :)
-        // ..wanna fight about it? https://people.xiph.org/~xiphmont/demo/neil-young.html
-        const int bitDepth = 16;
+        this->realtimeFactor = 0.f;
 
-        if (this->format == RenderFormat::WAV)
         {
-            WavAudioFormat wavFormat;
             const ScopedLock sl(this->writerLock);
-            this->writer.reset(wavFormat.createWriterFor(outStream.release(),
-                this->context->sampleRate, this->context->numOutputChannels, bitDepth, {}, 0));
-        }
-        else if (this->format == RenderFormat::FLAC)
-        {
-            FlacAudioFormat flacFormat;
-            const ScopedLock sl(this->writerLock);
-            this->writer.reset(flacFormat.createWriterFor(outStream.release(),
-                this->context->sampleRate, this->context->numOutputChannels, bitDepth, {}, 0));
+            this->writer.reset(this->createWriter(outStream.release(),
+                this->context->numOutputChannels));
         }
 
-        if (writer != nullptr)
+        if (this->writer == nullptr)
         {
-            DBG(this->renderTarget.getLocalFile().getFullPathName());
-            this->startThread(9);
+            return false;
         }
 
+        DBG(this->renderTarget.getLocalFile().getFullPathName());
+        this->onRenderedToFile = onComplete;
+        this->startThread(9);
         return true;
     }
 
     return false;
 }
 
+bool RendererThread::startRenderingToMemory(RenderOptions renderOptions,
+    Transport::PlaybackContext::Ptr playbackContext,
+    RenderedAudio::Callback onComplete)
+{
+    this->stop();
+    this->succeeded = false;
+
+    this->options = renderOptions;
+    this->options.blockSize = jlimit(RenderOptions::minBlockSize,
+        RenderOptions::maxBlockSize, this->options.blockSize);
+    this->options.stems = false;
+    this->context = playbackContext;
+    this->sequences = this->transport.getRenderCache();
+    this->renderTarget = {};
+
+    this->percentsDone = 0.f;
+    this->realtimeFactor = 0.f;
+
+    {
+        const ScopedLock sl(this->writerLock);
+        this->renderedAudio = new RenderedAudio();
+        this->renderedAudio->sampleRate = this->context->sampleRate;
+        this->onRenderedToMemory = onComplete;
+    }
+
+    this->startThread(9);
+    return true;
+}
+
+RenderedAudio::Ptr RendererThread::takeRenderedAudio()
+{
+    jassert(!this->isRendering());
+    const ScopedLock sl(this->writerLock);
+    RenderedAudio::Ptr result(this->renderedAudio);
+    this->renderedAudio = nullptr;
+    return result;
+}
+
 void RendererThread::stop()
 {
+    // the render thread might be waiting for the writer thread's fifo
+    // while holding the writer lock, and it checks the exit flag there;
+    // it's signalled before the writer thread is stopped, so that it
+    // leaves that wait instead of being killed by the timeout
+    this->signalThreadShouldExit();
+    this->writerThread.stopThread(500);
+
     if (this->isThreadRunning())
     {
-        this->stopThread(500);
+        this->stopThread(RendererThread::stopTimeoutMs);
     }
 
     {
         const ScopedLock lock(this->writerLock);
+        this->threadedWriter = nullptr;
         this->writer = nullptr;
     }
 }
@@ -109,6 +168,30 @@ bool RendererThread::isRendering() const
     return this->isThreadRunning();
 }
 
+AudioFormatWriter *RendererThread::createWriter(OutputStream *stream, int numChannels) const
+{
+    // 16 bits per sample should be enough for anybody :)
+    // ..wanna fight about it? https://people.xiph.org/~xiphmont/demo/neil-young.html
+    // (but 24-bit and 32-bit float are there for mastering anyway)
+    const int bitDepth = this->options.bitDepth;
+
+    if (this->format == RenderFormat::WAV)
+    {
+        WavAudioFormat wavFormat;
+        return wavFormat.createWriterFor(stream,
+            this->context->sampleRate, numChannels, bitDepth, {}, 0);
+    }
+    else if (this->format == RenderFormat::FLAC)
+    {
+        FlacAudioFormat flacFormat;
+        return flacFormat.createWriterFor(stream,
+            this->context->sampleRate, numChannels, bitDepth, {}, 0);
+    }
+
+    delete stream;
+    return nullptr;
+}
+
 //===----------------------------------------------------------------------===//
 // Thread
 //===----------------------------------------------------------------------===//
@@ -116,26 +199,248 @@ bool RendererThread::isRendering() const
 struct RenderBuffer final
 {
     Instrument *instrument;
+    bool isDoublePrecision = false;
     AudioBuffer<float> sampleBuffer;
+    AudioBuffer<double> sampleBufferDouble;
     MidiBuffer midiBuffer;
+
+    // lines this instrument up with the slowest one
+    UniquePointer<CompensationDelay<float>> delay;
+    UniquePointer<CompensationDelay<double>> delayDouble;
+
+    // only present in the stems render mode
+    UniquePointer<AudioFormatWriter::ThreadedWriter> stemWriter;
+    AudioBuffer<float> stemBuffer;
+
+    void writeStem(int startSample)
+    {
+        if (this->isDoublePrecision)
+        {
+            this->stemBuffer.makeCopyOf(this->sampleBufferDouble, true);
+        }
+
+        writeRenderedBlock(*this->stemWriter,
+            this->isDoublePrecision ? this->stemBuffer : this->sampleBuffer, startSample);
+    }
+
+    // if the writer thread is behind, the fifo is full,
+    // and we need to wait for it to catch up, unless the render is being
+    // stopped, and the writer thread might be already stopped too
+    static void writeRenderedBlock(AudioFormatWriter::ThreadedWriter &writer,
+        const AudioBuffer<float> &buffer, int startSample)
+    {
+        const auto numSamples = buffer.getNumSamples() - startSample;
+        if (numSamples <= 0)
+        {
+            return;
+        }
+
+        const float *channels[RenderBuffer::maxNumChannels];
+        const auto numChannels = jmin(buffer.getNumChannels(), RenderBuffer::maxNumChannels);
+        for (int i = 0; i < numChannels; ++i)
+        {
+            channels[i] = buffer.getReadPointer(i, startSample);
+        }
+
+        while (!writer.write(channels, numSamples))
+        {
+            if (Thread::currentThreadShouldExit())
+            {
+                return;
+            }
+
+            Thread::sleep(1);
+        }
+    }
+
+    static constexpr auto maxNumChannels = 64;
+
+    void process()
+    {
+        auto *graph = this->instrument->getProcessorGraph();
+        const ScopedLock lock(graph->getCallbackLock());
+
+        if (this->isDoublePrecision)
+        {
+            graph->processBlock(this->sampleBufferDouble, this->midiBuffer);
+            if (this->delayDouble != nullptr)
+            {
+                this->delayDouble->process(this->sampleBufferDouble.getArrayOfWritePointers(),
+                    this->sampleBufferDouble.getNumChannels(), this->sampleBufferDouble.getNumSamples());
+            }
+        }
+        else
+        {
+            graph->processBlock(this->sampleBuffer, this->midiBuffer);
+            if (this->delay != nullptr)
+            {
+                this->delay->process(this->sampleBuffer.getArrayOfWritePointers(),
+                    this->sampleBuffer.getNumChannels(), this->sampleBuffer.getNumSamples());
+            }
+        }
+
+        this->midiBuffer.clear();
+    }
+
+    void addTo(AudioBuffer<float> &mix) const
+    {
+        jassert(!this->isDoublePrecision);
+        for (int channel = 0; channel < mix.getNumChannels(); ++channel)
+        {
+            mix.addFrom(channel, 0, this->sampleBuffer, channel, 0, mix.getNumSamples());
+        }
+    }
+
+    void addTo(AudioBuffer<double> &mix) const
+    {
+        for (int channel = 0; channel < mix.getNumChannels(); ++channel)
+        {
+            if (this->isDoublePrecision)
+            {
+                mix.addFrom(channel, 0, this->sampleBufferDouble, channel, 0, mix.getNumSamples());
+                continue;
+            }
+
+            // single precision graphs are mixed in with the conversion
+            auto *destination = mix.getWritePointer(channel);
+            const auto *source = this->sampleBuffer.getReadPointer(channel);
+            for (int i = 0; i < mix.getNumSamples(); ++i)
+            {
+                destination[i] += double(source[i]);
+            }
+        }
+    }
+};
+
+// Instruments are independent of each other, so their graphs
+// can process each block in parallel: the workers and the calling
+// thread pick the buffers one by one, and the calling thread waits
+// for all of them to be processed before the mixdown
+class RenderWorkerPool final
+{
+public:
+
+    RenderWorkerPool(OwnedArray<RenderBuffer> &buffers, int numWorkers) :
+        buffers(buffers)
+    {
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            this->workers.add(new Worker(*this))->startThread(9);
+        }
+    }
+
+    ~RenderWorkerPool()
+    {
+        for (auto *worker : this->workers)
+        {
+            worker->signalThreadShouldExit();
+            worker->blockStarted.signal();
+        }
+
+        for (auto *worker : this->workers)
+        {
+            worker->stopThread(1000);
+        }
+    }
+
+    void processBlock()
+    {
+        this->numProcessedBuffers = 0;
+        this->nextBufferIndex = 0;
+
+        for (auto *worker : this->workers)
+        {
+            worker->blockStarted.signal();
+        }
+
+        this->processPendingBuffers();
+
+        while (this->numProcessedBuffers.get() < this->buffers.size())
+        {
+            this->blockFinished.wait(1);
+        }
+    }
+
+private:
+
+    void processPendingBuffers()
+    {
+        while (true)
+        {
+            const auto index = (++this->nextBufferIndex) - 1;
+            if (index >= this->buffers.size())
+            {
+                return;
+            }
+
+            this->buffers.getUnchecked(index)->process();
+
+            if (++this->numProcessedBuffers == this->buffers.size())
+            {
+                this->blockFinished.signal();
+            }
+        }
+    }
+
+    struct Worker final : public Thread
+    {
+        explicit Worker(RenderWorkerPool &pool) :
+            Thread("RenderWorker"), pool(pool) {}
+
+        void run() override
+        {
+            while (!this->threadShouldExit())
+            {
+                if (this->blockStarted.wait(100) && !this->threadShouldExit())
+                {
+                    this->pool.processPendingBuffers();
+                }
+            }
+        }
+
+        RenderWorkerPool &pool;
+        WaitableEvent blockStarted;
+    };
+
+    OwnedArray<RenderBuffer> &buffers;
+    OwnedArray<Worker> workers;
+
+    Atomic<int> nextBufferIndex = 0;
+    Atomic<int> numProcessedBuffers = 0;
+    WaitableEvent blockFinished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderWorkerPool)
 };
 
 void RendererThread::run()
 {
     // step 0. init.
-    auto sequences = this->transport.buildPlaybackCache(false);
-    constexpr auto bufferSize = 512;
+    TransportPlaybackCache sequences(move(this->sequences));
+    const auto bufferSize = this->options.blockSize;
 
     // assuming that number of channels and sample rate is equal for all instruments
     const int numOutChannels = sequences.getNumOutputChannels();
     const int numInChannels = sequences.getNumInputChannels();
     const double sampleRate = sequences.getSampleRate();
-    const double totalTimeMs = this->context->totalTimeMs;
-    const double msPerQuarter = this->context->startBeatTempo;
-    double secPerQuarter = msPerQuarter / 1000.0;
 
-    double currentFrame = 0.0;
-    const double lastFrame = totalTimeMs / 1000.0 * sampleRate;
+    // all event times are relative to the start beat, which is the frame 0
+    const auto &tempoMap = sequences.getTempoMap();
+    const double startTimeMs = tempoMap.getTimeAt(this->context->startBeat);
+
+    auto getFrameAt = [&tempoMap, startTimeMs, sampleRate](double beat)
+    {
+        return tempoMap.getSamplePositionAt(beat, startTimeMs, sampleRate);
+    };
+
+    // the frames are counted in integers, so that the block boundaries
+    // and the event positions are compared exactly
+    int64 currentFrame = 0;
+    const int64 lastFrame = jmax(int64(0), getFrameAt(this->context->endBeat));
+    const int64 lastTailFrame = lastFrame +
+        (this->options.renderTail ? int64(this->options.maxTailSeconds * sampleRate) : 0);
+    const auto silenceThreshold = Decibels::decibelsToGain(this->options.silenceThresholdDb);
+    const int64 minSilentTailFrames = int64(this->options.minSilenceSeconds * sampleRate);
+    int64 numSilentTailFrames = 0;
 
     // step 1. create a list of unique instruments with audio buffers for them.
     OwnedArray<RenderBuffer> subBuffers;
@@ -145,9 +450,26 @@ void RendererThread::run()
     for (int i = 0; i < uniqueInstruments.size(); ++i)
     {
         Instrument *instrument = uniqueInstruments[i];
+        if (this->options.instrumentId.isNotEmpty() &&
+            instrument->getIdAndHash() != this->options.instrumentId)
+        {
+            continue; // its messages won't find any buffer to go
+        }
+
         auto *subBuffer = new RenderBuffer();
         subBuffer->instrument = instrument;
-        subBuffer->sampleBuffer = AudioBuffer<float>(numOutChannels, bufferSize);
+        subBuffer->isDoublePrecision = this->options.doublePrecision &&
+            instrument->getProcessorGraph()->supportsDoublePrecisionProcessing();
+
+        if (subBuffer->isDoublePrecision)
+        {
+            subBuffer->sampleBufferDouble = AudioBuffer<double>(numOutChannels, bufferSize);
+        }
+        else
+        {
+            subBuffer->sampleBuffer = AudioBuffer<float>(numOutChannels, bufferSize);
+        }
+
         subBuffers.add(subBuffer);
         //DBG("Adding instrument: " + String(instrument->getName()));
     }
@@ -158,38 +480,164 @@ void RendererThread::run()
         auto *graph = subBuffer->instrument->getProcessorGraph();
         graph->setPlayConfigDetails(numInChannels, numOutChannels, sampleRate, bufferSize);
         graph->releaseResources();
-        graph->setProcessingPrecision(AudioProcessor::singlePrecision);
+        graph->setProcessingPrecision(subBuffer->isDoublePrecision ?
+            AudioProcessor::doublePrecision : AudioProcessor::singlePrecision);
         graph->prepareToPlay(graph->getSampleRate(), bufferSize);
         graph->setNonRealtime(true);
     }
 
+    // step 2'. line up the instruments with the slowest one, and skip
+    // its latency at the start of the output, so that frame 0 is in time
+    int latencyFrames = 0;
+    for (auto *subBuffer : subBuffers)
+    {
+        latencyFrames = jmax(latencyFrames, subBuffer->instrument->getLatencySamples());
+    }
+
+    for (auto *subBuffer : subBuffers)
+    {
+        const auto delay = latencyFrames - subBuffer->instrument->getLatencySamples();
+        if (delay > 0 && subBuffer->isDoublePrecision)
+        {
+            subBuffer->delayDouble = make<CompensationDelay<double>>(numOutChannels, delay);
+        }
+        else if (delay > 0)
+        {
+            subBuffer->delay = make<CompensationDelay<float>>(numOutChannels, delay);
+        }
+    }
+
+    // the calling thread is also rendering, so it needs one worker less
+    const auto numWorkers = jmin(SystemStats::getNumCpus(), subBuffers.size()) - 1;
+    UniquePointer<RenderWorkerPool> workerPool;
+    if (numWorkers > 0)
+    {
+        workerPool = make<RenderWorkerPool>(subBuffers, numWorkers);
+    }
+
+    auto processBlock = [&workerPool, &subBuffers]()
+    {
+        if (workerPool != nullptr)
+        {
+            workerPool->processBlock();
+        }
+        else
+        {
+            for (auto *subBuffer : subBuffers)
+            {
+                subBuffer->process();
+            }
+        }
+    };
+
+    // step 2a. the encoding and disk I/O go through the FIFOs to the writer
+    // thread, so that they overlap with the rendering of the next blocks
+    const auto writerFifoSize = jmax(bufferSize * 4, int(sampleRate));
+
+    if (this->writer != nullptr)
+    {
+        this->writerThread.startThread(8);
+
+        const ScopedLock lock(this->writerLock);
+        this->threadedWriter = make<AudioFormatWriter::ThreadedWriter>(this->writer.release(),
+            this->writerThread, writerFifoSize);
+    }
+    else
+    {
+        // rendering to memory: allocate the whole thing upfront, including
+        // the maximum tail, and trim it to the rendered size at the end
+        const auto numBlocks = int((lastTailFrame + latencyFrames + bufferSize - 1) / bufferSize);
+        const ScopedLock lock(this->writerLock);
+        jassert(this->renderedAudio != nullptr);
+        this->renderedAudio->buffer.setSize(numOutChannels, numBlocks * bufferSize);
+        this->renderedAudio->startTimeMs = startTimeMs;
+    }
+
+    // the waveform summaries are built along the way, so that
+    // the rendered audio never needs to be decoded again for drawing
+    WaveformPeaks::Builder peaksBuilder(numOutChannels, sampleRate);
+
+    // step 2b. in the stems mode, create a writer for each instrument
+    // next to the mixdown file, so that all stems are rendered in one pass
+    if (this->options.stems && this->renderTarget.isLocalFile())
+    {
+        const auto mixdownFile = this->renderTarget.getLocalFile();
+        for (int i = 0; i < subBuffers.size(); ++i)
+        {
+            auto *subBuffer = subBuffers.getUnchecked(i);
+            const auto stemName = mixdownFile.getFileNameWithoutExtension() + " - " +
+                String(i + 1) + " " + subBuffer->instrument->getName();
+
+            const auto stemFile = mixdownFile.getSiblingFile(File::createLegalFileName(stemName) +
+                mixdownFile.getFileExtension());
+
+            if (stemFile.existsAsFile() && !stemFile.deleteFile())
+            {
+                continue;
+            }
+
+            if (auto stream = stemFile.createOutputStream())
+            {
+                if (auto *stemWriter = this->createWriter(stream.release(), numOutChannels))
+                {
+                    subBuffer->stemWriter = make<AudioFormatWriter::ThreadedWriter>(stemWriter,
+                        this->writerThread, writerFifoSize);
+                }
+            }
+        }
+    }
+
     // let the processor graphs handle their async updates
     Thread::sleep(200);
 
+    // step 2c. instead of rendering everything before the start beat,
+    // send the controller states at it, and let the graphs warm up
+    // (e.g. the smoothed parameters settle) rendering the silence:
+    for (int cc = 0; cc < Transport::PlaybackContext::numCCs; ++cc)
+    {
+        const auto state = this->context->ccStates[cc];
+        if (state < 0) // not present in any track
+        {
+            continue;
+        }
+
+        for (auto *subBuffer : subBuffers)
+        {
+            for (int channel = 1; channel < Globals::numChannels; ++channel)
+            {
+                subBuffer->midiBuffer.addEvent(MidiMessage::controllerEvent(channel, cc, state), 0);
+            }
+        }
+    }
+
+    const auto numWarmUpBlocks = this->options.hasRange() ?
+        int(std::ceil(this->options.warmUpSeconds * sampleRate / bufferSize)) : 0;
+
+    for (int i = 0; i < numWarmUpBlocks && !this->threadShouldExit(); ++i)
+    {
+        processBlock();
+    }
+
     // step 3. render loop itself.
-    sequences.seekToStart();
+    sequences.seekToBeat(this->context->startBeat);
     
     CachedMidiMessage nextMessage;
     bool hasNextMessage = sequences.getNextMessage(nextMessage);
-    jassert(hasNextMessage);
     
-    // TODO: add double precision rendering someday (for processor graphs who support it)
     AudioBuffer<float> mixingBuffer(numOutChannels, bufferSize);
-    
-    double lastEventTick = 0.0;
-    double prevEventTimeStamp = 0.0;
-    double nextEventTickDelta = (nextMessage.message.getTimeStamp() - prevEventTimeStamp) * secPerQuarter;
-    double nextEventTick = lastEventTick + nextEventTickDelta;
+    AudioBuffer<double> mixingBufferDouble(this->options.doublePrecision ? numOutChannels : 0, bufferSize);
+
+    const auto renderStartTimeMs = Time::getMillisecondCounterHiRes();
 
-    int messageFrame = int((nextEventTick * sampleRate) - currentFrame);
+    int64 nextEventFrame = hasNextMessage ? getFrameAt(nextMessage.message.getTimeStamp()) : 0;
 
     // And here we go: send MidiStart
     for (auto *subBuffer : subBuffers)
     {
-        subBuffer->midiBuffer.addEvent(MidiMessage::midiStart(), messageFrame);
+        subBuffer->midiBuffer.addEvent(MidiMessage::midiStart(), 0);
     }
 
-    while (currentFrame < lastFrame)
+    while (currentFrame < lastTailFrame + latencyFrames)
     {
         if (this->threadShouldExit())
         {
@@ -197,17 +645,14 @@ void RendererThread::run()
         }
         
         // step 3a. fill up the midi buffers.
-        while (hasNextMessage &&
-               ( (nextEventTick * sampleRate) >= currentFrame &&
-                 (nextEventTick * sampleRate) < (currentFrame + bufferSize) ))
+        while (hasNextMessage && nextEventFrame < jmin(currentFrame + bufferSize, lastFrame))
         {
-            messageFrame = int((nextEventTick * sampleRate) - currentFrame);
+            const int messageFrame = int(jmax(int64(0), nextEventFrame - currentFrame));
 
             if (nextMessage.message.isTempoMetaEvent())
             {
-                secPerQuarter = nextMessage.message.getTempoSecondsPerQuarterNote();
-
-                // Sends this to everybody (need to do that for drum-machines) - TODO test
+                // the timing is taken from the tempo map, but
+                // this is sent to everybody (need to do that for drum-machines) - TODO test
                 for (auto *subBuffer : subBuffers)
                 {
                     subBuffer->midiBuffer.addEvent(nextMessage.message, messageFrame);
@@ -225,62 +670,120 @@ void RendererThread::run()
                 }
             }
 
-            lastEventTick += nextEventTickDelta;
-            prevEventTimeStamp = nextMessage.message.getTimeStamp();
-            
             hasNextMessage = sequences.getNextMessage(nextMessage);
-            nextEventTickDelta = (nextMessage.message.getTimeStamp() - prevEventTimeStamp) * secPerQuarter;
-            nextEventTick = lastEventTick + nextEventTickDelta;
+            if (hasNextMessage)
+            {
+                nextEventFrame = getFrameAt(nextMessage.message.getTimeStamp());
+            }
         }
 
-        // step 3b. call processBlock for every instrument.
-        for (auto *subBuffer : subBuffers)
+        // the events after the range end are not sent, so the notes
+        // still sounding there need to be released to render the tail
+        if (this->options.hasRange() &&
+            lastFrame >= currentFrame && lastFrame < currentFrame + bufferSize)
         {
-            auto *graph = subBuffer->instrument->getProcessorGraph();
+            const int endFrame = int(lastFrame - currentFrame);
+            for (auto *subBuffer : subBuffers)
             {
-                const ScopedLock lock(graph->getCallbackLock());
-                
-                //DBG("processBlock num midi events: " + String(subBuffer->midiBuffer.getNumEvents()));
-                graph->processBlock(subBuffer->sampleBuffer, subBuffer->midiBuffer);
-                subBuffer->midiBuffer.clear();
-
-                //Thread::yield();
+                for (int channel = 1; channel < Globals::numChannels; ++channel)
+                {
+                    subBuffer->midiBuffer.addEvent(MidiMessage::allNotesOff(channel), endFrame);
+                }
             }
         }
 
+        // step 3b. call processBlock for every instrument.
+        processBlock();
+
         // step 3c. mix them down to the render buffer.
-        mixingBuffer.clear();
+        if (this->options.doublePrecision)
+        {
+            mixingBufferDouble.clear();
+            for (const auto *subBuffer : subBuffers)
+            {
+                subBuffer->addTo(mixingBufferDouble);
+            }
 
-        for (auto *subBuffer : subBuffers)
+            mixingBuffer.makeCopyOf(mixingBufferDouble, true);
+        }
+        else
+        {
+            mixingBuffer.clear();
+            for (const auto *subBuffer : subBuffers)
+            {
+                subBuffer->addTo(mixingBuffer);
+            }
+        }
+
+        // step 3c'. past the end, the tail is finished when the mix stays silent long enough
+        if (currentFrame >= lastFrame + latencyFrames)
         {
+            float peak = 0.f;
             for (int j = 0; j < numOutChannels; ++j)
             {
-                mixingBuffer.addFrom(j, 0,
-                    subBuffer->sampleBuffer, j, 0,
-                    bufferSize,
-                    1.0f);
+                const auto range = FloatVectorOperations::findMinAndMax(mixingBuffer.getReadPointer(j), bufferSize);
+                peak = jmax(peak, range.getEnd(), -range.getStart());
+            }
+
+            numSilentTailFrames = (peak < silenceThreshold) ? numSilentTailFrames + bufferSize : 0;
+            if (numSilentTailFrames >= minSilentTailFrames)
+            {
+                break;
             }
         }
 
-        // step 3d. write resulting buffer to disk.
+        // step 3d. send the resulting buffer to the writer thread,
+        // except for the compensated latency frames at the very start
+        const int skippedFrames = int(jlimit(int64(0), int64(bufferSize), latencyFrames - currentFrame));
+        const int outputFrame = int(currentFrame) + skippedFrames - latencyFrames;
+
         {
             const ScopedLock lock(this->writerLock);
-            bool writtenSuccessfully = false;
-            
-            while (! writtenSuccessfully)
+            if (this->threadedWriter != nullptr)
+            {
+                RenderBuffer::writeRenderedBlock(*this->threadedWriter, mixingBuffer, skippedFrames);
+            }
+            else if (skippedFrames < bufferSize)
+            {
+                for (int j = 0; j < numOutChannels; ++j)
+                {
+                    this->renderedAudio->buffer.copyFrom(j, outputFrame,
+                        mixingBuffer, j, skippedFrames, bufferSize - skippedFrames);
+                }
+            }
+        }
+
+        if (skippedFrames < bufferSize)
+        {
+            peaksBuilder.addBlock(mixingBuffer, skippedFrames, bufferSize - skippedFrames);
+        }
+
+        for (auto *subBuffer : subBuffers)
+        {
+            if (subBuffer->stemWriter != nullptr)
             {
-                writtenSuccessfully =
-                    this->writer->writeFromAudioSampleBuffer(mixingBuffer, 0, mixingBuffer.getNumSamples());
+                subBuffer->writeStem(skippedFrames);
             }
         }
 
         // step 3e. finally, update counters.
         currentFrame += bufferSize;
 
-        this->percentsDone = float(currentFrame / lastFrame);
+        this->percentsDone = jlimit(0.f, 1.f, float(double(currentFrame - latencyFrames) / double(lastFrame)));
         //DBG("this->percentsDone : " + String(this->percentsDone));
+
+        const auto elapsedSeconds = (Time::getMillisecondCounterHiRes() - renderStartTimeMs) * 0.001;
+        if (elapsedSeconds > 0.0)
+        {
+            this->realtimeFactor = float(double(currentFrame) / sampleRate / elapsedSeconds);
+        }
     }
 
+    DBG("Rendered with block size " + String(bufferSize) +
+        " at realtime factor " + String(this->realtimeFactor.get(), 1));
+
+    workerPool = nullptr;
+
     // step 4. setNonRealtime false.
     for (auto *subBuffer : subBuffers)
     {
@@ -290,13 +793,58 @@ void RendererThread::run()
         graph->releaseResources();
     }
     
+    // the writers flush their FIFOs when deleted
     {
         const ScopedLock sl(this->writerLock);
+        this->threadedWriter = nullptr;
         this->writer = nullptr;
+
+        if (this->renderedAudio != nullptr)
+        {
+            this->renderedAudio->buffer.setSize(numOutChannels,
+                jmax(0, int(currentFrame) - latencyFrames), true);
+            this->renderedAudio->peaks = peaksBuilder.build();
+
+            if (this->onRenderedToMemory != nullptr && !this->threadShouldExit())
+            {
+                auto callback = move(this->onRenderedToMemory);
+                RenderedAudio::Ptr result(this->renderedAudio);
+                this->renderedAudio = nullptr;
+                MessageManager::callAsync([callback, result]()
+                {
+                    callback(result);
+                });
+            }
+
+            this->onRenderedToMemory = nullptr;
+        }
     }
 
+    for (auto *subBuffer : subBuffers)
+    {
+        subBuffer->stemWriter = nullptr;
+    }
+
+    this->writerThread.stopThread(500);
+
+    // the peak file is saved after the audio file is flushed,
+    // so that it's never older than the audio, see WaveformPeaks::loadFor
+    if (this->renderTarget.isLocalFile() && !this->threadShouldExit())
+    {
+        peaksBuilder.build()->saveNextTo(this->renderTarget.getLocalFile());
+    }
+
+    if (this->onRenderedToFile != nullptr && !this->threadShouldExit())
+    {
+        MessageManager::callAsync(move(this->onRenderedToFile));
+    }
+
+    this->onRenderedToFile = nullptr;
+
     // dispose the URL object, so that its security bookmark can be released by iOS
     this->renderTarget = {};
 
+    this->succeeded = !this->threadShouldExit();
+
     App::Workspace().getAudioCore().setAwake();
 }
@@ -29,12 +29,31 @@ public:
     
     float getPercentsComplete() const noexcept;
 
+    // audio seconds rendered per wall clock second
+    float getRealtimeFactor() const noexcept;
+
+    // the callback, if any, is called on the message thread,
+    // when the file is written and its peak file is saved
     bool startRendering(const URL &target, RenderFormat format,
-        Transport::PlaybackContext::Ptr context);
+        RenderOptions options, Transport::PlaybackContext::Ptr context,
+        Function<void()> onComplete = nullptr);
+
+    // renders the mixdown into memory instead of a file, skipping
+    // the encoding and the disk round-trip (stems are not supported here);
+    // the result can be taken when the rendering is done,
+    // or received in the callback, called on the message thread:
+    bool startRenderingToMemory(RenderOptions options,
+        Transport::PlaybackContext::Ptr context,
+        RenderedAudio::Callback onComplete = nullptr);
+    RenderedAudio::Ptr takeRenderedAudio();
 
     void stop();
     bool isRendering() const;
 
+    // true if the last rendering has run to the end and was not stopped;
+    // the target file might exist anyway, e.g. left from the previous render
+    bool hasSucceeded() const noexcept;
+
 private:
 
     //===------------------------------------------------------------------===//
@@ -43,19 +62,45 @@ private:
 
     void run() override;
 
+    // creates the writer for the current format and
+    // sample rate, taking the ownership of the stream
+    AudioFormatWriter *createWriter(OutputStream *stream, int numChannels) const;
+
 private:
 
     Transport &transport;
     Transport::PlaybackContext::Ptr context;
+
+    // a copy of the transport's playback cache, taken on the message thread
+    // when the rendering starts; it shares the exported sequences and the merged
+    // timeline with the transport, and is only moved to the render loop
+    TransportPlaybackCache sequences;
     RenderFormat format;
+    RenderOptions options;
 
     // this needs to be kept alive while rendering (why - because iOS)
     URL renderTarget;
+    Function<void()> onRenderedToFile;
 
     CriticalSection writerLock;
     UniquePointer<AudioFormatWriter> writer;
 
+    // long enough for a slow plugin to finish its block,
+    // since a killed render thread might leave the graph locked
+    static constexpr auto stopTimeoutMs = 5000;
+
+    // while rendering, the writer is moved behind a FIFO, so that encoding
+    // and disk I/O happen in the writer thread, overlapped with rendering
+    UniquePointer<AudioFormatWriter::ThreadedWriter> threadedWriter;
+    TimeSliceThread writerThread { "RenderWriterThread" };
+
+    // used instead of the writer when rendering to memory
+    RenderedAudio::Ptr renderedAudio;
+    RenderedAudio::Callback onRenderedToMemory;
+
     Atomic<float> percentsDone = 0.f;
+    Atomic<float> realtimeFactor = 0.f;
+    Atomic<bool> succeeded = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RendererThread)
 };
@@ -20,8 +20,8 @@
 #include "OrchestraPit.h"
 #include "RendererThread.h"
 #include "PlayerThread.h"
-#include "PlayerThreadPool.h"
 #include "MidiSequence.h"
+#include "PianoSequence.h"
 #include "MidiTrack.h"
 #include "Pattern.h"
 #include "Workspace.h"
@@ -30,7 +30,11 @@
 #include "KeyboardMapping.h"
 #include "ProjectMetadata.h"
 #include "ProjectTimeline.h"
+#include "TimeSignaturesSequence.h"
+#include "AutomationSequence.h"
+#include "Note.h"
 #include "DefaultSynthAudioPlugin.h"
+#include "DocumentHelpers.h"
 
 #define TIME_NOW (Time::getMillisecondCounterHiRes() * 0.001)
 
@@ -39,7 +43,7 @@ Transport::Transport(ProjectNode &project, OrchestraPit &orchestraPit, SleepTime
     orchestra(orchestraPit),
     sleepTimer(sleepTimer)
 {
-    this->player = make<PlayerThreadPool>(*this);
+    this->player = make<PlayerThread>(*this);
     this->renderer = make<RendererThread>(*this);
 
     this->project.addListener(this);
@@ -60,6 +64,10 @@ Transport::~Transport()
     this->renderer = nullptr;
     this->player = nullptr;
 
+    // the files are kept for the next time the project is opened
+    this->isProjectActive = false;
+    this->applyFrozenAudio();
+
     this->transportListeners.clear();
 }
 
@@ -140,27 +148,16 @@ void Transport::probeSoundAtBeat(float targetBeat, const MidiSequence *limitToSe
     this->sleepTimer.setAwake();
     this->rebuildPlaybackCacheIfNeeded();
     
-    const auto sequencesToProbe = this->playbackCache.getAllFor(limitToSequence);
+    const auto sequencesToProbe = this->playbackCache.getAllAt(targetBeat, limitToSequence);
     
     for (const auto &seq : sequencesToProbe)
     {
-        for (int j = 0; j < seq->midiMessages.getNumEvents(); ++j)
+        seq->forEachNoteAt(targetBeat, [&seq](const MidiMessage &noteOn)
         {
-            auto *noteOnHolder = seq->midiMessages.getEventPointer(j);
-            
-            if (auto *noteOffHolder = noteOnHolder->noteOffObject)
-            {
-                const auto noteOnBeat = noteOnHolder->message.getTimeStamp();
-                const auto noteOffBeat = noteOffHolder->message.getTimeStamp();
-                
-                if (noteOnBeat <= targetBeat && noteOffBeat > targetBeat)
-                {
-                    MidiMessage messageTimestampedAsNow(noteOnHolder->message);
-                    messageTimestampedAsNow.setTimeStamp(TIME_NOW);
-                    seq->listener->addMessageToQueue(messageTimestampedAsNow);
-                }
-            }
-        }
+            MidiMessage messageTimestampedAsNow(noteOn);
+            messageTimestampedAsNow.setTimeStamp(TIME_NOW);
+            seq->listener->addMessageToQueue(messageTimestampedAsNow);
+        });
     }
 
     this->sleepTimer.setCanSleepAfter(Transport::soundSleepDelayMs);
@@ -181,6 +178,7 @@ void Transport::startPlayback(float start)
     this->rebuildPlaybackCacheIfNeeded();
 
     this->stopPlayback();
+    this->cancelScheduledPreviews();
 
     if (this->loopMode.get())
     {
@@ -205,6 +203,7 @@ void Transport::startPlaybackFragment(float startBeat, float endBeat, bool loope
     this->rebuildPlaybackCacheIfNeeded();
     
     this->stopPlayback();
+    this->cancelScheduledPreviews();
 
     this->player->startPlayback(startBeat, startBeat, endBeat, looped);
     this->broadcastPlay();
@@ -351,16 +350,223 @@ float Transport::getPlaybackLoopEnd() const noexcept
 // Rendering
 //===----------------------------------------------------------------------===//
 
-bool Transport::startRender(const URL &renderTarget, RenderFormat format)
+bool Transport::startRender(const URL &renderTarget,
+    RenderFormat format, RenderOptions options)
 {
     if (this->renderer->isRendering())
     {
         return false;
     }
     
-    this->sleepTimer.setCanSleepAfter(0);
-    return this->renderer->startRendering(renderTarget, format,
-        this->fillPlaybackContextAt(this->getProjectFirstBeat()));
+    this->sleepTimer.setDisconnected();
+    return this->renderer->startRendering(renderTarget, format, options,
+        this->fillRenderContext(options));
+}
+
+bool Transport::startRenderToMemory(RenderOptions options,
+    RenderedAudio::Callback onComplete)
+{
+    if (this->renderer->isRendering())
+    {
+        return false;
+    }
+
+    this->sleepTimer.setDisconnected();
+    return this->renderer->startRenderingToMemory(options,
+        this->fillRenderContext(options), onComplete);
+}
+
+RenderedAudio::Ptr Transport::takeRenderedAudio()
+{
+    if (this->renderer->isRendering())
+    {
+        return nullptr;
+    }
+
+    return this->renderer->takeRenderedAudio();
+}
+
+//===----------------------------------------------------------------------===//
+// Freezing
+//===----------------------------------------------------------------------===//
+
+bool Transport::freezeTrack(const MidiTrack *track)
+{
+    auto *instrument = this->findInstrumentForTrackId(track->getTrackId());
+    if (instrument == nullptr || this->renderer->isRendering())
+    {
+        return false;
+    }
+
+    this->stopPlaybackAndRecording();
+
+    // the previous file, if any, is going to be overwritten
+    this->unfreezeInstrument(instrument);
+
+    // 32-bit float WAV is memory-mapped and played as is, see FrozenAudio::loadFrom
+    RenderOptions options;
+    options.instrumentId = instrument->getIdAndHash();
+    options.blockSize = RenderOptions::maxBlockSize;
+    options.bitDepth = 32;
+    options.renderTail = true;
+
+    const auto context = this->fillRenderContext(options);
+    const auto startTimeMs = context->startBeatTimeMs;
+    const auto file = this->getFrozenAudioFile(options.instrumentId);
+
+    this->freezingInstrument = instrument;
+
+    WeakReference<Transport> weakThis(this);
+    WeakReference<Instrument> weakInstrument(instrument);
+    this->sleepTimer.setDisconnected();
+    return this->renderer->startRendering(URL(file), RenderFormat::WAV, options, context,
+        [weakThis, weakInstrument, file, startTimeMs]()
+    {
+        // the instrument might have been changed or removed in the meantime
+        if (weakThis == nullptr || weakInstrument == nullptr ||
+            weakThis->freezingInstrument.get() != weakInstrument.get())
+        {
+            return;
+        }
+
+        weakThis->freezingInstrument = nullptr;
+
+        using FrozenAudio = Instrument::AudioCallback::FrozenAudio;
+        if (auto frozenAudio = FrozenAudio::loadFrom(file, startTimeMs))
+        {
+            weakThis->frozenAudio[weakInstrument->getIdAndHash()] = frozenAudio;
+            weakThis->applyFrozenAudio();
+        }
+    });
+}
+
+void Transport::unfreezeTrack(const MidiTrack *track)
+{
+    this->unfreezeInstrument(this->findInstrumentForTrackId(track->getTrackId()));
+}
+
+bool Transport::isTrackFrozen(const MidiTrack *track) const
+{
+    auto *instrument = this->findInstrumentForTrackId(track->getTrackId());
+    return instrument != nullptr &&
+        this->frozenAudio.find(instrument->getIdAndHash()) != this->frozenAudio.end();
+}
+
+// one file per project and instrument, kept next to the configs,
+// so that it's still there when the project is loaded again
+File Transport::getFrozenAudioFile(const String &instrumentIdAndHash) const
+{
+    return DocumentHelpers::getConfigSlot(File::createLegalFileName("Frozen " +
+        this->project.getId() + " " + instrumentIdAndHash + ".wav"));
+}
+
+// the instruments are shared between the projects, so they play
+// the frozen audio of the active project, and the rest is played live
+void Transport::applyFrozenAudio()
+{
+    for (auto *instrument : this->orchestra.getInstruments())
+    {
+        auto &player = instrument->getProcessorPlayer();
+        const auto found = this->frozenAudio.find(instrument->getIdAndHash());
+        const auto ownAudio = found != this->frozenAudio.end() ? found->second : nullptr;
+
+        if (this->isProjectActive)
+        {
+            if (player.getFrozenAudio() != ownAudio)
+            {
+                player.setFrozenAudio(ownAudio);
+            }
+        }
+        else if (ownAudio != nullptr && player.getFrozenAudio() == ownAudio)
+        {
+            player.setFrozenAudio(nullptr);
+        }
+    }
+}
+
+static void deleteFrozenAudioFile(const File &file)
+{
+    file.deleteFile();
+    WaveformPeaks::getPeaksFileFor(file).deleteFile();
+}
+
+void Transport::unfreezeInstrument(Instrument *instrument)
+{
+    if (instrument == nullptr)
+    {
+        return;
+    }
+
+    if (this->freezingInstrument.get() == instrument)
+    {
+        this->freezingInstrument = nullptr;
+    }
+
+    const auto found = this->frozenAudio.find(instrument->getIdAndHash());
+    if (found == this->frozenAudio.end())
+    {
+        return;
+    }
+
+    const auto file = found->second->file;
+    auto &player = instrument->getProcessorPlayer();
+    if (player.getFrozenAudio() == found->second)
+    {
+        player.setFrozenAudio(nullptr);
+    }
+
+    // the file is unmapped here, so it can be deleted
+    this->frozenAudio.erase(found);
+    deleteFrozenAudioFile(file);
+}
+
+void Transport::unfreezeTracksAffectedBy(const String &trackId)
+{
+    for (const auto *track : this->tracksCache)
+    {
+        if (track->getTrackId() != trackId)
+        {
+            continue;
+        }
+
+        if (track->isTempoTrack())
+        {
+            this->unfreezeAllInstruments();
+            return;
+        }
+
+        // the annotations, key and time signatures are linked to the default
+        // instrument as well, but they don't make any sound, so that e.g.
+        // renaming or recolouring an annotation doesn't unfreeze it
+        const auto *sequence = track->getSequence();
+        if (dynamic_cast<const PianoSequence *>(sequence) == nullptr &&
+            dynamic_cast<const AutomationSequence *>(sequence) == nullptr)
+        {
+            return;
+        }
+
+        break;
+    }
+
+    this->unfreezeInstrument(this->findInstrumentForTrackId(trackId));
+}
+
+void Transport::unfreezeAllInstruments()
+{
+    this->freezingInstrument = nullptr;
+
+    for (auto *instrument : this->orchestra.getInstruments())
+    {
+        this->unfreezeInstrument(instrument);
+    }
+
+    // the instruments which are not there anymore
+    for (const auto &it : this->frozenAudio)
+    {
+        deleteFrozenAudioFile(it.second->file);
+    }
+
+    this->frozenAudio.clear();
 }
 
 void Transport::stopRender()
@@ -380,11 +586,21 @@ bool Transport::isRendering() const
     return this->renderer->isRendering();
 }
 
+bool Transport::hasRenderSucceeded() const
+{
+    return this->renderer->hasSucceeded();
+}
+
 float Transport::getRenderingPercentsComplete() const
 {
     return this->renderer->getPercentsComplete();
 }
 
+float Transport::getRenderingRealtimeFactor() const
+{
+    return this->renderer->getRealtimeFactor();
+}
+
 //===----------------------------------------------------------------------===//
 // Sending messages at real-time
 //===----------------------------------------------------------------------===//
@@ -406,31 +622,29 @@ Transport::NotePreviewTimer::~NotePreviewTimer()
 
 void Transport::NotePreviewTimer::cancelAllPendingPreviews(bool sendRemainingNoteOffs)
 {
-    if (this->isTimerRunning())
-    {
-        this->stopTimer();
-        for (int key = 0; key < NotePreviewTimer::numPreviewedKeys; ++key)
-        {
-            auto &preview = this->previews[key];
+    this->stopTimer();
 
-            if (sendRemainingNoteOffs &&
-                preview.noteOffTimeoutMs > 0 &&
-                preview.instrument != nullptr)
-            {
-                //DBG("noteOff " + String(key));
-                const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
-                MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
-                message.setTimeStamp(TIME_NOW);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
-            }
+    for (const auto key : this->activeKeys)
+    {
+        auto &preview = this->previews[key];
 
-            preview.instrument = nullptr;
-            preview.noteOnTimeoutMs = 0;
-            preview.noteOffTimeoutMs = 0;
-            preview.volume = 0;
+        if (sendRemainingNoteOffs &&
+            preview.isNoteOffPending &&
+            preview.instrument != nullptr)
+        {
+            //DBG("noteOff " + String(key));
+            const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
+            NotePreviewTimer::sendPreviewMessage(preview,
+                MidiMessage::noteOff(mapped.channel, mapped.key).withTimeStamp(TIME_NOW));
         }
+
+        preview.instrument = nullptr;
+        preview.isNoteOnPending = false;
+        preview.isNoteOffPending = false;
+        preview.volume = 0;
     }
+
+    this->activeKeys.clearQuick();
 }
 
 void Transport::NotePreviewTimer::previewNote(WeakReference<Instrument> instrument,
@@ -440,27 +654,33 @@ void Transport::NotePreviewTimer::previewNote(WeakReference<Instrument> instrume
 
     auto &preview = this->previews[key];
 
-    if (preview.noteOffTimeoutMs > 0 &&
+    if (preview.isNoteOffPending &&
         preview.instrument != instrument &&
         preview.instrument != nullptr)
     {
         //DBG("! noteOff " + String(key));
         const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
-        MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
-        message.setTimeStamp(TIME_NOW);
-        preview.instrument->getProcessorPlayer()
-            .getMidiMessageCollector().addMessageToQueue(message);
+        NotePreviewTimer::sendPreviewMessage(preview,
+            MidiMessage::noteOff(mapped.channel, mapped.key).withTimeStamp(TIME_NOW));
     }
 
+    const auto now = Time::getMillisecondCounter();
+
     preview.volume = volume;
-    preview.noteOnTimeoutMs = NotePreviewTimer::timerTickMs;
-    preview.noteOffTimeoutMs = noteOffTimeoutMs;
+    preview.noteOnTimeMs = now + NotePreviewTimer::noteOnDelayMs;
+    preview.noteOffTimeMs = preview.noteOnTimeMs + uint32(jmax(int16(0), noteOffTimeoutMs));
+    preview.isNoteOnPending = true;
+    preview.isNoteOffPending = noteOffTimeoutMs > 0;
     preview.instrument = instrument;
 
-    if (!this->isTimerRunning())
-    {
-        this->startTimer(NotePreviewTimer::timerTickMs);
-    }
+    this->activeKeys.addIfNotAlreadyThere(key);
+    this->scheduleNextCallback(now);
+}
+
+static inline bool isPreviewDeadlineDue(uint32 deadline, uint32 now) noexcept
+{
+    // the millisecond counter wraps around every 49 days or so
+    return int32(deadline - now) <= 0;
 }
 
 void Transport::NotePreviewTimer::timerCallback()
@@ -472,53 +692,74 @@ void Transport::NotePreviewTimer::timerCallback()
     const auto time = TIME_NOW;
 #endif
 
-    bool canStop = true;
-    for (int key = 0; key < NotePreviewTimer::numPreviewedKeys; ++key)
+    const auto now = Time::getMillisecondCounter();
+
+    for (int i = this->activeKeys.size(); --i >= 0;)
     {
+        const auto key = this->activeKeys.getUnchecked(i);
         auto &preview = this->previews[key];
-        if (preview.noteOnTimeoutMs > 0)
-        {
-            canStop = false;
-            preview.noteOnTimeoutMs -= NotePreviewTimer::timerTickMs;
 
-            if (preview.noteOnTimeoutMs <= 0 && preview.instrument != nullptr)
+        if (preview.isNoteOnPending && isPreviewDeadlineDue(preview.noteOnTimeMs, now))
+        {
+            preview.isNoteOnPending = false;
+            if (preview.instrument != nullptr)
             {
                 //DBG("noteOn " + String(key));
                 const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
-                MidiMessage message(MidiMessage::noteOn(mapped.channel, mapped.key, preview.volume));
-                message.setTimeStamp(time);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
+                NotePreviewTimer::sendPreviewMessage(preview,
+                    MidiMessage::noteOn(mapped.channel, mapped.key, preview.volume).withTimeStamp(time));
             }
         }
-        else if (preview.noteOffTimeoutMs > 0)
-        {
-            canStop = false;
-            preview.noteOffTimeoutMs -= NotePreviewTimer::timerTickMs;
 
-            if (preview.noteOffTimeoutMs <= 0 && preview.instrument != nullptr)
+        if (!preview.isNoteOnPending && preview.isNoteOffPending &&
+            isPreviewDeadlineDue(preview.noteOffTimeMs, now))
+        {
+            preview.isNoteOffPending = false;
+            if (preview.instrument != nullptr)
             {
                 //DBG("noteOff " + String(key));
                 const auto mapped = preview.instrument->getKeyboardMapping()->map(key);
-                MidiMessage message(MidiMessage::noteOff(mapped.channel, mapped.key));
-                message.setTimeStamp(time);
-                preview.instrument->getProcessorPlayer()
-                    .getMidiMessageCollector().addMessageToQueue(message);
+                NotePreviewTimer::sendPreviewMessage(preview,
+                    MidiMessage::noteOff(mapped.channel, mapped.key).withTimeStamp(time));
             }
         }
+
+        if (!preview.isNoteOnPending && !preview.isNoteOffPending)
+        {
+            preview.instrument = nullptr;
+            this->activeKeys.remove(i);
+        }
     }
 
-    if (canStop)
+    this->scheduleNextCallback(now);
+}
+
+void Transport::NotePreviewTimer::scheduleNextCallback(uint32 now)
+{
+    if (this->activeKeys.isEmpty())
     {
         this->stopTimer();
+        return;
+    }
+
+    auto nearestDeadlineMs = std::numeric_limits<int>::max();
+    for (const auto key : this->activeKeys)
+    {
+        const auto &preview = this->previews[key];
+        const auto deadline = preview.isNoteOnPending ? preview.noteOnTimeMs : preview.noteOffTimeMs;
+        nearestDeadlineMs = jmin(nearestDeadlineMs, int(int32(deadline - now)));
     }
+
+    this->startTimer(jmax(1, nearestDeadlineMs));
 }
 
-void Transport::previewKey(const String &trackId, int key,
-    float volume, float lengthInBeats) const
+void Transport::NotePreviewTimer::sendPreviewMessage(const KeyPreviewState &preview, const MidiMessage &message)
 {
-    this->sleepTimer.setAwake();
+    preview.instrument->getProcessorPlayer().getMidiMessageCollector().addMessageToQueue(message);
+}
 
+Instrument *Transport::findPreviewInstrument(const String &trackId) const
+{
     const auto foundLink = this->instrumentLinks.find(trackId);
 
     // in some cases we need to preview notes which are not tied to any
@@ -528,11 +769,91 @@ void Transport::previewKey(const String &trackId, int key,
     const bool useDefaultInstrument = trackId.isEmpty() ||
         foundLink == this->instrumentLinks.end();
 
-    auto *instrument = useDefaultInstrument ?
+    return useDefaultInstrument ?
         this->orchestra.getDefaultInstrument() :
         foundLink.value().get();
+}
+
+void Transport::previewKey(const String &trackId, int key,
+    float volume, float lengthInBeats) const
+{
+    this->sleepTimer.setAwake();
+    this->previewKey(this->findPreviewInstrument(trackId), key, volume, lengthInBeats);
+}
+
+void Transport::previewNotes(const String &trackId,
+    const Array<Note> &notes, int keyOffset) const
+{
+    if (notes.isEmpty())
+    {
+        return;
+    }
+
+    this->sleepTimer.setAwake();
+
+    auto *instrument = this->findPreviewInstrument(trackId);
+    jassert(instrument != nullptr);
+
+    auto &player = instrument->getProcessorPlayer();
+    const auto sampleRate = player.getSampleRate();
+    if (sampleRate <= 0.0 || this->isPlaying())
+    {
+        for (const auto &note : notes)
+        {
+            this->previewKey(instrument, note.getKey() + keyOffset,
+                note.getVelocity(), note.getLength());
+        }
+
+        return;
+    }
+
+    // the previous fragment's note-offs would be scheduled
+    // after this one's note-ons, and would hold them back
+    this->cancelScheduledPreviews();
+
+    auto firstBeat = notes.getReference(0).getBeat();
+    for (const auto &note : notes)
+    {
+        firstBeat = jmin(firstBeat, note.getBeat());
+    }
+
+    // the default tempo is used for simplicity, just like in previewKey
+    constexpr auto msPerBeat = double(Globals::Defaults::msPerBeat);
+    const auto &keyMap = *instrument->getKeyboardMapping();
+
+    MidiMessageSequence fragment;
+    for (const auto &note : notes)
+    {
+        const auto mapped = keyMap.map(note.getKey() + keyOffset);
+        const auto noteOnMs = (note.getBeat() - firstBeat) * msPerBeat;
+        const auto noteOffMs = noteOnMs + note.getLength() * msPerBeat;
+
+        fragment.addEvent(MidiMessage::noteOn(mapped.channel,
+            mapped.key, note.getVelocity()).withTimeStamp(noteOnMs));
+        fragment.addEvent(MidiMessage::noteOff(mapped.channel,
+            mapped.key).withTimeStamp(noteOffMs));
+    }
+
+    // the schedule queue expects the messages in time order
+    fragment.sort();
+
+    const auto startPosition = player.getSamplePosition() +
+        int64(Transport::scheduledPreviewDelayMs * 0.001 * sampleRate);
+
+    for (int i = 0; i < fragment.getNumEvents(); ++i)
+    {
+        const auto &message = fragment.getEventPointer(i)->message;
+        const auto position = startPosition + int64(message.getTimeStamp() * 0.001 * sampleRate);
+        if (!player.scheduleMessage(message, position))
+        {
+            player.getMidiMessageCollector().addMessageToQueue(message.withTimeStamp(TIME_NOW));
+        }
+    }
 
-    this->previewKey(instrument, key, volume, lengthInBeats);
+    this->scheduledPreviewInstrument = instrument;
+
+    const auto lengthMs = int(fragment.getEndTime());
+    this->sleepTimer.setCanSleepAfter(Transport::soundSleepDelayMs + lengthMs * 2);
 }
 
 void Transport::previewKey(WeakReference<Instrument> instrument,
@@ -561,10 +882,24 @@ static void stopSoundForInstrument(Instrument *instrument)
     }
 }
 
+void Transport::cancelScheduledPreviews() const
+{
+    if (auto *instrument = this->scheduledPreviewInstrument.get())
+    {
+        // the notes which have already started would never get
+        // their note-offs, so they are stopped here as well
+        instrument->getProcessorPlayer().cancelScheduledMessages();
+        stopSoundForInstrument(instrument);
+    }
+
+    this->scheduledPreviewInstrument = nullptr;
+}
+
 void Transport::stopSound(const String &trackId) const
 {
     this->sleepTimer.setAwake();
     this->notePreviewTimer.cancelAllPendingPreviews(true);
+    this->cancelScheduledPreviews();
 
     if (Instrument *instrument = this->instrumentLinks[trackId])
     {
@@ -588,6 +923,7 @@ void Transport::allNotesControllersAndSoundOff() const
 {
     this->sleepTimer.setAwake();
     this->notePreviewTimer.cancelAllPendingPreviews(true);
+    this->cancelScheduledPreviews();
 
     for (int i = 1; i < Globals::numChannels; ++i)
     {
@@ -621,11 +957,10 @@ void Transport::allNotesControllersAndSoundOff() const
 
 void Transport::onMetronomeFlagChanged(bool enabled)
 {
-    // metronome events are the part of playback cache,
-    // so we will have to rebuild it when the playback starts:
+    // metronome events are not the part of playback cache,
+    // they are attached to it when the playback starts:
     this->isMetronomeEnabled = enabled;
     this->stopPlaybackAndRecording();
-    this->playbackCacheIsOutdated = true;
 }
 
 //===----------------------------------------------------------------------===//
@@ -634,12 +969,9 @@ void Transport::onMetronomeFlagChanged(bool enabled)
 
 void Transport::onTimeSignaturesUpdated()
 {
-    // almost same logic as in onMetronomeFlagChanged:
-    if (this->isMetronomeEnabled)
-    {
-        // this->stopPlaybackAndRecording(); // that's kinda too intrusive
-        this->playbackCacheIsOutdated = true;
-    }
+    // the time signature events themselves are invalidated
+    // by the track listener methods, only the metronome is left:
+    this->metronomeCacheIsOutdated = true;
 }
 
 //===----------------------------------------------------------------------===//
@@ -651,12 +983,14 @@ void Transport::onAddInstrument(Instrument *instrument)
     this->stopPlaybackAndRecording();
 
     // invalidate cache as is uses pointers to the players too
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCache();
 
     for (int i = 0; i < this->tracksCache.size(); ++i)
     {
         this->updateInstrumentLinkForTrack(this->tracksCache.getUnchecked(i));
     }
+
+    this->updateInstrumentsInUse();
 }
 
 void Transport::onRemoveInstrument(Instrument *instrument)
@@ -668,12 +1002,14 @@ void Transport::onRemoveInstrument(Instrument *instrument)
 
 void Transport::onPostRemoveInstrument()
 {
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCache();
 
     for (int i = 0; i < this->tracksCache.size(); ++i)
     {
         this->updateInstrumentLinkForTrack(this->tracksCache.getUnchecked(i));
     }
+
+    this->updateInstrumentsInUse();
 }
 
 //===----------------------------------------------------------------------===//
@@ -697,7 +1033,7 @@ void Transport::onChangeMidiEvent(const MidiEvent &oldEvent, const MidiEvent &ne
     }
 
     updateLengthAndTimeIfNeeded((&newEvent));
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCacheFor(newEvent.getSequence()->getTrack());
 }
 
 void Transport::onAddMidiEvent(const MidiEvent &event)
@@ -708,7 +1044,7 @@ void Transport::onAddMidiEvent(const MidiEvent &event)
     }
 
     updateLengthAndTimeIfNeeded((&event));
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCacheFor(event.getSequence()->getTrack());
 }
 
 void Transport::onRemoveMidiEvent(const MidiEvent &event) {}
@@ -716,9 +1052,24 @@ void Transport::onPostRemoveMidiEvent(MidiSequence *const sequence)
 {
     this->stopPlaybackAndRecording();
     updateLengthAndTimeIfNeeded(sequence->getTrack());
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCacheFor(sequence->getTrack());
+}
+
+// all events of a group belong to the same sequence,
+// so it's enough to handle any of them:
+void Transport::onAddMidiEvents(const Array<const MidiEvent *> &events)
+{
+    this->onAddMidiEvent(*events.getFirst());
+}
+
+void Transport::onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+    const Array<const MidiEvent *> &newEvents)
+{
+    this->onChangeMidiEvent(*oldEvents.getFirst(), *newEvents.getFirst());
 }
 
+void Transport::onRemoveMidiEvents(const Array<const MidiEvent *> &events) {}
+
 void Transport::onAddClip(const Clip &clip)
 {
     if (!this->isRecording())
@@ -727,14 +1078,20 @@ void Transport::onAddClip(const Clip &clip)
     }
 
     updateLengthAndTimeIfNeeded((&clip));
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCacheFor(clip);
 }
 
 void Transport::onChangeClip(const Clip &oldClip, const Clip &newClip)
 {
     this->stopPlaybackAndRecording();
     updateLengthAndTimeIfNeeded((&newClip));
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCacheFor(newClip);
+
+    // soloing a clip mutes all the others
+    if (oldClip.isSoloed() != newClip.isSoloed())
+    {
+        this->unfreezeAllInstruments();
+    }
 }
 
 void Transport::onRemoveClip(const Clip &clip) {}
@@ -742,23 +1099,30 @@ void Transport::onPostRemoveClip(Pattern *const pattern)
 {
     this->stopPlaybackAndRecording();
     updateLengthAndTimeIfNeeded(pattern->getTrack());
-    this->playbackCacheIsOutdated = true;
+    // the removed clip's sequence will be dropped on the next rebuild:
+    this->invalidatePlaybackCacheFor(pattern->getTrack());
 }
 
 void Transport::onChangeTrackProperties(MidiTrack *const track)
 {
-    // Stop playback only when instrument changes:
+    // Stop playback only when instrument changes, the other properties,
+    // e.g. the name or colour, don't affect the sound, or the frozen audio:
     const auto &trackId = track->getTrackId();
-    if (!instrumentLinks.contains(trackId) ||
-        this->instrumentLinks[trackId]->getInstrumentId() != track->getTrackInstrumentId())
+    const auto link = this->instrumentLinks.find(trackId);
+    if (link == this->instrumentLinks.end() ||
+        link->second.get() != this->findInstrumentForTrack(track))
     {
         if (!this->isRecording())
         {
             this->stopPlayback();
         }
 
-        this->playbackCacheIsOutdated = true;
+        this->invalidatePlaybackCacheFor(track);
         this->updateInstrumentLinkForTrack(track);
+        this->updateInstrumentsInUse();
+
+        // the new instrument gets one more track to play
+        this->unfreezeTrack(track);
     }
 }
 
@@ -777,15 +1141,32 @@ void Transport::updateTemperamentInfoForBuiltInSynth(int periodSize, double peri
 void Transport::onDeactivateProjectSubtree(const ProjectMetadata *meta)
 {
     this->stopPlaybackAndRecording();
+    this->lastKeyboardMappingsFingerprint = this->getKeyboardMappingsFingerprint();
+
+    this->isProjectActive = false;
+    this->applyFrozenAudio();
 }
 
 void Transport::onActivateProjectSubtree(const ProjectMetadata *meta)
 {
     this->updateTemperamentInfoForBuiltInSynth(meta->getPeriodSize(), meta->getPeriodRange());
 
-    // let's reset midi caches, just in case some instrument's keyboard mapping
-    // has changed in the meanwhile (no idea how to observe kbm changes in transport)
-    this->playbackCacheIsOutdated = true;
+    // the instrument links are kept up to date by the orchestra callbacks
+    // even while inactive, so the only thing that could make the sequences
+    // outdated in the meanwhile is some instrument's keyboard mapping
+    if (this->lastKeyboardMappingsFingerprint != this->getKeyboardMappingsFingerprint())
+    {
+        this->invalidatePlaybackCache();
+    }
+    else if (this->hasPlaybackCacheOutdatedItems())
+    {
+        this->startTimer(Transport::playbackCacheRebuildDelayMs);
+    }
+
+    this->isProjectActive = true;
+    this->applyFrozenAudio();
+
+    this->updateInstrumentsInUse();
 }
 
 void Transport::onChangeProjectInfo(const ProjectMetadata *meta)
@@ -796,7 +1177,7 @@ void Transport::onChangeProjectInfo(const ProjectMetadata *meta)
 void Transport::onReloadProjectContent(const Array<MidiTrack *> &tracks,
     const ProjectMetadata *meta)
 {
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCache();
 
     this->tracksCache.clearQuick();
     this->instrumentLinks.clear();
@@ -807,6 +1188,8 @@ void Transport::onReloadProjectContent(const Array<MidiTrack *> &tracks,
         this->updateInstrumentLinkForTrack(track);
     }
 
+    this->updateInstrumentsInUse();
+
     this->stopPlaybackAndRecording();
 
     this->updateTemperamentInfoForBuiltInSynth(meta->getPeriodSize(), meta->getPeriodRange());
@@ -819,18 +1202,20 @@ void Transport::onAddTrack(MidiTrack *const track)
         this->stopPlayback();
     }
 
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCacheFor(track);
     this->tracksCache.addIfNotAlreadyThere(track);
     this->updateInstrumentLinkForTrack(track);
+    this->updateInstrumentsInUse();
 }
 
 void Transport::onRemoveTrack(MidiTrack *const track)
 {
     this->stopPlaybackAndRecording();
 
-    this->playbackCacheIsOutdated = true;
+    this->invalidatePlaybackCacheFor(track);
     this->tracksCache.removeAllInstancesOf(track);
     this->clearInstrumentLinkForTrack(track);
+    this->updateInstrumentsInUse();
 }
 
 void Transport::onChangeProjectBeatRange(float firstBeat, float lastBeat)
@@ -842,6 +1227,9 @@ void Transport::onChangeProjectBeatRange(float firstBeat, float lastBeat)
 
     this->projectFirstBeat = firstBeat;
     this->projectLastBeat = lastBeat;
+
+    // the metronome track depends on the project range:
+    this->metronomeCacheIsOutdated = true;
     
     // real track total time changed
     const auto realLengthMs = this->findTimeAt(lastBeat);
@@ -854,229 +1242,555 @@ void Transport::onChangeProjectBeatRange(float firstBeat, float lastBeat)
 
 double Transport::findTimeAt(float targetBeat) const
 {
-    double resultTimeMs = 0.0;
+    this->rebuildPlaybackCacheIfNeeded();
+    return this->playbackCache.getTempoMap().getTimeAt(targetBeat);
+}
 
+Transport::PlaybackContext::Ptr Transport::fillPlaybackContextAt(float targetBeat) const
+{
     this->rebuildPlaybackCacheIfNeeded();
 
-    CachedMidiMessage cached;
+    const auto &tempoMap = this->playbackCache.getTempoMap();
+
+    Transport::PlaybackContext::Ptr context(new Transport::PlaybackContext());
+    context->startBeat = targetBeat;
+
+    context->totalTimeMs = tempoMap.getTimeAt(this->projectLastBeat.get());
+    context->startBeatTimeMs = tempoMap.getTimeAt(targetBeat);
+    context->startBeatTempo = tempoMap.getTempoAt(targetBeat);
 
-    // try to find the initial value for global tempo
-    // by picking the very first tempo automation event, if present
-    double tempo = Globals::Defaults::msPerBeat;
+    context->sampleRate = this->playbackCache.getSampleRate();
+    context->numOutputChannels = this->playbackCache.getNumOutputChannels();
+    context->sampleAccurateMode = App::Workspace().getAudioCore().isSampleAccuratePlaybackEnabled();
 
+    // the controller states still need a pass over the events before the start beat
+    CachedMidiMessage cached;
     this->playbackCache.seekToStart();
     while (this->playbackCache.getNextMessage(cached))
     {
-        if (cached.message.isTempoMetaEvent())
+        if (cached.message.getTimeStamp() > context->startBeat)
         {
-            tempo = cached.message.getTempoSecondsPerQuarterNote() * 1000.f;
             break;
         }
+
+        if (cached.message.isController() &&
+            cached.message.getControllerNumber() <= PlaybackContext::numCCs)
+        {
+            context->ccStates[cached.message.getControllerNumber()] =
+                cached.message.getControllerValue();
+        }
     }
 
-    double prevTimestamp = 0.0;
+    return context;
+}
+
+Transport::PlaybackContext::Ptr Transport::fillRenderContext(const RenderOptions &options) const
+{
+    const auto startBeat = options.hasRange() ? options.startBeat :
+        jmin(0.f, this->getProjectFirstBeat());
 
-    this->playbackCache.seekToStart();
-    while (this->playbackCache.getNextMessage(cached))
+    auto context = this->fillPlaybackContextAt(startBeat);
+    context->endBeat = options.hasRange() ? options.endBeat : this->getProjectLastBeat();
+    return context;
+}
+
+//===----------------------------------------------------------------------===//
+// Playback cache management
+//===----------------------------------------------------------------------===//
+
+void Transport::rebuildPlaybackCacheIfNeeded() const
+{
+    TRACE_ZONE("Transport::rebuildPlaybackCacheIfNeeded");
+
+    // the speculative rebuild might be still merging the cache,
+    // and it makes no sense to start all over again this time:
+    this->playbackCacheBuilder.waitForCompletion();
+    if (auto warmCache = this->playbackCacheBuilder.takeResult())
+    {
+        this->playbackCache = move(*warmCache);
+    }
+
+    if (!this->hasPlaybackCacheOutdatedItems())
+    {
+        return;
+    }
+
+    auto result = this->exportOutdatedSequences();
+    result.buildTimeline();
+    this->playbackCache = move(result);
+}
+
+// Exports the outdated sequences and reuses the rest of them;
+// returns the cache which is not merged yet, see buildTimeline()
+TransportPlaybackCache Transport::exportOutdatedSequences() const
+{
+    // solo clips affect the export of all tracks
+    const bool hasSoloClips = this->hasSoloClips();
+    const bool allOutdated = this->playbackCacheIsOutdated.get() ||
+        hasSoloClips != this->lastExportHadSoloClips;
+
+    Array<PlaybackSequenceExport> exports;
+    StringArray keys;
+
+    const auto addSequence = [&](const MidiTrack *track, const Clip &clip, bool trackIsOutdated)
     {
-        const auto nextTimestamp = cached.message.getTimeStamp();
+        const auto key = track->getTrackId() + clip.getKeyString();
 
-        if (nextTimestamp > targetBeat)
+        PlaybackSequenceExport sequenceExport(track, clip);
+        if (!trackIsOutdated && !this->outdatedClips.contains(key))
         {
-            break;
+            const auto found = this->exportedSequences.find(key);
+            if (found != this->exportedSequences.end())
+            {
+                sequenceExport.result = found->second;
+            }
+        }
+
+        if (sequenceExport.result == nullptr)
+        {
+            sequenceExport.instrument = this->instrumentLinks[track->getTrackId()];
         }
 
-        const auto nextEventTimeDelta = tempo * (nextTimestamp - prevTimestamp);
-        resultTimeMs += nextEventTimeDelta;
-        prevTimestamp = nextTimestamp;
+        exports.add(sequenceExport);
+        keys.add(key);
+    };
+
+    for (const auto *track : this->tracksCache)
+    {
+        const bool trackIsOutdated = allOutdated ||
+            this->outdatedTracks.contains(track->getTrackId());
 
-        if (cached.message.isTempoMetaEvent())
+        if (track->getPattern() != nullptr)
+        {
+            for (const auto *clip : track->getPattern()->getClips())
+            {
+                addSequence(track, *clip, trackIsOutdated);
+            }
+        }
+        else
         {
-            tempo = cached.message.getTempoSecondsPerQuarterNote() * 1000.f;
+            static Clip noTransform;
+            addSequence(track, noTransform, trackIsOutdated);
         }
     }
 
-    // add remainder, the time from the last event to the given beat:
-    resultTimeMs += (tempo * (targetBeat - prevTimestamp));
+    this->exportPlaybackSequences(exports, hasSoloClips);
+
+    TransportPlaybackCache result;
+    FlatHashMap<String, CachedMidiSequence::Ptr, StringHash> sequences;
+
+    for (int i = 0; i < exports.size(); ++i)
+    {
+        const auto &sequence = exports.getReference(i).result;
+        sequences[keys[i]] = sequence;
+        result.addWrapper(sequence);
+    }
+
+    // the sequences of removed tracks and clips are dropped here:
+    this->exportedSequences = move(sequences);
+    this->outdatedTracks.clear();
+    this->outdatedClips.clear();
+    this->lastExportHadSoloClips = hasSoloClips;
+    this->playbackCacheIsOutdated = false;
 
-    return resultTimeMs;
+    return result;
 }
 
-Transport::PlaybackContext::Ptr Transport::fillPlaybackContextAt(float targetBeat) const
+TransportPlaybackCache Transport::getRenderCache() const
 {
     this->rebuildPlaybackCacheIfNeeded();
+    return this->playbackCache;
+}
 
-    CachedMidiMessage cached;
+// The tracks are independent, and the project model is only read meanwhile,
+// so the tracks are exported on all cores; the calling thread also exports,
+// and it waits for the pool jobs to finish, since they refer to its stack;
+// whatever the model creates on first access is created before the jobs start
+void Transport::exportPlaybackSequences(Array<PlaybackSequenceExport> &exports,
+    bool hasSoloClips) const
+{
+    // the clips of one track come one after another,
+    // and they are exported together, see exportPendingClips
+    Array<Range<int>> pendingTracks;
+    for (int i = 0; i < exports.size();)
+    {
+        const auto *track = exports.getReference(i).track;
 
-    // try to find the initial value for global tempo
-    // by picking the very first tempo automation event, if present
-    double tempo = Globals::Defaults::msPerBeat;
+        bool hasPendingClips = false;
+        const auto start = i;
+        for (; i < exports.size() && exports.getReference(i).track == track; ++i)
+        {
+            hasPendingClips = hasPendingClips || exports.getReference(i).result == nullptr;
+        }
 
-    this->playbackCache.seekToStart();
-    while (this->playbackCache.getNextMessage(cached))
-    {
-        if (cached.message.isTempoMetaEvent())
+        if (hasPendingClips)
         {
-            tempo = cached.message.getTempoSecondsPerQuarterNote() * 1000.f;
-            break;
+            pendingTracks.add({ start, i });
         }
     }
 
-    Transport::PlaybackContext::Ptr context(new Transport::PlaybackContext());
-    context->startBeat = targetBeat;
+    // the piano sequences cache their packed notes, which the export reads,
+    // so they are built on the calling thread, and the jobs only read them
+    for (const auto &range : pendingTracks)
+    {
+        const auto *track = exports.getReference(range.getStart()).track;
+        if (const auto *pianoSequence = dynamic_cast<const PianoSequence *>(track->getSequence()))
+        {
+            pianoSequence->getPackedNotes();
+        }
+    }
 
-    context->totalTimeMs = 0.0;
-    context->startBeatTimeMs = 0.0;
-    context->startBeatTempo = tempo;
+    // each track's sequence is exported once, relative to the clip,
+    // and then it's only stamped for each of its outdated clips
+    const auto exportPendingClips = [&](Range<int> range)
+    {
+        const auto *track = exports.getReference(range.getStart()).track;
+        if (Transport::isPlayedAsCurve(track))
+        {
+            for (int i = range.getStart(); i < range.getEnd(); ++i)
+            {
+                auto &sequenceExport = exports.getReference(i);
+                if (sequenceExport.result == nullptr)
+                {
+                    sequenceExport.result = this->exportPlaybackCurve(sequenceExport);
+                }
+            }
 
-    context->sampleRate = this->playbackCache.getSampleRate();
-    context->numOutputChannels = this->playbackCache.getNumOutputChannels();
+            return;
+        }
 
-    double prevTimestamp = 0.0;
-    bool startBeatPassed = false;
+        const auto *sequence = track->getSequence();
 
-    this->playbackCache.seekToStart();
-    while (this->playbackCache.getNextMessage(cached))
-    {
-        const auto nextTimestamp = cached.message.getTimeStamp();
-        const auto nextEventTimeDelta = tempo * (nextTimestamp - prevTimestamp);
+        Array<MidiEvent::ExportedMessage> clipRelativeMessages;
+        sequence->exportClipRelativeMessages(clipRelativeMessages, false,
+            this->projectFirstBeat.get(), this->projectLastBeat.get());
 
-        if (nextTimestamp > context->startBeat)
+        for (int i = range.getStart(); i < range.getEnd(); ++i)
         {
-            // the time from the last event to the given beat:
-            context->startBeatTimeMs += (tempo * (context->startBeat - prevTimestamp));
-            startBeatPassed = true;
+            auto &sequenceExport = exports.getReference(i);
+            if (sequenceExport.result == nullptr)
+            {
+                sequenceExport.result = this->exportPlaybackSequence(sequenceExport,
+                    clipRelativeMessages, hasSoloClips);
+            }
         }
+    };
 
-        if (!startBeatPassed)
+    Atomic<int> nextIndex = 0;
+    const auto exportPendingTracks = [&]()
+    {
+        while (true)
         {
-            context->startBeatTimeMs += nextEventTimeDelta;
+            const auto index = (++nextIndex) - 1;
+            if (index >= pendingTracks.size())
+            {
+                return;
+            }
+
+            exportPendingClips(pendingTracks.getUnchecked(index));
         }
+    };
 
-        context->totalTimeMs += nextEventTimeDelta;
-        prevTimestamp = nextTimestamp;
+    const auto numJobs = jmin(pendingTracks.size(), SystemStats::getNumCpus()) - 1;
+    if (numJobs <= 0)
+    {
+        exportPendingTracks();
+        return;
+    }
 
-        if (cached.message.isTempoMetaEvent())
-        {
-            tempo = cached.message.getTempoSecondsPerQuarterNote() * 1000.f;
-        }
-        else if (!startBeatPassed &&
-            cached.message.isController() &&
-            cached.message.getControllerNumber() <= PlaybackContext::numCCs)
+    {
+        const ScopedLock sl(this->exportThreadPoolLock);
+        if (this->exportThreadPool == nullptr)
         {
-            context->ccStates[cached.message.getControllerNumber()] =
-                cached.message.getControllerValue();
+            this->exportThreadPool = make<ThreadPool>(jmax(1, SystemStats::getNumCpus() - 1));
         }
+    }
 
-        if (!startBeatPassed)
+    Atomic<int> numRunningJobs = numJobs;
+    WaitableEvent allJobsFinished;
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        this->exportThreadPool->addJob([&]()
         {
-            context->startBeatTempo = tempo;
-        }
+            exportPendingTracks();
+            if (--numRunningJobs == 0)
+            {
+                allJobsFinished.signal();
+            }
+
+            return ThreadPoolJob::jobHasFinished;
+        });
     }
 
-    // the remainder
-    context->totalTimeMs += (tempo * (this->projectLastBeat.get() - prevTimestamp));
-    //jassert(context->totalTimeMs == this->findTimeAt(this->projectLastBeat.get()));
+    exportPendingTracks();
+    allJobsFinished.wait(-1);
+}
 
-    return context;
+CachedMidiSequence::Ptr Transport::exportPlaybackSequence(const PlaybackSequenceExport &sequenceExport,
+    const Array<MidiEvent::ExportedMessage> &clipRelativeMessages, bool hasSoloClips) const
+{
+    auto *instrument = sequenceExport.instrument;
+    const auto &keyMap = *instrument->getKeyboardMapping();
+
+    auto cached = CachedMidiSequence::createFrom(instrument,
+        sequenceExport.track->getSequence());
+
+    cached->track->exportClip(cached->midiMessages, clipRelativeMessages,
+        sequenceExport.clip, keyMap, hasSoloClips);
+
+    cached->updateBeatRange();
+    cached->buildActiveNotesIndex();
+    return cached;
 }
 
-//===----------------------------------------------------------------------===//
-// Playback cache management
-//===----------------------------------------------------------------------===//
+bool Transport::isPlayedAsCurve(const MidiTrack *track)
+{
+    return !track->isTempoTrack() && !track->isOnOffAutomationTrack() &&
+        dynamic_cast<const AutomationSequence *>(track->getSequence()) != nullptr;
+}
 
-void Transport::rebuildPlaybackCacheIfNeeded() const
+// only the clip offset applies to the automation, see MidiSequence::exportClip
+CachedMidiSequence::Ptr Transport::exportPlaybackCurve(const PlaybackSequenceExport &sequenceExport) const
+{
+    const auto *track = sequenceExport.track;
+    const auto *sequence = track->getSequence();
+    auto cached = CachedMidiSequence::createFrom(sequenceExport.instrument, sequence);
+
+    if (sequence->isEmpty() || sequenceExport.clip.isMuted())
+    {
+        return cached;
+    }
+
+    cached->curveChannel = track->getTrackChannel();
+    cached->curveControllerNumber = track->getTrackControllerNumber();
+
+    const auto clipOffset = double(sequenceExport.clip.getBeat());
+    cached->curve.ensureStorageAllocated(sequence->size());
+    for (const auto *event : *sequence)
+    {
+        const auto *automationEvent = static_cast<const AutomationEvent *>(event);
+        cached->curve.add({ automationEvent->getBeat() + clipOffset,
+            automationEvent->getControllerValue(), automationEvent->getCurvature() });
+    }
+
+    cached->firstBeat = cached->curve.getFirst().beat;
+    cached->lastBeat = cached->curve.getLast().beat;
+    return cached;
+}
+
+CachedMidiSequence::Ptr Transport::getMetronomeIfNeeded() const
 {
-    if (this->playbackCacheIsOutdated.get())
+    if (!this->isMetronomeEnabled)
+    {
+        return nullptr;
+    }
+
+    if (this->metronomeCacheIsOutdated)
     {
-        this->playbackCache = this->buildPlaybackCache(this->isMetronomeEnabled);
-        this->playbackCacheIsOutdated = false;
+        this->metronomeCache = this->exportMetronome();
+        this->metronomeCacheIsOutdated = false;
     }
+
+    return this->metronomeCache;
 }
 
-TransportPlaybackCache Transport::buildPlaybackCache(bool withMetronome) const
+CachedMidiSequence::Ptr Transport::exportMetronome() const
+{
+    const auto *timeSignatures = this->project.getTimeline()->getTimeSignatures();
+    const auto *sequence = static_cast<const TimeSignaturesSequence *>(timeSignatures->getSequence());
+
+    static Clip noTransform;
+    const PlaybackSequenceExport metronomeExport(timeSignatures, noTransform,
+        this->instrumentLinks[timeSignatures->getTrackId()]);
+
+    if (metronomeExport.instrument == nullptr)
+    {
+        jassertfalse;
+        return nullptr;
+    }
+
+    Array<MidiEvent::ExportedMessage> metronomeMessages;
+    sequence->exportMetronome(metronomeMessages,
+        this->projectFirstBeat.get(), this->projectLastBeat.get());
+
+    return this->exportPlaybackSequence(metronomeExport, metronomeMessages, false);
+}
+
+bool Transport::hasSoloClips() const
 {
-    TransportPlaybackCache result;
-    
-    // Find solo clips, if any
-    bool hasSoloClips = false;
     for (const auto *track : this->tracksCache)
     {
         if (track->getPattern() != nullptr &&
             track->getPattern()->hasSoloClips())
         {
-            hasSoloClips = true;
-            break;
+            return true;
         }
     }
 
-    for (const auto *track : this->tracksCache)
+    return false;
+}
+
+// whatever makes the playback cache outdated, also
+// makes the frozen audio of the same tracks outdated:
+
+void Transport::invalidatePlaybackCache()
+{
+    this->unfreezeAllInstruments();
+    this->playbackCacheIsOutdated = true;
+    this->metronomeCacheIsOutdated = true;
+    this->startTimer(Transport::playbackCacheRebuildDelayMs);
+}
+
+void Transport::invalidatePlaybackCacheFor(const MidiTrack *track)
+{
+    jassert(track != nullptr);
+    this->unfreezeTracksAffectedBy(track->getTrackId());
+    this->outdatedTracks.insert(track->getTrackId());
+
+    if (track == this->project.getTimeline()->getTimeSignatures())
     {
-        const auto instrument = this->instrumentLinks[track->getTrackId()];
-        const auto &keyMap = *instrument->getKeyboardMapping();
+        this->metronomeCacheIsOutdated = true;
+    }
+    this->startTimer(Transport::playbackCacheRebuildDelayMs);
+}
 
-        auto cached = CachedMidiSequence::createFrom(instrument, track->getSequence());
+void Transport::invalidatePlaybackCacheFor(const Clip &clip)
+{
+    this->unfreezeTracksAffectedBy(clip.getTrackId());
+    this->outdatedClips.insert(clip.getTrackId() + clip.getKeyString());
+    this->startTimer(Transport::playbackCacheRebuildDelayMs);
+}
 
-        if (track->getPattern() != nullptr)
-        {
-            for (const auto *clip : track->getPattern()->getClips())
-            {
-                cached->track->exportMidi(cached->midiMessages, *clip,
-                    keyMap, hasSoloClips, withMetronome,
-                    this->projectFirstBeat.get(), this->projectLastBeat.get());
-            }
-        }
-        else
+void Transport::releasePlaybackCache()
+{
+    jassert(!this->isPlaying());
+
+    this->stopTimer();
+    this->playbackCacheBuilder.waitForCompletion();
+    this->playbackCacheBuilder.takeResult();
+
+    this->playbackCache = TransportPlaybackCache();
+    this->exportedSequences.clear();
+    this->outdatedTracks.clear();
+    this->outdatedClips.clear();
+    this->playbackCacheIsOutdated = true;
+
+    this->metronomeCache = nullptr;
+    this->metronomeCacheIsOutdated = true;
+}
+
+int64 Transport::getKeyboardMappingsFingerprint() const
+{
+    // the sum doesn't depend on the order of the links
+    int64 result = 0;
+    for (const auto &link : this->instrumentLinks)
+    {
+        if (const auto *instrument = link.second.get())
         {
-            static Clip noTransform;
-            cached->track->exportMidi(cached->midiMessages, noTransform,
-                keyMap, hasSoloClips, withMetronome,
-                this->projectFirstBeat.get(), this->projectLastBeat.get());
+            result += int64(pointer_sized_int(instrument)) * 31 +
+                instrument->getKeyboardMapping()->getVersion();
         }
-
-        result.addWrapper(cached);
     }
 
     return result;
 }
 
+bool Transport::hasPlaybackCacheOutdatedItems() const noexcept
+{
+    return this->playbackCacheIsOutdated.get() ||
+        !this->outdatedTracks.empty() || !this->outdatedClips.empty();
+}
+
+void Transport::timerCallback()
+{
+    this->stopTimer();
+
+    if (!this->hasPlaybackCacheOutdatedItems())
+    {
+        return; // someone has already rebuilt the cache
+    }
+
+    // the previous speculative rebuild is only merging
+    // the exported sequences, so this should be quick:
+    this->playbackCacheBuilder.waitForCompletion();
+    this->playbackCacheBuilder.startBuilding(this->exportOutdatedSequences());
+}
+
+//===----------------------------------------------------------------------===//
+// Background playback cache builder
+//===----------------------------------------------------------------------===//
+
+Transport::PlaybackCacheBuilder::PlaybackCacheBuilder() :
+    Thread("PlaybackCacheBuilder") {}
+
+Transport::PlaybackCacheBuilder::~PlaybackCacheBuilder()
+{
+    this->stopThread(1000);
+    delete this->result.exchange(nullptr);
+}
+
+void Transport::PlaybackCacheBuilder::startBuilding(TransportPlaybackCache &&unmergedCache)
+{
+    jassert(!this->isThreadRunning());
+    this->pendingCache = move(unmergedCache);
+    this->startThread(3);
+}
+
+void Transport::PlaybackCacheBuilder::waitForCompletion()
+{
+    if (this->isThreadRunning())
+    {
+        this->waitForThreadToExit(-1);
+    }
+}
+
+UniquePointer<TransportPlaybackCache> Transport::PlaybackCacheBuilder::takeResult()
+{
+    return UniquePointer<TransportPlaybackCache>(this->result.exchange(nullptr));
+}
+
+void Transport::PlaybackCacheBuilder::run()
+{
+    this->pendingCache.buildTimeline();
+
+    // publish the merged cache, the previous one was not taken by anyone, so it's stale:
+    auto *mergedCache = new TransportPlaybackCache(move(this->pendingCache));
+    delete this->result.exchange(mergedCache);
+}
+
 // returning by value, because it will be used by (possibly many) player threads,
 // so we'd rather play safe and just let them deal with their own copy of it;
-// internally, the data is refcounted anyway and protected by critical sections
+// internally, the data is refcounted anyway, and the merged timeline is shared
+// between all copies, each of them only keeps its own playback position
 TransportPlaybackCache Transport::getPlaybackCache()
 {
-    return this->playbackCache;
+    auto result = this->playbackCache;
+    result.setMetronome(this->getMetronomeIfNeeded());
+    return result;
+}
+
+Instrument *Transport::findInstrumentForTrackId(const String &trackId) const
+{
+    const auto found = this->instrumentLinks.find(trackId);
+    return found != this->instrumentLinks.end() ? found->second.get() : nullptr;
 }
 
 void Transport::updateInstrumentLinkForTrack(const MidiTrack *track)
 {
-    const auto instruments = this->orchestra.getInstruments();
-    
-    // check by ids
-    for (int i = 0; i < instruments.size(); ++i)
-    {
-        auto *instrument = instruments.getUnchecked(i);
-        if (track->getTrackInstrumentId().contains(instrument->getInstrumentId()))
-        {
-            // corresponding node already exists, lets add
-            this->instrumentLinks[track->getTrackId()] = instrument;
-            return;
-        }
-    }
-    
-    // check by hashes
-    for (int i = 0; i < instruments.size(); ++i)
+    this->instrumentLinks[track->getTrackId()] = this->findInstrumentForTrack(track);
+}
+
+Instrument *Transport::findInstrumentForTrack(const MidiTrack *track) const
+{
+    // check by ids, then by hashes
+    if (auto *instrument = this->orchestra.findInstrumentById(track->getTrackInstrumentId()))
     {
-        auto *instrument = instruments.getUnchecked(i);
-        if (track->getTrackInstrumentId().contains(instrument->getInstrumentHash()))
-        {
-            this->instrumentLinks[track->getTrackId()] = instrument;
-            return;
-        }
+        return instrument;
     }
-    
+
     // set default instrument, if none found
-    this->instrumentLinks[track->getTrackId()] = this->orchestra.getDefaultInstrument();
+    return this->orchestra.getDefaultInstrument();
 }
 
 void Transport::clearInstrumentLinkForTrack(const MidiTrack *track)
@@ -1084,6 +1798,20 @@ void Transport::clearInstrumentLinkForTrack(const MidiTrack *track)
     this->instrumentLinks.erase(track->getTrackId());
 }
 
+void Transport::updateInstrumentsInUse() const
+{
+    Array<Instrument *> instrumentsInUse;
+    for (const auto &link : this->instrumentLinks)
+    {
+        if (link.second != nullptr)
+        {
+            instrumentsInUse.addIfNotAlreadyThere(link.second.get());
+        }
+    }
+
+    App::Workspace().getAudioCore().setInstrumentsInUse(instrumentsInUse);
+}
+
 //===----------------------------------------------------------------------===//
 // Transport Listeners
 //===----------------------------------------------------------------------===//
@@ -1176,6 +1904,15 @@ SerializedData Transport::serialize() const
     using namespace Serialization;
     SerializedData tree(Audio::transport);
     tree.setProperty(Audio::transportSeekBeat, this->getSeekBeat());
+
+    for (const auto &it : this->frozenAudio)
+    {
+        SerializedData frozen(Audio::frozenInstrument);
+        frozen.setProperty(Audio::instrumentId, it.first);
+        frozen.setProperty(Audio::frozenStartTimeMs, it.second->startTimeMs);
+        tree.appendChild(frozen);
+    }
+
     return tree;
 }
 
@@ -1189,6 +1926,29 @@ void Transport::deserialize(const SerializedData &data)
 
     const float seek = root.getProperty(Audio::transportSeekBeat, 0.f);
     this->seekToBeat(seek);
+
+    forEachChildWithType(root, e, Audio::frozenInstrument)
+    {
+        const String instrumentId = e.getProperty(Audio::instrumentId);
+        const double startTimeMs = e.getProperty(Audio::frozenStartTimeMs, 0.0);
+
+        // the cached file might have been cleaned up in the meantime
+        using FrozenAudio = Instrument::AudioCallback::FrozenAudio;
+        if (auto frozenAudio = FrozenAudio::loadFrom(this->getFrozenAudioFile(instrumentId), startTimeMs))
+        {
+            this->frozenAudio[instrumentId] = frozenAudio;
+        }
+    }
+
+    // the tracks are loaded and linked at this point, and the frozen audio
+    // was up to date with the keyboard mappings when the project was saved
+    this->lastKeyboardMappingsFingerprint = this->getKeyboardMappingsFingerprint();
+    this->applyFrozenAudio();
 }
 
-void Transport::reset() {}
+void Transport::reset()
+{
+    // the files are kept, since the project is probably going to be loaded again
+    this->frozenAudio.clear();
+    this->applyFrozenAudio();
+}
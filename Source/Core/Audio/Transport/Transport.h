@@ -21,8 +21,8 @@ class ProjectNode;
 class SleepTimer;
 class OrchestraPit;
 class PlayerThread;
-class PlayerThreadPool;
 class RendererThread;
+class Note;
 
 #include "TransportListener.h"
 #include "TransportPlaybackCache.h"
@@ -31,6 +31,8 @@ class RendererThread;
 #include "ProjectListener.h"
 #include "RenderFormat.h"
 #include "Instrument.h"
+#include "Clip.h"
+#include "MidiEvent.h"
 #include "UserInterfaceFlags.h"
 #include "Config.h"
 
@@ -38,7 +40,8 @@ class Transport final : public Serializable,
     public ProjectListener,
     public OrchestraListener,
     public TimeSignaturesAggregator::Listener,
-    public UserInterfaceFlags::Listener // needs the metronome on/off flag changes
+    public UserInterfaceFlags::Listener, // needs the metronome on/off flag changes
+    private Timer // rebuilds the playback cache when the edits settle down
 {
 public:
 
@@ -77,8 +80,14 @@ public:
     bool isPlayingAndRecording() const;
     void stopPlaybackAndRecording();
 
-    bool startRender(const URL &renderTarget, RenderFormat format);
+    bool startRender(const URL &renderTarget, RenderFormat format,
+        RenderOptions options = {});
+    // for quick bounces, previews and thumbnails, see RenderedAudio
+    bool startRenderToMemory(RenderOptions options = {},
+        RenderedAudio::Callback onComplete = nullptr);
+    RenderedAudio::Ptr takeRenderedAudio();
     bool isRendering() const;
+    bool hasRenderSucceeded() const;
     void stopRender();
     
     void togglePlaybackLoop(float startBeat, float endBeat);
@@ -88,6 +97,20 @@ public:
     float getPlaybackLoopEnd() const noexcept;
 
     float getRenderingPercentsComplete() const;
+    float getRenderingRealtimeFactor() const;
+
+    //===------------------------------------------------------------------===//
+    // Freezing
+    //===------------------------------------------------------------------===//
+
+    // renders the track's instrument output in background into a cached file,
+    // and then plays the rendered audio instead, bypassing the instrument's plugins;
+    // the instruments can be shared between tracks, so this freezes all the tracks
+    // using the same instrument, and any change in their events, clips or instrument,
+    // or in the tempo track, unfreezes it automatically; saved with the project:
+    bool freezeTrack(const MidiTrack *track);
+    void unfreezeTrack(const MidiTrack *track);
+    bool isTrackFrozen(const MidiTrack *track) const;
     
     //===------------------------------------------------------------------===//
     // Playback context and caches
@@ -95,6 +118,11 @@ public:
 
     double findTimeAt(float beat) const;
 
+    // the inactive projects keep their caches, so that switching back
+    // and hitting play is instant, until they are released, e.g. when
+    // the project is not among the recently active ones, see Workspace
+    void releasePlaybackCache();
+
     struct PlaybackContext final : public ReferenceCountedObject
     {
         using Ptr = ReferenceCountedObjectPtr<PlaybackContext>;
@@ -117,6 +145,9 @@ public:
 
         bool playbackLoopMode = false;
 
+        // see AudioCore::isSampleAccuratePlaybackEnabled
+        bool sampleAccurateMode = false;
+
         // computed CC values: -1 if not found in any track,
         // otherwise, the controller value at the time of playback start;
         // CC numbers 102119 are undefined, and numbers 120-127 are
@@ -126,6 +157,7 @@ public:
     };
 
     PlaybackContext::Ptr fillPlaybackContextAt(float beat) const;
+    PlaybackContext::Ptr fillRenderContext(const RenderOptions &options) const;
 
     TransportPlaybackCache getPlaybackCache();
 
@@ -148,6 +180,16 @@ public:
     void previewKey(WeakReference<Instrument> instrument,
         int key, float volume, float lengthInBeats) const;
 
+    // previews a short fragment at once, e.g. a chord or an arpeggio:
+    // the messages are scheduled ahead at the exact sample positions
+    // of the instrument's audio callback, so the relative timing is kept
+    // regardless of the timers; the notes' beats are relative to the
+    // earliest one, and keyOffset is added to all keys (e.g. the clip key);
+    // falls back to previewKey while playing, since the schedule
+    // queue of the instrument is used by the player thread then
+    void previewNotes(const String &trackId,
+        const Array<Note> &notes, int keyOffset = 0) const;
+
     void stopSound(const String &trackId = "") const;
     void allNotesControllersAndSoundOff() const;
 
@@ -180,6 +222,10 @@ public:
     void onAddMidiEvent(const MidiEvent &event) override;
     void onRemoveMidiEvent(const MidiEvent &event) override;
     void onPostRemoveMidiEvent(MidiSequence *const layer) override;
+    void onAddMidiEvents(const Array<const MidiEvent *> &events) override;
+    void onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents) override;
+    void onRemoveMidiEvents(const Array<const MidiEvent *> &events) override;
 
     void onAddClip(const Clip &clip) override;
     void onChangeClip(const Clip &oldClip, const Clip &newClip) override;
@@ -228,7 +274,6 @@ private:
     void broadcastSeek(float newBeat, double currentTimeMs, double totalTimeMs);
 
     friend class PlayerThread;
-    friend class PlayerThreadPool;
     friend class RendererThread;
 
 private:
@@ -239,7 +284,7 @@ private:
     SleepTimer &sleepTimer;
     static constexpr auto soundSleepDelayMs = 60000;
 
-    UniquePointer<PlayerThreadPool> player;
+    UniquePointer<PlayerThread> player;
     UniquePointer<RendererThread> renderer;
 
 private:
@@ -247,7 +292,104 @@ private:
     mutable TransportPlaybackCache playbackCache;
     mutable Atomic<bool> playbackCacheIsOutdated = true;
     void rebuildPlaybackCacheIfNeeded() const;
-    TransportPlaybackCache buildPlaybackCache(bool withMetronome) const;
+
+    // the renderer reuses the playback cache, which is up to date
+    // after fillRenderContext, instead of exporting everything again;
+    // the metronome is never rendered, and it's not there anyway
+    TransportPlaybackCache getRenderCache() const;
+
+    TransportPlaybackCache exportOutdatedSequences() const;
+
+    // the exported sequences for each clip of each track are kept between
+    // the cache rebuilds, so that only the outdated ones are exported again;
+    // keys are track id + clip key string
+    mutable FlatHashMap<String, CachedMidiSequence::Ptr, StringHash> exportedSequences;
+    mutable FlatHashSet<String, StringHash> outdatedTracks;
+    mutable FlatHashSet<String, StringHash> outdatedClips;
+    mutable bool lastExportHadSoloClips = false;
+
+    // the metronome ticks are cached separately from the playback cache,
+    // and attached to its copy when the playback starts, see getPlaybackCache
+    mutable CachedMidiSequence::Ptr metronomeCache;
+    mutable bool metronomeCacheIsOutdated = true;
+    CachedMidiSequence::Ptr getMetronomeIfNeeded() const;
+    CachedMidiSequence::Ptr exportMetronome() const;
+
+    // the keyboard mappings may change while the project is inactive,
+    // and the exported sequences are mapped already, so the cache is only
+    // kept after the re-activation, if this hasn't changed
+    int64 getKeyboardMappingsFingerprint() const;
+    int64 lastKeyboardMappingsFingerprint = 0;
+
+    void invalidatePlaybackCache();
+    void invalidatePlaybackCacheFor(const MidiTrack *track);
+    void invalidatePlaybackCacheFor(const Clip &clip);
+    bool hasPlaybackCacheOutdatedItems() const noexcept;
+    bool hasSoloClips() const;
+
+    // the speculative rebuild: when the edits settle down, the outdated
+    // sequences are exported on the message thread (the project model
+    // is not thread-safe), and the builder merges them in background,
+    // so that starting the playback most likely finds a warm cache
+    void timerCallback() override;
+    static constexpr auto playbackCacheRebuildDelayMs = 500;
+
+    class PlaybackCacheBuilder final : private Thread
+    {
+    public:
+
+        PlaybackCacheBuilder();
+        ~PlaybackCacheBuilder() override;
+
+        void startBuilding(TransportPlaybackCache &&unmergedCache);
+        void waitForCompletion();
+
+        // returns the published cache, if any, and takes the ownership
+        UniquePointer<TransportPlaybackCache> takeResult();
+
+    private:
+
+        void run() override;
+
+        TransportPlaybackCache pendingCache;
+        Atomic<TransportPlaybackCache *> result = nullptr;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlaybackCacheBuilder)
+    };
+
+    mutable PlaybackCacheBuilder playbackCacheBuilder;
+
+    struct PlaybackSequenceExport final
+    {
+        PlaybackSequenceExport() = default;
+        PlaybackSequenceExport(const MidiTrack *track, const Clip &clip,
+            Instrument *instrument = nullptr) :
+            track(track), clip(clip), instrument(instrument) {}
+
+        const MidiTrack *track = nullptr;
+        Clip clip;
+        // the instrument links are looked up before the export
+        // on the calling thread, since it's not a thread-safe map
+        Instrument *instrument = nullptr;
+        CachedMidiSequence::Ptr result;
+    };
+
+    void exportPlaybackSequences(Array<PlaybackSequenceExport> &exports,
+        bool hasSoloClips) const;
+
+    CachedMidiSequence::Ptr exportPlaybackSequence(const PlaybackSequenceExport &sequenceExport,
+        const Array<MidiEvent::ExportedMessage> &clipRelativeMessages, bool hasSoloClips) const;
+
+    // the controller automation is played as breakpoint curves, evaluated
+    // on the fly, see CachedMidiSequence::curve; the tempo track is still
+    // exported as messages, since the tempo map needs all of its changes
+    static bool isPlayedAsCurve(const MidiTrack *track);
+    CachedMidiSequence::Ptr exportPlaybackCurve(const PlaybackSequenceExport &sequenceExport) const;
+
+    // created on demand and shared by the playback cache
+    // rebuilds and the renderer, which may happen concurrently
+    mutable UniquePointer<ThreadPool> exportThreadPool;
+    mutable CriticalSection exportThreadPoolLock;
 
     // linksCache is <track id : instrument>
     mutable Array<const MidiTrack *> tracksCache;
@@ -255,6 +397,25 @@ private:
     
     void updateInstrumentLinkForTrack(const MidiTrack *track);
     void clearInstrumentLinkForTrack(const MidiTrack *track);
+    Instrument *findInstrumentForTrack(const MidiTrack *track) const;
+
+    // lets the audio core suspend the unused instruments sooner
+    void updateInstrumentsInUse() const;
+    Instrument *findInstrumentForTrackId(const String &trackId) const;
+
+    WeakReference<Instrument> freezingInstrument;
+
+    // the frozen audio of this project by the instrument ids and hashes;
+    // the instruments are shared between the projects, so they only
+    // play the frozen audio of the active one, see applyFrozenAudio
+    FlatHashMap<String, Instrument::AudioCallback::FrozenAudio::Ptr, StringHash> frozenAudio;
+    bool isProjectActive = false;
+
+    File getFrozenAudioFile(const String &instrumentIdAndHash) const;
+    void applyFrozenAudio();
+    void unfreezeInstrument(Instrument *instrument);
+    void unfreezeTracksAffectedBy(const String &trackId);
+    void unfreezeAllInstruments();
     
     // a nasty hack, see the description in BuiltInSynth.h:
     void updateTemperamentInfoForBuiltInSynth(int periodSize, double periodRange) const;
@@ -276,25 +437,46 @@ private:
 
         void timerCallback() override;
 
+        // the times are in Time::getMillisecondCounter() units
         struct KeyPreviewState final
         {
             WeakReference<Instrument> instrument;
             float volume = 0;
-            int16 noteOnTimeoutMs = 0;
-            int16 noteOffTimeoutMs = 0;
+            uint32 noteOnTimeMs = 0;
+            uint32 noteOffTimeMs = 0;
+            bool isNoteOnPending = false;
+            bool isNoteOffPending = false;
         };
 
-        static constexpr auto timerTickMs = 50;
+        // the note-on is slightly delayed, so that the repeated
+        // previews of the same key, e.g. while dragging, are merged
+        static constexpr auto noteOnDelayMs = 50;
         static constexpr auto numPreviewedKeys =
             Globals::numChannels * Globals::twelveToneKeyboardSize;
 
         KeyPreviewState previews[numPreviewedKeys];
 
+        // only the keys with pending note-ons or note-offs are visited,
+        // and the timer only wakes up at the nearest of their deadlines,
+        // and it's stopped when there's nothing to wait for
+        Array<int> activeKeys;
+        void scheduleNextCallback(uint32 now);
+
+        static void sendPreviewMessage(const KeyPreviewState &preview, const MidiMessage &message);
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NotePreviewTimer)
     };
 
     mutable NotePreviewTimer notePreviewTimer;
 
+    // the instrument which has the scheduled note previews pending,
+    // they are cancelled on stopSound or when the playback starts
+    mutable WeakReference<Instrument> scheduledPreviewInstrument;
+    void cancelScheduledPreviews() const;
+    static constexpr auto scheduledPreviewDelayMs = 50;
+
+    Instrument *findPreviewInstrument(const String &trackId) const;
+
 private:
 
     Atomic<float> seekBeat = 0.0;
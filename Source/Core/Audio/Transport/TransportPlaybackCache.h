@@ -18,25 +18,190 @@
 #pragma once
 
 #include "Instrument.h"
+#include "AutomationEvent.h"
 
 class MidiSequence;
 
 struct CachedMidiSequence final : public ReferenceCountedObject
 {
     MidiMessageSequence midiMessages;
-    int currentIndex;
     MidiMessageCollector *listener;
     Instrument *instrument;
     const MidiSequence *track;
 
+    // the beat range of all messages, including note-offs,
+    // needs to be updated after the sequence is exported
+    double firstBeat = 0.0;
+    double lastBeat = 0.0;
+
     using Ptr = ReferenceCountedObjectPtr<CachedMidiSequence>;
 
+    void updateBeatRange() noexcept
+    {
+        this->firstBeat = this->midiMessages.getStartTime();
+        this->lastBeat = this->midiMessages.getEndTime();
+    }
+
+    inline bool mayContainBeat(double beat) const noexcept
+    {
+        return beat >= this->firstBeat && beat <= this->lastBeat;
+    }
+
+    // binary search for the index of the first message at or after the given beat
+    int getNextIndexAtBeat(double beat) const noexcept
+    {
+        int low = 0;
+        int high = this->midiMessages.getNumEvents();
+        while (low < high)
+        {
+            const auto middle = (low + high) / 2;
+            if (this->midiMessages.getEventPointer(middle)->message.getTimeStamp() < beat)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+
+    // the notes sounding at some beat are looked up in the buckets
+    // of that many beats, each bucket listing the note-on indices
+    // of all notes overlapping it, so that probing the sound doesn't
+    // have to walk through all the notes before the target beat;
+    // the buckets are stored flat, see buildActiveNotesIndex
+    static constexpr auto activeNotesBucketBeats = 4.0;
+    Array<int> activeNotesOffsets;
+    Array<int> activeNotes;
+
+    inline int getActiveNotesBucket(double beat) const noexcept
+    {
+        return int((beat - this->firstBeat) / CachedMidiSequence::activeNotesBucketBeats);
+    }
+
+    // needs to be called after the sequence is exported,
+    // since it relies on the note-off links set by the export
+    void buildActiveNotesIndex()
+    {
+        this->activeNotesOffsets.clearQuick();
+        this->activeNotes.clearQuick();
+
+        const auto numEvents = this->midiMessages.getNumEvents();
+        if (numEvents == 0)
+        {
+            return;
+        }
+
+        const auto numBuckets = this->getActiveNotesBucket(this->lastBeat) + 1;
+        this->activeNotesOffsets.insertMultiple(0, 0, numBuckets + 1);
+
+        const auto forEachNoteBucket = [this, numEvents](auto &&callback)
+        {
+            for (int i = 0; i < numEvents; ++i)
+            {
+                const auto *noteOnHolder = this->midiMessages.getEventPointer(i);
+                if (const auto *noteOffHolder = noteOnHolder->noteOffObject)
+                {
+                    const auto firstBucket = this->getActiveNotesBucket(noteOnHolder->message.getTimeStamp());
+                    const auto lastBucket = this->getActiveNotesBucket(noteOffHolder->message.getTimeStamp());
+                    for (int bucket = firstBucket; bucket <= lastBucket; ++bucket)
+                    {
+                        callback(bucket, i);
+                    }
+                }
+            }
+        };
+
+        // two passes: count the notes in each bucket, then place them
+        forEachNoteBucket([this](int bucket, int)
+        {
+            this->activeNotesOffsets.getReference(bucket + 1)++;
+        });
+
+        for (int bucket = 0; bucket < numBuckets; ++bucket)
+        {
+            this->activeNotesOffsets.getReference(bucket + 1) +=
+                this->activeNotesOffsets.getUnchecked(bucket);
+        }
+
+        this->activeNotes.insertMultiple(0, 0, this->activeNotesOffsets.getLast());
+
+        auto bucketFill = this->activeNotesOffsets;
+        forEachNoteBucket([this, &bucketFill](int bucket, int noteOnIndex)
+        {
+            this->activeNotes.setUnchecked(bucketFill.getReference(bucket)++, noteOnIndex);
+        });
+    }
+
+    // calls back with each note-on message sounding at the given beat
+    template <typename Callback>
+    void forEachNoteAt(double beat, Callback &&callback) const
+    {
+        if (!this->mayContainBeat(beat) || this->activeNotesOffsets.isEmpty())
+        {
+            return;
+        }
+
+        const auto bucket = this->getActiveNotesBucket(beat);
+        for (int i = this->activeNotesOffsets.getUnchecked(bucket),
+             end = this->activeNotesOffsets.getUnchecked(bucket + 1); i < end; ++i)
+        {
+            const auto *noteOnHolder = this->midiMessages.getEventPointer(this->activeNotes.getUnchecked(i));
+            if (noteOnHolder->message.getTimeStamp() <= beat &&
+                noteOnHolder->noteOffObject->message.getTimeStamp() > beat)
+            {
+                callback(noteOnHolder->message);
+            }
+        }
+    }
+
+    // the automation curves are not pre-baked into controller messages,
+    // which would take thousands of messages for a long curvy lane, instead,
+    // the breakpoints are kept as they are, and the playback evaluates them
+    // on the fly, see TransportPlaybackCache::getNextMessage;
+    // a sequence has either the messages or the curve, not both
+    struct CurvePoint final
+    {
+        double beat;
+        float value;
+        float curvature; // of the segment starting at this point
+    };
+
+    Array<CurvePoint> curve;
+    int curveChannel = 1;
+    int curveControllerNumber = 0;
+
+    // roughly an audio block at the usual tempos
+    static constexpr auto curveStepBeat = double(AutomationEvent::curveEvaluationStepBeat);
+
+    inline bool hasCurve() const noexcept
+    {
+        return !this->curve.isEmpty();
+    }
+
+    // same as AutomationEvent::ExportParameters::createMessage does
+    static inline int getControllerValue(float value) noexcept
+    {
+        return int(value * 127);
+    }
+
+    inline int getCurveValueAt(int segmentIndex, double beat) const noexcept
+    {
+        const auto &start = this->curve.getReference(segmentIndex);
+        const auto &end = this->curve.getReference(segmentIndex + 1);
+        const auto factor = float((beat - start.beat) / (end.beat - start.beat));
+        return CachedMidiSequence::getControllerValue(AutomationEvent::interpolateEvents(start.value,
+            end.value, jlimit(0.f, 1.f, factor), start.curvature));
+    }
+
     static Ptr createFrom(Instrument *instrument, const MidiSequence *track = nullptr)
     {
         jassert(instrument != nullptr);
         CachedMidiSequence::Ptr wrapper(new CachedMidiSequence());
         wrapper->track = track;
-        wrapper->currentIndex = 0;
         wrapper->instrument = instrument;
         wrapper->listener = &instrument->getProcessorPlayer().getMidiMessageCollector();
         return wrapper;
@@ -48,9 +213,127 @@ struct CachedMidiMessage final : public ReferenceCountedObject
     MidiMessage message;
     MidiMessageCollector *listener;
     Instrument *instrument;
+    int targetIndex = 0; // see TransportPlaybackCache::getNumTargets
     using Ptr = ReferenceCountedObjectPtr<CachedMidiMessage>;
 };
 
+// Cumulative time at each tempo change, built along with the merged timeline,
+// so that beat <-> time conversions are a binary search and a multiply;
+// all times are relative to beat 0, and the first tempo is also assumed
+// to be in effect before the first tempo change:
+struct CachedTempoMap final
+{
+    struct Point final
+    {
+        double beat;
+        double timeMs;
+        double msPerBeat;
+    };
+
+    Array<Point> points;
+
+    void addTempoChange(double beat, double msPerBeat)
+    {
+        if (this->points.isEmpty())
+        {
+            this->points.add({ beat, beat * msPerBeat, msPerBeat });
+            return;
+        }
+
+        const auto &last = this->points.getReference(this->points.size() - 1);
+        jassert(beat >= last.beat);
+
+        const auto timeMs = last.timeMs + last.msPerBeat * (beat - last.beat);
+        this->points.add({ beat, timeMs, msPerBeat });
+    }
+
+    double getTimeAt(double beat) const noexcept
+    {
+        const auto &point = this->findPoint(beat, &Point::beat);
+        return point.timeMs + point.msPerBeat * (beat - point.beat);
+    }
+
+    double getBeatAt(double timeMs) const noexcept
+    {
+        const auto &point = this->findPoint(timeMs, &Point::timeMs);
+        return point.beat + (timeMs - point.timeMs) / point.msPerBeat;
+    }
+
+    double getTempoAt(double beat) const noexcept
+    {
+        return this->findPoint(beat, &Point::beat).msPerBeat;
+    }
+
+    // the nearest sample of the given beat, counting from the origin time;
+    // it's computed from the cumulative time each time, and not from the
+    // accumulated deltas, so the positions never drift, however long
+    // the song is, and the renderer and the frozen audio agree on them
+    int64 getSamplePositionAt(double beat, double originTimeMs, double sampleRate) const noexcept
+    {
+        return roundToInt64((this->getTimeAt(beat) - originTimeMs) * 0.001 * sampleRate);
+    }
+
+private:
+
+    // the last point at or before the given value, or the first one
+    const Point &findPoint(double value, double Point::*key) const noexcept
+    {
+        static const Point defaultTempo = { 0.0, 0.0, double(Globals::Defaults::msPerBeat) };
+        if (this->points.isEmpty())
+        {
+            return defaultTempo;
+        }
+
+        const auto found = std::upper_bound(this->points.begin(), this->points.end(), value,
+            [key](double v, const Point &point) { return v < point.*key; });
+
+        return found == this->points.begin() ? *found : *(found - 1);
+    }
+};
+
+// All cached sequences merged into one time-sorted contiguous array,
+// built once per cache rebuild and shared by all copies of the cache,
+// so that the playback only has to walk through it:
+struct CachedMidiTimeline final : public ReferenceCountedObject
+{
+    struct Event final
+    {
+        double timeStamp; // in beats, as in all cached sequences
+        uint8 data[3]; // a short message, or a 24-bit tempo value
+        uint8 size;
+        bool isTempo;
+        int16 targetIndex;
+
+        inline int getMicrosecondsPerQuarterNote() const noexcept
+        {
+            return (int(this->data[0]) << 16) | (int(this->data[1]) << 8) | int(this->data[2]);
+        }
+
+        MidiMessage toMidiMessage() const noexcept
+        {
+            if (this->isTempo)
+            {
+                return MidiMessage::tempoMetaEvent(this->getMicrosecondsPerQuarterNote())
+                    .withTimeStamp(this->timeStamp);
+            }
+
+            return MidiMessage(this->data, int(this->size), this->timeStamp);
+        }
+    };
+
+    struct Target final
+    {
+        Instrument *instrument;
+        MidiMessageCollector *listener;
+    };
+
+    Array<Event> events;
+    Array<Target> targets;
+    CachedTempoMap tempoMap;
+
+    using Ptr = ReferenceCountedObjectPtr<CachedMidiTimeline>;
+};
+
 class TransportPlaybackCache final
 {
 private:
@@ -58,6 +341,32 @@ private:
     Array<Instrument *, CriticalSection> uniqueInstruments;
     ReferenceCountedArray<CachedMidiSequence, CriticalSection> sequences;
 
+    CachedMidiTimeline::Ptr timeline;
+    int timelineIndex = 0;
+
+    // the metronome ticks are not merged into the timeline, since they
+    // depend only on the time signatures and the project range, and toggling
+    // the metronome shouldn't re-export and re-merge everything else,
+    // so they are kept aside and merged on the fly while playing
+    CachedMidiSequence::Ptr metronome;
+    int metronomeIndex = 0;
+    int metronomeTargetIndex = 0;
+
+    // each curve has a cursor with its next pending controller change,
+    // which is found by stepping through the curve when the previous
+    // change is sent, so the curves are merged on the fly as well
+    struct CurveCursor final
+    {
+        int segmentIndex = 0; // the index of the point starting the segment
+        double nextBeat = 0.0;
+        int nextValue = -1; // -1 means there are no more changes
+        int lastValue = -1;
+        int targetIndex = 0;
+    };
+
+    ReferenceCountedArray<CachedMidiSequence, CriticalSection> curves;
+    Array<CurveCursor> curveCursors;
+
 public:
     
     TransportPlaybackCache() = default;
@@ -66,18 +375,39 @@ public:
     {
         this->sequences.addArray(other.sequences);
         this->uniqueInstruments.addArray(other.uniqueInstruments);
+        this->timeline = other.timeline;
+        this->timelineIndex = other.timelineIndex;
+        this->metronome = other.metronome;
+        this->metronomeIndex = other.metronomeIndex;
+        this->metronomeTargetIndex = other.metronomeTargetIndex;
+        this->curves.addArray(other.curves);
+        this->curveCursors.addArray(other.curveCursors);
     }
 
     TransportPlaybackCache(TransportPlaybackCache &&other) noexcept
     {
         this->sequences.swapWith(other.sequences);
         this->uniqueInstruments.swapWith(other.uniqueInstruments);
+        std::swap(this->timeline, other.timeline);
+        std::swap(this->timelineIndex, other.timelineIndex);
+        std::swap(this->metronome, other.metronome);
+        std::swap(this->metronomeIndex, other.metronomeIndex);
+        std::swap(this->metronomeTargetIndex, other.metronomeTargetIndex);
+        this->curves.swapWith(other.curves);
+        this->curveCursors.swapWith(other.curveCursors);
     }
 
     TransportPlaybackCache &operator= (TransportPlaybackCache &&other) noexcept
     {
         this->sequences.swapWith(other.sequences);
         this->uniqueInstruments.swapWith(other.uniqueInstruments);
+        std::swap(this->timeline, other.timeline);
+        std::swap(this->timelineIndex, other.timelineIndex);
+        std::swap(this->metronome, other.metronome);
+        std::swap(this->metronomeIndex, other.metronomeIndex);
+        std::swap(this->metronomeTargetIndex, other.metronomeTargetIndex);
+        this->curves.swapWith(other.curves);
+        this->curveCursors.swapWith(other.curveCursors);
         return *this;
     }
 
@@ -92,18 +422,66 @@ public:
         {
             this->uniqueInstruments.addIfNotAlreadyThere(newWrapper->instrument);
             this->sequences.add(newWrapper);
+            this->timeline = nullptr;
+        }
+        else if (newWrapper->hasCurve())
+        {
+            this->uniqueInstruments.addIfNotAlreadyThere(newWrapper->instrument);
+            this->curves.add(newWrapper);
+            this->curveCursors.add({});
+            this->timeline = nullptr;
         }
     }
     
+    // needs to be called after the timeline is built,
+    // since the metronome might share a target with it
+    void setMetronome(CachedMidiSequence::Ptr newMetronome) noexcept
+    {
+        this->metronome = nullptr;
+        this->metronomeIndex = 0;
+        this->metronomeTargetIndex = 0;
+
+        if (newMetronome == nullptr || newMetronome->midiMessages.getNumEvents() == 0)
+        {
+            return;
+        }
+
+        this->uniqueInstruments.addIfNotAlreadyThere(newMetronome->instrument);
+        this->metronome = newMetronome;
+
+        if (this->timeline == nullptr)
+        {
+            return;
+        }
+
+        const auto &targets = this->timeline->targets;
+        this->metronomeTargetIndex = targets.size();
+        for (int i = 0; i < targets.size(); ++i)
+        {
+            if (targets.getReference(i).listener == newMetronome->listener)
+            {
+                this->metronomeTargetIndex = i;
+                break;
+            }
+        }
+    }
+
     inline void clear()
     {
         this->uniqueInstruments.clearQuick();
         this->sequences.clearQuick();
+        this->timeline = nullptr;
+        this->timelineIndex = 0;
+        this->metronome = nullptr;
+        this->metronomeIndex = 0;
+        this->metronomeTargetIndex = 0;
+        this->curves.clearQuick();
+        this->curveCursors.clearQuick();
     }
     
     inline bool isEmpty() const
     {
-        return this->sequences.isEmpty();
+        return this->sequences.isEmpty() && this->curves.isEmpty() && this->metronome == nullptr;
     }
     
     double getSampleRate() const
@@ -114,7 +492,7 @@ public:
         }
 
         // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getSampleRate();
+        return this->uniqueInstruments.getFirst()->getProcessorGraph()->getSampleRate();
     }
 
     int getNumOutputChannels() const
@@ -125,7 +503,7 @@ public:
         }
 
         // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getTotalNumOutputChannels();
+        return this->uniqueInstruments.getFirst()->getProcessorGraph()->getTotalNumOutputChannels();
     }
 
     int getNumInputChannels() const
@@ -136,7 +514,7 @@ public:
         }
 
         // TODO: something more reasonable?
-        return this->sequences[0]->instrument->getProcessorGraph()->getTotalNumInputChannels();
+        return this->uniqueInstruments.getFirst()->getProcessorGraph()->getTotalNumInputChannels();
     }
 
     ReferenceCountedArray<CachedMidiSequence> getAllFor(const MidiSequence *midiTrack)
@@ -154,75 +532,380 @@ public:
         return result;
     }
 
-    void seekToTime(double position)
+    // Same as above, but also skips the sequences
+    // whose beat range cannot contain the given beat
+    ReferenceCountedArray<CachedMidiSequence> getAllAt(float beat, const MidiSequence *midiTrack)
     {
-        for (auto *wrapper : this->sequences)
+        ReferenceCountedArray<CachedMidiSequence> result;
+        for (int i = 0; i < this->sequences.size(); ++i)
         {
-            wrapper->currentIndex = this->getNextIndexAtTime(wrapper->midiMessages, (position - DBL_MIN));
+            CachedMidiSequence::Ptr seq(this->sequences[i]);
+            if ((midiTrack == nullptr || midiTrack == seq->track) &&
+                seq->mayContainBeat(beat))
+            {
+                result.add(seq);
+            }
         }
+
+        return result;
     }
-    
-    void seekToStart()
+
+    // Merges all sequences added so far into the flat timeline;
+    // needs to be called once after the cache is filled up
+    void buildTimeline()
     {
-        for (auto *wrapper : this->sequences)
+        CachedMidiTimeline::Ptr newTimeline(new CachedMidiTimeline());
+
+        // min-heap of the current heads of all sequences, ordered by timestamps
+        // (ties are resolved by the sequence index to keep the merge order stable),
+        // which makes picking the next message an O(log n) operation:
+        Array<SequenceHead> heads;
+        heads.ensureStorageAllocated(this->sequences.size());
+
+        const auto findOrAddTarget = [&newTimeline](const CachedMidiSequence *wrapper)
+        {
+            auto &targets = newTimeline->targets;
+            for (int j = 0; j < targets.size(); ++j)
+            {
+                if (targets.getReference(j).listener == wrapper->listener)
+                {
+                    return j;
+                }
+            }
+
+            targets.add({ wrapper->instrument, wrapper->listener });
+            return targets.size() - 1;
+        };
+
+        int numEvents = 0;
+        for (int i = 0; i < this->sequences.size(); ++i)
         {
-            wrapper->currentIndex = 0;
+            const auto *wrapper = this->sequences.getObjectPointerUnchecked(i);
+            numEvents += wrapper->midiMessages.getNumEvents();
+
+            const auto targetIndex = findOrAddTarget(wrapper);
+            heads.add({ wrapper->midiMessages.getEventPointer(0)->message.getTimeStamp(), i, 0, targetIndex });
         }
+
+        std::make_heap(heads.begin(), heads.end(), TransportPlaybackCache::isLaterThan);
+        newTimeline->events.ensureStorageAllocated(numEvents);
+
+        while (!heads.isEmpty())
+        {
+            std::pop_heap(heads.begin(), heads.end(), TransportPlaybackCache::isLaterThan);
+            auto &head = heads.getReference(heads.size() - 1);
+
+            const auto &sequence = this->sequences.getObjectPointerUnchecked(head.sequenceIndex)->midiMessages;
+            const auto &message = sequence.getEventPointer(head.eventIndex)->message;
+
+            CachedMidiTimeline::Event event;
+            event.timeStamp = message.getTimeStamp();
+            event.targetIndex = int16(head.targetIndex);
+            event.isTempo = message.isTempoMetaEvent();
+
+            if (event.isTempo)
+            {
+                const auto *tempoData = message.getMetaEventData();
+                event.data[0] = tempoData[0];
+                event.data[1] = tempoData[1];
+                event.data[2] = tempoData[2];
+                event.size = 3;
+                newTimeline->events.add(event);
+                newTimeline->tempoMap.addTempoChange(event.timeStamp,
+                    event.getMicrosecondsPerQuarterNote() * 0.001);
+            }
+            else if (!message.isMetaEvent() && !message.isSysEx() && message.getRawDataSize() <= 3)
+            {
+                // other meta events, like annotations or time signatures,
+                // are of no interest to instruments, so we just skip them here
+                zeromem(event.data, sizeof(event.data));
+                memcpy(event.data, message.getRawData(), size_t(message.getRawDataSize()));
+                event.size = uint8(message.getRawDataSize());
+                newTimeline->events.add(event);
+            }
+
+            head.eventIndex++;
+            if (head.eventIndex < sequence.getNumEvents())
+            {
+                head.timeStamp = sequence.getEventPointer(head.eventIndex)->message.getTimeStamp();
+                std::push_heap(heads.begin(), heads.end(), TransportPlaybackCache::isLaterThan);
+            }
+            else
+            {
+                heads.removeLast();
+            }
+        }
+
+        for (int i = 0; i < this->curves.size(); ++i)
+        {
+            this->curveCursors.getReference(i).targetIndex =
+                findOrAddTarget(this->curves.getObjectPointerUnchecked(i));
+        }
+
+        this->timeline = newTimeline;
+        this->timelineIndex = 0;
+        this->seekCurvesToStart();
+    }
+
+    const CachedTempoMap &getTempoMap() const noexcept
+    {
+        static const CachedTempoMap emptyMap;
+        return this->timeline != nullptr ? this->timeline->tempoMap : emptyMap;
+    }
+
+    // Positions the playback at the first message at or after the given beat,
+    // the timeline is sorted, so that's just a binary search
+    void seekToBeat(float beat)
+    {
+        jassert(this->timeline != nullptr || this->sequences.isEmpty());
+
+        if (this->metronome != nullptr)
+        {
+            this->metronomeIndex = this->metronome->getNextIndexAtBeat(beat);
+        }
+
+        for (int i = 0; i < this->curves.size(); ++i)
+        {
+            this->seekCurve(i, beat);
+        }
+
+        if (this->timeline == nullptr)
+        {
+            this->timelineIndex = 0;
+            return;
+        }
+
+        const auto &events = this->timeline->events;
+        const auto found = std::lower_bound(events.begin(), events.end(), double(beat),
+            [](const CachedMidiTimeline::Event &event, double timeStamp)
+            {
+                return event.timeStamp < timeStamp;
+            });
+
+        this->timelineIndex = int(found - events.begin());
     }
     
+    void seekToStart()
+    {
+        jassert(this->timeline != nullptr || this->sequences.isEmpty());
+        this->timelineIndex = 0;
+        this->metronomeIndex = 0;
+        this->seekCurvesToStart();
+    }
+    
+    // a merge of the timeline, the automation curves and the metronome ticks,
+    // the timeline goes first when the timestamps are equal,
+    // so that the tempo changes are always sent before the ticks
     bool getNextMessage(CachedMidiMessage &target)
     {
-        double minTimeStamp = DBL_MAX;
-        int targetSequenceIndex = -1;
+        const bool hasTimelineEvents = this->timeline != nullptr &&
+            this->timelineIndex < this->timeline->events.size();
 
-        for (int i = 0; i < this->sequences.size(); ++i)
+        const bool hasMetronomeEvents = this->metronome != nullptr &&
+            this->metronomeIndex < this->metronome->midiMessages.getNumEvents();
+
+        const auto timelineBeat = hasTimelineEvents ?
+            this->timeline->events.getReference(this->timelineIndex).timeStamp :
+            std::numeric_limits<double>::max();
+
+        // there are only a few curves, if any
+        int curveIndex = -1;
+        for (int i = 0; i < this->curveCursors.size(); ++i)
         {
-            const auto *wrapper = this->sequences.getObjectPointer(i);
-            if (wrapper->currentIndex < wrapper->midiMessages.getNumEvents())
+            const auto &cursor = this->curveCursors.getReference(i);
+            if (cursor.nextValue >= 0 && (curveIndex < 0 ||
+                cursor.nextBeat < this->curveCursors.getReference(curveIndex).nextBeat))
             {
-                const auto &message = wrapper->midiMessages.getEventPointer(wrapper->currentIndex)->message;
+                curveIndex = i;
+            }
+        }
 
-                if (message.getTimeStamp() < minTimeStamp)
-                {
-                    minTimeStamp = message.getTimeStamp();
-                    targetSequenceIndex = i;
-                }
+        const auto curveBeat = curveIndex >= 0 ?
+            this->curveCursors.getReference(curveIndex).nextBeat :
+            std::numeric_limits<double>::max();
+
+        if (hasMetronomeEvents)
+        {
+            const auto &tick = this->metronome->midiMessages.getEventPointer(this->metronomeIndex)->message;
+            if (tick.getTimeStamp() < timelineBeat && tick.getTimeStamp() < curveBeat)
+            {
+                this->metronomeIndex++;
+                target.message = tick;
+                target.listener = this->metronome->listener;
+                target.instrument = this->metronome->instrument;
+                target.targetIndex = this->metronomeTargetIndex;
+                return true;
             }
         }
 
-        if (targetSequenceIndex < 0)
+        if (curveIndex >= 0 && curveBeat < timelineBeat)
         {
-            return false;
+            const auto *curve = this->curves.getObjectPointerUnchecked(curveIndex);
+            auto &cursor = this->curveCursors.getReference(curveIndex);
+
+            target.message = MidiMessage::controllerEvent(curve->curveChannel,
+                curve->curveControllerNumber, cursor.nextValue).withTimeStamp(cursor.nextBeat);
+            target.listener = curve->listener;
+            target.instrument = curve->instrument;
+            target.targetIndex = cursor.targetIndex;
+
+            cursor.lastValue = cursor.nextValue;
+            this->findNextCurveChange(curveIndex, cursor.nextBeat);
+            return true;
         }
 
-        auto *foundWrapper = this->sequences.getObjectPointer(targetSequenceIndex);
-        jassert(foundWrapper->currentIndex < foundWrapper->midiMessages.getNumEvents());
+        if (!hasTimelineEvents)
+        {
+            return false;
+        }
 
-        auto &foundMessage = foundWrapper->midiMessages.getEventPointer(foundWrapper->currentIndex)->message;
-        foundWrapper->currentIndex++;
+        const auto &event = this->timeline->events.getReference(this->timelineIndex);
+        const auto &eventTarget = this->timeline->targets.getReference(event.targetIndex);
+        this->timelineIndex++;
 
-        target.message = foundMessage;
-        target.listener = foundWrapper->listener;
-        target.instrument = foundWrapper->instrument;
+        target.message = event.toMidiMessage();
+        target.listener = eventTarget.listener;
+        target.instrument = eventTarget.instrument;
+        target.targetIndex = event.targetIndex;
 
         return true;
     }
+
+    // all unique listeners of the merged timeline, indexed by
+    // CachedMidiMessage::targetIndex, so that the player can keep
+    // its per-instrument state in plain arrays instead of lookups;
+    // the metronome either shares one of them, or comes last
+    int getNumTargets() const noexcept
+    {
+        const auto numTimelineTargets =
+            this->timeline != nullptr ? this->timeline->targets.size() : 0;
+
+        return this->metronome != nullptr ?
+            jmax(numTimelineTargets, this->metronomeTargetIndex + 1) : numTimelineTargets;
+    }
+
+    MidiMessageCollector *getTargetListener(int targetIndex) const noexcept
+    {
+        if (this->timeline == nullptr || targetIndex >= this->timeline->targets.size())
+        {
+            jassert(this->metronome != nullptr && targetIndex == this->metronomeTargetIndex);
+            return this->metronome->listener;
+        }
+
+        return this->timeline->targets.getReference(targetIndex).listener;
+    }
+
+    Instrument *getTargetInstrument(int targetIndex) const noexcept
+    {
+        if (this->timeline == nullptr || targetIndex >= this->timeline->targets.size())
+        {
+            jassert(this->metronome != nullptr && targetIndex == this->metronomeTargetIndex);
+            return this->metronome->instrument;
+        }
+
+        return this->timeline->targets.getReference(targetIndex).instrument;
+    }
     
 private:
-    
-    int getNextIndexAtTime(const MidiMessageSequence &sequence, double timeStamp) const
+
+    void seekCurvesToStart()
     {
-        int i = 0;
-        for (; i < sequence.getNumEvents(); ++i)
+        for (int i = 0; i < this->curves.size(); ++i)
+        {
+            const auto &firstPoint = this->curves.getObjectPointerUnchecked(i)->curve.getReference(0);
+            auto &cursor = this->curveCursors.getReference(i);
+            cursor.segmentIndex = 0;
+            cursor.nextBeat = firstPoint.beat;
+            cursor.nextValue = CachedMidiSequence::getControllerValue(firstPoint.value);
+            cursor.lastValue = -1;
+        }
+    }
+
+    // the value at the given beat is assumed to be sent already,
+    // i.e. via the controller states of the playback context
+    void seekCurve(int curveIndex, double beat)
+    {
+        const auto *curve = this->curves.getObjectPointerUnchecked(curveIndex);
+        const auto &points = curve->curve;
+        auto &cursor = this->curveCursors.getReference(curveIndex);
+
+        if (beat <= points.getReference(0).beat)
         {
-            const double eventTs = sequence.getEventPointer(i)->message.getTimeStamp();
-            if (eventTs >= timeStamp)
+            const auto &firstPoint = points.getReference(0);
+            cursor.segmentIndex = 0;
+            cursor.nextBeat = firstPoint.beat;
+            cursor.nextValue = CachedMidiSequence::getControllerValue(firstPoint.value);
+            cursor.lastValue = -1;
+            return;
+        }
+
+        const auto found = std::upper_bound(points.begin(), points.end(), beat,
+            [](double b, const CachedMidiSequence::CurvePoint &point) { return b < point.beat; });
+
+        cursor.segmentIndex = int(found - points.begin()) - 1;
+        cursor.lastValue = cursor.segmentIndex < points.size() - 1 ?
+            curve->getCurveValueAt(cursor.segmentIndex, beat) :
+            CachedMidiSequence::getControllerValue(points.getLast().value);
+
+        this->findNextCurveChange(curveIndex, beat);
+    }
+
+    // steps through the curve until the controller value changes;
+    // the interpolation is monotonic, so the segments which start
+    // and end with the last sent value are skipped at once
+    void findNextCurveChange(int curveIndex, double afterBeat)
+    {
+        const auto *curve = this->curves.getObjectPointerUnchecked(curveIndex);
+        const auto &points = curve->curve;
+        auto &cursor = this->curveCursors.getReference(curveIndex);
+
+        auto beat = afterBeat;
+        while (cursor.segmentIndex < points.size() - 1)
+        {
+            const auto &start = points.getReference(cursor.segmentIndex);
+            const auto &end = points.getReference(cursor.segmentIndex + 1);
+            const auto endValue = CachedMidiSequence::getControllerValue(end.value);
+
+            beat += CachedMidiSequence::curveStepBeat;
+            if (beat >= end.beat || (endValue == cursor.lastValue &&
+                CachedMidiSequence::getControllerValue(start.value) == cursor.lastValue))
             {
-                break;
+                cursor.segmentIndex++;
+                beat = end.beat;
+                if (endValue != cursor.lastValue)
+                {
+                    cursor.nextBeat = beat;
+                    cursor.nextValue = endValue;
+                    return;
+                }
+
+                continue;
+            }
+
+            const auto value = curve->getCurveValueAt(cursor.segmentIndex, beat);
+            if (value != cursor.lastValue)
+            {
+                cursor.nextBeat = beat;
+                cursor.nextValue = value;
+                return;
             }
         }
-        
-        return i;
+
+        cursor.nextValue = -1;
+    }
+
+    struct SequenceHead final
+    {
+        double timeStamp;
+        int sequenceIndex;
+        int eventIndex;
+        int targetIndex;
+    };
+
+    static bool isLaterThan(const SequenceHead &a, const SequenceHead &b) noexcept
+    {
+        return a.timeStamp > b.timeStamp ||
+            (a.timeStamp == b.timeStamp && a.sequenceIndex > b.sequenceIndex);
     }
 
     JUCE_LEAK_DETECTOR(TransportPlaybackCache)
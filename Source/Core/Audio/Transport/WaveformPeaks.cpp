@@ -0,0 +1,252 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "WaveformPeaks.h"
+
+static inline int16 quantizePeakValue(float value) noexcept
+{
+    return int16(roundToInt(jlimit(-1.f, 1.f, value) * 32767.f));
+}
+
+static inline float dequantizePeakValue(int16 value) noexcept
+{
+    return float(value) / 32767.f;
+}
+
+Range<float> WaveformPeaks::getRange(int channel, int64 startSample, int64 endSample) const noexcept
+{
+    if (channel < 0 || channel >= this->numChannels ||
+        this->levels.isEmpty() || endSample <= startSample)
+    {
+        return {};
+    }
+
+    int levelIndex = 0;
+    int64 levelSamplesPerPeak = WaveformPeaks::samplesPerPeak;
+    while (levelIndex < this->levels.size() - 1 &&
+        levelSamplesPerPeak * WaveformPeaks::levelRatio <= endSample - startSample)
+    {
+        levelIndex++;
+        levelSamplesPerPeak *= WaveformPeaks::levelRatio;
+    }
+
+    const auto &level = this->levels.getReference(levelIndex);
+    const auto numPeaks = level.size() / this->numChannels;
+    const auto firstPeak = int(jlimit(int64(0), int64(numPeaks), startSample / levelSamplesPerPeak));
+    const auto lastPeak = int(jlimit(int64(0), int64(numPeaks), (endSample - 1) / levelSamplesPerPeak + 1));
+    if (firstPeak >= lastPeak)
+    {
+        return {};
+    }
+
+    auto min = std::numeric_limits<int16>::max();
+    auto max = std::numeric_limits<int16>::min();
+    for (int i = firstPeak; i < lastPeak; ++i)
+    {
+        const auto &peak = level.getReference(i * this->numChannels + channel);
+        min = jmin(min, peak.min);
+        max = jmax(max, peak.max);
+    }
+
+    return { dequantizePeakValue(min), dequantizePeakValue(max) };
+}
+
+void WaveformPeaks::buildCoarserLevels()
+{
+    jassert(this->levels.size() == 1);
+
+    while (this->levels.getReference(this->levels.size() - 1).size() / this->numChannels > 1)
+    {
+        const auto &finerLevel = this->levels.getReference(this->levels.size() - 1);
+        const auto numFinerPeaks = finerLevel.size() / this->numChannels;
+        const auto numPeaks = (numFinerPeaks + WaveformPeaks::levelRatio - 1) / WaveformPeaks::levelRatio;
+
+        Array<Peak> level;
+        level.resize(numPeaks * this->numChannels);
+
+        for (int i = 0; i < numPeaks; ++i)
+        {
+            const auto firstFinerPeak = i * WaveformPeaks::levelRatio;
+            const auto lastFinerPeak = jmin(numFinerPeaks, firstFinerPeak + WaveformPeaks::levelRatio);
+            for (int c = 0; c < this->numChannels; ++c)
+            {
+                auto peak = finerLevel.getReference(firstFinerPeak * this->numChannels + c);
+                for (int j = firstFinerPeak + 1; j < lastFinerPeak; ++j)
+                {
+                    const auto &finerPeak = finerLevel.getReference(j * this->numChannels + c);
+                    peak.min = jmin(peak.min, finerPeak.min);
+                    peak.max = jmax(peak.max, finerPeak.max);
+                }
+
+                level.setUnchecked(i * this->numChannels + c, peak);
+            }
+        }
+
+        this->levels.add(move(level));
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Building
+//===----------------------------------------------------------------------===//
+
+WaveformPeaks::Builder::Builder(int numChannels, double sampleRate) :
+    peaks(new WaveformPeaks())
+{
+    this->peaks->numChannels = jmax(1, numChannels);
+    this->peaks->sampleRate = sampleRate;
+    this->peaks->levels.add({});
+    this->pendingRanges.resize(this->peaks->numChannels);
+}
+
+void WaveformPeaks::Builder::addBlock(const AudioBuffer<float> &buffer, int startSample, int numSamples)
+{
+    jassert(this->peaks != nullptr);
+    const auto numChannels = jmin(buffer.getNumChannels(), this->peaks->numChannels);
+
+    while (numSamples > 0)
+    {
+        const auto chunkSize = jmin(numSamples,
+            WaveformPeaks::samplesPerPeak - this->numPendingSamples);
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            const auto range = FloatVectorOperations::findMinAndMax(buffer.getReadPointer(c, startSample), chunkSize);
+            auto &pendingRange = this->pendingRanges.getReference(c);
+            pendingRange = this->numPendingSamples == 0 ? range : pendingRange.getUnionWith(range);
+        }
+
+        this->numPendingSamples += chunkSize;
+        this->peaks->numSamples += chunkSize;
+        startSample += chunkSize;
+        numSamples -= chunkSize;
+
+        if (this->numPendingSamples == WaveformPeaks::samplesPerPeak)
+        {
+            this->flushPendingPeak();
+        }
+    }
+}
+
+void WaveformPeaks::Builder::flushPendingPeak()
+{
+    auto &finestLevel = this->peaks->levels.getReference(0);
+    for (const auto &range : this->pendingRanges)
+    {
+        finestLevel.add({ quantizePeakValue(range.getStart()), quantizePeakValue(range.getEnd()) });
+    }
+
+    for (auto &range : this->pendingRanges)
+    {
+        range = {};
+    }
+
+    this->numPendingSamples = 0;
+}
+
+WaveformPeaks::Ptr WaveformPeaks::Builder::build()
+{
+    jassert(this->peaks != nullptr);
+
+    if (this->numPendingSamples > 0)
+    {
+        this->flushPendingPeak();
+    }
+
+    this->peaks->buildCoarserLevels();
+
+    WaveformPeaks::Ptr result;
+    std::swap(result, this->peaks);
+    return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Peak files
+//===----------------------------------------------------------------------===//
+
+File WaveformPeaks::getPeaksFileFor(const File &audioFile)
+{
+    return audioFile.getSiblingFile(audioFile.getFileName() + ".peaks");
+}
+
+// only the finest level is saved, the rest are cheap to rebuild
+bool WaveformPeaks::saveNextTo(const File &audioFile) const
+{
+    MemoryOutputStream out;
+    out.writeInt(WaveformPeaks::fileMagic);
+    out.writeInt(WaveformPeaks::fileVersion);
+    out.writeInt(this->numChannels);
+    out.writeDouble(this->sampleRate);
+    out.writeInt64(this->numSamples);
+
+    const auto &finestLevel = this->levels.getReference(0);
+    out.writeInt(finestLevel.size());
+    for (const auto &peak : finestLevel)
+    {
+        out.writeShort(peak.min);
+        out.writeShort(peak.max);
+    }
+
+    const auto peaksFile = WaveformPeaks::getPeaksFileFor(audioFile);
+    return peaksFile.replaceWithData(out.getData(), out.getDataSize());
+}
+
+WaveformPeaks::Ptr WaveformPeaks::loadFor(const File &audioFile)
+{
+    const auto peaksFile = WaveformPeaks::getPeaksFileFor(audioFile);
+    if (!peaksFile.existsAsFile() ||
+        peaksFile.getLastModificationTime() < audioFile.getLastModificationTime())
+    {
+        return nullptr;
+    }
+
+    FileInputStream in(peaksFile);
+    if (!in.openedOk() ||
+        in.readInt() != WaveformPeaks::fileMagic ||
+        in.readInt() != WaveformPeaks::fileVersion)
+    {
+        return nullptr;
+    }
+
+    WaveformPeaks::Ptr peaks(new WaveformPeaks());
+    peaks->numChannels = in.readInt();
+    peaks->sampleRate = in.readDouble();
+    peaks->numSamples = in.readInt64();
+
+    const auto numPeaks = in.readInt();
+    const auto expectedNumPeaks = (peaks->numSamples + WaveformPeaks::samplesPerPeak - 1) /
+        WaveformPeaks::samplesPerPeak * peaks->numChannels;
+
+    if (peaks->numChannels <= 0 || numPeaks != expectedNumPeaks ||
+        in.getNumBytesRemaining() < int64(numPeaks) * 4)
+    {
+        return nullptr;
+    }
+
+    Array<Peak> finestLevel;
+    finestLevel.resize(numPeaks);
+    for (auto &peak : finestLevel)
+    {
+        peak.min = in.readShort();
+        peak.max = in.readShort();
+    }
+
+    peaks->levels.add(move(finestLevel));
+    peaks->buildCoarserLevels();
+    return peaks;
+}
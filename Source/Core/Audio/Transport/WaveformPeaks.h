@@ -0,0 +1,108 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Multi-resolution min/max summaries of the rendered audio, built on the fly
+// by the renderer, and kept along with the frozen audio or saved next to
+// the rendered file, so that drawing a waveform at any zoom level only needs
+// to scan a handful of peaks per pixel, and never decodes the audio itself
+
+class WaveformPeaks final : public ReferenceCountedObject
+{
+public:
+
+    using Ptr = ReferenceCountedObjectPtr<WaveformPeaks>;
+
+    // the finest level has one peak per that many samples,
+    // and each next level is that many times coarser
+    static constexpr auto samplesPerPeak = 256;
+    static constexpr auto levelRatio = 4;
+
+    struct Peak final
+    {
+        int16 min = 0;
+        int16 max = 0;
+    };
+
+    int getNumChannels() const noexcept { return this->numChannels; }
+    int64 getNumSamples() const noexcept { return this->numSamples; }
+    double getSampleRate() const noexcept { return this->sampleRate; }
+
+    // the min/max sample values within the range, approximated by the
+    // coarsest level, which still has at least one peak in that range,
+    // so that the cost doesn't depend on the zoom level
+    Range<float> getRange(int channel, int64 startSample, int64 endSample) const noexcept;
+
+    //===------------------------------------------------------------------===//
+    // Building
+    //===------------------------------------------------------------------===//
+
+    class Builder final
+    {
+    public:
+
+        Builder(int numChannels, double sampleRate);
+
+        void addBlock(const AudioBuffer<float> &buffer, int startSample, int numSamples);
+
+        // the last incomplete peak is also added here
+        WaveformPeaks::Ptr build();
+
+    private:
+
+        WaveformPeaks::Ptr peaks;
+
+        Array<Range<float>> pendingRanges;
+        int numPendingSamples = 0;
+
+        void flushPendingPeak();
+
+        JUCE_DECLARE_NON_COPYABLE(Builder)
+    };
+
+    //===------------------------------------------------------------------===//
+    // Peak files
+    //===------------------------------------------------------------------===//
+
+    // e.g. "mixdown.flac.peaks" for "mixdown.flac"
+    static File getPeaksFileFor(const File &audioFile);
+
+    bool saveNextTo(const File &audioFile) const;
+
+    // returns nullptr if there's no peak file, or if it's older than the audio
+    static WaveformPeaks::Ptr loadFor(const File &audioFile);
+
+private:
+
+    WaveformPeaks() = default;
+
+    int numChannels = 0;
+    int64 numSamples = 0;
+    double sampleRate = 0.0;
+
+    // levels[0] is the finest one, the peaks of
+    // all channels are interleaved in each level
+    Array<Array<Peak>> levels;
+
+    void buildCoarserLevels();
+
+    static constexpr auto fileMagic = 0x4b504548; // "HEPK"
+    static constexpr auto fileVersion = 1;
+
+    JUCE_LEAK_DETECTOR(WaveformPeaks)
+};
@@ -0,0 +1,81 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#if JUCE_UNIT_TESTS
+
+// Benchmarks are unit tests of their own category, which is run
+// in the same headless mode instead of the regular tests, when the app
+// is started with --benchmark (and optionally --benchmark-size=N);
+// each measurement is logged as one line of JSON, so that the results
+// can be collected by a script and compared across releases
+
+class Benchmark : public UnitTest
+{
+public:
+
+    explicit Benchmark(const String &name) :
+        UnitTest(name, UnitTestCategories::benchmarks) {}
+
+    // the multiplier for the generated data size,
+    // 1 is roughly a sketch, 10 is roughly a large score
+    static int getSize() noexcept { return Benchmark::size(); }
+    static void setSize(int newSize) noexcept { Benchmark::size() = jmax(1, newSize); }
+
+protected:
+
+    static constexpr auto numRuns = 10;
+
+    // runs the task several times after a warm-up run,
+    // and logs the fastest and the median run times
+    template <typename Task>
+    void measure(const String &caseName, Task &&task)
+    {
+        task();
+
+        Array<double> times;
+        for (int i = 0; i < Benchmark::numRuns; ++i)
+        {
+            const auto startTicks = Time::getHighResolutionTicks();
+            task();
+            const auto endTicks = Time::getHighResolutionTicks();
+            times.add(Time::highResolutionTicksToSeconds(endTicks - startTicks) * 1000.0);
+        }
+
+        times.sort();
+
+        auto *result = new DynamicObject();
+        result->setProperty("benchmark", this->getName());
+        result->setProperty("case", caseName);
+        result->setProperty("size", Benchmark::getSize());
+        result->setProperty("runs", Benchmark::numRuns);
+        result->setProperty("minMs", times.getFirst());
+        result->setProperty("medianMs", times[times.size() / 2]);
+        this->logMessage(JSON::toString(var(result), true));
+    }
+
+private:
+
+    static int &size() noexcept
+    {
+        static int value = 1;
+        return value;
+    }
+};
+
+#endif
@@ -62,11 +62,41 @@ CommandPaletteAction::Ptr CommandPaletteAction::unfiltered()
 CommandPaletteAction::CommandPaletteAction(String text, String hint, float order) :
     name(move(text)),
     hint(move(hint)),
-    order(order) {}
+    order(order),
+    charactersMask(CommandPaletteAction::getCharactersMask(this->name.getCharPointer())) {}
+
+uint32 CommandPaletteAction::getCharactersMask(String::CharPointerType text) noexcept
+{
+    uint32 mask = 0;
+    while (!text.isEmpty())
+    {
+        const auto c = CharacterFunctions::toLowerCase(text.getAndAdvance());
+        mask |= (uint32(1) << (uint32(c) % 32));
+    }
+
+    return mask;
+}
 
 void CommandPaletteAction::setMatch(int score, const uint8 *matches)
 {
     this->matchScore = score;
+    this->hasMatchedIndices = matches != nullptr;
+    if (matches != nullptr)
+    {
+        memcpy(this->matchedIndices, matches, CommandPaletteAction::maxMatches);
+    }
+
+    this->highlightedMatchOutdated = true;
+}
+
+const GlyphArrangement &CommandPaletteAction::getGlyphArrangement() const
+{
+    if (!this->highlightedMatchOutdated)
+    {
+        return this->highlightedMatch;
+    }
+
+    this->highlightedMatchOutdated = false;
     this->highlightedMatch.clear();
 
     const Font fontNormal(Globals::UI::Fonts::L, Font::plain);
@@ -83,6 +113,7 @@ void CommandPaletteAction::setMatch(int score, const uint8 *matches)
     const float xOffset = 0.f;
     const float yOffset = 0.f;
     auto t = this->name.getCharPointer();
+    const auto *matches = this->hasMatchedIndices ? this->matchedIndices : nullptr;
 
     for (int i = 0, nextMatch = 0; i < newGlyphs.size(); ++i)
     {
@@ -94,7 +125,7 @@ void CommandPaletteAction::setMatch(int score, const uint8 *matches)
         {
             isMatchGlyph = true;
             nextMatch++;
-            jassert(nextMatch < 32);
+            jassert(nextMatch < CommandPaletteAction::maxMatches);
         }
 
         const bool isWhitespace = t.isWhitespace();
@@ -104,6 +135,8 @@ void CommandPaletteAction::setMatch(int score, const uint8 *matches)
             xOffset + thisX, yOffset, nextX - thisX,
             isWhitespace));
     }
+
+    return this->highlightedMatch;
 }
 
 int CommandPaletteAction::getMatchScore() const noexcept
@@ -111,11 +144,6 @@ int CommandPaletteAction::getMatchScore() const noexcept
     return this->matchScore;
 }
 
-const GlyphArrangement &CommandPaletteAction::getGlyphArrangement() const noexcept
-{
-    return this->highlightedMatch;
-}
-
 const String &CommandPaletteAction::getName() const noexcept
 {
     return this->name;
@@ -153,7 +181,7 @@ bool CommandPaletteAction::isUnfiltered() const noexcept
 // https://www.forrestthewoods.com/blog/reverse_engineering_sublime_texts_fuzzy_match
 
 // Original code had a limit of 256, but I really expect it to be way lower:
-#define FUZZY_MAX_MATCHES (32)
+#define FUZZY_MAX_MATCHES (CommandPaletteAction::maxMatches)
 #define FUZZY_MAX_RECURSION (8)
 
 static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType str,
@@ -168,38 +196,50 @@ static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType
 
 void CommandPaletteActionsProvider::updateFilter(const String &pattern, bool skipPrefix)
 {
-    this->filteredActions.clearQuick();
-
     auto patternPtr = pattern.getCharPointer();
     if (skipPrefix)
     {
         patternPtr.getAndAdvance();
     }
 
-    const auto updateFilteredListWith = [this, patternPtr](const Actions &actions)
+    const String actualPattern(patternPtr);
+    const auto patternMask = CommandPaletteAction::getCharactersMask(patternPtr);
+
+    const bool sourceActionsChanged = this->updateSourceActions();
+    const bool canRefinePreviousMatches = !sourceActionsChanged &&
+        this->lastPattern.isNotEmpty() && actualPattern.startsWith(this->lastPattern);
+
+    Actions candidates;
+    if (canRefinePreviousMatches)
+    {
+        candidates.swapWith(this->filteredActions);
+    }
+    else
+    {
+        candidates.addArray(this->lastSourceActions);
+    }
+
+    this->filteredActions.clearQuick();
+    this->lastPattern = actualPattern;
+
+    for (const auto &action : candidates)
     {
-        for (const auto &action : actions)
+        if (action->isUnfiltered())
+        {
+            this->filteredActions.add(action);
+        }
+        else if (action->mayMatch(patternMask))
         {
-            if (action->isUnfiltered())
+            int outScore = 0;
+            uint8 matches[FUZZY_MAX_MATCHES] = {};
+            const auto match = fuzzyMatch(patternPtr, action->getName().getCharPointer(), outScore, matches);
+            if (match)
             {
+                action->setMatch(outScore, matches);
                 this->filteredActions.add(action);
             }
-            else
-            {
-                int outScore = 0;
-                uint8 matches[FUZZY_MAX_MATCHES] = {};
-                const auto match = fuzzyMatch(patternPtr, action->getName().getCharPointer(), outScore, matches);
-                if (match)
-                {
-                    action->setMatch(outScore, matches);
-                    this->filteredActions.add(action);
-                }
-            }
         }
-    };
-
-    updateFilteredListWith(this->additionalActions);
-    updateFilteredListWith(this->getActions());
+    }
 
     static CommandPaletteActionSortByMatch comparator;
     this->filteredActions.sort(comparator);
@@ -207,9 +247,11 @@ void CommandPaletteActionsProvider::updateFilter(const String &pattern, bool ski
 
 void CommandPaletteActionsProvider::clearFilter()
 {
+    this->lastPattern.clear();
+    this->updateSourceActions();
+
     this->filteredActions.clearQuick();
-    this->filteredActions.addArray(this->additionalActions);
-    this->filteredActions.addArray(this->getActions());
+    this->filteredActions.addArray(this->lastSourceActions);
     for (const auto &action : this->filteredActions)
     {
         action->setMatch(0, nullptr);
@@ -219,6 +261,37 @@ void CommandPaletteActionsProvider::clearFilter()
     this->filteredActions.sort(comparator);
 }
 
+// returns true if the actions have changed since the last check,
+// which is only a comparison of pointers, way cheaper than the matching
+bool CommandPaletteActionsProvider::updateSourceActions()
+{
+    const auto &actions = this->getActions();
+    const auto numActions = this->additionalActions.size() + actions.size();
+
+    bool hasChanges = numActions != this->lastSourceActions.size();
+    for (int i = 0; !hasChanges && i < this->additionalActions.size(); ++i)
+    {
+        hasChanges = this->lastSourceActions.getObjectPointerUnchecked(i) !=
+            this->additionalActions.getObjectPointerUnchecked(i);
+    }
+
+    const auto offset = this->additionalActions.size();
+    for (int i = 0; !hasChanges && i < actions.size(); ++i)
+    {
+        hasChanges = this->lastSourceActions.getObjectPointerUnchecked(offset + i) !=
+            actions.getObjectPointerUnchecked(i);
+    }
+
+    if (hasChanges)
+    {
+        this->lastSourceActions.clearQuick();
+        this->lastSourceActions.addArray(this->additionalActions);
+        this->lastSourceActions.addArray(actions);
+    }
+
+    return hasChanges;
+}
+
 static bool fuzzyMatch(String::CharPointerType pattern, String::CharPointerType str, int &outScore,
     String::CharPointerType strBegin, uint8 const *srcMatches, uint8 *matches, int nextMatch, int &recursionCount)
 {
@@ -35,10 +35,20 @@ public:
     Callback getCallback() const noexcept;
     bool isUnfiltered() const noexcept;
 
+    static constexpr auto maxMatches = 32;
     void setMatch(int score, const uint8 *matches);
     int getMatchScore() const noexcept;
     float getOrder() const noexcept;
-    const GlyphArrangement &getGlyphArrangement() const noexcept;
+    const GlyphArrangement &getGlyphArrangement() const;
+
+    // a cheap pre-check before the fuzzy matching: each character sets
+    // a bit depending on its lowercase code, so if the pattern has some bit
+    // that the name doesn't, the name can't contain all of its characters
+    static uint32 getCharactersMask(String::CharPointerType text) noexcept;
+    inline bool mayMatch(uint32 patternMask) const noexcept
+    {
+        return (patternMask & ~this->charactersMask) == 0;
+    }
 
 private:
 
@@ -54,9 +64,16 @@ private:
     bool shouldClosePalette = true;
     bool required = false;
 
-    GlyphArrangement highlightedMatch;
+    // the highlighted glyphs are only built when they are displayed,
+    // since most of the matches are never scrolled to
+    mutable GlyphArrangement highlightedMatch;
+    mutable bool highlightedMatchOutdated = true;
+    uint8 matchedIndices[CommandPaletteAction::maxMatches] = {};
+    bool hasMatchedIndices = false;
     int matchScore = 0;
 
+    const uint32 charactersMask;
+
     // actions will be sorted by match, as user is entering the search text,
     // but we may also need ordering for the full list or items with the same match;
     // the context for this variable should be defined by action provider,
@@ -117,6 +134,13 @@ private:
     // all actions after applying a fuzzy search:
     Actions filteredActions;
 
+    // the filtering is incremental: when the new pattern extends
+    // the previous one, only the previous matches can match it,
+    // unless the actions themselves have changed since then
+    String lastPattern;
+    Actions lastSourceActions;
+    bool updateSourceActions();
+
     JUCE_DECLARE_WEAK_REFERENCEABLE(CommandPaletteActionsProvider)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CommandPaletteActionsProvider)
 };
@@ -1208,16 +1208,27 @@ public:
             "/Ab", "/A", "/A#", "/Bb", "/B", "/C", "/C#", "/Db", "/D", "/D#", "/Eb", "/E", "/F", "/F#", "/Gb", "/G", "/G#");
     }
 
-    void parse(const String &input)
+    // returns false if the input is the same as the last parsed one,
+    // e.g. when the palette's text editor re-sends the same text
+    bool parse(const String &input)
     {
-        using namespace ChordParsing;
-        this->chord = CleanupPass(Parser(Lexer(input.getCharPointer()).getTokens()).getExpressions()).getChord();
+        return this->parse(input.getCharPointer());
     }
 
-    void parse(String::CharPointerType input)
+    bool parse(String::CharPointerType input)
     {
         using namespace ChordParsing;
+
+        if (this->hasParsedInput && this->lastInput == input)
+        {
+            return false;
+        }
+
+        this->hasParsedInput = true;
+        this->lastInput = String(input);
         this->chord = CleanupPass(Parser(Lexer(input).getTokens()).getExpressions()).getChord();
+        this->chordAsString = this->describeChord();
+        return true;
     }
 
     bool isValid() const noexcept
@@ -1377,7 +1388,12 @@ public:
         return hasChanges;
     }
 
-    String getChordAsString() const
+    const String &getChordAsString() const noexcept
+    {
+        return this->chordAsString;
+    }
+
+    String describeChord() const
     {
         String result;
 
@@ -1472,6 +1488,10 @@ private:
     ChordParsing::ChordDescription chord;
     mutable Array<int> lastResult;
 
+    String lastInput;
+    String chordAsString;
+    bool hasParsedInput = false;
+
     const Scale::Ptr major = Scale::getNaturalMajorScale();
     const Scale::Ptr minor = Scale::getNaturalMinorScale();
     const UniquePointer<ChordParsing::ChordQualityExpression> qualityFallback =
@@ -1531,19 +1551,33 @@ void CommandPaletteChordConstructor::updateFilter(const String &pattern, bool sk
         inputPtr.getAndAdvance();
     }
 
-    this->chordCompiler->parse(inputPtr);
-    const auto chordAsString = this->chordCompiler->getChordAsString();
+    // the same text, nothing to re-parse or re-suggest
+    if (!this->chordCompiler->parse(inputPtr))
+    {
+        CommandPaletteActionsProvider::updateFilter(pattern, skipPrefix);
+        return;
+    }
 
     this->actions.clearQuick();
     if (this->chordCompiler->isValid())
     {
-        this->actions.add(CommandPaletteAction::action(chordAsString, TRANS(I18n::CommandPalette::chordGenerate), -10.f)->
-            unfiltered()->withCallback([this, chordAsString](TextEditor &ed)
+        // different inputs often describe the same chord,
+        // e.g. while typing spaces, so the action is reused
+        const auto &chordAsString = this->chordCompiler->getChordAsString();
+        if (this->generateAction == nullptr ||
+            this->generateAction->getName() != chordAsString)
         {
-            this->previewIfNeeded();
-            ed.setText("!" + chordAsString);
-            return false;
-        }));
+            this->generateAction = CommandPaletteAction::action(chordAsString,
+                TRANS(I18n::CommandPalette::chordGenerate), -10.f)->
+                unfiltered()->withCallback([this, chordAsString](TextEditor &ed)
+            {
+                this->previewIfNeeded();
+                ed.setText("!" + chordAsString);
+                return false;
+            });
+        }
+
+        this->actions.add(this->generateAction);
     }
     else
     {
@@ -47,6 +47,8 @@ private:
     PianoRoll &roll;
     Array<int> chord;
 
+    CommandPaletteAction::Ptr generateAction;
+
     bool hasMadeChanges = false;
     void undoIfNeeded();
     void previewIfNeeded();
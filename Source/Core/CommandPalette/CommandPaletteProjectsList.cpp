@@ -66,9 +66,26 @@ void CommandPaletteProjectsList::reloadProjects()
             return true;
         }));
 
+#if JUCE_DEBUG
+    this->projects.add(CommandPaletteAction::action(
+        "Generate a large project", {}, 1.f)->
+        withColour(defaultColor)->
+        withCallback([](TextEditor &) {
+            App::Workspace().createGeneratedProject();
+            return true;
+        }));
+#endif
+
+    FlatHashSet<String, StringHash> loadedProjectIds;
+    for (const auto *loadedProject : this->workspace.getLoadedProjects())
+    {
+        loadedProjectIds.emplace(loadedProject->getId());
+    }
+
+    const auto now = Time::getCurrentTime();
     for (auto *projectInfo : this->workspace.getUserProfile().getProjects())
     {
-        const bool isLoaded = this->workspace.hasLoadedProject(projectInfo);
+        const bool isLoaded = loadedProjectIds.contains(projectInfo->getProjectId());
         const auto action = [this, projectInfo](TextEditor &)
         {
             for (auto *loadedProject : this->workspace.getLoadedProjects())
@@ -96,7 +113,7 @@ void CommandPaletteProjectsList::reloadProjects()
         };
 
         constexpr auto orderOffset = 10.f; // after 'create' and 'open' actions
-        const auto sinceLastOpened = Time::getCurrentTime() - projectInfo->getUpdatedAt();
+        const auto sinceLastOpened = now - projectInfo->getUpdatedAt();
         this->projects.add(CommandPaletteAction::action(projectInfo->getTitle(),
             App::getHumanReadableDate(projectInfo->getUpdatedAt()),
             orderOffset + float(sinceLastOpened.inSeconds()))->
@@ -52,7 +52,10 @@ Config::Config(int timeoutToSaveMs) :
 
 Config::~Config()
 {
-    this->saveIfNeeded();
+    // the pending callbacks of background saves will never come
+    DocumentHelpers::waitForBackgroundSaves();
+    this->isSavingInBackground = false;
+    this->saveIfNeeded(false);
 }
 
 void Config::initResources()
@@ -96,8 +99,14 @@ void Config::save(const Serializable *serializable, const Identifier &key)
     SerializedData root(key);
     root.appendChild(serializable->serialize());
 
+    const auto found = this->children.find(key);
+    if (found != this->children.end() && found->second.isEquivalentTo(root))
+    {
+        return;
+    }
+
     this->children[key] = root;
-    this->onConfigChanged();
+    this->onConfigChanged(key);
 }
 
 void Config::load(Serializable *serializable, const Identifier &key)
@@ -117,10 +126,13 @@ void Config::load(Serializable *serializable, const Identifier &key)
 
 void Config::setProperty(const Identifier &key, const var &value, bool delayedSave)
 {
-    this->properties[key] = value;
-    if (delayedSave)
+    auto &property = this->properties[key];
+    const bool hasChanged = !property.equalsWithSameType(value);
+    property = value;
+
+    if (delayedSave && hasChanged)
     {
-        this->onConfigChanged();
+        this->onConfigChanged(key);
     }
 }
 
@@ -135,9 +147,28 @@ bool Config::containsProperty(const Identifier &key) const noexcept
     return this->properties.contains(key) || this->children.contains(key);
 }
 
-bool Config::saveIfNeeded()
+static bool writeConfigFile(InterProcessLock &fileLock,
+    const File &file, const SerializedData &configNode)
+{
+    InterProcessLock::ScopedLockType fLock(fileLock);
+    if (!fLock.isLocked())
+    {
+        DBG("Config !fLock.isLocked()");
+        return false;
+    }
+
+    if (DocumentHelpers::save<XmlSerializer>(file, configNode))
+    {
+        DBG("Config saved: " + file.getFullPathName());
+        return true;
+    }
+
+    return false;
+}
+
+bool Config::saveIfNeeded(bool inBackground)
 {
-    if (!this->needsSaving)
+    if (this->changedKeys.empty())
     {
         return false;
     }
@@ -147,13 +178,14 @@ bool Config::saveIfNeeded()
         return false;
     }
 
-    InterProcessLock::ScopedLockType fLock(this->fileLock);
-    if (!fLock.isLocked())
+    // will be re-scheduled when the running save is done
+    if (this->isSavingInBackground)
     {
-        DBG("Config !fLock.isLocked()");
         return false;
     }
 
+    // the children trees are never modified after being stored,
+    // only replaced, so it's safe to share them with the saving thread
     SerializedData configNode(Serialization::Core::globalConfig);
     for (const auto &i : this->properties)
     {
@@ -165,33 +197,76 @@ bool Config::saveIfNeeded()
         configNode.appendChild(i.second);
     }
 
-    if (DocumentHelpers::save<XmlSerializer>(this->propertiesFile, configNode))
+    ChangedKeys keysBeingSaved;
+    keysBeingSaved.swap(this->changedKeys);
+
+    if (!inBackground)
     {
-        this->needsSaving = false;
-        DBG("Config saved: " + this->propertiesFile.getFullPathName());
-        return true;
+        if (writeConfigFile(this->fileLock, this->propertiesFile, configNode))
+        {
+            return true;
+        }
+
+        this->changedKeys.insert(keysBeingSaved.begin(), keysBeingSaved.end());
+        return false;
     }
 
-    return false;
+    // the destructor waits for all background saves, so the lock outlives the job
+    auto *fileLock = &this->fileLock;
+    const auto file = this->propertiesFile;
+    WeakReference<Config> weakThis(this);
+
+    this->isSavingInBackground = true;
+    DocumentHelpers::saveInBackground([fileLock, file, configNode]()
+    {
+        return writeConfigFile(*fileLock, file, configNode);
+    },
+    [weakThis, keysBeingSaved](bool savedOk)
+    {
+        if (weakThis == nullptr)
+        {
+            return;
+        }
+
+        weakThis->isSavingInBackground = false;
+
+        if (!savedOk)
+        {
+            weakThis->changedKeys.insert(keysBeingSaved.begin(), keysBeingSaved.end());
+        }
+
+        if (!weakThis->changedKeys.empty())
+        {
+            weakThis->scheduleSave();
+        }
+    });
+
+    return true;
 }
 
 void Config::timerCallback()
 {
-    this->saveIfNeeded();
     this->stopTimer();
+    this->saveIfNeeded(true);
 }
 
-void Config::onConfigChanged()
+void Config::onConfigChanged(const Identifier &key)
 {
-    this->needsSaving = true;
+    this->changedKeys.insert(key);
+    this->scheduleSave();
+}
 
+// the timer is restarted on each change, so that the frequent
+// changes, like zooming or resizing, are coalesced into one write
+void Config::scheduleSave()
+{
     if (this->saveTimeout > 0)
     {
         this->startTimer(this->saveTimeout);
     }
     else if (this->saveTimeout == 0)
     {
-        this->saveIfNeeded();
+        this->saveIfNeeded(true);
     }
 }
 
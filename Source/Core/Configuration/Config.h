@@ -67,8 +67,9 @@ public:
 
 private:
 
-    void onConfigChanged();
-    bool saveIfNeeded();
+    void onConfigChanged(const Identifier &key);
+    void scheduleSave();
+    bool saveIfNeeded(bool inBackground);
 
     void timerCallback() override;
 
@@ -92,8 +93,15 @@ private:
 
     UniquePointer<UserInterfaceFlags> uiFlags;
 
-    bool needsSaving = false;
+    // the file is only written when something has actually changed;
+    // while a background save is running, new changes are collected
+    // here and will be written with the next save
+    using ChangedKeys = FlatHashSet<Identifier, IdentifierHash>;
+    ChangedKeys changedKeys;
+    bool isSavingInBackground = false;
+
     int saveTimeout = 0;
 
+    JUCE_DECLARE_WEAK_REFERENCEABLE(Config)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Config)
 };
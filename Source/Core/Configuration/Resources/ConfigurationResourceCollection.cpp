@@ -20,9 +20,31 @@
 #include "JsonSerializer.h"
 #include "BinarySerializer.h"
 #include "DocumentHelpers.h"
+#include "SerializationKeys.h"
 
 // TODO: monitor user's file changes?
 
+// the parsed built-in and user's resources are cached in a binary file,
+// so that json is only parsed on the first start after an update or after
+// the user's file has changed; bump the version when the format changes
+static const int resourceCacheVersion = 1;
+
+static String getResourceSourceHash(const String &builtInResource, const File &usersResource)
+{
+    const auto usersResourceHash = usersResource.existsAsFile() ?
+        usersResource.getLastModificationTime().toMilliseconds() ^ usersResource.getSize() : 0;
+
+    return String(resourceCacheVersion) + "/" +
+        String::toHexString(builtInResource.hashCode64()) + "/" +
+        String::toHexString(usersResourceHash);
+}
+
+static SerializedData getCachedResource(const SerializedData &cache, const Identifier &source)
+{
+    const auto wrapper = cache.getChildWithName(source);
+    return wrapper.getNumChildren() > 0 ? wrapper.getChild(0) : SerializedData();
+}
+
 ConfigurationResourceCollection::ConfigurationResourceCollection(const Identifier &resourceType) :
     resourceType(resourceType) {}
 
@@ -87,6 +109,12 @@ String ConfigurationResourceCollection::getBuiltInResourceString() const
     return {};
 }
 
+File ConfigurationResourceCollection::getResourceCacheFile() const
+{
+    const String assumedFileName = this->resourceType + ".cache";
+    return DocumentHelpers::getConfigSlot(assumedFileName);
+}
+
 const ConfigurationResource &ConfigurationResourceCollection::getResourceComparator() const
 {
     return this->comparator;
@@ -128,15 +156,61 @@ void ConfigurationResourceCollection::reloadResources()
 #endif
 
     const String builtInResource(this->getBuiltInResourceString());
-    if (builtInResource.isNotEmpty())
+    const File usersResource(this->getUsersResourceFile());
+    const File cacheFile(this->getResourceCacheFile());
+    const auto sourceHash = getResourceSourceHash(builtInResource, usersResource);
+
+    SerializedData builtInTree;
+    SerializedData usersTree;
+
+    const auto cache = cacheFile.existsAsFile() ?
+        DocumentHelpers::load<BinarySerializer>(cacheFile) : SerializedData();
+
+    const bool cacheIsValid = cache.hasType(Serialization::Resources::resourceCache) &&
+        cache.getProperty(Serialization::Resources::sourceHash).toString() == sourceHash;
+
+    if (cacheIsValid)
     {
-        const auto tree(DocumentHelpers::load(builtInResource));
-        if (tree.isValid())
+        builtInTree = getCachedResource(cache, Serialization::Resources::builtInResource);
+        usersTree = getCachedResource(cache, Serialization::Resources::usersResource);
+    }
+    else
+    {
+        if (builtInResource.isNotEmpty())
         {
-            this->deserializeResources(tree, this->baseResources);
-            shouldBroadcastChange = true;
+            builtInTree = DocumentHelpers::load(builtInResource);
+        }
+
+        if (usersResource.existsAsFile())
+        {
+            usersTree = DocumentHelpers::load(usersResource);
+        }
+
+        SerializedData newCache(Serialization::Resources::resourceCache);
+        newCache.setProperty(Serialization::Resources::sourceHash, sourceHash);
+
+        SerializedData builtInWrapper(Serialization::Resources::builtInResource);
+        if (builtInTree.isValid())
+        {
+            builtInWrapper.appendChild(builtInTree);
+        }
+
+        SerializedData usersWrapper(Serialization::Resources::usersResource);
+        if (usersTree.isValid())
+        {
+            usersWrapper.appendChild(usersTree);
         }
 
+        newCache.appendChild(builtInWrapper);
+        newCache.appendChild(usersWrapper);
+        DocumentHelpers::save<BinarySerializer>(cacheFile, newCache);
+    }
+
+    if (builtInTree.isValid())
+    {
+        this->deserializeResources(builtInTree, this->baseResources);
+        shouldBroadcastChange = true;
+
         DBG("Loaded built-in " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
     }
 
@@ -163,16 +237,10 @@ void ConfigurationResourceCollection::reloadResources()
 #endif
 
     // Try to extend base config with user's settings
-    const File usersResource(this->getUsersResourceFile());
-
-    if (usersResource.existsAsFile())
+    if (usersTree.isValid())
     {
-        const auto tree(DocumentHelpers::load(usersResource));
-        if (tree.isValid())
-        {
-            this->deserializeResources(tree, this->userResources);
-            shouldBroadcastChange = true;
-        }
+        this->deserializeResources(usersTree, this->userResources);
+        shouldBroadcastChange = true;
 
         DBG("Loaded user's " + this->resourceType.toString() + " in " + String(Time::getMillisecondCounter() - startTime) + " ms");
     }
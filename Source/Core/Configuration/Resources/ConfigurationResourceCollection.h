@@ -117,6 +117,7 @@ protected:
     virtual File getDownloadedResourceFile() const;
     virtual File getUsersResourceFile() const;
     virtual String getBuiltInResourceString() const;
+    virtual File getResourceCacheFile() const;
     virtual const ConfigurationResource &getResourceComparator() const;
 
     using Resources = FlatHashMap<String, ConfigurationResource::Ptr, StringHash>;
@@ -296,7 +296,41 @@ float Arpeggiator::getBeatFor(int arpKeyIndex) const noexcept
     return this->keys.getUnchecked(safeKeyIndex).beat;
 }
 
-Note Arpeggiator::mapArpKeyIntoChordSpace(const Temperament::Ptr temperament,
+void Arpeggiator::ChordKeysCache::update(const Temperament::Ptr newTemperament,
+    const Array<Note> &chord, const Scale::Ptr newChordScale, Note::Key newChordRoot)
+{
+    bool chordKeysMatch = this->chordKeys.size() == chord.size();
+    for (int i = 0; chordKeysMatch && i < chord.size(); ++i)
+    {
+        chordKeysMatch = this->chordKeys.getUnchecked(i) == chord.getUnchecked(i).getKey();
+    }
+
+    if (chordKeysMatch &&
+        this->temperament == newTemperament &&
+        this->chordScale == newChordScale &&
+        this->chordRoot == newChordRoot)
+    {
+        return;
+    }
+
+    this->temperament = newTemperament;
+    this->chordScale = newChordScale;
+    this->chordRoot = newChordRoot;
+
+    this->chordKeys.clearQuick();
+    for (const auto &note : chord)
+    {
+        this->chordKeys.add(note.getKey());
+    }
+
+    this->absChordRoot = SequencerOperations::findAbsoluteRootKey(this->temperament,
+        this->chordRoot, this->chordKeys.getFirst());
+
+    this->mappedKeys.clear();
+}
+
+Note Arpeggiator::mapArpKeyIntoChordSpace(ChordKeysCache &cache,
+    const Temperament::Ptr temperament,
     int arpKeyIndex, float startBeat,
     const Array<Note> &chord, const Scale::Ptr chordScale, Note::Key chordRoot,
     bool reversed, float durationMultiplier, float randomness) const
@@ -304,6 +338,8 @@ Note Arpeggiator::mapArpKeyIntoChordSpace(const Temperament::Ptr temperament,
     jassert(chord.size() > 0);
     jassert(this->keys.size() > 0);
 
+    cache.update(temperament, chord, chordScale, chordRoot);
+
     const auto safeKeyIndex = arpKeyIndex % this->getNumKeys();
 
     const auto arpKeyIndexOrReversed = reversed ? this->getNumKeys() - arpKeyIndex - 1 : arpKeyIndex;
@@ -312,15 +348,20 @@ Note Arpeggiator::mapArpKeyIntoChordSpace(const Temperament::Ptr temperament,
     const auto arpKey = this->keys.getUnchecked(safeKeyIndex);
     const auto arpKeyOrReversed = this->keys.getUnchecked(safeKeyIndexOrReversed);
 
-    const auto absChordRoot = SequencerOperations::findAbsoluteRootKey(temperament,
-        chordRoot, chord.getUnchecked(0).getKey());
-
     static Random rng; // add -1, 0 or 1 scale offset randomly:
     const auto randomScaleOffset = int((rng.nextFloat() * randomness * 2.f) - 1.f);
+    jassert(randomScaleOffset >= -1 && randomScaleOffset <= 1);
+
+    const auto mappedKeyId = safeKeyIndexOrReversed * 3 + (randomScaleOffset + 1);
+    auto mappedKey = cache.mappedKeys.find(mappedKeyId);
+    if (mappedKey == cache.mappedKeys.end())
+    {
+        mappedKey = cache.mappedKeys.emplace(mappedKeyId,
+            this->mapper->mapArpKeyIntoChord(arpKeyOrReversed,
+                chord, chordScale, cache.absChordRoot, randomScaleOffset)).first;
+    }
 
-    const auto newNoteKey =
-        this->mapper->mapArpKeyIntoChord(arpKeyOrReversed,
-            chord, chordScale, absChordRoot, randomScaleOffset);
+    const auto newNoteKey = mappedKey->second;
 
     const auto newNoteVelocity =
         jlimit(0.f, 1.f, this->mapper->mapArpVelocityIntoChord(arpKeyOrReversed, chord)
@@ -57,7 +57,37 @@ public:
     bool isKeyIndexValid(int index) const noexcept;
 
     float getBeatFor(int arpKeyIndex) const noexcept;
-    Note mapArpKeyIntoChordSpace(const Temperament::Ptr temperament,
+
+    // the keys of the arpeggiated notes only depend on the chord's keys,
+    // so they are mapped once per arp key and scale offset, and reused
+    // for the next chords with the same keys, which is the common case;
+    // one cache is meant to be used for one arpeggiation
+    class ChordKeysCache final
+    {
+    public:
+
+        ChordKeysCache() = default;
+
+    private:
+
+        void update(const Temperament::Ptr temperament, const Array<Note> &chord,
+            const Scale::Ptr chordScale, Note::Key chordRoot);
+
+        Temperament::Ptr temperament;
+        Scale::Ptr chordScale;
+        Note::Key chordRoot = 0;
+        Array<Note::Key> chordKeys;
+
+        Note::Key absChordRoot = 0;
+        FlatHashMap<int, Note::Key> mappedKeys;
+
+        friend class Arpeggiator;
+
+        JUCE_DECLARE_NON_COPYABLE(ChordKeysCache)
+    };
+
+    Note mapArpKeyIntoChordSpace(ChordKeysCache &cache,
+        const Temperament::Ptr temperament,
         int arpKeyIndex, float startBeat,
         const Array<Note> &chord, const Scale::Ptr chordScale, Note::Key chordRoot,
         bool reversed, float durationMultiplier = 1.f, float randomness = 0.f) const;
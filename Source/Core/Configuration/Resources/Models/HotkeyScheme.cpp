@@ -26,12 +26,11 @@ HotkeyScheme::HotkeyScheme(const HotkeyScheme &other)
 
 String HotkeyScheme::findHotkeyDescription(int commandId) const noexcept
 {
-    for (const auto &key : this->keyPresses)
+    const auto found = this->commandsIndex.find(commandId);
+    if (found != this->commandsIndex.end())
     {
-        if (key.commandId == commandId)
-        {
-            return key.keyPress.getTextDescriptionWithIcons();
-        }
+        return this->keyPresses.getReference(found->second)
+            .keyPress.getTextDescriptionWithIcons();
     }
 
     return {};
@@ -41,8 +40,15 @@ bool HotkeyScheme::dispatchKeyPress(KeyPress keyPress,
     WeakReference<Component> keyPressReceiver,
     WeakReference<Component> messageReceiver)
 {
-    for (const auto &key : this->keyPresses)
+    const auto found = this->keyPressesIndex.find(HotkeyScheme::getKeyPressHash(keyPress));
+    if (found == this->keyPressesIndex.end())
+    {
+        return false;
+    }
+
+    for (const auto index : found->second)
     {
+        const auto &key = this->keyPresses.getReference(index);
         if (keyPress == key.keyPress)
         {
             if (this->sendHotkeyCommand(key, keyPressReceiver, messageReceiver))
@@ -56,6 +62,30 @@ bool HotkeyScheme::dispatchKeyPress(KeyPress keyPress,
     return false;
 }
 
+// KeyPress::operator== ignores the case of the character key codes
+uint64 HotkeyScheme::getKeyPressHash(const KeyPress &keyPress) noexcept
+{
+    const auto keyCode = keyPress.getKeyCode();
+    const auto normalizedKeyCode = keyCode < 256 ?
+        int(CharacterFunctions::toLowerCase(juce_wchar(keyCode))) : keyCode;
+
+    return (uint64(uint32(keyPress.getModifiers().getRawFlags())) << 32) |
+        uint64(uint32(normalizedKeyCode));
+}
+
+void HotkeyScheme::rebuildIndex()
+{
+    this->keyPressesIndex.clear();
+    this->commandsIndex.clear();
+
+    for (int i = 0; i < this->keyPresses.size(); ++i)
+    {
+        const auto &key = this->keyPresses.getReference(i);
+        this->keyPressesIndex[HotkeyScheme::getKeyPressHash(key.keyPress)].add(i);
+        this->commandsIndex.emplace(key.commandId, i);
+    }
+}
+
 bool HotkeyScheme::dispatchKeyStateChange(bool isKeyDown,
     WeakReference<Component> keyPressReceiver,
     WeakReference<Component> messageReceiver)
@@ -109,7 +139,7 @@ static Component *findMessageReceiver(Component *root, const String &id)
     return nullptr;
 }
 
-bool HotkeyScheme::sendHotkeyCommand(Hotkey key,
+bool HotkeyScheme::sendHotkeyCommand(const Hotkey &key,
     WeakReference<Component> keyPressReceiver,
     WeakReference<Component> messageReceiver)
 {
@@ -231,6 +261,8 @@ void HotkeyScheme::deserialize(const SerializedData &data)
             this->keyUps.add(createHotkey(e, receiver));
         }
     }
+
+    this->rebuildIndex();
 }
 
 void HotkeyScheme::reset()
@@ -239,6 +271,8 @@ void HotkeyScheme::reset()
     this->keyPresses.clearQuick();
     this->keyDowns.clearQuick();
     this->keyUps.clearQuick();
+    this->keyPressesIndex.clear();
+    this->commandsIndex.clear();
     this->receiverChildren.clear();
     this->holdKeys.clearQuick();
     this->lastReceiver = nullptr;
@@ -253,6 +287,7 @@ HotkeyScheme &HotkeyScheme::operator=(const HotkeyScheme &other)
     this->keyPresses.addArray(other.keyPresses);
     this->keyDowns.addArray(other.keyDowns);
     this->keyUps.addArray(other.keyUps);
+    this->rebuildIndex();
     return *this;
 }
 
@@ -79,10 +79,18 @@ private:
     Array<Hotkey> keyUps;
     Array<KeyPress> holdKeys;
 
+    // the key presses are looked up on every key event, so the scheme
+    // is indexed when loaded: the hotkeys for each key code and modifiers,
+    // in their order in the scheme, and the first hotkey for each command
+    FlatHashMap<uint64, Array<int>> keyPressesIndex;
+    FlatHashMap<int, int> commandsIndex;
+    static uint64 getKeyPressHash(const KeyPress &keyPress) noexcept;
+    void rebuildIndex();
+
     WeakReference<Component> lastReceiver;
     FlatHashMap<String, WeakReference<Component>, StringHash> receiverChildren;
 
-    bool sendHotkeyCommand(Hotkey key,
+    bool sendHotkeyCommand(const Hotkey &key,
         WeakReference<Component> root,
         WeakReference<Component> target);
 
@@ -215,6 +215,8 @@ void KeyboardMapping::loadMapFromString(const String &str)
         }
     } while (c != 0);
 
+    this->updateDefaultMappingFlag();
+    this->version++;
     this->sendChangeMessage();
 }
 
@@ -227,6 +229,8 @@ void KeyboardMapping::loadMapFromPreset(KeyboardMapping *preset)
         this->index[i] = preset->index[i];
     }
 
+    this->isDefaultMapping = preset->isDefaultMapping;
+    this->version++;
     this->sendChangeMessage();
 }
 
@@ -244,6 +248,8 @@ void KeyboardMapping::reset()
         this->index[key] = KeyboardMapping::getDefaultMappingFor(key);
     }
 
+    this->isDefaultMapping = true;
+    this->version++;
     this->sendChangeMessage();
 }
 
@@ -384,6 +390,8 @@ void KeyboardMapping::loadScalaKbmFile(InputStream &fileContentStream,
         }
     }
 
+    this->updateDefaultMappingFlag();
+    this->version++;
     this->sendChangeMessage();
 }
 
@@ -398,9 +406,24 @@ void KeyboardMapping::updateKey(int key, int8 targetKey, int8 targetChannel)
     jassert(targetKey >= 0);
     jassert(targetChannel > 0);
     this->index[key] = { targetKey, targetChannel };
+    this->updateDefaultMappingFlag();
+    this->version++;
     this->sendChangeMessage();
 }
 
+void KeyboardMapping::updateDefaultMappingFlag() noexcept
+{
+    this->isDefaultMapping = true;
+    for (int key = 0; key < KeyboardMapping::numMappedKeys; ++key)
+    {
+        if (this->index[key] != KeyboardMapping::getDefaultMappingFor(key))
+        {
+            this->isDefaultMapping = false;
+            return;
+        }
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // BaseResource
 //===----------------------------------------------------------------------===//
@@ -74,6 +74,19 @@ public:
         return this->index[key];
     }
 
+    // most instruments never customize the mapping, so the exporters
+    // can skip the table and just compute the default key and channel
+    bool isDefault() const noexcept
+    {
+        return this->isDefaultMapping;
+    }
+
+    static KeyChannel getDefaultMappingFor(int key) noexcept;
+
+    // incremented on any change of the mapping itself (not the name),
+    // so that the exported sequences can tell if they're outdated
+    int getVersion() const noexcept { return this->version; }
+
     void updateKey(int key, const KeyChannel &keyChannel);
     void updateKey(int key, int8 targetKey, int8 targetChannel);
 
@@ -108,10 +121,13 @@ public:
 
 private:
 
-    static KeyChannel getDefaultMappingFor(int key) noexcept;
-
     String name;
     KeyChannel index[numMappedKeys];
 
+    bool isDefaultMapping = true;
+    void updateDefaultMappingFlag() noexcept;
+
+    int version = 0;
+
     JUCE_DECLARE_WEAK_REFERENCEABLE(KeyboardMapping)
 };
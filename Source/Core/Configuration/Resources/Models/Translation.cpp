@@ -59,6 +59,23 @@ void Translation::deserialize(const SerializedData &data)
         Translations::wrapperMethodName + "(" +
         root.getProperty(Translations::pluralEquation, "1").toString() + ")";
 
+    this->pendingLiterals.add(root);
+}
+
+void Translation::loadPendingLiterals()
+{
+    for (const auto &root : this->pendingLiterals)
+    {
+        this->deserializeLiterals(root);
+    }
+
+    this->pendingLiterals.clearQuick();
+}
+
+void Translation::deserializeLiterals(const SerializedData &root)
+{
+    using namespace Serialization;
+
     forEachChildWithType(root, pluralLiteral, Translations::pluralLiteral)
     {
         I18n::Key literalKey = I18n::Key(int64(pluralLiteral.getProperty(Translations::translationId)));
@@ -149,6 +166,7 @@ void Translation::deserialize(const SerializedData &data)
 
 void Translation::reset()
 {
+    this->pendingLiterals.clear();
     this->singulars.clear();
     this->plurals.clear();
 }
@@ -45,6 +45,12 @@ public:
 
 private:
 
+    // only the locale ids and names are needed until a translation
+    // is actually selected, so parsing the literals is deferred
+    void loadPendingLiterals();
+    void deserializeLiterals(const SerializedData &root);
+    Array<SerializedData> pendingLiterals;
+
     String id;
     String name;
     String pluralEquation;
@@ -279,6 +279,8 @@ namespace I18n
         static constexpr auto audioDevice = constexprHash("settings::audio::device");
         static constexpr auto audioDriver = constexprHash("settings::audio::driver");
         static constexpr auto audioSampleRate = constexprHash("settings::audio::samplerate");
+        static constexpr auto audioMeasureLatency = constexprHash("settings::audio::latency::measure");
+        static constexpr auto audioLatencyFailed = constexprHash("settings::audio::latency::failed");
         static constexpr auto midiRecord = constexprHash("settings::midi::record");
         static constexpr auto midiOutput = constexprHash("settings::midi::output");
         static constexpr auto midiOutputNone = constexprHash("settings::midi::output::none");
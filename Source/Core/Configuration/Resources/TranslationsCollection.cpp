@@ -84,7 +84,14 @@ void TranslationsCollection::loadLocaleWithId(const String &localeId)
 
     if (const auto translation = this->getResourceById<Translation>(localeId))
     {
-        this->currentTranslation = translation;
+        translation->loadPendingLiterals();
+
+        {
+            const SpinLock::ScopedLockType sl(this->currentTranslationLock);
+            this->currentTranslation = translation;
+            this->updateSingulars();
+        }
+
         App::Config().setProperty(Serialization::Config::currentLocale, localeId);
         this->sendChangeMessage();
     }
@@ -104,16 +111,10 @@ String TranslationsCollection::translate(I18n::Key key)
 {
     const SpinLock::ScopedLockType sl(this->currentTranslationLock);
 
-    const auto foundCurrentSingular = this->currentTranslation->singulars.find(key);
-    if (foundCurrentSingular != this->currentTranslation->singulars.end())
+    const auto foundSingular = this->singulars.find(key);
+    if (foundSingular != this->singulars.end())
     {
-        return foundCurrentSingular->second;
-    }
-
-    const auto foundFallbackSingular = this->fallbackTranslation->singulars.find(key);
-    if (foundFallbackSingular != this->fallbackTranslation->singulars.end())
-    {
-        return foundFallbackSingular->second;
+        return foundSingular->second;
     }
 
     return {};
@@ -136,21 +137,39 @@ String TranslationsCollection::translate(const String &baseLiteral, int64 target
         return baseLiteral.replace(Translations::metaSymbol, String(targetNumber));
     }
 
-    const String expressionToEvaluate =
-        this->currentTranslation->pluralEquation.replace(Translations::metaSymbol,
-            String(targetNumber > 0 ? targetNumber : -targetNumber));
+    const auto absNumber = targetNumber > 0 ? targetNumber : -targetNumber;
+    const bool isCacheable = absNumber <= TranslationsCollection::maxCachedPluralNumber;
 
-    const Result result = this->engine->execute(expressionToEvaluate);
-    if (!result.failed())
+    String pluralForm;
+    const auto foundPluralForm = this->pluralForms.find(absNumber);
+    if (isCacheable && foundPluralForm != this->pluralForms.end())
+    {
+        pluralForm = foundPluralForm->second;
+    }
+    else
     {
-        const String pluralForm = this->equationResult;
-        const auto foundTranslation = foundPlural->second->find(pluralForm);
-        if (foundTranslation != foundPlural->second->end())
+        const String expressionToEvaluate =
+            this->currentTranslation->pluralEquation.replace(Translations::metaSymbol, String(absNumber));
+
+        const Result result = this->engine->execute(expressionToEvaluate);
+        if (result.failed())
         {
-            return foundTranslation->second.replace(Translations::metaSymbol, String(targetNumber));
+            return baseLiteral.replace(Translations::metaSymbol, String(targetNumber));
+        }
+
+        pluralForm = this->equationResult;
+        if (isCacheable)
+        {
+            this->pluralForms[absNumber] = pluralForm;
         }
     }
 
+    const auto foundTranslation = foundPlural->second->find(pluralForm);
+    if (foundTranslation != foundPlural->second->end())
+    {
+        return foundTranslation->second.replace(Translations::metaSymbol, String(targetNumber));
+    }
+
     return baseLiteral.replace(Translations::metaSymbol, String(targetNumber));
 }
 
@@ -202,6 +221,20 @@ void TranslationsCollection::deserializeResources(const SerializedData &tree, Re
 
     jassert(this->currentTranslation != nullptr);
     jassert(this->fallbackTranslation != nullptr);
+
+    // all other translations are only parsed when selected
+    if (this->currentTranslation != nullptr)
+    {
+        this->currentTranslation->loadPendingLiterals();
+    }
+
+    if (this->fallbackTranslation != nullptr)
+    {
+        this->fallbackTranslation->loadPendingLiterals();
+    }
+
+    const SpinLock::ScopedLockType sl(this->currentTranslationLock);
+    this->updateSingulars();
 }
 
 void TranslationsCollection::reset()
@@ -210,12 +243,36 @@ void TranslationsCollection::reset()
     this->currentTranslation = nullptr;
     this->fallbackTranslation = nullptr;
     this->equationResult.clear();
+
+    const SpinLock::ScopedLockType sl(this->currentTranslationLock);
+    this->updateSingulars();
 }
 
 //===----------------------------------------------------------------------===//
 // Private
 //===----------------------------------------------------------------------===//
 
+// expects the translation lock to be held
+void TranslationsCollection::updateSingulars()
+{
+    this->singulars.clear();
+    this->pluralForms.clear();
+
+    if (this->fallbackTranslation != nullptr)
+    {
+        this->singulars = this->fallbackTranslation->singulars;
+    }
+
+    if (this->currentTranslation != nullptr &&
+        this->currentTranslation != this->fallbackTranslation)
+    {
+        for (const auto &singular : this->currentTranslation->singulars)
+        {
+            this->singulars[singular.first] = singular.second;
+        }
+    }
+}
+
 String TranslationsCollection::getSelectedLocaleId() const
 {
     if (App::Config().containsProperty(Serialization::Config::currentLocale))
@@ -61,6 +61,17 @@ private:
     Translation::Ptr currentTranslation;
     Translation::Ptr fallbackTranslation;
 
+    // the current translation's singulars merged over the fallback ones,
+    // so that translating a key is a single lookup
+    Translation::SingularsMap singulars;
+    void updateSingulars();
+
+    // evaluating the plural equation in the javascript engine is slow,
+    // and the results only depend on the number, so they are cached;
+    // the numbers above the limit are too rare to be worth caching
+    static constexpr auto maxCachedPluralNumber = 10000;
+    FlatHashMap<int64, String> pluralForms;
+
     String getSelectedLocaleId() const;
     friend struct PluralEquationWrapper;
 
@@ -0,0 +1,206 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "HeadlessRender.h"
+#include "Workspace.h"
+#include "RootNode.h"
+#include "ProjectNode.h"
+#include "Transport.h"
+#include "AudioCore.h"
+
+static String getHeadlessRenderArg(const StringArray &args, const String &prefix)
+{
+    for (const auto &arg : args)
+    {
+        if (arg.startsWith(prefix))
+        {
+            return arg.fromFirstOccurrenceOf("=", false, false).unquoted();
+        }
+    }
+
+    return {};
+}
+
+// unlike DBG, this is also visible in the release builds,
+// so that the scripts running the renders can see what's wrong
+static void logHeadlessRender(const String &message)
+{
+    Logger::writeToLog("Render: " + message);
+}
+
+HeadlessRender::HeadlessRender(Workspace &workspace) :
+    workspace(workspace) {}
+
+HeadlessRender::~HeadlessRender()
+{
+    this->stopTimer();
+
+    if (this->project != nullptr)
+    {
+        this->project->getTransport().stopRender();
+    }
+}
+
+bool HeadlessRender::isRequested(const StringArray &args)
+{
+    return getHeadlessRenderArg(args, "--render=").isNotEmpty();
+}
+
+bool HeadlessRender::start(const StringArray &args)
+{
+    const auto workingDirectory = File::getCurrentWorkingDirectory();
+    const auto projectFile = workingDirectory.getChildFile(getHeadlessRenderArg(args, "--render="));
+    if (!projectFile.existsAsFile())
+    {
+        logHeadlessRender("project not found: " + projectFile.getFullPathName());
+        return false;
+    }
+
+    this->format = RenderFormat::FLAC;
+    const auto formatName = getHeadlessRenderArg(args, "--format=").toLowerCase();
+    if (formatName == getExtensionForRenderFormat(RenderFormat::WAV))
+    {
+        this->format = RenderFormat::WAV;
+    }
+    else if (formatName.isNotEmpty() && formatName != getExtensionForRenderFormat(RenderFormat::FLAC))
+    {
+        logHeadlessRender("unsupported format: " + formatName);
+        return false;
+    }
+
+    const auto outputPath = getHeadlessRenderArg(args, "--output=");
+    this->outputFile = outputPath.isEmpty() ?
+        projectFile.withFileExtension(getExtensionForRenderFormat(this->format)) :
+        workingDirectory.getChildFile(outputPath);
+
+    auto &options = this->options;
+    // nobody is waiting for the first block here
+    options.blockSize = RenderOptions::maxBlockSize;
+    options.stems = args.contains("--stems");
+    options.renderTail = args.contains("--tail");
+
+    const auto bitDepth = getHeadlessRenderArg(args, "--bit-depth=");
+    if (bitDepth.isNotEmpty())
+    {
+        options.bitDepth = bitDepth.getIntValue();
+        if (options.bitDepth != 16 && options.bitDepth != 24 && options.bitDepth != 32)
+        {
+            logHeadlessRender("unsupported bit depth: " + bitDepth);
+            return false;
+        }
+    }
+
+    const auto startBeat = getHeadlessRenderArg(args, "--start-beat=");
+    const auto endBeat = getHeadlessRenderArg(args, "--end-beat=");
+    if (startBeat.isNotEmpty() || endBeat.isNotEmpty())
+    {
+        options.startBeat = startBeat.getFloatValue();
+        options.endBeat = endBeat.getFloatValue();
+        if (!options.hasRange())
+        {
+            logHeadlessRender("the end beat should be after the start beat");
+            return false;
+        }
+    }
+
+    // the project is not opened via RootNode::openProject,
+    // which would also select it and show its pages
+    this->project = new ProjectNode(projectFile);
+    this->workspace.getTreeRoot()->addChildNode(this->project);
+    if (!this->project->getDocument()->load(projectFile))
+    {
+        logHeadlessRender("failed to load " + projectFile.getFullPathName());
+        return false;
+    }
+
+    // the plugins of the instruments might be still loading asynchronously,
+    // so the rendering is started from the timer, when they are all ready
+    logHeadlessRender(projectFile.getFullPathName() + " -> " + this->outputFile.getFullPathName());
+    this->loadingStartTimeMs = Time::getMillisecondCounter();
+    this->startTimer(HeadlessRender::progressPollMs);
+    return true;
+}
+
+bool HeadlessRender::hasLoadingInstruments() const
+{
+    for (const auto *instrument : this->workspace.getAudioCore().getInstruments())
+    {
+        if (instrument->isLoading())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void HeadlessRender::timerCallback()
+{
+    auto &transport = this->project->getTransport();
+
+    if (!this->isRenderStarted)
+    {
+        if (this->hasLoadingInstruments())
+        {
+            const auto waitedMs = Time::getMillisecondCounter() - this->loadingStartTimeMs;
+            if (waitedMs < HeadlessRender::instrumentsTimeoutMs)
+            {
+                return;
+            }
+
+            logHeadlessRender("timed out waiting for the instruments to load");
+            this->stopTimer();
+            this->finish(false);
+            return;
+        }
+
+        this->isRenderStarted = true;
+        if (!transport.startRender(URL(this->outputFile), this->format, this->options))
+        {
+            logHeadlessRender("failed to start rendering " + this->outputFile.getFullPathName());
+            this->stopTimer();
+            this->finish(false);
+        }
+
+        return;
+    }
+
+    if (transport.isRendering())
+    {
+        const auto percents = int(transport.getRenderingPercentsComplete() * 100.f);
+        if (percents / 10 > this->lastLoggedPercents / 10)
+        {
+            this->lastLoggedPercents = percents;
+            logHeadlessRender(String(percents) + "%, " +
+                String(transport.getRenderingRealtimeFactor(), 1) + "x realtime");
+        }
+
+        return;
+    }
+
+    this->stopTimer();
+    this->finish(transport.hasRenderSucceeded());
+}
+
+void HeadlessRender::finish(bool succeeded)
+{
+    logHeadlessRender(succeeded ? "done" : "failed");
+
+    JUCEApplication::getInstance()->setApplicationReturnValue(succeeded ? 0 : 1);
+    JUCEApplication::quit();
+}
@@ -0,0 +1,74 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+class Workspace;
+class ProjectNode;
+
+#include "RenderFormat.h"
+
+// Renders a project into a file without opening the main window,
+// for batch exports from scripts, when the app is started like:
+//
+//   helio --render=song.helio [--output=song.flac] [--format=flac|wav]
+//       [--bit-depth=16|24|32] [--start-beat=N --end-beat=N] [--stems] [--tail]
+//
+// the instruments are restored from the saved workspace, but the workspace
+// is never saved back, so that several renders can run in parallel processes;
+// the app exits with a non-zero code, if the render has failed
+
+class HeadlessRender final : private Timer
+{
+public:
+
+    explicit HeadlessRender(Workspace &workspace);
+    ~HeadlessRender() override;
+
+    static bool isRequested(const StringArray &args);
+
+    // returns false if the arguments are invalid, or the project
+    // cannot be loaded; otherwise, waits for the instruments to load,
+    // renders the project and quits the app when done
+    bool start(const StringArray &args);
+
+private:
+
+    void timerCallback() override;
+    void finish(bool succeeded);
+
+    bool hasLoadingInstruments() const;
+
+    Workspace &workspace;
+
+    // owned by the workspace tree
+    ProjectNode *project = nullptr;
+
+    File outputFile;
+    RenderFormat format = RenderFormat::FLAC;
+    RenderOptions options;
+
+    bool isRenderStarted = false;
+    uint32 loadingStartTimeMs = 0;
+    int lastLoggedPercents = 0;
+
+    static constexpr auto progressPollMs = 250;
+    // some plugins take a while to scan their sample libraries
+    static constexpr auto instrumentsTimeoutMs = 120000;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessRender)
+};
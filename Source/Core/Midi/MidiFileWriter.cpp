@@ -0,0 +1,116 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "MidiFileWriter.h"
+
+MidiFileWriter::MidiFileWriter(OutputStream &stream) noexcept :
+    stream(stream) {}
+
+bool MidiFileWriter::writeHeader(int numTracks, short timeFormat)
+{
+    jassert(this->numTracksWritten == 0);
+    this->numTracksExpected = numTracks;
+
+    // multi-track file, same as MidiFile::writeTo does
+    return this->stream.writeIntBigEndian(int(ByteOrder::bigEndianInt("MThd"))) &&
+        this->stream.writeIntBigEndian(6) &&
+        this->stream.writeShortBigEndian(1) &&
+        this->stream.writeShortBigEndian(short(numTracks)) &&
+        this->stream.writeShortBigEndian(timeFormat);
+}
+
+// the same encoding as MidiFile uses, including the running status
+bool MidiFileWriter::writeTrack(const MidiMessageSequence &sequence)
+{
+    jassert(this->numTracksWritten < this->numTracksExpected);
+    this->numTracksWritten++;
+
+    this->trackData.reset();
+
+    int lastTick = 0;
+    uint8 lastStatusByte = 0;
+    bool endOfTrackEventWritten = false;
+
+    for (int i = 0; i < sequence.getNumEvents(); ++i)
+    {
+        const auto &message = sequence.getEventPointer(i)->message;
+
+        if (message.isEndOfTrackMetaEvent())
+        {
+            endOfTrackEventWritten = true;
+        }
+
+        const auto tick = roundToInt(message.getTimeStamp());
+        this->writeVariableLengthInt(uint32(jmax(0, tick - lastTick)));
+        lastTick = tick;
+
+        const auto *data = message.getRawData();
+        auto dataSize = message.getRawDataSize();
+        const auto statusByte = data[0];
+
+        if (statusByte == lastStatusByte &&
+            (statusByte & 0xf0) != 0xf0 && dataSize > 1 && i > 0)
+        {
+            ++data;
+            --dataSize;
+        }
+        else if (statusByte == 0xf0)
+        {
+            // sysex is written with its length
+            this->trackData.writeByte(char(statusByte));
+            ++data;
+            --dataSize;
+            this->writeVariableLengthInt(uint32(dataSize));
+        }
+
+        this->trackData.write(data, size_t(dataSize));
+        lastStatusByte = statusByte;
+    }
+
+    if (!endOfTrackEventWritten)
+    {
+        this->trackData.writeByte(0);
+        const auto endOfTrack = MidiMessage::endOfTrack();
+        this->trackData.write(endOfTrack.getRawData(), size_t(endOfTrack.getRawDataSize()));
+    }
+
+    return this->stream.writeIntBigEndian(int(ByteOrder::bigEndianInt("MTrk"))) &&
+        this->stream.writeIntBigEndian(int(this->trackData.getDataSize())) &&
+        this->stream.write(this->trackData.getData(), this->trackData.getDataSize());
+}
+
+void MidiFileWriter::writeVariableLengthInt(uint32 value)
+{
+    auto buffer = value & 0x7f;
+    while ((value >>= 7) != 0)
+    {
+        buffer <<= 8;
+        buffer |= ((value & 0x7f) | 0x80);
+    }
+
+    while (true)
+    {
+        this->trackData.writeByte(char(buffer));
+        if ((buffer & 0x80) == 0)
+        {
+            break;
+        }
+
+        buffer >>= 8;
+    }
+}
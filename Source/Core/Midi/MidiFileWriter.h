@@ -0,0 +1,43 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Writes a standard MIDI file track by track, as opposed to MidiFile,
+// which needs all the tracks to be kept in memory until it writes them;
+// only the current track chunk is buffered, because its size goes first
+class MidiFileWriter final
+{
+public:
+
+    explicit MidiFileWriter(OutputStream &stream) noexcept;
+
+    bool writeHeader(int numTracks, short timeFormat);
+    bool writeTrack(const MidiMessageSequence &sequence);
+
+private:
+
+    void writeVariableLengthInt(uint32 value);
+
+    OutputStream &stream;
+    MemoryOutputStream trackData;
+
+    int numTracksExpected = 0;
+    int numTracksWritten = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiFileWriter)
+};
@@ -228,13 +228,42 @@ SerializedData Clip::serialize() const
 void Clip::deserialize(const SerializedData &data)
 {
     using namespace Serialization;
-    this->key = data.getProperty(Midi::key, 0);
-    this->beat = float(data.getProperty(Midi::timestamp)) / Globals::ticksPerBeat;
-    this->id = unpackId(data.getProperty(Midi::id, this->id));
-    const auto vol = float(data.getProperty(Midi::volume, Globals::velocitySaveResolution)) / Globals::velocitySaveResolution;
-    this->velocity = jmax(jmin(vol, 1.f), 0.f);
-    this->mute = bool(data.getProperty(Midi::mute, 0));
-    this->solo = bool(data.getProperty(Midi::solo, 0));
+
+    this->key = 0;
+    this->beat = 0.f;
+    this->velocity = 1.f;
+    this->mute = false;
+    this->solo = false;
+
+    data.forEachProperty([this](const Identifier &name, const var &value)
+    {
+        if (name == Midi::key)
+        {
+            this->key = value;
+        }
+        else if (name == Midi::timestamp)
+        {
+            this->beat = float(value) / Globals::ticksPerBeat;
+        }
+        else if (name == Midi::id)
+        {
+            this->id = unpackId(value);
+        }
+        else if (name == Midi::volume)
+        {
+            const auto vol = float(value) / Globals::velocitySaveResolution;
+            this->velocity = jmax(jmin(vol, 1.f), 0.f);
+        }
+        else if (name == Midi::mute)
+        {
+            this->mute = bool(value);
+        }
+        else if (name == Midi::solo)
+        {
+            this->solo = bool(value);
+        }
+    });
+
     this->updateCaches();
 }
 
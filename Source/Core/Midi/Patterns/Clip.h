@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "PooledAllocator.h"
+
 class Pattern;
 
 // Just an instance of a midi sequence on a certain position,
@@ -119,6 +121,11 @@ private:
     friend class LegacyClipFormatSupportTests;
 
     JUCE_LEAK_DETECTOR(Clip);
+
+public:
+
+    // see PooledAllocator.h
+    POOLED_ALLOCATOR(Clip)
 };
 
 struct ClipHash
@@ -101,15 +101,56 @@ void Pattern::sort()
 
 bool Pattern::hasSoloClips() const noexcept
 {
-    for (const auto *clip : this->clips)
+    jassert(this->numSoloClips >= 0);
+    return this->numSoloClips > 0;
+}
+
+bool Pattern::hasMutedClips() const noexcept
+{
+    jassert(this->numMutedClips >= 0);
+    return this->numMutedClips > 0;
+}
+
+int Pattern::indexOfFirstClipStartingFrom(float beat) const noexcept
+{
+    return int(std::lower_bound(this->clips.begin(), this->clips.end(), beat,
+        [](const Clip *clip, float beat) { return clip->getBeat() < beat; }) - this->clips.begin());
+}
+
+int Pattern::indexOfFirstClipStartingAfter(float beat) const noexcept
+{
+    return int(std::upper_bound(this->clips.begin(), this->clips.end(), beat,
+        [](float beat, const Clip *clip) { return beat < clip->getBeat(); }) - this->clips.begin());
+}
+
+Clip *Pattern::findClosestClip(float beat) const noexcept
+{
+    if (this->clips.isEmpty())
     {
-        if (clip->isSoloed())
-        {
-            return true;
-        }
+        return nullptr;
+    }
+
+    const auto index = this->indexOfFirstClipStartingFrom(beat);
+    if (index == this->clips.size())
+    {
+        return this->clips.getLast();
     }
 
-    return false;
+    auto *next = this->clips.getUnchecked(index);
+    if (index == 0)
+    {
+        return next;
+    }
+
+    // prefer the earlier one if both are equally close:
+    auto *previous = this->clips.getUnchecked(index - 1);
+    return (beat - previous->getBeat()) <= (next->getBeat() - beat) ? previous : next;
+}
+
+void Pattern::updateClipCounters(const Clip &clip, int delta) noexcept
+{
+    this->numSoloClips += clip.isSoloed() ? delta : 0;
+    this->numMutedClips += clip.isMuted() ? delta : 0;
 }
 
 //===----------------------------------------------------------------------===//
@@ -158,6 +199,7 @@ void Pattern::silentImport(const Clip &clip)
     auto *storedClip = new Clip(this, clip);
     this->clips.addSorted(*storedClip, storedClip);
     this->usedClipIds.insert(storedClip->getId());
+    this->updateClipCounters(*storedClip, 1);
     this->updateBeatRange(false);
 }
 
@@ -173,6 +215,7 @@ bool Pattern::insert(const Clip &clipParams, bool undoable)
     {
         auto *ownedClip = new Clip(this, clipParams);
         this->clips.addSorted(*ownedClip, ownedClip);
+        this->updateClipCounters(*ownedClip, 1);
         this->notifyClipAdded(*ownedClip);
         this->updateBeatRange(true);
     }
@@ -196,6 +239,7 @@ bool Pattern::remove(const Clip &clipParams, bool undoable)
         {
             const auto *removedClip = this->clips.getUnchecked(index);
             jassert(removedClip->isValid());
+            this->updateClipCounters(*removedClip, -1);
             this->notifyClipRemoved(*removedClip);
             this->clips.remove(index, true);
             this->updateBeatRange(true);
@@ -223,7 +267,9 @@ bool Pattern::change(const Clip &oldParams, const Clip &newParams, bool undoable
         if (index >= 0)
         {
             auto *changedClip = this->clips.getUnchecked(index);
+            this->updateClipCounters(*changedClip, -1);
             changedClip->applyChanges(newParams);
+            this->updateClipCounters(*changedClip, 1);
             this->clips.remove(index, false);
             this->clips.addSorted(*changedClip, changedClip);
             this->notifyClipChanged(oldParams, *changedClip);
@@ -252,6 +298,7 @@ bool Pattern::insertGroup(Array<Clip> &group, bool undoable)
             const Clip &eventParams = group.getReference(i);
             auto *ownedClip = new Clip(this, eventParams);
             this->clips.addSorted(*ownedClip, ownedClip);
+            this->updateClipCounters(*ownedClip, 1);
             this->notifyClipAdded(*ownedClip);
         }
 
@@ -279,6 +326,7 @@ bool Pattern::removeGroup(Array<Clip> &group, bool undoable)
             if (index >= 0)
             {
                 auto *removedClip = this->clips.getUnchecked(index);
+                this->updateClipCounters(*removedClip, -1);
                 this->notifyClipRemoved(*removedClip);
                 this->clips.remove(index, true);
             }
@@ -312,7 +360,9 @@ bool Pattern::changeGroup(Array<Clip> &groupBefore, Array<Clip> &groupAfter, boo
             if (index >= 0)
             {
                 auto *changedClip = this->clips.getUnchecked(index);
+                this->updateClipCounters(*changedClip, -1);
                 changedClip->applyChanges(newParams);
+                this->updateClipCounters(*changedClip, 1);
                 this->clips.remove(index, false);
                 this->clips.addSorted(*changedClip, changedClip);
                 this->notifyClipChanged(oldParams, *changedClip);
@@ -428,6 +478,7 @@ void Pattern::deserialize(const SerializedData &data)
         clip->deserialize(e);
         this->clips.add(clip); // sorted later
         this->usedClipIds.insert(clip->getId());
+        this->updateClipCounters(*clip, 1);
     }
 
     // Fallback to single clip at zero bar, if no clips found
@@ -444,6 +495,8 @@ void Pattern::reset()
 {
     this->clips.clear(true);
     this->usedClipIds.clear();
+    this->numSoloClips = 0;
+    this->numMutedClips = 0;
 }
 
 Clip::Id Pattern::createUniqueClipId() const noexcept
@@ -85,6 +85,15 @@ public:
     { return this->clips; }
 
     bool hasSoloClips() const noexcept;
+    bool hasMutedClips() const noexcept;
+
+    // all clips of a pattern share the same sequence, so they all are
+    // of the same length, and the beat-sorted array is enough to make
+    // the spatial lookups logarithmic; beats here are clip offsets,
+    // i.e. without the sequence's first beat:
+    int indexOfFirstClipStartingFrom(float beat) const noexcept;
+    int indexOfFirstClipStartingAfter(float beat) const noexcept;
+    Clip *findClosestClip(float beat) const noexcept;
 
     //===------------------------------------------------------------------===//
     // Events change listener
@@ -125,6 +134,12 @@ protected:
     float lastEndBeat = 0.f;
     float lastStartBeat = 0.f;
 
+    // cached flags counters, updated on every clip
+    // insertion, removal and change (see updateClipCounters):
+    int numSoloClips = 0;
+    int numMutedClips = 0;
+    void updateClipCounters(const Clip &clip, int delta) noexcept;
+
     ProjectNode *getProject() const noexcept;
     UndoStack *getUndoStack() const noexcept;
 
@@ -0,0 +1,107 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// A free-list pool for the small model objects, which are created and
+// deleted by hundreds of thousands when loading or reloading a project:
+// they are allocated in slabs of many objects at once, and the deleted
+// ones are reused, so that the bulk load and unload don't have to hit
+// the heap for each single event; the memory is kept for the reuse and
+// never returned, since the deleted objects are likely to be recreated
+
+template <typename T, int slabSize = 1024>
+class PooledAllocator final
+{
+public:
+
+    static void *allocate(size_t size)
+    {
+        jassert(size == sizeof(T));
+        auto &pool = getInstance();
+
+        const SpinLock::ScopedLockType lock(pool.lock);
+
+        if (pool.freeList == nullptr)
+        {
+            pool.addSlab();
+        }
+
+        auto *slot = pool.freeList;
+        pool.freeList = slot->next;
+        return slot;
+    }
+
+    static void deallocate(void *ptr, size_t size) noexcept
+    {
+        jassert(size == sizeof(T));
+        if (ptr == nullptr)
+        {
+            return;
+        }
+
+        auto &pool = getInstance();
+
+        const SpinLock::ScopedLockType lock(pool.lock);
+
+        auto *slot = static_cast<Slot *>(ptr);
+        slot->next = pool.freeList;
+        pool.freeList = slot;
+    }
+
+private:
+
+    union Slot
+    {
+        Slot *next;
+        alignas(T) char storage[sizeof(T)];
+    };
+
+    void addSlab()
+    {
+        auto *slab = new Slot[slabSize];
+        for (int i = 0; i < slabSize - 1; ++i)
+        {
+            slab[i].next = &slab[i + 1];
+        }
+
+        slab[slabSize - 1].next = this->freeList;
+        this->freeList = slab;
+    }
+
+    // intentionally leaked, so that the objects deleted
+    // during the static destruction still have their pool
+    static PooledAllocator &getInstance()
+    {
+        static auto *instance = new PooledAllocator();
+        return *instance;
+    }
+
+    SpinLock lock;
+    Slot *freeList = nullptr;
+
+};
+
+// the placement forms are also needed, since the class-level
+// operator new hides the global ones, e.g. for Array<Note>
+#define POOLED_ALLOCATOR(ClassName) \
+    static void *operator new(size_t size) \
+    { return PooledAllocator<ClassName>::allocate(size); } \
+    static void operator delete(void *ptr, size_t size) noexcept \
+    { PooledAllocator<ClassName>::deallocate(ptr, size); } \
+    static void *operator new(size_t, void *ptr) noexcept { return ptr; } \
+    static void operator delete(void *, void *) noexcept {}
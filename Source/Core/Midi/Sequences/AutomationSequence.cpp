@@ -46,9 +46,9 @@ float AutomationSequence::getAverageControllerValue() const
 
 void AutomationSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
-    
+    Array<MidiEvent *> importedEvents;
+    importedEvents.ensureStorageAllocated(sequence.getNumEvents());
+
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
         const MidiMessage &message = sequence.getEventPointer(i)->message;
@@ -56,20 +56,48 @@ void AutomationSequence::importMidi(const MidiMessageSequence &sequence, short t
         if (message.isController())
         {
             const int controllerValue = message.getControllerValue();
-            const AutomationEvent event(this, startBeat, float(controllerValue) / 127.f);
-            this->importMidiEvent<AutomationEvent>(event);
+            importedEvents.add(new AutomationEvent(this, startBeat, float(controllerValue) / 127.f));
         }
         else if (message.isTempoMetaEvent())
         {
             const float controllerValue = Transport::getControllerValueByTempo(message.getTempoSecondsPerQuarterNote());
-            const AutomationEvent event(this, startBeat, controllerValue);
-            this->importMidiEvent<AutomationEvent>(event);
+            importedEvents.add(new AutomationEvent(this, startBeat, controllerValue));
         }
     }
-    
+
+    // the midi sequence is sorted already, so this is cheap
+    this->addSortedEvents(importedEvents);
     this->updateBeatRange(false);
 }
 
+// walks the neighbouring events directly, instead of
+// each event looking up its successor in the sequence;
+// the curves are emitted strictly before the next event,
+// so the messages come out sorted already
+void AutomationSequence::exportClipRelativeMessages(Array<MidiEvent::ExportedMessage> &outMessages,
+    bool exportMetronome, float projectFirstBeat, float projectLastBeat,
+    double timeFactor /*= 1.0*/) const
+{
+    if (this->midiEvents.isEmpty())
+    {
+        return;
+    }
+
+    const AutomationEvent::ExportParameters parameters(*this->getTrack());
+
+    outMessages.ensureStorageAllocated(outMessages.size() + this->midiEvents.size() * 2);
+
+    const auto numEvents = this->midiEvents.size();
+    for (int i = 0; i < numEvents; ++i)
+    {
+        const auto *event = static_cast<const AutomationEvent *>(this->midiEvents.getUnchecked(i));
+        const auto *nextEvent = (i < numEvents - 1) ?
+            static_cast<const AutomationEvent *>(this->midiEvents.getUnchecked(i + 1)) : nullptr;
+
+        event->exportMessages(outMessages, nextEvent, parameters, timeFactor);
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Undoable track editing
 //===----------------------------------------------------------------------===//
@@ -245,12 +273,10 @@ SerializedData AutomationSequence::serialize() const
 {
     SerializedData tree(Serialization::Midi::automation);
 
-    for (int i = 0; i < this->midiEvents.size(); ++i)
-    {
-        MidiEvent *event = this->midiEvents.getUnchecked(i);
-        tree.appendChild(event->serialize());
-    }
-    
+    Array<const MidiEvent *> events;
+    events.addArray(this->midiEvents);
+    AutomationEvent::packEvents(tree, events);
+
     return tree;
 }
 
@@ -265,20 +291,14 @@ void AutomationSequence::deserialize(const SerializedData &data)
     if (!root.isValid())
     { return; }
 
-    float firstBeat = 0;
-    float lastBeat = 0;
+    Array<AutomationEvent> events;
+    AutomationEvent::unpackEvents(root, events);
 
-    forEachChildWithType(root, e, Serialization::Midi::automationEvent)
+    this->midiEvents.ensureStorageAllocated(events.size());
+    for (const auto &parameters : events)
     {
-        auto *event = new AutomationEvent(this, 0, 0);
-        event->deserialize(e);
-        
-        this->midiEvents.add(event); // sorted later
-        
-        lastBeat = jmax(lastBeat, event->getBeat());
-        firstBeat = jmin(firstBeat, event->getBeat());
-
-        this->usedEventIds.insert(event->getId());
+        this->midiEvents.add(new AutomationEvent(this, parameters)); // sorted later
+        this->usedEventIds.insert(parameters.getId());
     }
 
     this->sort();
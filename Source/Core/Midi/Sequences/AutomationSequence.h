@@ -50,6 +50,9 @@ public:
     //===------------------------------------------------------------------===//
 
     void importMidi(const MidiMessageSequence &sequence, short timeFormat) override;
+    void exportClipRelativeMessages(Array<MidiEvent::ExportedMessage> &outMessages,
+        bool exportMetronome, float projectFirstBeat, float projectLastBeat,
+        double timeFactor = 1.0) const override;
 
     //===------------------------------------------------------------------===//
     // Serializable
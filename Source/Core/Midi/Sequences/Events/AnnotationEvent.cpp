@@ -44,12 +44,12 @@ AnnotationEvent::AnnotationEvent(WeakReference<MidiSequence> owner,
     colour(parametersToCopy.colour),
     length(parametersToCopy.length) {}
 
-void AnnotationEvent::exportMessages(MidiMessageSequence &outSequence,
-    const Clip &clip, const KeyboardMapping &keyMap, double timeFactor) const noexcept
+void AnnotationEvent::exportMessages(Array<ExportedMessage> &outMessages,
+    double timeFactor) const noexcept
 {
     MidiMessage event(MidiMessage::textMetaEvent(1, this->getDescription()));
-    event.setTimeStamp((this->beat + clip.getBeat()) * timeFactor);
-    outSequence.addEvent(event);
+    event.setTimeStamp(this->beat * timeFactor);
+    outMessages.add({ event });
 }
 
 AnnotationEvent AnnotationEvent::withDeltaBeat(float beatOffset) const noexcept
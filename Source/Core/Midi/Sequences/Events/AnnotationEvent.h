@@ -32,8 +32,8 @@ public:
         const String &description = "",
         const Colour &newColour = Colours::white) noexcept;
     
-    void exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
-        const KeyboardMapping &keyMap, double timeFactor) const noexcept override;
+    void exportMessages(Array<ExportedMessage> &outMessages,
+        double timeFactor) const noexcept override;
 
     AnnotationEvent withDeltaBeat(float beatOffset) const noexcept;
     AnnotationEvent withBeat(float newBeat) const noexcept;
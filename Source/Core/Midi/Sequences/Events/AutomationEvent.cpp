@@ -20,6 +20,7 @@
 #include "MidiSequence.h"
 #include "Transport.h"
 #include "SerializationKeys.h"
+#include "PackedData.h"
 #include "MidiTrack.h"
 
 AutomationEvent::AutomationEvent() noexcept :
@@ -57,65 +58,90 @@ float AutomationEvent::interpolateEvents(float cv1, float cv2, float factor, flo
     return cv1 + (easeIn + easeOut);
 }
 
-void AutomationEvent::exportMessages(MidiMessageSequence &outSequence,
-    const Clip &clip, const KeyboardMapping &keyMap, double timeFactor) const noexcept
+void AutomationEvent::exportMessages(Array<ExportedMessage> &outMessages,
+    double timeFactor) const noexcept
 {
-    MidiMessage cc;
-    const bool isTempoTrack = this->getSequence()->getTrack()->isTempoTrack();
+    // the sequence exports all events at once, see AutomationSequence,
+    // so this lookup is only here for exporting a single event
+    const auto indexOfThis = this->getSequence()->indexOfSorted(this);
+    const auto *nextEvent = (indexOfThis >= 0 && indexOfThis < (this->getSequence()->size() - 1)) ?
+        static_cast<AutomationEvent *>(this->getSequence()->getUnchecked(indexOfThis + 1)) : nullptr;
+
+    this->exportMessages(outMessages, nextEvent,
+        ExportParameters(*this->getSequence()->getTrack()), timeFactor);
+}
+
+AutomationEvent::ExportParameters::ExportParameters(const MidiTrack &track) noexcept :
+    isTempoTrack(track.isTempoTrack()),
+    isOnOffTrack(track.isOnOffAutomationTrack()),
+    channel(track.getTrackChannel()),
+    controllerNumber(track.getTrackControllerNumber()) {}
 
-    if (isTempoTrack)
+MidiMessage AutomationEvent::ExportParameters::createMessage(float controllerValue,
+    double timestamp) const noexcept
+{
+    MidiMessage message = this->isTempoTrack ?
+        MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(controllerValue)) :
+        MidiMessage::controllerEvent(this->channel, this->controllerNumber, int(controllerValue * 127));
+
+    message.setTimeStamp(timestamp);
+    return message;
+}
+
+void AutomationEvent::exportMessages(Array<ExportedMessage> &outMessages,
+    const AutomationEvent *nextEvent, const ExportParameters &parameters,
+    double timeFactor) const noexcept
+{
+    const double startTime = this->beat * timeFactor;
+    outMessages.add({ parameters.createMessage(this->controllerValue, startTime) });
+
+    // add interpolated events, if needed
+    if (parameters.isOnOffTrack || nextEvent == nullptr)
     {
-        cc = MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(this->controllerValue));
+        return;
     }
-    else
+
+    const auto hasChanged = [&parameters](float value, float lastValue)
+    {
+        return parameters.isTempoTrack ?
+            fabsf(value - lastValue) > AutomationEvent::curveInterpolationThreshold :
+            int(value * 127) != int(lastValue * 127);
+    };
+
+    // the interpolation is monotonic, so if the ends of the curve
+    // export the same value, nothing changes in between either
+    if (!hasChanged(nextEvent->controllerValue, this->controllerValue))
     {
-        cc = MidiMessage::controllerEvent(this->getTrackChannel(),
-            this->getTrackControllerNumber(), int(this->controllerValue * 127));
+        return;
     }
 
-    const double startTime = (this->beat + clip.getBeat()) * timeFactor;
-    cc.setTimeStamp(startTime);
-    outSequence.addEvent(cc);
+    float lastAppliedValue = this->controllerValue;
+    float lastAppliedBeat = this->beat;
+    const float beatRange = nextEvent->beat - this->beat;
 
-    // add interpolated events, if needed
-    const int indexOfThis = this->getSequence()->indexOfSorted(this);
-    const bool isPedalOrSwitchEvent = this->getSequence()->getTrack()->isOnOffAutomationTrack();
-    if (!isPedalOrSwitchEvent && indexOfThis >= 0 && indexOfThis < (this->getSequence()->size() - 1))
+    for (float interpolatedBeat = this->beat + AutomationEvent::curveEvaluationStepBeat;
+        interpolatedBeat < nextEvent->beat;
+        interpolatedBeat += AutomationEvent::curveEvaluationStepBeat)
     {
-        const auto *nextEvent = static_cast<AutomationEvent *>(this->getSequence()->getUnchecked(indexOfThis + 1));
-        float interpolatedBeat = this->beat + AutomationEvent::curveInterpolationStepBeat;
-        float lastAppliedValue = this->controllerValue;
-
-        while (interpolatedBeat < nextEvent->beat)
+        // when the curve is steep, the changes within the min interval
+        // are merged into one message with the latest value
+        if (interpolatedBeat - lastAppliedBeat < AutomationEvent::curveMinIntervalBeat)
         {
-            const float factor = (interpolatedBeat - this->beat) / (nextEvent->beat - this->beat);
+            continue;
+        }
 
-            const float interpolatedValue =
-                AutomationEvent::interpolateEvents(this->controllerValue,
-                    nextEvent->controllerValue, factor, this->curvature);
+        const float factor = (interpolatedBeat - this->beat) / beatRange;
 
-            const float controllerDelta = fabsf(interpolatedValue - lastAppliedValue);
-            if (controllerDelta > AutomationEvent::curveInterpolationThreshold)
-            {
-                const double interpolatedTs = (interpolatedBeat + clip.getBeat()) * timeFactor;
-                if (isTempoTrack)
-                {
-                    MidiMessage ci(MidiMessage::tempoMetaEvent(Transport::getTempoByControllerValue(interpolatedValue)));
-                    ci.setTimeStamp(interpolatedTs);
-                    outSequence.addEvent(ci);
-                }
-                else
-                {
-                    MidiMessage ci(MidiMessage::controllerEvent(this->getTrackChannel(),
-                        this->getTrackControllerNumber(), int(interpolatedValue * 127)));
-                    ci.setTimeStamp(interpolatedTs);
-                    outSequence.addEvent(ci);
-                }
-
-                lastAppliedValue = interpolatedValue;
-            }
+        const float interpolatedValue =
+            AutomationEvent::interpolateEvents(this->controllerValue,
+                nextEvent->controllerValue, factor, this->curvature);
 
-            interpolatedBeat += AutomationEvent::curveInterpolationStepBeat;
+        if (hasChanged(interpolatedValue, lastAppliedValue))
+        {
+            const double interpolatedTs = interpolatedBeat * timeFactor;
+            outMessages.add({ parameters.createMessage(interpolatedValue, interpolatedTs) });
+            lastAppliedValue = interpolatedValue;
+            lastAppliedBeat = interpolatedBeat;
         }
     }
 }
@@ -256,14 +282,126 @@ void AutomationEvent::deserialize(const SerializedData &data)
 {
     this->reset();
     using namespace Serialization;
-    this->controllerValue = float(data.getProperty(Midi::value));
-    this->curvature = float(data.getProperty(Midi::curve, Globals::Defaults::automationControllerCurve));
-    this->beat = float(data.getProperty(Midi::timestamp)) / Globals::ticksPerBeat;
-    this->id = unpackId(data.getProperty(Midi::id));
+
+    this->controllerValue = 0.f;
+    this->curvature = Globals::Defaults::automationControllerCurve;
+    this->beat = 0.f;
+    this->id = 0;
+
+    data.forEachProperty([this](const Identifier &name, const var &value)
+    {
+        if (name == Midi::value)
+        {
+            this->controllerValue = float(value);
+        }
+        else if (name == Midi::curve)
+        {
+            this->curvature = float(value);
+        }
+        else if (name == Midi::timestamp)
+        {
+            this->beat = float(value) / Globals::ticksPerBeat;
+        }
+        else if (name == Midi::id)
+        {
+            this->id = unpackId(value);
+        }
+    });
 }
 
 void AutomationEvent::reset() noexcept {}
 
+static constexpr auto packedAutomationEventsFormatVersion = 1;
+
+void AutomationEvent::packEvents(SerializedData &tree, const Array<const MidiEvent *> &events)
+{
+    MemoryOutputStream out(events.size() * 14 + 8);
+    PackedData::writeVarInt(out, packedAutomationEventsFormatVersion);
+    PackedData::writeVarInt(out, events.size());
+
+    const auto getEvent = [&events](int i)
+    {
+        const auto *event = events.getUnchecked(i);
+        jassert(event->isTypeOf(MidiEvent::Type::Auto));
+        return static_cast<const AutomationEvent *>(event);
+    };
+
+    for (int i = 0; i < events.size(); ++i)
+    {
+        out.writeInt(getEvent(i)->id);
+    }
+
+    int64 previousTicks = 0;
+    for (int i = 0; i < events.size(); ++i)
+    {
+        const auto ticks = int64(int(getEvent(i)->beat * Globals::ticksPerBeat));
+        PackedData::writeVarInt(out, ticks - previousTicks);
+        previousTicks = ticks;
+    }
+
+    for (int i = 0; i < events.size(); ++i)
+    {
+        out.writeFloat(getEvent(i)->controllerValue);
+    }
+
+    for (int i = 0; i < events.size(); ++i)
+    {
+        out.writeFloat(getEvent(i)->curvature);
+    }
+
+    tree.setProperty(Serialization::Midi::packedEvents, PackedData::toVar(out));
+}
+
+void AutomationEvent::unpackEvents(const SerializedData &tree, Array<AutomationEvent> &outEvents)
+{
+    using namespace Serialization;
+
+    MemoryBlock data;
+    if (PackedData::fromVar(tree.getProperty(Midi::packedEvents), data))
+    {
+        MemoryInputStream in(data, false);
+        const auto version = PackedData::readVarInt(in);
+        const auto numEvents = int(PackedData::readVarInt(in));
+
+        if (version == packedAutomationEventsFormatVersion &&
+            numEvents > 0 && size_t(numEvents) * 13 <= data.getSize())
+        {
+            const auto firstIndex = outEvents.size();
+            outEvents.insertMultiple(-1, {}, numEvents);
+            auto *events = outEvents.getRawDataPointer() + firstIndex;
+
+            for (int i = 0; i < numEvents; ++i)
+            {
+                events[i].id = in.readInt();
+            }
+
+            int64 ticks = 0;
+            for (int i = 0; i < numEvents; ++i)
+            {
+                ticks += PackedData::readVarInt(in);
+                events[i].beat = float(ticks) / Globals::ticksPerBeat;
+            }
+
+            for (int i = 0; i < numEvents; ++i)
+            {
+                events[i].controllerValue = in.readFloat();
+            }
+
+            for (int i = 0; i < numEvents; ++i)
+            {
+                events[i].curvature = in.readFloat();
+            }
+        }
+    }
+
+    AutomationEvent parameters;
+    forEachChildWithType(tree, e, Midi::automationEvent)
+    {
+        parameters.deserialize(e);
+        outEvents.add(parameters);
+    }
+}
+
 void AutomationEvent::applyChanges(const AutomationEvent &parameters) noexcept
 {
     jassert(this->id == parameters.id);
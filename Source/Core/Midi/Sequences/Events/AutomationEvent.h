@@ -18,6 +18,9 @@
 #pragma once
 
 #include "MidiEvent.h"
+#include "PooledAllocator.h"
+
+class MidiTrack;
 
 class AutomationEvent final : public MidiEvent
 {
@@ -38,14 +41,39 @@ public:
         float beatVal = 0.f,
         float controllerValue = 0.f) noexcept;
 
-    void exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
-        const KeyboardMapping &keyMap, double timeFactor) const noexcept override;
+    void exportMessages(Array<ExportedMessage> &outMessages,
+        double timeFactor) const noexcept override;
+
+    // the track properties are the same for all events in the sequence,
+    // so the sequence export only looks them up once
+    struct ExportParameters final
+    {
+        explicit ExportParameters(const MidiTrack &track) noexcept;
+        MidiMessage createMessage(float controllerValue, double timestamp) const noexcept;
+
+        const bool isTempoTrack;
+        const bool isOnOffTrack;
+        const int channel;
+        const int controllerNumber;
+    };
+
+    // exports this event and the interpolated curve up to the next event,
+    // which the sequence export knows without searching for it
+    void exportMessages(Array<ExportedMessage> &outMessages,
+        const AutomationEvent *nextEvent, const ExportParameters &parameters,
+        double timeFactor) const noexcept;
 
     static float interpolateEvents(float cv1, float cv2, float factor, float easing);
 
     static constexpr auto curveInterpolationStepBeat = 0.25f;
     static constexpr auto curveInterpolationThreshold = 0.0025f;
 
+    // the exported curves are evaluated at a fine step, but only the changes
+    // of the 7-bit controller value are emitted (or the changes above the
+    // threshold for tempo), and not more often than the min interval
+    static constexpr auto curveEvaluationStepBeat = 1.f / 64.f;
+    static constexpr auto curveMinIntervalBeat = 1.f / 32.f;
+
     AutomationEvent withBeat(float newBeat) const noexcept;
     AutomationEvent withDeltaBeat(float deltaBeat) const noexcept;
     AutomationEvent withControllerValue(float cv) const noexcept;
@@ -84,6 +112,11 @@ public:
     void deserialize(const SerializedData &data) override;
     void reset() noexcept override;
 
+    // all events at once, packed into a single binary property,
+    // see Note::packNotes and Note::unpackNotes
+    static void packEvents(SerializedData &tree, const Array<const MidiEvent *> &events);
+    static void unpackEvents(const SerializedData &tree, Array<AutomationEvent> &outEvents);
+
     //===------------------------------------------------------------------===//
     // Helpers
     //===------------------------------------------------------------------===//
@@ -113,4 +146,9 @@ protected:
 private:
 
     JUCE_LEAK_DETECTOR(AutomationEvent);
+
+public:
+
+    // see PooledAllocator.h
+    POOLED_ALLOCATOR(AutomationEvent)
 };
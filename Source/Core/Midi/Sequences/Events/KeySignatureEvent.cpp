@@ -49,8 +49,8 @@ String KeySignatureEvent::toString(const StringArray &keyNames) const
     return keyNames[index] + ", " + this->scale->getLocalizedName();
 }
 
-void KeySignatureEvent::exportMessages(MidiMessageSequence &outSequence,
-    const Clip &clip, const KeyboardMapping &keyMap, double timeFactor) const noexcept
+void KeySignatureEvent::exportMessages(Array<ExportedMessage> &outMessages,
+    double timeFactor) const noexcept
 {
     // Basically, we can have any non-standard scale here:
     // from "symmetrical nonatonic" or "chromatic permutated diatonic dorian"
@@ -72,8 +72,8 @@ void KeySignatureEvent::exportMessages(MidiMessageSequence &outSequence,
     const int flatsOrSharps = isMinor ? minorCircle[root] : majorCircle[root];
 
     MidiMessage event(MidiMessage::keySignatureMetaEvent(flatsOrSharps, isMinor));
-    event.setTimeStamp((this->beat + clip.getBeat()) * timeFactor);
-    outSequence.addEvent(event);
+    event.setTimeStamp(this->beat * timeFactor);
+    outMessages.add({ event });
 }
 
 KeySignatureEvent KeySignatureEvent::withDeltaBeat(float beatOffset) const noexcept
@@ -37,8 +37,8 @@ public:
 
     String toString(const StringArray &keyNames) const;
 
-    void exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
-        const KeyboardMapping &keyMap, double timeFactor) const noexcept override;
+    void exportMessages(Array<ExportedMessage> &outMessages,
+        double timeFactor) const noexcept override;
     
     KeySignatureEvent withDeltaBeat(float beatOffset) const noexcept;
     KeySignatureEvent withBeat(float newBeat) const noexcept;
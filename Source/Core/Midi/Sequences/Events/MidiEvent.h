@@ -53,8 +53,21 @@ public:
     // with custom parameters (assumes the id is already valid and unique)
     MidiEvent(WeakReference<MidiSequence> owner, const MidiEvent &parameters) noexcept;
 
-    virtual void exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
-        const KeyboardMapping &keyMap, double timeFactor) const noexcept = 0;
+    // The messages are exported relative to the clip, which then only
+    // applies its offsets to them, see MidiSequence::exportClip;
+    // the note messages are placeholders, the actual key and velocity
+    // are only known after the clip's key offset and keyboard mapping,
+    // unless the message is marked as final (e.g. the metronome notes):
+    struct ExportedMessage final
+    {
+        MidiMessage message;
+        int key = 0;
+        float velocity = 0.f;
+        bool isFinal = false;
+    };
+
+    virtual void exportMessages(Array<ExportedMessage> &outMessages,
+        double timeFactor) const noexcept = 0;
 
     //===------------------------------------------------------------------===//
     // Accessors
@@ -19,6 +19,7 @@
 #include "Note.h"
 #include "MidiSequence.h"
 #include "SerializationKeys.h"
+#include "PackedData.h"
 #include "KeyboardMapping.h"
 
 Note::Note() noexcept : MidiEvent(nullptr, Type::Note, 0.f) {}
@@ -38,28 +39,48 @@ Note::Note(WeakReference<MidiSequence> owner, const Note &parametersToCopy) noex
     velocity(parametersToCopy.velocity),
     tuplet(parametersToCopy.tuplet) {}
 
-void Note::exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
-    const KeyboardMapping &keyMap, double timeFactor) const noexcept
+Note::Note(const Compact &parameters) noexcept :
+    MidiEvent(nullptr, Type::Note, parameters.beat),
+    key(parameters.key),
+    length(parameters.length),
+    velocity(parameters.velocity),
+    tuplet(parameters.tuplet)
 {
-    const auto keyWithOffset = this->key + clip.getKey();
-    const auto finalVolume = this->velocity * clip.getVelocity();
-    const auto tupletLength = this->length / float(this->tuplet);
-    const auto mapped = keyMap.map(keyWithOffset);
+    this->id = parameters.id;
+}
+
+Note::Compact Note::getCompact() const noexcept
+{
+    return { this->id, this->beat, this->length, this->velocity, this->key, this->tuplet };
+}
+
+void Note::exportMessages(Array<ExportedMessage> &outMessages,
+    double timeFactor) const noexcept
+{
+    Note::exportMessages(outMessages, this->key, this->beat,
+        this->length, this->velocity, this->tuplet, timeFactor);
+}
 
-    for (int i = 0; i < this->tuplet; ++i)
+void Note::exportMessages(Array<ExportedMessage> &outMessages,
+    Key key, float beat, float length, float velocity,
+    Tuplet tuplet, double timeFactor) noexcept
+{
+    const auto tupletLength = length / float(tuplet);
+
+    for (int i = 0; i < tuplet; ++i)
     {
-        const float tupletStart = this->beat + tupletLength * float(i);
+        const float tupletStart = beat + tupletLength * float(i);
 
         // slightly adjust volume for tuplet sequence: factor fading from 1 to 0.9;
         // this should sound anyway better than the same volume for all tuplets,
         // but, in future user should have some kind of control over it
         // (like implement auto curves for individual notes?)
-        const float tupletVolume = finalVolume * (1.f - float(i) / 100.f);
+        const float tupletVolume = velocity * (1.f - float(i) / 100.f);
 
-        MidiMessage eventNoteOn(MidiMessage::noteOn(mapped.channel, mapped.key, tupletVolume));
-        const double startTime = (tupletStart + clip.getBeat()) * timeFactor;
+        MidiMessage eventNoteOn(MidiMessage::noteOn(1, 0, tupletVolume));
+        const double startTime = tupletStart * timeFactor;
         eventNoteOn.setTimeStamp(startTime);
-        outSequence.addEvent(eventNoteOn);
+        outMessages.add({ eventNoteOn, key, tupletVolume });
 
         // we want to subtract some little time offset from the the note-off
         // timestamps to make sure end/start times of neighbor notes never overlap:
@@ -73,10 +94,10 @@ void Note::exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
         // be aligned accurately, so someday we might come up with a better fix:
         constexpr auto noteOffOffset = 1.0 / 1000.0;
 
-        MidiMessage eventNoteOff(MidiMessage::noteOff(mapped.channel, mapped.key));
-        const double endTime = (tupletStart + tupletLength + clip.getBeat()) * timeFactor - noteOffOffset;
+        MidiMessage eventNoteOff(MidiMessage::noteOff(1, 0));
+        const double endTime = (tupletStart + tupletLength) * timeFactor - noteOffOffset;
         eventNoteOff.setTimeStamp(endTime);
-        outSequence.addEvent(eventNoteOff);
+        outMessages.add({ eventNoteOff, key, 0.f });
     }
 }
 
@@ -227,17 +248,177 @@ void Note::deserialize(const SerializedData &data)
 {
     this->reset();
     using namespace Serialization;
-    this->id = unpackId(data.getProperty(Midi::id));
-    this->key = data.getProperty(Midi::key);
-    this->beat = float(data.getProperty(Midi::timestamp)) / Globals::ticksPerBeat;
-    this->length = float(data.getProperty(Midi::length)) / Globals::ticksPerBeat;
-    const auto vol = float(data.getProperty(Midi::volume)) / Globals::velocitySaveResolution;
-    this->velocity = jmax(jmin(vol, 1.f), 0.f);
-    this->tuplet = Tuplet(int(data.getProperty(Midi::tuplet, 1)));
+
+    this->id = 0;
+    this->key = 0;
+    this->beat = 0.f;
+    this->length = 0.f;
+    this->velocity = 0.f;
+    this->tuplet = 1;
+
+    data.forEachProperty([this](const Identifier &name, const var &value)
+    {
+        if (name == Midi::id)
+        {
+            this->id = unpackId(value);
+        }
+        else if (name == Midi::key)
+        {
+            this->key = value;
+        }
+        else if (name == Midi::timestamp)
+        {
+            this->beat = float(value) / Globals::ticksPerBeat;
+        }
+        else if (name == Midi::length)
+        {
+            this->length = float(value) / Globals::ticksPerBeat;
+        }
+        else if (name == Midi::volume)
+        {
+            const auto vol = float(value) / Globals::velocitySaveResolution;
+            this->velocity = jmax(jmin(vol, 1.f), 0.f);
+        }
+        else if (name == Midi::tuplet)
+        {
+            this->tuplet = Tuplet(int(value));
+        }
+    });
 }
 
 void Note::reset() noexcept {}
 
+static constexpr auto packedNotesFormatVersion = 1;
+
+template <typename GetNote>
+static void writePackedNotes(SerializedData &tree, int numNotes, GetNote getNote)
+{
+    MemoryOutputStream out(numNotes * 10 + 8);
+    PackedData::writeVarInt(out, packedNotesFormatVersion);
+    PackedData::writeVarInt(out, numNotes);
+
+    // ids are random, so there's no point in encoding them
+    for (int i = 0; i < numNotes; ++i)
+    {
+        out.writeInt(getNote(i).getId());
+    }
+
+    // the notes are usually sorted, so the beat and key deltas are small
+    int64 previousTicks = 0;
+    for (int i = 0; i < numNotes; ++i)
+    {
+        const auto ticks = int64(int(getNote(i).getBeat() * Globals::ticksPerBeat));
+        PackedData::writeVarInt(out, ticks - previousTicks);
+        previousTicks = ticks;
+    }
+
+    Key previousKey = 0;
+    for (int i = 0; i < numNotes; ++i)
+    {
+        PackedData::writeVarInt(out, getNote(i).getKey() - previousKey);
+        previousKey = getNote(i).getKey();
+    }
+
+    for (int i = 0; i < numNotes; ++i)
+    {
+        PackedData::writeVarInt(out, int(getNote(i).getLength() * Globals::ticksPerBeat));
+    }
+
+    for (int i = 0; i < numNotes; ++i)
+    {
+        PackedData::writeVarInt(out, int(getNote(i).getVelocity() * Globals::velocitySaveResolution));
+    }
+
+    for (int i = 0; i < numNotes; ++i)
+    {
+        out.writeByte(getNote(i).getTuplet());
+    }
+
+    tree.setProperty(Serialization::Midi::packedEvents, PackedData::toVar(out));
+}
+
+void Note::packNotes(SerializedData &tree, const Array<const MidiEvent *> &notes)
+{
+    writePackedNotes(tree, notes.size(), [&notes](int i) -> const Note &
+    {
+        const auto *event = notes.getUnchecked(i);
+        jassert(event->isTypeOf(MidiEvent::Type::Note));
+        return *static_cast<const Note *>(event);
+    });
+}
+
+void Note::packNotes(SerializedData &tree, const Array<Note> &notes)
+{
+    writePackedNotes(tree, notes.size(), [&notes](int i) -> const Note &
+    {
+        return notes.getReference(i);
+    });
+}
+
+void Note::unpackNotes(const SerializedData &tree, Array<Note> &outNotes)
+{
+    using namespace Serialization;
+
+    MemoryBlock data;
+    if (PackedData::fromVar(tree.getProperty(Midi::packedEvents), data))
+    {
+        MemoryInputStream in(data, false);
+        const auto version = PackedData::readVarInt(in);
+        const auto numNotes = int(PackedData::readVarInt(in));
+
+        // each note takes at least 8 bytes, so anything else is garbage
+        if (version == packedNotesFormatVersion &&
+            numNotes > 0 && size_t(numNotes) * 8 <= data.getSize())
+        {
+            const auto firstIndex = outNotes.size();
+            outNotes.insertMultiple(-1, {}, numNotes);
+            auto *notes = outNotes.getRawDataPointer() + firstIndex;
+
+            for (int i = 0; i < numNotes; ++i)
+            {
+                notes[i].id = in.readInt();
+            }
+
+            int64 ticks = 0;
+            for (int i = 0; i < numNotes; ++i)
+            {
+                ticks += PackedData::readVarInt(in);
+                notes[i].beat = float(ticks) / Globals::ticksPerBeat;
+            }
+
+            Key key = 0;
+            for (int i = 0; i < numNotes; ++i)
+            {
+                key += Key(PackedData::readVarInt(in));
+                notes[i].key = key;
+            }
+
+            for (int i = 0; i < numNotes; ++i)
+            {
+                notes[i].length = float(PackedData::readVarInt(in)) / Globals::ticksPerBeat;
+            }
+
+            for (int i = 0; i < numNotes; ++i)
+            {
+                const auto vol = float(PackedData::readVarInt(in)) / Globals::velocitySaveResolution;
+                notes[i].velocity = jmax(jmin(vol, 1.f), 0.f);
+            }
+
+            for (int i = 0; i < numNotes; ++i)
+            {
+                notes[i].tuplet = Tuplet(jmax(1, int(in.readByte())));
+            }
+        }
+    }
+
+    Note parameters;
+    forEachChildWithType(tree, e, Midi::note)
+    {
+        parameters.deserialize(e);
+        outNotes.add(parameters);
+    }
+}
+
 void Note::applyChanges(const Note &other) noexcept
 {
     jassert(this->id == other.id);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "MidiEvent.h"
+#include "PooledAllocator.h"
 
 class Note final : public MidiEvent
 {
@@ -35,12 +36,34 @@ public:
     Note &operator= (Note &&other) = default;
 
     Note(WeakReference<MidiSequence> owner, const Note &parametersToCopy) noexcept;
+
+    // just the parameters, without the owner reference and the vtable,
+    // for where lots of notes are kept for a long time, e.g. undo actions
+    struct Compact final
+    {
+        Id id;
+        float beat;
+        float length;
+        float velocity;
+        Key key;
+        Tuplet tuplet;
+    };
+
+    explicit Note(const Compact &parameters) noexcept;
+    Compact getCompact() const noexcept;
+
     explicit Note(WeakReference<MidiSequence> owner,
         Key keyVal = 0, float beatVal = 0.f,
         float lengthVal = 1.f, float velocityVal = 1.f) noexcept;
 
-    void exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
-        const KeyboardMapping &keyMap, double timeFactor) const noexcept override;
+    void exportMessages(Array<ExportedMessage> &outMessages,
+        double timeFactor) const noexcept override;
+
+    // the same, but for the note parameters stored elsewhere,
+    // see PianoSequence::PackedNotes
+    static void exportMessages(Array<ExportedMessage> &outMessages,
+        Key key, float beat, float length, float velocity,
+        Tuplet tuplet, double timeFactor) noexcept;
     
     // use these methods to perform undo/redo actions
     Note withKey(Key newKey) const noexcept;
@@ -76,6 +99,13 @@ public:
     void deserialize(const SerializedData &data) override;
     void reset() noexcept override;
 
+    // all notes at once, packed column by column into a single binary property,
+    // which is way more compact and faster to read than a tree per each note;
+    // unpacking also supports the legacy format with a child tree per note
+    static void packNotes(SerializedData &tree, const Array<const MidiEvent *> &notes);
+    static void packNotes(SerializedData &tree, const Array<Note> &notes);
+    static void unpackNotes(const SerializedData &tree, Array<Note> &outNotes);
+
     //===------------------------------------------------------------------===//
     // Helpers
     //===------------------------------------------------------------------===//
@@ -104,4 +134,9 @@ protected:
 private:
 
     JUCE_LEAK_DETECTOR(Note);
+
+public:
+
+    // see PooledAllocator.h
+    POOLED_ALLOCATOR(Note)
 };
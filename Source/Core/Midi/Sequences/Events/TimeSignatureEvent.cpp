@@ -43,12 +43,12 @@ TimeSignatureEvent::TimeSignatureEvent(WeakReference<MidiSequence> owner,
     track(parametersToCopy.track),
     meter(parametersToCopy.meter) {}
 
-void TimeSignatureEvent::exportMessages(MidiMessageSequence &outSequence,
-    const Clip &clip, const KeyboardMapping &keyMap, double timeFactor) const noexcept
+void TimeSignatureEvent::exportMessages(Array<ExportedMessage> &outMessages,
+    double timeFactor) const noexcept
 {
     MidiMessage event(MidiMessage::timeSignatureMetaEvent(this->meter.getNumerator(), this->meter.getDenominator()));
-    event.setTimeStamp((this->beat + clip.getBeat()) * timeFactor);
-    outSequence.addEvent(event);
+    event.setTimeStamp(this->beat * timeFactor);
+    outMessages.add({ event });
 }
 
 TimeSignatureEvent TimeSignatureEvent::withDeltaBeat(float beatOffset) const noexcept
@@ -49,8 +49,8 @@ public:
         int newNumerator = Globals::Defaults::timeSignatureNumerator,
         int newDenominator = Globals::Defaults::timeSignatureDenominator) noexcept;
     
-    void exportMessages(MidiMessageSequence &outSequence, const Clip &clip,
-        const KeyboardMapping &keyMap, double timeFactor) const noexcept override;
+    void exportMessages(Array<ExportedMessage> &outMessages,
+        double timeFactor) const noexcept override;
 
     TimeSignatureEvent withDeltaBeat(float beatOffset) const noexcept;
     TimeSignatureEvent withBeat(float newBeat) const noexcept;
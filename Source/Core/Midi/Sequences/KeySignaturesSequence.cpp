@@ -32,9 +32,6 @@ KeySignaturesSequence::KeySignaturesSequence(MidiTrack &track,
 
 void KeySignaturesSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
-
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
         const MidiMessage &message = sequence.getEventPointer(i)->message;
@@ -149,6 +146,23 @@ bool KeySignaturesSequence::change(const KeySignatureEvent &oldParams,
     return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Lookup
+//===----------------------------------------------------------------------===//
+
+int KeySignaturesSequence::indexOfKeySignatureAt(float beat) const noexcept
+{
+    if (this->midiEvents.isEmpty())
+    {
+        return -1;
+    }
+
+    const auto firstAfter = int(std::upper_bound(this->midiEvents.begin(), this->midiEvents.end(), beat,
+        [](float beat, const MidiEvent *event) { return beat < event->getBeat(); }) - this->midiEvents.begin());
+
+    return jmax(0, firstAfter - 1);
+}
+
 //===----------------------------------------------------------------------===//
 // Serializable
 //===----------------------------------------------------------------------===//
@@ -43,6 +43,15 @@ public:
         const KeySignatureEvent &newSignature,
         bool undoable);
 
+    //===------------------------------------------------------------------===//
+    // Lookup
+    //===------------------------------------------------------------------===//
+
+    // the index of the key signature in effect at the given beat,
+    // i.e. the last one starting at or before it, or the first one,
+    // if the beat is before all of them, or -1 if the sequence is empty
+    int indexOfKeySignatureAt(float beat) const noexcept;
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -21,20 +21,40 @@
 #include "ProjectMetadata.h"
 #include "UndoStack.h"
 #include "MidiTrack.h"
+#include "KeyboardMapping.h"
 
+// The ids are up to 4 alphanumeric characters packed into an int,
+// so that they can be serialized as strings; the combinations are indexed
+// starting from the 2-character ones, so that picking a random index below
+// some limit picks a random id of up to some length with one random number
 struct EventIdGenerator final
 {
-    static MidiEvent::Id generateId(int length = 2)
+    static constexpr int numIdChars = 62;
+    static constexpr int minIdLength = 2;
+    static constexpr int maxIdLength = 4;
+    static constexpr int numShortIds = numIdChars * numIdChars;
+    static constexpr int numIds = numShortIds * (1 + numIdChars * (1 + numIdChars));
+
+    static MidiEvent::Id getIdAt(int index)
     {
-        jassert(length <= 4);
-        MidiEvent::Id id = 0;
-        static Random r;
-        r.setSeedRandomly();
         static const char idChars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+        int length = minIdLength;
+        int numIdsOfLength = numIdChars * numIdChars;
+        while (index >= numIdsOfLength && length < maxIdLength)
+        {
+            index -= numIdsOfLength;
+            numIdsOfLength *= numIdChars;
+            length++;
+        }
+
+        MidiEvent::Id id = 0;
         for (int i = 0; i < length; ++i)
         {
-            id |= idChars[r.nextInt(62)] << (i * CHAR_BIT);
+            id |= idChars[index % numIdChars] << (i * CHAR_BIT);
+            index /= numIdChars;
         }
+
         return id;
     }
 };
@@ -52,6 +72,68 @@ void MidiSequence::sort()
     }
 }
 
+// takes ownership of the events
+void MidiSequence::addSortedEvents(const Array<MidiEvent *> &events)
+{
+    if (events.isEmpty())
+    {
+        return;
+    }
+
+    const auto numOldEvents = this->midiEvents.size();
+    this->midiEvents.ensureStorageAllocated(numOldEvents + events.size());
+    for (auto *event : events)
+    {
+        this->midiEvents.add(event);
+    }
+
+    const auto isLess = [](const MidiEvent *a, const MidiEvent *b)
+    {
+        return MidiEvent::compareElements(a, b) < 0;
+    };
+
+    auto *newEvents = this->midiEvents.begin() + numOldEvents;
+    std::sort(newEvents, this->midiEvents.end(), isLess);
+    std::inplace_merge(this->midiEvents.begin(), newEvents, this->midiEvents.end(), isLess);
+}
+
+void MidiSequence::removeEventsAt(Array<int> &indices, bool deleteEvents)
+{
+    if (indices.isEmpty())
+    {
+        return;
+    }
+
+    indices.sort();
+
+    auto **events = this->midiEvents.begin();
+    const auto numEvents = this->midiEvents.size();
+
+    int numKeptEvents = 0;
+    for (int i = 0, nextIndex = 0; i < numEvents; ++i)
+    {
+        if (nextIndex < indices.size() && indices.getUnchecked(nextIndex) == i)
+        {
+            if (deleteEvents)
+            {
+                delete events[i];
+            }
+
+            // duplicate indices are not expected, but won't hurt
+            while (nextIndex < indices.size() && indices.getUnchecked(nextIndex) == i)
+            {
+                ++nextIndex;
+            }
+
+            continue;
+        }
+
+        events[numKeptEvents++] = events[i];
+    }
+
+    this->midiEvents.removeLast(numEvents - numKeptEvents, false);
+}
+
 //===----------------------------------------------------------------------===//
 // Undoing
 //===----------------------------------------------------------------------===//
@@ -96,27 +178,166 @@ void MidiSequence::exportMidi(MidiMessageSequence &outSequence,
     float projectFirstBeat, float projectLastBeat,
     double timeFactor /*= 1.0*/) const
 {
-    if (this->midiEvents.isEmpty() || clip.isMuted())
+    Array<MidiEvent::ExportedMessage> messages;
+    this->exportClipRelativeMessages(messages, exportMetronome,
+        projectFirstBeat, projectLastBeat, timeFactor);
+
+    this->exportClip(outSequence, messages, clip,
+        keyMap, soloPlaybackMode, timeFactor);
+}
+
+void MidiSequence::exportClipRelativeMessages(Array<MidiEvent::ExportedMessage> &outMessages,
+    bool exportMetronome, float projectFirstBeat, float projectLastBeat,
+    double timeFactor /*= 1.0*/) const
+{
+    outMessages.ensureStorageAllocated(outMessages.size() + this->midiEvents.size() * 2);
+
+    for (const auto *event : this->midiEvents)
     {
-        return;
+        event->exportMessages(outMessages, timeFactor);
     }
 
+    MidiSequence::sortExportedMessages(outMessages);
+}
+
+// the clip offsets don't change the order of messages,
+// so it's enough to sort them once here, see addExportedMessages
+void MidiSequence::sortExportedMessages(Array<MidiEvent::ExportedMessage> &messages)
+{
+    std::stable_sort(messages.begin(), messages.end(),
+        [](const MidiEvent::ExportedMessage &a, const MidiEvent::ExportedMessage &b)
+        {
+            return a.message.getTimeStamp() < b.message.getTimeStamp();
+        });
+}
+
+void MidiSequence::exportClip(MidiMessageSequence &outSequence,
+    const Array<MidiEvent::ExportedMessage> &clipRelativeMessages,
+    const Clip &clip, const KeyboardMapping &keyMap,
+    bool soloPlaybackMode, double timeFactor /*= 1.0*/) const
+{
     // this will ignore soloPlaybackMode flag,
     // (which means there's at least one solo clip somewhere),
     // since not all sequence types are supposed to be soloed,
     // for example, automations should be exported all the time unless muted;
-
     // for now, PianoSequence overrides this method
-    // to make sure it skips all no-solo clips, when soloPlaybackMode is true,
-    // and TimeSignatureSequence overrides this method
-    // to emit the "virtual" metronome track, if needed
+    // to make sure it skips all no-solo clips, when soloPlaybackMode is true
 
-    for (const auto *event : this->midiEvents)
+    if (clipRelativeMessages.isEmpty() || clip.isMuted())
     {
-        event->exportMessages(outSequence, clip, keyMap, timeFactor);
+        return;
     }
 
-    outSequence.updateMatchedPairs();
+    const auto clipOffset = double(clip.getBeat()) * timeFactor;
+    const auto clipKey = clip.getKey();
+    const auto clipVelocity = clip.getVelocity();
+
+    // the default mapping doesn't need the table lookups
+    const auto hasDefaultKeyMap = keyMap.isDefault();
+    const auto mapKey = [&keyMap, hasDefaultKeyMap](Note::Key key)
+    {
+        return hasDefaultKeyMap ? KeyboardMapping::getDefaultMappingFor(key) : keyMap.map(key);
+    };
+
+    Array<MidiMessage> messages;
+    messages.ensureStorageAllocated(clipRelativeMessages.size());
+
+    for (const auto &exported : clipRelativeMessages)
+    {
+        const auto timestamp = exported.message.getTimeStamp() + clipOffset;
+
+        if (exported.isFinal)
+        {
+            messages.add(exported.message.withTimeStamp(timestamp));
+        }
+        // velocity 0 placeholders are still note-ons, as they were exported
+        else if (exported.message.isNoteOn(true))
+        {
+            const auto mapped = mapKey(exported.key + clipKey);
+            messages.add(MidiMessage::noteOn(mapped.channel, mapped.key,
+                exported.velocity * clipVelocity).withTimeStamp(timestamp));
+        }
+        else if (exported.message.isNoteOff())
+        {
+            const auto mapped = mapKey(exported.key + clipKey);
+            messages.add(MidiMessage::noteOff(mapped.channel,
+                mapped.key).withTimeStamp(timestamp));
+        }
+        else
+        {
+            messages.add(exported.message.withTimeStamp(timestamp));
+        }
+    }
+
+    MidiSequence::addExportedMessages(outSequence, messages);
+}
+
+void MidiSequence::addExportedMessages(MidiMessageSequence &outSequence,
+    Array<MidiMessage> &messages)
+{
+    if (messages.isEmpty())
+    {
+        return;
+    }
+
+    // the events are sorted by beat, but the note-offs, the tuplets and
+    // the interpolated automation events are not; the stable sort keeps
+    // the order of the messages at the same timestamp as they were added,
+    // which is the same as MidiMessageSequence::addEvent would do
+    const auto compareTimestamps = [](const MidiMessage &a, const MidiMessage &b)
+    {
+        return a.getTimeStamp() < b.getTimeStamp();
+    };
+
+    // the clip-relative messages are sorted already
+    if (!std::is_sorted(messages.begin(), messages.end(), compareTimestamps))
+    {
+        std::stable_sort(messages.begin(), messages.end(), compareTimestamps);
+    }
+
+    // for each channel and key, the note-on still waiting for its note-off;
+    // just like updateMatchedPairs, if the next note-on of the same key
+    // comes first, a note-off is inserted right before it
+    static constexpr auto numKeys = 16 * 128;
+    MidiMessageSequence::MidiEventHolder *pendingNoteOns[numKeys] = {};
+
+    for (const auto &message : messages)
+    {
+        const bool isNoteOn = message.isNoteOn();
+        const bool isNoteOff = !isNoteOn && message.isNoteOff();
+
+        if (!isNoteOn && !isNoteOff)
+        {
+            outSequence.addEvent(message);
+            continue;
+        }
+
+        const auto keyIndex = (message.getChannel() - 1) * 128 + message.getNoteNumber();
+        jassert(keyIndex >= 0 && keyIndex < numKeys);
+        auto *&pendingNoteOn = pendingNoteOns[keyIndex];
+
+        if (isNoteOn)
+        {
+            if (pendingNoteOn != nullptr)
+            {
+                auto noteOff = MidiMessage::noteOff(message.getChannel(), message.getNoteNumber());
+                noteOff.setTimeStamp(message.getTimeStamp());
+                pendingNoteOn->noteOffObject = outSequence.addEvent(noteOff);
+            }
+
+            pendingNoteOn = outSequence.addEvent(message);
+            pendingNoteOn->noteOffObject = nullptr;
+        }
+        else
+        {
+            auto *noteOffHolder = outSequence.addEvent(message);
+            if (pendingNoteOn != nullptr)
+            {
+                pendingNoteOn->noteOffObject = noteOffHolder;
+                pendingNoteOn = nullptr;
+            }
+        }
+    }
 }
 
 float MidiSequence::midiTicksToBeats(double ticks, int timeFormat) noexcept
@@ -135,6 +356,14 @@ float MidiSequence::midiTicksToBeats(double ticks, int timeFormat) noexcept
     return float(timeInSeconds * secsPerQuarterNoteAt120BPM * Globals::beatsPerBar);
 }
 
+void MidiSequence::swapEventsWith(OwnedArray<MidiEvent> &events,
+    FlatHashSet<MidiEvent::Id> &eventIds)
+{
+    this->midiEvents.swapWith(events);
+    this->usedEventIds.swap(eventIds);
+    this->updateBeatRange(false);
+}
+
 //===----------------------------------------------------------------------===//
 // Accessors
 //===----------------------------------------------------------------------===//
@@ -205,14 +434,23 @@ void MidiSequence::updateBeatRange(bool shouldNotifyIfChanged)
 
 MidiEvent::Id MidiSequence::createUniqueEventId() const noexcept
 {
-    int length = 2;
-    auto eventId = EventIdGenerator::generateId(length);
-    while (this->usedEventIds.contains(eventId))
+    // the ids are random, so that the events created on other devices
+    // or in other branches are unlikely to collide when merged, and the ids
+    // of the removed events, which the undo history may still bring back,
+    // are unlikely to be reused, even after the project is reloaded;
+    // each collision extends the range to the longer ids, so that
+    // the retries stay cheap when the short ids are running out
+    auto numIdsToPickFrom = EventIdGenerator::numShortIds;
+    MidiEvent::Id eventId = 0;
+    do
     {
-        length = jmin(4, length + 1);
-        eventId = EventIdGenerator::generateId(length);
+        jassert(this->usedEventIds.size() < EventIdGenerator::numIds);
+        eventId = EventIdGenerator::getIdAt(this->idRandom.nextInt(numIdsToPickFrom));
+        numIdsToPickFrom = jmin(EventIdGenerator::numIds,
+            numIdsToPickFrom * EventIdGenerator::numIdChars);
     }
-    
+    while (this->usedEventIds.contains(eventId));
+
     this->usedEventIds.insert(eventId);
     return eventId;
 }
@@ -50,17 +50,41 @@ public:
     //===------------------------------------------------------------------===//
 
     static float midiTicksToBeats(double ticks, int timeFormat) noexcept;
+
+    // the import doesn't touch the undo stack and doesn't send notifications,
+    // so that different sequences can be imported in parallel;
+    // the caller is supposed to clear the undo history and to reload the project
     virtual void importMidi(const MidiMessageSequence &sequence, short timeFormat) = 0;
-    virtual void exportMidi(MidiMessageSequence &outSequence,
+    void exportMidi(MidiMessageSequence &outSequence,
         const Clip &clip, const KeyboardMapping &keyMap,
         bool soloPlaybackMode, bool exportMetronome,
         float projectFirstBeat, float projectLastBeat,
         double timeFactor = 1.0) const;
 
+    // exportMidi is split in two parts: the events are exported relative
+    // to the clip once, and then each clip only applies its beat, key and
+    // velocity offsets to them, so the sequences with many clips, like the
+    // repeated drum loops, don't need to re-export all events for each clip
+    virtual void exportClipRelativeMessages(Array<MidiEvent::ExportedMessage> &outMessages,
+        bool exportMetronome, float projectFirstBeat, float projectLastBeat,
+        double timeFactor = 1.0) const;
+
+    virtual void exportClip(MidiMessageSequence &outSequence,
+        const Array<MidiEvent::ExportedMessage> &clipRelativeMessages,
+        const Clip &clip, const KeyboardMapping &keyMap,
+        bool soloPlaybackMode, double timeFactor = 1.0) const;
+
     //===------------------------------------------------------------------===//
     // Track editing
     //===------------------------------------------------------------------===//
 
+    // Moves all events out of the sequence and the given ones in,
+    // with no copying, see MidiTrackNode::swapStateWith; events are
+    // bound to the sequence they were created for, so they should
+    // only be swapped back into the same sequence they came from
+    virtual void swapEventsWith(OwnedArray<MidiEvent> &events,
+        FlatHashSet<MidiEvent::Id> &eventIds);
+
     // Methods for import and checkout.
     // Have different assumptions on event ids.
     // Don't notify anybody to prevent notification hell.
@@ -100,6 +124,20 @@ public:
         this->midiEvents.addSorted(comparator, event.release());
     }
 
+    template<typename T>
+    void checkoutEvent(const T &parameters)
+    {
+        if (this->usedEventIds.contains(parameters.getId()))
+        {
+            jassertfalse;
+            return;
+        }
+
+        static T comparator;
+        this->usedEventIds.insert(parameters.getId());
+        this->midiEvents.addSorted(comparator, new T(this, parameters));
+    }
+
     //===------------------------------------------------------------------===//
     // Accessors
     //===------------------------------------------------------------------===//
@@ -179,6 +217,19 @@ protected:
     virtual float findFirstBeat() const noexcept;
     virtual float findLastBeat() const noexcept;
 
+    // the events export their messages into a flat array, which is then
+    // sorted once and appended to the sequence with the matched pairs
+    static void addExportedMessages(MidiMessageSequence &outSequence,
+        Array<MidiMessage> &messages);
+
+    static void sortExportedMessages(Array<MidiEvent::ExportedMessage> &messages);
+
+    // the group edits don't keep the array sorted event by event,
+    // which takes O(n) per event; instead, they find all the events first,
+    // and then detach them, or merge them into the array, in one pass:
+    void addSortedEvents(const Array<MidiEvent *> &events);
+    void removeEventsAt(Array<int> &indices, bool deleteEvents);
+
     ProjectEventDispatcher &eventDispatcher;
     ProjectNode *getProject() const noexcept;
     UndoStack *getUndoStack() const noexcept;
@@ -186,6 +237,8 @@ protected:
 
     OwnedArray<MidiEvent> midiEvents;
     mutable FlatHashSet<MidiEvent::Id> usedEventIds;
+    // seeded once, not on every id like it used to be
+    mutable Random idRandom;
     
 private:
 
@@ -22,6 +22,9 @@
 #include "NoteActions.h"
 #include "SerializationKeys.h"
 #include "UndoStack.h"
+#include "BinarySerializer.h"
+#include "KeyboardMapping.h"
+#include "Benchmark.h"
 
 PianoSequence::PianoSequence(MidiTrack &track,
     ProjectEventDispatcher &dispatcher) noexcept :
@@ -33,54 +36,66 @@ PianoSequence::PianoSequence(MidiTrack &track,
 
 void PianoSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
+    Array<MidiEvent *> importedNotes;
+    importedNotes.ensureStorageAllocated(sequence.getNumEvents() / 2);
 
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
-        const auto &messageOn = sequence.getEventPointer(i)->message;
-        if (messageOn.isNoteOn())
+        const auto *holderOn = sequence.getEventPointer(i);
+        const auto &messageOn = holderOn->message;
+        // the matched note-off is taken from the holder directly,
+        // since getIndexOfMatchingKeyUp is a linear search
+        if (messageOn.isNoteOn() && holderOn->noteOffObject != nullptr)
         {
             const int key = messageOn.getNoteNumber();
             const float velocity = messageOn.getVelocity() / 128.f;
             const float startBeat = MidiSequence::midiTicksToBeats(messageOn.getTimeStamp(), timeFormat);
-            const int noteOffIndex = sequence.getIndexOfMatchingKeyUp(i);
-            if (noteOffIndex > 0)
+            const MidiMessage &messageOff = holderOn->noteOffObject->message;
+            const float endBeat = MidiSequence::midiTicksToBeats(messageOff.getTimeStamp(), timeFormat);
+            if (endBeat > startBeat)
             {
-                const MidiMessage &messageOff = sequence.getEventPointer(noteOffIndex)->message;
-                const float endBeat = MidiSequence::midiTicksToBeats(messageOff.getTimeStamp(), timeFormat);
-                if (endBeat > startBeat)
-                {
-                    const float length = endBeat - startBeat;
-                    const Note note(this, key, startBeat, length, velocity);
-                    this->importMidiEvent<Note>(note);
-                }
+                const float length = endBeat - startBeat;
+                importedNotes.add(new Note(this, key, startBeat, length, velocity));
             }
         }
     }
 
+    // the midi sequence is sorted already, so this is cheap
+    this->addSortedEvents(importedNotes);
     this->updateBeatRange(false);
 }
 
-void PianoSequence::exportMidi(MidiMessageSequence &outSequence,
-    const Clip &clip, const KeyboardMapping &keyMap,
-    bool soloPlaybackMode, bool exportMetronome,
-    float projectFirstBeat, float projectLastBeat,
+void PianoSequence::exportClipRelativeMessages(Array<MidiEvent::ExportedMessage> &outMessages,
+    bool exportMetronome, float projectFirstBeat, float projectLastBeat,
     double timeFactor /*= 1.0*/) const
 {
-    // This method pretty much duplicates base method, except for this check:
-    if (this->midiEvents.isEmpty() || clip.isMuted() ||
-        (soloPlaybackMode && !clip.isSoloed()))
+    const auto notes = this->getPackedNotes();
+    outMessages.ensureStorageAllocated(outMessages.size() + notes->size() * 2);
+
+    for (int i = 0; i < notes->size(); ++i)
     {
-        return;
+        Note::exportMessages(outMessages,
+            notes->keys.getUnchecked(i), notes->beats.getUnchecked(i),
+            notes->lengths.getUnchecked(i), notes->velocities.getUnchecked(i),
+            notes->tuplets.getUnchecked(i), timeFactor);
     }
 
-    for (const auto *event : this->midiEvents)
+    MidiSequence::sortExportedMessages(outMessages);
+}
+
+void PianoSequence::exportClip(MidiMessageSequence &outSequence,
+    const Array<MidiEvent::ExportedMessage> &clipRelativeMessages,
+    const Clip &clip, const KeyboardMapping &keyMap,
+    bool soloPlaybackMode, double timeFactor /*= 1.0*/) const
+{
+    // This method only adds this check to the base method:
+    if (soloPlaybackMode && !clip.isSoloed())
     {
-        event->exportMessages(outSequence, clip, keyMap, timeFactor);
+        return;
     }
 
-    outSequence.updateMatchedPairs();
+    MidiSequence::exportClip(outSequence, clipRelativeMessages,
+        clip, keyMap, soloPlaybackMode, timeFactor);
 }
 
 //===----------------------------------------------------------------------===//
@@ -99,6 +114,7 @@ MidiEvent *PianoSequence::insert(const Note &eventParams, const bool undoable)
     {
         auto *ownedNote = new Note(this, eventParams);
         this->midiEvents.addSorted(*ownedNote, ownedNote);
+        this->invalidatePackedNotes();
         this->eventDispatcher.dispatchAddEvent(*ownedNote);
         this->updateBeatRange(true);
         return ownedNote;
@@ -125,6 +141,7 @@ bool PianoSequence::remove(const Note &eventParams, const bool undoable)
             jassert(removedNote->isValid());
             this->eventDispatcher.dispatchRemoveEvent(*removedNote);
             this->midiEvents.remove(index, true);
+            this->invalidatePackedNotes();
             this->updateBeatRange(true);
             this->eventDispatcher.dispatchPostRemoveEvent(this);
             return true;
@@ -155,6 +172,7 @@ bool PianoSequence::change(const Note &oldParams,
             changedNote->applyChanges(newParams);
             this->midiEvents.remove(index, false);
             this->midiEvents.addSorted(*changedNote, changedNote);
+            this->invalidatePackedNotes();
             this->eventDispatcher.dispatchChangeEvent(oldParams, *changedNote);
             this->updateBeatRange(true);
             return true;
@@ -176,14 +194,20 @@ bool PianoSequence::insertGroup(Array<Note> &group, bool undoable)
     }
     else
     {
-        for (int i = 0; i < group.size(); ++i)
+        Array<MidiEvent *> ownedNotes;
+        ownedNotes.ensureStorageAllocated(group.size());
+        for (const auto &eventParams : group)
         {
-            const Note &eventParams = group.getUnchecked(i);
-            auto *ownedNote = new Note(this, eventParams);
-            this->midiEvents.addSorted(*ownedNote, ownedNote);
-            this->eventDispatcher.dispatchAddEvent(*ownedNote);
+            ownedNotes.add(new Note(this, eventParams));
         }
 
+        this->addSortedEvents(ownedNotes);
+        this->invalidatePackedNotes();
+
+        Array<const MidiEvent *> addedNotes;
+        addedNotes.addArray(ownedNotes);
+        this->eventDispatcher.dispatchAddEvents(addedNotes);
+
         this->updateBeatRange(true);
     }
 
@@ -200,6 +224,11 @@ bool PianoSequence::removeGroup(Array<Note> &group, bool undoable)
     }
     else
     {
+        Array<int> indices;
+        Array<const MidiEvent *> removedNotes;
+        indices.ensureStorageAllocated(group.size());
+        removedNotes.ensureStorageAllocated(group.size());
+
         for (int i = 0; i < group.size(); ++i)
         {
             const Note &note = group.getUnchecked(i);
@@ -211,12 +240,16 @@ bool PianoSequence::removeGroup(Array<Note> &group, bool undoable)
             jassert(index >= 0);
             if (index >= 0)
             {
-                auto *removedNote = this->midiEvents.getUnchecked(index);
-                this->eventDispatcher.dispatchRemoveEvent(*removedNote);
-                this->midiEvents.remove(index, true);
+                indices.add(index);
+                removedNotes.add(this->midiEvents.getUnchecked(index));
             }
         }
 
+        // the listeners still need the notes to be valid
+        this->eventDispatcher.dispatchRemoveEvents(removedNotes);
+        this->removeEventsAt(indices, true);
+        this->invalidatePackedNotes();
+
         this->updateBeatRange(true);
         this->eventDispatcher.dispatchPostRemoveEvent(this);
     }
@@ -237,26 +270,13 @@ bool PianoSequence::changeGroup(Array<Note> &groupBefore,
     }
     else
     {
-        for (int i = 0; i < groupBefore.size(); ++i)
-        {
-            const Note &oldParams = groupBefore.getReference(i);
-            const Note &newParams = groupAfter.getReference(i);
-            const int index = this->midiEvents.indexOfSorted(oldParams, &oldParams);
-            // if you're hitting this assertion, one of the reasons might be
-            // allowing user to somehow select notes of different clips simultaneously,
-            // and then editing the selection, which leads to applying the same
-            // transformation to one set of notes twice, which is kinda nonsense,
-            // so make sure the selection is always limited to active track and clip:
-            jassert(index >= 0);
-            if (index >= 0)
-            {
-                auto *changedNote = static_cast<Note *>(this->midiEvents.getUnchecked(index));
-                changedNote->applyChanges(newParams);
-                this->midiEvents.remove(index, false);
-                this->midiEvents.addSorted(*changedNote, changedNote);
-                this->eventDispatcher.dispatchChangeEvent(oldParams, *changedNote);
-            }
-        }
+        Array<MidiEvent *> changedNotes;
+        Array<const MidiEvent *> oldNotes;
+        this->applyGroupChange(groupBefore, groupAfter, changedNotes, oldNotes);
+
+        Array<const MidiEvent *> newNotes;
+        newNotes.addArray(changedNotes);
+        this->eventDispatcher.dispatchChangeEvents(oldNotes, newNotes);
 
         this->updateBeatRange(true);
     }
@@ -264,6 +284,73 @@ bool PianoSequence::changeGroup(Array<Note> &groupBefore,
     return true;
 }
 
+void PianoSequence::previewGroupChange(const Array<Note> &groupBefore,
+    const Array<Note> &groupAfter)
+{
+    jassert(groupBefore.size() == groupAfter.size());
+
+    Array<MidiEvent *> changedNotes;
+    Array<const MidiEvent *> oldNotes;
+    this->applyGroupChange(groupBefore, groupAfter, changedNotes, oldNotes);
+}
+
+bool PianoSequence::commitGroupChange(Array<Note> &groupBefore,
+    Array<Note> &groupAfter)
+{
+    jassert(groupBefore.size() == groupAfter.size());
+
+    // the previewed state is silently reverted first,
+    // so that the undo action could perform it once again:
+    this->previewGroupChange(groupAfter, groupBefore);
+    return this->changeGroup(groupBefore, groupAfter, true);
+}
+
+void PianoSequence::applyGroupChange(const Array<Note> &groupBefore,
+    const Array<Note> &groupAfter,
+    Array<MidiEvent *> &changedNotes,
+    Array<const MidiEvent *> &oldNotes)
+{
+    Array<int> indices;
+    Array<const Note *> newParams;
+    indices.ensureStorageAllocated(groupBefore.size());
+    changedNotes.ensureStorageAllocated(groupBefore.size());
+    oldNotes.ensureStorageAllocated(groupBefore.size());
+    newParams.ensureStorageAllocated(groupBefore.size());
+    FlatHashSet<int> foundIndices;
+
+    // all lookups go first, while the array is still sorted
+    for (int i = 0; i < groupBefore.size(); ++i)
+    {
+        const Note &oldParams = groupBefore.getReference(i);
+        const int index = this->midiEvents.indexOfSorted(oldParams, &oldParams);
+        // if you're hitting this assertion, one of the reasons might be
+        // allowing user to somehow select notes of different clips simultaneously,
+        // and then editing the selection, which leads to applying the same
+        // transformation to one set of notes twice, which is kinda nonsense,
+        // so make sure the selection is always limited to active track and clip:
+        jassert(index >= 0);
+        // (the same note can't be changed twice within a group anyway)
+        if (index >= 0 && foundIndices.insert(index).second)
+        {
+            indices.add(index);
+            changedNotes.add(this->midiEvents.getUnchecked(index));
+            oldNotes.add(&oldParams);
+            newParams.add(&groupAfter.getReference(i));
+        }
+    }
+
+    this->removeEventsAt(indices, false);
+
+    for (int i = 0; i < changedNotes.size(); ++i)
+    {
+        static_cast<Note *>(changedNotes.getUnchecked(i))->
+            applyChanges(*newParams.getUnchecked(i));
+    }
+
+    this->addSortedEvents(changedNotes);
+    this->invalidatePackedNotes();
+}
+
 //===----------------------------------------------------------------------===//
 // Accessors
 //===----------------------------------------------------------------------===//
@@ -300,12 +387,10 @@ SerializedData PianoSequence::serialize() const
 {
     SerializedData tree(Serialization::Midi::track);
 
-    for (int i = 0; i < this->midiEvents.size(); ++i)
-    {
-        const auto *event = this->midiEvents.getUnchecked(i);
-        tree.appendChild(event->serialize());
-    }
-    
+    Array<const MidiEvent *> notes;
+    notes.addArray(this->midiEvents);
+    Note::packNotes(tree, notes);
+
     return tree;
 }
 
@@ -323,13 +408,14 @@ void PianoSequence::deserialize(const SerializedData &data)
     }
 
     // a hack to avoid generating a unique id each time we create `new Note(this)`:
-    // instead, deserialize parameters into this temporary unowned struct,
-    // and later create an owned note with known parameters
-    Note parameters;
+    // instead, deserialize parameters into these temporary unowned structs,
+    // and later create owned notes with known parameters
+    Array<Note> notes;
+    Note::unpackNotes(root, notes);
 
-    forEachChildWithType(root, e, Serialization::Midi::note)
+    this->midiEvents.ensureStorageAllocated(notes.size());
+    for (const auto &parameters : notes)
     {
-        parameters.deserialize(e);
         this->midiEvents.add(new Note(this, parameters));
         this->usedEventIds.insert(parameters.getId());
     }
@@ -342,4 +428,212 @@ void PianoSequence::reset()
 {
     this->midiEvents.clear();
     this->usedEventIds.clear();
+    this->invalidatePackedNotes();
+}
+
+void PianoSequence::swapEventsWith(OwnedArray<MidiEvent> &events,
+    FlatHashSet<MidiEvent::Id> &eventIds)
+{
+    MidiSequence::swapEventsWith(events, eventIds);
+    this->invalidatePackedNotes();
+}
+
+//===----------------------------------------------------------------------===//
+// Packed storage
+//===----------------------------------------------------------------------===//
+
+PianoSequence::PackedNotes::Ptr PianoSequence::getPackedNotes() const
+{
+    const SpinLock::ScopedLockType lock(this->packedNotesLock);
+
+    if (this->packedNotes != nullptr)
+    {
+        return this->packedNotes;
+    }
+
+    PackedNotes::Ptr notes(new PackedNotes());
+
+    const auto numNotes = this->midiEvents.size();
+    notes->beats.ensureStorageAllocated(numNotes);
+    notes->lengths.ensureStorageAllocated(numNotes);
+    notes->keys.ensureStorageAllocated(numNotes);
+    notes->velocities.ensureStorageAllocated(numNotes);
+    notes->tuplets.ensureStorageAllocated(numNotes);
+    notes->ids.ensureStorageAllocated(numNotes);
+    notes->maxEnds.ensureStorageAllocated(numNotes);
+
+    float maxEnd = -FLT_MAX;
+    for (const auto *event : this->midiEvents)
+    {
+        const auto *note = static_cast<const Note *>(event);
+        maxEnd = jmax(maxEnd, note->getBeat() + note->getLength());
+        notes->maxEnds.add(maxEnd);
+        notes->beats.add(note->getBeat());
+        notes->lengths.add(note->getLength());
+        notes->keys.add(note->getKey());
+        notes->velocities.add(note->getVelocity());
+        notes->tuplets.add(note->getTuplet());
+        notes->ids.add(note->getId());
+    }
+
+    this->packedNotes = notes;
+    return notes;
+}
+
+void PianoSequence::invalidatePackedNotes() noexcept
+{
+    const SpinLock::ScopedLockType lock(this->packedNotesLock);
+    this->packedNotes = nullptr;
+}
+
+int PianoSequence::PackedNotes::indexOfFirstStartingFrom(float beat) const noexcept
+{
+    return int(std::lower_bound(this->beats.begin(), this->beats.end(), beat) - this->beats.begin());
 }
+
+int PianoSequence::PackedNotes::indexOfFirstEndingAfter(float beat) const noexcept
+{
+    return int(std::upper_bound(this->maxEnds.begin(), this->maxEnds.end(), beat) - this->maxEnds.begin());
+}
+
+void PianoSequence::findNotesStartingInRange(float startBeat, float endBeat,
+    Array<Note *> &outNotes) const
+{
+    const auto notes = this->getPackedNotes();
+    jassert(notes->size() == this->midiEvents.size());
+
+    const auto end = notes->indexOfFirstStartingFrom(endBeat);
+    for (int i = notes->indexOfFirstStartingFrom(startBeat); i < end; ++i)
+    {
+        outNotes.add(static_cast<Note *>(this->midiEvents.getUnchecked(i)));
+    }
+}
+
+void PianoSequence::findNotesOverlappingRange(float startBeat, float endBeat,
+    Array<Note *> &outNotes) const
+{
+    const auto notes = this->getPackedNotes();
+    jassert(notes->size() == this->midiEvents.size());
+
+    // all notes before the first index end before the range,
+    // but some of the following ones might still need to be skipped
+    const auto end = notes->indexOfFirstStartingFrom(endBeat);
+    for (int i = notes->indexOfFirstEndingAfter(startBeat); i < end; ++i)
+    {
+        if (notes->beats.getUnchecked(i) + notes->lengths.getUnchecked(i) > startBeat)
+        {
+            outNotes.add(static_cast<Note *>(this->midiEvents.getUnchecked(i)));
+        }
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Helpers
+//===----------------------------------------------------------------------===//
+
+void PianoSequence::updateBeatRange(bool shouldNotifyIfChanged)
+{
+    this->invalidatePackedNotes();
+    MidiSequence::updateBeatRange(shouldNotifyIfChanged);
+}
+
+//===----------------------------------------------------------------------===//
+// Benchmarks
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class PianoSequenceBenchmarks final : public Benchmark
+{
+public:
+
+    PianoSequenceBenchmarks() : Benchmark("Piano sequence benchmarks") {}
+
+    void runTest() override
+    {
+        SequenceTrack track;
+        PianoSequence sequence(track, this->dispatcher);
+        track.sequence = &sequence;
+
+        // a dense generated score, about a hundred notes per bar
+        const auto numNotes = 10000 * Benchmark::getSize();
+        const auto numBars = float(numNotes / 100);
+
+        Random random(1);
+        Array<Note> notes;
+        notes.ensureStorageAllocated(numNotes);
+        for (int i = 0; i < numNotes; ++i)
+        {
+            const auto beat = roundBeat(random.nextFloat() * numBars * Globals::beatsPerBar);
+            notes.add(Note(&sequence, 24 + random.nextInt(72), beat,
+                Globals::minNoteLength * float(1 + random.nextInt(32)), random.nextFloat()));
+        }
+
+        beginTest("Insert notes");
+        this->measure("insertGroup", [&]()
+        {
+            sequence.reset();
+            sequence.insertGroup(notes, false);
+        });
+
+        beginTest("Find notes in range");
+        this->measure("findNotesOverlappingRange", [&]()
+        {
+            Array<Note *> found;
+            for (float bar = 0.f; bar < numBars; bar += 1.f)
+            {
+                found.clearQuick();
+                sequence.findNotesOverlappingRange(bar * Globals::beatsPerBar,
+                    (bar + 1.f) * Globals::beatsPerBar, found);
+            }
+        });
+
+        beginTest("Serialization");
+        SerializedData tree;
+        this->measure("serialize", [&]() { tree = sequence.serialize(); });
+        this->measure("deserialize", [&]() { sequence.deserialize(tree); });
+
+        BinarySerializer serializer;
+        String binary;
+        this->measure("BinarySerializer::saveToString",
+            [&]() { serializer.saveToString(binary, tree); });
+        this->measure("BinarySerializer::loadFromString",
+            [&]() { tree = serializer.loadFromString(binary); });
+
+        beginTest("MIDI export and import");
+        constexpr auto timeFactor = 960.0;
+        const Clip clip;
+        const KeyboardMapping keyMap;
+        Array<MidiEvent::ExportedMessage> messages;
+        MidiMessageSequence midiSequence;
+        this->measure("exportClip", [&]()
+        {
+            messages.clearQuick();
+            midiSequence.clear();
+            sequence.exportClipRelativeMessages(messages, false,
+                sequence.getFirstBeat(), sequence.getLastBeat(), timeFactor);
+            sequence.exportClip(midiSequence, messages, clip, keyMap, false, timeFactor);
+        });
+
+        midiSequence.updateMatchedPairs();
+        this->measure("importMidi", [&]()
+        {
+            sequence.reset();
+            sequence.importMidi(midiSequence, short(timeFactor));
+        });
+    }
+
+private:
+
+    struct SequenceTrack final : public VirtualMidiTrack
+    {
+        MidiSequence *getSequence() const noexcept override { return this->sequence; }
+        MidiSequence *sequence = nullptr;
+    };
+
+    EmptyEventDispatcher dispatcher;
+};
+
+static PianoSequenceBenchmarks pianoSequenceBenchmarks;
+
+#endif
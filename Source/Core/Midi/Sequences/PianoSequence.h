@@ -33,11 +33,13 @@ public:
     //===------------------------------------------------------------------===//
 
     void importMidi(const MidiMessageSequence &sequence, short timeFormat) override;
-    void exportMidi(MidiMessageSequence &outSequence,
-        const Clip &clip, const KeyboardMapping &keyMap,
-        bool soloPlaybackMode, bool exportMetronome,
-        float projectFirstBeat, float projectLastBeat,
+    void exportClipRelativeMessages(Array<MidiEvent::ExportedMessage> &outMessages,
+        bool exportMetronome, float projectFirstBeat, float projectLastBeat,
         double timeFactor = 1.0) const override;
+    void exportClip(MidiMessageSequence &outSequence,
+        const Array<MidiEvent::ExportedMessage> &clipRelativeMessages,
+        const Clip &clip, const KeyboardMapping &keyMap,
+        bool soloPlaybackMode, double timeFactor = 1.0) const override;
 
     //===------------------------------------------------------------------===//
     // Undoable track editing
@@ -53,7 +55,80 @@ public:
     bool removeGroup(Array<Note> &notes, bool undoable);
     bool changeGroup(Array<Note> &eventsBefore,
         Array<Note> &eventsAfter, bool undoable);
+
+    // interactive edits, like dragging the notes around, are previewed in place,
+    // with no undo actions and no notifications, so the caller has to update
+    // itself; when done, the edit is committed as a single undoable change,
+    // which notifies all the listeners once
+    void previewGroupChange(const Array<Note> &eventsBefore,
+        const Array<Note> &eventsAfter);
+    bool commitGroupChange(Array<Note> &eventsBefore,
+        Array<Note> &eventsAfter);
     
+    //===------------------------------------------------------------------===//
+    // Packed storage
+    //===------------------------------------------------------------------===//
+
+    // The notes are owned by the base class as separate heap objects,
+    // which all the editing code relies on; for the hot read-only paths,
+    // like the export, the sequence also keeps the note parameters packed
+    // in the parallel arrays, in the same order; they are rebuilt lazily
+    // after any change, and are immutable, so can be shared between threads
+    struct PackedNotes final : public ReferenceCountedObject
+    {
+        Array<float> beats;
+        Array<float> lengths;
+        Array<Note::Key> keys;
+        Array<float> velocities;
+        Array<Note::Tuplet> tuplets;
+        Array<MidiEvent::Id> ids;
+
+        // the running maximum of the note ends, which makes the overlap
+        // lookups a binary search, since it never decreases
+        Array<float> maxEnds;
+
+        inline int size() const noexcept { return this->beats.size(); }
+
+        // the index of the first note starting at or after the given beat
+        int indexOfFirstStartingFrom(float beat) const noexcept;
+
+        // the index of the first note which may end after the given beat
+        int indexOfFirstEndingAfter(float beat) const noexcept;
+
+        using Ptr = ReferenceCountedObjectPtr<PackedNotes>;
+    };
+
+    // a lightweight handle to a packed note, mirrors the Note accessors
+    class PackedNote final
+    {
+    public:
+
+        PackedNote(const PackedNotes &notes, int index) noexcept :
+            notes(notes), index(index) {}
+
+        inline float getBeat() const noexcept { return this->notes.beats.getUnchecked(this->index); }
+        inline float getLength() const noexcept { return this->notes.lengths.getUnchecked(this->index); }
+        inline Note::Key getKey() const noexcept { return this->notes.keys.getUnchecked(this->index); }
+        inline float getVelocity() const noexcept { return this->notes.velocities.getUnchecked(this->index); }
+        inline Note::Tuplet getTuplet() const noexcept { return this->notes.tuplets.getUnchecked(this->index); }
+        inline MidiEvent::Id getId() const noexcept { return this->notes.ids.getUnchecked(this->index); }
+
+    private:
+
+        const PackedNotes &notes;
+        const int index;
+    };
+
+    PackedNotes::Ptr getPackedNotes() const;
+
+    // the range lookups, like the lasso selection, take O(log n + k)
+    // instead of scanning the whole sequence; this is only safe to use
+    // from the thread that edits the sequence (i.e. the message thread)
+    void findNotesStartingInRange(float startBeat, float endBeat,
+        Array<Note *> &outNotes) const;
+    void findNotesOverlappingRange(float startBeat, float endBeat,
+        Array<Note *> &outNotes) const;
+
     //===------------------------------------------------------------------===//
     // Serializable
     //===------------------------------------------------------------------===//
@@ -62,10 +137,30 @@ public:
     void deserialize(const SerializedData &data) override;
     void reset() override;
 
+    void swapEventsWith(OwnedArray<MidiEvent> &events,
+        FlatHashSet<MidiEvent::Id> &eventIds) override;
+
+    //===------------------------------------------------------------------===//
+    // Helpers
+    //===------------------------------------------------------------------===//
+
+    // the edits invalidate the packed notes before notifying the listeners,
+    // the rest (the imports and the checkouts) end up here
+    void updateBeatRange(bool shouldNotifyIfChanged) override;
+
 private:
 
     float findLastBeat() const noexcept override;
 
+    void applyGroupChange(const Array<Note> &groupBefore,
+        const Array<Note> &groupAfter,
+        Array<MidiEvent *> &outChangedNotes,
+        Array<const MidiEvent *> &outOldNotes);
+
+    mutable PackedNotes::Ptr packedNotes;
+    mutable SpinLock packedNotesLock;
+    void invalidatePackedNotes() noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PianoSequence);
     JUCE_DECLARE_WEAK_REFERENCEABLE(PianoSequence);
 };
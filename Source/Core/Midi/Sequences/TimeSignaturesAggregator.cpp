@@ -45,6 +45,11 @@ public:
     void dispatchRemoveEvent(const MidiEvent &event) override {}
     void dispatchPostRemoveEvent(MidiSequence *const layer) override {}
 
+    void dispatchAddEvents(const Array<const MidiEvent *> &events) override {}
+    void dispatchChangeEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents) override {}
+    void dispatchRemoveEvents(const Array<const MidiEvent *> &events) override {}
+
     void dispatchAddClip(const Clip &clip) override {}
     void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) override {}
     void dispatchRemoveClip(const Clip &clip) override {}
@@ -121,6 +126,11 @@ void TimeSignaturesAggregator::updateGridDefaultsIfNeeded(int &numerator, int &d
     }
 }
 
+int TimeSignaturesAggregator::getVersion() const noexcept
+{
+    return this->version;
+}
+
 //===----------------------------------------------------------------------===//
 // Listeners management
 //===----------------------------------------------------------------------===//
@@ -143,6 +153,12 @@ void TimeSignaturesAggregator::removeAllListeners()
     this->listeners.clear();
 }
 
+void TimeSignaturesAggregator::notifyTimeSignaturesUpdated()
+{
+    this->version++;
+    this->listeners.call(&Listener::onTimeSignaturesUpdated);
+}
+
 //===----------------------------------------------------------------------===//
 // VirtualMidiTrack
 //===----------------------------------------------------------------------===//
@@ -170,7 +186,7 @@ void TimeSignaturesAggregator::onAddMidiEvent(const MidiEvent &event)
         !this->isAggregatingTimeSignatureOverrides())
     {
         jassert(static_cast<const TimeSignatureEvent &>(event).getSequence() == this->getSequence());
-        this->listeners.call(&Listener::onTimeSignaturesUpdated);
+        this->notifyTimeSignaturesUpdated();
     }
 }
 
@@ -181,7 +197,7 @@ void TimeSignaturesAggregator::onChangeMidiEvent(const MidiEvent &oldEvent, cons
     {
         jassert(static_cast<const TimeSignatureEvent &>(oldEvent).getSequence() == this->getSequence());
         jassert(static_cast<const TimeSignatureEvent &>(newEvent).getSequence() == this->getSequence());
-        this->listeners.call(&Listener::onTimeSignaturesUpdated);
+        this->notifyTimeSignaturesUpdated();
     }
 }
 
@@ -190,7 +206,7 @@ void TimeSignaturesAggregator::onPostRemoveMidiEvent(MidiSequence *const sequenc
     if (sequence == this->getSequence() &&
         !this->isAggregatingTimeSignatureOverrides())
     {
-        this->listeners.call(&Listener::onTimeSignaturesUpdated);
+        this->notifyTimeSignaturesUpdated();
     }
 }
 
@@ -288,13 +304,10 @@ void TimeSignaturesAggregator::rebuildAll()
     {
         // now it will return timeline's sequence in getSequence():
         this->orderedEvents = nullptr;
-        this->listeners.call(&Listener::onTimeSignaturesUpdated);
+        this->notifyTimeSignaturesUpdated();
         return;
     }
 
-    // clear all
-    this->orderedEvents = make<TimeSignaturesSequence>(*this, *this->dummyEventDispatcher.get());
-
     // todo: multiple time signatures per track? now there can be only one
 
     Array<Clip *> allOrdererClips; // duplicate positions won't be a problem
@@ -316,6 +329,7 @@ void TimeSignaturesAggregator::rebuildAll()
     float chunkStartBeat = 0.f;
     // we'll also make sure all those time signatures have unique ids:
     MidiEvent::Id generatedTimeSignatureId = 0;
+    Array<TimeSignatureEvent> aggregatedEvents;
 
     for (const auto *clip : allOrdererClips)
     {
@@ -333,7 +347,7 @@ void TimeSignaturesAggregator::rebuildAll()
         {
             chunkStartBeat = startBeat;
             chunkStartMeter = timeSignatureOverride->getMeter();
-            this->orderedEvents->appendUnsafe(timeSignatureOverride->withId(generatedTimeSignatureId).withBeat(startBeat));
+            aggregatedEvents.add(timeSignatureOverride->withId(generatedTimeSignatureId).withBeat(startBeat));
             generatedTimeSignatureId++;
 
             continue;
@@ -349,10 +363,50 @@ void TimeSignaturesAggregator::rebuildAll()
         // new chunk starts here, add time signature
         chunkStartBeat = startBeat;
         chunkStartMeter = timeSignatureOverride->getMeter();
-        this->orderedEvents->appendUnsafe(timeSignatureOverride->withId(generatedTimeSignatureId).withBeat(startBeat));
+        aggregatedEvents.add(timeSignatureOverride->withId(generatedTimeSignatureId).withBeat(startBeat));
         generatedTimeSignatureId++;
     }
 
+    // most of the edits, like moving the notes around, don't affect
+    // the aggregated time signatures at all, and when they do, it's usually
+    // the tail of the list, so only the events after the first mismatch are replaced:
+    if (this->orderedEvents == nullptr)
+    {
+        this->orderedEvents = make<TimeSignaturesSequence>(*this, *this->dummyEventDispatcher.get());
+    }
+
+    auto &existingEvents = this->orderedEvents->midiEvents;
+
+    int numUnchangedEvents = 0;
+    while (numUnchangedEvents < jmin(existingEvents.size(), aggregatedEvents.size()))
+    {
+        const auto *existing = static_cast<const TimeSignatureEvent *>(existingEvents.getUnchecked(numUnchangedEvents));
+        const auto &aggregated = aggregatedEvents.getReference(numUnchangedEvents);
+        if (existing->getId() != aggregated.getId() ||
+            existing->getBeat() != aggregated.getBeat() ||
+            existing->getMeter() != aggregated.getMeter() ||
+            existing->getTrack() != aggregated.getTrack())
+        {
+            break;
+        }
+
+        numUnchangedEvents++;
+    }
+
+    if (numUnchangedEvents == existingEvents.size() &&
+        numUnchangedEvents == aggregatedEvents.size())
+    {
+        return;
+    }
+
+    existingEvents.removeLast(existingEvents.size() - numUnchangedEvents);
+    for (int i = numUnchangedEvents; i < aggregatedEvents.size(); ++i)
+    {
+        this->orderedEvents->appendUnsafe(aggregatedEvents.getReference(i));
+    }
+
+    this->orderedEvents->updateBeatRange(false);
+
     // for now, simple as that: remember the very first one
     // of the aggregated time signatures, and use it as the grid default
     if (!this->orderedEvents->isEmpty())
@@ -363,5 +417,5 @@ void TimeSignaturesAggregator::rebuildAll()
         this->defaultGridStart = firstTimeSignature->getBeat();
     }
 
-    this->listeners.call(&Listener::onTimeSignaturesUpdated);
+    this->notifyTimeSignaturesUpdated();
 }
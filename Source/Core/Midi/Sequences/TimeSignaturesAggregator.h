@@ -58,6 +58,11 @@ public:
     void updateGridDefaultsIfNeeded(int &numerator,
         int &denominator, float &startBeat) const noexcept;
 
+    // incremented each time the listeners are notified,
+    // so that anything computed from the time signatures
+    // can be cached and only recomputed when this changes
+    int getVersion() const noexcept;
+
     //===------------------------------------------------------------------===//
     // Listeners management
     //===------------------------------------------------------------------===//
@@ -114,6 +119,9 @@ private:
     void rebuildAll();
     bool isAggregatingTimeSignatureOverrides() const noexcept;
 
+    void notifyTimeSignaturesUpdated();
+    int version = 0;
+
     UniquePointer<DummyProjectEventDispatcher> dummyEventDispatcher;
     UniquePointer<TimeSignaturesSequence> orderedEvents;
 
@@ -35,9 +35,6 @@ TimeSignaturesSequence::TimeSignaturesSequence(MidiTrack &track,
 
 void TimeSignaturesSequence::importMidi(const MidiMessageSequence &sequence, short timeFormat)
 {
-    this->clearUndoHistory();
-    this->checkpoint();
-
     for (int i = 0; i < sequence.getNumEvents(); ++i)
     {
         const auto &message = sequence.getEventPointer(i)->message;
@@ -55,10 +52,8 @@ void TimeSignaturesSequence::importMidi(const MidiMessageSequence &sequence, sho
     this->updateBeatRange(false);
 }
 
-void TimeSignaturesSequence::exportMidi(MidiMessageSequence &outSequence,
-    const Clip &clip, const KeyboardMapping &keyMap,
-    bool soloPlaybackMode, bool exportMetronome,
-    float projectFirstBeat, float projectLastBeat,
+void TimeSignaturesSequence::exportClipRelativeMessages(Array<MidiEvent::ExportedMessage> &outMessages,
+    bool exportMetronome, float projectFirstBeat, float projectLastBeat,
     double timeFactor /*= 1.0*/) const
 {
     // This method pretty much duplicates the base method, except for
@@ -69,77 +64,78 @@ void TimeSignaturesSequence::exportMidi(MidiMessageSequence &outSequence,
         // but it is only used when exporting to midi file (i.e. sets midi clock),
         // and we don't export the virtual metronome track to midi files:
         jassert(timeFactor == 1.0);
+        this->exportMetronome(outMessages, projectFirstBeat, projectLastBeat);
+    }
 
-        const auto emitNextMetronomeEvent = [](MidiMessageSequence &outSequence,
-            float beat, const MetronomeScheme &scheme, int &syllableIndex)
-        {
-            const auto currentSyllable = scheme.getSyllableAt(syllableIndex);
-            const auto key = MetronomeSynth::getKeyForSyllable(currentSyllable);
+    MidiSequence::exportClipRelativeMessages(outMessages,
+        exportMetronome, projectFirstBeat, projectLastBeat, timeFactor);
+}
+
+void TimeSignaturesSequence::exportMetronome(Array<MidiEvent::ExportedMessage> &outMessages,
+    float projectFirstBeat, float projectLastBeat) const
+{
+    const auto emitNextMetronomeEvent = [](Array<MidiEvent::ExportedMessage> &outMessages,
+        float beat, const MetronomeScheme &scheme, int &syllableIndex)
+    {
+        const auto currentSyllable = scheme.getSyllableAt(syllableIndex);
+        const auto key = MetronomeSynth::getKeyForSyllable(currentSyllable);
+
+        syllableIndex = ++syllableIndex % scheme.getSize();
 
-            syllableIndex = ++syllableIndex % scheme.getSize();
+        constexpr auto metronomeChannel = 1;    // doesn't matter which one
+        constexpr auto metronomeVelocity = 1.f; // also will be ignored
 
-            constexpr auto metronomeChannel = 1;    // doesn't matter which one
-            constexpr auto metronomeVelocity = 1.f; // also will be ignored
+        MidiMessage mentonomeNoteOn(MidiMessage::noteOn(metronomeChannel, key, metronomeVelocity));
+        mentonomeNoteOn.setTimeStamp(beat);
+        outMessages.add({ mentonomeNoteOn, key, metronomeVelocity, true });
 
-            MidiMessage mentonomeNoteOn(MidiMessage::noteOn(metronomeChannel, key, metronomeVelocity));
-            mentonomeNoteOn.setTimeStamp(beat);
-            outSequence.addEvent(mentonomeNoteOn);
+        // for simplicity, not emitting note-offs for the built-in metronome,
+        // Synthesiser class automatically stops/starts the voices when the same note repeats
+    };
 
-            // for simplicity, not emitting note-offs for the built-in metronome,
-            // Synthesiser class automatically stops/starts the voices when the same note repeats
-        };
+    if (this->midiEvents.isEmpty())
+    {
+        int syllableIndex = 0;
+        const MetronomeScheme defaultScheme;
+        for (float beat = projectFirstBeat; beat <= projectLastBeat; beat += 1.f)
+        {
+            emitNextMetronomeEvent(outMessages, beat, defaultScheme, syllableIndex);
+        }
+    }
+    else
+    {
+        const auto *firstEvent = static_cast<const TimeSignatureEvent *>(this->midiEvents.getFirst());
+        jassert(firstEvent->getBeat() >= projectFirstBeat);
 
-        if (this->midiEvents.isEmpty())
         {
             int syllableIndex = 0;
-            const MetronomeScheme defaultScheme;
-            for (float beat = projectFirstBeat; beat <= projectLastBeat; beat += 1.f)
+            const auto metronomeScheme = firstEvent->getMeter().getMetronome();
+            jassert(metronomeScheme.isValid());
+
+            for (float beat = projectFirstBeat; beat < firstEvent->getBeat();
+                 beat += firstEvent->getDenominatorInBeats())
             {
-                emitNextMetronomeEvent(outSequence, beat, defaultScheme, syllableIndex);
+                emitNextMetronomeEvent(outMessages, beat, metronomeScheme, syllableIndex);
             }
         }
-        else
+
+        for (int i = 0; i < this->midiEvents.size(); ++i)
         {
-            const auto *firstEvent = static_cast<const TimeSignatureEvent *>(this->midiEvents.getFirst());
-            jassert(firstEvent->getBeat() >= projectFirstBeat);
+            const auto *event = static_cast<const TimeSignatureEvent *>(this->midiEvents.getUnchecked(i));
+            const auto nextBeat = (i < this->midiEvents.size() - 1) ?
+                this->midiEvents.getUnchecked(i + 1)->getBeat() : projectLastBeat;
 
-            {
-                int syllableIndex = 0;
-                const auto metronomeScheme = firstEvent->getMeter().getMetronome();
-                jassert(metronomeScheme.isValid());
-
-                for (float beat = projectFirstBeat; beat < firstEvent->getBeat();
-                     beat += firstEvent->getDenominatorInBeats())
-                {
-                    emitNextMetronomeEvent(outSequence, beat, metronomeScheme, syllableIndex);
-                }
-            }
+            int syllableIndex = 0;
+            const auto metronomeScheme = event->getMeter().getMetronome();
+            jassert(metronomeScheme.isValid());
 
-            for (int i = 0; i < this->midiEvents.size(); ++i)
+            for (float beat = event->getBeat(); beat < nextBeat;
+                 beat += event->getDenominatorInBeats())
             {
-                const auto *event = static_cast<const TimeSignatureEvent *>(this->midiEvents.getUnchecked(i));
-                const auto nextBeat = (i < this->midiEvents.size() - 1) ?
-                    this->midiEvents.getUnchecked(i + 1)->getBeat() : projectLastBeat;
-
-                int syllableIndex = 0;
-                const auto metronomeScheme = event->getMeter().getMetronome();
-                jassert(metronomeScheme.isValid());
-
-                for (float beat = event->getBeat(); beat < nextBeat;
-                     beat += event->getDenominatorInBeats())
-                {
-                    emitNextMetronomeEvent(outSequence, beat, metronomeScheme, syllableIndex);
-                }
+                emitNextMetronomeEvent(outMessages, beat, metronomeScheme, syllableIndex);
             }
         }
     }
-
-    for (const auto *event : this->midiEvents)
-    {
-        event->exportMessages(outSequence, clip, keyMap, timeFactor);
-    }
-
-    outSequence.updateMatchedPairs();
 }
 
 //===----------------------------------------------------------------------===//
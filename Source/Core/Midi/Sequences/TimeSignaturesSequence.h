@@ -32,12 +32,15 @@ public:
     //===------------------------------------------------------------------===//
 
     void importMidi(const MidiMessageSequence &sequence, short timeFormat) override;
-    void exportMidi(MidiMessageSequence &outSequence,
-        const Clip &clip, const KeyboardMapping &keyMap,
-        bool soloPlaybackMode, bool exportMetronome,
-        float projectFirstBeat, float projectLastBeat,
+    void exportClipRelativeMessages(Array<MidiEvent::ExportedMessage> &outMessages,
+        bool exportMetronome, float projectFirstBeat, float projectLastBeat,
         double timeFactor = 1.0) const override;
 
+    // the "virtual" metronome track, the note-ons sorted by beat,
+    // which the transport caches separately from the tracks
+    void exportMetronome(Array<MidiEvent::ExportedMessage> &outMessages,
+        float projectFirstBeat, float projectLastBeat) const;
+
     //===------------------------------------------------------------------===//
     // Undoable track editing
     //===------------------------------------------------------------------===//
@@ -35,6 +35,12 @@ public:
     int64 getUpdateTime() const noexcept { return DTO_PROPERTY(Projects::updatedAt); }
     Array<RevisionDto> getRevisions() const { return DTO_CHILDREN(RevisionDto, Revisions::revisions); }
 
+    bool supportsCompactRevisions() const
+    {
+        const auto formats = DTO_PROPERTY(Projects::revisionFormats);
+        return formats.toString().contains(Serialization::Api::V1::Revisions::compactData.toString());
+    }
+
     JUCE_LEAK_DETECTOR(ProjectDto)
 };
 
@@ -47,6 +47,7 @@ namespace Routes
         static const String session = "/my/sessions/:deviceId";
         static const String projects = "/my/projects";
         static const String project = "/my/projects/:projectId";
+        static const String projectRevisions = "/my/projects/:projectId/revisions";
         static const String projectRevision = "/my/projects/:projectId/revisions/:revisionId";
     }
 
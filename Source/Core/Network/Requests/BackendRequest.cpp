@@ -75,6 +75,16 @@ const String BackendRequest::Response::getRedirect() const noexcept
     return this->headers.getValue("location", {});
 }
 
+const String BackendRequest::Response::getEntityTag() const noexcept
+{
+    return this->headers.getValue("etag", {});
+}
+
+int64 BackendRequest::Response::getBodySize() const noexcept
+{
+    return this->bodySize;
+}
+
 BackendRequest::BackendRequest(const String &apiEndpoint) :
     apiEndpoint(apiEndpoint),
     serializer(true) {}
@@ -93,6 +103,13 @@ static String getHeaders()
         << "Content-Type: " << apiVersion1
         << "\r\n"
         << "User-Agent: " << userAgent
+        << "\r\n"
+        // the platform http stack reuses the connection to api host
+        // for the subsequent requests, if the server agrees to that
+        << "Connection: keep-alive"
+        << "\r\n"
+        // lets the backend know it can serve the compact revision payloads
+        << "X-Revision-Formats: " << Serialization::Api::V1::Revisions::compactData.toString()
         << "\r\n";
 
     const auto &profile = App::Workspace().getUserProfile();
@@ -113,14 +130,31 @@ void BackendRequest::processResponse(BackendRequest::Response &response, InputSt
         return;
     }
 
-    // Try to parse response as JSON object wrapping all properties
-    const String responseBody = stream->readEntireStreamAsString();
-    if (responseBody.isNotEmpty())
+    // Read the body as is, reserving the memory up front if the size is known,
+    // and parse it right from that buffer, without copying it into a string
+    MemoryBlock responseData;
+    const auto contentLength = stream->getTotalLength();
+    if (contentLength > 0)
+    {
+        responseData.ensureSize(size_t(contentLength) + 1);
+    }
+
     {
-        DBG("<< Received " << response.statusCode << " " // << responseBody);
-            << responseBody.substring(0, 128) << (responseBody.length() > 128 ? ".." : ""));
+        MemoryOutputStream out(responseData, false);
+        out.writeFromInputStream(*stream, -1);
+        out.writeByte(0);
+    }
 
-        response.body = this->serializer.loadFromString(responseBody);
+    const auto responseSize = responseData.getSize() - 1;
+    response.bodySize = int64(responseSize);
+    if (responseSize > 0)
+    {
+        const auto *responseBody = static_cast<const char *>(responseData.getData());
+        DBG("<< Received " << response.statusCode << " "
+            << String::fromUTF8(responseBody, int(jmin(responseSize, size_t(128))))
+            << (responseSize > 128 ? ".." : ""));
+
+        response.body = this->serializer.loadFromUTF8(responseBody);
         if (!response.body.isValid())
         {
             response.errors.add(TRANS(I18n::Common::networkError));
@@ -158,8 +192,13 @@ BackendRequest::Response BackendRequest::post(const SerializedData &payload) con
     return this->doRequest(payload, "POST");
 }
 
-BackendRequest::Response BackendRequest::get() const
+BackendRequest::Response BackendRequest::get(const String &ifNoneMatch) const
 {
+    if (ifNoneMatch.isNotEmpty())
+    {
+        return this->doRequest("GET", "If-None-Match: " + ifNoneMatch + "\r\n");
+    }
+
     return this->doRequest("GET");
 }
 
@@ -168,7 +207,7 @@ BackendRequest::Response BackendRequest::del() const
     return this->doRequest("DELETE");
 }
 
-BackendRequest::Response BackendRequest::doRequest(const String &verb) const
+BackendRequest::Response BackendRequest::doRequest(const String &verb, const String &extraHeaders) const
 {
     Response response;
     UniquePointer<InputStream> stream;
@@ -182,7 +221,7 @@ BackendRequest::Response BackendRequest::doRequest(const String &verb) const
         stream = url.createInputStream(
             URL::InputStreamOptions(URL::ParameterHandling::inAddress)
                 .withHttpRequestCmd(verb)
-                .withExtraHeaders(getHeaders())
+                .withExtraHeaders(getHeaders() + extraHeaders)
                 .withConnectionTimeoutMs(BackendRequest::connectionTimeoutMs)
                 .withNumRedirectsToFollow(5)
                 .withResponseHeaders(&response.headers)
@@ -198,20 +237,24 @@ BackendRequest::Response BackendRequest::doRequest(const SerializedData &payload
     Response response;
     UniquePointer<InputStream> stream;
 
-    String jsonPayload;
-    if (this->serializer.saveToString(jsonPayload, payload).failed())
+    MemoryBlock jsonPayload;
     {
-        return response;
+        MemoryOutputStream out(jsonPayload, false);
+        if (this->serializer.saveToStream(out, payload).failed())
+        {
+            return response;
+        }
     }
 
-    const auto url = URL(Routes::Api::baseURL + this->apiEndpoint)
-        .withPOSTData(MemoryBlock(jsonPayload.toRawUTF8(), jsonPayload.getNumBytesAsUTF8()));
+    const auto url = URL(Routes::Api::baseURL + this->apiEndpoint).withPOSTData(jsonPayload);
 
     int i = 0;
     do
     {
-        DBG(">> " << verb << " " << this->apiEndpoint << " " 
-            << jsonPayload.substring(0, 128) + (jsonPayload.length() > 128 ? ".." : ""));
+        DBG(">> " << verb << " " << this->apiEndpoint << " "
+            << String::fromUTF8(static_cast<const char *>(jsonPayload.getData()),
+                int(jmin(jsonPayload.getSize(), size_t(128))))
+            << (jsonPayload.getSize() > 128 ? ".." : ""));
 
         stream = url.createInputStream(
             URL::InputStreamOptions(URL::ParameterHandling::inPostData)
@@ -44,6 +44,8 @@ public:
         const Array<String> &getErrors() const noexcept;
         const SerializedData getBody() const noexcept;
         const String getRedirect() const noexcept;
+        const String getEntityTag() const noexcept;
+        int64 getBodySize() const noexcept;
 
     private:
 
@@ -53,12 +55,15 @@ public:
         Array<String> errors;
 
         int statusCode = 0;
+        int64 bodySize = 0;
         StringPairArray headers;
 
         friend class BackendRequest;
     };
 
-    Response get() const;
+    // if the entity tag is given, the request is conditional,
+    // and the response is 304 with no body when nothing has changed
+    Response get(const String &ifNoneMatch = {}) const;
     Response post(const SerializedData &payload) const;
     Response put(const SerializedData &payload) const;
     Response del() const;
@@ -73,7 +78,7 @@ private:
     String apiEndpoint;
     JsonSerializer serializer;
 
-    Response doRequest(const String &verb) const;
+    Response doRequest(const String &verb, const String &extraHeaders = {}) const;
     Response doRequest(const SerializedData &payload, const String &verb) const;
     void processResponse(Response &response, InputStream *const stream) const;
 
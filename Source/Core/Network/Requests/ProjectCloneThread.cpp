@@ -61,64 +61,120 @@ void ProjectCloneThread::run()
     else if (!this->response.is200())
     {
         DBG("Failed to clone project from remote: " + this->response.getErrors().getFirst());
-        callbackOnMessageThread(ProjectCloneThread, onCloneFailed, self->response.getErrors(), self->projectId);
+        callbackOnMessageThread(ProjectCloneThread, onCloneFailed, self->response.getErrors(), self->projectId, false);
         return;
     }
 
     // the info about what revisions are available remotely will be needed by revision tree:
-    this->vcs->updateRemoteSyncCache(remoteProject.getRevisions());
+    this->vcs->updateRemoteSyncCache(remoteProject.getRevisions(),
+        this->response.getEntityTag());
 
     // build tree(s) of shallow VCS::Revision from newRemoteRevisions list and append them to VCS
     const auto remoteHistory = RevisionsSyncHelpers::constructRemoteTree(remoteProject.getRevisions());
     if (remoteHistory == nullptr)
     {
         DBG("Failed to construct remote history tree");
-        callbackOnMessageThread(ProjectCloneThread, onCloneFailed, {}, self->projectId);
+        callbackOnMessageThread(ProjectCloneThread, onCloneFailed, {}, self->projectId, false);
         return;
     }
 
     this->vcs->replaceHistory(remoteHistory);
 
+    // the head is found before fetching anything, so that the revisions on its path
+    // are fetched first, and the project can be opened as soon as they are here,
+    // while the rest of the history is filling in behind it;
+    // if project's head is null, this will at least point the new head to one of leafs:
+    RevisionsMap remoteRevisions;
+    RevisionsSyncHelpers::buildLocalRevisionsIndex(remoteRevisions, remoteHistory);
+
     this->newHead = nullptr;
+    this->isHeadCheckedOut = false;
 
-    // if anything is needed to pull, fetch all data for each, then update and callback
-    for (const auto &dto : remoteProject.getRevisions())
+    const auto foundHead = remoteRevisions.find(remoteProject.getHead());
+    if (foundHead != remoteRevisions.end())
     {
-        const String revisionRoute(Routes::Api::projectRevision
-            .replace(":projectId", this->projectId)
-            .replace(":revisionId", dto.getId()));
-
-        const BackendRequest revisionRequest(revisionRoute);
-        this->response = revisionRequest.get();
-        if (!this->response.is2xx())
+        this->newHead = foundHead->second;
+    }
+    else
+    {
+        for (const auto &dto : remoteProject.getRevisions())
         {
-            DBG("Failed to fetch revision data: " + this->response.getErrors().getFirst());
-            callbackOnMessageThread(ProjectCloneThread, onCloneFailed, self->response.getErrors(), self->projectId);
-            return;
+            const auto revision = remoteRevisions[dto.getId()];
+            if (revision != nullptr && revision->getChildren().isEmpty())
+            {
+                this->newHead = revision;
+                break;
+            }
         }
+    }
+
+    jassert(this->newHead != nullptr);
 
-        const RevisionDto fullData(this->response.getBody());
-        auto revision = this->vcs->updateShallowRevisionData(fullData.getId(), fullData.getData());
+    Array<String> revisionIds;
+    FlatHashSet<String, StringHash> headPathIds;
+    for (WeakReference<VCS::Revision> it = this->newHead.get(); it != nullptr; it = it->getParent())
+    {
+        revisionIds.insert(0, it->getUuid());
+        headPathIds.insert(it->getUuid());
+    }
 
-        // if project's head is null, this will at least point the new head to one of leafs:
-        if ((this->newHead == nullptr && revision->getChildren().isEmpty()) ||
-            revision->getUuid() == remoteProject.getHead())
+    for (const auto &dto : remoteProject.getRevisions())
+    {
+        if (!headPathIds.contains(dto.getId()))
         {
-            this->newHead = revision;
+            revisionIds.add(dto.getId());
         }
     }
 
-    jassert(this->newHead != nullptr);
+    this->numRevisions = revisionIds.size();
+    this->numRevisionsOnHeadPath = headPathIds.size();
+    this->numFetchedRevisions = 0;
+    this->numBytesReceived = 0;
 
-    // checkout the head revision
-    MessageManager::getInstance()->callFunctionOnMessageThread([](void *ptr) -> void*
+    const auto fetched = RevisionsSyncHelpers::fetchRevisionsData(this->projectId,
+        revisionIds, [this](const RevisionDto &fullData, int64 numBytesReceived)
+        {
+            this->fetchedRevision = fullData;
+            this->numFetchedRevisions++;
+            this->numBytesReceived = numBytesReceived;
+
+            // applied on the message thread, where the project is saved,
+            // because after the checkout the history is already open
+            MessageManager::getInstance()->callFunctionOnMessageThread([](void *ptr) -> void*
+            {
+                auto *self = static_cast<ProjectCloneThread *>(ptr);
+                self->vcs->updateShallowRevisionData(self->fetchedRevision.getId(),
+                    RevisionsSyncHelpers::unpackRevisionData(self->fetchedRevision.getData()));
+
+                if (self->numFetchedRevisions == self->numRevisionsOnHeadPath)
+                {
+                    self->vcs->checkout(self->newHead);
+                    self->isHeadCheckedOut = true;
+                    if (self->onHeadCheckedOut != nullptr)
+                    {
+                        self->onHeadCheckedOut(self->projectId);
+                    }
+                }
+
+                if (self->onCloneProgress != nullptr)
+                {
+                    self->onCloneProgress(self->projectId, self->numFetchedRevisions,
+                        self->numRevisions, self->numBytesReceived, self->isHeadCheckedOut);
+                }
+
+                return nullptr;
+            }, this);
+        }, this->response);
+
+    if (!fetched)
     {
-        auto *self = static_cast<ProjectCloneThread *>(ptr);
-        self->vcs->checkout(self->newHead);
-        return nullptr;
-    }, this);
+        callbackOnMessageThread(ProjectCloneThread, onCloneFailed,
+            self->response.getErrors(), self->projectId, self->isHeadCheckedOut);
+        return;
+    }
 
-    callbackOnMessageThread(ProjectCloneThread, onCloneDone);
+    jassert(this->isHeadCheckedOut);
+    callbackOnMessageThread(ProjectCloneThread, onCloneDone, self->projectId);
 }
 
 #endif
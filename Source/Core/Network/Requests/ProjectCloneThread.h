@@ -30,9 +30,18 @@ public:
     ProjectCloneThread();
     ~ProjectCloneThread() override;
     
-    Function<void()> onCloneDone;
+    Function<void(const String &projectId)> onCloneDone;
     Function<void(const String &projectId)> onProjectMissing;
-    Function<void(const Array<String> &errors, const String &projectId)> onCloneFailed;
+    // if the head is already checked out, the project is usable,
+    // and the rest of the history can be pulled later by sync
+    Function<void(const Array<String> &errors,
+        const String &projectId, bool isHeadCheckedOut)> onCloneFailed;
+
+    // the history is cloned starting from the head's path,
+    // and the project is opened as soon as it's available
+    Function<void(const String &projectId)> onHeadCheckedOut;
+    Function<void(const String &projectId, int numFetchedRevisions,
+        int numRevisions, int64 numBytesReceived, bool isHeadCheckedOut)> onCloneProgress;
 
     void doClone(WeakReference<VersionControl> vcs, const String &projectId);
 
@@ -43,6 +52,13 @@ private:
     String projectId;
     WeakReference<VersionControl> vcs;
     VCS::Revision::Ptr newHead;
+    bool isHeadCheckedOut = false;
+
+    RevisionDto fetchedRevision;
+    int numFetchedRevisions = 0;
+    int numRevisionsOnHeadPath = 0;
+    int numRevisions = 0;
+    int64 numBytesReceived = 0;
 
     BackendRequest::Response response;
 
@@ -17,6 +17,9 @@
 
 #include "Common.h"
 #include "RevisionsSyncHelpers.h"
+#include "BinarySerializer.h"
+#include "Network.h"
+#include "ParallelTasks.h"
 
 #if !NO_NETWORK
 
@@ -134,4 +137,166 @@ VCS::Revision::Ptr RevisionsSyncHelpers::constructRemoteTree(const Array<Revisio
     return root;
 }
 
+SerializedData RevisionsSyncHelpers::unpackRevisionData(const SerializedData &data)
+{
+    namespace ApiKeys = Serialization::Api::V1;
+    if (data.hasProperty(ApiKeys::Revisions::compactData))
+    {
+        SerializedData result(ApiKeys::Revisions::data);
+        result.appendChild(BinarySerializer::unpackFromVar(data.getProperty(ApiKeys::Revisions::compactData)));
+        return result;
+    }
+    else if (data.hasProperty(ApiKeys::Revisions::packedData))
+    {
+        SerializedData result(ApiKeys::Revisions::data);
+        result.appendChild(BinarySerializer::unpackFromVar(data.getProperty(ApiKeys::Revisions::packedData)));
+        return result;
+    }
+
+    return data;
+}
+
+bool RevisionsSyncHelpers::isBatchRequestUnsupported(const BackendRequest::Response &response)
+{
+    // older backends don't have the batch routes
+    return response.is(404) || response.is(405);
+}
+
+struct RevisionFetchBatch final
+{
+    Array<String> ids;
+    Array<RevisionDto> revisions;
+    BackendRequest::Response response;
+    WaitableEvent isDone;
+    int64 numBytesReceived = 0;
+    bool failed = false;
+};
+
+static void fetchRevisionsOneByOne(const String &projectId, RevisionFetchBatch &batch)
+{
+    for (const auto &id : batch.ids)
+    {
+        const String revisionRoute(Routes::Api::projectRevision
+            .replace(":projectId", projectId)
+            .replace(":revisionId", id));
+
+        const BackendRequest revisionRequest(revisionRoute);
+        batch.response = revisionRequest.get();
+        if (!batch.response.is2xx())
+        {
+            batch.failed = true;
+            return;
+        }
+
+        batch.revisions.add(RevisionDto(batch.response.getBody()));
+        batch.numBytesReceived += batch.response.getBodySize();
+    }
+}
+
+static void fetchRevisionsBatch(const String &projectId, RevisionFetchBatch &batch)
+{
+    namespace ApiKeys = Serialization::Api::V1;
+
+    const String batchRoute(Routes::Api::projectRevisions
+        .replace(":projectId", projectId) + "?ids=" + batch.ids.joinIntoString(","));
+
+    const BackendRequest batchRequest(batchRoute);
+    batch.response = batchRequest.get();
+    if (!batch.response.is2xx())
+    {
+        batch.failed = true;
+        return;
+    }
+
+    batch.numBytesReceived = batch.response.getBodySize();
+
+    forEachChildWithType(batch.response.getBody(), child, ApiKeys::Revisions::revisions)
+    {
+        batch.revisions.add(RevisionDto(child));
+    }
+
+    // the response is expected to have all the revisions in the requested order
+    if (batch.revisions.size() != batch.ids.size())
+    {
+        jassertfalse;
+        batch.failed = true;
+    }
+}
+
+bool RevisionsSyncHelpers::fetchRevisionsData(const String &projectId,
+    const Array<String> &revisionIds, const FullRevisionCallback &callback,
+    BackendRequest::Response &failedResponse)
+{
+    OwnedArray<RevisionFetchBatch> batches;
+    for (int i = 0; i < revisionIds.size(); i += RevisionsSyncHelpers::maxRevisionsPerBatch)
+    {
+        auto *batch = batches.add(new RevisionFetchBatch());
+        batch->ids.addArray(revisionIds, i, RevisionsSyncHelpers::maxRevisionsPerBatch);
+    }
+
+    const auto numBatches = batches.size();
+
+    // the batches are picked in order, so when one fails and the rest
+    // are skipped, all the batches before it are already being fetched
+    ParallelTasks fetches(numBatches);
+    Atomic<int> batchesUnsupported = 0;
+    fetches.start([&](int index)
+    {
+        auto *batch = batches.getUnchecked(index);
+        if (batch->ids.size() > 1 && batchesUnsupported.get() == 0)
+        {
+            fetchRevisionsBatch(projectId, *batch);
+            if (batch->failed && isBatchRequestUnsupported(batch->response))
+            {
+                batchesUnsupported = 1;
+                batch->failed = false;
+                batch->numBytesReceived = 0;
+                batch->revisions.clearQuick();
+                fetchRevisionsOneByOne(projectId, *batch);
+            }
+        }
+        else
+        {
+            fetchRevisionsOneByOne(projectId, *batch);
+        }
+
+        if (batch->failed)
+        {
+            fetches.stop();
+        }
+
+        batch->isDone.signal();
+    }, RevisionsSyncHelpers::maxRequestsInFlight);
+
+    // the results are applied in order as soon as they arrive,
+    // and released right away, so that only the ones fetched
+    // ahead of the first pending request are kept in memory
+    bool succeeded = true;
+    int64 numBytesReceived = 0;
+    for (auto *batch : batches)
+    {
+        batch->isDone.wait(-1);
+
+        if (batch->failed)
+        {
+            DBG("Failed to fetch revision data: " + batch->response.getErrors().getFirst());
+            failedResponse = batch->response;
+            succeeded = false;
+            break;
+        }
+
+        numBytesReceived += batch->numBytesReceived;
+        for (const auto &revision : batch->revisions)
+        {
+            callback(revision, numBytesReceived);
+        }
+
+        batch->revisions.clear();
+        batch->response = {};
+    }
+
+    fetches.wait();
+    return succeeded;
+}
+
 #endif
@@ -21,6 +21,7 @@
 
 #include "Revision.h"
 #include "RevisionDto.h"
+#include "BackendRequest.h"
 
 using RevisionsMap = FlatHashMap<String, VCS::Revision::Ptr, StringHash>;
 
@@ -37,6 +38,25 @@ struct RevisionsSyncHelpers final
 
     // only used when cloning projects, assuming all revisions will fit in one subtree
     static VCS::Revision::Ptr constructRemoteTree(const Array<RevisionDto> &list);
+
+    // revision deltas are pushed as a single compressed blob, possibly with the
+    // identical delta data shared, but the revisions pushed by older versions
+    // have them as plain nodes, and these are still valid
+    static SerializedData unpackRevisionData(const SerializedData &data);
+
+    // fetches the full data of the given revisions in batches, with a few requests
+    // in flight, and passes them to the callback on the calling thread in the given
+    // order, along with the total size of responses received so far; stops
+    // at the first failed request and returns its response in failedResponse
+    using FullRevisionCallback = Function<void(const RevisionDto &fullRevision, int64 numBytesReceived)>;
+    static bool fetchRevisionsData(const String &projectId,
+        const Array<String> &revisionIds, const FullRevisionCallback &callback,
+        BackendRequest::Response &failedResponse);
+
+    static constexpr auto maxRequestsInFlight = 8;
+    static constexpr auto maxRevisionsPerBatch = 16;
+
+    static bool isBatchRequestUnsupported(const BackendRequest::Response &response);
 };
 
 #endif
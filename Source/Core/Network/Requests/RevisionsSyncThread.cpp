@@ -21,6 +21,7 @@
 #include "RevisionsSyncHelpers.h"
 #include "Workspace.h"
 #include "Network.h"
+#include "BinarySerializer.h"
 
 #if !NO_NETWORK
 
@@ -76,12 +77,25 @@ void RevisionsSyncThread::doSync(WeakReference<VersionControl> vcs,
 
 void RevisionsSyncThread::run()
 {
+    TRACE_ZONE("RevisionsSyncThread::run");
+
     RevisionsMap localRevisions;
     RevisionsSyncHelpers::buildLocalRevisionsIndex(localRevisions, this->vcs->getRoot());
 
     const String projectRoute(ApiRoutes::project.replace(":projectId", this->projectId));
     const BackendRequest revisionsRequest(projectRoute);
-    this->response = revisionsRequest.get();
+
+    // background fetches are conditional, since most of the time
+    // nothing has changed remotely since the last one
+    this->response = revisionsRequest.get(this->fetchOnly ?
+        this->vcs->getRemoteSyncCacheEntityTag() : String());
+
+    if (this->fetchOnly && this->response.is(304))
+    {
+        this->vcs->markRemoteSyncCacheAsUpToDate();
+        callbackOnMessageThread(RevisionsSyncThread, onFetchDone);
+        return;
+    }
 
     const ProjectDto remoteProject(this->response.getBody());
 
@@ -113,8 +127,13 @@ void RevisionsSyncThread::run()
         return;
     }
 
+    // only push the compact payloads if the backend says it can store them,
+    // otherwise other clients of older versions will fail to read them
+    this->useCompactPayloads = remoteProject.supportsCompactRevisions();
+
     // the info about what revisions are available remotely will be needed by revision tree:
-    this->vcs->updateRemoteSyncCache(remoteProject.getRevisions());
+    this->vcs->updateRemoteSyncCache(remoteProject.getRevisions(),
+        this->response.getEntityTag());
     
     using RevisionDtosMap = FlatHashMap<String, RevisionDto, StringHash>;
 
@@ -144,8 +163,21 @@ void RevisionsSyncThread::run()
         }
     }
 
+    // the revisions left shallow by an interrupted clone are known
+    // locally, but their data still has to be pulled
+    Array<String> shallowRevisionsToPull;
+    for (const auto &localRevision : localRevisions)
+    {
+        if (localRevision.second->isShallowCopy() &&
+            remoteRevisions.contains(localRevision.first))
+        {
+            shallowRevisionsToPull.add(localRevision.first);
+        }
+    }
+
     // everything is up to date
-    if (newLocalRevisions.isEmpty() && newRemoteRevisions.isEmpty())
+    if (newLocalRevisions.isEmpty() && newRemoteRevisions.isEmpty() &&
+        shallowRevisionsToPull.isEmpty())
     {
         callbackOnMessageThread(RevisionsSyncThread, onSyncDone, true);
         return;
@@ -181,37 +213,40 @@ void RevisionsSyncThread::run()
         {
             remoteRevisionsToPull.addIfNotAlreadyThere(dto.getId());
         }
+
+        remoteRevisionsToPull.addArray(shallowRevisionsToPull);
     }
 
     // if anything is needed to pull, fetch all data for each, then update and callback
-    for (const auto &revisionId : remoteRevisionsToPull)
-    {
-        const String revisionRoute(ApiRoutes::projectRevision
-            .replace(":projectId", this->projectId)
-            .replace(":revisionId", revisionId));
-
-        const BackendRequest revisionRequest(revisionRoute);
-        this->response = revisionRequest.get();
-        if (!this->response.is2xx())
+    const auto fetched = RevisionsSyncHelpers::fetchRevisionsData(this->projectId,
+        remoteRevisionsToPull, [this](const RevisionDto &fullRevision, int64)
         {
-            DBG("Failed to fetch revision data: " + this->response.getErrors().getFirst());
-            callbackOnMessageThread(RevisionsSyncThread, onSyncFailed, self->response.getErrors());
-            return;
-        }
+            this->vcs->updateShallowRevisionData(fullRevision.getId(),
+                RevisionsSyncHelpers::unpackRevisionData(fullRevision.getData()));
+        }, this->response);
 
-        const RevisionDto fullRevision(this->response.getBody());
-        const auto revision = this->vcs->updateShallowRevisionData(fullRevision.getId(), fullRevision.getData());
+    if (!fetched)
+    {
+        callbackOnMessageThread(RevisionsSyncThread, onSyncFailed, self->response.getErrors());
+        return;
     }
 
     // if anything is needed to push,
     // build tree(s) from newLocalRevisions list
     const auto newLocalTrees = RevisionsSyncHelpers::constructNewLocalTrees(newLocalRevisions);
 
-    // push them recursively, starting from the root, so that
+    // push them in batches, starting from the root, so that
     // each pushed revision already has a valid remote parent
+    ReferenceCountedArray<VCS::Revision> revisionsToPush;
     for (auto *subtree : newLocalTrees)
     {
-        this->pushSubtreeRecursively(subtree);
+        this->collectRevisionsToPush(subtree, revisionsToPush);
+    }
+
+    if (!this->pushRevisions(revisionsToPush))
+    {
+        callbackOnMessageThread(RevisionsSyncThread, onSyncFailed, self->response.getErrors());
+        return;
     }
 
     // finally, update project head ref
@@ -231,43 +266,121 @@ void RevisionsSyncThread::run()
     callbackOnMessageThread(RevisionsSyncThread, onSyncDone, false);
 }
 
-void RevisionsSyncThread::pushSubtreeRecursively(VCS::Revision::Ptr root)
+static SerializedData serializeRevisionForPush(VCS::Revision::Ptr revision,
+    bool compact, const Identifier &nodeType = ApiKeys::Revisions::revision)
+{
+    SerializedData payload(nodeType);
+    payload.setProperty(ApiKeys::Revisions::id, revision->getUuid());
+    payload.setProperty(ApiKeys::Revisions::message, revision->getMessage());
+    payload.setProperty(ApiKeys::Revisions::timestamp, String(revision->getTimeStamp()));
+    payload.setProperty(ApiKeys::Revisions::parentId,
+        (revision->getParent() ? var(revision->getParent()->getUuid()) : var()));
+
+    SerializedData data(ApiKeys::Revisions::data);
+    if (compact)
+    {
+        auto deltas = revision->serializeDeltas();
+        VCS::RevisionItem::shareIdenticalDeltaData(deltas);
+        data.setProperty(ApiKeys::Revisions::compactData, BinarySerializer::packToVar(deltas));
+    }
+    else
+    {
+        data.setProperty(ApiKeys::Revisions::packedData,
+            BinarySerializer::packToVar(revision->serializeDeltas()));
+    }
+
+    payload.appendChild(data);
+
+    return payload;
+}
+
+// parents always come before their children here
+void RevisionsSyncThread::collectRevisionsToPush(VCS::Revision::Ptr root,
+    ReferenceCountedArray<VCS::Revision> &result) const
 {
     // todo debug and fix `push branch` for non-existing remotely project
     if (this->idsToPush.isEmpty() ||
         this->idsToPush.contains(root->getUuid()))
     {
-        const String revisionRoute(ApiRoutes::projectRevision
-            .replace(":projectId", this->projectId)
-            .replace(":revisionId", root->getUuid()));
-
-        SerializedData payload(ApiKeys::Revisions::revision);
-        payload.setProperty(ApiKeys::Revisions::message, root->getMessage());
-        payload.setProperty(ApiKeys::Revisions::timestamp, String(root->getTimeStamp()));
-        payload.setProperty(ApiKeys::Revisions::parentId,
-            (root->getParent() ? var(root->getParent()->getUuid()) : var()));
-
-        SerializedData data(ApiKeys::Revisions::data);
-        data.appendChild(root->serializeDeltas());
-        payload.appendChild(data);
-
-        const BackendRequest revisionRequest(revisionRoute);
-        this->response = revisionRequest.put(payload);
-        if (!this->response.is2xx())
+        result.add(root);
+    }
+
+    for (auto *child : root->getChildren())
+    {
+        this->collectRevisionsToPush(child, result);
+    }
+}
+
+bool RevisionsSyncThread::pushRevisions(const ReferenceCountedArray<VCS::Revision> &revisions)
+{
+    bool batchesUnsupported = false;
+    for (int i = 0; i < revisions.size(); i += RevisionsSyncHelpers::maxRevisionsPerBatch)
+    {
+        const auto numRevisionsInBatch =
+            jmin(RevisionsSyncHelpers::maxRevisionsPerBatch, revisions.size() - i);
+
+        if (!batchesUnsupported && numRevisionsInBatch > 1)
         {
-            DBG("Failed to put revision data: " + this->response.getErrors().getFirst());
-            callbackOnMessageThread(RevisionsSyncThread, onSyncFailed, self->response.getErrors());
-            return;
+            // the batch is a json array of the same revision objects as pushed one by one
+            SerializedData payload(ApiKeys::Revisions::revisions);
+            for (int j = i; j < i + numRevisionsInBatch; ++j)
+            {
+                payload.appendChild(serializeRevisionForPush(revisions.getUnchecked(j),
+                    this->useCompactPayloads, ApiKeys::Revisions::revisions));
+            }
+
+            const BackendRequest batchRequest(ApiRoutes::projectRevisions
+                .replace(":projectId", this->projectId));
+
+            this->response = batchRequest.put(payload);
+            if (this->response.is2xx())
+            {
+                for (int j = i; j < i + numRevisionsInBatch; ++j)
+                {
+                    this->vcs->updateLocalSyncCache(revisions.getUnchecked(j));
+                }
+
+                continue;
+            }
+
+            if (!RevisionsSyncHelpers::isBatchRequestUnsupported(this->response))
+            {
+                DBG("Failed to put revisions batch: " + this->response.getErrors().getFirst());
+                return false;
+            }
+
+            batchesUnsupported = true;
         }
 
-        // notify vcs that revision is available remotely
-        this->vcs->updateLocalSyncCache(root);
+        for (int j = i; j < i + numRevisionsInBatch; ++j)
+        {
+            if (!this->pushRevision(revisions.getUnchecked(j)))
+            {
+                return false;
+            }
+        }
     }
 
-    for (auto *child : root->getChildren())
+    return true;
+}
+
+bool RevisionsSyncThread::pushRevision(VCS::Revision::Ptr revision)
+{
+    const String revisionRoute(ApiRoutes::projectRevision
+        .replace(":projectId", this->projectId)
+        .replace(":revisionId", revision->getUuid()));
+
+    const BackendRequest revisionRequest(revisionRoute);
+    this->response = revisionRequest.put(serializeRevisionForPush(revision, this->useCompactPayloads));
+    if (!this->response.is2xx())
     {
-        this->pushSubtreeRecursively(child);
+        DBG("Failed to put revision data: " + this->response.getErrors().getFirst());
+        return false;
     }
+
+    // notify vcs that revision is available remotely
+    this->vcs->updateLocalSyncCache(revision);
+    return true;
 }
 
 #endif
@@ -45,9 +45,15 @@ public:
 private:
     
     void run() override;
-    void pushSubtreeRecursively(VCS::Revision::Ptr subtree);
+
+    void collectRevisionsToPush(VCS::Revision::Ptr root,
+        ReferenceCountedArray<VCS::Revision> &result) const;
+
+    bool pushRevisions(const ReferenceCountedArray<VCS::Revision> &revisions);
+    bool pushRevision(VCS::Revision::Ptr revision);
     
     bool fetchOnly;
+    bool useCompactPayloads = false;
     String projectId;
     String projectName;
     
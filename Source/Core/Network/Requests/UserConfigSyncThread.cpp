@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "UserConfigSyncThread.h"
 #include "Network.h"
+#include "ParallelTasks.h"
 
 #if !NO_NETWORK
 
@@ -63,27 +64,9 @@ void UserConfigSyncThread::run()
         // need to wait after each operation,
         // so that callback receives target resource object and says signal()
 
-        if (const auto resource = this->resourcesToGet.getLast())
+        if (!this->resourcesToGet.isEmpty())
         {
-            const String configurationRoute(ApiRoutes::customResource
-                .replace(":resourceType", resource->getType())
-                .replace(":resourceId", URL::addEscapeChars(resource->getName(), false)));
-
-            const BackendRequest syncRequest(configurationRoute);
-            this->response = syncRequest.get();
-            if (this->response.is2xx())
-            {
-                callbackOnMessageThread(UserConfigSyncThread, onResourceFetched, { self->response.getBody() });
-            }
-            else
-            {
-                DBG("Failed to update resource: " + this->response.getErrors().getFirst());
-                callbackOnMessageThread(UserConfigSyncThread, onSyncError, self->response.getErrors());
-            }
-
-            this->resourcesToGet.removeObject(resource);
-
-            WaitableEvent::wait();
+            this->fetchPendingConfigurations();
         }
 
         if (const auto resource = this->resourcesToPut.getLast())
@@ -150,6 +133,47 @@ void UserConfigSyncThread::run()
     }
 }
 
+// all pending resources are fetched at once, with a few requests in flight,
+// which is what makes the initial sync on a new machine fast enough,
+// and then passed to the callbacks one by one in the queued order
+void UserConfigSyncThread::fetchPendingConfigurations()
+{
+    const ReferenceCountedArray<SyncedConfigurationInfo> resources(this->resourcesToGet);
+    const auto numResources = resources.size();
+
+    Array<BackendRequest::Response> responses;
+    responses.resize(numResources);
+
+    ParallelTasks::run(numResources, [&](int index)
+    {
+        const auto *resource = resources.getUnchecked(index);
+        const String configurationRoute(ApiRoutes::customResource
+            .replace(":resourceType", resource->getType())
+            .replace(":resourceId", URL::addEscapeChars(resource->getName(), false)));
+
+        const BackendRequest syncRequest(configurationRoute);
+        responses.getReference(index) = syncRequest.get();
+    }, UserConfigSyncThread::maxRequestsInFlight);
+
+    for (int i = 0; i < numResources; ++i)
+    {
+        this->response = responses.getReference(i);
+        if (this->response.is2xx())
+        {
+            callbackOnMessageThread(UserConfigSyncThread, onResourceFetched, { self->response.getBody() });
+        }
+        else
+        {
+            DBG("Failed to update resource: " + this->response.getErrors().getFirst());
+            callbackOnMessageThread(UserConfigSyncThread, onSyncError, self->response.getErrors());
+        }
+
+        this->resourcesToGet.removeObject(resources.getUnchecked(i));
+
+        WaitableEvent::wait();
+    }
+}
+
 bool UserConfigSyncThread::areQueuesEmpty() const
 {
     return this->resourcesToGet.isEmpty()
@@ -43,6 +43,9 @@ public:
 private:
 
     void run() override;
+    void fetchPendingConfigurations();
+
+    static constexpr auto maxRequestsInFlight = 8;
 
     ReferenceCountedArray<SyncedConfigurationInfo, CriticalSection> resourcesToGet;
     ReferenceCountedArray<ConfigurationResource, CriticalSection> resourcesToPut;
@@ -21,6 +21,7 @@
 #include "Workspace.h"
 #include "MainLayout.h"
 #include "ProgressTooltip.h"
+#include "ProjectNode.h"
 
 #if !NO_NETWORK
 
@@ -125,17 +126,50 @@ RevisionsSyncThread *ProjectSyncService::prepareFetchRevisionsThread()
     return thread;
 }
 
+// persists the history cloned so far, so that an interrupted clone can be resumed by sync
+static void saveClonedProject(const String &projectId)
+{
+    for (auto *project : App::Workspace().getLoadedProjects())
+    {
+        if (project->getId() == projectId)
+        {
+            project->getDocument()->autosave();
+            return;
+        }
+    }
+}
+
 ProjectCloneThread *ProjectSyncService::prepareProjectCloneThread()
 {
     auto *thread = this->getNewThreadFor<ProjectCloneThread>();
     
-    thread->onCloneDone = []()
+    thread->onCloneDone = [](const String &projectId)
     {
+        saveClonedProject(projectId);
         App::Layout().showTooltip({}, MainLayout::TooltipIcon::Success);
-        // do nothing? VCS will sendChangeMessage
+        // VCS will sendChangeMessage
         // and views will update themselves on the message thread
     };
 
+    thread->onHeadCheckedOut = [](const String &projectId)
+    {
+        // the progress indicator is modal, but the project is usable now
+        App::dismissAllModalComponents();
+    };
+
+    thread->onCloneProgress = [](const String &projectId, int numFetchedRevisions,
+        int numRevisions, int64 numBytesReceived, bool isHeadCheckedOut)
+    {
+        App::Layout().showTooltip(String(numFetchedRevisions) + " / " + String(numRevisions) +
+            ", " + File::descriptionOfSizeInBytes(numBytesReceived));
+
+        constexpr auto numRevisionsPerSave = 25;
+        if (isHeadCheckedOut && numFetchedRevisions % numRevisionsPerSave == 0)
+        {
+            saveClonedProject(projectId);
+        }
+    };
+
     thread->onProjectMissing = [](const String &projectId)
     {
         // unload and delete the stub, remove remote info
@@ -144,9 +178,18 @@ ProjectCloneThread *ProjectSyncService::prepareProjectCloneThread()
         workspace.getUserProfile().onProjectRemoteInfoReset(projectId);
     };
 
-    thread->onCloneFailed = [](const Array<String> &errors, const String &projectId)
+    thread->onCloneFailed = [](const Array<String> &errors,
+        const String &projectId, bool isHeadCheckedOut)
     {
         App::Layout().showTooltip(errors.getFirst(), MainLayout::TooltipIcon::Failure);
+
+        if (isHeadCheckedOut)
+        {
+            // keep what is fetched, the sync will pull the rest
+            saveClonedProject(projectId);
+            return;
+        }
+
         // now find project stub by id, unload and delete it locally
         App::Workspace().unloadProject(projectId, true, false);
     };
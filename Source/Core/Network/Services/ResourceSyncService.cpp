@@ -135,8 +135,7 @@ UpdatesCheckThread *ResourceSyncService::prepareUpdatesCheckThread()
     thread->onUpdatesCheckOk = [this](const AppInfoDto info)
     {
         // check if any available resource has a hash different from stored one
-        // then start threads to fetch those resources (with somewhat random delays)
-        Random r;
+        // then start threads to fetch those resources, each runs in parallel
         AppInfoDto lastUpdatesInfo;
         App::Config().load(&lastUpdatesInfo, Serialization::Config::lastUpdatesInfo);
         bool everythingIsUpToDate = true;
@@ -144,9 +143,7 @@ UpdatesCheckThread *ResourceSyncService::prepareUpdatesCheckThread()
         {
             if (lastUpdatesInfo.resourceSeemsOutdated(newResource))
             {
-                // I just don't want to fire all requests at once:
-                const auto delay = r.nextInt(5) * 1000;
-                this->prepareResourceRequestThread()->requestResource(newResource.getType(), delay);
+                this->prepareResourceRequestThread()->requestResource(newResource.getType(), 0);
                 everythingIsUpToDate = false;
             }
         }
@@ -0,0 +1,92 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "ParallelTasks.h"
+
+ParallelTasks::ParallelTasks(int numTasks) noexcept :
+    numTasks(numTasks) {}
+
+ParallelTasks::~ParallelTasks()
+{
+    this->stop();
+    this->wait();
+}
+
+void ParallelTasks::start(const Task &newTask, int numWorkers)
+{
+    jassert(this->task == nullptr);
+    this->task = newTask;
+
+    numWorkers = jmin(numWorkers, this->numTasks);
+    if (numWorkers <= 0)
+    {
+        return;
+    }
+
+    this->threadPool = make<ThreadPool>(numWorkers);
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        this->threadPool->addJob([this]()
+        {
+            this->runPendingTasks();
+            return ThreadPoolJob::jobHasFinished;
+        });
+    }
+}
+
+void ParallelTasks::wait()
+{
+    this->runPendingTasks();
+
+    if (this->threadPool != nullptr)
+    {
+        this->threadPool->removeAllJobs(false, -1);
+    }
+}
+
+void ParallelTasks::stop() noexcept
+{
+    this->stopped = true;
+}
+
+void ParallelTasks::runPendingTasks()
+{
+    if (this->task == nullptr)
+    {
+        return;
+    }
+
+    while (!this->stopped.get())
+    {
+        const auto index = (++this->nextIndex) - 1;
+        if (index >= this->numTasks)
+        {
+            return;
+        }
+
+        this->task(index);
+    }
+}
+
+void ParallelTasks::run(int numTasks, const Task &task, int maxNumThreads)
+{
+    const auto numThreads = maxNumThreads > 0 ? maxNumThreads : SystemStats::getNumCpus();
+    ParallelTasks tasks(numTasks);
+    tasks.start(task, numThreads - 1);
+    tasks.wait();
+}
@@ -0,0 +1,64 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Runs a task for each index in [0, numTasks) on a few temporary workers,
+// which pick the next pending index until none left, so that a slow task
+// doesn't hold up the rest; the tasks might finish in any order, so each
+// of them is expected to only write its own slot of the results.
+//
+// the calling thread either joins the workers, see run(), or does something
+// else in the meantime, e.g. consumes the results in order as they arrive
+
+class ParallelTasks final
+{
+public:
+
+    using Task = Function<void(int)>;
+
+    explicit ParallelTasks(int numTasks) noexcept;
+    ~ParallelTasks();
+
+    // starts up to numWorkers workers and returns right away
+    void start(const Task &task, int numWorkers);
+
+    // runs the pending tasks on the calling thread too,
+    // then waits for the workers to finish theirs
+    void wait();
+
+    // the workers finish their current tasks, but skip the rest
+    void stop() noexcept;
+
+    // the calling thread and up to maxNumThreads - 1 workers run the tasks,
+    // returns when all of them are done; by default, one thread per CPU
+    static void run(int numTasks, const Task &task, int maxNumThreads = 0);
+
+private:
+
+    void runPendingTasks();
+
+    const int numTasks;
+    Task task;
+
+    Atomic<int> nextIndex = 0;
+    Atomic<bool> stopped = false;
+
+    UniquePointer<ThreadPool> threadPool;
+
+    JUCE_DECLARE_NON_COPYABLE(ParallelTasks)
+};
@@ -0,0 +1,307 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "RealtimeChecks.h"
+
+#if HELIO_REALTIME_CHECKS
+
+#if defined (__GLIBC__)
+#   include <dlfcn.h>
+#   include <pthread.h>
+#   include <sched.h>
+#   include <errno.h>
+#elif JUCE_WINDOWS && defined (_DEBUG)
+#   include <crtdbg.h>
+#else
+#   include <new>
+#endif
+
+// these are plain ints, so that accessing them from the allocator hooks
+// never allocates anything itself, as the dynamic thread-locals would
+static thread_local int realtimeScopeDepth = 0;
+static thread_local bool isReportingRealtimeViolation = false;
+
+RealtimeScope::RealtimeScope() noexcept
+{
+    realtimeScopeDepth++;
+}
+
+RealtimeScope::~RealtimeScope() noexcept
+{
+    realtimeScopeDepth--;
+}
+
+static inline bool isInRealtimeScope() noexcept
+{
+    return realtimeScopeDepth > 0 && !isReportingRealtimeViolation;
+}
+
+// the stacks already reported, so that a violation
+// in the hot path doesn't flood the log every block
+static constexpr auto maxReportedRealtimeViolations = 256;
+static int64 reportedRealtimeViolations[maxReportedRealtimeViolations];
+static int numReportedRealtimeViolations = 0;
+static SpinLock reportedRealtimeViolationsLock;
+
+static void reportRealtimeViolation(const char *what) noexcept
+{
+    // the report itself allocates a lot, which is fine,
+    // since the thread is already off the realtime track anyway
+    isReportingRealtimeViolation = true;
+
+    const auto stackTrace = SystemStats::getStackBacktrace();
+    const auto hash = stackTrace.hashCode64();
+
+    bool isNewViolation = false;
+    bool isLastReported = false;
+
+    {
+        const SpinLock::ScopedLockType sl(reportedRealtimeViolationsLock);
+        if (numReportedRealtimeViolations < maxReportedRealtimeViolations &&
+            std::find(reportedRealtimeViolations,
+                reportedRealtimeViolations + numReportedRealtimeViolations,
+                hash) == reportedRealtimeViolations + numReportedRealtimeViolations)
+        {
+            reportedRealtimeViolations[numReportedRealtimeViolations++] = hash;
+            isNewViolation = true;
+            isLastReported = numReportedRealtimeViolations == maxReportedRealtimeViolations;
+        }
+    }
+
+    if (isNewViolation)
+    {
+        Logger::writeToLog("Realtime violation: " + String(what) + " on the audio thread\n" + stackTrace);
+        if (isLastReported)
+        {
+            Logger::writeToLog("Too many realtime violations, the rest are not reported");
+        }
+    }
+
+    isReportingRealtimeViolation = false;
+}
+
+//===----------------------------------------------------------------------===//
+// Allocator hooks
+//===----------------------------------------------------------------------===//
+
+#if defined (__GLIBC__)
+
+// the executable's definitions take precedence over libc's ones
+// for all the libraries, including JUCE's HeapBlock and libstdc++'s
+// operator new, which both end up here; glibc exports its own
+// implementations under these names, so they are just forwarded
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t num, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void __libc_free(void *ptr);
+}
+
+extern "C" void *malloc(size_t size) __THROW
+{
+    if (isInRealtimeScope())
+    {
+        reportRealtimeViolation("malloc");
+    }
+
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t num, size_t size) __THROW
+{
+    if (isInRealtimeScope())
+    {
+        reportRealtimeViolation("calloc");
+    }
+
+    return __libc_calloc(num, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) __THROW
+{
+    if (isInRealtimeScope())
+    {
+        reportRealtimeViolation("realloc");
+    }
+
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr) __THROW
+{
+    if (ptr != nullptr && isInRealtimeScope())
+    {
+        reportRealtimeViolation("free");
+    }
+
+    __libc_free(ptr);
+}
+
+#elif JUCE_WINDOWS && defined (_DEBUG)
+
+// the debug CRT calls this for the whole heap, including operator new
+static int realtimeAllocHook(int allocType, void *, size_t, int blockType,
+    long, const unsigned char *, int)
+{
+    // the CRT's own blocks are allocated in the debug heap internals
+    if (blockType != _CRT_BLOCK && isInRealtimeScope())
+    {
+        reportRealtimeViolation(allocType == _HOOK_FREE ? "free" :
+            (allocType == _HOOK_REALLOC ? "realloc" : "malloc"));
+    }
+
+    return TRUE;
+}
+
+static const auto previousRealtimeAllocHook = _CrtSetAllocHook(realtimeAllocHook);
+
+#else
+
+// there's no simple way to hook malloc itself here,
+// so only the C++ allocations are checked
+
+void *operator new(std::size_t size)
+{
+    if (isInRealtimeScope())
+    {
+        reportRealtimeViolation("operator new");
+    }
+
+    if (auto *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    if (isInRealtimeScope())
+    {
+        reportRealtimeViolation("operator new");
+    }
+
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &nothrow) noexcept
+{
+    return ::operator new(size, nothrow);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr != nullptr && isInRealtimeScope())
+    {
+        reportRealtimeViolation("operator delete");
+    }
+
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    ::operator delete(ptr);
+}
+
+#endif
+
+//===----------------------------------------------------------------------===//
+// Lock hooks
+//===----------------------------------------------------------------------===//
+
+#if defined (__GLIBC__)
+
+// CriticalSection, std::mutex and the plugins' locks all end up here;
+// taking a free mutex is cheap and expected, e.g. JUCE's AudioProcessorPlayer
+// does that in every callback, so only the locks which would actually wait
+// for another thread are reported
+
+using MutexLockFunction = int (*)(pthread_mutex_t *);
+static Atomic<MutexLockFunction> nextMutexLock = nullptr;
+static thread_local bool isResolvingMutexLock = false;
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t *mutex) __THROWNL
+{
+    if (isInRealtimeScope())
+    {
+        const auto result = pthread_mutex_trylock(mutex);
+        if (result != EBUSY)
+        {
+            return result;
+        }
+
+        reportRealtimeViolation("blocking mutex lock");
+    }
+
+    auto lock = nextMutexLock.get();
+    if (lock == nullptr)
+    {
+        if (isResolvingMutexLock)
+        {
+            // dlsym might lock something on its own,
+            // and the real function is not known yet
+            int result = 0;
+            while ((result = pthread_mutex_trylock(mutex)) == EBUSY)
+            {
+                sched_yield();
+            }
+
+            return result;
+        }
+
+        isResolvingMutexLock = true;
+        lock = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        isResolvingMutexLock = false;
+        nextMutexLock = lock;
+    }
+
+    return lock(mutex);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Catches the realtime-safety regressions in the audio callbacks:
+// build with HELIO_REALTIME_CHECKS=1 (meant for the debug builds),
+// and put REALTIME_SCOPE() at the beginning of a callback, then any heap
+// allocation or deallocation, and any mutex lock which has to wait for
+// another thread, made by that thread while it's inside the scope,
+// is logged with a stack trace, once per distinct stack;
+// without the flag, the scopes are compiled out completely.
+//
+// the allocator is hooked via the malloc family on Linux, via the CRT
+// debug heap on Windows, and via the global operator new elsewhere;
+// the blocking locks are only detected on Linux
+
+#if !defined HELIO_REALTIME_CHECKS
+#   define HELIO_REALTIME_CHECKS 0
+#endif
+
+#if HELIO_REALTIME_CHECKS
+
+class RealtimeScope final
+{
+public:
+
+    // the scopes can be nested, e.g. the instruments
+    // are processed inside the mixer's callback
+    RealtimeScope() noexcept;
+    ~RealtimeScope() noexcept;
+
+private:
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeScope)
+};
+
+#   define REALTIME_SCOPE() const RealtimeScope JUCE_JOIN_MACRO(realtimeScope, __LINE__)
+
+#else
+
+#   define REALTIME_SCOPE()
+
+#endif
@@ -41,6 +41,8 @@ void Autosaver::changeListenerCallback(ChangeBroadcaster *source)
 
 void Autosaver::timerCallback()
 {
+    TRACE_ZONE("Autosaver::timerCallback");
+
     this->stopTimer();
-    this->documentOwner.getDocument()->save();
+    this->documentOwner.getDocument()->autosave();
 }
@@ -17,46 +17,169 @@
 
 #include "Common.h"
 #include "BinarySerializer.h"
+#include "PackedData.h"
 
 static const char *kHelioHeaderV2String = "Helio2::";
 static const uint64 kHelioHeaderV2 = ByteOrder::littleEndianInt64(kHelioHeaderV2String);
 
-Result BinarySerializer::saveToFile(File file, const SerializedData &tree) const
+// v3 is the same tree, but with a dictionary of all identifiers in the header,
+// so that node types and property names are stored as indices, not as strings
+static const char *kHelioHeaderV3String = "Helio3::";
+static const uint64 kHelioHeaderV3 = ByteOrder::littleEndianInt64(kHelioHeaderV3String);
+
+// the same v3 payload, deflated with zlib; the fastest compression level
+// gives most of the size gain on the repetitive event data, and costs nothing
+// compared to the disk or network time saved
+static const char *kHelioHeaderV3CompressedString = "Helio3z:";
+static const uint64 kHelioHeaderV3Compressed = ByteOrder::littleEndianInt64(kHelioHeaderV3CompressedString);
+static const int kCompressionLevel = 1;
+
+static void writeCompressedPayload(OutputStream &outputStream, const SerializedData &tree)
 {
-    FileOutputStream fileStream(file);
-    if (fileStream.openedOk())
+    GZIPCompressorOutputStream zipStream(outputStream, kCompressionLevel);
+    tree.writeToStreamWithDictionary(zipStream);
+    zipStream.flush();
+}
+
+// inflating everything at once is way faster than reading
+// the tree value by value from the decompressor stream
+static bool readCompressedPayload(InputStream &inputStream, MemoryBlock &outData)
+{
+    GZIPDecompressorInputStream zipStream(inputStream);
+    MemoryOutputStream outputStream(outData, false);
+    outputStream.writeFromInputStream(zipStream, -1);
+    return outputStream.getDataSize() > 0;
+}
+
+static SerializedData readFromStreamWithHeader(InputStream &inputStream)
+{
+    const auto magicNumber = static_cast<uint64>(inputStream.readInt64());
+    if (magicNumber == kHelioHeaderV3Compressed)
+    {
+        MemoryBlock data;
+        if (readCompressedPayload(inputStream, data))
+        {
+            MemoryInputStream dataStream(data, false);
+            return SerializedData::readFromStreamWithDictionary(dataStream);
+        }
+    }
+    else if (magicNumber == kHelioHeaderV3)
     {
-        fileStream.setPosition(0);
-        fileStream.truncate();
-        fileStream.writeInt64(kHelioHeaderV2);
-        tree.writeToStream(fileStream);
-        return Result::ok();
+        return SerializedData::readFromStreamWithDictionary(inputStream);
+    }
+    else if (magicNumber == kHelioHeaderV2)
+    {
+        return SerializedData::readFromStream(inputStream);
     }
 
-    return Result::fail("Failed to save");
+    return {};
 }
 
-SerializedData BinarySerializer::loadFromFile(const File &file) const
+static bool visitStreamWithHeader(InputStream &inputStream, SerializedData::Visitor &visitor)
+{
+    const auto magicNumber = static_cast<uint64>(inputStream.readInt64());
+    if (magicNumber == kHelioHeaderV3Compressed)
+    {
+        MemoryBlock data;
+        if (readCompressedPayload(inputStream, data))
+        {
+            MemoryInputStream dataStream(data, false);
+            return SerializedData::visitStreamWithDictionary(dataStream, visitor);
+        }
+    }
+    else if (magicNumber == kHelioHeaderV3)
+    {
+        return SerializedData::visitStreamWithDictionary(inputStream, visitor);
+    }
+    else if (magicNumber == kHelioHeaderV2)
+    {
+        return SerializedData::visitStream(inputStream, visitor);
+    }
+
+    return false;
+}
+
+// here's the thing: reading from FileInputStream is slow asfuck (at least, on Windows);
+// adding BufferedInputStream bufferedStream(fileStream) - kinda helps, but:
+// ValueTree::readFromStream still calls getTotalLength() quite often, which
+// ends up calling File::getSize(), which, in turn, consumes a lot time.
+
+// so instead we'll map the file into memory and deserialize right from there,
+// without copying the whole file; if mapping fails for whatever reason,
+// fall back to reading the whole file into memory, which is somewhat ugly,
+// but works, and saved files should never be really large anyway.
+static bool readBinaryFile(const File &file, const Function<bool(InputStream &)> &read)
 {
-    // here's the thing: reading from FileInputStream is slow asfuck (at least, on Windows);
-    // adding BufferedInputStream bufferedStream(fileStream) - kinda helps, but:
-    // ValueTree::readFromStream still calls getTotalLength() quite often, which
-    // ends up calling File::getSize(), which, in turn, consumes a lot time.
+    MemoryMappedFile mappedFile(file, MemoryMappedFile::readOnly);
+    if (mappedFile.getData() != nullptr && mappedFile.getSize() > sizeof(uint64))
+    {
+        MemoryInputStream inputStream(mappedFile.getData(), mappedFile.getSize(), false);
+        return read(inputStream);
+    }
 
-    // so instead we'll just read the whole file into memory and deserialize from it;
-    // somewhat ugly, but works, and saved files should never be really large anyway.
     MemoryBlock mb;
     if (file.loadFileAsData(mb))
     {
         MemoryInputStream inputStream(mb, false);
-        const auto magicNumber = static_cast<uint64>(inputStream.readInt64());
-        if (magicNumber == kHelioHeaderV2)
+        return read(inputStream);
+    }
+
+    return false;
+}
+
+BinarySerializer::BinarySerializer(bool useCompression) noexcept :
+    useCompression(useCompression) {}
+
+Result BinarySerializer::saveToFile(File file, const SerializedData &tree) const
+{
+    FileOutputStream fileStream(file, Serializer::fileBufferSize);
+    if (fileStream.openedOk())
+    {
+        // truncating also syncs the file, which is pointless
+        // for the new temporary files most documents are saved to
+        if (fileStream.getPosition() > 0)
+        {
+            fileStream.setPosition(0);
+            fileStream.truncate();
+        }
+
+        if (this->useCompression)
+        {
+            fileStream.writeInt64(kHelioHeaderV3Compressed);
+            writeCompressedPayload(fileStream, tree);
+        }
+        else
         {
-            return SerializedData::readFromStream(inputStream);
+            fileStream.writeInt64(kHelioHeaderV3);
+            tree.writeToStreamWithDictionary(fileStream);
         }
+
+        // the only sync point, before the file is moved in place
+        fileStream.flush();
+        return fileStream.getStatus();
     }
 
-    return {};
+    return Result::fail("Failed to save");
+}
+
+SerializedData BinarySerializer::loadFromFile(const File &file) const
+{
+    SerializedData result;
+    readBinaryFile(file, [&result](InputStream &inputStream)
+    {
+        result = readFromStreamWithHeader(inputStream);
+        return result.isValid();
+    });
+
+    return result;
+}
+
+bool BinarySerializer::visitFile(const File &file, SerializedData::Visitor &visitor) const
+{
+    return readBinaryFile(file, [&visitor](InputStream &inputStream)
+    {
+        return visitStreamWithHeader(inputStream, visitor);
+    });
 }
 
 Result BinarySerializer::saveToString(String &string, const SerializedData &tree) const
@@ -86,5 +209,31 @@ bool BinarySerializer::supportsFileWithExtension(const String &extension) const
 
 bool BinarySerializer::supportsFileWithHeader(const String &header) const
 {
-    return header.startsWith(kHelioHeaderV2String);
+    return header.startsWith(kHelioHeaderV3CompressedString) ||
+        header.startsWith(kHelioHeaderV3String) ||
+        header.startsWith(kHelioHeaderV2String);
+}
+
+//===----------------------------------------------------------------------===//
+// Packing into a var
+//===----------------------------------------------------------------------===//
+
+var BinarySerializer::packToVar(const SerializedData &tree)
+{
+    MemoryOutputStream outputStream;
+    outputStream.writeInt64(kHelioHeaderV3Compressed);
+    writeCompressedPayload(outputStream, tree);
+    return PackedData::toVar(outputStream);
+}
+
+SerializedData BinarySerializer::unpackFromVar(const var &data)
+{
+    MemoryBlock block;
+    if (PackedData::fromVar(data, block) && block.getSize() > sizeof(uint64))
+    {
+        MemoryInputStream inputStream(block, false);
+        return readFromStreamWithHeader(inputStream);
+    }
+
+    return {};
 }
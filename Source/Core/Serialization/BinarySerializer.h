@@ -23,6 +23,10 @@ class BinarySerializer final : public Serializer
 {
 public:
 
+    // compressed files are told apart by their header,
+    // so loading doesn't depend on this flag
+    explicit BinarySerializer(bool useCompression = false) noexcept;
+
     Result saveToFile(File file, const SerializedData &tree) const override;
     SerializedData loadFromFile(const File &file) const override;
 
@@ -32,4 +36,16 @@ public:
     bool supportsFileWithExtension(const String &extension) const override;
     bool supportsFileWithHeader(const String &header) const override;
 
+    // reads the file without building a tree, see SerializedData::Visitor
+    bool visitFile(const File &file, SerializedData::Visitor &visitor) const;
+
+    // the compressed tree as a single binary var, e.g. to be sent over
+    // the network as a part of some other document; see PackedData
+    static var packToVar(const SerializedData &tree);
+    static SerializedData unpackFromVar(const var &data);
+
+private:
+
+    const bool useCompression;
+
 };
@@ -76,6 +76,9 @@ void Document::renameFile(const String &newName)
         return;
     }
 
+    // make sure the incrementally saved changes are not left behind
+    this->save();
+
     const auto safeNewName = File::createLegalFileName(newName).trimCharactersAtEnd(".");
 
     jassert(!this->extension.startsWithChar('.'));
@@ -97,25 +100,34 @@ void Document::renameFile(const String &newName)
 // Save
 //===----------------------------------------------------------------------===//
 
-void Document::save()
+bool Document::canSaveWorkingFile() const
 {
-    if (this->hasChanges &&
-        this->workingFile.getFullPathName().isNotEmpty())
+    const String fullPath = this->workingFile.getFullPathName();
+    if (fullPath.isEmpty())
     {
-        const String fullPath = this->workingFile.getFullPathName();
-        const auto firstCharAfterLastSlash = fullPath.lastIndexOfChar(File::getSeparatorChar()) + 1;
-        const auto lastDot = fullPath.lastIndexOfChar('.');
-        const bool hasEmptyName = (lastDot == firstCharAfterLastSlash);
-        if (hasEmptyName)
-        {
-            return;
-        }
+        return false;
+    }
 
+    const auto firstCharAfterLastSlash = fullPath.lastIndexOfChar(File::getSeparatorChar()) + 1;
+    const auto lastDot = fullPath.lastIndexOfChar('.');
+    const bool hasEmptyName = (lastDot == firstCharAfterLastSlash);
+    return !hasEmptyName;
+}
+
+void Document::save()
+{
+    // whatever is being saved in background, it is outdated now
+    DocumentHelpers::waitForBackgroundSaves();
+
+    if ((this->hasChanges || this->hasIncrementallySavedChanges) &&
+        this->canSaveWorkingFile())
+    {
         const bool savedOk = this->owner.onDocumentSave(this->workingFile);
 
         if (savedOk)
         {
             this->hasChanges = false;
+            this->hasIncrementallySavedChanges = false;
             DBG("Document saved: " + this->workingFile.getFullPathName());
             return;
         }
@@ -124,6 +136,33 @@ void Document::save()
     }
 }
 
+void Document::autosave()
+{
+    if (this->hasChanges && this->canSaveWorkingFile())
+    {
+        WeakReference<Document> weakThis(this);
+        const auto onSaved = [weakThis](bool savedOk)
+        {
+            if (!savedOk && weakThis != nullptr)
+            {
+                // try again the next time
+                weakThis->hasChanges = true;
+                DBG("Document autosave failed: " + weakThis->workingFile.getFullPathName());
+            }
+        };
+
+        bool isIncremental = false;
+        if (this->owner.onDocumentAutosave(this->workingFile, isIncremental, onSaved))
+        {
+            this->hasChanges = false;
+            this->hasIncrementallySavedChanges = isIncremental;
+            return;
+        }
+
+        this->save();
+    }
+}
+
 void Document::exportAs(const String &exportExtension,
     const String &defaultFilenameWithExtension)
 {
@@ -170,6 +209,7 @@ bool Document::load(const File &file)
 
     this->workingFile = file;
     this->hasChanges = false;
+    this->hasIncrementallySavedChanges = false;
 
     if (!this->owner.onDocumentLoad(file))
     {
@@ -43,6 +43,12 @@ public:
     //===------------------------------------------------------------------===//
 
     void save();
+
+    // autosaving tries to save just the recent changes, and in background,
+    // when the owner supports it, see DocumentOwner::onDocumentAutosave,
+    // and falls back to the usual full save otherwise
+    void autosave();
+
     void exportAs(const String &exportExtension,
         const String &defaultFilename = "");
 
@@ -63,9 +69,16 @@ private:
     bool hasChanges = true;
     File workingFile;
 
+    // the changes were saved incrementally, but not into the working file itself,
+    // so the next full save should happen even if nothing has changed since then
+    bool hasIncrementallySavedChanges = false;
+
+    bool canSaveWorkingFile() const;
+
     // async-launched file choosers must have long enough lifetime
     UniquePointer<FileChooser> exportFileChooser;
     UniquePointer<FileChooser> importFileChooser;
 
+    JUCE_DECLARE_WEAK_REFERENCEABLE(Document)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Document)
 };
@@ -22,6 +22,7 @@
 #include "XmlSerializer.h"
 #include "BinarySerializer.h"
 #include "MainLayout.h"
+#include "ParallelTasks.h"
 
 void DocumentHelpers::showFileChooser(UniquePointer<FileChooser> &chooser,
     int flags, Function<void(URL &url)> successCallback)
@@ -197,19 +198,29 @@ File DocumentHelpers::getTempSlot(const String &fileName)
     return getFirstSlot(tempPath, tempPath, fileName);
 }
 
-static const OwnedArray<Serializer> &getSerializers()
+// documents may be loaded from several threads (see ParallelLoader),
+// so this relies on the thread-safe static initialization:
+struct Serializers final
 {
-    static OwnedArray<Serializer> serializers;
-    if (serializers.isEmpty())
+    Serializers()
     {
-        serializers.add(new XmlSerializer());
-        serializers.add(new JsonSerializer());
-        serializers.add(new BinarySerializer());
+        this->list.add(new XmlSerializer());
+        this->list.add(new JsonSerializer());
+        this->list.add(new BinarySerializer());
     }
 
-    return serializers;
+    OwnedArray<Serializer> list;
+};
+
+static const OwnedArray<Serializer> &getSerializers()
+{
+    static const Serializers serializers;
+    return serializers.list;
 }
 
+// only accessed on the message thread, see ParallelLoader
+static FlatHashMap<String, SerializedData, StringHash> preloadedDocuments;
+
 static const Array<Serializer *> getSerializersForExtension(const String &extension)
 {
     Array<Serializer *> result;
@@ -242,6 +253,17 @@ static const Array<Serializer *> getSerializersForHeader(const String &header)
 
 SerializedData DocumentHelpers::load(const File &file)
 {
+    if (!preloadedDocuments.empty())
+    {
+        const auto found = preloadedDocuments.find(file.getFullPathName());
+        if (found != preloadedDocuments.end())
+        {
+            const auto result = found->second;
+            preloadedDocuments.erase(found);
+            return result;
+        }
+    }
+
     if (!file.existsAsFile())
     {
         return {};
@@ -375,3 +397,185 @@ bool DocumentHelpers::TempDocument::deleteTemporaryFile() const
 
     return false;
 }
+
+//===----------------------------------------------------------------------===//
+// Background saves
+//===----------------------------------------------------------------------===//
+
+// the pool is created on demand, and destroyed in the app's shutdown,
+// while JUCE is still alive, not by the static destructors;
+// any saves requested after that are just done right away
+static CriticalSection backgroundSavesLock;
+static UniquePointer<ThreadPool> backgroundSavesPool;
+static bool hasShutDownBackgroundSaves = false;
+
+static void addBackgroundSaveJob(std::function<ThreadPoolJob::JobStatus()> &&job)
+{
+    {
+        const ScopedLock lock(backgroundSavesLock);
+        if (!hasShutDownBackgroundSaves)
+        {
+            if (backgroundSavesPool == nullptr)
+            {
+                backgroundSavesPool = make<ThreadPool>(1);
+            }
+
+            backgroundSavesPool->addJob(move(job));
+            return;
+        }
+    }
+
+    jassertfalse;
+    job();
+}
+
+void DocumentHelpers::saveInBackground(Function<bool()> saveJob, Function<void(bool)> onDone)
+{
+    jassert(saveJob != nullptr);
+    addBackgroundSaveJob([saveJob, onDone]()
+    {
+        const auto savedOk = saveJob();
+        if (onDone != nullptr)
+        {
+            MessageManager::callAsync([onDone, savedOk]() { onDone(savedOk); });
+        }
+
+        return ThreadPoolJob::jobHasFinished;
+    });
+}
+
+struct PendingDocumentSave final : ReferenceCountedObject
+{
+    using Ptr = ReferenceCountedObjectPtr<PendingDocumentSave>;
+
+    Function<bool()> saveJob;
+    Array<Function<void(bool)>> callbacks;
+    bool isFullRewrite = false;
+};
+
+// the last queued job for each document, removed when it's started;
+// both are only accessed under the lock
+static CriticalSection pendingDocumentSavesLock;
+static FlatHashMap<String, PendingDocumentSave::Ptr, StringHash> pendingDocumentSaves;
+
+void DocumentHelpers::saveInBackground(const File &document, bool isFullRewrite,
+    Function<bool()> saveJob, Function<void(bool)> onDone)
+{
+    jassert(saveJob != nullptr);
+    const auto key = document.getFullPathName();
+
+    PendingDocumentSave::Ptr pendingSave;
+
+    {
+        const ScopedLock lock(pendingDocumentSavesLock);
+        auto &lastSave = pendingDocumentSaves[key];
+        if (isFullRewrite && lastSave != nullptr && lastSave->isFullRewrite)
+        {
+            lastSave->saveJob = saveJob;
+            lastSave->callbacks.add(onDone);
+            return;
+        }
+
+        pendingSave = new PendingDocumentSave();
+        pendingSave->saveJob = saveJob;
+        pendingSave->callbacks.add(onDone);
+        pendingSave->isFullRewrite = isFullRewrite;
+        lastSave = pendingSave;
+    }
+
+    addBackgroundSaveJob([key, pendingSave]()
+    {
+        Function<bool()> saveJob;
+        Array<Function<void(bool)>> callbacks;
+
+        {
+            const ScopedLock lock(pendingDocumentSavesLock);
+            const auto found = pendingDocumentSaves.find(key);
+            if (found != pendingDocumentSaves.end() && found->second == pendingSave)
+            {
+                pendingDocumentSaves.erase(found);
+            }
+
+            saveJob = pendingSave->saveJob;
+            callbacks = pendingSave->callbacks;
+        }
+
+        const auto savedOk = saveJob();
+        MessageManager::callAsync([callbacks, savedOk]()
+        {
+            for (const auto &onDone : callbacks)
+            {
+                if (onDone != nullptr)
+                {
+                    onDone(savedOk);
+                }
+            }
+        });
+
+        return ThreadPoolJob::jobHasFinished;
+    });
+}
+
+void DocumentHelpers::waitForBackgroundSaves()
+{
+    ThreadPool *pool = nullptr;
+
+    {
+        const ScopedLock lock(backgroundSavesLock);
+        pool = backgroundSavesPool.get();
+    }
+
+    while (pool != nullptr && pool->getNumJobs() > 0)
+    {
+        Thread::sleep(1);
+    }
+}
+
+void DocumentHelpers::shutdownBackgroundSaves()
+{
+    UniquePointer<ThreadPool> pool;
+
+    {
+        const ScopedLock lock(backgroundSavesLock);
+        hasShutDownBackgroundSaves = true;
+        pool = move(backgroundSavesPool);
+    }
+
+    // no new jobs can be added now, so the queued ones are all finished,
+    // and not dropped, before the pool's thread is stopped
+    while (pool != nullptr && pool->getNumJobs() > 0)
+    {
+        Thread::sleep(1);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// ParallelLoader
+//===----------------------------------------------------------------------===//
+
+DocumentHelpers::ParallelLoader::ParallelLoader(const Array<File> &files)
+{
+    jassert(MessageManager::getInstance()->isThisTheMessageThread());
+
+    Array<SerializedData> results;
+    results.resize(files.size());
+
+    ParallelTasks::run(files.size(), [&](int i)
+    {
+        results.getReference(i) = DocumentHelpers::load(files.getReference(i));
+    });
+
+    for (int i = 0; i < files.size(); ++i)
+    {
+        if (results.getReference(i).isValid())
+        {
+            preloadedDocuments[files.getReference(i).getFullPathName()] = results.getReference(i);
+        }
+    }
+}
+
+DocumentHelpers::ParallelLoader::~ParallelLoader()
+{
+    // whatever hasn't been picked up is not needed anymore
+    preloadedDocuments.clear();
+}
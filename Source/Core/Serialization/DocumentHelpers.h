@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "Serializer.h"
+
 class DocumentHelpers final
 {
 public:
@@ -58,6 +60,18 @@ public:
         return serializer.loadFromStream(stream);
     }
 
+    // for the serializers that need to be configured
+    static bool save(const File &file, const SerializedData &tree, const Serializer &serializer)
+    {
+        TempDocument tempDoc(file);
+        if (serializer.saveToFile(tempDoc.getFile(), tree).wasOk())
+        {
+            return tempDoc.overwriteTargetFileWithTemporary();
+        }
+
+        return false;
+    }
+
     template <typename T>
     static bool save(const File &file, const SerializedData &tree)
     {
@@ -85,6 +99,30 @@ public:
         return false;
     }
 
+    // The saving jobs are run on a single background thread one after another,
+    // in the same order they were requested, so that the later writes into
+    // the same files never get overtaken by earlier ones; onDone is called
+    // on the message thread with the job's result.
+    // The job must not access the model, only the snapshot it has captured:
+    static void saveInBackground(Function<bool()> saveJob, Function<void(bool)> onDone);
+
+    // Same as above, but for the jobs which rewrite the whole document:
+    // if the previous job queued for that document is also a full rewrite,
+    // and it hasn't started yet, it is just replaced with the new one,
+    // and both onDone callbacks get the result of the new one;
+    // the jobs which are not full rewrites, like journal appends,
+    // should use the same document to never be overtaken by these
+    static void saveInBackground(const File &document, bool isFullRewrite,
+        Function<bool()> saveJob, Function<void(bool)> onDone);
+
+    // blocks until all pending background saves are finished,
+    // should be called before any synchronous saving
+    static void waitForBackgroundSaves();
+
+    // finishes all pending background saves and stops the saving thread,
+    // should be called once at the app shutdown, when nothing else is saved
+    static void shutdownBackgroundSaves();
+
     class TempDocument final
     {
     public:
@@ -105,4 +143,21 @@ public:
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TempDocument)
     };
+
+    // Parses the given documents on a few background threads at once,
+    // and while this object exists, DocumentHelpers::load calls for these
+    // files just pick up the parsed trees; it is used to re-open all the
+    // workspace's projects on startup, where the parsing is the heavy part,
+    // but the tree nodes can only be created on the message thread
+    class ParallelLoader final
+    {
+    public:
+
+        explicit ParallelLoader(const Array<File> &files);
+        ~ParallelLoader();
+
+    private:
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParallelLoader)
+    };
 };
@@ -38,6 +38,15 @@ protected:
 
     virtual bool onDocumentLoad(const File &file) = 0;
     virtual bool onDocumentSave(const File &file) = 0;
+
+    // autosaving might be done incrementally, i.e. the recent changes are
+    // saved somewhere next to the file, to be picked up on load and folded
+    // into the document on the next onDocumentSave call, and/or it might be
+    // done on a background thread, see DocumentHelpers::saveInBackground;
+    // returns false if not supported, so that the usual save is done instead,
+    // otherwise sets outIsIncremental, and calls onSaved when finished
+    virtual bool onDocumentAutosave(const File &file, bool &outIsIncremental,
+        Function<void(bool savedOk)> onSaved) { return false; }
     virtual void onDocumentImport(InputStream &stream) = 0;
     virtual bool onDocumentExport(OutputStream &stream) = 0;
 
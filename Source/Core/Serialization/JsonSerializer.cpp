@@ -56,7 +56,24 @@ struct JsonParser final
 
     static Result parseString(const juce_wchar quoteChar, String::CharPointerType &t, String &result)
     {
-        static MemoryOutputStream buffer(256);
+        // fast path for the most common case of strings without escape sequences:
+        // create the string right from the source text, without copying it to the buffer
+        const auto start = t;
+        for (auto end = t;; ++end)
+        {
+            const auto c = *end;
+            if (c == quoteChar)
+            {
+                result = String(start, end);
+                t = end;
+                ++t;
+                return Result::ok();
+            }
+
+            if (c == '\\' || c == 0) { break; }
+        }
+
+        thread_local MemoryOutputStream buffer(256);
         buffer.reset();
 
         for (;;)
@@ -110,6 +127,34 @@ struct JsonParser final
         return Result::ok();
     }
 
+    static Result parseIdentifier(String::CharPointerType &t, Identifier &result)
+    {
+        // object keys are mostly repeated, like property names of every node,
+        // so just look them up in the string pool, without temporary strings
+        for (auto end = t;; ++end)
+        {
+            const auto c = *end;
+            if (c == '"')
+            {
+                result = (end == t) ? Identifier() : Identifier(t, end);
+                t = end;
+                ++t;
+                return Result::ok();
+            }
+
+            if (c == '\\' || c == 0) { break; }
+        }
+
+        String name;
+        const auto r = parseString('"', t, name);
+        if (r.wasOk())
+        {
+            result = name.isEmpty() ? Identifier() : Identifier(name);
+        }
+
+        return r;
+    }
+
     static void findNextNewline(String::CharPointerType &t)
     {
         juce_wchar c = 0;
@@ -295,11 +340,10 @@ private:
             if (c == 0) { return createFail("Unexpected end-of-input in object declaration"); }
             if (c == '"')
             {
-                String nodeNameVar;
-                const auto r = parseString('"', t, nodeNameVar);
+                Identifier nodeName;
+                const auto r = parseIdentifier(t, nodeName);
                 if (r.failed()) { return r; }
 
-                const Identifier nodeName(nodeNameVar);
                 if (nodeName.isValid())
                 {
                     skipCommentsAndWhitespaces(t);
@@ -509,12 +553,17 @@ struct JsonFormatter final
         }
         else if (v.isInt() || v.isInt64())
         {
-            out << v.toString();
+            writeInteger(out, static_cast<int64>(v));
         }
         else if (v.isDouble())
         {
             out << String(static_cast<double> (v), maximumDecimalPlaces);
         }
+        else if (v.isBinaryData())
+        {
+            // base64-encoded, see PackedData::fromVar
+            out << '"' << v.toString() << '"';
+        }
         else
         {
             // Should never hit this point anyway
@@ -523,6 +572,24 @@ struct JsonFormatter final
         }
     }
 
+    static void writeInteger(OutputStream &out, int64 value)
+    {
+        char buffer[24];
+        auto *const end = buffer + numElementsInArray(buffer);
+        auto *p = end;
+
+        auto v = value < 0 ? (0 - static_cast<uint64>(value)) : static_cast<uint64>(value);
+        do
+        {
+            *--p = static_cast<char>('0' + (v % 10));
+            v /= 10;
+        } while (v != 0);
+
+        if (value < 0) { *--p = '-'; }
+
+        out.write(p, static_cast<size_t>(end - p));
+    }
+
     static void writeEscapedChar(OutputStream &out, const unsigned short value)
     {
         out << "\\u" << String::toHexString((int)value).paddedLeft('0', 4);
@@ -532,6 +599,20 @@ struct JsonFormatter final
     {
         for (;;)
         {
+            // plain ascii characters are written in runs, not one by one
+            auto *const runStart = t.getAddress();
+            auto *runEnd = runStart;
+            while (*runEnd >= 32 && *runEnd < 127 && *runEnd != '\"' && *runEnd != '\\')
+            {
+                ++runEnd;
+            }
+
+            if (runEnd != runStart)
+            {
+                out.write(runStart, static_cast<size_t>(runEnd - runStart));
+                t = String::CharPointerType(runEnd);
+            }
+
             auto c = t.getAndAdvance();
 
             switch (c)
@@ -632,14 +713,19 @@ void JsonSerializer::setHeaderComments(StringArray comments) noexcept
 
 Result JsonSerializer::saveToFile(File file, const SerializedData &tree) const
 {
-    FileOutputStream fileStream(file);
+    FileOutputStream fileStream(file, Serializer::fileBufferSize);
     if (fileStream.openedOk())
     {
-        fileStream.setPosition(0);
-        fileStream.truncate();
+        // see the comments in BinarySerializer::saveToFile
+        if (fileStream.getPosition() > 0)
+        {
+            fileStream.setPosition(0);
+            fileStream.truncate();
+        }
 
         JsonFormatter::write(fileStream, tree, this->headerComments, 0, this->allOnOneLine, 6);
-        return Result::ok();
+        fileStream.flush();
+        return fileStream.getStatus();
     }
 
     return Result::fail("Failed to save");
@@ -667,9 +753,25 @@ Result JsonSerializer::saveToString(String &string, const SerializedData &tree)
 }
 
 SerializedData JsonSerializer::loadFromString(const String &string) const
+{
+    return loadFromCharPointer(string.getCharPointer());
+}
+
+Result JsonSerializer::saveToStream(OutputStream &stream, const SerializedData &tree) const
+{
+    JsonFormatter::write(stream, tree, this->headerComments, 0, this->allOnOneLine, 6);
+    return Result::ok();
+}
+
+SerializedData JsonSerializer::loadFromUTF8(const char *nullTerminatedData) const
+{
+    return loadFromCharPointer(String::CharPointerType(nullTerminatedData));
+}
+
+SerializedData JsonSerializer::loadFromCharPointer(String::CharPointerType data)
 {
     SerializedData root(fakeRoot);
-    const auto result = JsonParser::parseObjectOrArray(string.getCharPointer(), root);
+    const auto result = JsonParser::parseObjectOrArray(data, root);
     if (result.wasOk())
     {
         if (root.getNumChildren() == 1 && root.getNumProperties() == 0)
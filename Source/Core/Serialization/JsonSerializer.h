@@ -33,11 +33,17 @@ public:
     Result saveToString(String &string, const SerializedData &tree) const override;
     SerializedData loadFromString(const String &string) const override;
 
+    // these skip the intermediate string copies of large network payloads
+    Result saveToStream(OutputStream &stream, const SerializedData &tree) const;
+    SerializedData loadFromUTF8(const char *nullTerminatedData) const;
+
     bool supportsFileWithExtension(const String &extension) const override;
     bool supportsFileWithHeader(const String &header) const override;
 
 private:
 
+    static SerializedData loadFromCharPointer(String::CharPointerType data);
+
     bool allOnOneLine;
     StringArray headerComments;
 
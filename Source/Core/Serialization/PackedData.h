@@ -0,0 +1,71 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Helpers for storing large homogeneous collections, like notes
+// or automation events, as a single binary blob property instead
+// of a separate tree for each item: the blob is kept as binary var
+// in the binary format, and as base64 string in json and xml
+
+namespace PackedData
+{
+    // zigzag + LEB128, so small deltas of either sign take a single byte
+    inline void writeVarInt(OutputStream &out, int64 value)
+    {
+        auto v = (static_cast<uint64>(value) << 1) ^ static_cast<uint64>(value >> 63);
+        while (v >= 0x80)
+        {
+            out.writeByte(static_cast<char>((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+
+        out.writeByte(static_cast<char>(v));
+    }
+
+    inline int64 readVarInt(InputStream &in)
+    {
+        uint64 v = 0;
+        for (int shift = 0; shift < 64 && !in.isExhausted(); shift += 7)
+        {
+            const auto b = static_cast<uint8>(in.readByte());
+            v |= static_cast<uint64>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+            {
+                break;
+            }
+        }
+
+        return static_cast<int64>(v >> 1) ^ -static_cast<int64>(v & 1);
+    }
+
+    inline var toVar(const MemoryOutputStream &stream)
+    {
+        return var(stream.getData(), stream.getDataSize());
+    }
+
+    inline bool fromVar(const var &value, MemoryBlock &outData)
+    {
+        if (const auto *binary = value.getBinaryData())
+        {
+            outData = *binary;
+            return true;
+        }
+
+        return value.isString() && outData.fromBase64Encoding(value.toString());
+    }
+} // namespace PackedData
@@ -46,6 +46,7 @@ namespace Serialization
         static const Identifier pianoTrack = "pianoTrack";
         static const Identifier automationTrack = "automationTrack";
         static const Identifier projectTimeline = "projectTimeline";
+        static const Identifier projectJournalEntry = "journalEntry";
         static const Identifier filePath = "filePath";
 
         // Properties
@@ -121,6 +122,9 @@ namespace Serialization
         static const Identifier volume = "vol";
         static const Identifier tuplet = "div";
 
+        // all events of a sequence packed into a single blob, see PackedData.h
+        static const Identifier packedEvents = "packed";
+
         static const Identifier mute = "mute";
         static const Identifier solo = "solo";
 
@@ -158,6 +162,8 @@ namespace Serialization
 
         static const Identifier transport = "transport";
         static const Identifier transportSeekBeat = "seekBeat";
+        static const Identifier frozenInstrument = "frozen";
+        static const Identifier frozenStartTimeMs = "startTimeMs";
 
         static const Identifier audioPlugin = "pluginSettings";
 
@@ -181,8 +187,18 @@ namespace Serialization
         static const Identifier midiInputReadjusting = "midiInputReadjusting";
         static const Identifier midiOutputName = "midiOutputName";
         static const Identifier midiOutputId = "midiOutputId";
+        static const Identifier sampleAccuratePlayback = "sampleAccuratePlayback";
+        static const Identifier parallelProcessing = "parallelProcessing";
+        static const Identifier idleSuspension = "idleSuspension";
+        static const Identifier latencyCorrection = "latencyCorrection";
+        static const Identifier stableBufferSizes = "stableBufferSizes";
 
         static const Identifier pluginsList = "plugins";
+        static const Identifier pluginsScanCache = "scanCache";
+        static const Identifier scannedFile = "scannedFile";
+        static const Identifier scannedFilePath = "path";
+        static const Identifier scannedFileModTime = "fileTime";
+        static const Identifier scannedFileSize = "size";
         static const Identifier audioCore = "audioCore";
         static const Identifier orchestra = "orchestra";
 
@@ -232,6 +248,11 @@ namespace Serialization
         static const Identifier colourSchemes = "colourSchemes";
         static const Identifier hotkeySchemes = "hotkeySchemes";
         static const Identifier keyboardMappings = "keyboardMappings";
+
+        static const Identifier resourceCache = "resourceCache";
+        static const Identifier sourceHash = "sourceHash";
+        static const Identifier builtInResource = "builtIn";
+        static const Identifier usersResource = "user";
     }
 
     namespace UI
@@ -254,6 +275,15 @@ namespace Serialization
         static const Identifier positionY = "positionY";
 
         static const Identifier lastRenderPath = "lastRenderPath";
+        static const Identifier lastRenderBlockSize = "lastRenderBlockSize";
+        static const Identifier lastRenderDoublePrecision = "lastRenderDoublePrecision";
+        static const Identifier lastRenderStems = "lastRenderStems";
+        static const Identifier lastRenderBitDepth = "lastRenderBitDepth";
+        static const Identifier lastRenderTail = "lastRenderTail";
+        static const Identifier lastRenderLoopRange = "lastRenderLoopRange";
+        static const Identifier renderWarmUpSeconds = "renderWarmUpSeconds";
+        static const Identifier renderSilenceThresholdDb = "renderSilenceThresholdDb";
+        static const Identifier renderMaxTailSeconds = "renderMaxTailSeconds";
 
         namespace Flags
         {
@@ -398,6 +428,8 @@ namespace Serialization
             static const Identifier title = "title";
             static const Identifier projectId = "id";
             static const Identifier updatedAt = "updatedAt";
+            static const Identifier numTracks = "tracks";
+            static const Identifier numEvents = "events";
         } // namespace RecentProjects
 
         namespace Sessions
@@ -429,6 +461,7 @@ namespace Serialization
 
         static const Identifier remoteCache = "remoteCache";
         static const Identifier remoteCacheSyncTime = "lastSync";
+        static const Identifier remoteCacheEntityTag = "etag";
         static const Identifier remoteRevision = "revision";
         static const Identifier remoteRevisionId = "id";
         static const Identifier remoteRevisionTimeStamp = "ts";
@@ -457,6 +490,10 @@ namespace Serialization
 
         static const Identifier headStateDelta = "headState";
 
+        static const Identifier sharedDeltas = "sharedDeltas";
+        static const Identifier sharedDelta = "sharedDelta";
+        static const Identifier sharedDeltaId = "sharedId";
+
         namespace ProjectInfoDeltas
         {
             static const Identifier projectLicense = "license";
@@ -599,6 +636,9 @@ namespace Serialization
                 static const Identifier alias = "alias";
                 static const Identifier head = "head";
                 static const Identifier updatedAt = "updatedAt";
+                // the revision payload formats the backend can store,
+                // besides the plain data and the packed data
+                static const Identifier revisionFormats = "revisionFormats";
             }
 
             namespace Revisions
@@ -610,6 +650,10 @@ namespace Serialization
                 static const Identifier timestamp = "timestamp";
                 static const Identifier parentId = "parentId";
                 static const Identifier data = "data";
+                static const Identifier packedData = "packed";
+                // same as packed, but the identical delta data
+                // is only stored once, see RevisionItem::shareIdenticalDeltaData
+                static const Identifier compactData = "compact";
             }
         } // namespace V1
     } // namespace Api
@@ -100,6 +100,15 @@ public:
         }
     }
 
+    void removeChild(int index)
+    {
+        if (auto *child = this->children.getObjectPointer(index))
+        {
+            child->parent = nullptr;
+            this->children.remove(index);
+        }
+    }
+
     bool isEquivalentTo(const SharedData &other) const noexcept
     {
         if (this->type != other.type
@@ -153,6 +162,109 @@ public:
         }
     }
 
+    void writeToXmlStream(OutputStream &output, int depth) const
+    {
+        writeXmlIndent(output, depth);
+        output.writeByte('<');
+        writeXmlRaw(output, this->type.toString());
+
+        for (int j = 0; j < this->properties.size(); ++j)
+        {
+            const auto &value = this->properties.getValueAt(j);
+            output.writeByte(' ');
+            if (const auto *binaryData = value.getBinaryData())
+            {
+                output.write("base64:", 7);
+                writeXmlRaw(output, this->properties.getName(j).toString());
+                output.write("=\"", 2);
+                writeXmlRaw(output, binaryData->toBase64Encoding());
+            }
+            else
+            {
+                jassert(!value.isObject() && !value.isArray() && !value.isMethod());
+                writeXmlRaw(output, this->properties.getName(j).toString());
+                output.write("=\"", 2);
+                writeXmlEscaped(output, value.toString());
+            }
+            output.writeByte('"');
+        }
+
+        if (this->children.isEmpty())
+        {
+            output.write("/>\n", 3);
+            return;
+        }
+
+        output.write(">\n", 2);
+
+        for (const auto *c : this->children)
+        {
+            c->writeToXmlStream(output, depth + 1);
+        }
+
+        writeXmlIndent(output, depth);
+        output.write("</", 2);
+        writeXmlRaw(output, this->type.toString());
+        output.write(">\n", 2);
+    }
+
+    static void writeXmlIndent(OutputStream &output, int depth)
+    {
+        output.writeRepeatedByte(' ', size_t(depth) * 2);
+    }
+
+    static void writeXmlRaw(OutputStream &output, const String &text)
+    {
+        output.write(text.toRawUTF8(), text.getNumBytesAsUTF8());
+    }
+
+    // the non-ASCII bytes are written as is, since the text is UTF-8 anyway,
+    // and the unescaped runs are written at once, not byte by byte
+    static void writeXmlEscaped(OutputStream &output, const String &text)
+    {
+        const auto *runStart = text.toRawUTF8();
+        const auto *p = runStart;
+
+        for (;; ++p)
+        {
+            const auto c = uint8(*p);
+            const char *escaped = nullptr;
+            switch (c)
+            {
+                case 0: break;
+                case '&': escaped = "&amp;"; break;
+                case '"': escaped = "&quot;"; break;
+                case '\'': escaped = "&apos;"; break;
+                case '<': escaped = "&lt;"; break;
+                case '>': escaped = "&gt;"; break;
+                default:
+                    if (c >= 32)
+                    {
+                        continue;
+                    }
+                    break;
+            }
+
+            output.write(runStart, size_t(p - runStart));
+
+            if (c == 0)
+            {
+                return;
+            }
+
+            if (escaped != nullptr)
+            {
+                output.write(escaped, strlen(escaped));
+            }
+            else
+            {
+                output << "&#" << int(c) << ';';
+            }
+
+            runStart = p + 1;
+        }
+    }
+
     static void writeObjectToStream(OutputStream &output, const SharedData *data)
     {
         if (data != nullptr)
@@ -167,6 +279,57 @@ public:
         }
     }
 
+    //===------------------------------------------------------------------===//
+    // Dictionary-based format
+    //===------------------------------------------------------------------===//
+
+    // maps identifiers to their indices in the dictionary, starting from 1,
+    // so that 0 can mean an invalid type, same as an empty string does above
+    using IdentifierIndices = FlatHashMap<Identifier, int, IdentifierHash>;
+
+    void collectIdentifiers(IdentifierIndices &indices, Array<Identifier> &dictionary) const
+    {
+        const auto addIdentifier = [&indices, &dictionary](const Identifier &id)
+        {
+            if (indices.find(id) == indices.end())
+            {
+                dictionary.add(id);
+                indices[id] = dictionary.size();
+            }
+        };
+
+        addIdentifier(this->type);
+
+        for (int j = 0; j < this->properties.size(); ++j)
+        {
+            addIdentifier(this->properties.getName(j));
+        }
+
+        for (const auto *c : this->children)
+        {
+            c->collectIdentifiers(indices, dictionary);
+        }
+    }
+
+    void writeToStream(OutputStream &output, const IdentifierIndices &indices) const
+    {
+        output.writeCompressedInt(indices.at(this->type));
+        output.writeCompressedInt(this->properties.size());
+
+        for (int j = 0; j < this->properties.size(); ++j)
+        {
+            output.writeCompressedInt(indices.at(this->properties.getName(j)));
+            this->properties.getValueAt(j).writeToStream(output);
+        }
+
+        output.writeCompressedInt(this->children.size());
+
+        for (const auto *c : this->children)
+        {
+            c->writeToStream(output, indices);
+        }
+    }
+
     const Identifier type;
     NamedValueSet properties;
     ReferenceCountedArray<SharedData> children;
@@ -293,6 +456,12 @@ Identifier SerializedData::getPropertyName(int index) const noexcept
     return this->data->properties.getName(index);
 }
 
+const NamedValueSet &SerializedData::getProperties() const noexcept
+{
+    static const NamedValueSet noProperties;
+    return this->data == nullptr ? noProperties : this->data->properties;
+}
+
 int SerializedData::getNumChildren() const noexcept
 {
     return this->data == nullptr ? 0 : this->data->children.size();
@@ -327,6 +496,12 @@ void SerializedData::appendChild(const SerializedData &child)
     this->data->appendChild(child.data.get());
 }
 
+void SerializedData::removeChild(int index)
+{
+    jassert(this->data != nullptr);
+    this->data->removeChild(index);
+}
+
 SerializedData::Iterator::Iterator(const SerializedData &v, bool isEnd)
     : internal(v.data != nullptr ? (isEnd ? v.data->children.end() : v.data->children.begin()) : nullptr) {}
 
@@ -390,13 +565,46 @@ void SerializedData::writeToStream(OutputStream &output) const
     SharedData::writeObjectToStream(output, this->data.get());
 }
 
+void SerializedData::writeToStreamWithDictionary(OutputStream &output) const
+{
+    SharedData::IdentifierIndices indices;
+    Array<Identifier> dictionary;
+
+    if (this->data != nullptr)
+    {
+        this->data->collectIdentifiers(indices, dictionary);
+    }
+
+    output.writeCompressedInt(dictionary.size());
+    for (const auto &id : dictionary)
+    {
+        output.writeString(id.toString());
+    }
+
+    if (this->data != nullptr)
+    {
+        this->data->writeToStream(output, indices);
+    }
+    else
+    {
+        output.writeCompressedInt(0);
+        output.writeCompressedInt(0);
+        output.writeCompressedInt(0);
+    }
+}
+
+//===----------------------------------------------------------------------===//
+// Visitor
+//===----------------------------------------------------------------------===//
+
 inline static Identifier readIdentifier(InputStream &input)
 {
     // avoid re-allocating a buffer *every* time we read an object or property type
     // (using JUCE's readString() on deserialization sucks really hard);
     // also preallocated size of 32 should be enough for all identifiers I ever use,
-    // and for all string values var::readFromStream() will be called, but far less frequently 
-    static MemoryOutputStream buffer(32);
+    // and for all string values var::readFromStream() will be called, but far less frequently;
+    // the buffer is per thread, since documents can be parsed in parallel
+    thread_local MemoryOutputStream buffer(32);
     buffer.reset();
 
     for (;;)
@@ -411,50 +619,138 @@ inline static Identifier readIdentifier(InputStream &input)
     }
 }
 
-SerializedData SerializedData::readFromStream(InputStream &input)
+template <typename ReadIdentifierFn>
+static bool visitSerializedNode(InputStream &input,
+    SerializedData::Visitor &visitor, const ReadIdentifierFn &readId)
 {
-    const auto type = readIdentifier(input);
+    const auto type = readId(input);
 
-    if (!type.isValid())
+    if (!type.isValid() || !visitor.onNodeStarted(type))
     {
-        return {};
+        return false;
     }
 
-    SerializedData v(type);
-
     const auto numProps = input.readCompressedInt();
 
     for (int i = 0; i < numProps; ++i)
     {
-        const auto propertyType = readIdentifier(input);
+        const auto propertyType = readId(input);
+        auto value = var::readFromStream(input);
 
-        if (propertyType.isValid())
+        if (!propertyType.isValid())
         {
-            v.data->properties.set(propertyType, var::readFromStream(input));
+            jassertfalse;
+            continue;
         }
-        else
+
+        if (!visitor.onProperty(propertyType, move(value)))
         {
-            jassertfalse;
+            return false;
         }
     }
 
     const auto numChildren = input.readCompressedInt();
-    v.data->children.ensureStorageAllocated(numChildren);
 
     for (int i = 0; i < numChildren; ++i)
     {
-        const auto child = readFromStream(input);
+        if (!visitSerializedNode(input, visitor, readId))
+        {
+            return false;
+        }
+    }
+
+    return visitor.onNodeFinished();
+}
+
+bool SerializedData::visitStream(InputStream &input, Visitor &visitor)
+{
+    return visitSerializedNode(input, visitor, readIdentifier);
+}
+
+bool SerializedData::visitStreamWithDictionary(InputStream &input, Visitor &visitor)
+{
+    // all identifiers are only created once per file here,
+    // and then each node just refers to them by their indices
+    Array<Identifier> dictionary;
+
+    const auto numIdentifiers = input.readCompressedInt();
+    if (numIdentifiers < 0)
+    {
+        return false;
+    }
 
-        if (!child.isValid())
+    dictionary.ensureStorageAllocated(numIdentifiers);
+    for (int i = 0; i < numIdentifiers && !input.isExhausted(); ++i)
+    {
+        dictionary.add(readIdentifier(input));
+    }
+
+    return visitSerializedNode(input, visitor, [&dictionary](InputStream &in)
+    {
+        const auto index = in.readCompressedInt();
+        return (index > 0 && index <= dictionary.size()) ?
+            dictionary.getReference(index - 1) : Identifier();
+    });
+}
+
+// builds the tree from the visitor's callbacks; when the stream is malformed,
+// it still returns whatever was read before, same as the old reader did
+class SerializedData::TreeBuilder final : public SerializedData::Visitor
+{
+public:
+
+    bool onNodeStarted(const Identifier &type) override
+    {
+        SharedData::Ptr node(new SharedData(type));
+
+        if (this->stack.isEmpty())
+        {
+            this->root = node;
+        }
+        else
         {
-            return v;
+            this->stack.getLast()->appendChild(node.get());
         }
 
-        v.data->children.add(child.data);
-        child.data->parent = v.data.get();
+        this->stack.add(node.get());
+        return true;
+    }
+
+    bool onProperty(const Identifier &name, var &&value) override
+    {
+        this->stack.getLast()->properties.set(name, move(value));
+        return true;
+    }
+
+    bool onNodeFinished() override
+    {
+        this->stack.removeLast();
+        return true;
+    }
+
+    SerializedData getResult() const noexcept
+    {
+        return SerializedData(this->root);
     }
 
-    return v;
+private:
+
+    SharedData::Ptr root;
+    Array<SharedData *> stack;
+};
+
+SerializedData SerializedData::readFromStream(InputStream &input)
+{
+    TreeBuilder builder;
+    SerializedData::visitStream(input, builder);
+    return builder.getResult();
+}
+
+SerializedData SerializedData::readFromStreamWithDictionary(InputStream &input)
+{
+    TreeBuilder builder;
+    SerializedData::visitStreamWithDictionary(input, builder);
+    return builder.getResult();
 }
 
 SerializedData SerializedData::readFromData(const void *data, size_t numBytes)
@@ -462,3 +758,319 @@ SerializedData SerializedData::readFromData(const void *data, size_t numBytes)
     MemoryInputStream in(data, numBytes, false);
     return readFromStream(in);
 }
+
+//===----------------------------------------------------------------------===//
+// Streaming XML
+//===----------------------------------------------------------------------===//
+
+void SerializedData::writeToXmlStream(OutputStream &output) const
+{
+    jassert(this->data != nullptr);
+    if (this->data != nullptr)
+    {
+        output << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n\n";
+        this->data->writeToXmlStream(output, 0);
+    }
+}
+
+struct XmlTextReader final
+{
+    XmlTextReader(const char *start, size_t numBytes) noexcept :
+        p(start), end(start + numBytes) {}
+
+    const char *p;
+    const char *const end;
+
+    bool isAtEnd() const noexcept { return this->p >= this->end; }
+
+    bool startsWith(const char *prefix) const noexcept
+    {
+        const auto length = strlen(prefix);
+        return size_t(this->end - this->p) >= length && memcmp(this->p, prefix, length) == 0;
+    }
+
+    // moves right after the terminator, returns false if not found
+    bool skipPast(const char *terminator) noexcept
+    {
+        const auto length = strlen(terminator);
+        for (; size_t(this->end - this->p) >= length; ++this->p)
+        {
+            if (memcmp(this->p, terminator, length) == 0)
+            {
+                this->p += length;
+                return true;
+            }
+        }
+
+        this->p = this->end;
+        return false;
+    }
+
+    void skipWhitespace() noexcept
+    {
+        while (this->p < this->end && CharacterFunctions::isWhitespace(*this->p))
+        {
+            ++this->p;
+        }
+    }
+
+    static bool isNameChar(char c) noexcept
+    {
+        return c != '=' && c != '/' && c != '>' && c != '<' &&
+            c != '"' && c != '\'' && !CharacterFunctions::isWhitespace(c);
+    }
+
+    bool readName(const char *&outStart, const char *&outEnd) noexcept
+    {
+        outStart = this->p;
+        while (this->p < this->end && isNameChar(*this->p))
+        {
+            ++this->p;
+        }
+
+        outEnd = this->p;
+        return outEnd > outStart;
+    }
+
+    // only the predefined and the numeric entities are supported
+    static bool decodeEntities(const char *start, const char *finish, String &result)
+    {
+        MemoryOutputStream decoded(size_t(finish - start));
+        const auto *runStart = start;
+        for (const auto *i = start; i < finish; ++i)
+        {
+            if (*i != '&')
+            {
+                continue;
+            }
+
+            decoded.write(runStart, size_t(i - runStart));
+
+            const auto *semicolon = i + 1;
+            while (semicolon < finish && *semicolon != ';')
+            {
+                ++semicolon;
+            }
+
+            if (semicolon >= finish)
+            {
+                return false;
+            }
+
+            const String entity(CharPointer_UTF8(i + 1), CharPointer_UTF8(semicolon));
+            juce_wchar c = 0;
+            if (entity == "amp") { c = '&'; }
+            else if (entity == "quot") { c = '"'; }
+            else if (entity == "apos") { c = '\''; }
+            else if (entity == "lt") { c = '<'; }
+            else if (entity == "gt") { c = '>'; }
+            else if (entity.startsWithChar('#'))
+            {
+                c = (entity[1] == 'x' || entity[1] == 'X') ?
+                    juce_wchar(entity.substring(2).getHexValue32()) :
+                    juce_wchar(entity.substring(1).getIntValue());
+            }
+
+            if (c == 0)
+            {
+                return false;
+            }
+
+            char utf8[8] = {};
+            CharPointer_UTF8 writer(utf8);
+            writer.write(c);
+            decoded.write(utf8, CharPointer_UTF8::getBytesRequiredFor(c));
+
+            i = semicolon;
+            runStart = semicolon + 1;
+        }
+
+        decoded.write(runStart, size_t(finish - runStart));
+        result = decoded.toUTF8();
+        return true;
+    }
+};
+
+bool SerializedData::visitXml(const char *utf8, size_t numBytes, Visitor &visitor)
+{
+    XmlTextReader reader(utf8, numBytes);
+    if (reader.startsWith("\xef\xbb\xbf"))
+    {
+        reader.p += 3;
+    }
+
+    int depth = 0;
+    while (true)
+    {
+        // the text between the elements is ignored
+        while (!reader.isAtEnd() && *reader.p != '<')
+        {
+            ++reader.p;
+        }
+
+        if (reader.isAtEnd())
+        {
+            return false;
+        }
+
+        if (reader.startsWith("<?"))
+        {
+            if (!reader.skipPast("?>")) { return false; }
+        }
+        else if (reader.startsWith("<!--"))
+        {
+            if (!reader.skipPast("-->")) { return false; }
+        }
+        else if (reader.startsWith("<![CDATA["))
+        {
+            if (!reader.skipPast("]]>")) { return false; }
+        }
+        else if (reader.startsWith("<!"))
+        {
+            // a doctype with the internal subset may declare entities
+            const auto *closing = reader.p;
+            while (closing < reader.end && *closing != '>' && *closing != '[')
+            {
+                ++closing;
+            }
+
+            if (closing >= reader.end || *closing == '[') { return false; }
+            reader.p = closing + 1;
+        }
+        else if (reader.startsWith("</"))
+        {
+            if (!reader.skipPast(">") || depth == 0 || !visitor.onNodeFinished())
+            {
+                return false;
+            }
+
+            if (--depth == 0)
+            {
+                return true;
+            }
+        }
+        else
+        {
+            ++reader.p;
+            const char *nameStart = nullptr;
+            const char *nameEnd = nullptr;
+            if (!reader.readName(nameStart, nameEnd) ||
+                !visitor.onNodeStarted(Identifier(CharPointer_UTF8(nameStart), CharPointer_UTF8(nameEnd))))
+            {
+                return false;
+            }
+
+            while (true)
+            {
+                reader.skipWhitespace();
+                if (reader.isAtEnd())
+                {
+                    return false;
+                }
+
+                if (reader.startsWith("/>"))
+                {
+                    reader.p += 2;
+                    if (!visitor.onNodeFinished())
+                    {
+                        return false;
+                    }
+
+                    if (depth == 0)
+                    {
+                        return true;
+                    }
+
+                    break;
+                }
+
+                if (*reader.p == '>')
+                {
+                    ++reader.p;
+                    ++depth;
+                    break;
+                }
+
+                if (!reader.readName(nameStart, nameEnd))
+                {
+                    return false;
+                }
+
+                reader.skipWhitespace();
+                if (reader.isAtEnd() || *reader.p != '=')
+                {
+                    return false;
+                }
+
+                ++reader.p;
+                reader.skipWhitespace();
+                if (reader.isAtEnd() || (*reader.p != '"' && *reader.p != '\''))
+                {
+                    return false;
+                }
+
+                const auto quote = *reader.p++;
+                const auto *valueStart = reader.p;
+                while (!reader.isAtEnd() && *reader.p != quote)
+                {
+                    ++reader.p;
+                }
+
+                if (reader.isAtEnd())
+                {
+                    return false;
+                }
+
+                const auto *valueEnd = reader.p++;
+
+                String value;
+                if (std::find(valueStart, valueEnd, '&') == valueEnd)
+                {
+                    value = String(CharPointer_UTF8(valueStart), CharPointer_UTF8(valueEnd));
+                }
+                else if (!XmlTextReader::decodeEntities(valueStart, valueEnd, value))
+                {
+                    return false;
+                }
+
+                // see NamedValueSet::setFromXmlAttributes
+                static constexpr auto base64Prefix = "base64:";
+                const auto prefixLength = strlen(base64Prefix);
+                if (size_t(nameEnd - nameStart) > prefixLength &&
+                    memcmp(nameStart, base64Prefix, prefixLength) == 0)
+                {
+                    MemoryBlock block;
+                    if (block.fromBase64Encoding(value))
+                    {
+                        if (!visitor.onProperty(Identifier(CharPointer_UTF8(nameStart + prefixLength),
+                            CharPointer_UTF8(nameEnd)), var(move(block))))
+                        {
+                            return false;
+                        }
+
+                        continue;
+                    }
+                }
+
+                if (!visitor.onProperty(Identifier(CharPointer_UTF8(nameStart),
+                    CharPointer_UTF8(nameEnd)), var(move(value))))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+}
+
+SerializedData SerializedData::readFromXmlData(const void *data, size_t numBytes)
+{
+    // unlike the binary readers, a malformed document is not read partially,
+    // same as XmlDocument would do
+    TreeBuilder builder;
+    if (SerializedData::visitXml(static_cast<const char *>(data), numBytes, builder))
+    {
+        return builder.getResult();
+    }
+
+    return {};
+}
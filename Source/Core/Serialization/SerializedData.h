@@ -50,21 +50,68 @@ public:
     int getNumProperties() const noexcept;
     Identifier getPropertyName(int index) const noexcept;
 
+    // Iterates the properties once, which is cheaper than looking up
+    // each known property by name, e.g. for the events deserialized
+    // by thousands; the names are interned, so comparing them with
+    // the known identifiers only compares the pointers
+    template <typename Callback>
+    void forEachProperty(Callback &&callback) const
+    {
+        for (const auto &property : this->getProperties())
+        {
+            callback(property.name, property.value);
+        }
+    }
+
     int getNumChildren() const noexcept;
     SerializedData getChild(int index) const;
     SerializedData getChildWithName(const Identifier &type) const;
     void addChild(const SerializedData &child, int index);
     void appendChild(const SerializedData &child);
+    void removeChild(int index);
 
     SerializedData getParent() const noexcept;
 
     UniquePointer<XmlElement> writeToXml() const;
     static SerializedData readFromXml(const XmlElement &xml);
 
+    // same as above, but written and parsed right from the UTF-8 text,
+    // without building the whole XmlElement tree in between;
+    // the binary properties are saved as base64, same as JUCE does
+    void writeToXmlStream(OutputStream &output) const;
+    static SerializedData readFromXmlData(const void *data, size_t numBytes);
+
     void writeToStream(OutputStream &output) const;
     static SerializedData readFromStream(InputStream &input);
     static SerializedData readFromData(const void *data, size_t numBytes);
 
+    // same as above, but all types and property names are written once
+    // in a dictionary header, and nodes only refer to them by indices
+    void writeToStreamWithDictionary(OutputStream &output) const;
+    static SerializedData readFromStreamWithDictionary(InputStream &input);
+
+    // SAX-style reading of both binary formats above, without building a tree:
+    // the visitor receives nodes and their properties in the document order,
+    // and returning false from any callback stops reading the stream
+    struct Visitor
+    {
+        virtual ~Visitor() = default;
+        virtual bool onNodeStarted(const Identifier &type) = 0;
+        virtual bool onProperty(const Identifier &name, var &&value) = 0;
+        virtual bool onNodeFinished() = 0;
+    };
+
+    // these return true if the whole document has been read
+    static bool visitStream(InputStream &input, Visitor &visitor);
+    static bool visitStreamWithDictionary(InputStream &input, Visitor &visitor);
+
+    // only the elements and the attributes are visited, the text,
+    // comments and processing instructions are skipped; anything it
+    // doesn't support, like the DTD entities, is reported as malformed;
+    // the text is always read as UTF-8, whatever the declaration says,
+    // see XmlSerializer for the documents in other encodings
+    static bool visitXml(const char *utf8, size_t numBytes, Visitor &visitor);
+
     struct Iterator final
     {
         Iterator(const SerializedData &, bool isEnd);
@@ -91,6 +138,10 @@ private:
 
     class SharedData;
     ReferenceCountedObjectPtr<SharedData> data;
+
+    const NamedValueSet &getProperties() const noexcept;
+
+    class TreeBuilder;
     
     friend class SharedData;
     explicit SerializedData(ReferenceCountedObjectPtr<SharedData>) noexcept;
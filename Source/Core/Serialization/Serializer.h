@@ -35,4 +35,8 @@ public:
     virtual bool supportsFileWithExtension(const String &extension) const = 0;
     virtual bool supportsFileWithHeader(const String &header) const = 0;
 
+    // larger than the default, so that the writes to the slow disks
+    // and the cloud-synced folders come in fewer and larger chunks
+    static constexpr auto fileBufferSize = 64 * 1024;
+
 };
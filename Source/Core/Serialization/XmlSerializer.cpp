@@ -18,32 +18,64 @@
 #include "Common.h"
 #include "XmlSerializer.h"
 
-static const String xmlEncoding = "UTF-8";
-
-static XmlElement::TextFormat getXmlFormat()
+// returns the encoding from the xml declaration, if any
+static String getDeclaredXmlEncoding(const void *data, size_t numBytes)
 {
-    static XmlElement::TextFormat format;
-    format.dtd = {};
-    format.lineWrapLength = 120;
-    format.customEncoding = xmlEncoding;
-    return format;
+    static constexpr size_t maxDeclarationSize = 256;
+    const auto declaration = String::createStringFromData(data,
+        int(jmin(numBytes, maxDeclarationSize)));
+
+    if (!declaration.startsWith("<?xml"))
+    {
+        return {};
+    }
+
+    const auto attributes = declaration.upToFirstOccurrenceOf("?>", false, false);
+    const auto encoding = attributes.fromFirstOccurrenceOf("encoding", false, false)
+        .fromFirstOccurrenceOf("=", false, false).trimStart();
+
+    return encoding.substring(1).upToFirstOccurrenceOf(encoding.substring(0, 1), false, false);
 }
 
-Result XmlSerializer::saveToFile(File file, const SerializedData &tree) const
+// XmlDocument doesn't care about the declared encoding, it only takes a string,
+// so the latin-1 documents are decoded here; any other encodings are read
+// by String::createStringFromData, i.e. as UTF-8 or UTF-16 with the BOM
+static String decodeXmlText(const void *data, size_t numBytes, const String &encoding)
 {
-    UniquePointer<XmlElement> xml(tree.writeToXml());
-    if (xml != nullptr)
+    if (encoding.equalsIgnoreCase("ISO-8859-1") || encoding.equalsIgnoreCase("latin1"))
     {
-        const auto saved = xml->writeTo(file, getXmlFormat());
-        return saved ? Result::ok() : Result::fail({});
+        HeapBlock<juce_wchar> chars(numBytes + 1, true);
+        for (size_t i = 0; i < numBytes; ++i)
+        {
+            chars[i] = juce_wchar(static_cast<const uint8 *>(data)[i]);
+        }
+
+        return String(CharPointer_UTF32(chars.get()));
     }
 
-    return Result::fail({});
+    return String::createStringFromData(data, int(numBytes));
 }
 
-SerializedData XmlSerializer::loadFromFile(const File &file) const
+// the documents are written and parsed without the XmlElement tree,
+// so that large ones don't need a second copy of the whole tree in memory;
+// the JUCE's parser is only used as a fallback for the documents
+// in other encodings or with the features not supported here
+static SerializedData readXml(const void *data, size_t numBytes)
 {
-    XmlDocument document(file);
+    const auto encoding = getDeclaredXmlEncoding(data, numBytes);
+    const bool isUtf8 = encoding.isEmpty() ||
+        encoding.equalsIgnoreCase("UTF-8") || encoding.equalsIgnoreCase("UTF8");
+
+    if (isUtf8)
+    {
+        auto result = SerializedData::readFromXmlData(data, numBytes);
+        if (result.isValid())
+        {
+            return result;
+        }
+    }
+
+    XmlDocument document(decodeXmlText(data, numBytes, encoding));
     UniquePointer<XmlElement> xml(document.getDocumentElement());
     if (xml != nullptr)
     {
@@ -53,23 +85,76 @@ SerializedData XmlSerializer::loadFromFile(const File &file) const
     return {};
 }
 
+Result XmlSerializer::saveToFile(File file, const SerializedData &tree) const
+{
+    if (!tree.isValid())
+    {
+        return Result::fail({});
+    }
+
+    // like XmlElement::writeTo, writes into a temporary file first,
+    // and only replaces the target when everything is written,
+    // so that a crash or a full disk doesn't leave a truncated config
+    TemporaryFile tempFile(file);
+
+    {
+        FileOutputStream fileStream(tempFile.getFile(), Serializer::fileBufferSize);
+        if (!fileStream.openedOk())
+        {
+            return Result::fail("Failed to save");
+        }
+
+        tree.writeToXmlStream(fileStream);
+        fileStream.flush();
+
+        const auto status = fileStream.getStatus();
+        if (status.failed())
+        {
+            return status;
+        }
+    }
+
+    if (!tempFile.overwriteTargetFileWithTemporary())
+    {
+        return Result::fail("Failed to save");
+    }
+
+    return Result::ok();
+}
+
+SerializedData XmlSerializer::loadFromFile(const File &file) const
+{
+    MemoryMappedFile mappedFile(file, MemoryMappedFile::readOnly);
+    if (mappedFile.getData() != nullptr && mappedFile.getSize() > 0)
+    {
+        return readXml(mappedFile.getData(), mappedFile.getSize());
+    }
+
+    MemoryBlock block;
+    if (file.loadFileAsData(block) && block.getSize() > 0)
+    {
+        return readXml(block.getData(), block.getSize());
+    }
+
+    return {};
+}
+
 Result XmlSerializer::saveToString(String &string, const SerializedData &tree) const
 {
-    UniquePointer<XmlElement> xml(tree.writeToXml());
-    if (xml != nullptr)
+    if (!tree.isValid())
     {
-        string = xml->toString(getXmlFormat());
-        return Result::ok();
+        return Result::fail({});
     }
 
-    return Result::fail({});
+    MemoryOutputStream stream;
+    tree.writeToXmlStream(stream);
+    string = stream.toUTF8();
+    return Result::ok();
 }
 
 SerializedData XmlSerializer::loadFromString(const String &string) const
 {
-    XmlDocument document(string);
-    UniquePointer<XmlElement> xml(document.getDocumentElement());
-    return SerializedData::readFromXml(*xml);
+    return readXml(string.toRawUTF8(), string.getNumBytesAsUTF8());
 }
 
 bool XmlSerializer::supportsFileWithExtension(const String &extension) const
@@ -81,3 +166,143 @@ bool XmlSerializer::supportsFileWithHeader(const String &header) const
 {
     return header.startsWithIgnoreCase("<?xml");
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class XmlSerializerTests final : public UnitTest
+{
+public:
+    XmlSerializerTests() : UnitTest("XML serializer tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        XmlSerializer serializer;
+
+        beginTest("Write and read back");
+        {
+            const String specialChars("a & b \"c\" 'd' <e>\t\r\n\x01");
+            const String unicodeText(CharPointer_UTF8("\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xe6\x97\xa5\xe6\x9c\xac"));
+
+            MemoryBlock binary;
+            for (int i = 0; i < 256; ++i)
+            {
+                binary.append(&i, 1);
+            }
+
+            SerializedData root("root");
+            root.setProperty("special", specialChars);
+            root.setProperty("unicode", unicodeText);
+            root.setProperty("binary", binary);
+            root.setProperty("number", 42);
+
+            SerializedData child("child");
+            child.appendChild(SerializedData("leaf"));
+            root.appendChild(child);
+            root.appendChild(SerializedData("empty"));
+
+            String text;
+            expect(serializer.saveToString(text, root).wasOk());
+            expect(text.contains("a &amp; b &quot;c&quot; &apos;d&apos; &lt;e&gt;&#9;&#13;&#10;&#1;"));
+            expect(text.contains("base64:binary=\""));
+            expect(text.contains(unicodeText));
+
+            // the simple parser should read everything it has written itself
+            const auto result = SerializedData::readFromXmlData(text.toRawUTF8(), text.getNumBytesAsUTF8());
+            expect(result.isValid());
+            expect(result.hasType("root"));
+            expectEquals(result.getProperty("special").toString(), specialChars);
+            expectEquals(result.getProperty("unicode").toString(), unicodeText);
+            expectEquals(int(result.getProperty("number")), 42);
+
+            const auto *resultBinary = result.getProperty("binary").getBinaryData();
+            expect(resultBinary != nullptr && *resultBinary == binary);
+
+            expectEquals(result.getNumChildren(), 2);
+            expect(result.getChild(0).hasType("child"));
+            expectEquals(result.getChild(0).getNumChildren(), 1);
+            expect(result.getChild(0).getChild(0).hasType("leaf"));
+            expect(result.getChild(1).hasType("empty"));
+            expect(result.isEquivalentTo(root));
+        }
+
+        beginTest("Entities");
+        {
+            const auto result = readSimple("<root a=\"&#65;&#x42;&#x42F;&amp;&lt;&gt;&quot;&apos;\" b='\"'/>");
+            expect(result.isValid());
+            expectEquals(result.getProperty("a").toString(),
+                String(CharPointer_UTF8("AB\xd0\xaf&<>\"'")));
+            expectEquals(result.getProperty("b").toString(), String("\""));
+
+            expect(!readSimple("<root a=\"&unknown;\"/>").isValid());
+            expect(!readSimple("<root a=\"&amp\"/>").isValid());
+        }
+
+        beginTest("Self-closing root");
+        {
+            const auto result = readSimple("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n\n<root a=\"1\"/>\n");
+            expect(result.isValid());
+            expect(result.hasType("root"));
+            expectEquals(result.getNumChildren(), 0);
+            expectEquals(int(result.getProperty("a")), 1);
+        }
+
+        beginTest("Comments, processing instructions and doctype");
+        {
+            const auto result = readSimple(CharPointer_UTF8("\xef\xbb\xbf<?xml version=\"1.0\"?>\n"
+                "<!DOCTYPE root>\n"
+                "<!-- a comment with <tags/> -->\n"
+                "<?instruction data?>\n"
+                "<root a=\"1\"><!-- another one --><child b=\"2\"/>text</root>"));
+
+            expect(result.isValid());
+            expect(result.hasType("root"));
+            expectEquals(result.getNumChildren(), 1);
+            expectEquals(int(result.getChild(0).getProperty("b")), 2);
+
+            expect(!readSimple("<root><child></root").isValid());
+            expect(!readSimple("<!-- unterminated <root/>").isValid());
+        }
+
+        beginTest("Fallback to XmlDocument");
+        {
+            // the internal doctype subset is not supported by the simple parser
+            const String text("<!DOCTYPE root [<!ELEMENT root ANY>]>\n<root a=\"1\"><child/></root>");
+            expect(!readSimple(text).isValid());
+
+            const auto result = serializer.loadFromString(text);
+            expect(result.isValid());
+            expect(result.hasType("root"));
+            expectEquals(int(result.getProperty("a")), 1);
+            expectEquals(result.getNumChildren(), 1);
+        }
+
+        beginTest("Declared encoding");
+        {
+            const char latin1[] = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n<root a=\"caf\xe9\"/>";
+
+            const auto file = File::createTempFile(".xml");
+            expect(file.replaceWithData(latin1, strlen(latin1)));
+
+            const auto result = serializer.loadFromFile(file);
+            expect(result.isValid());
+            expectEquals(result.getProperty("a").toString(), String(CharPointer_UTF8("caf\xc3\xa9")));
+
+            file.deleteFile();
+        }
+    }
+
+private:
+
+    static SerializedData readSimple(const String &text)
+    {
+        return SerializedData::readFromXmlData(text.toRawUTF8(), text.getNumBytesAsUTF8());
+    }
+};
+
+static XmlSerializerTests xmlSerializerTests;
+
+#endif
@@ -0,0 +1,139 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "Tracing.h"
+
+#if HELIO_TRACING
+
+struct TraceBuffer final
+{
+    struct Zone final
+    {
+        const char *name;
+        int64 startTicks;
+        int64 endTicks;
+    };
+
+    // when the buffer is full, the newer zones are just dropped
+    static constexpr auto capacity = 1 << 16;
+
+    String threadName;
+    HeapBlock<Zone> zones { TraceBuffer::capacity };
+
+    // only written by the owning thread, and read when saving
+    Atomic<int> numZones = 0;
+};
+
+// the buffers are never deleted before the shutdown,
+// so that the zones of the finished threads are saved too
+static CriticalSection &getTraceBuffersLock()
+{
+    static CriticalSection lock;
+    return lock;
+}
+
+static OwnedArray<TraceBuffer> &getTraceBuffers()
+{
+    static OwnedArray<TraceBuffer> buffers;
+    return buffers;
+}
+
+static TraceBuffer *getTraceBufferForThisThread()
+{
+    // the lock is only taken once per thread, at its first zone
+    thread_local TraceBuffer *buffer = nullptr;
+    if (buffer == nullptr)
+    {
+        auto newBuffer = make<TraceBuffer>();
+        if (auto *thread = Thread::getCurrentThread())
+        {
+            newBuffer->threadName = thread->getThreadName();
+        }
+        else if (MessageManager::existsAndIsCurrentThread())
+        {
+            newBuffer->threadName = "Message thread";
+        }
+        else
+        {
+            newBuffer->threadName = "Thread " +
+                String::toHexString(pointer_sized_int(Thread::getCurrentThreadId()));
+        }
+
+        const ScopedLock lock(getTraceBuffersLock());
+        buffer = getTraceBuffers().add(newBuffer.release());
+    }
+
+    return buffer;
+}
+
+void Tracing::addZone(const char *name, int64 startTicks, int64 endTicks) noexcept
+{
+    auto *buffer = getTraceBufferForThisThread();
+    const auto index = buffer->numZones.get();
+    if (index < TraceBuffer::capacity)
+    {
+        buffer->zones[index] = { name, startTicks, endTicks };
+        buffer->numZones = index + 1;
+    }
+}
+
+bool Tracing::saveChromeTrace(const File &file)
+{
+    MemoryOutputStream out;
+    out << "{\"traceEvents\":[";
+
+    const ScopedLock lock(getTraceBuffersLock());
+    const auto &buffers = getTraceBuffers();
+
+    bool isFirstEvent = true;
+    auto nextEvent = [&out, &isFirstEvent]() -> MemoryOutputStream &
+    {
+        out << (isFirstEvent ? "\n" : ",\n");
+        isFirstEvent = false;
+        return out;
+    };
+
+    auto ticksToMicroseconds = [](int64 ticks)
+    {
+        return String(Time::highResolutionTicksToSeconds(ticks) * 1000000.0, 3);
+    };
+
+    for (int tid = 0; tid < buffers.size(); ++tid)
+    {
+        const auto *buffer = buffers.getUnchecked(tid);
+
+        nextEvent() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":" << JSON::toString(buffer->threadName) << "}}";
+
+        const auto numZones = buffer->numZones.get();
+        for (int i = 0; i < numZones; ++i)
+        {
+            const auto &zone = buffer->zones[i];
+            nextEvent() << "{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << ticksToMicroseconds(zone.startTicks)
+                << ",\"dur\":" << ticksToMicroseconds(zone.endTicks - zone.startTicks) << "}";
+        }
+    }
+
+    out << "\n]}\n";
+
+    DBG("Saving the trace to " + file.getFullPathName());
+    return file.replaceWithData(out.getData(), out.getDataSize());
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Scoped trace zones for profiling the interactions between the threads:
+// build with HELIO_TRACING=1 and put TRACE_ZONE("name") at the beginning
+// of a scope, then the zones are recorded into per-thread buffers without
+// locking, and saved in the Chrome trace format at shutdown, so that
+// the trace can be opened in Perfetto or chrome://tracing;
+// without the flag, the zones are compiled out completely
+
+#if !defined HELIO_TRACING
+#   define HELIO_TRACING 0
+#endif
+
+// Logs how long each of the sequential phases of something took,
+// e.g. the startup steps, so that regressions are visible in the log
+// without a profiler; it's only used in a few places, so it's not
+// compiled out, and the logging itself is a no-op in the release builds
+
+class PhaseLog final
+{
+public:
+
+    explicit PhaseLog(const String &name) noexcept :
+        name(name), startTicks(Time::getHighResolutionTicks()), phaseStartTicks(startTicks) {}
+
+    void endPhase(const char *phase) noexcept
+    {
+        ignoreUnused(phase);
+        const auto ticks = Time::getHighResolutionTicks();
+        DBG(this->name + ": " + phase + " took " +
+            String(Time::highResolutionTicksToSeconds(ticks - this->phaseStartTicks) * 1000.0, 1) + " ms");
+        this->phaseStartTicks = ticks;
+    }
+
+    ~PhaseLog() noexcept
+    {
+        DBG(this->name + ": " + String(Time::highResolutionTicksToSeconds(
+            Time::getHighResolutionTicks() - this->startTicks) * 1000.0, 1) + " ms total");
+    }
+
+private:
+
+    const String name;
+    const int64 startTicks;
+    int64 phaseStartTicks;
+
+    JUCE_DECLARE_NON_COPYABLE(PhaseLog)
+};
+
+#if HELIO_TRACING
+
+class Tracing final
+{
+public:
+
+    // the name is expected to be a string literal,
+    // since only the pointer is stored in the buffer
+    static void addZone(const char *name, int64 startTicks, int64 endTicks) noexcept;
+
+    static bool saveChromeTrace(const File &file);
+
+    class Zone final
+    {
+    public:
+
+        explicit Zone(const char *name) noexcept :
+            name(name), startTicks(Time::getHighResolutionTicks()) {}
+
+        ~Zone() noexcept
+        {
+            Tracing::addZone(this->name, this->startTicks, Time::getHighResolutionTicks());
+        }
+
+    private:
+
+        const char *name;
+        const int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(Zone)
+    };
+};
+
+#   define TRACE_ZONE(name) const Tracing::Zone JUCE_JOIN_MACRO(traceZone, __LINE__)(name)
+
+#else
+
+#   define TRACE_ZONE(name)
+
+#endif
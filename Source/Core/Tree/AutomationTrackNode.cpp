@@ -141,6 +141,8 @@ VCS::DiffLogic *AutomationTrackNode::getDiffLogic() const
 
 void AutomationTrackNode::resetStateTo(const VCS::TrackedItem &newState)
 {
+    this->updateVCSStateVersion();
+
     using namespace Serialization::VCS;
     for (int i = 0; i < newState.getNumDeltas(); ++i)
     {
@@ -208,6 +210,8 @@ SerializedData AutomationTrackNode::serialize() const
 
 void AutomationTrackNode::deserialize(const SerializedData &data)
 {
+    this->updateVCSStateVersion();
+
     this->reset();
 
     this->deserializeVCSUuid(data);
@@ -266,13 +270,31 @@ void AutomationTrackNode::resetControllerDelta(const SerializedData &state)
 
 void AutomationTrackNode::resetEventsDelta(const SerializedData &state)
 {
+    this->updateVCSStateVersion();
+
     jassert(state.hasType(Serialization::VCS::AutoSequenceDeltas::eventsAdded));
     this->getSequence()->reset();
 
-    forEachChildWithType(state, e, Serialization::Midi::automationEvent)
+    Array<AutomationEvent> events;
+    AutomationEvent::unpackEvents(state, events);
+    for (const auto &event : events)
     {
-        this->getSequence()->checkoutEvent<AutomationEvent>(e);
+        this->getSequence()->checkoutEvent<AutomationEvent>(event);
     }
 
     this->getSequence()->updateBeatRange(false);
 }
+
+bool AutomationTrackNode::createEventsFromDelta(const SerializedData &state,
+    OwnedArray<MidiEvent> &outEvents, FlatHashSet<MidiEvent::Id> &outEventIds) const
+{
+    if (!state.hasType(Serialization::VCS::AutoSequenceDeltas::eventsAdded))
+    {
+        return false;
+    }
+
+    Array<AutomationEvent> events;
+    AutomationEvent::unpackEvents(state, events);
+    this->createEvents<AutomationEvent>(events, outEvents, outEventIds);
+    return true;
+}
@@ -56,6 +56,11 @@ public:
     void resetControllerDelta(const SerializedData &state);
     void resetEventsDelta(const SerializedData &state);
 
+protected:
+
+    bool createEventsFromDelta(const SerializedData &state,
+        OwnedArray<MidiEvent> &outEvents, FlatHashSet<MidiEvent::Id> &outEventIds) const override;
+
 private:
 
     UniquePointer<VCS::AutomationTrackDiffLogic> vcsDiffLogic;
@@ -43,7 +43,6 @@ InstrumentNode::InstrumentNode(Instrument *targetInstrument) :
     if (this->instrument != nullptr)
     {
         this->name = this->instrument->getName();
-        this->initInstrumentEditor();
     }
 }
 
@@ -67,6 +66,9 @@ void InstrumentNode::showPage()
         return;
     }
 
+    // the editor lays out the whole plugin graph, so it is only
+    // created when first shown, and then kept until the node is removed
+    this->initInstrumentEditor();
     App::Layout().showPage(this->instrumentEditor.get(), this);
 }
 
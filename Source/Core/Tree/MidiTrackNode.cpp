@@ -49,6 +49,8 @@ void MidiTrackNode::showPage()
 
 void MidiTrackNode::safeRename(const String &newName, bool sendNotifications)
 {
+    this->updateVCSStateVersion();
+
     String fixedName = newName.replace("\\", "/");
 
     while (fixedName.contains("//"))
@@ -68,6 +70,16 @@ String MidiTrackNode::getVCSName() const
     return this->getXPath();
 }
 
+int MidiTrackNode::getVCSStateVersion() const noexcept
+{
+    return this->vcsStateVersion;
+}
+
+void MidiTrackNode::updateVCSStateVersion() noexcept
+{
+    this->vcsStateVersion = VCS::TrackedItem::createVCSStateVersion();
+}
+
 SerializedData MidiTrackNode::serializeClipsDelta() const
 {
     SerializedData tree(Serialization::VCS::PatternDeltas::clipsAdded);
@@ -83,6 +95,8 @@ SerializedData MidiTrackNode::serializeClipsDelta() const
 
 void MidiTrackNode::resetClipsDelta(const SerializedData &state)
 {
+    this->updateVCSStateVersion();
+
     jassert(state.hasType(Serialization::VCS::PatternDeltas::clipsAdded));
 
     this->getPattern()->reset();
@@ -101,6 +115,126 @@ Colour MidiTrackNode::getRevisionDisplayColour() const
     return this->getTrackColour();
 }
 
+// the events are moved as they are, which is the point,
+// and the rest of the state is small enough to be kept serialized
+class MidiTrackNode::VCSStateHolder final : public VCS::TrackedItem::StateHolder
+{
+public:
+
+    explicit VCSStateHolder(const MidiSequence *sequence) :
+        sequence(sequence) {}
+
+    const MidiSequence *const sequence;
+
+    OwnedArray<MidiEvent> events;
+    FlatHashSet<MidiEvent::Id> eventIds;
+
+    // invalid ones are not applied, as with the missing deltas
+    SerializedData path;
+    SerializedData colour;
+    SerializedData instrument;
+    SerializedData timeSignature;
+    SerializedData clips;
+    int controllerNumber = -1;
+};
+
+UniquePointer<VCS::TrackedItem::StateHolder> MidiTrackNode::createStateHolder() const
+{
+    return make<VCSStateHolder>(this->getSequence());
+}
+
+UniquePointer<VCS::TrackedItem::StateHolder> MidiTrackNode::createStateHolder(const VCS::TrackedItem &newState) const
+{
+    using namespace Serialization::VCS;
+
+    auto state = make<VCSStateHolder>(this->getSequence());
+
+    bool hasEvents = false;
+    for (int i = 0; i < newState.getNumDeltas(); ++i)
+    {
+        const auto *newDelta = newState.getDelta(i);
+        auto newDeltaData = newState.getDeltaData(i);
+
+        if (newDelta->hasType(MidiTrackDeltas::trackPath))
+        {
+            state->path = move(newDeltaData);
+        }
+        else if (newDelta->hasType(MidiTrackDeltas::trackColour))
+        {
+            state->colour = move(newDeltaData);
+        }
+        else if (newDelta->hasType(MidiTrackDeltas::trackInstrument))
+        {
+            state->instrument = move(newDeltaData);
+        }
+        else if (newDelta->hasType(MidiTrackDeltas::trackController))
+        {
+            state->controllerNumber = newDeltaData.getProperty(Serialization::VCS::delta);
+        }
+        else if (newDelta->hasType(TimeSignatureDeltas::timeSignaturesChanged))
+        {
+            state->timeSignature = move(newDeltaData);
+        }
+        else if (newDelta->hasType(PatternDeltas::clipsAdded))
+        {
+            state->clips = move(newDeltaData);
+        }
+        else if (this->createEventsFromDelta(newDeltaData, state->events, state->eventIds))
+        {
+            hasEvents = true;
+        }
+    }
+
+    // without the events, the swap would leave the sequence empty,
+    // instead of keeping it as is, so this is left for resetStateTo
+    if (!hasEvents)
+    {
+        return nullptr;
+    }
+
+    return state;
+}
+
+bool MidiTrackNode::swapStateWith(VCS::TrackedItem::StateHolder &holder)
+{
+    auto *state = dynamic_cast<VCSStateHolder *>(&holder);
+    if (state == nullptr || state->sequence != this->getSequence())
+    {
+        jassertfalse; // the events can't be moved to another sequence
+        return false;
+    }
+
+    this->updateVCSStateVersion();
+
+    auto path = this->serializePathDelta();
+    auto colour = this->serializeColourDelta();
+    auto instrument = this->serializeInstrumentDelta();
+    auto timeSignature = this->serializeTimeSignatureDelta();
+    auto clips = this->serializeClipsDelta();
+    const auto controllerNumber = this->controllerNumber;
+
+    if (state->path.isValid()) { this->resetPathDelta(state->path); }
+    if (state->colour.isValid()) { this->resetColourDelta(state->colour); }
+    if (state->instrument.isValid()) { this->resetInstrumentDelta(state->instrument); }
+    if (state->timeSignature.isValid()) { this->resetTimeSignatureDelta(state->timeSignature); }
+    if (state->clips.isValid()) { this->resetClipsDelta(state->clips); }
+
+    if (state->controllerNumber >= 0)
+    {
+        this->setTrackControllerNumber(state->controllerNumber, dontSendNotification);
+    }
+
+    state->path = move(path);
+    state->colour = move(colour);
+    state->instrument = move(instrument);
+    state->timeSignature = move(timeSignature);
+    state->clips = move(clips);
+    state->controllerNumber = controllerNumber;
+
+    this->getSequence()->swapEventsWith(state->events, state->eventIds);
+    return true;
+}
+
 //===----------------------------------------------------------------------===//
 // MidiTrack
 //===----------------------------------------------------------------------===//
@@ -112,6 +246,8 @@ const String &MidiTrackNode::getTrackId() const noexcept
 
 void MidiTrackNode::setTrackId(const String &val)
 {
+    this->updateVCSStateVersion();
+
     this->id = val;
 }
 
@@ -127,6 +263,8 @@ int MidiTrackNode::getTrackChannel() const noexcept
 
 void MidiTrackNode::setTrackName(const String &newName, bool undoable, NotificationType notificationType)
 {
+    this->updateVCSStateVersion();
+
     if (this->getTrackName() == newName)
     {
         return;
@@ -156,6 +294,8 @@ Colour MidiTrackNode::getTrackColour() const noexcept
 
 void MidiTrackNode::setTrackColour(const Colour &val, bool undoable, NotificationType notificationType)
 {
+    this->updateVCSStateVersion();
+
     if (this->colour == val)
     {
         return;
@@ -186,6 +326,8 @@ String MidiTrackNode::getTrackInstrumentId() const noexcept
 
 void MidiTrackNode::setTrackInstrumentId(const String &val, bool undoable, NotificationType notificationType)
 {
+    this->updateVCSStateVersion();
+
     if (this->instrumentId == val)
     {
         return;
@@ -214,6 +356,8 @@ int MidiTrackNode::getTrackControllerNumber() const noexcept
 
 void MidiTrackNode::setTrackControllerNumber(int val, NotificationType notificationType)
 {
+    this->updateVCSStateVersion();
+
     if (this->controllerNumber == val)
     {
         return;
@@ -251,6 +395,8 @@ const TimeSignatureEvent *MidiTrackNode::getTimeSignatureOverride() const noexce
 
 void MidiTrackNode::setTimeSignatureOverride(const TimeSignatureEvent &ts, bool undoable, NotificationType notificationType)
 {
+    this->updateVCSStateVersion();
+
     if (undoable)
     {
         this->getProject()->getUndoStack()->perform(new MidiTrackChangeTimeSignatureAction(*this->getProject(), this->getTrackId(), ts));
@@ -302,6 +448,8 @@ String MidiTrackNode::getXPath() const noexcept
 
 void MidiTrackNode::setXPath(const String &path, bool sendNotifications)
 {
+    this->updateVCSStateVersion();
+
     if (path == this->getXPath() || path.isEmpty())
     {
         return;
@@ -398,6 +546,8 @@ void MidiTrackNode::setXPath(const String &path, bool sendNotifications)
 
 void MidiTrackNode::dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent)
 {
+    this->updateVCSStateVersion();
+
     if (this->lastFoundParent != nullptr)
     {
         this->lastFoundParent->broadcastChangeEvent(oldEvent, newEvent);
@@ -406,6 +556,8 @@ void MidiTrackNode::dispatchChangeEvent(const MidiEvent &oldEvent, const MidiEve
 
 void MidiTrackNode::dispatchAddEvent(const MidiEvent &event)
 {
+    this->updateVCSStateVersion();
+
     if (this->lastFoundParent != nullptr)
     {
         this->lastFoundParent->broadcastAddEvent(event);
@@ -414,6 +566,8 @@ void MidiTrackNode::dispatchAddEvent(const MidiEvent &event)
 
 void MidiTrackNode::dispatchRemoveEvent(const MidiEvent &event)
 {
+    this->updateVCSStateVersion();
+
     if (this->lastFoundParent != nullptr)
     {
         this->lastFoundParent->broadcastRemoveEvent(event);
@@ -422,6 +576,8 @@ void MidiTrackNode::dispatchRemoveEvent(const MidiEvent &event)
 
 void MidiTrackNode::dispatchPostRemoveEvent(MidiSequence *const layer)
 {
+    this->updateVCSStateVersion();
+
     jassert(layer == this->sequence.get());
     if (this->lastFoundParent != nullptr)
     {
@@ -429,8 +585,41 @@ void MidiTrackNode::dispatchPostRemoveEvent(MidiSequence *const layer)
     }
 }
 
+void MidiTrackNode::dispatchAddEvents(const Array<const MidiEvent *> &events)
+{
+    this->updateVCSStateVersion();
+
+    if (this->lastFoundParent != nullptr)
+    {
+        this->lastFoundParent->broadcastAddEvents(events);
+    }
+}
+
+void MidiTrackNode::dispatchChangeEvents(const Array<const MidiEvent *> &oldEvents,
+    const Array<const MidiEvent *> &newEvents)
+{
+    this->updateVCSStateVersion();
+
+    if (this->lastFoundParent != nullptr)
+    {
+        this->lastFoundParent->broadcastChangeEvents(oldEvents, newEvents);
+    }
+}
+
+void MidiTrackNode::dispatchRemoveEvents(const Array<const MidiEvent *> &events)
+{
+    this->updateVCSStateVersion();
+
+    if (this->lastFoundParent != nullptr)
+    {
+        this->lastFoundParent->broadcastRemoveEvents(events);
+    }
+}
+
 void MidiTrackNode::dispatchChangeTrackProperties()
 {
+    this->updateVCSStateVersion();
+
     if (this->lastFoundParent != nullptr)
     {
         this->lastFoundParent->broadcastChangeTrackProperties(this);
@@ -455,6 +644,8 @@ void MidiTrackNode::dispatchChangeProjectBeatRange()
 
 void MidiTrackNode::dispatchAddClip(const Clip &clip)
 {
+    this->updateVCSStateVersion();
+
     if (this->lastFoundParent != nullptr)
     {
         this->lastFoundParent->broadcastAddClip(clip);
@@ -463,6 +654,8 @@ void MidiTrackNode::dispatchAddClip(const Clip &clip)
 
 void MidiTrackNode::dispatchChangeClip(const Clip &oldClip, const Clip &newClip)
 {
+    this->updateVCSStateVersion();
+
     if (this->lastFoundParent != nullptr)
     {
         this->lastFoundParent->broadcastChangeClip(oldClip, newClip);
@@ -471,6 +664,8 @@ void MidiTrackNode::dispatchChangeClip(const Clip &oldClip, const Clip &newClip)
 
 void MidiTrackNode::dispatchRemoveClip(const Clip &clip)
 {
+    this->updateVCSStateVersion();
+
     if (this->lastFoundParent != nullptr)
     {
         this->lastFoundParent->broadcastRemoveClip(clip);
@@ -479,6 +674,8 @@ void MidiTrackNode::dispatchRemoveClip(const Clip &clip)
 
 void MidiTrackNode::dispatchPostRemoveClip(Pattern *const pattern)
 {
+    this->updateVCSStateVersion();
+
     jassert(pattern == this->pattern.get());
     if (this->lastFoundParent != nullptr)
     {
@@ -584,6 +781,8 @@ SerializedData MidiTrackNode::serializeTimeSignatureDelta() const
 
 void MidiTrackNode::resetPathDelta(const SerializedData &state)
 {
+    this->updateVCSStateVersion();
+
     jassert(state.hasType(Serialization::VCS::MidiTrackDeltas::trackPath));
     const String newName = state.getProperty(Serialization::VCS::delta);
     this->setTrackName(newName, false, dontSendNotification);
@@ -591,6 +790,8 @@ void MidiTrackNode::resetPathDelta(const SerializedData &state)
 
 void MidiTrackNode::resetColourDelta(const SerializedData &state)
 {
+    this->updateVCSStateVersion();
+
     jassert(state.hasType(Serialization::VCS::MidiTrackDeltas::trackColour));
     const String colourString = state.getProperty(Serialization::VCS::delta);
     const auto colour = Colour::fromString(colourString);
@@ -599,6 +800,8 @@ void MidiTrackNode::resetColourDelta(const SerializedData &state)
 
 void MidiTrackNode::resetInstrumentDelta(const SerializedData &state)
 {
+    this->updateVCSStateVersion();
+
     jassert(state.hasType(Serialization::VCS::MidiTrackDeltas::trackInstrument));
     const String instrumentId = state.getProperty(Serialization::VCS::delta);
     this->setTrackInstrumentId(instrumentId, false, dontSendNotification);
@@ -606,6 +809,8 @@ void MidiTrackNode::resetInstrumentDelta(const SerializedData &state)
 
 void MidiTrackNode::resetTimeSignatureDelta(const SerializedData &state)
 {
+    this->updateVCSStateVersion();
+
     jassert(state.hasType(Serialization::VCS::TimeSignatureDeltas::timeSignaturesChanged));
 
     this->timeSignatureOverride.reset();
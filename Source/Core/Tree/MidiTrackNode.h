@@ -49,10 +49,15 @@ public:
     //===------------------------------------------------------------------===//
 
     String getVCSName() const override;
+    int getVCSStateVersion() const noexcept override;
     SerializedData serializeClipsDelta() const;
     void resetClipsDelta(const SerializedData &state);
     Colour getRevisionDisplayColour() const override;
 
+    UniquePointer<VCS::TrackedItem::StateHolder> createStateHolder() const override;
+    UniquePointer<VCS::TrackedItem::StateHolder> createStateHolder(const VCS::TrackedItem &newState) const override;
+    bool swapStateWith(VCS::TrackedItem::StateHolder &holder) override;
+
     //===------------------------------------------------------------------===//
     // MidiTrack
     //===------------------------------------------------------------------===//
@@ -92,6 +97,11 @@ public:
     void dispatchRemoveEvent(const MidiEvent &event) override;
     void dispatchPostRemoveEvent(MidiSequence *const layer) override;
 
+    void dispatchAddEvents(const Array<const MidiEvent *> &events) override;
+    void dispatchChangeEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents) override;
+    void dispatchRemoveEvents(const Array<const MidiEvent *> &events) override;
+
     void dispatchAddClip(const Clip &clip) override;
     void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) override;
     void dispatchRemoveClip(const Clip &clip) override;
@@ -130,6 +140,38 @@ protected:
     void resetInstrumentDelta(const SerializedData &state);
     void resetTimeSignatureDelta(const SerializedData &state);
 
+    // creates the events in the same way the sequence would do on reset,
+    // but detached from it, see createStateHolder; returns false if the delta
+    // is not the sequence's events delta; called on the worker threads
+    virtual bool createEventsFromDelta(const SerializedData &state,
+        OwnedArray<MidiEvent> &outEvents, FlatHashSet<MidiEvent::Id> &outEventIds) const
+    {
+        return false;
+    }
+
+    template<typename T>
+    void createEvents(const Array<T> &parameters,
+        OwnedArray<MidiEvent> &outEvents, FlatHashSet<MidiEvent::Id> &outEventIds) const
+    {
+        outEvents.ensureStorageAllocated(parameters.size());
+        for (const auto &event : parameters)
+        {
+            if (outEventIds.contains(event.getId()))
+            {
+                jassertfalse;
+                continue;
+            }
+
+            outEventIds.insert(event.getId());
+            outEvents.add(new T(this->getSequence(), event));
+        }
+
+        if (!outEvents.isEmpty())
+        {
+            outEvents.sort(*outEvents.getFirst());
+        }
+    }
+
 protected:
 
     ProjectNode *lastFoundParent;
@@ -151,4 +193,13 @@ protected:
     // used as a template by TimeSignaturesAggregator:
     TimeSignatureEvent timeSignatureOverride;
 
+    // called on every change of the track's state, see VCS::Head
+    void updateVCSStateVersion() noexcept;
+
+private:
+
+    int vcsStateVersion = VCS::TrackedItem::createVCSStateVersion();
+
+    class VCSStateHolder;
+
 };
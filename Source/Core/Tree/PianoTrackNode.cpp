@@ -140,6 +140,8 @@ VCS::DiffLogic *PianoTrackNode::getDiffLogic() const
 
 void PianoTrackNode::resetStateTo(const VCS::TrackedItem &newState)
 {
+    this->updateVCSStateVersion();
+
     using namespace Serialization::VCS;
     for (int i = 0; i < newState.getNumDeltas(); ++i)
     {
@@ -206,6 +208,8 @@ SerializedData PianoTrackNode::serialize() const
 
 void PianoTrackNode::deserialize(const SerializedData &data)
 {
+    this->updateVCSStateVersion();
+
     this->reset();
 
     this->deserializeVCSUuid(data);
@@ -237,24 +241,46 @@ void PianoTrackNode::deserialize(const SerializedData &data)
 SerializedData PianoTrackNode::serializeEventsDelta() const
 {
     SerializedData tree(Serialization::VCS::PianoSequenceDeltas::notesAdded);
+
+    Array<const MidiEvent *> notes;
+    notes.ensureStorageAllocated(this->getSequence()->size());
     for (int i = 0; i < this->getSequence()->size(); ++i)
     {
-        const MidiEvent *event = this->getSequence()->getUnchecked(i);
-        tree.appendChild(event->serialize());
+        notes.add(this->getSequence()->getUnchecked(i));
     }
 
+    Note::packNotes(tree, notes);
     return tree;
 }
 
 void PianoTrackNode::resetEventsDelta(const SerializedData &state)
 {
+    this->updateVCSStateVersion();
+
     jassert(state.hasType(Serialization::VCS::PianoSequenceDeltas::notesAdded));
 
     this->getSequence()->reset();
-    forEachChildWithType(state, e, Serialization::Midi::note)
+
+    Array<Note> notes;
+    Note::unpackNotes(state, notes);
+    for (const auto &note : notes)
     {
-        this->getSequence()->checkoutEvent<Note>(e);
+        this->getSequence()->checkoutEvent<Note>(note);
     }
 
     this->getSequence()->updateBeatRange(false);
 }
+
+bool PianoTrackNode::createEventsFromDelta(const SerializedData &state,
+    OwnedArray<MidiEvent> &outEvents, FlatHashSet<MidiEvent::Id> &outEventIds) const
+{
+    if (!state.hasType(Serialization::VCS::PianoSequenceDeltas::notesAdded))
+    {
+        return false;
+    }
+
+    Array<Note> notes;
+    Note::unpackNotes(state, notes);
+    this->createEvents<Note>(notes, outEvents, outEventIds);
+    return true;
+}
@@ -53,6 +53,11 @@ public:
     SerializedData serializeEventsDelta() const;
     void resetEventsDelta(const SerializedData &state);
 
+protected:
+
+    bool createEventsFromDelta(const SerializedData &state,
+        OwnedArray<MidiEvent> &outEvents, FlatHashSet<MidiEvent::Id> &outEventIds) const override;
+
 private:
 
     UniquePointer<VCS::PianoTrackDiffLogic> vcsDiffLogic;
@@ -38,6 +38,12 @@ public:
     virtual void dispatchRemoveEvent(const MidiEvent &event) = 0;
     virtual void dispatchPostRemoveEvent(MidiSequence *const sequence) = 0;
 
+    // Group edits of a sequence
+    virtual void dispatchAddEvents(const Array<const MidiEvent *> &events) = 0;
+    virtual void dispatchChangeEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents) = 0;
+    virtual void dispatchRemoveEvents(const Array<const MidiEvent *> &events) = 0;
+
     // Patterns and clips
     virtual void dispatchAddClip(const Clip &clip) = 0;
     virtual void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) = 0;
@@ -63,6 +69,11 @@ public:
     void dispatchRemoveEvent(const MidiEvent &event) noexcept override {}
     void dispatchPostRemoveEvent(MidiSequence *const layer) noexcept override {}
 
+    void dispatchAddEvents(const Array<const MidiEvent *> &events) noexcept override {}
+    void dispatchChangeEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents) noexcept override {}
+    void dispatchRemoveEvents(const Array<const MidiEvent *> &events) noexcept override {}
+
     void dispatchAddClip(const Clip &clip) noexcept override {}
     void dispatchChangeClip(const Clip &oldClip, const Clip &newClip) noexcept override {}
     void dispatchRemoveClip(const Clip &clip) noexcept override {}
@@ -36,6 +36,35 @@ public:
     virtual void onRemoveMidiEvent(const MidiEvent &event) = 0;
     virtual void onPostRemoveMidiEvent(MidiSequence *const layer) {}
 
+    // Sent by the group edits of a single sequence instead of the callbacks above,
+    // by default, they just forward each event, so only override them if
+    // the listener can handle the whole group in one pass
+    virtual void onAddMidiEvents(const Array<const MidiEvent *> &events)
+    {
+        for (const auto *event : events)
+        {
+            this->onAddMidiEvent(*event);
+        }
+    }
+
+    virtual void onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents)
+    {
+        jassert(oldEvents.size() == newEvents.size());
+        for (int i = 0; i < oldEvents.size(); ++i)
+        {
+            this->onChangeMidiEvent(*oldEvents.getUnchecked(i), *newEvents.getUnchecked(i));
+        }
+    }
+
+    virtual void onRemoveMidiEvents(const Array<const MidiEvent *> &events)
+    {
+        for (const auto *event : events)
+        {
+            this->onRemoveMidiEvent(*event);
+        }
+    }
+
     virtual void onAddClip(const Clip &clip) = 0;
     virtual void onChangeClip(const Clip &oldClip, const Clip &newClip) = 0;
     virtual void onRemoveClip(const Clip &clip) = 0;
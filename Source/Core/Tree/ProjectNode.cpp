@@ -39,6 +39,7 @@
 #include "UndoStack.h"
 #include "MidiRecorder.h"
 #include "KeyboardMapping.h"
+#include "MidiFileWriter.h"
 
 #include "ProjectMetadata.h"
 #include "ProjectTimeline.h"
@@ -51,6 +52,7 @@
 #include "Workspace.h"
 #include "ColourIDs.h"
 #include "Config.h"
+#include "ParallelTasks.h"
 
 ProjectNode::ProjectNode() :
     DocumentOwner({}, "helio"),
@@ -131,20 +133,32 @@ String ProjectNode::getId() const noexcept
     return this->id;
 }
 
-String ProjectNode::getStats() const
+static void collectProjectStats(const ProjectNode &project, int &outNumTracks, int &outNumEvents)
 {
-    const auto tracks = this->findChildrenOfType<MidiTrackNode>();
-    
-    int numEvents = 0;
-    int numTracks = tracks.size();
-    for (int i = 0; i < numTracks; ++i)
+    const auto tracks = project.findChildrenOfType<MidiTrackNode>();
+
+    outNumEvents = 0;
+    outNumTracks = tracks.size();
+    for (int i = 0; i < outNumTracks; ++i)
     {
-        numEvents += tracks[i]->getSequence()->size();
+        outNumEvents += tracks[i]->getSequence()->size();
     }
+}
 
-    return String(TRANS_PLURAL("{x} layers", numTracks) + " " + 
-        TRANS(I18n::Common::conjunction) + " " +
-        TRANS_PLURAL("{x} events", numEvents));
+String ProjectNode::getStats() const
+{
+    int numTracks = 0;
+    int numEvents = 0;
+    collectProjectStats(*this, numTracks, numEvents);
+    return RecentProjectInfo::formatStats(numTracks, numEvents);
+}
+
+void ProjectNode::updateRecentProjectStats() const
+{
+    int numTracks = 0;
+    int numEvents = 0;
+    collectProjectStats(*this, numTracks, numEvents);
+    App::Workspace().getUserProfile().onProjectStatsUpdated(this->getId(), numTracks, numEvents);
 }
 
 Transport &ProjectNode::getTransport() const noexcept
@@ -153,6 +167,12 @@ Transport &ProjectNode::getTransport() const noexcept
     return (*this->transport);
 }
 
+MidiRecorder &ProjectNode::getMidiRecorder() const noexcept
+{
+    jassert(this->midiRecorder);
+    return (*this->midiRecorder);
+}
+
 ProjectMetadata *ProjectNode::getProjectInfo() const noexcept
 {
     jassert(this->metadata);
@@ -182,6 +202,13 @@ Image ProjectNode::getIcon() const noexcept
 
 void ProjectNode::showPage()
 {
+    // unlike the sequencer, the project page is not needed
+    // until shown, so it is only created on demand
+    if (this->projectPage == nullptr)
+    {
+        this->projectPage = make<ProjectPage>(*this);
+    }
+
     this->projectPage->updateContent();
     App::Layout().showPage(this->projectPage.get(), this);
 }
@@ -212,13 +239,13 @@ void ProjectNode::safeRename(const String &newName, bool sendNotifications)
 void ProjectNode::recreatePage()
 {
     SerializedData layoutState(Serialization::UI::sequencer);
-    if (this->sequencerLayout || this->projectPage)
+    if (this->sequencerLayout != nullptr)
     {
         layoutState = this->sequencerLayout->serialize();
     }
     
     this->sequencerLayout = make<SequencerLayout>(*this);
-    this->projectPage = make<ProjectPage>(*this);
+    this->projectPage = nullptr;
 
     // reset caches and let rolls update view ranges:
     // (fixme the below is quite a common piece of code)
@@ -363,6 +390,21 @@ void ProjectNode::redo()
     this->getUndoStack()->redo();
 }
 
+void ProjectNode::releaseMemory()
+{
+    this->getUndoStack()->spillOldTransactions();
+
+    if (!this->transport->isPlaying() && !this->transport->isRendering())
+    {
+        this->transport->releasePlaybackCache();
+    }
+
+    if (auto *vcs = this->findChildOfType<VersionControlNode>())
+    {
+        vcs->releaseCachedStates();
+    }
+}
+
 void ProjectNode::clearUndoHistory()
 {
     this->getUndoStack()->clearUndoHistory();
@@ -410,13 +452,19 @@ Array<MidiTrack *> ProjectNode::getTracks() const
 
 void ProjectNode::collectTracks(Array<MidiTrack *> &resultArray, bool onlySelected /*= false*/) const
 {
-    const auto trackNodes = this->findChildrenOfType<MidiTrackNode>();
-    
-    for (int i = 0; i < trackNodes.size(); ++i)
+    this->rebuildTrackNodesCacheIfNeeded();
+
+    if (!onlySelected)
+    {
+        resultArray.addArray(this->trackNodesCache);
+        return;
+    }
+
+    for (auto *trackNode : this->trackNodesCache)
     {
-        if (trackNodes.getUnchecked(i)->isSelected() || !onlySelected)
+        if (trackNode->isSelected())
         {
-            resultArray.add(trackNodes.getUnchecked(i));
+            resultArray.add(trackNode);
         }
     }
 }
@@ -540,6 +588,14 @@ void ProjectNode::reset()
 }
 
 SerializedData ProjectNode::save() const
+{
+    auto tree = this->saveOwnState();
+    TreeNodeSerializer::serializeChildren(*this, tree);
+    return tree;
+}
+
+// everything except the tree nodes, i.e. tracks and vcs
+SerializedData ProjectNode::saveOwnState() const
 {
     SerializedData tree(Serialization::Core::project);
 
@@ -553,13 +609,13 @@ SerializedData ProjectNode::save() const
     tree.appendChild(this->transport->serialize());
     tree.appendChild(this->sequencerLayout->serialize());
 
-    TreeNodeSerializer::serializeChildren(*this, tree);
-
     return tree;
 }
 
 void ProjectNode::load(const SerializedData &tree)
 {
+    TRACE_ZONE("ProjectNode::load");
+
     this->broadcastBeforeReloadProjectContent();
     this->reset();
 
@@ -621,61 +677,82 @@ void ProjectNode::importMidi(InputStream &stream)
     Random r;
     const auto colours = ColourIDs::getColoursList();
     const auto timeFormat = tempFile.getTimeFormat();
+    const auto numTracks = tempFile.getNumTracks();
 
-    for (int i = 0; i < tempFile.getNumTracks(); i++)
+    struct ImportedTrackInfo final
     {
-        const auto *importedTrack = tempFile.getTrack(i);
-
+        String name;
         bool hasPianoEvents = false;
         bool hasControllerEvents = false;
-        int trackControllerNumber = 0;
+        int controllerNumber = 0;
+    };
 
-        auto trackName = "Track " + String(i);
-        const auto colour = colours[r.nextInt(colours.size())]; // set some random colour
+    // first, classify all tracks in parallel,
+    Array<ImportedTrackInfo> trackInfos;
+    trackInfos.resize(numTracks);
+
+    ParallelTasks::run(numTracks, [&](int i)
+    {
+        const auto *importedTrack = tempFile.getTrack(i);
+        auto &info = trackInfos.getReference(i);
+        info.name = "Track " + String(i);
 
         for (int j = 0; j < importedTrack->getNumEvents(); ++j)
         {
             const auto *event = importedTrack->getEventPointer(j);
             if (event->message.isTrackNameEvent())
             {
-                trackName = event->message.getTextFromTextMetaEvent();
+                info.name = event->message.getTextFromTextMetaEvent();
             }
             else if (event->message.isController())
             {
-                trackControllerNumber = event->message.getControllerNumber();
-                hasControllerEvents = true;
+                info.controllerNumber = event->message.getControllerNumber();
+                info.hasControllerEvents = true;
             }
             else if (event->message.isTempoMetaEvent())
             {
-                trackControllerNumber = MidiTrack::tempoController;
-                hasControllerEvents = true;
+                info.controllerNumber = MidiTrack::tempoController;
+                info.hasControllerEvents = true;
             }
             else if (event->message.isNoteOnOrOff())
             {
-                hasPianoEvents = true;
+                info.hasPianoEvents = true;
             }
         }
+    });
+
+    // then create the track nodes in order, still without any events,
+    Array<MidiTrackNode *> importedNodes;
+    Array<const MidiMessageSequence *> importedSequences;
+
+    for (int i = 0; i < numTracks; i++)
+    {
+        const auto *importedTrack = tempFile.getTrack(i);
+        const auto &info = trackInfos.getReference(i);
+        const auto colour = colours[r.nextInt(colours.size())]; // set some random colour
 
-        if (hasControllerEvents)
+        if (info.hasControllerEvents)
         {
-            const String controllerName = trackControllerNumber == MidiTrack::tempoController ?
-                "Tempo" : MidiMessage::getControllerName(trackControllerNumber);
+            const String controllerName = info.controllerNumber == MidiTrack::tempoController ?
+                "Tempo" : MidiMessage::getControllerName(info.controllerNumber);
 
-            MidiTrackNode *trackNode = new AutomationTrackNode(trackName + " - " + controllerName);
+            MidiTrackNode *trackNode = new AutomationTrackNode(info.name + " - " + controllerName);
 
             const Clip clip(trackNode->getPattern());
             trackNode->getPattern()->insert(clip, false);
 
             this->addChildNode(trackNode, -1, false);
 
-            trackNode->setTrackControllerNumber(trackControllerNumber, dontSendNotification);
+            trackNode->setTrackControllerNumber(info.controllerNumber, dontSendNotification);
             trackNode->setTrackColour(colour, false, dontSendNotification);
-            trackNode->getSequence()->importMidi(*importedTrack, timeFormat);
+
+            importedNodes.add(trackNode);
+            importedSequences.add(importedTrack);
         }
 
-        if (hasPianoEvents)
+        if (info.hasPianoEvents)
         {
-            MidiTrackNode *trackNode = new PianoTrackNode(trackName);
+            MidiTrackNode *trackNode = new PianoTrackNode(info.name);
 
             const Clip clip(trackNode->getPattern());
             trackNode->getPattern()->insert(clip, false);
@@ -683,7 +760,9 @@ void ProjectNode::importMidi(InputStream &stream)
             this->addChildNode(trackNode, -1, false);
 
             trackNode->setTrackColour(colour, false, dontSendNotification);
-            trackNode->getSequence()->importMidi(*importedTrack, timeFormat);
+
+            importedNodes.add(trackNode);
+            importedSequences.add(importedTrack);
         }
 
         // if the track contains any key/time signatures, try importing them all,
@@ -693,7 +772,17 @@ void ProjectNode::importMidi(InputStream &stream)
         this->timeline->getKeySignatures()->getSequence()->importMidi(*importedTrack, timeFormat);
         this->timeline->getTimeSignatures()->getSequence()->importMidi(*importedTrack, timeFormat);
     }
-    
+
+    // and fill the sequences in parallel, each one is only touched by one thread
+    ParallelTasks::run(importedNodes.size(), [&](int i)
+    {
+        importedNodes.getUnchecked(i)->getSequence()->
+            importMidi(*importedSequences.getUnchecked(i), timeFormat);
+    });
+
+    this->getUndoStack()->clearUndoHistory();
+    this->getUndoStack()->beginNewTransaction();
+
     this->isTracksCacheOutdated = true;
     this->broadcastReloadProjectContent();
     const auto range = this->broadcastChangeProjectBeatRange();
@@ -703,6 +792,127 @@ void ProjectNode::importMidi(InputStream &stream)
     this->getDocument()->save();
 }
 
+#if JUCE_DEBUG
+
+void ProjectNode::generateContent(const GeneratedContentParams &params)
+{
+    auto *vcs = this->findChildOfType<VersionControlNode>();
+    jassert(vcs != nullptr);
+
+    Random random(params.seed);
+    const auto colours = ColourIDs::getColoursList();
+
+    // about 16 notes per bar in each track, like in a busy piano part
+    const auto numBars = jmax(1, params.numNotesPerTrack / 16);
+    const auto clipLength = float(numBars * Globals::beatsPerBar);
+
+    const auto addTrack = [this, &random, &colours](MidiTrackNode *track)
+    {
+        track->setTrackColour(colours[random.nextInt(colours.size())], false, dontSendNotification);
+
+        // the same way as in the midi import, no notifications until it's done
+        this->addChildNode(track, -1, false);
+        const ScopedWriteLock lock(this->vcsInfoLock);
+        this->vcsItems.addIfNotAlreadyThere(track);
+    };
+
+    Array<PianoSequence *> pianoSequences;
+
+    const auto numRevisions = jmax(1, params.numRevisions);
+    for (int revision = 0; revision < numRevisions; ++revision)
+    {
+        // the tracks are spread evenly over the revisions,
+        const auto firstPianoTrack = params.numPianoTracks * revision / numRevisions;
+        const auto lastPianoTrack = params.numPianoTracks * (revision + 1) / numRevisions;
+        for (int t = firstPianoTrack; t < lastPianoTrack; ++t)
+        {
+            auto *track = new PianoTrackNode("Piano " + String(t + 1));
+            auto *sequence = static_cast<PianoSequence *>(track->getSequence());
+
+            Array<Note> notes;
+            notes.ensureStorageAllocated(params.numNotesPerTrack);
+            for (int i = 0; i < params.numNotesPerTrack; ++i)
+            {
+                notes.add(Note(sequence, 36 + random.nextInt(48),
+                    roundBeat(random.nextFloat() * clipLength),
+                    Globals::minNoteLength * float(1 + random.nextInt(16)),
+                    0.25f + random.nextFloat() * 0.75f));
+            }
+
+            sequence->insertGroup(notes, false);
+
+            Array<Clip> clips;
+            for (int i = 0; i < jmax(1, params.numClipsPerTrack); ++i)
+            {
+                clips.add(Clip(track->getPattern(), clipLength * float(i)));
+            }
+
+            track->getPattern()->insertGroup(clips, false);
+            addTrack(track);
+            pianoSequences.add(sequence);
+        }
+
+        const auto firstAutoTrack = params.numAutomationTracks * revision / numRevisions;
+        const auto lastAutoTrack = params.numAutomationTracks * (revision + 1) / numRevisions;
+        for (int t = firstAutoTrack; t < lastAutoTrack; ++t)
+        {
+            auto *track = new AutomationTrackNode("Automation " + String(t + 1));
+            auto *sequence = static_cast<AutomationSequence *>(track->getSequence());
+
+            const auto numEvents = jmax(2, params.numEventsPerAutomationTrack);
+            const auto step = clipLength / float(numEvents);
+
+            Array<AutomationEvent> events;
+            events.ensureStorageAllocated(numEvents);
+            for (int i = 0; i < numEvents; ++i)
+            {
+                events.add(AutomationEvent(sequence, step * float(i), random.nextFloat()));
+            }
+
+            sequence->insertGroup(events, false);
+            track->getPattern()->insert(Clip(track->getPattern()), false);
+            track->setTrackControllerNumber(1 + t % 63, dontSendNotification);
+            addTrack(track);
+        }
+
+        // and when there are more revisions than the new tracks,
+        // the notes of some existing track are transposed instead
+        if (firstPianoTrack == lastPianoTrack && !pianoSequences.isEmpty())
+        {
+            auto *sequence = pianoSequences[random.nextInt(pianoSequences.size())];
+
+            Array<Note> groupBefore, groupAfter;
+            for (int i = 0; i < sequence->size(); i += 4)
+            {
+                const auto *note = static_cast<Note *>(sequence->getUnchecked(i));
+                groupBefore.add(*note);
+                groupAfter.add(note->withDeltaKey(random.nextBool() ? 1 : -1));
+            }
+
+            sequence->changeGroup(groupBefore, groupAfter, false);
+        }
+
+        this->isTracksCacheOutdated = true;
+
+        if (vcs != nullptr)
+        {
+            vcs->commitAllChanges("Generated revision " + String(revision + 1));
+        }
+    }
+
+    this->getUndoStack()->clearUndoHistory();
+    this->getUndoStack()->beginNewTransaction();
+
+    this->broadcastReloadProjectContent();
+    const auto range = this->broadcastChangeProjectBeatRange();
+    this->broadcastChangeViewBeatRange(range.getStart() - Globals::beatsPerBar,
+        range.getEnd() + Globals::beatsPerBar);
+
+    this->getDocument()->save();
+}
+
+#endif
+
 //===----------------------------------------------------------------------===//
 // ProjectListeners management
 //===----------------------------------------------------------------------===//
@@ -713,16 +923,36 @@ void ProjectNode::addListener(ProjectListener *listener)
     this->changeListeners.add(listener);
 }
 
+void ProjectNode::addListener(ProjectListener *listener, const MidiSequence *sequence)
+{
+    jassert(MessageManager::getInstance()->currentThreadHasLockedMessageManager());
+    jassert(sequence != nullptr);
+
+    auto &list = this->sequenceListeners[sequence];
+    if (list == nullptr)
+    {
+        list = make<SequenceListeners>();
+    }
+
+    list->add(listener);
+}
+
 void ProjectNode::removeListener(ProjectListener *listener)
 {
     jassert(MessageManager::getInstance()->currentThreadHasLockedMessageManager());
     this->changeListeners.remove(listener);
+
+    for (auto &it : this->sequenceListeners)
+    {
+        it.second->remove(listener);
+    }
 }
 
 void ProjectNode::removeAllListeners()
 {
     jassert(MessageManager::getInstance()->currentThreadHasLockedMessageManager());
     this->changeListeners.clear();
+    this->sequenceListeners.clear();
 }
 
 
@@ -734,33 +964,74 @@ void ProjectNode::broadcastChangeEvent(const MidiEvent &oldEvent, const MidiEven
 {
     //jassert(oldEvent.isValid()); // old event is allowed to be un-owned
     jassert(newEvent.isValid());
-    this->changeListeners.call(&ProjectListener::onChangeMidiEvent, oldEvent, newEvent);
+    this->callListeners(newEvent.getSequence(), &ProjectListener::onChangeMidiEvent, oldEvent, newEvent);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastAddEvent(const MidiEvent &event)
 {
     jassert(event.isValid());
-    this->changeListeners.call(&ProjectListener::onAddMidiEvent, event);
+    this->callListeners(event.getSequence(), &ProjectListener::onAddMidiEvent, event);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastRemoveEvent(const MidiEvent &event)
 {
     jassert(event.isValid());
-    this->changeListeners.call(&ProjectListener::onRemoveMidiEvent, event);
+    this->callListeners(event.getSequence(), &ProjectListener::onRemoveMidiEvent, event);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastPostRemoveEvent(MidiSequence *const layer)
 {
-    this->changeListeners.call(&ProjectListener::onPostRemoveMidiEvent, layer);
+    this->callListeners(layer, &ProjectListener::onPostRemoveMidiEvent, layer);
+    this->sendChangeMessage();
+}
+
+void ProjectNode::broadcastAddEvents(const Array<const MidiEvent *> &events)
+{
+    if (events.isEmpty())
+    {
+        return;
+    }
+
+    this->callListeners(events.getFirst()->getSequence(), &ProjectListener::onAddMidiEvents, events);
+    this->sendChangeMessage();
+}
+
+void ProjectNode::broadcastChangeEvents(const Array<const MidiEvent *> &oldEvents,
+    const Array<const MidiEvent *> &newEvents)
+{
+    jassert(oldEvents.size() == newEvents.size());
+    if (newEvents.isEmpty())
+    {
+        return;
+    }
+
+    this->callListeners(newEvents.getFirst()->getSequence(),
+        &ProjectListener::onChangeMidiEvents, oldEvents, newEvents);
+    this->sendChangeMessage();
+}
+
+void ProjectNode::broadcastRemoveEvents(const Array<const MidiEvent *> &events)
+{
+    if (events.isEmpty())
+    {
+        return;
+    }
+
+    this->callListeners(events.getFirst()->getSequence(), &ProjectListener::onRemoveMidiEvents, events);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastAddTrack(MidiTrack *const track)
 {
-    this->isTracksCacheOutdated = true;
+    if (!this->isTracksCacheOutdated)
+    {
+        this->tracksRefsCache[track->getTrackId()] = track;
+    }
+
+    this->isTrackNodesOrderOutdated = true;
 
     if (auto *tracked = dynamic_cast<VCS::TrackedItem *>(track))
     {
@@ -768,13 +1039,17 @@ void ProjectNode::broadcastAddTrack(MidiTrack *const track)
         this->vcsItems.addIfNotAlreadyThere(tracked);
     }
 
-    this->changeListeners.call(&ProjectListener::onAddTrack, track);
+    this->callListeners(track->getSequence(), &ProjectListener::onAddTrack, track);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastRemoveTrack(MidiTrack *const track)
 {
-    this->isTracksCacheOutdated = true;
+    if (!this->isTracksCacheOutdated)
+    {
+        this->tracksRefsCache.erase(track->getTrackId());
+        this->trackNodesCache.removeFirstMatchingValue(dynamic_cast<MidiTrackNode *>(track));
+    }
 
     if (auto *tracked = dynamic_cast<VCS::TrackedItem *>(track))
     {
@@ -782,54 +1057,82 @@ void ProjectNode::broadcastRemoveTrack(MidiTrack *const track)
         this->vcsItems.removeAllInstancesOf(tracked);
     }
 
-    this->changeListeners.call(&ProjectListener::onRemoveTrack, track);
+    this->pendingTrackBeatRangeChanges.removeAllInstancesOf(track);
+
+    this->callListeners(track->getSequence(), &ProjectListener::onRemoveTrack, track);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastChangeTrackProperties(MidiTrack *const track)
 {
-    this->changeListeners.call(&ProjectListener::onChangeTrackProperties, track);
+    // renaming a track moves it in the tree, and
+    // if the track id has somehow changed, just start over:
+    this->isTrackNodesOrderOutdated = true;
+    if (!this->isTracksCacheOutdated)
+    {
+        const auto found = this->tracksRefsCache.find(track->getTrackId());
+        if (found == this->tracksRefsCache.end() || found->second != track)
+        {
+            this->isTracksCacheOutdated = true;
+        }
+    }
+
+    this->callListeners(track->getSequence(), &ProjectListener::onChangeTrackProperties, track);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastChangeTrackBeatRange(MidiTrack *const track)
 {
-    this->changeListeners.call(&ProjectListener::onChangeTrackBeatRange, track);
+    if (this->broadcastBatchDepth > 0)
+    {
+        this->pendingTrackBeatRangeChanges.addIfNotAlreadyThere(track);
+        return;
+    }
+
+    this->callListeners(track->getSequence(), &ProjectListener::onChangeTrackBeatRange, track);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastAddClip(const Clip &clip)
 {
-    this->changeListeners.call(&ProjectListener::onAddClip, clip);
+    this->callListeners(clip.getPattern()->getTrack()->getSequence(), &ProjectListener::onAddClip, clip);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastChangeClip(const Clip &oldClip, const Clip &newClip)
 {
-    this->changeListeners.call(&ProjectListener::onChangeClip, oldClip, newClip);
+    this->callListeners(newClip.getPattern()->getTrack()->getSequence(),
+        &ProjectListener::onChangeClip, oldClip, newClip);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastRemoveClip(const Clip &clip)
 {
-    this->changeListeners.call(&ProjectListener::onRemoveClip, clip);
+    this->callListeners(clip.getPattern()->getTrack()->getSequence(), &ProjectListener::onRemoveClip, clip);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastPostRemoveClip(Pattern *const pattern)
 {
-    this->changeListeners.call(&ProjectListener::onPostRemoveClip, pattern);
+    this->callListeners(pattern->getTrack()->getSequence(), &ProjectListener::onPostRemoveClip, pattern);
     this->sendChangeMessage();
 }
 
 void ProjectNode::broadcastChangeProjectInfo(const ProjectMetadata *info)
 {
     this->changeListeners.call(&ProjectListener::onChangeProjectInfo, info);
+    this->callAllSequenceListeners(&ProjectListener::onChangeProjectInfo, info);
     this->sendChangeMessage();
 }
 
 Range<float> ProjectNode::broadcastChangeProjectBeatRange()
 {
+    if (this->broadcastBatchDepth > 0)
+    {
+        this->hasPendingProjectBeatRangeChange = true;
+        return this->beatRange;
+    }
+
     const auto newBeatRange = this->calculateProjectBeatRange();
     
     if (this->beatRange != newBeatRange)
@@ -843,6 +1146,8 @@ Range<float> ProjectNode::broadcastChangeProjectBeatRange()
         this->transport->onChangeProjectBeatRange(this->beatRange.getStart(), this->beatRange.getEnd());
         this->changeListeners.callExcluding(this->transport.get(),
             &ProjectListener::onChangeProjectBeatRange, this->beatRange.getStart(), this->beatRange.getEnd());
+        this->callAllSequenceListeners(&ProjectListener::onChangeProjectBeatRange,
+            this->beatRange.getStart(), this->beatRange.getEnd());
 
         this->sendChangeMessage();
     }
@@ -853,14 +1158,16 @@ Range<float> ProjectNode::broadcastChangeProjectBeatRange()
 void ProjectNode::broadcastBeforeReloadProjectContent()
 {
     this->changeListeners.call(&ProjectListener::onBeforeReloadProjectContent);
+    this->callAllSequenceListeners(&ProjectListener::onBeforeReloadProjectContent);
 }
 
 void ProjectNode::broadcastReloadProjectContent()
 {
     this->isTracksCacheOutdated = true;
 
-    this->changeListeners.call(&ProjectListener::onReloadProjectContent,
-        this->getTracks(), this->metadata.get());
+    const auto tracks = this->getTracks();
+    this->changeListeners.call(&ProjectListener::onReloadProjectContent, tracks, this->metadata.get());
+    this->callAllSequenceListeners(&ProjectListener::onReloadProjectContent, tracks, this->metadata.get());
 
     this->sendChangeMessage();
 }
@@ -868,16 +1175,47 @@ void ProjectNode::broadcastReloadProjectContent()
 void ProjectNode::broadcastActivateProjectSubtree()
 {
     this->changeListeners.call(&ProjectListener::onActivateProjectSubtree, this->metadata.get());
+    this->callAllSequenceListeners(&ProjectListener::onActivateProjectSubtree, this->metadata.get());
 }
 
 void ProjectNode::broadcastDeactivateProjectSubtree()
 {
     this->changeListeners.call(&ProjectListener::onDeactivateProjectSubtree, this->metadata.get());
+    this->callAllSequenceListeners(&ProjectListener::onDeactivateProjectSubtree, this->metadata.get());
+}
+
+void ProjectNode::beginBroadcastBatch() noexcept
+{
+    this->broadcastBatchDepth++;
+}
+
+void ProjectNode::endBroadcastBatch()
+{
+    jassert(this->broadcastBatchDepth > 0);
+    this->broadcastBatchDepth--;
+
+    if (this->broadcastBatchDepth > 0)
+    {
+        return;
+    }
+
+    const auto tracks = move(this->pendingTrackBeatRangeChanges);
+    for (auto *track : tracks)
+    {
+        this->broadcastChangeTrackBeatRange(track);
+    }
+
+    if (this->hasPendingProjectBeatRangeChange)
+    {
+        this->hasPendingProjectBeatRangeChange = false;
+        this->broadcastChangeProjectBeatRange();
+    }
 }
 
 void ProjectNode::broadcastChangeViewBeatRange(float firstBeat, float lastBeat)
 {
     this->changeListeners.call(&ProjectListener::onChangeViewBeatRange, firstBeat, lastBeat);
+    this->callAllSequenceListeners(&ProjectListener::onChangeViewBeatRange, firstBeat, lastBeat);
     // this->sendChangeMessage(); the project itself didn't change, so dont call this
 }
 
@@ -885,31 +1223,296 @@ void ProjectNode::broadcastChangeViewBeatRange(float firstBeat, float lastBeat)
 // DocumentOwner
 //===----------------------------------------------------------------------===//
 
+static constexpr auto maxProjectJournalEntries = 50;
+static constexpr int64 maxProjectJournalSize = 8 * 1024 * 1024;
+static constexpr int projectJournalEntryMagic = 0x6c6e726a;
+
+static bool replaceJournaledTrack(SerializedData &parent,
+    const SerializedData &track, const var &trackId)
+{
+    using namespace Serialization;
+
+    for (int i = 0; i < parent.getNumChildren(); ++i)
+    {
+        auto child = parent.getChild(i);
+        if (!child.hasType(Core::treeNode))
+        {
+            continue;
+        }
+
+        if (child.getProperty(Serialization::VCS::vcsItemId) == trackId)
+        {
+            parent.removeChild(i);
+            parent.addChild(track, i);
+            return true;
+        }
+
+        if (replaceJournaledTrack(child, track, trackId))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// moves all the children out of the tree, so they can be added elsewhere
+static Array<SerializedData> detachChildren(SerializedData &tree)
+{
+    Array<SerializedData> children;
+    while (tree.getNumChildren() > 0)
+    {
+        children.add(tree.getChild(0));
+        tree.removeChild(0);
+    }
+
+    return children;
+}
+
+static SerializedData applyProjectJournal(SerializedData tree, const File &journalFile)
+{
+    using namespace Serialization;
+
+    MemoryBlock journal;
+    if (!journalFile.loadFileAsData(journal))
+    {
+        return tree;
+    }
+
+    MemoryInputStream in(journal, false);
+    while (in.getNumBytesRemaining() >= 8)
+    {
+        const auto magic = in.readInt();
+        const auto size = in.readInt();
+
+        // the last entry might have been written partially, if the app has crashed
+        if (magic != projectJournalEntryMagic ||
+            size <= 0 || size > in.getNumBytesRemaining())
+        {
+            break;
+        }
+
+        MemoryInputStream entryStream(static_cast<const char *>(journal.getData()) +
+            in.getPosition(), size_t(size), false);
+
+        in.skipNextBytes(size);
+
+        auto entry = SerializedData::readFromStreamWithDictionary(entryStream);
+        if (!entry.hasType(Core::projectJournalEntry) || entry.getNumChildren() == 0)
+        {
+            break;
+        }
+
+        // the first child is the project's own state, which replaces the old one,
+        // and all the tree nodes are moved to it, except the journaled tracks
+        auto entryChildren = detachChildren(entry);
+        auto updatedTree = entryChildren.getFirst();
+
+        for (const auto &child : detachChildren(tree))
+        {
+            if (child.hasType(Core::treeNode))
+            {
+                updatedTree.appendChild(child);
+            }
+        }
+
+        for (int i = 1; i < entryChildren.size(); ++i)
+        {
+            const auto &track = entryChildren.getReference(i);
+            replaceJournaledTrack(updatedTree, track, track.getProperty(Serialization::VCS::vcsItemId));
+        }
+
+        tree = updatedTree;
+    }
+
+    return tree;
+}
+
 bool ProjectNode::onDocumentLoad(const File &file)
 {
-    const auto tree = DocumentHelpers::load(file);
+    auto tree = DocumentHelpers::load(file);
+
+    const auto journalFile = ProjectNode::getJournalFile(file);
+    const bool hasJournal = tree.isValid() && journalFile.existsAsFile();
+    if (hasJournal)
+    {
+        tree = applyProjectJournal(tree, journalFile);
+    }
 
     if (tree.isValid())
     {
         this->load(tree);
 
+        // the journal is only removed after the next full save succeeds
+        this->updateJournaledTracks();
+        this->numJournalEntries = 0;
+        this->hasChangesNotInJournal = hasJournal;
+        if (hasJournal)
+        {
+            DocumentOwner::sendChangeMessage();
+        }
+
         App::Workspace().getUserProfile()
             .onProjectLocalInfoUpdated(this->getId(), this->getName(),
                 this->getDocument()->getFullPath());
 
+        this->updateRecentProjectStats();
         return true;
     }
 
     return false;
 }
 
+// projects are the largest documents of all, and they mostly consist
+// of repetitive event data, so the full saves are compressed
+static bool saveProjectFile(const File &file, const SerializedData &tree)
+{
+    static const BinarySerializer serializer(true);
+    return DocumentHelpers::save(file, tree, serializer);
+}
+
 bool ProjectNode::onDocumentSave(const File &file)
 {
     const auto projectNode = this->save();
 #if DEBUG
     DocumentHelpers::save<XmlSerializer>(file.withFileExtension("xml"), projectNode);
 #endif
-    return DocumentHelpers::save<BinarySerializer>(file, projectNode);
+    if (!saveProjectFile(file, projectNode))
+    {
+        return false;
+    }
+
+    ProjectNode::getJournalFile(file).deleteFile();
+    this->updateJournaledTracks();
+    this->numJournalEntries = 0;
+    this->hasChangesNotInJournal = false;
+    this->updateRecentProjectStats();
+    return true;
+}
+
+// the trees are built here on the message thread, and they are effectively
+// immutable snapshots, so only the writing is done in background
+bool ProjectNode::onDocumentAutosave(const File &file,
+    bool &outIsIncremental, Function<void(bool savedOk)> onSaved)
+{
+    auto saveJob = this->createJournalEntrySaveJob(file);
+    outIsIncremental = (saveJob != nullptr);
+
+    this->updateRecentProjectStats();
+
+    if (saveJob == nullptr)
+    {
+        const auto projectNode = this->save();
+        saveJob = [file, projectNode]()
+        {
+#if DEBUG
+            DocumentHelpers::save<XmlSerializer>(file.withFileExtension("xml"), projectNode);
+#endif
+            if (!saveProjectFile(file, projectNode))
+            {
+                return false;
+            }
+
+            ProjectNode::getJournalFile(file).deleteFile();
+            return true;
+        };
+
+        this->updateJournaledTracks();
+        this->numJournalEntries = 0;
+        this->hasChangesNotInJournal = false;
+    }
+
+    WeakReference<TreeNode> weakThis(this);
+    DocumentHelpers::saveInBackground(file, !outIsIncremental, saveJob, [weakThis, onSaved](bool savedOk)
+    {
+        if (!savedOk && weakThis != nullptr)
+        {
+            // make sure the next save is the full one
+            static_cast<ProjectNode *>(weakThis.get())->hasChangesNotInJournal = true;
+        }
+
+        onSaved(savedOk);
+    });
+
+    return true;
+}
+
+// returns nullptr, if the full save is needed instead
+Function<bool()> ProjectNode::createJournalEntrySaveJob(const File &file)
+{
+    const auto journalFile = ProjectNode::getJournalFile(file);
+    if (this->hasChangesNotInJournal ||
+        this->numJournalEntries >= maxProjectJournalEntries ||
+        journalFile.getSize() >= maxProjectJournalSize)
+    {
+        return nullptr;
+    }
+
+    const auto tracks = this->findChildrenOfType<MidiTrackNode>();
+    if (tracks.size() != this->journaledTrackIds.size())
+    {
+        return nullptr;
+    }
+
+    SerializedData entry(Serialization::Core::projectJournalEntry);
+    entry.appendChild(this->saveOwnState());
+
+    for (int i = 0; i < tracks.size(); ++i)
+    {
+        const auto *track = tracks.getUnchecked(i);
+        const auto trackId = track->getUuid().toString();
+
+        // any added, removed or reordered tracks need the full save
+        if (trackId != this->journaledTrackIds[i])
+        {
+            return nullptr;
+        }
+
+        if (track->getVCSStateVersion() != this->journaledTrackVersions[trackId])
+        {
+            entry.appendChild(track->serialize());
+        }
+    }
+
+    this->updateJournaledTracks();
+    this->numJournalEntries++;
+
+    return [journalFile, entry]()
+    {
+        MemoryOutputStream entryData;
+        entry.writeToStreamWithDictionary(entryData);
+
+        FileOutputStream out(journalFile); // appends to the end of existing file
+        if (!out.openedOk())
+        {
+            return false;
+        }
+
+        out.writeInt(projectJournalEntryMagic);
+        out.writeInt(int(entryData.getDataSize()));
+        out.write(entryData.getData(), entryData.getDataSize());
+        out.flush();
+
+        return out.getStatus().wasOk();
+    };
+}
+
+File ProjectNode::getJournalFile(const File &documentFile)
+{
+    return documentFile.getSiblingFile(documentFile.getFileName() + ".journal");
+}
+
+void ProjectNode::updateJournaledTracks()
+{
+    this->journaledTrackIds.clearQuick();
+    this->journaledTrackVersions.clear();
+
+    for (const auto *track : this->findChildrenOfType<MidiTrackNode>())
+    {
+        const auto trackId = track->getUuid().toString();
+        this->journaledTrackIds.add(trackId);
+        this->journaledTrackVersions[trackId] = track->getVCSStateVersion();
+    }
 }
 
 void ProjectNode::onDocumentImport(InputStream &stream)
@@ -921,15 +1524,16 @@ void ProjectNode::onDocumentImport(InputStream &stream)
 bool ProjectNode::onDocumentExport(OutputStream &stream)
 {
     // assumes MIDI export, todo checks
-    this->exportMidi(stream);
-    return true;
+    return this->exportMidi(stream);
 }
 
-void ProjectNode::exportMidi(OutputStream &stream) const
+// writes the file track by track, so that only one group of tracks
+// is kept in memory at a time; it only reads the project,
+// so it can run on a background thread, reporting the progress
+bool ProjectNode::exportMidi(OutputStream &stream,
+    const Function<void(float progress)> &onProgress /*= nullptr*/) const
 {
-    MidiFile tempFile;
     static const double midiClock = 960.0;
-    tempFile.setTicksPerQuarterNote(int(midiClock));
 
     static Clip noTransform;
     static KeyboardMapping simpleMapping;
@@ -941,50 +1545,75 @@ void ProjectNode::exportMidi(OutputStream &stream) const
     // Metronome track flag is only needed for playback:
     const bool metronomeFlag = false;
 
+    // the file tracks go in the order of their first project track
     const auto grouping = this->getTrackGroupingMode();
-    FlatHashMap<String, MidiMessageSequence, StringHash> sequences;
+    FlatHashMap<String, int, StringHash> groupIndices;
+    Array<Array<const MidiTrack *>> groups;
 
     for (const auto *track : this->getTracks())
     {
         const auto groupKey = track->getTrackGroupKey(grouping);
-        if (!sequences.contains(groupKey))
+        if (!groupIndices.contains(groupKey))
         {
-            sequences.insert({ groupKey, {} });
+            groupIndices[groupKey] = groups.size();
+            groups.add(Array<const MidiTrack *>());
         }
 
-        auto &sequence = sequences[groupKey];
+        groups.getReference(groupIndices[groupKey]).add(track);
+    }
+
+    MidiFileWriter writer(stream);
+    if (!writer.writeHeader(groups.size(), short(midiClock)))
+    {
+        return false;
+    }
 
-        // todo add more meta events like track name
-        if (track->getPattern() != nullptr)
+    for (int i = 0; i < groups.size(); ++i)
+    {
+        MidiMessageSequence sequence;
+
+        for (const auto *track : groups.getReference(i))
         {
-            for (const auto *clip : track->getPattern()->getClips())
+            // the events are exported once, and then stamped for each clip
+            Array<MidiEvent::ExportedMessage> clipRelativeMessages;
+            track->getSequence()->exportClipRelativeMessages(clipRelativeMessages,
+                metronomeFlag, this->beatRange.getStart(), this->beatRange.getEnd(),
+                midiClock);
+
+            // todo add more meta events like track name
+            if (track->getPattern() != nullptr)
+            {
+                for (const auto *clip : track->getPattern()->getClips())
+                {
+                    track->getSequence()->exportClip(sequence, clipRelativeMessages,
+                        *clip, simpleMapping, soloFlag, midiClock);
+                }
+            }
+            else
             {
-                track->getSequence()->exportMidi(sequence, *clip,
-                    simpleMapping, soloFlag, metronomeFlag,
-                    this->beatRange.getStart(), this->beatRange.getEnd(),
-                    midiClock);
+                track->getSequence()->exportClip(sequence, clipRelativeMessages,
+                    noTransform, simpleMapping, soloFlag, midiClock);
             }
+
+            // the project will not necessarily start from 0 timestamp;
+            // normally we don't care (not caring about that also makes the code simpler),
+            // but when exporting to MIDI file, let's make sure the start is at zero:
+            sequence.addTimeToMessages(-this->beatRange.getStart());
         }
-        else
+
+        if (!writer.writeTrack(sequence))
         {
-            track->getSequence()->exportMidi(sequence, noTransform,
-                simpleMapping, soloFlag, metronomeFlag,
-                this->beatRange.getStart(), this->beatRange.getEnd(),
-                midiClock);
+            return false;
         }
 
-        // the project will not necessarily start from 0 timestamp;
-        // normally we don't care (not caring about that also makes the code simpler),
-        // but when exporting to MIDI file, let's make sure the start is at zero:
-        sequence.addTimeToMessages(-this->beatRange.getStart());
-    }
-
-    for (const auto &i : sequences)
-    {
-        tempFile.addTrack(i.second);
+        if (onProgress != nullptr)
+        {
+            onProgress(float(i + 1) / float(groups.size()));
+        }
     }
 
-    tempFile.writeTo(stream);
+    stream.flush();
+    return true;
 }
 
 //===----------------------------------------------------------------------===//
@@ -1048,24 +1677,8 @@ VCS::TrackedItem *ProjectNode::getTrackedItem(int index)
 VCS::TrackedItem *ProjectNode::initTrackedItem(const Identifier &type,
     const Uuid &id, const VCS::TrackedItem &newState)
 {
-    if (type == Serialization::Core::pianoTrack)
+    if (auto *track = this->initEmptyTrackedItem(type, id))
     {
-        auto *track = new PianoTrackNode("");
-        track->setVCSUuid(id);
-        this->addChildNode(track, -1, false);
-        // add explicitly, since we aren't going to receive a notification:
-        this->isTracksCacheOutdated = true;
-        this->vcsItems.addIfNotAlreadyThere(track);
-        track->resetStateTo(newState);
-        return track;
-    }
-    if (type == Serialization::Core::automationTrack)
-    {
-        auto *track = new AutomationTrackNode("");
-        track->setVCSUuid(id);
-        this->addChildNode(track, -1, false);
-        this->isTracksCacheOutdated = true;
-        this->vcsItems.addIfNotAlreadyThere(track);
         track->resetStateTo(newState);
         return track;
     }
@@ -1085,6 +1698,30 @@ VCS::TrackedItem *ProjectNode::initTrackedItem(const Identifier &type,
     return nullptr;
 }
 
+VCS::TrackedItem *ProjectNode::initEmptyTrackedItem(const Identifier &type, const Uuid &id)
+{
+    MidiTrackNode *track = nullptr;
+    if (type == Serialization::Core::pianoTrack)
+    {
+        track = new PianoTrackNode("");
+    }
+    else if (type == Serialization::Core::automationTrack)
+    {
+        track = new AutomationTrackNode("");
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    track->setVCSUuid(id);
+    this->addChildNode(track, -1, false);
+    // add explicitly, since we aren't going to receive a notification:
+    this->isTracksCacheOutdated = true;
+    this->vcsItems.addIfNotAlreadyThere(track);
+    return track;
+}
+
 bool ProjectNode::deleteTrackedItem(VCS::TrackedItem *item)
 {
     if (auto *treeItem = dynamic_cast<MidiTrackNode *>(item))
@@ -1137,6 +1774,7 @@ void ProjectNode::changeListenerCallback(ChangeBroadcaster *source)
 {
     if (auto *vcs = dynamic_cast<VersionControl *>(source))
     {
+        this->hasChangesNotInJournal = true;
         DocumentOwner::sendChangeMessage();
     }
 }
@@ -1146,6 +1784,7 @@ void ProjectNode::rebuildTracksRefsCacheIfNeeded() const
     if (this->isTracksCacheOutdated)
     {
         this->tracksRefsCache.clear();
+        this->trackNodesCache.clearQuick();
 
         this->tracksRefsCache[this->timeline->getAnnotations()->getTrackId()] =
             this->timeline->getAnnotations();
@@ -1156,14 +1795,25 @@ void ProjectNode::rebuildTracksRefsCacheIfNeeded() const
         this->tracksRefsCache[this->timeline->getTimeSignatures()->getTrackId()] =
             this->timeline->getTimeSignatures();
         
-        const auto children = this->findChildrenOfType<MidiTrack>();
+        this->trackNodesCache = this->findChildrenOfType<MidiTrackNode>();
         
-        for (int i = 0; i < children.size(); ++i)
+        for (auto *track : this->trackNodesCache)
         {
-            MidiTrack *const track = children.getUnchecked(i);
             this->tracksRefsCache[track->getTrackId()] = track;
         }
         
         this->isTracksCacheOutdated = false;
+        this->isTrackNodesOrderOutdated = false;
+    }
+}
+
+void ProjectNode::rebuildTrackNodesCacheIfNeeded() const
+{
+    this->rebuildTracksRefsCacheIfNeeded();
+
+    if (this->isTrackNodesOrderOutdated)
+    {
+        this->trackNodesCache = this->findChildrenOfType<MidiTrackNode>();
+        this->isTrackNodesOrderOutdated = false;
     }
 }
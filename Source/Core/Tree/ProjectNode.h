@@ -26,6 +26,7 @@ class MidiEvent;
 class ProjectPage;
 class Origami;
 class MidiRecorder;
+class MidiTrackNode;
 class ProjectMetadata;
 class ProjectTimeline;
 class CommandPaletteTimelineEvents;
@@ -62,13 +63,36 @@ public:
     String getStats() const;
 
     Transport &getTransport() const noexcept;
+    MidiRecorder &getMidiRecorder() const noexcept;
     ProjectMetadata *getProjectInfo() const noexcept;
     ProjectTimeline *getTimeline() const noexcept;
     RollEditMode &getEditMode() noexcept;
     RollBase *getLastFocusedRoll() const;
     
     void importMidi(InputStream &stream);
-    void exportMidi(OutputStream &stream) const;
+    bool exportMidi(OutputStream &stream,
+        const Function<void(float progress)> &onProgress = nullptr) const;
+
+#if JUCE_DEBUG
+
+    // fills the project with random content of the given size, committed
+    // in the given number of revisions, so that the performance issues
+    // which only show up in large projects can be reproduced without them;
+    // the same parameters always generate the same content
+    struct GeneratedContentParams final
+    {
+        int numPianoTracks = 200;
+        int numClipsPerTrack = 4;
+        int numNotesPerTrack = 2500;
+        int numAutomationTracks = 20;
+        int numEventsPerAutomationTrack = 1000;
+        int numRevisions = 100;
+        int64 seed = 1;
+    };
+
+    void generateContent(const GeneratedContentParams &params);
+
+#endif
 
     Image getIcon() const noexcept override;
 
@@ -105,6 +129,10 @@ public:
     void redo();
     void clearUndoHistory();
     UndoStack *getUndoStack() const noexcept;
+
+    // drops or spills whatever can be restored later,
+    // e.g. when the OS is running out of memory
+    void releaseMemory();
     void removeTrack(const MidiTrack &track);
 
     //===------------------------------------------------------------------===//
@@ -133,6 +161,11 @@ public:
     void removeListener(ProjectListener *listener);
     void removeAllListeners();
 
+    // listeners only interested in one sequence, like clip components,
+    // won't receive the event, clip and track changes of other sequences;
+    // removeListener() unsubscribes them as well
+    void addListener(ProjectListener *listener, const MidiSequence *sequence);
+
     //===------------------------------------------------------------------===//
     // Broadcaster
     //===------------------------------------------------------------------===//
@@ -142,6 +175,11 @@ public:
     void broadcastRemoveEvent(const MidiEvent &event);
     void broadcastPostRemoveEvent(MidiSequence *const layer);
 
+    void broadcastAddEvents(const Array<const MidiEvent *> &events);
+    void broadcastChangeEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents);
+    void broadcastRemoveEvents(const Array<const MidiEvent *> &events);
+
     void broadcastAddTrack(MidiTrack *const track);
     void broadcastRemoveTrack(MidiTrack *const track);
     void broadcastChangeTrackProperties(MidiTrack *const track);
@@ -162,6 +200,13 @@ public:
     void broadcastActivateProjectSubtree();
     void broadcastDeactivateProjectSubtree();
 
+    // while the undo stack is undoing or redoing a transaction,
+    // the track and project beat range changes, which make the project
+    // iterate all tracks and the rolls resize, are collected and sent
+    // only once when the transaction is done; batches can be nested
+    void beginBroadcastBatch() noexcept;
+    void endBroadcastBatch();
+
     //===------------------------------------------------------------------===//
     // VCS::TrackedItemsSource
     //===------------------------------------------------------------------===//
@@ -172,6 +217,8 @@ public:
     VCS::TrackedItem *getTrackedItem(int index) override;
     VCS::TrackedItem *initTrackedItem(const Identifier &type,
         const Uuid &id, const VCS::TrackedItem &newState) override;
+    VCS::TrackedItem *initEmptyTrackedItem(const Identifier &type,
+        const Uuid &id) override;
     bool deleteTrackedItem(VCS::TrackedItem *item) override;
     void onBeforeResetState() override;
     void onResetState() override;
@@ -196,6 +243,8 @@ protected:
 
     bool onDocumentLoad(const File &file) override;
     bool onDocumentSave(const File &file) override;
+    bool onDocumentAutosave(const File &file, bool &outIsIncremental,
+        Function<void(bool savedOk)> onSaved) override;
     void onDocumentImport(InputStream &stream) override;
     bool onDocumentExport(OutputStream &stream) override;
 
@@ -211,6 +260,9 @@ private:
 
     void collectTracks(Array<MidiTrack *> &resultArray, bool onlySelected = false) const;
 
+    // keeps the stats shown in the dashboard up to date
+    void updateRecentProjectStats() const;
+
     UniquePointer<Autosaver> autosaver;
     UniquePointer<Transport> transport;
     UniquePointer<MidiRecorder> midiRecorder;
@@ -219,6 +271,42 @@ private:
     RollEditMode rollEditMode;
 
     ListenerList<ProjectListener> changeListeners;
+
+    // the lists are never removed until all listeners are removed,
+    // so that any listener can unsubscribe while being called
+    using SequenceListeners = ListenerList<ProjectListener>;
+    FlatHashMap<const MidiSequence *, UniquePointer<SequenceListeners>> sequenceListeners;
+
+    template <typename... MethodArgs, typename... Args>
+    void callListeners(const MidiSequence *sequence,
+        void (ProjectListener::*callback)(MethodArgs...), Args &&... args)
+    {
+        this->changeListeners.call(callback, args...);
+
+        const auto found = this->sequenceListeners.find(sequence);
+        if (found != this->sequenceListeners.end())
+        {
+            found->second->call(callback, args...);
+        }
+    }
+
+    template <typename... MethodArgs, typename... Args>
+    void callAllSequenceListeners(void (ProjectListener::*callback)(MethodArgs...), Args &&... args)
+    {
+        // the callbacks may subscribe new listeners, e.g. when reloading the rolls,
+        // so the map is not iterated while calling them
+        Array<SequenceListeners *> lists;
+        for (const auto &it : this->sequenceListeners)
+        {
+            lists.add(it.second.get());
+        }
+
+        for (auto *list : lists)
+        {
+            list->call(callback, args...);
+        }
+    }
+
     UniquePointer<ProjectPage> projectPage;
     ReadWriteLock tracksListLock;
 
@@ -233,8 +321,25 @@ private:
 
     void initialize();
     SerializedData save() const;
+    SerializedData saveOwnState() const;
     void load(const SerializedData &tree);
 
+private:
+
+    // instead of rewriting the whole project with its vcs history each time,
+    // autosaving appends the project's own state and the changed tracks
+    // to the journal file next to the document, which is folded into it
+    // on the next full save; any other changes, like vcs commits
+    // or adding and removing tracks, still need the full save
+    static File getJournalFile(const File &documentFile);
+    Function<bool()> createJournalEntrySaveJob(const File &file);
+    void updateJournaledTracks();
+
+    StringArray journaledTrackIds;
+    FlatHashMap<String, int, StringHash> journaledTrackVersions;
+    int numJournalEntries = 0;
+    bool hasChangesNotInJournal = true;
+
 private:
 
     String id;
@@ -249,8 +354,19 @@ private:
     mutable Range<float> beatRange = { 0.f, Globals::Defaults::projectLength };
     Range<float> calculateProjectBeatRange() const;
 
+    int broadcastBatchDepth = 0;
+    Array<MidiTrack *> pendingTrackBeatRangeChanges;
+    bool hasPendingProjectBeatRangeChange = false;
+
+    // the tracks lookup is updated in place when a track is added or removed,
+    // and only rebuilt after bulk changes, like import, undo or vcs checkout;
+    // the tree-ordered list of track nodes is also kept after removals,
+    // but re-collected after additions and renames, which may reorder the tree:
     mutable bool isTracksCacheOutdated = true;
+    mutable bool isTrackNodesOrderOutdated = true;
     mutable FlatHashMap<String, WeakReference<MidiTrack>, StringHash> tracksRefsCache;
+    mutable Array<MidiTrackNode *> trackNodesCache;
     void rebuildTracksRefsCacheIfNeeded() const;
+    void rebuildTrackNodesCacheIfNeeded() const;
 
 };
@@ -300,6 +300,22 @@ void ProjectTimeline::dispatchPostRemoveEvent(MidiSequence *const layer)
     this->project.broadcastPostRemoveEvent(layer);
 }
 
+void ProjectTimeline::dispatchAddEvents(const Array<const MidiEvent *> &events)
+{
+    this->project.broadcastAddEvents(events);
+}
+
+void ProjectTimeline::dispatchChangeEvents(const Array<const MidiEvent *> &oldEvents,
+    const Array<const MidiEvent *> &newEvents)
+{
+    this->project.broadcastChangeEvents(oldEvents, newEvents);
+}
+
+void ProjectTimeline::dispatchRemoveEvents(const Array<const MidiEvent *> &events)
+{
+    this->project.broadcastRemoveEvents(events);
+}
+
 void ProjectTimeline::dispatchChangeTrackProperties()
 {
     jassertfalse; // should never be called
@@ -216,6 +216,21 @@ ProjectNode *RootNode::addExampleProject()
     return project;
 }
 
+#if JUCE_DEBUG
+
+ProjectNode *RootNode::addGeneratedProject()
+{
+    auto *project = new ProjectNode("Generated project");
+    this->addChildNode(project);
+    addAllEssentialProjectNodes(project);
+    createProjectContentFromTemplate(project, {});
+    project->generateContent({});
+    project->selectFirstChildOfType<PianoTrackNode>();
+    return project;
+}
+
+#endif
+
 ProjectNode *RootNode::importMidi(const File &file)
 {
     auto *project = new ProjectNode(file.getFileNameWithoutExtension());
@@ -51,6 +51,11 @@ public:
     ProjectNode *addExampleProject();
     ProjectNode *addEmptyProject(const File &projectLocation, const String &templateName);
     ProjectNode *addEmptyProject(const String &projectName, const String &templateName);
+
+#if JUCE_DEBUG
+    // a large project for profiling, see ProjectNode::generateContent
+    ProjectNode *addGeneratedProject();
+#endif
     
     //===------------------------------------------------------------------===//
     // Menu
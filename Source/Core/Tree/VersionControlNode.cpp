@@ -68,8 +68,12 @@ void VersionControlNode::showPage()
 
 void VersionControlNode::recreatePage()
 {
-    this->shutdownEditor();
-    this->initEditor();
+    // if not created yet, it will be when first shown
+    if (this->editor != nullptr)
+    {
+        this->shutdownEditor();
+        this->initEditor();
+    }
 }
 
 String VersionControlNode::getName() const noexcept
@@ -128,6 +132,32 @@ void VersionControlNode::commitProjectInfo()
     }
 }
 
+// commits everything on the stage without asking,
+// e.g. when generating a project's history
+void VersionControlNode::commitAllChanges(const String &message)
+{
+    if (this->vcs == nullptr)
+    {
+        jassertfalse;
+        return;
+    }
+
+    auto &head = this->vcs->getHead();
+    head.rebuildDiffSynchronously();
+
+    SparseSet<int> allItems;
+    allItems.addRange({ 0, head.getDiff()->getItems().size() });
+    this->vcs->commit(allItems, message);
+}
+
+void VersionControlNode::releaseCachedStates()
+{
+    if (this->vcs != nullptr)
+    {
+        this->vcs->getHead().invalidateCachedStates();
+    }
+}
+
 void VersionControlNode::toggleQuickStash()
 {
     if (this->vcs == nullptr)
@@ -168,11 +198,11 @@ void VersionControlNode::toggleQuickStash()
 
 void VersionControlNode::onNodeAddToTree(bool sendNotifications)
 {
-    // Could be still uninitialized at this moment
+    // Could be still uninitialized at this moment;
+    // the editor lays out the whole history, so it's created on demand
     if (this->vcs == nullptr)
     {
         this->initVCS();
-        this->initEditor();
     }
 }
 
@@ -38,8 +38,13 @@ public:
     String getStatsString() const;
     
     void commitProjectInfo();
+    void commitAllChanges(const String &message);
     void toggleQuickStash();
 
+    // the cached revision states are only needed
+    // to move around the history faster, and can be rebuilt
+    void releaseCachedStates();
+
     //===------------------------------------------------------------------===//
     // Tree
     //===------------------------------------------------------------------===//
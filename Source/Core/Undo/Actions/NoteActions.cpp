@@ -254,6 +254,155 @@ void NoteChangeAction::reset()
     this->trackId.clear();
 }
 
+//===----------------------------------------------------------------------===//
+// Compact groups
+//===----------------------------------------------------------------------===//
+
+static void compactNotes(const Array<Note> &notes, Array<Note::Compact> &outNotes)
+{
+    outNotes.ensureStorageAllocated(outNotes.size() + notes.size());
+    for (const auto &note : notes)
+    {
+        outNotes.add(note.getCompact());
+    }
+
+    outNotes.minimiseStorageOverheads();
+}
+
+static void expandNotes(const Array<Note::Compact> &notes, Array<Note> &outNotes)
+{
+    outNotes.ensureStorageAllocated(notes.size());
+    for (const auto &note : notes)
+    {
+        outNotes.add(Note(note));
+    }
+}
+
+NotesGroupChange::NotesGroupChange(const Array<Note> &before, const Array<Note> &after)
+{
+    jassert(before.size() == after.size());
+    compactNotes(before, this->notesBefore);
+
+    for (int i = 0; i < before.size(); ++i)
+    {
+        const auto &b = before.getReference(i);
+        const auto &a = after.getReference(i);
+
+        if (b.getId() != a.getId())
+        {
+            this->changedFields = 0;
+            compactNotes(after, this->notesAfter);
+            return;
+        }
+
+        this->changedFields |=
+            (b.getBeat() != a.getBeat() ? Field::Beat : 0) |
+            (b.getLength() != a.getLength() ? Field::Length : 0) |
+            (b.getVelocity() != a.getVelocity() ? Field::Velocity : 0) |
+            (b.getKey() != a.getKey() ? Field::Key : 0) |
+            (b.getTuplet() != a.getTuplet() ? Field::Tuplet : 0);
+    }
+
+    // all the values of one changed parameter go first, then the next one, etc.
+    for (const auto field : { Field::Beat, Field::Length, Field::Velocity, Field::Key, Field::Tuplet })
+    {
+        if ((this->changedFields & field) == 0)
+        {
+            continue;
+        }
+
+        for (const auto &note : after)
+        {
+            switch (field)
+            {
+                case Field::Beat: this->changedValues.add(note.getBeat()); break;
+                case Field::Length: this->changedValues.add(note.getLength()); break;
+                case Field::Velocity: this->changedValues.add(note.getVelocity()); break;
+                case Field::Key: this->changedValues.add(float(note.getKey())); break;
+                case Field::Tuplet: this->changedValues.add(float(note.getTuplet())); break;
+            }
+        }
+    }
+
+    this->changedValues.minimiseStorageOverheads();
+}
+
+int NotesGroupChange::size() const noexcept
+{
+    return this->notesBefore.size();
+}
+
+MidiEvent::Id NotesGroupChange::getIdBefore(int index) const noexcept
+{
+    return this->notesBefore.getReference(index).id;
+}
+
+MidiEvent::Id NotesGroupChange::getIdAfter(int index) const noexcept
+{
+    return this->notesAfter.isEmpty() ?
+        this->notesBefore.getReference(index).id :
+        this->notesAfter.getReference(index).id;
+}
+
+void NotesGroupChange::getNotesBefore(Array<Note> &outNotes) const
+{
+    expandNotes(this->notesBefore, outNotes);
+}
+
+void NotesGroupChange::getNotesAfter(Array<Note> &outNotes) const
+{
+    if (!this->notesAfter.isEmpty())
+    {
+        expandNotes(this->notesAfter, outNotes);
+        return;
+    }
+
+    const auto numNotes = this->notesBefore.size();
+    Array<Note::Compact> notes(this->notesBefore);
+
+    int column = 0;
+    for (const auto field : { Field::Beat, Field::Length, Field::Velocity, Field::Key, Field::Tuplet })
+    {
+        if ((this->changedFields & field) == 0)
+        {
+            continue;
+        }
+
+        const auto *values = this->changedValues.begin() + column * numNotes;
+        for (int i = 0; i < numNotes; ++i)
+        {
+            auto &note = notes.getReference(i);
+            switch (field)
+            {
+                case Field::Beat: note.beat = values[i]; break;
+                case Field::Length: note.length = values[i]; break;
+                case Field::Velocity: note.velocity = values[i]; break;
+                case Field::Key: note.key = Note::Key(values[i]); break;
+                case Field::Tuplet: note.tuplet = Note::Tuplet(values[i]); break;
+            }
+        }
+
+        column++;
+    }
+
+    expandNotes(notes, outNotes);
+}
+
+int NotesGroupChange::getSizeInBytes() const noexcept
+{
+    return int(sizeof(NotesGroupChange) +
+        sizeof(Note::Compact) * (this->notesBefore.size() + this->notesAfter.size()) +
+        sizeof(float) * this->changedValues.size());
+}
+
+void NotesGroupChange::clear()
+{
+    this->notesBefore.clear();
+    this->notesAfter.clear();
+    this->changedValues.clear();
+    this->changedFields = 0;
+}
+
 //===----------------------------------------------------------------------===//
 // Insert Group
 //===----------------------------------------------------------------------===//
@@ -262,6 +411,14 @@ NotesGroupInsertAction::NotesGroupInsertAction(MidiTrackSource &source,
     const String &trackId, Array<Note> &target) noexcept :
     UndoAction(source),
     trackId(trackId)
+{
+    compactNotes(target, this->notes);
+}
+
+NotesGroupInsertAction::NotesGroupInsertAction(MidiTrackSource &source,
+    const String &trackId, Array<Note::Compact> &target) noexcept :
+    UndoAction(source),
+    trackId(trackId)
 {
     this->notes.swapWith(target);
 }
@@ -271,7 +428,7 @@ NotesGroupInsertAction::NotesGroupInsertAction(MidiTrackSource &source,
     UndoAction(source),
     trackId(trackId)
 {
-    this->notes.add(action1Note, action2Note);
+    this->notes.add(action1Note.getCompact(), action2Note.getCompact());
 }
 
 bool NotesGroupInsertAction::perform()
@@ -279,7 +436,9 @@ bool NotesGroupInsertAction::perform()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->insertGroup(this->notes, false);
+        Array<Note> notes;
+        expandNotes(this->notes, notes);
+        return sequence->insertGroup(notes, false);
     }
     
     return false;
@@ -290,7 +449,9 @@ bool NotesGroupInsertAction::undo()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->removeGroup(this->notes, false);
+        Array<Note> notes;
+        expandNotes(this->notes, notes);
+        return sequence->removeGroup(notes, false);
     }
     
     return false;
@@ -298,7 +459,9 @@ bool NotesGroupInsertAction::undo()
 
 int NotesGroupInsertAction::getSizeInUnits()
 {
-    return (sizeof(Note) * this->notes.size());
+    return int(sizeof(NotesGroupInsertAction) +
+        this->trackId.getNumBytesAsUTF8() +
+        sizeof(Note::Compact) * this->notes.size());
 }
 
 SerializedData NotesGroupInsertAction::serialize() const
@@ -306,9 +469,9 @@ SerializedData NotesGroupInsertAction::serialize() const
     SerializedData tree(Serialization::Undo::notesGroupInsertAction);
     tree.setProperty(Serialization::Undo::trackId, this->trackId);
     
-    for (int i = 0; i < this->notes.size(); ++i)
+    for (const auto &note : this->notes)
     {
-        tree.appendChild(this->notes.getUnchecked(i).serialize());
+        tree.appendChild(Note(note).serialize());
     }
     
     return tree;
@@ -323,7 +486,7 @@ void NotesGroupInsertAction::deserialize(const SerializedData &data)
     {
         Note n;
         n.deserialize(props);
-        this->notes.add(n);
+        this->notes.add(n.getCompact());
     }
 }
 
@@ -355,7 +518,7 @@ UndoAction *NotesGroupInsertAction::createCoalescedAction(UndoAction *nextAction
         }
 
         //DBG("NotesGroupInsertAction + NoteInsertAction");
-        this->notes.add(nextChanger->note);
+        this->notes.add(nextChanger->note.getCompact());
         return new NotesGroupInsertAction(this->source,
             this->trackId, this->notes);
     }
@@ -373,7 +536,7 @@ NotesGroupRemoveAction::NotesGroupRemoveAction(MidiTrackSource &source,
     UndoAction(source),
     trackId(trackId)
 {
-    this->notes.swapWith(target);
+    compactNotes(target, this->notes);
 }
 
 bool NotesGroupRemoveAction::perform()
@@ -381,7 +544,9 @@ bool NotesGroupRemoveAction::perform()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->removeGroup(this->notes, false);
+        Array<Note> notes;
+        expandNotes(this->notes, notes);
+        return sequence->removeGroup(notes, false);
     }
     
     return false;
@@ -392,7 +557,9 @@ bool NotesGroupRemoveAction::undo()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->insertGroup(this->notes, false);
+        Array<Note> notes;
+        expandNotes(this->notes, notes);
+        return sequence->insertGroup(notes, false);
     }
     
     return false;
@@ -400,7 +567,9 @@ bool NotesGroupRemoveAction::undo()
 
 int NotesGroupRemoveAction::getSizeInUnits()
 {
-    return (sizeof(Note) * this->notes.size());
+    return int(sizeof(NotesGroupRemoveAction) +
+        this->trackId.getNumBytesAsUTF8() +
+        sizeof(Note::Compact) * this->notes.size());
 }
 
 SerializedData NotesGroupRemoveAction::serialize() const
@@ -408,9 +577,9 @@ SerializedData NotesGroupRemoveAction::serialize() const
     SerializedData tree(Serialization::Undo::notesGroupRemoveAction);
     tree.setProperty(Serialization::Undo::trackId, this->trackId);
     
-    for (int i = 0; i < this->notes.size(); ++i)
+    for (const auto &note : this->notes)
     {
-        tree.appendChild(this->notes.getUnchecked(i).serialize());
+        tree.appendChild(Note(note).serialize());
     }
     
     return tree;
@@ -425,7 +594,7 @@ void NotesGroupRemoveAction::deserialize(const SerializedData &data)
     {
         Note n;
         n.deserialize(props);
-        this->notes.add(n);
+        this->notes.add(n.getCompact());
     }
 }
 
@@ -442,18 +611,18 @@ void NotesGroupRemoveAction::reset()
 NotesGroupChangeAction::NotesGroupChangeAction(MidiTrackSource &source,
     const String &trackId, Array<Note> &state1, Array<Note> &state2) noexcept :
     UndoAction(source),
-    trackId(trackId)
-{
-    this->notesBefore.swapWith(state1);
-    this->notesAfter.swapWith(state2);
-}
+    trackId(trackId),
+    change(state1, state2) {}
 
 bool NotesGroupChangeAction::perform()
 {
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->changeGroup(this->notesBefore, this->notesAfter, false);
+        Array<Note> notesBefore, notesAfter;
+        this->change.getNotesBefore(notesBefore);
+        this->change.getNotesAfter(notesAfter);
+        return sequence->changeGroup(notesBefore, notesAfter, false);
     }
     
     return false;
@@ -464,7 +633,10 @@ bool NotesGroupChangeAction::undo()
     if (PianoSequence *sequence =
         this->source.findSequenceByTrackId<PianoSequence>(this->trackId))
     {
-        return sequence->changeGroup(this->notesAfter, this->notesBefore, false);
+        Array<Note> notesBefore, notesAfter;
+        this->change.getNotesBefore(notesBefore);
+        this->change.getNotesAfter(notesAfter);
+        return sequence->changeGroup(notesAfter, notesBefore, false);
     }
     
     return false;
@@ -472,8 +644,9 @@ bool NotesGroupChangeAction::undo()
 
 int NotesGroupChangeAction::getSizeInUnits()
 {
-    return (sizeof(Note) * this->notesBefore.size()) +
-        (sizeof(Note) * this->notesAfter.size());
+    return int(sizeof(NotesGroupChangeAction) +
+        this->trackId.getNumBytesAsUTF8()) +
+        this->change.getSizeInBytes();
 }
 
 UndoAction *NotesGroupChangeAction::createCoalescedAction(UndoAction *nextAction)
@@ -485,23 +658,25 @@ UndoAction *NotesGroupChangeAction::createCoalescedAction(UndoAction *nextAction
             return nullptr;
         }
             
-        if (this->notesBefore.size() != nextChanger->notesAfter.size())
+        if (this->change.size() != nextChanger->change.size())
         {
             return nullptr;
         }
             
-        for (int i = 0; i < this->notesBefore.size(); ++i)
+        for (int i = 0; i < this->change.size(); ++i)
         {
-            if (this->notesBefore.getUnchecked(i).getId() !=
-                nextChanger->notesAfter.getUnchecked(i).getId())
+            if (this->change.getIdBefore(i) != nextChanger->change.getIdAfter(i))
             {
                 return nullptr;
             }
         }
             
         //DBG("NotesGroupChangeAction ++");
+        Array<Note> notesBefore, notesAfter;
+        this->change.getNotesBefore(notesBefore);
+        nextChanger->change.getNotesAfter(notesAfter);
         return new NotesGroupChangeAction(this->source,
-            this->trackId, this->notesBefore, nextChanger->notesAfter);
+            this->trackId, notesBefore, notesAfter);
     }
 
     (void) nextAction;
@@ -519,15 +694,19 @@ SerializedData NotesGroupChangeAction::serialize() const
     
     SerializedData groupBeforeChild(Serialization::Undo::groupBefore);
     SerializedData groupAfterChild(Serialization::Undo::groupAfter);
+
+    Array<Note> notesBefore, notesAfter;
+    this->change.getNotesBefore(notesBefore);
+    this->change.getNotesAfter(notesAfter);
     
-    for (int i = 0; i < this->notesBefore.size(); ++i)
+    for (int i = 0; i < notesBefore.size(); ++i)
     {
-        groupBeforeChild.appendChild(this->notesBefore.getUnchecked(i).serialize());
+        groupBeforeChild.appendChild(notesBefore.getUnchecked(i).serialize());
     }
     
-    for (int i = 0; i < this->notesAfter.size(); ++i)
+    for (int i = 0; i < notesAfter.size(); ++i)
     {
-        groupAfterChild.appendChild(this->notesAfter.getUnchecked(i).serialize());
+        groupAfterChild.appendChild(notesAfter.getUnchecked(i).serialize());
     }
     
     tree.appendChild(groupBeforeChild);
@@ -545,24 +724,30 @@ void NotesGroupChangeAction::deserialize(const SerializedData &data)
     const auto groupBeforeChild = data.getChildWithName(Serialization::Undo::groupBefore);
     const auto groupAfterChild = data.getChildWithName(Serialization::Undo::groupAfter);
 
+    Array<Note> notesBefore, notesAfter;
+
     for (const auto &props : groupBeforeChild)
     {
         Note n;
         n.deserialize(props);
-        this->notesBefore.add(n);
+        notesBefore.add(n);
     }
 
     for (const auto &props : groupAfterChild)
     {
         Note n;
         n.deserialize(props);
-        this->notesAfter.add(n);
+        notesAfter.add(n);
+    }
+
+    if (notesBefore.size() == notesAfter.size())
+    {
+        this->change = { notesBefore, notesAfter };
     }
 }
 
 void NotesGroupChangeAction::reset()
 {
-    this->notesBefore.clear();
-    this->notesAfter.clear();
+    this->change.clear();
     this->trackId.clear();
 }
@@ -119,6 +119,50 @@ private:
     JUCE_DECLARE_NON_COPYABLE(NoteChangeAction)
 };
 
+//===----------------------------------------------------------------------===//
+// Compact groups
+//===----------------------------------------------------------------------===//
+
+// the undo history keeps lots of note groups, so they are stored compactly:
+// the notes before the change are Note::Compact, and of the notes after it,
+// only the parameters that actually differ, packed column by column
+class NotesGroupChange final
+{
+public:
+
+    NotesGroupChange() = default;
+    NotesGroupChange(const Array<Note> &notesBefore, const Array<Note> &notesAfter);
+
+    int size() const noexcept;
+    MidiEvent::Id getIdBefore(int index) const noexcept;
+    MidiEvent::Id getIdAfter(int index) const noexcept;
+
+    void getNotesBefore(Array<Note> &outNotes) const;
+    void getNotesAfter(Array<Note> &outNotes) const;
+
+    int getSizeInBytes() const noexcept;
+    void clear();
+
+private:
+
+    enum Field : uint8
+    {
+        Beat = 1 << 0,
+        Length = 1 << 1,
+        Velocity = 1 << 2,
+        Key = 1 << 3,
+        Tuplet = 1 << 4
+    };
+
+    Array<Note::Compact> notesBefore;
+
+    // only used when the ids differ, which normally doesn't happen
+    Array<Note::Compact> notesAfter;
+
+    uint8 changedFields = 0;
+    Array<float> changedValues;
+};
+
 //===----------------------------------------------------------------------===//
 // Insert Group
 //===----------------------------------------------------------------------===//
@@ -147,9 +191,12 @@ public:
     void reset() override;
     
 private:
+
+    NotesGroupInsertAction(MidiTrackSource &source,
+        const String &trackId, Array<Note::Compact> &target) noexcept;
     
     String trackId;
-    Array<Note> notes;
+    Array<Note::Compact> notes;
     
     JUCE_DECLARE_NON_COPYABLE(NotesGroupInsertAction)
 };
@@ -179,7 +226,7 @@ public:
 private:
     
     String trackId;
-    Array<Note> notes;
+    Array<Note::Compact> notes;
     
     JUCE_DECLARE_NON_COPYABLE(NotesGroupRemoveAction)
 };
@@ -210,9 +257,7 @@ public:
 private:
 
     String trackId;
-
-    Array<Note> notesBefore;
-    Array<Note> notesAfter;
+    NotesGroupChange change;
 
     JUCE_DECLARE_NON_COPYABLE(NotesGroupChangeAction)
 };
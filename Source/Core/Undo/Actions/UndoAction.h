@@ -29,6 +29,8 @@ public:
     virtual bool perform() = 0;
     virtual bool undo() = 0;
 
+    // the approximate number of bytes the action holds,
+    // which is what the undo stack's history limit is measured in
     virtual int getSizeInUnits()
     {
         return 10;
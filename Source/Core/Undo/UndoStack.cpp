@@ -148,6 +148,88 @@ UndoAction *UndoStack::Transaction::createUndoActionByTag(const Identifier &tagN
     return nullptr;
 }
 
+//===----------------------------------------------------------------------===//
+// Journal
+//===----------------------------------------------------------------------===//
+
+bool UndoStack::Journal::isEmpty() const noexcept
+{
+    return this->entries.isEmpty();
+}
+
+UndoActionId UndoStack::Journal::getLastTransactionId() const noexcept
+{
+    return this->entries.isEmpty() ? UndoActionIDs::None : this->entries.getLast().id;
+}
+
+bool UndoStack::Journal::push(const Transaction &transaction)
+{
+    if (this->file == nullptr)
+    {
+        this->file = make<TemporaryFile>(".undo");
+    }
+
+    FileOutputStream out(this->file->getFile());
+    if (out.failedToOpen())
+    {
+        return false;
+    }
+
+    const auto offset = out.getPosition();
+    transaction.serialize().writeToStreamWithDictionary(out);
+    out.flush();
+
+    if (out.getStatus().failed())
+    {
+        out.setPosition(offset);
+        out.truncate();
+        return false;
+    }
+
+    this->entries.add({ offset, transaction.id });
+    return true;
+}
+
+bool UndoStack::Journal::pop(Transaction &transaction)
+{
+    if (this->entries.isEmpty() || this->file == nullptr)
+    {
+        return false;
+    }
+
+    const auto entry = this->entries.removeAndReturn(this->entries.size() - 1);
+
+    {
+        FileInputStream in(this->file->getFile());
+        if (in.failedToOpen() || !in.setPosition(entry.offset))
+        {
+            return false;
+        }
+
+        transaction.deserialize(SerializedData::readFromStreamWithDictionary(in));
+        transaction.id = entry.id;
+    }
+
+    FileOutputStream out(this->file->getFile());
+    if (out.openedOk())
+    {
+        out.setPosition(entry.offset);
+        out.truncate();
+    }
+
+    return true;
+}
+
+void UndoStack::Journal::clear()
+{
+    this->entries.clear();
+    this->file = nullptr; // deletes the file
+}
+
+//===----------------------------------------------------------------------===//
+// UndoStack
+//===----------------------------------------------------------------------===//
+
 UndoStack::UndoStack(ProjectNode &parentProject,
     int maxNumberOfUnitsToKeep,
     int minimumTransactions) :
@@ -158,10 +240,28 @@ UndoStack::UndoStack(ProjectNode &parentProject,
 void UndoStack::clearUndoHistory()
 {
     this->transactions.clear();
+    this->journal.clear();
     this->totalUnitsStored = 0;
     this->nextIndex = 0;
 }
 
+void UndoStack::spillOldTransactions()
+{
+    while (this->nextIndex > 1)
+    {
+        if (!this->journal.push(*this->transactions.getFirst()))
+        {
+            this->journal.clear();
+        }
+
+        this->totalUnitsStored -= this->transactions.getFirst()->getTotalSize();
+        this->transactions.remove(0);
+        --this->nextIndex;
+    }
+
+    jassert(this->totalUnitsStored >= 0);
+}
+
 bool UndoStack::perform(UndoAction *const newAction, UndoActionId transactionId)
 {
     if (this->perform(newAction))
@@ -237,6 +337,12 @@ void UndoStack::clearFutureTransactions()
            && this->totalUnitsStored > this->maxNumUnitsToKeep
            && this->transactions.size() > this->minimumTransactionsToKeep)
     {
+        // if the journal fails, the older history would be inconsistent
+        if (!this->journal.push(*this->transactions.getFirst()))
+        {
+            this->journal.clear();
+        }
+
         this->totalUnitsStored -= this->transactions.getFirst()->getTotalSize();
         this->transactions.remove(0);
         --this->nextIndex;
@@ -282,7 +388,7 @@ UndoStack::Transaction *UndoStack::getNextSet() const noexcept
 
 bool UndoStack::canUndo() const noexcept
 {
-    return this->getCurrentSet() != nullptr;
+    return this->getCurrentSet() != nullptr || !this->journal.isEmpty();
 }
 
 bool UndoStack::canRedo() const noexcept
@@ -290,12 +396,35 @@ bool UndoStack::canRedo() const noexcept
     return this->getNextSet() != nullptr;
 }
 
+void UndoStack::restoreSpilledTransactionIfNeeded()
+{
+    if (this->nextIndex > 0 || this->journal.isEmpty())
+    {
+        return;
+    }
+
+    auto transaction = make<Transaction>(this->project);
+    if (!this->journal.pop(*transaction))
+    {
+        this->journal.clear();
+        return;
+    }
+
+    this->totalUnitsStored += transaction->getTotalSize();
+    this->transactions.insert(0, transaction.release());
+    this->nextIndex++;
+}
+
 bool UndoStack::undo()
 {
+    this->restoreSpilledTransactionIfNeeded();
+
     if (const auto *s = this->getCurrentSet())
     {
         const ScopedValueSetter<bool> setter(this->reentrancyCheck, true);
         
+        this->project.beginBroadcastBatch();
+
         if (s->undo())
         {
             --nextIndex;
@@ -305,6 +434,8 @@ bool UndoStack::undo()
             this->clearUndoHistory();
         }
         
+        this->project.endBroadcastBatch();
+
         this->beginNewTransaction();
         return true;
     }
@@ -318,6 +449,8 @@ bool UndoStack::redo()
     {
         const ScopedValueSetter<bool> setter(this->reentrancyCheck, true);
         
+        this->project.beginBroadcastBatch();
+
         if (s->perform())
         {
             ++nextIndex;
@@ -327,6 +460,8 @@ bool UndoStack::redo()
             this->clearUndoHistory();
         }
         
+        this->project.endBroadcastBatch();
+
         this->beginNewTransaction();
         return true;
     }
@@ -341,7 +476,7 @@ UndoActionId UndoStack::getUndoActionId() const
         return s->id;
     }
     
-    return 0;
+    return this->journal.getLastTransactionId();
 }
 
 UndoActionId UndoStack::getRedoActionId() const
@@ -30,11 +30,15 @@ class UndoStack final : public Serializable
 public:
 
     explicit UndoStack(ProjectNode &parentProject,
-        int maxNumberOfUnitsToKeep = 30000,
+        int maxNumberOfUnitsToKeep = 4 * 1024 * 1024, // bytes
         int minimumTransactionsToKeep = 30);
 
     void clearUndoHistory();
 
+    // spills all transactions before the current one into the journal,
+    // so that they are still undoable, but don't take any memory
+    void spillOldTransactions();
+
     bool perform(UndoAction *action);
     bool perform(UndoAction *action, UndoActionId transactionId);
 
@@ -100,6 +104,40 @@ private:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Transaction)
     };
 
+    // the transactions which don't fit in memory are not deleted,
+    // but spilled into a temporary file, which works as a stack:
+    // the transactions are appended as they get too old,
+    // and are read back when the user undoes that far
+    class Journal final
+    {
+    public:
+
+        Journal() = default;
+
+        bool isEmpty() const noexcept;
+        UndoActionId getLastTransactionId() const noexcept;
+
+        bool push(const Transaction &transaction);
+        bool pop(Transaction &transaction);
+        void clear();
+
+    private:
+
+        struct Entry final
+        {
+            int64 offset;
+            UndoActionId id;
+        };
+
+        Array<Entry> entries;
+        UniquePointer<TemporaryFile> file;
+
+        JUCE_DECLARE_NON_COPYABLE(Journal)
+    };
+
+    Journal journal;
+    void restoreSpilledTransactionIfNeeded();
+
     static constexpr auto maxTransactionsToSerialize = 10;
 
     void setCurrentUndoActionId(UndoActionId transactionId) noexcept;
@@ -17,6 +17,7 @@
 
 #include "Common.h"
 #include "Delta.h"
+#include "TrackedItem.h"
 
 namespace VCS
 {
@@ -59,6 +60,11 @@ bool Delta::hasType(const Identifier &id) const noexcept
     return (this->type == id);
 }
 
+int64 Delta::getNumChanges() const noexcept
+{
+    return this->description.getNumChanges();
+}
+
 SerializedData Delta::serialize() const
 {
     SerializedData tree(Serialization::VCS::delta);
@@ -108,4 +114,193 @@ void Delta::deserialize(const SerializedData &data)
 
 void Delta::reset() {}
 
+//===----------------------------------------------------------------------===//
+// DiffStatistics
+//===----------------------------------------------------------------------===//
+
+struct EventDeltaType final
+{
+    DiffStatistics::EventType eventType;
+    int64 DiffStatistics::Counters::*counter;
+};
+
+using EventDeltaTypes = FlatHashMap<Identifier, EventDeltaType, IdentifierHash>;
+
+static EventDeltaTypes createEventDeltaTypes()
+{
+    using namespace Serialization::VCS;
+    using Type = DiffStatistics::EventType;
+    using Counters = DiffStatistics::Counters;
+
+    EventDeltaTypes types;
+
+    types[PianoSequenceDeltas::notesAdded] = { Type::Notes, &Counters::numAdded };
+    types[PianoSequenceDeltas::notesRemoved] = { Type::Notes, &Counters::numRemoved };
+    types[PianoSequenceDeltas::notesChanged] = { Type::Notes, &Counters::numChanged };
+
+    types[AutoSequenceDeltas::eventsAdded] = { Type::AutomationEvents, &Counters::numAdded };
+    types[AutoSequenceDeltas::eventsRemoved] = { Type::AutomationEvents, &Counters::numRemoved };
+    types[AutoSequenceDeltas::eventsChanged] = { Type::AutomationEvents, &Counters::numChanged };
+
+    types[AnnotationDeltas::annotationsAdded] = { Type::Annotations, &Counters::numAdded };
+    types[AnnotationDeltas::annotationsRemoved] = { Type::Annotations, &Counters::numRemoved };
+    types[AnnotationDeltas::annotationsChanged] = { Type::Annotations, &Counters::numChanged };
+
+    types[TimeSignatureDeltas::timeSignaturesAdded] = { Type::TimeSignatures, &Counters::numAdded };
+    types[TimeSignatureDeltas::timeSignaturesRemoved] = { Type::TimeSignatures, &Counters::numRemoved };
+    types[TimeSignatureDeltas::timeSignaturesChanged] = { Type::TimeSignatures, &Counters::numChanged };
+
+    types[KeySignatureDeltas::keySignaturesAdded] = { Type::KeySignatures, &Counters::numAdded };
+    types[KeySignatureDeltas::keySignaturesRemoved] = { Type::KeySignatures, &Counters::numRemoved };
+    types[KeySignatureDeltas::keySignaturesChanged] = { Type::KeySignatures, &Counters::numChanged };
+
+    types[PatternDeltas::clipsAdded] = { Type::Clips, &Counters::numAdded };
+    types[PatternDeltas::clipsRemoved] = { Type::Clips, &Counters::numRemoved };
+    types[PatternDeltas::clipsChanged] = { Type::Clips, &Counters::numChanged };
+
+    return types;
+}
+
+void DiffStatistics::addDelta(const Delta &delta)
+{
+    static const auto eventDeltaTypes = createEventDeltaTypes();
+
+    const auto found = eventDeltaTypes.find(delta.getType());
+    if (found == eventDeltaTypes.end())
+    {
+        this->numPropertyChanges++;
+        return;
+    }
+
+    // the full states' deltas have no counters
+    const auto numChanges = delta.getNumChanges();
+    if (numChanges > 0)
+    {
+        auto &counters = this->counters[int(found->second.eventType)];
+        counters.*(found->second.counter) += numChanges;
+    }
+}
+
+void DiffStatistics::addItem(const TrackedItem &item)
+{
+    for (int i = 0; i < item.getNumDeltas(); ++i)
+    {
+        this->addDelta(*item.getDelta(i));
+    }
+}
+
+void DiffStatistics::add(const DiffStatistics &other) noexcept
+{
+    for (int i = 0; i < DiffStatistics::numEventTypes; ++i)
+    {
+        this->counters[i].numAdded += other.counters[i].numAdded;
+        this->counters[i].numRemoved += other.counters[i].numRemoved;
+        this->counters[i].numChanged += other.counters[i].numChanged;
+    }
+
+    this->numPropertyChanges += other.numPropertyChanges;
 }
+
+const DiffStatistics::Counters &DiffStatistics::getCounters(EventType type) const noexcept
+{
+    return this->counters[int(type)];
+}
+
+int64 DiffStatistics::getNumPropertyChanges() const noexcept
+{
+    return this->numPropertyChanges;
+}
+
+bool DiffStatistics::isEmpty() const noexcept
+{
+    for (const auto &c : this->counters)
+    {
+        if (c.getTotal() > 0)
+        {
+            return false;
+        }
+    }
+
+    return this->numPropertyChanges == 0;
+}
+
+}
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class DiffStatisticsTests final : public UnitTest
+{
+public:
+    DiffStatisticsTests() : UnitTest("VCS diff statistics tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        using namespace Serialization::VCS;
+        using VCS::Delta;
+        using VCS::DeltaDescription;
+        using VCS::DiffStatistics;
+        using Type = DiffStatistics::EventType;
+
+        beginTest("Count the changes per event type");
+
+        DiffStatistics stats;
+        expect(stats.isEmpty());
+
+        stats.addDelta(Delta(DeltaDescription("added {x} notes", 5), PianoSequenceDeltas::notesAdded));
+        stats.addDelta(Delta(DeltaDescription("added {x} notes", 2), PianoSequenceDeltas::notesAdded));
+        stats.addDelta(Delta(DeltaDescription("removed {x} notes", 3), PianoSequenceDeltas::notesRemoved));
+        stats.addDelta(Delta(DeltaDescription("changed {x} notes", 4), PianoSequenceDeltas::notesChanged));
+        stats.addDelta(Delta(DeltaDescription("changed {x} events", 7), AutoSequenceDeltas::eventsChanged));
+        stats.addDelta(Delta(DeltaDescription("removed {x} clips", 1), PatternDeltas::clipsRemoved));
+        stats.addDelta(Delta(DeltaDescription("added {x} annotations", 6), AnnotationDeltas::annotationsAdded));
+        stats.addDelta(Delta(DeltaDescription("added {x} key signatures", 8), KeySignatureDeltas::keySignaturesAdded));
+
+        // the property changes have no counters
+        stats.addDelta(Delta(DeltaDescription("color changed"), MidiTrackDeltas::trackColour));
+        stats.addDelta(Delta(DeltaDescription("moved from {x}", String("a")), MidiTrackDeltas::trackPath));
+
+        // the full states of the items have no counters as well
+        stats.addDelta(Delta(DeltaDescription(PianoSequenceDeltas::notesAdded), PianoSequenceDeltas::notesAdded));
+
+        expect(!stats.isEmpty());
+
+        const auto &notes = stats.getCounters(Type::Notes);
+        expectEquals(notes.numAdded, int64(7));
+        expectEquals(notes.numRemoved, int64(3));
+        expectEquals(notes.numChanged, int64(4));
+        expectEquals(notes.getTotal(), int64(14));
+
+        const auto &automation = stats.getCounters(Type::AutomationEvents);
+        expectEquals(automation.numAdded, int64(0));
+        expectEquals(automation.numChanged, int64(7));
+
+        expectEquals(stats.getCounters(Type::Clips).numRemoved, int64(1));
+        expectEquals(stats.getCounters(Type::Annotations).numAdded, int64(6));
+        expectEquals(stats.getCounters(Type::KeySignatures).numAdded, int64(8));
+        expectEquals(stats.getCounters(Type::TimeSignatures).getTotal(), int64(0));
+        expectEquals(stats.getNumPropertyChanges(), int64(2));
+
+        beginTest("Sum the statistics");
+
+        DiffStatistics other;
+        other.addDelta(Delta(DeltaDescription("added {x} notes", 1), PianoSequenceDeltas::notesAdded));
+        other.addDelta(Delta(DeltaDescription("instrument changed"), MidiTrackDeltas::trackInstrument));
+
+        DiffStatistics total;
+        total.add(stats);
+        total.add(other);
+
+        expectEquals(total.getCounters(Type::Notes).numAdded, int64(8));
+        expectEquals(total.getCounters(Type::Notes).numRemoved, int64(3));
+        expectEquals(total.getCounters(Type::AutomationEvents).numChanged, int64(7));
+        expectEquals(total.getNumPropertyChanges(), int64(3));
+    }
+};
+
+static DiffStatisticsTests diffStatisticsTests;
+
+#endif
@@ -21,6 +21,8 @@
 
 namespace VCS
 {
+    class TrackedItem;
+
     class DeltaDescription final
     {
     public:
@@ -49,6 +51,12 @@ namespace VCS
             intParameter(other.intParameter),
             stringParameter(other.stringParameter) {}
 
+        // the number of the changed events, if any, or -1
+        int64 getNumChanges() const noexcept
+        {
+            return this->intParameter;
+        }
+
     private:
         
         static int64 defaultNumChanges;
@@ -102,6 +110,9 @@ namespace VCS
         Identifier getType() const noexcept;
         bool hasType(const Identifier &id) const noexcept;
 
+        // the number of the changed events, if known, or -1
+        int64 getNumChanges() const noexcept;
+
         //===--------------------------------------------------------------===//
         // Serializable
         //===--------------------------------------------------------------===//
@@ -118,6 +129,58 @@ namespace VCS
         JUCE_LEAK_DETECTOR(Delta)
     };
 
+    // A numeric summary of the changes, e.g. for the analysis like
+    // how many notes were changed in each track across the history:
+    // it is collected from the deltas' counters, which are computed
+    // along with the diffs, so it is cheap, and no descriptions need
+    // to be translated; only the diffs and the changed revision items
+    // have the counters, the full states of the items don't
+    class DiffStatistics final
+    {
+    public:
+
+        enum class EventType : int8
+        {
+            Notes,
+            AutomationEvents,
+            Annotations,
+            TimeSignatures,
+            KeySignatures,
+            Clips
+        };
+
+        static constexpr auto numEventTypes = 6;
+
+        struct Counters final
+        {
+            int64 numAdded = 0;
+            int64 numRemoved = 0;
+            int64 numChanged = 0;
+
+            int64 getTotal() const noexcept
+            {
+                return this->numAdded + this->numRemoved + this->numChanged;
+            }
+        };
+
+        void addDelta(const Delta &delta);
+        void addItem(const TrackedItem &item);
+        void add(const DiffStatistics &other) noexcept;
+
+        const Counters &getCounters(EventType type) const noexcept;
+
+        // track renames, colour or instrument changes, project info edits etc.
+        int64 getNumPropertyChanges() const noexcept;
+
+        bool isEmpty() const noexcept;
+
+    private:
+
+        Counters counters[numEventTypes];
+        int64 numPropertyChanges = 0;
+
+    };
+
     struct DeltaDiff final
     {
         UniquePointer<Delta> delta;
@@ -604,24 +604,25 @@ Array<DeltaDiff> createAutoEventsDiffs(const SerializedData &state, const Serial
 void deserializeAutoTrackChanges(const SerializedData &state, const SerializedData &changes,
         OwnedArray<MidiEvent> &stateNotes, OwnedArray<MidiEvent> &changesNotes)
 {
-    if (state.isValid())
+    const auto deserializeEvents = [](const SerializedData &data, OwnedArray<MidiEvent> &outEvents)
     {
-        forEachChildWithType(state, e, Serialization::Midi::automationEvent)
+        Array<AutomationEvent> events;
+        AutomationEvent::unpackEvents(data, events);
+        for (const auto &parameters : events)
         {
-            auto *event = new AutomationEvent();
-            event->deserialize(e);
-            stateNotes.addSorted(*event, event);
+            auto *event = new AutomationEvent(parameters);
+            outEvents.addSorted(*event, event);
         }
+    };
+
+    if (state.isValid())
+    {
+        deserializeEvents(state, stateNotes);
     }
 
     if (changes.isValid())
     {
-        forEachChildWithType(changes, e, Serialization::Midi::automationEvent)
-        {
-            auto *event = new AutomationEvent();
-            event->deserialize(e);
-            changesNotes.addSorted(*event, event);
-        }
+        deserializeEvents(changes, changesNotes);
     }
 }
 
@@ -637,13 +638,7 @@ DeltaDiff serializeAutoTrackChanges(Array<const MidiEvent *> changes,
 SerializedData serializeAutoSequence(Array<const MidiEvent *> changes, const Identifier &tag)
 {
     SerializedData tree(tag);
-
-    for (int i = 0; i < changes.size(); ++i)
-    {
-        const MidiEvent *event = changes.getUnchecked(i);
-        tree.appendChild(event->serialize());
-    }
-
+    AutomationEvent::packEvents(tree, changes);
     return tree;
 }
 
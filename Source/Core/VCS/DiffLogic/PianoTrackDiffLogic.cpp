@@ -42,12 +42,12 @@ DeltaDiff createTimeSignatureDiff(const SerializedData &state, const SerializedD
 static Array<DeltaDiff> createEventsDiffs(const SerializedData &state, const SerializedData &changes);
 
 static void deserializeLayerChanges(const SerializedData &state, const SerializedData &changes,
-    OwnedArray<Note> &stateNotes, OwnedArray<Note> &changesNotes);
+    Array<Note> &stateNotes, Array<Note> &changesNotes);
 
-static DeltaDiff serializePianoTrackChanges(Array<const MidiEvent *> changes,
+static DeltaDiff serializePianoTrackChanges(Array<Note> &changes,
     const String &description, int64 numChanges,  const Identifier &deltaType);
 
-static SerializedData serializePianoSequence(Array<const MidiEvent *> changes, const Identifier &tag);
+static SerializedData serializePianoSequence(Array<Note> &changes, const Identifier &tag);
 static bool checkIfDeltaIsNotesType(const Delta *delta);
 
 
@@ -370,35 +370,39 @@ SerializedData mergeTimeSignature(const SerializedData &state, const SerializedD
     return changes.createCopy();
 }
 
+// all the notes merging and diffing below works on both sides sorted by id,
+// walking them at once, like in the merge sort: whenever the ids differ,
+// the smaller one only exists on its side, otherwise the note is on both
+
 SerializedData mergeNotesAdded(const SerializedData &state, const SerializedData &changes)
 {
     using namespace Serialization::VCS;
 
-    OwnedArray<Note> stateNotes;
-    OwnedArray<Note> changesNotes;
+    Array<Note> stateNotes;
+    Array<Note> changesNotes;
     deserializeLayerChanges(state, changes, stateNotes, changesNotes);
 
-    Array<const MidiEvent *> result;
-
-    result.addArray(stateNotes);
+    Array<Note> result;
+    result.ensureStorageAllocated(stateNotes.size() + changesNotes.size());
 
-    // на всякий пожарный, ищем, нет ли в состоянии нот с теми же id, где нет - добавляем
-    FlatHashSet<MidiEvent::Id> stateIDs;
-    
-    for (int j = 0; j < stateNotes.size(); ++j)
+    // just in case, the notes already present in the state are not added again
+    int i = 0, j = 0;
+    while (i < stateNotes.size() || j < changesNotes.size())
     {
-        const Note *stateNote = stateNotes.getUnchecked(j);
-        stateIDs.insert(stateNote->getId());
-    }
-
-    for (int i = 0; i < changesNotes.size(); ++i)
-    {
-        const Note *changesNote = changesNotes.getUnchecked(i);
-        const bool foundNoteInState = stateIDs.contains(changesNote->getId());
-
-        if (! foundNoteInState)
+        if (j >= changesNotes.size() ||
+            (i < stateNotes.size() && stateNotes.getReference(i).getId() < changesNotes.getReference(j).getId()))
         {
-            result.add(changesNote);
+            result.add(stateNotes.getReference(i++));
+        }
+        else if (i >= stateNotes.size() ||
+            changesNotes.getReference(j).getId() < stateNotes.getReference(i).getId())
+        {
+            result.add(changesNotes.getReference(j++));
+        }
+        else
+        {
+            result.add(stateNotes.getReference(i++));
+            ++j;
         }
     }
 
@@ -409,26 +413,23 @@ SerializedData mergeNotesRemoved(const SerializedData &state, const SerializedDa
 {
     using namespace Serialization::VCS;
 
-    OwnedArray<Note> stateNotes;
-    OwnedArray<Note> changesNotes;
+    Array<Note> stateNotes;
+    Array<Note> changesNotes;
     deserializeLayerChanges(state, changes, stateNotes, changesNotes);
 
-    Array<const MidiEvent *> result;
-
-    // добавляем все ноты из состояния, которых нет в изменениях
-    FlatHashSet<MidiEvent::Id> changesIDs;
+    Array<Note> result;
+    result.ensureStorageAllocated(stateNotes.size());
 
-    for (int j = 0; j < changesNotes.size(); ++j)
-    {
-        const Note *changesNote = changesNotes.getUnchecked(j);
-        changesIDs.insert(changesNote->getId());
-    }
-    
-    for (int i = 0; i < stateNotes.size(); ++i)
+    // keeps all the state notes which are not in the changes
+    int j = 0;
+    for (const auto &stateNote : stateNotes)
     {
-        const Note *stateNote =stateNotes.getUnchecked(i);
-        const bool foundNoteInChanges = changesIDs.contains(stateNote->getId());
-        if (! foundNoteInChanges)
+        while (j < changesNotes.size() && changesNotes.getReference(j).getId() < stateNote.getId())
+        {
+            ++j;
+        }
+
+        if (j >= changesNotes.size() || changesNotes.getReference(j).getId() != stateNote.getId())
         {
             result.add(stateNote);
         }
@@ -441,32 +442,26 @@ SerializedData mergeNotesChanged(const SerializedData &state, const SerializedDa
 {
     using namespace Serialization::VCS;
 
-    OwnedArray<Note> stateNotes;
-    OwnedArray<Note> changesNotes;
+    Array<Note> stateNotes;
+    Array<Note> changesNotes;
     deserializeLayerChanges(state, changes, stateNotes, changesNotes);
 
-    Array<const MidiEvent *> result;
+    Array<Note> result;
+    result.ensureStorageAllocated(stateNotes.size());
 
-    result.addArray(stateNotes);
-
-    // снова ищем по id и заменяем
-    FlatHashMap<MidiEvent::Id, const Note *> changesIDs;
-    
-    for (int j = 0; j < changesNotes.size(); ++j)
+    // replaces the state notes with the changed ones with the same ids
+    int j = 0;
+    for (const auto &stateNote : stateNotes)
     {
-        const Note *changesNote = changesNotes.getUnchecked(j);
-        changesIDs[changesNote->getId()] = changesNote;
-    }
-
-    for (int i = 0; i < stateNotes.size(); ++i)
-    {
-        const auto *stateNote = stateNotes.getUnchecked(i);
-        if (changesIDs.contains(stateNote->getId()))
+        while (j < changesNotes.size() && changesNotes.getReference(j).getId() < stateNote.getId())
         {
-            const auto *changesNote = changesIDs[stateNote->getId()];
-            result.removeAllInstancesOf(stateNote);
-            result.addIfNotAlreadyThere(changesNote);
+            ++j;
         }
+
+        const bool hasChanges = j < changesNotes.size() &&
+            changesNotes.getReference(j).getId() == stateNote.getId();
+
+        result.add(hasChanges ? changesNotes.getReference(j) : stateNote);
     }
 
     return serializePianoSequence(result, PianoSequenceDeltas::notesAdded);
@@ -523,84 +518,50 @@ Array<DeltaDiff> createEventsDiffs(const SerializedData &state, const Serialized
 {
     using namespace Serialization::VCS;
 
-    OwnedArray<Note> stateNotes;
-    OwnedArray<Note> changesNotes;
-
-    // вот здесь по уму надо десериализовать слои
-    // а для этого надо, чтоб в слоях не было ничего, кроме нот
-    // поэтому пока есть, как есть, и это не критично
+    Array<Note> stateNotes;
+    Array<Note> changesNotes;
     deserializeLayerChanges(state, changes, stateNotes, changesNotes);
 
     Array<DeltaDiff> res;
 
-    Array<const MidiEvent *> addedNotes;
-    Array<const MidiEvent *> removedNotes;
-    Array<const MidiEvent *> changedNotes;
+    Array<Note> addedNotes;
+    Array<Note> removedNotes;
+    Array<Note> changedNotes;
 
-    // собственно, само сравнение
-    for (int i = 0; i < stateNotes.size(); ++i)
+    int i = 0, j = 0;
+    while (i < stateNotes.size() || j < changesNotes.size())
     {
-        bool foundNoteInChanges = false;
-        const Note *stateNote(stateNotes.getUnchecked(i));
-
-        for (int j = 0; j < changesNotes.size(); ++j)
+        if (j >= changesNotes.size() ||
+            (i < stateNotes.size() && stateNotes.getReference(i).getId() < changesNotes.getReference(j).getId()))
         {
-            const Note *changesNote = changesNotes.getUnchecked(j);
-
-            // нота из состояния - существует в изменениях. добавляем запись changed, если нужно.
-            if (stateNote->getId() == changesNote->getId())
-            {
-                foundNoteInChanges = true;
-
-                const bool noteHasChanged =
-                    stateNote->getKey() != changesNote->getKey() ||
-                    stateNote->getBeat() != changesNote->getBeat() ||
-                    stateNote->getLength() != changesNote->getLength() ||
-                    stateNote->getVelocity() != changesNote->getVelocity() ||
-                    stateNote->getTuplet() != changesNote->getTuplet();
-
-                if (noteHasChanged)
-                {
-                    changedNotes.add(changesNote);
-                }
-
-                break;
-            }
+            // the state note is not found in the changes
+            removedNotes.add(stateNotes.getReference(i++));
         }
-
-        // нота из состояния - в изменениях не найдена. добавляем запись removed.
-        if (! foundNoteInChanges)
+        else if (i >= stateNotes.size() ||
+            changesNotes.getReference(j).getId() < stateNotes.getReference(i).getId())
         {
-            removedNotes.add(stateNote);
+            // the changes note is missing in the state
+            addedNotes.add(changesNotes.getReference(j++));
         }
-    }
-
-    // теперь ищем в изменениях ноты, которые отсутствуют в состоянии
-    for (int i = 0; i < changesNotes.size(); ++i)
-    {
-        bool foundNoteInState = false;
-        const Note *changesNote = changesNotes.getUnchecked(i);
-
-        for (int j = 0; j < stateNotes.size(); ++j)
+        else
         {
-            const Note *stateNote(stateNotes.getUnchecked(j));
+            const auto &stateNote = stateNotes.getReference(i++);
+            const auto &changesNote = changesNotes.getReference(j++);
+
+            const bool noteHasChanged =
+                stateNote.getKey() != changesNote.getKey() ||
+                stateNote.getBeat() != changesNote.getBeat() ||
+                stateNote.getLength() != changesNote.getLength() ||
+                stateNote.getVelocity() != changesNote.getVelocity() ||
+                stateNote.getTuplet() != changesNote.getTuplet();
 
-            if (stateNote->getId() == changesNote->getId())
+            if (noteHasChanged)
             {
-                foundNoteInState = true;
-                break;
+                changedNotes.add(changesNote);
             }
         }
-
-        // и пишем ее в список добавленных
-        if (! foundNoteInState)
-        {
-            addedNotes.add(changesNote);
-        }
     }
 
-    // сериализуем диффы, если таковые есть
-
     if (addedNotes.size() > 0)
     {
         res.add(serializePianoTrackChanges(addedNotes,
@@ -628,32 +589,33 @@ Array<DeltaDiff> createEventsDiffs(const SerializedData &state, const Serialized
     return res;
 }
 
+struct NoteIdComparator final
+{
+    static int compareElements(const Note &first, const Note &second) noexcept
+    {
+        return (first.getId() > second.getId()) - (first.getId() < second.getId());
+    }
+};
 
 void deserializeLayerChanges(const SerializedData &state, const SerializedData &changes,
-        OwnedArray<Note> &stateNotes, OwnedArray<Note> &changesNotes)
+    Array<Note> &stateNotes, Array<Note> &changesNotes)
 {
+    NoteIdComparator comparator;
+
     if (state.isValid())
     {
-        forEachChildWithType(state, e, Serialization::Midi::note)
-        {
-            auto *note = new Note();
-            note->deserialize(e);
-            stateNotes.addSorted(*note, note);
-        }
+        Note::unpackNotes(state, stateNotes);
+        stateNotes.sort(comparator);
     }
 
     if (changes.isValid())
     {
-        forEachChildWithType(changes, e, Serialization::Midi::note)
-        {
-            auto *note = new Note();
-            note->deserialize(e);
-            changesNotes.addSorted(*note, note);
-        }
+        Note::unpackNotes(changes, changesNotes);
+        changesNotes.sort(comparator);
     }
 }
 
-DeltaDiff serializePianoTrackChanges(Array<const MidiEvent *> changes,
+DeltaDiff serializePianoTrackChanges(Array<Note> &changes,
     const String &description, int64 numChanges, const Identifier &deltaType)
 {
     DeltaDiff changesFullDelta;
@@ -662,16 +624,15 @@ DeltaDiff serializePianoTrackChanges(Array<const MidiEvent *> changes,
     return changesFullDelta;
 }
 
-SerializedData serializePianoSequence(Array<const MidiEvent *> changes, const Identifier &tag)
+// the notes are packed back in their natural order, so that
+// the beat and key deltas, and the packed data, remain small
+SerializedData serializePianoSequence(Array<Note> &changes, const Identifier &tag)
 {
-    SerializedData tree(tag);
-
-    for (int i = 0; i < changes.size(); ++i)
-    {
-        const MidiEvent *event = changes.getUnchecked(i);
-        tree.appendChild(event->serialize());
-    }
+    Note comparator;
+    changes.sort(comparator);
 
+    SerializedData tree(tag);
+    Note::packNotes(tree, changes);
     return tree;
 }
 
@@ -684,3 +645,99 @@ bool checkIfDeltaIsNotesType(const Delta *d)
 }
 
 }
+
+//===----------------------------------------------------------------------===//
+// Tests
+//===----------------------------------------------------------------------===//
+
+#if JUCE_UNIT_TESTS
+
+class PianoTrackDiffLogicTests final : public UnitTest
+{
+public:
+    PianoTrackDiffLogicTests() : UnitTest("Piano track diff logic tests", UnitTestCategories::helio) {}
+
+    void runTest() override
+    {
+        using namespace Serialization::VCS;
+
+        const auto n1 = makeNote(1, 60, 0.f);
+        const auto n2 = makeNote(2, 62, 1.f);
+        const auto n3 = makeNote(3, 64, 2.f);
+        const auto n4 = makeNote(4, 65, 3.f);
+        const auto n2moved = makeNote(2, 62, 4.f);
+
+        beginTest("Diff notes");
+        {
+            const auto diffs = VCS::createEventsDiffs(pack({ n3, n1, n2 }), pack({ n4, n2moved, n3 }));
+            expectEquals(diffs.size(), 3);
+
+            expect(diffs.getReference(0).delta->hasType(PianoSequenceDeltas::notesAdded));
+            expectNotes(diffs.getReference(0).deltaData, { n4 });
+
+            expect(diffs.getReference(1).delta->hasType(PianoSequenceDeltas::notesRemoved));
+            expectNotes(diffs.getReference(1).deltaData, { n1 });
+
+            expect(diffs.getReference(2).delta->hasType(PianoSequenceDeltas::notesChanged));
+            expectNotes(diffs.getReference(2).deltaData, { n2moved });
+
+            expectEquals(VCS::createEventsDiffs(pack({ n1, n2 }), pack({ n2, n1 })).size(), 0);
+        }
+
+        beginTest("Merge added notes");
+        {
+            // the notes already present in the state are not duplicated
+            expectNotes(VCS::mergeNotesAdded(pack({ n3, n1 }), pack({ n2, n3 })), { n1, n2, n3 });
+            expectNotes(VCS::mergeNotesAdded({}, pack({ n2, n1 })), { n1, n2 });
+        }
+
+        beginTest("Merge removed notes");
+        {
+            // the missing notes are just ignored
+            expectNotes(VCS::mergeNotesRemoved(pack({ n1, n2, n3 }), pack({ n4, n2 })), { n1, n3 });
+            expectNotes(VCS::mergeNotesRemoved(pack({ n1, n2 }), pack({ n1, n2 })), {});
+        }
+
+        beginTest("Merge changed notes");
+        {
+            // the missing notes are not added
+            expectNotes(VCS::mergeNotesChanged(pack({ n3, n2, n1 }), pack({ n4, n2moved })), { n1, n2moved, n3 });
+        }
+    }
+
+private:
+
+    static Note makeNote(Note::Id id, Note::Key key, float beat)
+    {
+        return Note(Note::Compact{ id, beat, 1.f, 1.f, key, 0 });
+    }
+
+    static SerializedData pack(Array<Note> notes)
+    {
+        return VCS::serializePianoSequence(notes, Serialization::VCS::PianoSequenceDeltas::notesAdded);
+    }
+
+    void expectNotes(const SerializedData &tree, const Array<Note> &expected)
+    {
+        Array<Note> notes;
+        Note::unpackNotes(tree, notes);
+
+        VCS::NoteIdComparator comparator;
+        notes.sort(comparator);
+
+        expectEquals(notes.size(), expected.size());
+        for (int i = 0; i < jmin(notes.size(), expected.size()); ++i)
+        {
+            const auto &note = notes.getReference(i);
+            const auto &expectedNote = expected.getReference(i);
+            expectEquals(note.getId(), expectedNote.getId());
+            expectEquals(note.getKey(), expectedNote.getKey());
+            expectEquals(note.getBeat(), expectedNote.getBeat());
+            expectEquals(note.getLength(), expectedNote.getLength());
+        }
+    }
+};
+
+static PianoTrackDiffLogicTests pianoTrackDiffLogicTests;
+
+#endif
@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "Head.h"
 #include "Diff.h"
+#include "ParallelTasks.h"
 
 namespace VCS
 {
@@ -135,12 +136,6 @@ bool Head::moveTo(const Revision::Ptr revision)
         this->stopThread(Head::diffRebuildThreadStopTimeoutMs);
     }
 
-    // first, reset the snapshot state
-    {
-        const ScopedWriteLock lock(this->stateLock);
-        this->state = make<Snapshot>();
-    }
-
     // a path from the root to current revision
     ReferenceCountedArray<Revision> treePath;
     Revision::Ptr currentRevision(revision);
@@ -150,10 +145,39 @@ bool Head::moveTo(const Revision::Ptr revision)
         currentRevision = currentRevision->getParent();
     }
 
-    // then move from the root back to target revision
-    for (const auto *rev : treePath)
+    // first, reset the snapshot state to the nearest cached one, if any
+    int startIndex = -1;
+    const Snapshot *cachedState = nullptr;
+    for (int i = treePath.size() - 1; i >= 0; --i)
+    {
+        cachedState = this->findCachedState(treePath.getObjectPointerUnchecked(i));
+        if (cachedState != nullptr)
+        {
+            startIndex = i;
+            break;
+        }
+    }
+
     {
+        const ScopedWriteLock lock(this->stateLock);
+        this->state = (cachedState != nullptr) ?
+            make<Snapshot>(cachedState) : make<Snapshot>();
+    }
+
+    // the shallow revisions have no deltas yet,
+    // so no states after them are valid to be cached
+    bool canCacheStates = true;
+    for (int i = 0; i <= startIndex; ++i)
+    {
+        canCacheStates = canCacheStates && !treePath.getObjectPointerUnchecked(i)->isShallowCopy();
+    }
+
+    // then move from there to target revision
+    for (int i = startIndex + 1; i < treePath.size(); ++i)
+    {
+        const auto *rev = treePath.getObjectPointerUnchecked(i);
         DBG("VCS head moved to " + rev->getUuid());
+        canCacheStates = canCacheStates && !rev->isShallowCopy();
 
         // picking all deltas and applying them to current state
         for (auto *item : rev->getItems())
@@ -175,6 +199,16 @@ bool Head::moveTo(const Revision::Ptr revision)
                 jassertfalse;
             }
         }
+
+        if (canCacheStates && i > 0 && (i % Head::stateCheckpointInterval) == 0)
+        {
+            this->cacheState(treePath.getUnchecked(i), true);
+        }
+    }
+
+    if (canCacheStates && revision != nullptr)
+    {
+        this->cacheState(revision, false);
     }
 
     this->headingAt = revision;
@@ -182,6 +216,56 @@ bool Head::moveTo(const Revision::Ptr revision)
     return true;
 }
 
+const Snapshot *Head::findCachedState(const Revision *revision) const
+{
+    const auto found = this->cachedStates.find(revision->getUuid());
+    if (found != this->cachedStates.end() && found->second.revision.get() == revision)
+    {
+        return found->second.state.get();
+    }
+
+    return nullptr;
+}
+
+void Head::cacheState(const Revision::Ptr revision, bool isCheckpoint)
+{
+    const auto revisionId = revision->getUuid();
+    auto &cached = this->cachedStates[revisionId];
+    if (cached.revision != revision)
+    {
+        cached.revision = revision;
+        cached.state = make<Snapshot>(this->state.get());
+    }
+
+    cached.isCheckpoint = cached.isCheckpoint || isCheckpoint;
+
+    if (cached.isCheckpoint)
+    {
+        return;
+    }
+
+    this->recentlyVisitedStates.removeString(revisionId);
+    this->recentlyVisitedStates.add(revisionId);
+
+    while (this->recentlyVisitedStates.size() > Head::maxRecentlyVisitedStates)
+    {
+        const auto leastRecentId = this->recentlyVisitedStates[0];
+        this->recentlyVisitedStates.remove(0);
+
+        const auto found = this->cachedStates.find(leastRecentId);
+        if (found != this->cachedStates.end() && !found->second.isCheckpoint)
+        {
+            this->cachedStates.erase(found);
+        }
+    }
+}
+
+void Head::invalidateCachedStates()
+{
+    this->cachedStates.clear();
+    this->recentlyVisitedStates.clear();
+}
+
 void Head::pointTo(const Revision::Ptr revision)
 {
     this->headingAt = revision;
@@ -293,12 +377,13 @@ void Head::checkout()
         }
     }
 
+    Array<RevisionItem::Ptr> stateItems;
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
-        RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-        this->checkoutItem(stateItem);
+        stateItems.add(static_cast<RevisionItem *>(this->state->getTrackedItem(i)));
     }
 
+    this->checkoutItems(stateItems);
     this->targetVcsItemsSource.onResetState();
 }
 
@@ -309,23 +394,20 @@ void Head::cherryPick(const Array<Uuid> uuids)
         return;
     }
 
-    this->targetVcsItemsSource.onBeforeResetState();
-
+    Array<RevisionItem::Ptr> stateItems;
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
         RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
 
         // если этот айтем состояния выбран юзером, то чекаут.
-        for (int j = 0; j < uuids.size(); ++j)
+        if (uuids.contains(stateItem->getUuid()))
         {
-            if (stateItem->getUuid() == uuids.getUnchecked(j))
-            {
-                this->checkoutItem(stateItem);
-                break;
-            }
+            stateItems.add(stateItem);
         }
     }
 
+    this->targetVcsItemsSource.onBeforeResetState();
+    this->checkoutItems(stateItems);
     this->targetVcsItemsSource.onResetState();
 }
 
@@ -336,14 +418,14 @@ void Head::cherryPickAll()
         return;
     }
 
-    this->targetVcsItemsSource.onBeforeResetState();
-
+    Array<RevisionItem::Ptr> stateItems;
     for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
     {
-        RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-        this->checkoutItem(stateItem);
+        stateItems.add(static_cast<RevisionItem *>(this->state->getTrackedItem(i)));
     }
 
+    this->targetVcsItemsSource.onBeforeResetState();
+    this->checkoutItems(stateItems);
     this->targetVcsItemsSource.onResetState();
 }
 
@@ -356,15 +438,239 @@ bool Head::resetChanges(const Array<RevisionItem::Ptr> &changes)
 
     this->targetVcsItemsSource.onBeforeResetState();
 
+    Array<TrackedItem *> targetItems;
+    Array<const TrackedItem *> newStates;
+
     for (const auto &item : changes)
     {
-        this->resetChangedItemToState(item);
+        auto *targetItem = this->findTargetItem(item->getUuid());
+        const auto stateItem = this->state->getItemWithUuid(item->getUuid());
+
+        if (item->getType() == RevisionItem::Type::Changed &&
+            targetItem != nullptr && stateItem != nullptr)
+        {
+            targetItems.add(targetItem);
+            newStates.add(stateItem.get());
+        }
+        else
+        {
+            this->resetChangedItemToState(item);
+        }
     }
 
+    this->resetItemStates(targetItems, newStates);
+
     this->targetVcsItemsSource.onResetState();
     return true;
 }
 
+bool Head::resetChanges(const Array<RevisionItem::Ptr> &changes,
+    SwappedStates &swappedStates)
+{
+    if (this->state == nullptr)
+    {
+        return false;
+    }
+
+    SwappedStates updatedStates;
+
+    Array<TrackedItem *> targetItems;
+    Array<const TrackedItem *> newStates;
+
+    this->targetVcsItemsSource.onBeforeResetState();
+
+    for (const auto &item : changes)
+    {
+        auto *targetItem = this->findTargetItem(item->getUuid());
+        const auto stateItem = this->state->getItemWithUuid(item->getUuid());
+
+        if (item->getType() != RevisionItem::Type::Changed ||
+            targetItem == nullptr || stateItem == nullptr)
+        {
+            this->resetChangedItemToState(item);
+            continue;
+        }
+
+        const auto existingIndex = swappedStates.indexOf(findSwappedState(swappedStates, item->getUuid()));
+        if (existingIndex >= 0)
+        {
+            UniquePointer<SwappedState> swappedState(swappedStates.removeAndReturn(existingIndex));
+            if (targetItem->swapStateWith(*swappedState->holder))
+            {
+                updatedStates.add(swappedState.release());
+                continue;
+            }
+        }
+
+        auto holder = targetItem->createStateHolder();
+        if (holder != nullptr && targetItem->swapStateWith(*holder))
+        {
+            auto swappedState = make<SwappedState>();
+            swappedState->itemId = item->getUuid();
+            swappedState->holder = move(holder);
+            updatedStates.add(swappedState.release());
+        }
+
+        // now the item is either changed or empty
+        targetItems.add(targetItem);
+        newStates.add(stateItem.get());
+    }
+
+    this->resetItemStates(targetItems, newStates);
+
+    for (auto *swappedState : updatedStates)
+    {
+        if (auto *targetItem = this->findTargetItem(swappedState->itemId))
+        {
+            swappedState->itemVersion = targetItem->getVCSStateVersion();
+        }
+    }
+
+    this->targetVcsItemsSource.onResetState();
+
+    // whatever was not related to these changes is dropped
+    swappedStates.swapWith(updatedStates);
+    return true;
+}
+
+bool Head::restoreChanges(const Array<RevisionItem::Ptr> &changes,
+    SwappedStates &swappedStates)
+{
+    if (changes.size() != swappedStates.size())
+    {
+        return false;
+    }
+
+    Array<TrackedItem *> targetItems;
+    for (const auto &item : changes)
+    {
+        auto *swappedState = findSwappedState(swappedStates, item->getUuid());
+        auto *targetItem = this->findTargetItem(item->getUuid());
+
+        if (item->getType() != RevisionItem::Type::Changed ||
+            swappedState == nullptr || targetItem == nullptr ||
+            targetItem->getVCSStateVersion() != swappedState->itemVersion)
+        {
+            return false;
+        }
+
+        targetItems.add(targetItem);
+    }
+
+    this->targetVcsItemsSource.onBeforeResetState();
+
+    for (int i = 0; i < changes.size(); ++i)
+    {
+        auto *swappedState = findSwappedState(swappedStates, changes.getUnchecked(i)->getUuid());
+        auto *targetItem = targetItems.getUnchecked(i);
+        if (!targetItem->swapStateWith(*swappedState->holder))
+        {
+            jassertfalse;
+        }
+
+        swappedState->itemVersion = targetItem->getVCSStateVersion();
+    }
+
+    this->targetVcsItemsSource.onResetState();
+    return true;
+}
+
+void Head::checkoutItems(const Array<RevisionItem::Ptr> &stateItems)
+{
+    Array<TrackedItem *> targetItems;
+    Array<const TrackedItem *> newStates;
+
+    for (const auto &stateItem : stateItems)
+    {
+        auto *targetItem = this->findTargetItem(stateItem->getUuid());
+        const auto type = stateItem->getType();
+
+        // the new items are created empty, and reset along with the rest
+        if (targetItem == nullptr && type == RevisionItem::Type::Added)
+        {
+            targetItem = this->targetVcsItemsSource.initEmptyTrackedItem(
+                stateItem->getDiffLogic()->getType(), stateItem->getUuid());
+        }
+
+        if (targetItem != nullptr &&
+            (type == RevisionItem::Type::Changed || type == RevisionItem::Type::Added))
+        {
+            targetItems.add(targetItem);
+            newStates.add(stateItem.get());
+        }
+        else
+        {
+            this->checkoutItem(stateItem);
+        }
+    }
+
+    this->resetItemStates(targetItems, newStates);
+}
+
+// creating the new states, e.g. the tracks' events, is what takes most
+// of the time when resetting large projects, so the items which support it
+// prepare their new states in parallel, and then they are swapped in here;
+// the listeners are notified once by the caller, see onResetState
+void Head::resetItemStates(const Array<TrackedItem *> &targetItems,
+    const Array<const TrackedItem *> &newStates)
+{
+    jassert(targetItems.size() == newStates.size());
+
+    OwnedArray<TrackedItem::StateHolder> preparedStates;
+    preparedStates.ensureStorageAllocated(targetItems.size());
+    for (int i = 0; i < targetItems.size(); ++i)
+    {
+        preparedStates.add(nullptr);
+    }
+
+    ParallelTasks::run(targetItems.size(), [&](int i)
+    {
+        // each task only writes its own slot, which is already allocated
+        auto preparedState = targetItems.getUnchecked(i)->
+            createStateHolder(*newStates.getUnchecked(i));
+        preparedStates.set(i, preparedState.release());
+    });
+
+    for (int i = 0; i < targetItems.size(); ++i)
+    {
+        auto *targetItem = targetItems.getUnchecked(i);
+        auto *preparedState = preparedStates.getUnchecked(i);
+
+        // after swapping, the holders keep the previous states
+        if (preparedState == nullptr || !targetItem->swapStateWith(*preparedState))
+        {
+            targetItem->resetStateTo(*newStates.getUnchecked(i));
+        }
+    }
+}
+
+TrackedItem *Head::findTargetItem(const Uuid &id) const
+{
+    for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
+    {
+        auto *item = this->targetVcsItemsSource.getTrackedItem(i);
+        if (item->getUuid() == id)
+        {
+            return item;
+        }
+    }
+
+    return nullptr;
+}
+
+Head::SwappedState *Head::findSwappedState(const SwappedStates &states, const Uuid &id)
+{
+    for (auto *swappedState : states)
+    {
+        if (swappedState->itemId == id)
+        {
+            return swappedState;
+        }
+    }
+
+    return nullptr;
+}
+
 void Head::checkoutItem(RevisionItem::Ptr stateItem)
 {
     // Changed и Added RevisionItem'ы нужно применять через resetStateTo
@@ -418,6 +724,7 @@ void Head::rebuildDiffIfNeeded()
 {
     if (this->isDiffOutdated() && !this->isThreadRunning())
     {
+        this->updateTargetSnapshots();
         this->startThread(5);
     }
 }
@@ -431,9 +738,50 @@ void Head::rebuildDiffNow()
         this->stopThread(Head::diffRebuildThreadStopTimeoutMs);
     }
 
+    this->updateTargetSnapshots();
     this->startThread(9);
 }
 
+void Head::updateTargetSnapshots()
+{
+    jassert(!this->isThreadRunning());
+
+    Array<TargetItemSnapshot> snapshots;
+    const auto numItems = this->targetVcsItemsSource.getNumTrackedItems();
+    for (int i = 0; i < numItems; ++i)
+    {
+        auto *item = this->targetVcsItemsSource.getTrackedItem(i);
+
+        TargetItemSnapshot snapshot;
+        snapshot.source = item;
+        snapshot.version = item->getVCSStateVersion();
+        snapshot.name = item->getVCSName();
+
+        if (snapshot.version != 0)
+        {
+            for (const auto &previous : this->targetSnapshots)
+            {
+                if (previous.source == item &&
+                    previous.version == snapshot.version &&
+                    previous.name == snapshot.name)
+                {
+                    snapshot.copy = previous.copy;
+                    break;
+                }
+            }
+        }
+
+        if (snapshot.copy == nullptr)
+        {
+            snapshot.copy = new RevisionItem(RevisionItem::Type::Undefined, item);
+        }
+
+        snapshots.add(snapshot);
+    }
+
+    this->targetSnapshots.swapWith(snapshots);
+}
+
 
 //===----------------------------------------------------------------------===//
 // Serializable
@@ -481,6 +829,7 @@ void Head::deserialize(const SerializedData &data)
 
 void Head::reset()
 {
+    this->invalidateCachedStates();
     this->state = make<Snapshot>();
     this->setDiffOutdated(true);
 }
@@ -502,202 +851,166 @@ void Head::changeListenerCallback(ChangeBroadcaster *source)
 
 void Head::run()
 {
+    TRACE_ZONE("Head::run");
+
     if (this->state == nullptr)
     { return; }
-    
+
+    this->setRebuildingDiffMode(true);
+    this->sendChangeMessage();
+
+    if (this->rebuildDiff(true))
+    {
+        this->setDiffOutdated(false);
+    }
+
+    this->setRebuildingDiffMode(false);
+    this->sendChangeMessage();
+}
+
+void Head::rebuildDiffSynchronously()
+{
+    if (this->state == nullptr)
+    { return; }
+
+    if (this->isThreadRunning())
+    {
+        this->stopThread(Head::diffRebuildThreadStopTimeoutMs);
+    }
+
     this->setRebuildingDiffMode(true);
+    this->updateTargetSnapshots();
+
+    if (this->rebuildDiff(false))
+    {
+        this->setDiffOutdated(false);
+    }
+
+    this->setRebuildingDiffMode(false);
     this->sendChangeMessage();
+}
+
+bool Head::rebuildDiff(bool isCancellable)
+{
+    const auto shouldExit = [this, isCancellable]()
+    {
+        return isCancellable && this->threadShouldExit();
+    };
 
     {
         const ScopedWriteLock lock(this->diffLock);
         this->diff->reset();
     }
 
-    const ScopedReadLock threadStateLock(this->stateLock);
+    const ScopedReadLock rebuildStateLock(this->stateLock);
 
-    for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
+    FlatHashMap<Uuid, RevisionItem::Ptr, UuidHash> targetItems;
+    for (const auto &snapshot : this->targetSnapshots)
     {
-        if (this->threadShouldExit())
-        {
-            this->setRebuildingDiffMode(false);
-            this->sendChangeMessage();
-            return;
-        }
+        targetItems[snapshot.copy->getUuid()] = snapshot.copy;
+    }
 
-        bool foundItemInTarget = false;
+    struct ItemToDiff final
+    {
+        int resultIndex;
+        RevisionItem::Ptr stateItem;
+        RevisionItem::Ptr targetItem;
+    };
+
+    // the records are collected in the state's order, and added
+    // all at once, so that the diff doesn't depend on the scheduling
+    const auto numStateItems = this->state->getNumTrackedItems();
+    Array<RevisionItem::Ptr> stateRecords;
+    stateRecords.resize(numStateItems);
+
+    FlatHashSet<Uuid, UuidHash> stateItemIds;
+    Array<ItemToDiff> itemsToDiff;
+    FlatHashMap<Uuid, CachedItemDiff, UuidHash> newCachedItemDiffs;
+
+    for (int i = 0; i < numStateItems; ++i)
+    {
         const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
 
         // will check `removed` records later
         if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
 
-        for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
+        stateItemIds.insert(stateItem->getUuid());
+
+        const auto foundTarget = targetItems.find(stateItem->getUuid());
+        if (foundTarget != targetItems.end())
         {
-            if (this->threadShouldExit())
+            const auto cached = this->cachedItemDiffs.find(stateItem->getUuid());
+            if (cached != this->cachedItemDiffs.end() &&
+                cached->second.stateItem == stateItem &&
+                cached->second.targetItem == foundTarget->second)
             {
-                this->setRebuildingDiffMode(false);
-                this->sendChangeMessage();
-                return;
+                // neither side has changed since the last rebuild
+                stateRecords.set(i, cached->second.record);
+                newCachedItemDiffs[stateItem->getUuid()] = cached->second;
             }
-
-            TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(j); // i.e. LayerTreeItem
-
-            // state item exists in project, adding `changed` record, if needed
-            if (stateItem->getUuid() == targetItem->getUuid())
+            else
             {
-                foundItemInTarget = true;
-
-                UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
-
-                if (itemDiff->hasAnyChanges())
-                {
-                    RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
-                    const ScopedWriteLock itemDiffLock(this->diffLock);
-                    this->diff->addItem(revisionRecord);
-                }
-
-                break;
+                // state item exists in project, will add `changed` record, if needed
+                itemsToDiff.add({ i, stateItem, foundTarget->second });
             }
         }
-
-        // state item was not found in project, adding `removed` record
-        if (! foundItemInTarget)
+        else
         {
+            // state item was not found in project, adding `removed` record
             auto emptyDiff = make<Diff>(*stateItem);
-            RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
-            const ScopedWriteLock emptyDiffLock(this->diffLock);
-            this->diff->addItem(revisionRecord);
+            stateRecords.set(i, new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
         }
     }
 
-    // search for project item that are missing (or deleted) in the state
-    for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
+    ParallelTasks::run(itemsToDiff.size(), [&](int i)
     {
-        if (this->threadShouldExit())
-        {
-            this->setRebuildingDiffMode(false);
-            this->sendChangeMessage();
-            return;
-        }
+        if (shouldExit()) { return; }
 
-        bool foundItemInState = false;
-        TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
-
-        for (int j = 0; j < this->state->getNumTrackedItems(); ++j)
+        const auto &item = itemsToDiff.getReference(i);
+        UniquePointer<Diff> itemDiff(item.targetItem->getDiffLogic()->createDiff(*item.stateItem));
+        if (itemDiff->hasAnyChanges())
         {
-            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(j));
-
-            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInState = true;
-                break;
-            }
+            // each task only writes its own slot, which is already allocated
+            stateRecords.getReference(item.resultIndex) =
+                new RevisionItem(RevisionItem::Type::Changed, itemDiff.get());
         }
+    });
 
-        // copy deltas from targetItem and add `added` record
-        if (! foundItemInState)
-        {
-            RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Added, targetItem));
-            const ScopedWriteLock lock(this->diffLock);
-            this->diff->addItem(revisionRecord);
-        }
+    if (shouldExit())
+    {
+        return false;
     }
 
-    this->setDiffOutdated(false);
-    this->setRebuildingDiffMode(false);
-    this->sendChangeMessage();
-}
-
-// FIXME: lots of duplicate code from Head::run
-void Head::rebuildDiffSynchronously()
-{
-    if (this->state == nullptr)
-    { return; }
-    
-    if (this->isRebuildingDiff())
-    { return; }
-    
-    this->setRebuildingDiffMode(true);
-    
+    for (const auto &item : itemsToDiff)
     {
-        const ScopedWriteLock lock(this->diffLock);
-        this->diff->reset();
+        newCachedItemDiffs[item.stateItem->getUuid()] =
+            { item.stateItem, item.targetItem, stateRecords[item.resultIndex] };
     }
-    
-    const ScopedReadLock rebuildStateLock(this->stateLock);
-    
-    for (int i = 0; i < this->state->getNumTrackedItems(); ++i)
+
+    // this also drops the entries of the items which are gone
+    this->cachedItemDiffs.swap(newCachedItemDiffs);
+
+    const ScopedWriteLock lock(this->diffLock);
+
+    for (const auto &record : stateRecords)
     {
-        bool foundItemInTarget = false;
-        const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(i));
-        
-        // will check `removed` records later
-        if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-        
-        for (int j = 0; j < this->targetVcsItemsSource.getNumTrackedItems(); ++j)
+        if (record != nullptr)
         {
-            auto *targetItem = this->targetVcsItemsSource.getTrackedItem(j); // i.e. MidiTrckNode
-            
-            // state item exists in project, adding `changed` record, if needed
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInTarget = true;
-                
-                UniquePointer<Diff> itemDiff(targetItem->getDiffLogic()->createDiff(*stateItem));
-                
-                if (itemDiff->hasAnyChanges())
-                {
-                    RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Changed, itemDiff.get()));
-                    const ScopedWriteLock lock(this->diffLock);
-                    this->diff->addItem(revisionRecord);
-                }
-                
-                break;
-            }
-        }
-        
-        // state item was not found in project, adding `removed` record
-        if (! foundItemInTarget)
-        {
-            auto emptyDiff = make<Diff>(*stateItem);
-            RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Removed, emptyDiff.get()));
-            const ScopedWriteLock lock(this->diffLock);
-            this->diff->addItem(revisionRecord);
+            this->diff->addItem(record);
         }
     }
-    
-    // search for project item that are missing (or deleted) in the state
-    for (int i = 0; i < this->targetVcsItemsSource.getNumTrackedItems(); ++i)
+
+    // project items that are missing (or deleted) in the state,
+    // copy deltas from targetItem and add `added` record
+    for (const auto &snapshot : this->targetSnapshots)
     {
-        bool foundItemInState = false;
-        TrackedItem *targetItem = this->targetVcsItemsSource.getTrackedItem(i);
-        
-        for (int j = 0; j < this->state->getNumTrackedItems(); ++j)
+        if (!stateItemIds.contains(snapshot.copy->getUuid()))
         {
-            const RevisionItem::Ptr stateItem = static_cast<RevisionItem *>(this->state->getTrackedItem(j));
-            
-            if (stateItem->getType() == RevisionItem::Type::Removed) { continue; }
-            
-            if (stateItem->getUuid() == targetItem->getUuid())
-            {
-                foundItemInState = true;
-                break;
-            }
-        }
-        
-        // copy deltas from targetItem and add `added` record
-        if (! foundItemInState)
-        {
-            RevisionItem::Ptr revisionRecord(new RevisionItem(RevisionItem::Type::Added, targetItem));
-            const ScopedWriteLock lock(this->diffLock);
-            this->diff->addItem(revisionRecord);
+            this->diff->addItem(new RevisionItem(RevisionItem::Type::Added, snapshot.copy.get()));
         }
     }
-    
-    this->setDiffOutdated(false);
-    this->setRebuildingDiffMode(false);
-    this->sendChangeMessage();
+
+    return true;
 }
 
 }
@@ -52,14 +52,42 @@ namespace VCS
         bool moveTo(const Revision::Ptr revision); // rebuilds state index
         void pointTo(const Revision::Ptr revision); // does not rebuild index
 
+        // committed revisions are never supposed to change, except for a few
+        // cases like fetching the shallow revisions' data or quick-amending;
+        // this must be called after any of them to drop the cached states
+        void invalidateCachedStates();
+
         void checkout();
         void cherryPick(const Array<Uuid> uuids);
         void cherryPickAll();
         bool resetChanges(const Array<RevisionItem::Ptr> &changes);
 
+        // the in-memory quick stash: the contents of the changed items,
+        // moved away from them, which makes toggling the stash cheap
+        struct SwappedState final
+        {
+            Uuid itemId;
+            UniquePointer<TrackedItem::StateHolder> holder;
+            int itemVersion = 0; // right after the last swap
+        };
+
+        using SwappedStates = OwnedArray<SwappedState>;
+
+        // same as resetChanges, but the changed items' contents are moved
+        // into the holders first; the items which already have a holder
+        // are assumed to be holding the head state, which is just swapped in
+        bool resetChanges(const Array<RevisionItem::Ptr> &changes,
+            SwappedStates &swappedStates);
+
+        // puts the moved contents back, only if all the changes have been
+        // moved, and none of the items has been edited since the last swap,
+        // otherwise returns false, and nothing is changed
+        bool restoreChanges(const Array<RevisionItem::Ptr> &changes,
+            SwappedStates &swappedStates);
+
         void rebuildDiffIfNeeded(); // called from the editor when it gets visible
         void rebuildDiffNow(); // called from the visible editor, when it receives vcs change message 
-        void rebuildDiffSynchronously(); // a hack foe quick-stash
+        void rebuildDiffSynchronously(); // a hack for quick-stash
         
         //===--------------------------------------------------------------===//
         // Serializable
@@ -82,9 +110,21 @@ namespace VCS
         //===--------------------------------------------------------------===//
 
         void run() override;
+
+        // returns false if cancelled by the diff thread's exit signal,
+        // which is only checked when called from the diff thread itself
+        bool rebuildDiff(bool isCancellable);
+
         void checkoutItem(RevisionItem::Ptr stateItem);
         bool resetChangedItemToState(const RevisionItem::Ptr diffItem);
 
+        void checkoutItems(const Array<RevisionItem::Ptr> &stateItems);
+        void resetItemStates(const Array<TrackedItem *> &targetItems,
+            const Array<const TrackedItem *> &newStates);
+
+        TrackedItem *findTargetItem(const Uuid &id) const;
+        static SwappedState *findSwappedState(const SwappedStates &states, const Uuid &id);
+
         static constexpr auto diffRebuildThreadStopTimeoutMs = 5000;
 
         ReadWriteLock outdatedMarkerLock;
@@ -102,10 +142,63 @@ namespace VCS
         ReadWriteLock stateLock;
         UniquePointer<Snapshot> state;
 
+    private:
+
+        // the materialized states of some revisions, so that moving the head
+        // only replays the deltas from the nearest cached ancestor instead of
+        // the root: the checkpoints are taken every few revisions along the
+        // replayed paths, and a few recently visited states are kept as well;
+        // snapshots are cheap to copy, because the items they share are immutable
+        struct CachedState final
+        {
+            Revision::Ptr revision;
+            UniquePointer<Snapshot> state;
+            bool isCheckpoint = false;
+        };
+
+        FlatHashMap<String, CachedState, StringHash> cachedStates;
+        StringArray recentlyVisitedStates; // least recent go first
+
+        const Snapshot *findCachedState(const Revision *revision) const;
+        void cacheState(const Revision::Ptr revision, bool isCheckpoint);
+
+        static constexpr auto stateCheckpointInterval = 32;
+        static constexpr auto maxRecentlyVisitedStates = 8;
+
     private:
 
         TrackedItemsSource &targetVcsItemsSource;
 
+        // immutable copies of the project's tracked items, which the diff
+        // thread works with instead of the live project; they are only updated
+        // on the message thread, right before the diff thread starts, and the
+        // copies of the items which report the same state version are reused
+        struct TargetItemSnapshot final
+        {
+            const TrackedItem *source = nullptr;
+            int version = 0;
+            String name; // e.g. tracks' paths might change with their groups
+            RevisionItem::Ptr copy;
+        };
+
+        Array<TargetItemSnapshot> targetSnapshots;
+        void updateTargetSnapshots();
+
+        // the last diff result for each item, which is still valid as long
+        // as both the state item and the target copy are the same objects:
+        // the state items are immutable, and the target copies are only
+        // recreated when their items' versions change, so that rebuilding
+        // the diff only re-runs the diff logic for the items changed since;
+        // only accessed by rebuildDiff, holding the pointers prevents reuse
+        struct CachedItemDiff final
+        {
+            RevisionItem::Ptr stateItem;
+            RevisionItem::Ptr targetItem;
+            RevisionItem::Ptr record; // nullptr when there are no changes
+        };
+
+        FlatHashMap<Uuid, CachedItemDiff, UuidHash> cachedItemDiffs;
+
         JUCE_LEAK_DETECTOR(Head)
 
     };
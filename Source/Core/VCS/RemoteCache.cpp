@@ -32,16 +32,48 @@ bool RemoteCache::hasRevisionTracked(const Revision::Ptr revision) const
 
 #if !NO_NETWORK
 
-void RemoteCache::updateForRemoteRevisions(const Array<RevisionDto> &revisions)
+void RemoteCache::updateForRemoteRevisions(const Array<RevisionDto> &revisions,
+    const String &newEntityTag)
 {
+    FlatHashMap<String, int64, StringHash> remoteRevisions;
+    for (const auto &child : revisions)
+    {
+        remoteRevisions[child.getId()] = child.getTimestamp();
+    }
+
     ScopedWriteLock lock(this->cacheLock);
 
-    this->fetchCache.clear();
-    for (const auto &child : revisions)
+    // only touch the entries that have changed
+    for (auto it = this->fetchCache.begin(); it != this->fetchCache.end();)
     {
-        this->fetchCache[child.getId()] = child.getTimestamp();
+        if (!remoteRevisions.contains(it->first))
+        {
+            it = this->fetchCache.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
     }
 
+    for (const auto &child : remoteRevisions)
+    {
+        this->fetchCache[child.first] = child.second;
+    }
+
+    this->entityTag = newEntityTag;
+    this->lastSyncTime = Time::getCurrentTime();
+}
+
+String RemoteCache::getEntityTag() const
+{
+    ScopedReadLock lock(this->cacheLock);
+    return this->entityTag;
+}
+
+void RemoteCache::markAsUpToDate()
+{
+    ScopedWriteLock lock(this->cacheLock);
     this->lastSyncTime = Time::getCurrentTime();
 }
 
@@ -57,10 +89,18 @@ void RemoteCache::updateForLocalRevision(const Revision::Ptr revision)
 bool RemoteCache::isOutdated() const
 {
     // if history has not been synced for at least a couple of days,
-    // version control will fetch remote revisions in a background
+    // version control will fetch remote revisions in a background;
+    // when the fetch is a cheap conditional request, it is done more often
     ScopedReadLock lock(this->cacheLock);
-    return this->fetchCache.size() > 0 &&
-        (Time::getCurrentTime() - this->lastSyncTime).inDays() > 1;
+    if (this->fetchCache.size() == 0)
+    {
+        return false;
+    }
+
+    const auto timeSinceLastSync = Time::getCurrentTime() - this->lastSyncTime;
+    return this->entityTag.isNotEmpty() ?
+        timeSinceLastSync.inMinutes() > RemoteCache::conditionalRefreshMinutes :
+        timeSinceLastSync.inDays() > 1;
 }
 
 //===----------------------------------------------------------------------===//
@@ -72,6 +112,7 @@ SerializedData RemoteCache::serialize() const
     SerializedData tree(Serialization::VCS::remoteCache);
 
     tree.setProperty(Serialization::VCS::remoteCacheSyncTime, this->lastSyncTime.toMilliseconds());
+    tree.setProperty(Serialization::VCS::remoteCacheEntityTag, this->entityTag);
 
     for (const auto &child : this->fetchCache)
     {
@@ -94,6 +135,7 @@ void RemoteCache::deserialize(const SerializedData &data)
     if (!root.isValid()) { return; }
 
     this->lastSyncTime = Time(root.getProperty(Serialization::VCS::remoteCacheSyncTime));
+    this->entityTag = root.getProperty(Serialization::VCS::remoteCacheEntityTag);
 
     forEachChildWithType(root, e, Serialization::VCS::remoteRevision)
     {
@@ -106,6 +148,7 @@ void RemoteCache::deserialize(const SerializedData &data)
 void RemoteCache::reset()
 {
     this->fetchCache.clear();
+    this->entityTag.clear();
 }
 
 }
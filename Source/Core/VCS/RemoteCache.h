@@ -34,10 +34,18 @@ namespace VCS
         bool hasRevisionTracked(const Revision::Ptr revision) const;
 
         void updateForLocalRevision(const Revision::Ptr revision);
-        void updateForRemoteRevisions(const Array<RevisionDto> &revisions);
+        void updateForRemoteRevisions(const Array<RevisionDto> &revisions,
+            const String &entityTag);
+
+        // the tag of the last fetched project info, if the backend provided any,
+        // so that the next fetch can be a conditional request
+        String getEntityTag() const;
+        void markAsUpToDate();
 
         bool isOutdated() const;
 
+        static constexpr auto conditionalRefreshMinutes = 5;
+
         //===------------------------------------------------------------------===//
         // Serializable
         //===------------------------------------------------------------------===//
@@ -51,6 +59,7 @@ namespace VCS
         ReadWriteLock cacheLock;
         FlatHashMap<String, int64, StringHash> fetchCache;
         Time lastSyncTime;
+        String entityTag;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RemoteCache)
     };
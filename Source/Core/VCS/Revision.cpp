@@ -37,8 +37,9 @@ Revision::Revision(const RevisionDto &dto) :
 
 void Revision::copyDeltasFrom(Revision::Ptr other)
 {
+    this->loadPendingItems();
     this->deltas.clearQuick();
-    for (auto *revItem : other->deltas)
+    for (auto *revItem : other->getItems())
     {
         this->deltas.add(revItem);
     }
@@ -46,13 +47,14 @@ void Revision::copyDeltasFrom(Revision::Ptr other)
 
 bool Revision::isEmpty() const noexcept
 {
-    return this->deltas.isEmpty() && this->children.isEmpty();
+    return this->isShallowCopy() && this->children.isEmpty();
 }
 
 bool Revision::isShallowCopy() const noexcept
 {
     // children might me not empty though:
-    return this->deltas.isEmpty();
+    const SpinLock::ScopedLockType lock(this->pendingItemsLock);
+    return this->deltas.isEmpty() && this->pendingItems.isEmpty();
 }
 
 int64 Revision::getTimeStamp() const noexcept
@@ -72,9 +74,30 @@ String Revision::getMessage() const noexcept
 
 const ReferenceCountedArray<RevisionItem> &Revision::getItems() const noexcept
 {
+    this->loadPendingItems();
     return this->deltas;
 }
 
+void Revision::loadPendingItems() const
+{
+    const SpinLock::ScopedLockType lock(this->pendingItemsLock);
+    if (this->pendingItems.isEmpty())
+    {
+        return;
+    }
+
+    const RevisionItem::SharedDeltaDataScope sharedDeltaData(this->pendingItemsSharedData);
+    for (const auto &e : this->pendingItems)
+    {
+        RevisionItem::Ptr item(new RevisionItem(RevisionItem::Type::Undefined, nullptr));
+        item->deserialize(e);
+        this->deltas.add(item);
+    }
+
+    this->pendingItems.clear();
+    this->pendingItemsSharedData = nullptr;
+}
+
 const ReferenceCountedArray<Revision> &Revision::getChildren() const  noexcept
 {
     return this->children;
@@ -107,11 +130,13 @@ void Revision::removeChild(Revision::Ptr revision)
 
 void Revision::addItem(RevisionItem *item)
 {
+    this->loadPendingItems();
     this->deltas.add(item);
 }
 
 void Revision::addItem(RevisionItem::Ptr item)
 {
+    this->loadPendingItems();
     this->deltas.add(item);
 }
 
@@ -128,7 +153,7 @@ SerializedData Revision::serializeDeltas() const
 {
     SerializedData tree(Serialization::VCS::revision);
 
-    for (const auto *revItem : this->deltas)
+    for (const auto *revItem : this->getItems())
     {
         tree.appendChild(revItem->serialize());
     }
@@ -146,6 +171,9 @@ void Revision::deserializeDeltas(SerializedData data)
 
     if (!root.isValid()) { return; }
 
+    // the payloads pulled from the remote might have the identical delta data shared
+    const RevisionItem::SharedDeltaDataScope sharedDeltaData(root);
+
     this->deltas.clearQuick();
 
     forEachChildWithType(root, e, Serialization::VCS::revisionItem)
@@ -164,9 +192,24 @@ SerializedData Revision::serialize() const
     tree.setProperty(Serialization::VCS::commitMessage, this->message);
     tree.setProperty(Serialization::VCS::commitTimeStamp, this->timestamp);
 
-    for (const auto *revItem : this->deltas)
     {
-        tree.appendChild(revItem->serialize());
+        const SpinLock::ScopedLockType lock(this->pendingItemsLock);
+
+        for (const auto *revItem : this->deltas)
+        {
+            tree.appendChild(revItem->serialize());
+        }
+
+        // the items not loaded yet are re-serialized via temporary objects,
+        // because their shared delta data references are only valid
+        // within the document they were loaded from
+        const RevisionItem::SharedDeltaDataScope sharedDeltaData(this->pendingItemsSharedData);
+        for (const auto &e : this->pendingItems)
+        {
+            RevisionItem::Ptr item(new RevisionItem(RevisionItem::Type::Undefined, nullptr));
+            item->deserialize(e);
+            tree.appendChild(item->serialize());
+        }
     }
 
     for (const auto *child : this->children)
@@ -201,11 +244,14 @@ void Revision::deserialize(const SerializedData &data)
         }
         else if (e.hasType(Serialization::VCS::revisionItem))
         {
-            RevisionItem::Ptr item(new RevisionItem(RevisionItem::Type::Undefined, nullptr));
-            item->deserialize(e);
-            this->addItem(item);
+            this->pendingItems.add(e);
         }
     }
+
+    if (!this->pendingItems.isEmpty())
+    {
+        this->pendingItemsSharedData = RevisionItem::SharedDeltaDataScope::getCurrentSharedData();
+    }
 }
 
 void Revision::reset()
@@ -215,6 +261,10 @@ void Revision::reset()
     this->timestamp = 0;
     this->deltas.clearQuick();
     this->children.clearQuick();
+
+    const SpinLock::ScopedLockType lock(this->pendingItemsLock);
+    this->pendingItems.clearQuick();
+    this->pendingItemsSharedData = nullptr;
 }
 
 }
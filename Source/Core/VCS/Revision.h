@@ -86,7 +86,16 @@ namespace VCS
         int64 timestamp;
 
         ReferenceCountedArray<Revision> children;
-        ReferenceCountedArray<RevisionItem> deltas;
+        mutable ReferenceCountedArray<RevisionItem> deltas;
+
+        // the local history is deserialized lazily: the metadata is read
+        // at once, but the revision items, with all their deltas and diff
+        // logics, are only created when first needed, because most of
+        // the history is never visited after the project is loaded
+        void loadPendingItems() const;
+        mutable Array<SerializedData> pendingItems;
+        mutable RevisionItem::SharedDeltaData::Ptr pendingItemsSharedData;
+        mutable SpinLock pendingItemsLock;
 
         JUCE_DECLARE_WEAK_REFERENCEABLE(Revision)
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Revision)
@@ -102,6 +102,11 @@ String RevisionItem::getVCSName() const noexcept
     return this->description;
 }
 
+Colour RevisionItem::getRevisionDisplayColour() const noexcept
+{
+    return this->displayColour;
+}
+
 DiffLogic *RevisionItem::getDiffLogic() const noexcept
 {
     return this->logic.get();
@@ -166,11 +171,18 @@ void RevisionItem::deserialize(const SerializedData &data)
         UniquePointer<Delta> delta(new Delta({}, {}));
         delta->deserialize(e);
 
-        jassert(e.getNumChildren() == 1);
         if (e.getNumChildren() == 1)
         {
             this->deltasData.add(e.getChild(0));
         }
+        else if (e.hasProperty(Serialization::VCS::sharedDeltaId))
+        {
+            this->deltasData.add(findSharedDeltaData(e.getProperty(Serialization::VCS::sharedDeltaId)));
+        }
+        else
+        {
+            jassertfalse;
+        }
 
         this->deltas.add(delta.release());
         jassert(this->deltasData.size() == this->deltas.size());
@@ -184,4 +196,155 @@ void RevisionItem::reset()
     this->vcsItemType = Type::Undefined;
 }
 
+//===----------------------------------------------------------------------===//
+// Shared delta data
+//===----------------------------------------------------------------------===//
+
+// tiny deltas, like colour or path changes, are not worth the indirection
+static constexpr auto minSharedDeltaDataSize = 256;
+
+// two different 64-bit hashes and the size, which together
+// make accidental collisions practically impossible
+static String hashDeltaData(const uint8 *data, size_t size) noexcept
+{
+    uint64 fnvHash = 14695981039346656037ull;
+    uint64 polyHash = 5381;
+    for (size_t i = 0; i < size; ++i)
+    {
+        fnvHash = (fnvHash ^ data[i]) * 1099511628211ull;
+        polyHash = polyHash * 131 + data[i];
+    }
+
+    return String::toHexString(int64(fnvHash)) + "." +
+        String::toHexString(int64(polyHash)) + "." + String(int64(size));
+}
+
+void RevisionItem::shareIdenticalDeltaData(SerializedData &tree)
+{
+    struct DeltaDataInfo final
+    {
+        SerializedData deltaNode;
+        String hash;
+    };
+
+    Array<DeltaDataInfo> deltaDataInfos;
+    FlatHashMap<String, int, StringHash> numOccurrences;
+
+    MemoryOutputStream stream;
+    Array<SerializedData> nodesToVisit;
+    nodesToVisit.add(tree);
+
+    while (!nodesToVisit.isEmpty())
+    {
+        const auto node = nodesToVisit.removeAndReturn(nodesToVisit.size() - 1);
+        if (!node.hasType(Serialization::VCS::revisionItem))
+        {
+            for (const auto &child : node)
+            {
+                nodesToVisit.add(child);
+            }
+
+            continue;
+        }
+
+        for (const auto &deltaNode : node)
+        {
+            if (deltaNode.getNumChildren() != 1) { continue; }
+
+            stream.reset();
+            deltaNode.getChild(0).writeToStream(stream);
+            if (stream.getDataSize() < minSharedDeltaDataSize) { continue; }
+
+            const auto hash = hashDeltaData(static_cast<const uint8 *>(stream.getData()), stream.getDataSize());
+            numOccurrences[hash] += 1;
+            deltaDataInfos.add({ deltaNode, hash });
+        }
+    }
+
+    SerializedData sharedNode(Serialization::VCS::sharedDeltas);
+    FlatHashMap<String, int, StringHash> sharedIds;
+
+    for (auto &info : deltaDataInfos)
+    {
+        if (numOccurrences[info.hash] < 2) { continue; }
+
+        const auto data = info.deltaNode.getChild(0);
+        info.deltaNode.removeChild(0);
+
+        const auto found = sharedIds.find(info.hash);
+        if (found != sharedIds.end())
+        {
+            info.deltaNode.setProperty(Serialization::VCS::sharedDeltaId, found->second);
+            continue;
+        }
+
+        const auto sharedId = int(sharedIds.size()) + 1;
+        sharedIds[info.hash] = sharedId;
+        info.deltaNode.setProperty(Serialization::VCS::sharedDeltaId, sharedId);
+
+        SerializedData sharedDelta(Serialization::VCS::sharedDelta);
+        sharedDelta.setProperty(Serialization::VCS::sharedDeltaId, sharedId);
+        sharedDelta.appendChild(data);
+        sharedNode.appendChild(sharedDelta);
+    }
+
+    if (sharedNode.getNumChildren() > 0)
+    {
+        tree.appendChild(sharedNode);
+    }
+}
+
+static thread_local RevisionItem::SharedDeltaDataScope *currentSharedDeltaDataScope = nullptr;
+
+RevisionItem::SharedDeltaDataScope::SharedDeltaDataScope(const SerializedData &tree) :
+    sharedData(new SharedDeltaData()),
+    previousScope(currentSharedDeltaDataScope)
+{
+    const auto sharedNode = tree.getChildWithName(Serialization::VCS::sharedDeltas);
+    forEachChildWithType(sharedNode, e, Serialization::VCS::sharedDelta)
+    {
+        if (e.getNumChildren() == 1)
+        {
+            this->sharedData->items[e.getProperty(Serialization::VCS::sharedDeltaId)] = e.getChild(0);
+        }
+    }
+
+    currentSharedDeltaDataScope = this;
+}
+
+RevisionItem::SharedDeltaDataScope::SharedDeltaDataScope(SharedDeltaData::Ptr sharedData) :
+    sharedData(sharedData),
+    previousScope(currentSharedDeltaDataScope)
+{
+    currentSharedDeltaDataScope = this;
+}
+
+RevisionItem::SharedDeltaData::Ptr RevisionItem::SharedDeltaDataScope::getCurrentSharedData()
+{
+    return currentSharedDeltaDataScope != nullptr ?
+        currentSharedDeltaDataScope->sharedData : nullptr;
+}
+
+RevisionItem::SharedDeltaDataScope::~SharedDeltaDataScope()
+{
+    jassert(currentSharedDeltaDataScope == this);
+    currentSharedDeltaDataScope = this->previousScope;
+}
+
+SerializedData RevisionItem::findSharedDeltaData(int sharedId)
+{
+    if (currentSharedDeltaDataScope != nullptr && currentSharedDeltaDataScope->sharedData != nullptr)
+    {
+        const auto &items = currentSharedDeltaDataScope->sharedData->items;
+        const auto found = items.find(sharedId);
+        if (found != items.end())
+        {
+            return found->second;
+        }
+    }
+
+    jassertfalse;
+    return {};
+}
+
 }
@@ -51,6 +51,7 @@ namespace VCS
         SerializedData getDeltaData(int deltaIndex) const noexcept override;
 
         String getVCSName() const noexcept override;
+        Colour getRevisionDisplayColour() const noexcept override;
         DiffLogic *getDiffLogic() const noexcept override;
         void resetStateTo(const TrackedItem &newState) noexcept override {} // never reset
 
@@ -64,8 +65,47 @@ namespace VCS
 
         using Ptr = ReferenceCountedObjectPtr<RevisionItem>;
 
+        //===--------------------------------------------------------------===//
+        // Shared delta data
+        //===--------------------------------------------------------------===//
+
+        // identical delta data, like the states of unchanged tracks repeated
+        // across the history, stashes and the head snapshot, are saved once:
+        // the serialized tree is post-processed to move them into a separate
+        // node, and while the scope exists, the revision items deserialized
+        // pick them up from there by reference, so they also share memory
+        static void shareIdenticalDeltaData(SerializedData &tree);
+
+        struct SharedDeltaData final : public ReferenceCountedObject
+        {
+            using Ptr = ReferenceCountedObjectPtr<SharedDeltaData>;
+            FlatHashMap<int, SerializedData> items;
+        };
+
+        class SharedDeltaDataScope final
+        {
+        public:
+
+            explicit SharedDeltaDataScope(const SerializedData &tree);
+            explicit SharedDeltaDataScope(SharedDeltaData::Ptr sharedData);
+            ~SharedDeltaDataScope();
+
+            // for those who deserialize revision items later, out of the scope
+            static SharedDeltaData::Ptr getCurrentSharedData();
+
+        private:
+
+            SharedDeltaData::Ptr sharedData;
+            SharedDeltaDataScope *previousScope = nullptr;
+
+            friend class RevisionItem;
+            JUCE_DECLARE_NON_COPYABLE(SharedDeltaDataScope)
+        };
+
     private:
 
+        static SerializedData findSharedDeltaData(int sharedId);
+
         OwnedArray<Delta> deltas;
         Array<SerializedData> deltasData;
         UniquePointer<DiffLogic> logic;
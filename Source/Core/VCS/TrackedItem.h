@@ -45,6 +45,42 @@ namespace VCS
         virtual DiffLogic *getDiffLogic() const = 0;
         virtual void resetStateTo(const TrackedItem &newState) = 0;
 
+        // optional, for the items which can tell when their state changes:
+        // Head reuses the copies of the items, which report the same version,
+        // between diff rebuilds; zero means the item needs to be copied each time
+        virtual int getVCSStateVersion() const noexcept { return 0; }
+
+        // all versions are unique across all items,
+        // so that a new item never reports an old item's version
+        static int createVCSStateVersion() noexcept
+        {
+            static Atomic<int> lastVersion = 0;
+            return ++lastVersion;
+        }
+
+        // optional, for toggling the quick stash cheaply: the item's content
+        // can be moved into an opaque in-memory holder and back, with no
+        // serialization round trip; the holder is created empty, and each
+        // swap exchanges its content with the item's one, so after the first
+        // swap the item is empty and needs to be reset to some state
+        class StateHolder
+        {
+        public:
+            virtual ~StateHolder() = default;
+        };
+
+        virtual UniquePointer<StateHolder> createStateHolder() const { return nullptr; }
+        virtual bool swapStateWith(StateHolder &holder) { return false; }
+
+        // optional, for resetting many items at once: creates a holder
+        // filled with the given state, to be swapped in instead of calling
+        // resetStateTo; this does the expensive part, like creating the events,
+        // so it is called on the worker threads, and must not modify the item
+        virtual UniquePointer<StateHolder> createStateHolder(const TrackedItem &newState) const
+        {
+            return nullptr;
+        }
+
         void serializeVCSUuid(SerializedData &tree) const
         {
             tree.setProperty(Serialization::VCS::vcsItemId, this->getUuid().toString());
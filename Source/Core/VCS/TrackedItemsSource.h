@@ -37,6 +37,12 @@ namespace VCS
         virtual TrackedItem *initTrackedItem(const Identifier &type,
             const Uuid &id, const VCS::TrackedItem &newState) { return nullptr; }
 
+        // optional, same as above, but the new item is left empty, and then
+        // reset by the caller along with the others, so that the states
+        // of many new items can be prepared in parallel, see Head::checkoutItems
+        virtual TrackedItem *initEmptyTrackedItem(const Identifier &type,
+            const Uuid &id) { return nullptr; }
+
         virtual bool deleteTrackedItem(TrackedItem *item) { return false; }
         virtual void clearAllTrackedItems()
         {
@@ -84,6 +84,8 @@ void VersionControl::replaceHistory(const VCS::Revision::Ptr root)
     // which means we're cloning project and replacing stub root with valid one:
     DBG("Replacing history tree");
     this->rootRevision = root;
+    this->head.invalidateCachedStates();
+    this->invalidateQuickStashStates();
     // make sure head doesn't point to replaced revision:
     this->head.moveTo(this->rootRevision);
     this->sendChangeMessage();
@@ -106,6 +108,8 @@ VCS::Revision::Ptr VersionControl::updateShallowRevisionData(const String &id, c
         if (revision->isShallowCopy())
         {
             revision->deserializeDeltas(data);
+            this->head.invalidateCachedStates();
+            this->invalidateQuickStashStates();
             this->sendChangeMessage();
         }
 
@@ -122,6 +126,8 @@ void VersionControl::quickAmendItem(VCS::TrackedItem *targetItem)
     // changes and deletions to committed items will not work:
     VCS::RevisionItem::Ptr revisionRecord(new VCS::RevisionItem(VCS::RevisionItem::Type::Added, targetItem));
     this->head.getHeadingRevision()->addItem(revisionRecord);
+    this->head.invalidateCachedStates();
+    this->invalidateQuickStashStates();
     this->head.moveTo(this->head.getHeadingRevision());
     this->sendChangeMessage();
 }
@@ -256,7 +262,24 @@ bool VersionControl::quickStashAll()
 
     VCS::Revision::Ptr allChanges(this->head.getDiff());
     this->stashes->storeQuickStash(allChanges);
-    this->resetAllChanges();
+
+    // for toggling between the changes and the head state, which
+    // is used a lot, the changed items' contents are not re-created
+    // from the deltas each time, but moved away and back in memory;
+    // the stash revision is still stored, so that it can be saved
+    if (this->quickStashStatesRevision != this->head.getHeadingRevision())
+    {
+        this->quickStashStates.clear();
+    }
+
+    Array<VCS::RevisionItem::Ptr> changesToReset;
+    for (auto *item : allChanges->getItems())
+    {
+        changesToReset.add(item);
+    }
+
+    this->head.resetChanges(changesToReset, this->quickStashStates);
+    this->quickStashStatesRevision = this->head.getHeadingRevision();
 
     this->sendChangeMessage();
     return true;
@@ -266,7 +289,23 @@ bool VersionControl::restoreQuickStash()
 {
     if (! this->hasQuickStash())
     { return false; }
-    
+
+    Array<VCS::RevisionItem::Ptr> stashedChanges;
+    for (auto *item : this->stashes->getQuickStash()->getItems())
+    {
+        stashedChanges.add(item);
+    }
+
+    if (this->quickStashStatesRevision == this->head.getHeadingRevision() &&
+        this->head.restoreChanges(stashedChanges, this->quickStashStates))
+    {
+        this->stashes->resetQuickStash();
+        this->sendChangeMessage();
+        return true;
+    }
+
+    this->invalidateQuickStashStates();
+
     VCS::Head tempHead(this->head);
     tempHead.mergeStateWith(this->stashes->getQuickStash());
     tempHead.cherryPickAll();
@@ -276,6 +315,12 @@ bool VersionControl::restoreQuickStash()
     return true;
 }
 
+void VersionControl::invalidateQuickStashStates()
+{
+    this->quickStashStates.clear();
+    this->quickStashStatesRevision = nullptr;
+}
+
 //===----------------------------------------------------------------------===//
 // ChangeListener
 //===----------------------------------------------------------------------===//
@@ -351,12 +396,23 @@ void VersionControl::updateLocalSyncCache(const VCS::Revision::Ptr revision)
     this->sendChangeMessage();
 }
 
-void VersionControl::updateRemoteSyncCache(const Array<RevisionDto> &revisions)
+void VersionControl::updateRemoteSyncCache(const Array<RevisionDto> &revisions,
+    const String &entityTag)
 {
-    this->remoteCache.updateForRemoteRevisions(revisions);
+    this->remoteCache.updateForRemoteRevisions(revisions, entityTag);
     this->sendChangeMessage();
 }
 
+void VersionControl::markRemoteSyncCacheAsUpToDate()
+{
+    this->remoteCache.markAsUpToDate();
+}
+
+String VersionControl::getRemoteSyncCacheEntityTag() const
+{
+    return this->remoteCache.getEntityTag();
+}
+
 VCS::Revision::SyncState VersionControl::getRevisionSyncState(const VCS::Revision::Ptr revision) const
 {
     if (!revision->isShallowCopy() && this->remoteCache.hasRevisionTracked(revision))
@@ -392,6 +448,7 @@ SerializedData VersionControl::serialize() const
     tree.appendChild(this->remoteCache.serialize());
 #endif
 
+    VCS::RevisionItem::shareIdenticalDeltaData(tree);
     return tree;
 }
 
@@ -406,6 +463,7 @@ void VersionControl::deserialize(const SerializedData &data)
 
     const String headId = root.getProperty(Serialization::VCS::headRevisionId);
 
+    const VCS::RevisionItem::SharedDeltaDataScope sharedDeltaData(root);
     this->rootRevision->deserialize(root);
     this->stashes->deserialize(root);
 
@@ -451,6 +509,7 @@ void VersionControl::deserialize(const SerializedData &data)
 
 void VersionControl::reset()
 {
+    this->invalidateQuickStashStates();
     this->rootRevision->reset();
     this->head.reset();
     this->stashes->reset();
@@ -90,7 +90,10 @@ public:
     void fetchRevisionsIfNeeded();
 
     void updateLocalSyncCache(const VCS::Revision::Ptr revision);
-    void updateRemoteSyncCache(const Array<RevisionDto> &revisions);
+    void updateRemoteSyncCache(const Array<RevisionDto> &revisions,
+        const String &entityTag = {});
+    void markRemoteSyncCacheAsUpToDate();
+    String getRemoteSyncCacheEntityTag() const;
     VCS::Revision::SyncState getRevisionSyncState(const VCS::Revision::Ptr revision) const;
 
 #endif
@@ -116,6 +119,13 @@ protected:
     VCS::Head head;
     VCS::StashesRepository::Ptr stashes;
     VCS::Revision::Ptr rootRevision; // the history tree itself
+
+    // the quick stash contents kept in memory, see quickStashAll,
+    // and the revision they are valid for, since the swapped out
+    // contents are the head state after the stash is restored
+    VCS::Head::SwappedStates quickStashStates;
+    VCS::Revision::Ptr quickStashStatesRevision;
+    void invalidateQuickStashStates();
 #if !NO_NETWORK
     VCS::RemoteCache remoteCache;
 #endif
@@ -42,6 +42,7 @@ void RecentProjectInfo::updateRemoteInfo(const ProjectDto &remoteInfo)
     this->remote->title = remoteInfo.getTitle();
     this->remote->alias = remoteInfo.getAlias();
     this->remote->lastModifiedMs = remoteInfo.getUpdateTime();
+    this->updateSummary();
 }
 
 #endif
@@ -68,6 +69,7 @@ void RecentProjectInfo::updateLocalInfo(const String &localId,
     this->local->title = localTitle;
     this->local->path = localPath;
     this->local->lastModifiedMs = Time::currentTimeMillis();
+    this->updateSummary();
 }
 
 void RecentProjectInfo::updateLocalTimestampAsNow()
@@ -76,17 +78,55 @@ void RecentProjectInfo::updateLocalTimestampAsNow()
     if (this->local != nullptr)
     {
         this->local->lastModifiedMs = Time::currentTimeMillis();
+        this->updateSummary();
     }
 }
 
+bool RecentProjectInfo::updateLocalStats(int numTracks, int numEvents)
+{
+    if (this->local == nullptr ||
+        (this->local->numTracks == numTracks && this->local->numEvents == numEvents))
+    {
+        return false;
+    }
+
+    this->local->numTracks = numTracks;
+    this->local->numEvents = numEvents;
+    return true;
+}
+
+bool RecentProjectInfo::hasLocalStats() const noexcept
+{
+    return this->local != nullptr && this->local->numTracks >= 0;
+}
+
+String RecentProjectInfo::getLocalStats() const
+{
+    if (!this->hasLocalStats())
+    {
+        return {};
+    }
+
+    return RecentProjectInfo::formatStats(this->local->numTracks, this->local->numEvents);
+}
+
+String RecentProjectInfo::formatStats(int numTracks, int numEvents)
+{
+    return TRANS_PLURAL("{x} layers", numTracks) + " " +
+        TRANS(I18n::Common::conjunction) + " " +
+        TRANS_PLURAL("{x} events", numEvents);
+}
+
 void RecentProjectInfo::resetLocalInfo()
 {
     this->local = nullptr;
+    this->updateSummary();
 }
 
 void RecentProjectInfo::resetRemoteInfo()
 {
     this->remote = nullptr;
+    this->updateSummary();
 }
 
 String RecentProjectInfo::getProjectId() const noexcept
@@ -110,40 +150,37 @@ File RecentProjectInfo::getLocalFile() const
 
 String RecentProjectInfo::getTitle() const
 {
-    if (this->local != nullptr)
-    {
-        if (this->remote != nullptr &&
-            this->remote->lastModifiedMs > this->local->lastModifiedMs)
-        {
-            return this->remote->title;
-        }
-
-        return this->local->title;
-    }
-    else if (this->remote != nullptr)
-    {
-        return this->remote->title;
-    }
-
-    return {};
+    return this->title;
 }
 
 Time RecentProjectInfo::getUpdatedAt() const noexcept
+{
+    return Time(this->updatedAtMs);
+}
+
+void RecentProjectInfo::updateSummary()
 {
     if (this->local != nullptr && this->remote != nullptr)
     {
-        return Time(jmax(this->remote->lastModifiedMs, this->local->lastModifiedMs));
+        const bool isRemoteNewer = this->remote->lastModifiedMs > this->local->lastModifiedMs;
+        this->title = isRemoteNewer ? this->remote->title : this->local->title;
+        this->updatedAtMs = jmax(this->remote->lastModifiedMs, this->local->lastModifiedMs);
     }
     else if (this->local != nullptr)
     {
-        return Time(this->local->lastModifiedMs);
+        this->title = this->local->title;
+        this->updatedAtMs = this->local->lastModifiedMs;
     }
     else if (this->remote != nullptr)
     {
-        return Time(this->remote->lastModifiedMs);
+        this->title = this->remote->title;
+        this->updatedAtMs = this->remote->lastModifiedMs;
+    }
+    else
+    {
+        this->title.clear();
+        this->updatedAtMs = 0;
     }
-
-    return {};
 }
 
 bool RecentProjectInfo::hasLocalCopy() const noexcept
@@ -172,9 +209,9 @@ int RecentProjectInfo::compareElements(RecentProjectInfo *first, RecentProjectIn
         return 0;
     }
 
-    const auto firstLocalTime = first->getUpdatedAt();
-    const auto secondLocalTime = second->getUpdatedAt();
-    return (firstLocalTime < secondLocalTime) - (firstLocalTime > secondLocalTime);
+    const auto firstTime = first->updatedAtMs;
+    const auto secondTime = second->updatedAtMs;
+    return (firstTime < secondTime) - (firstTime > secondTime);
 }
 
 SerializedData RecentProjectInfo::serialize() const
@@ -190,6 +227,11 @@ SerializedData RecentProjectInfo::serialize() const
         localRoot.setProperty(RecentProjects::path, this->local->path.getFullPathName());
         localRoot.setProperty(RecentProjects::title, this->local->title);
         localRoot.setProperty(RecentProjects::updatedAt, this->local->lastModifiedMs);
+        if (this->local->numTracks >= 0)
+        {
+            localRoot.setProperty(RecentProjects::numTracks, this->local->numTracks);
+            localRoot.setProperty(RecentProjects::numEvents, this->local->numEvents);
+        }
         root.appendChild(localRoot);
     }
 
@@ -224,6 +266,8 @@ void RecentProjectInfo::deserialize(const SerializedData &data)
         this->local->path = localRoot.getProperty(RecentProjects::path);
         this->local->title = localRoot.getProperty(RecentProjects::title);
         this->local->lastModifiedMs = localRoot.getProperty(RecentProjects::updatedAt);
+        this->local->numTracks = localRoot.getProperty(RecentProjects::numTracks, -1);
+        this->local->numEvents = localRoot.getProperty(RecentProjects::numEvents, 0);
     }
 
     const auto remoteRoot(root.getChildWithName(RecentProjects::remoteProjectInfo));
@@ -234,10 +278,13 @@ void RecentProjectInfo::deserialize(const SerializedData &data)
         this->remote->title = remoteRoot.getProperty(RecentProjects::title);
         this->remote->lastModifiedMs = remoteRoot.getProperty(RecentProjects::updatedAt);
     }
+
+    this->updateSummary();
 }
 
 void RecentProjectInfo::reset()
 {
     this->local.reset();
     this->remote.reset();
+    this->updateSummary();
 }
@@ -46,6 +46,16 @@ public:
     void updateLocalInfo(const String &localId, const String &localTitle, const String &localPath);
     void updateLocalTimestampAsNow();
 
+    // the stats are collected when the project is loaded or saved,
+    // so that the dashboard can show them without loading the project;
+    // returns true if they have changed
+    bool updateLocalStats(int numTracks, int numEvents);
+    bool hasLocalStats() const noexcept;
+    String getLocalStats() const;
+
+    // e.g. "3 layers and 1024 events"
+    static String formatStats(int numTracks, int numEvents);
+
     void resetLocalInfo();
     void resetRemoteInfo();
 
@@ -67,6 +77,8 @@ private:
         File path;
         String title;
         int64 lastModifiedMs;
+        int numTracks = -1; // i.e. unknown
+        int numEvents = 0;
     };
 
     struct RemoteInfo final
@@ -81,5 +93,11 @@ private:
     UniquePointer<LocalInfo> local;
     UniquePointer<RemoteInfo> remote;
 
+    // the merged title and timestamp, kept up to date on every change,
+    // so that sorting and listing hundreds of projects is cheap
+    String title;
+    int64 updatedAtMs = 0;
+    void updateSummary();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecentProjectInfo)
 };
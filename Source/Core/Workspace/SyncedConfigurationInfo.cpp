@@ -52,6 +52,11 @@ String SyncedConfigurationInfo::getName() const noexcept
     return this->name;
 }
 
+String SyncedConfigurationInfo::getHash() const noexcept
+{
+    return this->hash;
+}
+
 void SyncedConfigurationInfo::deserialize(const SerializedData &data)
 {
     this->reset();
@@ -34,6 +34,7 @@ public:
 
     Identifier getType() const noexcept;
     String getName() const noexcept;
+    String getHash() const noexcept;
 
     bool equals(const ConfigurationResource::Ptr resource) const noexcept;
 
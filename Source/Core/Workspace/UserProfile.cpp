@@ -68,6 +68,14 @@ void UserProfile::updateProfile(const UserProfileDto &dto)
         this->sessions.addSorted(kSessionsSort, new UserSessionInfo(s));
     }
 
+    // the hashes of resources as of the last sync, to detect
+    // which of them were changed remotely since then, e.g. on another machine
+    FlatHashMap<String, String, StringHash> lastSyncedHashes;
+    for (const auto *resource : this->resources)
+    {
+        lastSyncedHashes[resource->getType().toString() + "/" + resource->getName()] = resource->getHash();
+    }
+
     const auto &localConfig = App::Config().getAllResources();
     this->resources.clearQuick();
     for (const auto &r : dto.getResources())
@@ -80,9 +88,13 @@ void UserProfile::updateProfile(const UserProfileDto &dto)
             isPresentLocally = foundType->second->containsUserResourceWithId(r.getName());
         }
 
+        const auto lastSyncedHash = lastSyncedHashes.find(r.getType() + "/" + r.getName());
+        const bool hasChangedRemotely = lastSyncedHash != lastSyncedHashes.end() &&
+            lastSyncedHash->second != r.getHash();
+
         const int i = this->resources.addSorted(kResourcesSort, new SyncedConfigurationInfo(r));
 
-        if (!isPresentLocally)
+        if (!isPresentLocally || hasChangedRemotely)
         {
             DBG("Found new user configuration to be synced: " + r.getType() + "/" + r.getName());
             const auto configToFetch = this->resources[i];
@@ -105,8 +117,16 @@ void UserProfile::onConfigurationInfoUpdated(const UserResourceDto &dto)
         if (resource->getName() == dto.getName() &&
             resource->getType().toString() == dto.getType())
         {
-            // already has that info, no need to send change message;
-            return;
+            if (resource->getHash() == dto.getHash())
+            {
+                // already has that info, no need to send change message;
+                return;
+            }
+
+            // keep the hash up to date, so that this very upload
+            // is not considered a remote change on the next profile update
+            this->resources.removeObject(resource);
+            break;
         }
     }
 
@@ -123,7 +143,7 @@ void UserProfile::onProjectRemoteInfoUpdated(const ProjectDto &info)
     }
     else
     {
-        this->projects.addSorted(kProjectsSort, new RecentProjectInfo(info));
+        this->addProject(new RecentProjectInfo(info));
     }
 
     this->sendChangeMessage();
@@ -190,12 +210,23 @@ void UserProfile::onProjectLocalInfoUpdated(const String &id, const String &titl
     }
     else
     {
-        this->projects.addSorted(kProjectsSort, new RecentProjectInfo(id, title, path));
+        this->addProject(new RecentProjectInfo(id, title, path));
     }
 
     this->sendChangeMessage();
 }
 
+void UserProfile::onProjectStatsUpdated(const String &id, int numTracks, int numEvents)
+{
+    if (auto *project = this->findProject(id))
+    {
+        if (project->updateLocalStats(numTracks, numEvents))
+        {
+            this->sendChangeMessage();
+        }
+    }
+}
+
 void UserProfile::onProjectLocalInfoReset(const String &id)
 {
     if (auto *project = this->findProject(id))
@@ -203,7 +234,7 @@ void UserProfile::onProjectLocalInfoReset(const String &id)
         project->resetLocalInfo();
         if (!project->isValid()) // i.e. doesn't have a remote copy
         {
-            this->projects.removeObject(project);
+            this->removeProject(project);
         }
         this->sendChangeMessage();
     }
@@ -216,7 +247,7 @@ void UserProfile::onProjectRemoteInfoReset(const String &id)
         project->resetRemoteInfo();
         if (!project->isValid()) // i.e. doesn't have a local copy
         {
-            this->projects.removeObject(project);
+            this->removeProject(project);
         }
         this->sendChangeMessage();
     }
@@ -320,19 +351,22 @@ const UserProfile::ResourcesList &UserProfile::getResources() const noexcept
     return this->resources;
 }
 
-// there won't be too much projects, so linear search should be ok
-// (might have to replace this with binary search someday though)
 RecentProjectInfo *UserProfile::findProject(const String &id) const
 {
-    for (auto *project : this->projects)
-    {
-        if (project->getProjectId() == id)
-        {
-            return project;
-        }
-    }
+    const auto found = this->projectsIndex.find(id);
+    return found != this->projectsIndex.end() ? found->second : nullptr;
+}
 
-    return nullptr;
+void UserProfile::addProject(RecentProjectInfo *project)
+{
+    this->projectsIndex[project->getProjectId()] = project;
+    this->projects.addSorted(kProjectsSort, project);
+}
+
+void UserProfile::removeProject(RecentProjectInfo *project)
+{
+    this->projectsIndex.erase(project->getProjectId());
+    this->projects.removeObject(project);
 }
 
 #if !NO_NETWORK
@@ -436,9 +470,14 @@ void UserProfile::deserialize(const SerializedData &data)
     {
         RecentProjectInfo::Ptr p(new RecentProjectInfo());
         p->deserialize(child);
-        if (p->isValid())
+        // not checking if the local files exist here, which would touch
+        // every project file at startup; the missing ones are removed
+        // from the list when failed to load, see DashboardMenu::loadFile
+        if (p->getProjectId().isNotEmpty() &&
+            (p->hasLocalCopy() || p->hasRemoteCopy()) &&
+            this->findProject(p->getProjectId()) == nullptr)
         {
-            this->projects.addSorted(kProjectsSort, p.get());
+            this->addProject(p.get());
         }
     }
     
@@ -470,6 +509,7 @@ void UserProfile::deserialize(const SerializedData &data)
 void UserProfile::reset()
 {
     this->projects.clearQuick();
+    this->projectsIndex.clear();
 #if !NO_NETWORK
     this->sessions.clearQuick();
 #endif
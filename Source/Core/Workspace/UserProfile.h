@@ -34,6 +34,7 @@ public:
     void onProjectUnloaded(const String &id);
     void onProjectLocalInfoUpdated(const String &id, const String &title, const String &path);
     void onProjectLocalInfoReset(const String &id);
+    void onProjectStatsUpdated(const String &id, int numTracks, int numEvents);
 
     void onProjectRemoteInfoReset(const String &id);
     void onConfigurationInfoReset(const Identifier &type, const String &name);
@@ -94,6 +95,8 @@ public:
 private:
 
     RecentProjectInfo *findProject(const String &id) const;
+    void addProject(RecentProjectInfo *project);
+    void removeProject(RecentProjectInfo *project);
 
 #if !NO_NETWORK
     UserSessionInfo *findSession(const String &deviceId) const;
@@ -113,6 +116,9 @@ private:
     ProjectsList projects;
     ResourcesList resources;
 
+    // project id to the item of the sorted list above
+    FlatHashMap<String, RecentProjectInfo *, StringHash> projectsIndex;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(UserProfile)
     JUCE_DECLARE_WEAK_REFERENCEABLE(UserProfile)
 };
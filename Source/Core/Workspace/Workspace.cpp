@@ -25,6 +25,7 @@
 #include "SettingsNode.h"
 #include "OrchestraPitNode.h"
 #include "ProjectNode.h"
+#include "Transport.h"
 #include "SerializationKeys.h"
 #include "CommandPaletteProjectsList.h"
 #include "MainLayout.h"
@@ -40,9 +41,12 @@ void Workspace::init()
 {
     if (! this->wasInitialized)
     {
+        PhaseLog initLog("Workspace init");
+
         this->audioCore = make<AudioCore>();
         this->pluginManager = make<PluginScanner>();
         this->treeRoot = make<RootNode>("Workspace");
+        initLog.endPhase("audio core");
 
         this->consoleProjectsList = make<CommandPaletteProjectsList>(*this);
 
@@ -58,6 +62,27 @@ void Workspace::init()
     }
 }
 
+void Workspace::initHeadless()
+{
+    if (! this->wasInitialized)
+    {
+        this->isHeadless = true;
+
+        this->audioCore = make<AudioCore>();
+        this->pluginManager = make<PluginScanner>();
+        this->treeRoot = make<RootNode>("Workspace");
+
+        if (! this->autoload())
+        {
+            this->getAudioCore().autodetectAudioDeviceSetup();
+        }
+
+        // the projects may still refer to the built-in instruments
+        this->getAudioCore().initBuiltInInstrumentsIfNeeded();
+        this->wasInitialized = true;
+    }
+}
+
 bool Workspace::isInitialized() const noexcept
 {
     return this->wasInitialized;
@@ -297,6 +322,33 @@ bool Workspace::hasLoadedProject(const RecentProjectInfo::Ptr file) const
     return false;
 }
 
+void Workspace::onProjectActivated(ProjectNode *project)
+{
+    jassert(project != nullptr);
+
+    for (int i = this->recentlyActiveProjects.size(); --i >= 0;)
+    {
+        const auto *recentProject = this->recentlyActiveProjects.getReference(i).get();
+        if (recentProject == nullptr || recentProject == project)
+        {
+            this->recentlyActiveProjects.remove(i);
+        }
+    }
+
+    this->recentlyActiveProjects.insert(0, project);
+
+    while (this->recentlyActiveProjects.size() > Workspace::numProjectsWithPlaybackCache)
+    {
+        auto *evictedProject = dynamic_cast<ProjectNode *>(this->recentlyActiveProjects.getLast().get());
+        this->recentlyActiveProjects.removeLast();
+        if (evictedProject != nullptr)
+        {
+            DBG("Releasing the playback cache of " + evictedProject->getName());
+            evictedProject->getTransport().releasePlaybackCache();
+        }
+    }
+}
+
 void Workspace::stopPlaybackForAllProjects()
 {
     for (auto *project : this->getLoadedProjects())
@@ -305,13 +357,21 @@ void Workspace::stopPlaybackForAllProjects()
     }
 }
 
+void Workspace::releaseMemory()
+{
+    for (auto *project : this->getLoadedProjects())
+    {
+        project->releaseMemory();
+    }
+}
+
 //===----------------------------------------------------------------------===//
 // Save/Load/Init
 //===----------------------------------------------------------------------===//
 
 void Workspace::autosave()
 {
-    if (! this->wasInitialized)
+    if (! this->wasInitialized || this->isHeadless)
     {
         return;
     }
@@ -352,6 +412,19 @@ void Workspace::failedDeserializationFallback()
     this->autosave();
 }
 
+#if JUCE_DEBUG
+
+void Workspace::createGeneratedProject()
+{
+    if (auto *p = this->treeRoot->addGeneratedProject())
+    {
+        this->userProfile.onProjectLocalInfoUpdated(p->getId(),
+            p->getName(), p->getDocument()->getFullPath());
+    }
+}
+
+#endif
+
 void Workspace::importProject(const String &filePattern)
 {
 #if JUCE_ANDROID
@@ -478,6 +551,37 @@ SerializedData Workspace::serialize() const
     return tree;
 }
 
+// see ProjectNode::deserialize
+static void collectProjectFiles(const SerializedData &node, Array<File> &result)
+{
+    using namespace Serialization;
+    if (node.hasType(Core::treeNode) && node.hasProperty(Core::filePath))
+    {
+        const File fullPathFile = File(node.getProperty(Core::filePath));
+        const File relativePathFile = DocumentHelpers::getDocumentSlot(fullPathFile.getFileName());
+        if (fullPathFile.existsAsFile())
+        {
+            result.addIfNotAlreadyThere(fullPathFile);
+        }
+        else if (relativePathFile.existsAsFile())
+        {
+            result.addIfNotAlreadyThere(relativePathFile);
+        }
+    }
+
+    for (const auto &child : node)
+    {
+        collectProjectFiles(child, result);
+    }
+}
+
+static Array<File> findProjectFiles(const SerializedData &treeRootNode)
+{
+    Array<File> result;
+    collectProjectFiles(treeRootNode, result);
+    return result;
+}
+
 void Workspace::deserialize(const SerializedData &data)
 {
     this->reset();
@@ -489,18 +593,42 @@ void Workspace::deserialize(const SerializedData &data)
     if (!root.isValid())
     {
         // Always fallback to default workspace
-        this->failedDeserializationFallback();
+        if (this->isHeadless)
+        {
+            this->getAudioCore().autodetectAudioDeviceSetup();
+        }
+        else
+        {
+            this->failedDeserializationFallback();
+        }
+
         return;
     }
 
+    PhaseLog loadLog("Workspace load");
+
     this->userProfile.deserialize(root);
     this->audioCore->deserialize(root);
+    loadLog.endPhase("audio devices and instruments");
+
     this->pluginManager->deserialize(root);
+    loadLog.endPhase("plugins list");
+
+    if (this->isHeadless)
+    {
+        return;
+    }
 
     const auto treeRootNode = root.getChildWithName(Core::treeRoot);
     jassert(treeRootNode.isValid());
 
-    this->treeRoot->deserialize(treeRootNode);
+    {
+        // parse all projects' documents at once, then create their nodes
+        const DocumentHelpers::ParallelLoader preloadedProjects(findProjectFiles(treeRootNode));
+        this->treeRoot->deserialize(treeRootNode);
+    }
+
+    loadLog.endPhase("projects");
     
     bool foundActiveNode = false;
     const auto treeStateNode = root.getChildWithName(Core::treeState);
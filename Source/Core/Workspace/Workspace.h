@@ -37,8 +37,14 @@ public:
 
     void init();
     void shutdown();
+
+    // only restores the audio settings and instruments, but no projects,
+    // and never saves the workspace back, see HeadlessRender
+    void initHeadless();
+
     bool isInitialized() const noexcept;
     void stopPlaybackForAllProjects(); // on app suspend / shutdown
+    void releaseMemory(); // on OS memory warnings
 
     void selectTreeNodeWithId(const String &id);
 
@@ -56,11 +62,19 @@ public:
     //===------------------------------------------------------------------===//
 
     void createEmptyProject();
+
+#if JUCE_DEBUG
+    void createGeneratedProject();
+#endif
     bool loadRecentProject(RecentProjectInfo::Ptr file);
     Array<ProjectNode *> getLoadedProjects() const;
     bool hasLoadedProject(const RecentProjectInfo::Ptr file) const;
     void unloadProject(const String &id, bool deleteLocally, bool deleteRemotely);
 
+    // keeps the playback caches of the few recently active projects,
+    // and releases the rest, see Transport::releasePlaybackCache
+    void onProjectActivated(ProjectNode *project);
+
     //===------------------------------------------------------------------===//
     // Save/Load
     //===------------------------------------------------------------------===//
@@ -86,6 +100,7 @@ public:
 private:
 
     bool wasInitialized = false;
+    bool isHeadless = false;
 
     UserProfile userProfile;
     
@@ -97,6 +112,10 @@ private:
 
     UniquePointer<CommandPaletteProjectsList> consoleProjectsList;
 
+    // the most recently active one goes first
+    Array<WeakReference<TreeNode>> recentlyActiveProjects;
+    static constexpr auto numProjectsWithPlaybackCache = 3;
+
     UniquePointer<FileChooser> newProjectFileChooser;
     UniquePointer<FileChooser> importFileChooser;
 
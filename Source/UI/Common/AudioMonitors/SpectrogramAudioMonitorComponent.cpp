@@ -50,15 +50,24 @@ SpectrogramAudioMonitorComponent::SpectrogramAudioMonitorComponent(WeakReference
 
     if (this->audioMonitor != nullptr)
     {
+        this->audioMonitor->addSpectrumSubscriber();
         this->startThread(5);
     }
 }
 
 void SpectrogramAudioMonitorComponent::setTargetAnalyzer(WeakReference<AudioMonitor> monitor)
 {
-    if (monitor != nullptr)
+    if (monitor != nullptr && monitor != this->audioMonitor)
     {
+        this->stopThread(1000);
+
+        if (this->audioMonitor != nullptr)
+        {
+            this->audioMonitor->removeSpectrumSubscriber();
+        }
+
         this->audioMonitor = monitor;
+        this->audioMonitor->addSpectrumSubscriber();
         this->startThread(5);
     }
 }
@@ -66,21 +75,35 @@ void SpectrogramAudioMonitorComponent::setTargetAnalyzer(WeakReference<AudioMoni
 SpectrogramAudioMonitorComponent::~SpectrogramAudioMonitorComponent()
 { 
     this->stopThread(1000);
+
+    if (this->audioMonitor != nullptr)
+    {
+        this->audioMonitor->removeSpectrumSubscriber();
+    }
 }
 
 void SpectrogramAudioMonitorComponent::run()
 {
     while (! this->threadShouldExit())
     {
+        if (!App::isInForeground())
+        {
+            // see the comment in SpectralLogo::run
+            Thread::sleep(100);
+            continue;
+        }
+
         Thread::sleep(jlimit(10, 100, 35 - this->skewTime));
         const double b = Time::getMillisecondCounterHiRes();
 
         if (this->isVisible())
         {
+            const auto volume = this->audioMonitor->getVolumeSnapshot();
+            this->lPeak = volume.peak[0];
+            this->rPeak = volume.peak[1];
+
             for (int i = 0; i < SpectrogramAudioMonitorComponent::numBands; ++i)
             {
-                this->lPeak = this->audioMonitor->getPeak(0);
-                this->rPeak = this->audioMonitor->getPeak(1);
                 this->values[i] = this->audioMonitor->getInterpolatedSpectrumAtFrequency(kPeakSpectrumFrequencies[i]);
             }
 
@@ -53,6 +53,13 @@ void WaveformAudioMonitorComponent::run()
 {
     while (! this->threadShouldExit())
     {
+        if (!App::isInForeground())
+        {
+            // see the comment in SpectralLogo::run
+            Thread::sleep(100);
+            continue;
+        }
+
         Thread::sleep(jlimit(10, 100, 35 - this->skewTime));
         const double b = Time::getMillisecondCounterHiRes();
 
@@ -68,10 +75,11 @@ void WaveformAudioMonitorComponent::run()
         const int i = WaveformAudioMonitorComponent::bufferSize - 1;
 
         // Push next values:
-        this->lPeakBuffer[i] = this->audioMonitor->getPeak(0);
-        this->rPeakBuffer[i] = this->audioMonitor->getPeak(1);
-        this->lRmsBuffer[i] = this->audioMonitor->getRootMeanSquare(0);
-        this->rRmsBuffer[i] = this->audioMonitor->getRootMeanSquare(1);
+        const auto volume = this->audioMonitor->getVolumeSnapshot();
+        this->lPeakBuffer[i] = volume.peak[0];
+        this->rPeakBuffer[i] = volume.peak[1];
+        this->lRmsBuffer[i] = volume.rms[0];
+        this->rRmsBuffer[i] = volume.rms[1];
 
         if (this->isVisible())
         {
@@ -155,6 +155,16 @@ namespace CommandIDs
         SelectMidiNoOutputDevice        = 0x3500,
         SelectMidiOutputDevice          = 0x3501, // more ids reserved for sub-items
         SelectFont                      = 0x3600, // more ids reserved for sub-items
+        SelectRenderBlockSize           = 0x3700, // more ids reserved for sub-items
+        SelectRenderSinglePrecision     = 0x3800,
+        SelectRenderDoublePrecision     = 0x3801,
+        ToggleRenderStems               = 0x3810,
+        ToggleRenderTail                = 0x3811,
+        ToggleRenderLoopRange           = 0x3812,
+        SelectRenderBitDepth16          = 0x3820,
+        SelectRenderBitDepth24          = 0x3821,
+        SelectRenderBitDepth32          = 0x3822,
+        MeasureAudioLatency             = 0x3900,
 
         EditModeDefault                 = 0x4000,
         EditModeDraw                    = 0x4001,
@@ -27,6 +27,16 @@ Origami::Origami()
     this->setPaintingIsUnclipped(true);
     this->setSize(256, 256); // not 0
 }
+
+// the live-resizable origamis, only accessed from the message thread
+static Array<Origami *> liveResizableOrigamis;
+static int numLiveResizes = 0;
+
+Origami::~Origami()
+{
+    liveResizableOrigamis.removeFirstMatchingValue(this);
+}
+
 //===----------------------------------------------------------------------===//
 // Origami
 //===----------------------------------------------------------------------===//
@@ -89,11 +99,101 @@ int Origami::getMaximumCommonSize() const
     return maxSize;
 }
 
+void Origami::setLiveResizeEnabled(bool shouldBeEnabled)
+{
+    this->liveResizeEnabled = shouldBeEnabled;
+
+    if (shouldBeEnabled)
+    {
+        liveResizableOrigamis.addIfNotAlreadyThere(this);
+    }
+    else
+    {
+        liveResizableOrigamis.removeFirstMatchingValue(this);
+        this->timerCallback();
+    }
+}
+
+void Origami::beginLiveResize()
+{
+    numLiveResizes++;
+}
+
+void Origami::endLiveResize()
+{
+    numLiveResizes = jmax(0, numLiveResizes - 1);
+    if (numLiveResizes > 0)
+    {
+        return;
+    }
+
+    for (auto *origami : liveResizableOrigamis)
+    {
+        if (origami->isTimerRunning())
+        {
+            origami->timerCallback();
+        }
+    }
+}
 
 //===----------------------------------------------------------------------===//
 // Component
 //===----------------------------------------------------------------------===//
 
+void Origami::resized()
+{
+    if (this->liveResizeEnabled && numLiveResizes > 0)
+    {
+        // restarted on each resize, so it only fires when the drag pauses
+        this->startTimer(Origami::liveResizePauseMs);
+        return;
+    }
+
+    this->layoutPagesIfChanged();
+}
+
+void Origami::timerCallback()
+{
+    this->stopTimer();
+    this->layoutPagesIfChanged();
+}
+
+void Origami::layoutPagesIfChanged()
+{
+    Array<int> layoutKey;
+    this->fillLayoutKey(layoutKey);
+    if (layoutKey == this->lastLayoutKey)
+    {
+        return;
+    }
+
+    this->layoutPages();
+
+    // the layout changes the pages' sizes, so the key is taken
+    // again to match the next call with the same sizes
+    this->lastLayoutKey.clearQuick();
+    this->fillLayoutKey(this->lastLayoutKey);
+}
+
+void Origami::fillLayoutKey(Array<int> &key) const
+{
+    key.ensureStorageAllocated(4 + this->pages.size() * 3);
+
+    // the number of children also changes when the shadows
+    // or the resizers are added, which also need to be laid out
+    key.add(this->getWidth());
+    key.add(this->getHeight());
+    key.add(this->getNumChildComponents());
+
+    for (const auto *page : this->pages)
+    {
+        const auto *component = page->component.getComponent();
+        key.add(component != nullptr ? component->getWidth() : -1);
+        key.add(component != nullptr ? component->getHeight() : -1);
+        key.add(page->fixedSize ? 1 : 0);
+    }
+}
+
 void Origami::ChildConstrainer::applyBoundsToComponent(Component &component, Rectangle<int> bounds)
 {
     ComponentBoundsConstrainer::applyBoundsToComponent(component, bounds);
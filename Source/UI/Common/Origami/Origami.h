@@ -17,7 +17,7 @@
 
 #pragma once
 
-class Origami : public Component
+class Origami : public Component, private Timer
 {
 public:
 
@@ -45,6 +45,7 @@ public:
     };
 
     Origami();
+    ~Origami() override;
 
     //===------------------------------------------------------------------===//
     // Origami
@@ -62,14 +63,42 @@ public:
     void clear();
     bool containsComponent(Component *component) const;
 
+    // in the live resize mode, the pages are not laid out while the window
+    // is being dragged to resize, but only when the drag pauses or ends,
+    // so that the expensive pages like the rolls don't slow the drag down
+    void setLiveResizeEnabled(bool shouldBeEnabled);
+
+    // called by the window's constrainer when the resize drag starts and ends
+    static void beginLiveResize();
+    static void endLiveResize();
+
+    //===------------------------------------------------------------------===//
+    // Component
+    //===------------------------------------------------------------------===//
+
+    void resized() override;
+
 protected:
 
     virtual void onPageResized(Component *component) = 0;
+    virtual void layoutPages() = 0;
 
     OwnedArray<Origami::Page> pages;
 
 private:
 
+    void timerCallback() override;
+    void layoutPagesIfChanged();
+
+    // the sizes of the origami and all its pages after the last layout,
+    // which only depends on them, so it's skipped when nothing has changed
+    Array<int> lastLayoutKey;
+    void fillLayoutKey(Array<int> &key) const;
+
+    bool liveResizeEnabled = false;
+
+    static constexpr auto liveResizePauseMs = 150;
+
     static constexpr auto defaultMinSize = 100;
     static constexpr auto defaultMaxSize = 1000;
 
@@ -137,7 +137,7 @@ void OrigamiHorizontal::addResizer(int minSize, int maxSize)
 }
 
 
-void OrigamiHorizontal::resized()
+void OrigamiHorizontal::layoutPages()
 {
     Rectangle<int> r(this->getLocalBounds());
     const int numPages = this->pages.size();
@@ -129,7 +129,7 @@ void OrigamiVertical::addResizer(int minSize, int maxSize)
     }
 }
 
-void OrigamiVertical::resized()
+void OrigamiVertical::layoutPages()
 {
     Rectangle<int> r(this->getLocalBounds());
     const int numPages = this->pages.size();
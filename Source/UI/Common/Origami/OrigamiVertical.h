@@ -30,7 +30,7 @@ public:
     void addResizer(int minSize, int maxSize) override;
 
     void onPageResized(Component *component) override;
-    void resized() override;
+    void layoutPages() override;
 
 private:
 
@@ -39,6 +39,13 @@ void SpectralLogo::run()
 {
     while (! this->threadShouldExit())
     {
+        if (!App::isInForeground())
+        {
+            // nothing is seen meanwhile, so just wait for the app to come back
+            Thread::sleep(100);
+            continue;
+        }
+
         static constexpr auto timerDelayMs = 50;
         Thread::sleep(jlimit(10, 100, timerDelayMs - this->skewTime));
         const double b = Time::getMillisecondCounterHiRes();
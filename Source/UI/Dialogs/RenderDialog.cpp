@@ -80,15 +80,53 @@ RenderDialog::RenderDialog(ProjectNode &parentProject,
     this->pathLabel->setJustificationType(Justification::centredLeft);
     this->pathLabel->setInterceptsMouseClicks(false, false);
 
+    this->realtimeFactorLabel = make<Label>();
+    this->addAndMakeVisible(this->realtimeFactorLabel.get());
+    this->realtimeFactorLabel->setFont(Globals::UI::Fonts::S);
+    this->realtimeFactorLabel->setJustificationType(Justification::centredRight);
+    this->realtimeFactorLabel->setInterceptsMouseClicks(false, false);
+
+    this->renderOptionsEditor = make<TextEditor>();
+    this->addAndMakeVisible(this->renderOptionsEditor.get());
+    this->renderOptionsEditor->setReadOnly(true);
+    this->renderOptionsEditor->setScrollbarsShown(false);
+    this->renderOptionsEditor->setCaretVisible(false);
+    this->renderOptionsEditor->setPopupMenuEnabled(false);
+    this->renderOptionsEditor->setInterceptsMouseClicks(false, true);
+    this->renderOptionsEditor->setFont(Globals::UI::Fonts::M);
+
+    this->renderOptionsCombo = make<MobileComboBox::Container>();
+    this->addAndMakeVisible(this->renderOptionsCombo.get());
+    this->renderOptionsCombo->initWith(this->renderOptionsEditor.get(), MenuPanel::Menu());
+
     this->separator = make<SeparatorHorizontalFading>();
     this->addAndMakeVisible(this->separator.get());
 
+    this->options.blockSize = App::Config().getProperty(Serialization::UI::lastRenderBlockSize,
+        RenderOptions::minBlockSize);
+    this->options.doublePrecision = App::Config().getProperty(Serialization::UI::lastRenderDoublePrecision,
+        false);
+    this->options.stems = App::Config().getProperty(Serialization::UI::lastRenderStems, false);
+    this->options.bitDepth = App::Config().getProperty(Serialization::UI::lastRenderBitDepth, 16);
+    this->options.renderTail = App::Config().getProperty(Serialization::UI::lastRenderTail, false);
+
+    // no UI for these, but they can be tweaked in the config file
+    this->options.silenceThresholdDb = App::Config().getProperty(Serialization::UI::renderSilenceThresholdDb,
+        this->options.silenceThresholdDb);
+    this->options.maxTailSeconds = App::Config().getProperty(Serialization::UI::renderMaxTailSeconds,
+        this->options.maxTailSeconds);
+    this->options.warmUpSeconds = App::Config().getProperty(Serialization::UI::renderWarmUpSeconds,
+        this->options.warmUpSeconds);
+
+    this->setLoopRangeEnabled(App::Config().getProperty(Serialization::UI::lastRenderLoopRange, false));
+
     // just in case..
     this->project.getTransport().stopPlaybackAndRecording();
 
-    this->setSize(520, 224);
+    this->setSize(520, 264);
     this->updatePosition();
     this->updateRenderTargetLabels();
+    this->updateRenderOptionsMenu();
 }
 
 RenderDialog::~RenderDialog() = default;
@@ -99,13 +137,20 @@ void RenderDialog::resized()
 
     this->captionLabel->setBounds(this->getCaptionBounds().withTrimmedLeft(browseButtonWidth));
 
-    this->pathLabel->setBounds(this->getRowBounds(0.1f, 24).withTrimmedLeft(browseButtonWidth));
-    this->filenameEditor->setBounds(this->getRowBounds(0.35f, 32).withTrimmedLeft(browseButtonWidth));
-    this->browseButton->setBounds(this->getRowBounds(0.35f, 48).withWidth(browseButtonWidth));
+    constexpr auto realtimeFactorWidth = 56;
+
+    this->pathLabel->setBounds(this->getRowBounds(0.08f, 24).withTrimmedLeft(browseButtonWidth));
+    this->filenameEditor->setBounds(this->getRowBounds(0.28f, 32).withTrimmedLeft(browseButtonWidth));
+    this->browseButton->setBounds(this->getRowBounds(0.28f, 48).withWidth(browseButtonWidth));
+
+    this->renderOptionsEditor->setBounds(this->getRowBounds(0.52f, 32).withTrimmedLeft(browseButtonWidth));
+    this->renderOptionsCombo->setBounds(this->getContentBounds());
 
-    this->separator->setBounds(this->getRowBounds(0.65f, 8));
-    this->slider->setBounds(this->getRowBounds(0.85f, 12).withTrimmedLeft(browseButtonWidth).reduced(6, 0));
-    this->indicator->setBounds(this->getRowBounds(0.84f, 24).withWidth(browseButtonWidth));
+    this->separator->setBounds(this->getRowBounds(0.7f, 8));
+    this->slider->setBounds(this->getRowBounds(0.87f, 12).withTrimmedLeft(browseButtonWidth)
+        .withTrimmedRight(realtimeFactorWidth).reduced(6, 0));
+    this->realtimeFactorLabel->setBounds(this->getRowBounds(0.87f, 24).removeFromRight(realtimeFactorWidth));
+    this->indicator->setBounds(this->getRowBounds(0.86f, 24).withWidth(browseButtonWidth));
 
     this->renderButton->setBounds(this->getButtonsBounds());
 }
@@ -134,6 +179,114 @@ void RenderDialog::handleCommandMessage(int commandId)
     {
         this->launchFileChooser();
     }
+    else if (commandId == CommandIDs::SelectRenderSinglePrecision ||
+        commandId == CommandIDs::SelectRenderDoublePrecision)
+    {
+        this->options.doublePrecision = commandId == CommandIDs::SelectRenderDoublePrecision;
+        App::Config().setProperty(Serialization::UI::lastRenderDoublePrecision, this->options.doublePrecision);
+        this->updateRenderOptionsMenu();
+    }
+    else if (commandId == CommandIDs::SelectRenderBitDepth16 ||
+        commandId == CommandIDs::SelectRenderBitDepth24 ||
+        commandId == CommandIDs::SelectRenderBitDepth32)
+    {
+        this->options.bitDepth = commandId == CommandIDs::SelectRenderBitDepth32 ? 32 :
+            (commandId == CommandIDs::SelectRenderBitDepth24 ? 24 : 16);
+        App::Config().setProperty(Serialization::UI::lastRenderBitDepth, this->options.bitDepth);
+        this->updateRenderOptionsMenu();
+    }
+    else if (commandId == CommandIDs::ToggleRenderTail)
+    {
+        this->options.renderTail = !this->options.renderTail;
+        App::Config().setProperty(Serialization::UI::lastRenderTail, this->options.renderTail);
+        this->updateRenderOptionsMenu();
+    }
+    else if (commandId == CommandIDs::ToggleRenderLoopRange)
+    {
+        this->setLoopRangeEnabled(!this->options.hasRange());
+        App::Config().setProperty(Serialization::UI::lastRenderLoopRange, this->options.hasRange());
+        this->updateRenderOptionsMenu();
+    }
+    else if (commandId == CommandIDs::ToggleRenderStems)
+    {
+        this->options.stems = !this->options.stems;
+        App::Config().setProperty(Serialization::UI::lastRenderStems, this->options.stems);
+        this->updateRenderOptionsMenu();
+    }
+    else if (commandId >= CommandIDs::SelectRenderBlockSize &&
+        commandId < CommandIDs::SelectRenderSinglePrecision)
+    {
+        this->options.blockSize = RenderOptions::minBlockSize << (commandId - CommandIDs::SelectRenderBlockSize);
+        App::Config().setProperty(Serialization::UI::lastRenderBlockSize, this->options.blockSize);
+        this->updateRenderOptionsMenu();
+    }
+}
+
+void RenderDialog::setLoopRangeEnabled(bool enabled)
+{
+    const auto &transport = this->project.getTransport();
+    this->options.startBeat = enabled ? transport.getPlaybackLoopStart() : 0.f;
+    this->options.endBeat = enabled ? transport.getPlaybackLoopEnd() : 0.f;
+}
+
+String RenderDialog::getBitDepthName() const
+{
+    if (this->options.bitDepth == 32 && this->format == RenderFormat::WAV)
+    {
+        return "32-bit float";
+    }
+
+    return this->options.bitDepth == 24 ? "24-bit" : "16-bit";
+}
+
+void RenderDialog::updateRenderOptionsMenu()
+{
+    MenuPanel::Menu menu;
+
+    for (int i = 0, blockSize = RenderOptions::minBlockSize;
+        blockSize <= RenderOptions::maxBlockSize; ++i, blockSize *= 2)
+    {
+        const bool isSelected = blockSize == this->options.blockSize;
+        menu.add(MenuItem::item(isSelected ? Icons::apply : Icons::empty,
+            CommandIDs::SelectRenderBlockSize + i, String(blockSize)));
+    }
+
+    menu.add(MenuItem::item(this->options.bitDepth == 16 ? Icons::apply : Icons::empty,
+        CommandIDs::SelectRenderBitDepth16, "16-bit"));
+
+    menu.add(MenuItem::item(this->options.bitDepth == 24 ? Icons::apply : Icons::empty,
+        CommandIDs::SelectRenderBitDepth24, "24-bit"));
+
+    // FLAC doesn't support floating point samples
+    if (this->format == RenderFormat::WAV)
+    {
+        menu.add(MenuItem::item(this->options.bitDepth == 32 ? Icons::apply : Icons::empty,
+            CommandIDs::SelectRenderBitDepth32, "32-bit float"));
+    }
+
+    menu.add(MenuItem::item(this->options.doublePrecision ? Icons::empty : Icons::apply,
+        CommandIDs::SelectRenderSinglePrecision, "Single precision"));
+
+    menu.add(MenuItem::item(this->options.doublePrecision ? Icons::apply : Icons::empty,
+        CommandIDs::SelectRenderDoublePrecision, "Double precision"));
+
+    menu.add(MenuItem::item(this->options.hasRange() ? Icons::apply : Icons::empty,
+        CommandIDs::ToggleRenderLoopRange, "Loop only"));
+
+    menu.add(MenuItem::item(this->options.renderTail ? Icons::apply : Icons::empty,
+        CommandIDs::ToggleRenderTail, "Tail"));
+
+    menu.add(MenuItem::item(this->options.stems ? Icons::apply : Icons::empty,
+        CommandIDs::ToggleRenderStems, "Stems"));
+
+    this->renderOptionsEditor->setText(TRANS(I18n::Settings::audioBufferSize) + ": " +
+        String(this->options.blockSize) + ", " + this->getBitDepthName() +
+        (this->options.doublePrecision ? ", double precision" : "") +
+        (this->options.hasRange() ? ", loop only" : "") +
+        (this->options.renderTail ? ", tail" : "") +
+        (this->options.stems ? ", stems" : ""), dontSendNotification);
+
+    this->renderOptionsCombo->updateMenu(menu);
 }
 
 void RenderDialog::launchFileChooser()
@@ -184,7 +337,7 @@ void RenderDialog::startOrAbortRender()
             this->renderTarget.getParentURL().getLocalFile().getFullPathName());
 #endif
 
-        if (transport.startRender(this->renderTarget, this->format))
+        if (transport.startRender(this->renderTarget, this->format, this->options))
         {
             this->startTrackingProgress();
         }
@@ -223,6 +376,12 @@ void RenderDialog::timerCallback(int timerId)
     {
         const float percentsDone = transport.getRenderingPercentsComplete();
         this->slider->setValue(percentsDone, dontSendNotification);
+
+        const auto realtimeFactor = transport.getRenderingRealtimeFactor();
+        if (realtimeFactor > 0.f)
+        {
+            this->realtimeFactorLabel->setText(String(realtimeFactor, 1) + "x", dontSendNotification);
+        }
     }
     else
     {
@@ -235,6 +394,7 @@ void RenderDialog::timerCallback(int timerId)
 void RenderDialog::startTrackingProgress()
 {
     this->startTimer(RenderDialog::renderProgressTimer, 17);
+    this->realtimeFactorLabel->setText({}, dontSendNotification);
     this->indicator->startAnimating();
     this->animator.fadeIn(this->indicator.get(), Globals::UI::fadeInLong);
     this->renderButton->setButtonText(TRANS(I18n::Dialog::renderAbort));
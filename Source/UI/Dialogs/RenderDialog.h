@@ -19,6 +19,7 @@
 
 #include "DialogBase.h"
 #include "SeparatorHorizontalFading.h"
+#include "MobileComboBox.h"
 #include "RenderFormat.h"
 
 class DocumentOwner;
@@ -63,6 +64,11 @@ private:
     void startOrAbortRender();
     void stopRender();
 
+    RenderOptions options;
+    void setLoopRangeEnabled(bool enabled);
+    void updateRenderOptionsMenu();
+    String getBitDepthName() const;
+
     UniquePointer<TextButton> renderButton;
     UniquePointer<Label> filenameEditor;
     UniquePointer<Label> captionLabel;
@@ -70,6 +76,9 @@ private:
     UniquePointer<ProgressIndicator> indicator;
     UniquePointer<MenuItemComponent> browseButton;
     UniquePointer<Label> pathLabel;
+    UniquePointer<Label> realtimeFactorLabel;
+    UniquePointer<TextEditor> renderOptionsEditor;
+    UniquePointer<MobileComboBox::Container> renderOptionsCombo;
     UniquePointer<SeparatorHorizontalFading> separator;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderDialog)
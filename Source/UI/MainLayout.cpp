@@ -247,6 +247,7 @@ void MainLayout::showPage(Component *page, TreeNode *source)
             if (newParentProject != nullptr)
             {
                 newParentProject->broadcastActivateProjectSubtree();
+                App::Workspace().onProjectActivated(newParentProject);
             }
         }
     }
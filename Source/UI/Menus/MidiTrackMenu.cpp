@@ -24,6 +24,8 @@
 #include "MidiSequence.h"
 #include "RollBase.h"
 
+#include "ProjectNode.h"
+#include "MidiRecorder.h"
 #include "Workspace.h"
 
 MidiTrackMenu::MidiTrackMenu(WeakReference<MidiTrack> track, WeakReference<UndoStack> undoStack) :
@@ -81,6 +83,35 @@ void MidiTrackMenu::initDefaultMenu()
         }
     }
 
+    if (auto *project = this->track->getSequence()->getProject())
+    {
+        auto &transport = project->getTransport();
+        const auto isFrozen = transport.isTrackFrozen(this->track);
+        menu.add(MenuItem::item(Icons::render, isFrozen ? "Unfreeze" : "Freeze")->
+            disabledIf(!isFrozen && transport.isRendering())->
+            closesMenu()->withAction([this, isFrozen]()
+        {
+            auto &transport = this->track->getSequence()->getProject()->getTransport();
+            if (isFrozen)
+            {
+                transport.unfreezeTrack(this->track);
+            }
+            else if (!transport.freezeTrack(this->track))
+            {
+                App::Layout().showTooltip({}, MainLayout::TooltipIcon::Failure);
+            }
+        }));
+
+        const auto &recorder = project->getMidiRecorder();
+        if (recorder.getTakesTrack() == this->track.get() && recorder.getNumTakes() > 1)
+        {
+            menu.add(MenuItem::item(Icons::list, "Takes")->withSubmenu()->withAction([this]()
+            {
+                this->initTakeSelectionMenu();
+            }));
+        }
+    }
+
     this->updateContent(menu, MenuPanel::SlideRight);
 }
 
@@ -111,3 +142,27 @@ void MidiTrackMenu::initInstrumentSelectionMenu()
     
     this->updateContent(menu, MenuPanel::SlideLeft);
 }
+
+void MidiTrackMenu::initTakeSelectionMenu()
+{
+    MenuPanel::Menu menu;
+    menu.add(MenuItem::item(Icons::back, TRANS(I18n::Menu::back))->withAction([this]()
+    {
+        this->initDefaultMenu();
+    }));
+
+    auto *project = this->track->getSequence()->getProject();
+    const auto &recorder = project->getMidiRecorder();
+
+    for (int i = 0; i < recorder.getNumTakes(); ++i)
+    {
+        const bool isTicked = (i == recorder.getCommittedTakeIndex());
+        menu.add(MenuItem::item(isTicked ? Icons::apply : Icons::list, "Take " + String(i + 1))->
+            disabledIf(isTicked)->closesMenu()->withAction([project, i]()
+        {
+            project->getMidiRecorder().pickTake(i);
+        }));
+    }
+
+    this->updateContent(menu, MenuPanel::SlideLeft);
+}
@@ -31,6 +31,7 @@ private:
     
     void initDefaultMenu();
     void initInstrumentSelectionMenu();
+    void initTakeSelectionMenu();
 
     WeakReference<MidiTrack> track;
     WeakReference<UndoStack> undoStack;
@@ -150,7 +150,9 @@ void RecentProjectRow::updateDescription(const RecentProjectInfo::Ptr file, bool
     this->isFileLoaded = isLoaded;
 
     this->titleLabel->setText(this->targetFile->getTitle(), dontSendNotification);
-    this->dateLabel->setText(App::getHumanReadableDate(this->targetFile->getUpdatedAt()), dontSendNotification);
+    const auto date = App::getHumanReadableDate(this->targetFile->getUpdatedAt());
+    this->dateLabel->setText(this->targetFile->hasLocalStats() ?
+        date + ", " + this->targetFile->getLocalStats() : date, dontSendNotification);
 
     const float totalAlpha = this->isFileLoaded ? 1.f : 0.5f;
 
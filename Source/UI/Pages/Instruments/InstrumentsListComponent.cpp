@@ -67,6 +67,19 @@ void InstrumentsListComponent::parentHierarchyChanged()
     if (this->getParentComponent() != nullptr)
     {
         this->updateListContent();
+        this->startTimer(InstrumentsListComponent::loadUpdateIntervalMs);
+    }
+    else
+    {
+        this->stopTimer();
+    }
+}
+
+void InstrumentsListComponent::timerCallback()
+{
+    if (this->isShowing())
+    {
+        this->instrumentsList->repaint();
     }
 }
 
@@ -127,6 +140,25 @@ void InstrumentsListComponent::paintListBoxItem(int rowNumber, Graphics &g, int
         (margin * 2) + int(InstrumentsListComponent::iconSize), margin,
         w, h - (margin * 2), Justification::centredLeft, false);
 
+    // the average and the peak share of the block duration the instrument
+    // takes to process, and the number of blocks it didn't make in time
+    const auto load = instrument->getProcessorPlayer().getLoad();
+    if (load.averageMs > 0.f)
+    {
+        String loadText;
+        loadText << int(load.averageLoad * 100.f) << "% / " << int(load.maxLoad * 100.f) << "%";
+        if (load.numOverruns > 0)
+        {
+            loadText << ", " << load.numOverruns << " xruns";
+        }
+
+        g.setFont(Globals::UI::Fonts::S);
+        g.setColour(findDefaultColour(ListBox::textColourId)
+            .withMultipliedAlpha(load.numOverruns > 0 ? alpha : alpha * 0.5f));
+        g.drawText(loadText, margin, margin, w - margin * 3, h - (margin * 2),
+            Justification::centredRight, false);
+    }
+
     Icons::drawImageRetinaAware(this->instrumentIcon, g, h / 2, h / 2);
 }
 
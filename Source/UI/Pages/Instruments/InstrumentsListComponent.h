@@ -27,7 +27,8 @@ class HeadlineContextMenuController;
 
 class InstrumentsListComponent final : public Component,
                                        public ListBoxModel,
-                                       public HeadlineItemDataSource
+                                       public HeadlineItemDataSource,
+                                       private Timer
 {
 public:
 
@@ -66,6 +67,10 @@ public:
 
 private:
 
+    // the rows show the instruments' audio load, updated periodically
+    void timerCallback() override;
+    static constexpr auto loadUpdateIntervalMs = 500;
+
     PluginScanner &pluginScanner;
     OrchestraPitNode &instrumentsRoot;
 
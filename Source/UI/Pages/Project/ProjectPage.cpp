@@ -213,8 +213,13 @@ ProjectPage::ProjectPage(ProjectNode &parentProject) :
         }
     }
 
+    // the page may be created long after the project is loaded,
+    // so it can't rely on receiving the last total time change
+    auto &transport = this->project.getTransport();
+    this->totalTimeMs = transport.findTimeAt(transport.getProjectLastBeat());
+
     this->project.addChangeListener(this);
-    this->project.getTransport().addTransportListener(this);
+    transport.addTransportListener(this);
 
 #if PLATFORM_MOBILE
     // не комильфо на мобильниках показывать расположение файлов
@@ -19,6 +19,7 @@
 #include "AudioSettings.h"
 #include "AudioCore.h"
 #include "Workspace.h"
+#include "MainLayout.h"
 
 AudioSettings::AudioSettings(AudioCore &core) : audioCore(core)
 {
@@ -158,6 +159,12 @@ void AudioSettings::parentHierarchyChanged()
 
 void AudioSettings::handleCommandMessage(int commandId)
 {
+    if (commandId == CommandIDs::MeasureAudioLatency)
+    {
+        this->measureLatency();
+        return;
+    }
+
     auto &deviceManager = this->audioCore.getDevice();
     const auto &deviceTypes = deviceManager.getAvailableDeviceTypes();
 
@@ -285,9 +292,35 @@ void AudioSettings::applyBufferSize(AudioDeviceManager &deviceManager, int buffe
     this->syncBufferSizesList(deviceManager);
 }
 
+void AudioSettings::measureLatency()
+{
+    if (this->audioCore.isMeasuringLatency())
+    {
+        return;
+    }
+
+    Component::SafePointer<AudioSettings> safeThis(this);
+    this->audioCore.measureLatency([safeThis](double roundTripMs)
+    {
+        if (roundTripMs < 0.0)
+        {
+            App::Layout().showTooltip(TRANS(I18n::Settings::audioLatencyFailed),
+                MainLayout::TooltipIcon::Failure);
+            return;
+        }
+
+        App::Layout().showTooltip(String(roundTripMs, 1) + " ms", MainLayout::TooltipIcon::Success);
+
+        if (safeThis != nullptr)
+        {
+            safeThis->syncBufferSizesList(safeThis->audioCore.getDevice());
+        }
+    });
+}
+
 void AudioSettings::applyMidiOutput(AudioDeviceManager &deviceManager, const String &deviceId)
 {
-    deviceManager.setDefaultMidiOutputDevice(deviceId);
+    this->audioCore.setMidiOutputDevice(deviceId);
     this->syncMidiOutputsList(deviceManager);
 }
 
@@ -406,18 +439,33 @@ void AudioSettings::syncBufferSizesList(AudioDeviceManager &deviceManager)
 
     const auto bufferSizes = currentDevice->getAvailableBufferSizes();
     const int currentBufferSize = currentDevice->getCurrentBufferSizeSamples();
+    const int suggestedBufferSize = this->audioCore.getSuggestedBufferSize();
+
+    // the latency of the other buffer sizes is estimated
+    // assuming the buffer is the only part of it which changes
+    const auto sampleRate = jmax(1.0, currentDevice->getCurrentSampleRate());
+    const auto outputLatencyMs = this->audioCore.getOutputLatencyMs();
+    const auto getLatencyText = [&](int bufferSize)
+    {
+        const auto bufferDifferenceMs = (bufferSize - currentBufferSize) * 1000.0 / sampleRate;
+        return String(jmax(0.0, outputLatencyMs + bufferDifferenceMs), 1) + " ms";
+    };
+
+    menu.add(MenuItem::item(Icons::metronome,
+        CommandIDs::MeasureAudioLatency, TRANS(I18n::Settings::audioMeasureLatency)));
 
     for (int i = 0; i < bufferSizes.size(); ++i)
     {
         const int &bufferSize = bufferSizes[i];
         const bool isSelected = bufferSize == currentBufferSize;
-        menu.add(MenuItem::item(isSelected ? Icons::apply : Icons::empty,
-            CommandIDs::SelectBufferSize + i, String(bufferSize)));
+        const bool isSuggested = bufferSize == suggestedBufferSize;
+        menu.add(MenuItem::item(isSelected ? Icons::apply : (isSuggested ? Icons::success : Icons::empty),
+            CommandIDs::SelectBufferSize + i, String(bufferSize) + ", " + getLatencyText(bufferSize)));
 
         if (isSelected)
         {
             this->bufferSizeEditor->setText(TRANS(I18n::Settings::audioBufferSize) +
-                ": " + String(bufferSize), dontSendNotification);
+                ": " + String(bufferSize) + ", " + getLatencyText(bufferSize), dontSendNotification);
         }
     }
 
@@ -479,7 +527,7 @@ void AudioSettings::syncMidiOutputsList(AudioDeviceManager &deviceManager)
 {
     MenuPanel::Menu menu;
     const auto devices = MidiOutput::getAvailableDevices();
-    const auto defaultOutputDeviceId = deviceManager.getDefaultMidiOutputIdentifier();
+    const auto defaultOutputDeviceId = this->audioCore.getMidiOutputDeviceId();
 
     // "don't send midi" option
     menu.add(MenuItem::item(defaultOutputDeviceId.isEmpty() ? Icons::apply : Icons::empty,
@@ -38,6 +38,7 @@ private:
     void applyDevice(AudioDeviceManager &deviceManager, const String &deviceName);
     void applySampleRate(AudioDeviceManager &deviceManager, double sampleRate);
     void applyBufferSize(AudioDeviceManager &deviceManager, int bufferSize);
+    void measureLatency();
     void applyMidiInput(AudioDeviceManager &deviceManager, const String &deviceId);
     void applyMidiOutput(AudioDeviceManager &deviceManager, const String &deviceId);
 
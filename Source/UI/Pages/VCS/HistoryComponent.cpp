@@ -47,11 +47,22 @@ HistoryComponent::HistoryComponent(VersionControl &owner) : vcs(owner)
 
 #if !NO_NETWORK
     this->vcs.fetchRevisionsIfNeeded();
+    this->startTimer(HistoryComponent::remoteRefreshIntervalMs);
 #endif
 }
 
 HistoryComponent::~HistoryComponent() = default;
 
+void HistoryComponent::timerCallback()
+{
+#if !NO_NETWORK
+    if (this->isShowing())
+    {
+        this->vcs.fetchRevisionsIfNeeded();
+    }
+#endif
+}
+
 void HistoryComponent::resized()
 {
     constexpr auto labelHeight = 26;
@@ -106,6 +117,19 @@ void HistoryComponent::clearSelection()
 
 void HistoryComponent::rebuildRevisionTree()
 {
+    // the tree is kept alive to reuse the layout when possible
+    if (this->revisionTree != nullptr)
+    {
+        this->revisionTree->rebuild();
+        if (auto *alignerProxy = dynamic_cast<ViewportFitProxyComponent *>
+            (this->revisionViewport->getViewedComponent()))
+        {
+            alignerProxy->centerTargetToViewport();
+        }
+
+        return;
+    }
+
     this->revisionTree = new RevisionTreeComponent(this->vcs);
     auto *alignerProxy = new ViewportFitProxyComponent(*this->revisionViewport, this->revisionTree, true); // owns revisionTree
     this->revisionViewport->setViewedComponent(alignerProxy, true); // owns alignerProxy
@@ -23,7 +23,9 @@ class RevisionTreeComponent;
 #include "HeadlineItemDataSource.h"
 #include "SeparatorHorizontalFadingReversed.h"
 
-class HistoryComponent final : public Component, public HeadlineItemDataSource
+class HistoryComponent final : public Component,
+    public HeadlineItemDataSource,
+    private Timer
 {
 public:
 
@@ -53,6 +55,11 @@ public:
 
 private:
 
+    // while the page is showing, keeps the remote sync state fresh
+    // with background fetches, which are cheap conditional requests
+    void timerCallback() override;
+    static constexpr auto remoteRefreshIntervalMs = 60 * 1000;
+
     VersionControl &vcs;
     SafePointer<RevisionTreeComponent> revisionTree;
 
@@ -89,7 +89,7 @@ RevisionComponent::RevisionComponent(VersionControl &owner,
 
 #endif
 
-    this->setSize(165, 50);
+    this->setSize(RevisionComponent::defaultWidth, RevisionComponent::defaultHeight);
 }
 
 RevisionComponent::~RevisionComponent() = default;
@@ -152,44 +152,3 @@ void RevisionComponent::setSelected(bool selected)
     this->isSelected = selected;
     this->repaint();
 }
-
-RevisionComponent *RevisionComponent::getLeftmostSibling() const
-{
-    if (!this->leftmostSibling && this->parent)
-    {
-        if (this != this->parent->children.getFirst())
-        {
-            this->leftmostSibling = this->parent->children.getFirst();
-        }
-    }
-
-    return this->leftmostSibling;
-}
-
-RevisionComponent *RevisionComponent::getLeftBrother() const
-{
-    RevisionComponent *n = nullptr;
-
-    if (this->parent)
-    {
-        for (auto i : this->parent->children)
-        {
-            if (i == this) { return n; }
-            n = i;
-        }
-    }
-
-    return n;
-}
-
-RevisionComponent *RevisionComponent::right() const
-{
-    if (this->children.size() > 0) { return this->children.getLast(); }
-    return this->wired;
-}
-
-RevisionComponent *RevisionComponent::left() const
-{
-    if (this->children.size() > 0) { return this->children.getFirst(); }
-    return this->wired;
-}
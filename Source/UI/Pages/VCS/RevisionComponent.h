@@ -33,30 +33,11 @@ public:
         const VCS::Revision::Ptr revision, VCS::Revision::SyncState viewState, bool isHead);
     ~RevisionComponent();
 
-    // Helpers for tree traverse:
-
-    float x = 0.f;
-    float y = 0.f;
-    float mod = 0.f;
-    float shift = 0.f;
-    float change = 0.f;
-    int number = 0;
+    static constexpr auto defaultWidth = 165;
+    static constexpr auto defaultHeight = 50;
 
     const VCS::Revision::Ptr revision;
 
-    RevisionComponent *parent = nullptr;
-    RevisionComponent *ancestor = nullptr;
-    RevisionComponent *wired = nullptr;
-
-    Array<RevisionComponent *> children;
-
-    RevisionComponent *getLeftmostSibling() const;
-    RevisionComponent *getLeftBrother() const;
-    RevisionComponent *right() const;
-    RevisionComponent *left() const;
-
-    mutable RevisionComponent *leftmostSibling = nullptr;
-
     void setSelected(bool selected);
 
     void paint(Graphics &g) override;
@@ -19,40 +19,28 @@
 #include "RevisionConnectorComponent.h"
 #include "ColourIDs.h"
 
-RevisionConnectorComponent::RevisionConnectorComponent(Component *c1, Component *c2) :
-    component1(c1),
-    component2(c2)
+RevisionConnectorComponent::RevisionConnectorComponent(const Rectangle<int> &parentBounds,
+    const Rectangle<int> &childBounds) :
+    parentBounds(parentBounds),
+    childBounds(childBounds)
 {
     this->setInterceptsMouseClicks(false, false);
-    this->resizeToFit();
-}
-
-void RevisionConnectorComponent::getPoints(float &x1, float &y1, float &x2, float &y2) const
-{
-    x1 = float(this->component1->getBounds().getCentreX());
-    y1 = float(this->component1->getY());
-    x2 = float(this->component2->getBounds().getCentreX());
-    y2 = float(this->component2->getBottom());
-}
 
-void RevisionConnectorComponent::resizeToFit()
-{
     float x1, y1, x2, y2;
     this->getPoints(x1, y1, x2, y2);
 
-    const Rectangle<int> newBounds(int(jmin(x1, x2) - 4),
+    this->setBounds(int(jmin(x1, x2) - 4),
         int(jmin(y1, y2) - 4),
         int(fabsf(x1 - x2) + 8),
         int(fabsf(y1 - y2) + 8));
+}
 
-    if (newBounds != this->getBounds())
-    {
-        this->setBounds(newBounds);
-    }
-    else
-    {
-        this->resized();
-    }
+void RevisionConnectorComponent::getPoints(float &x1, float &y1, float &x2, float &y2) const
+{
+    x1 = float(this->parentBounds.getCentreX());
+    y1 = float(this->parentBounds.getY());
+    x2 = float(this->childBounds.getCentreX());
+    y2 = float(this->childBounds.getBottom());
 }
 
 void RevisionConnectorComponent::paint(Graphics &g)
@@ -63,11 +51,6 @@ void RevisionConnectorComponent::paint(Graphics &g)
 
 void RevisionConnectorComponent::resized()
 {
-    if (!this->component1 || !this->component2)
-    {
-        delete this;
-    }
-
     float x1, y1, x2, y2;
     this->getPoints(x1, y1, x2, y2);
 
@@ -23,9 +23,10 @@ class RevisionConnectorComponent final :
 {
 public:
 
-    RevisionConnectorComponent(Component *c1, Component *c2);
-
-    void resizeToFit();
+    // connects the top of the parent revision's bounds
+    // with the bottom of the child revision's bounds
+    RevisionConnectorComponent(const Rectangle<int> &parentBounds,
+        const Rectangle<int> &childBounds);
 
     void paint(Graphics &g) override;
     void resized() override;
@@ -36,8 +37,8 @@ private:
 
     Path linePath;
 
-    SafePointer<Component> component1;
-    SafePointer<Component> component2;
+    const Rectangle<int> parentBounds;
+    const Rectangle<int> childBounds;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RevisionConnectorComponent)
 };
@@ -28,24 +28,93 @@ RevisionTreeComponent::RevisionTreeComponent(VersionControl &owner) :
 {
     this->setInterceptsMouseClicks(false, true);
     this->setSize(1, 1);
+    this->rebuild();
+}
 
-    auto *root = this->initComponents(1, this->vcs.getRoot(), nullptr);
-    auto *dt = this->firstWalk(root);
-    
-    float min = -1;
-    min = this->secondWalk(dt, min);
+RevisionTreeComponent::~RevisionTreeComponent()
+{
+    if (this->observedParent != nullptr)
+    {
+        this->observedParent->removeComponentListener(this);
+    }
 
-    if (min < 0)
+    if (this->observedViewport != nullptr)
     {
-        this->thirdWalk(dt, -min);
+        this->observedViewport->removeComponentListener(this);
     }
 
-    this->postWalk(root);
+    this->nodes.clear();
 }
 
-RevisionTreeComponent::~RevisionTreeComponent()
+void RevisionTreeComponent::rebuild()
+{
+    Array<VCS::Revision::Ptr> revisions;
+    Array<int> parentIndices;
+    this->flattenHistory(this->vcs.getRoot(), -1, revisions, parentIndices);
+
+    // most rebuilds are caused by checkouts, syncs and commits on top
+    // of the new revisions, and only the latter changes the tree shape
+    bool hasSameShape = (revisions.size() == this->nodes.size());
+    for (int i = 0; hasSameShape && i < revisions.size(); ++i)
+    {
+        const auto *node = this->nodes.getUnchecked(i);
+        const auto parentIndex = parentIndices.getUnchecked(i);
+        hasSameShape = node->parent == this->nodes[parentIndex] &&
+            node->revision->getUuid() == revisions.getUnchecked(i)->getUuid();
+    }
+
+    if (hasSameShape)
+    {
+        for (int i = 0; i < revisions.size(); ++i)
+        {
+            auto *node = this->nodes.getUnchecked(i);
+            node->parentConnector = nullptr;
+            node->component = nullptr;
+            node->revision = revisions.getUnchecked(i);
+        }
+    }
+    else
+    {
+        this->nodes.clear();
+        this->nodes.ensureStorageAllocated(revisions.size());
+
+        for (int i = 0; i < revisions.size(); ++i)
+        {
+            auto *node = this->nodes.add(new Node());
+            node->revision = revisions.getUnchecked(i);
+            node->ancestor = node;
+
+            if (auto *parentNode = this->nodes[parentIndices.getUnchecked(i)])
+            {
+                node->parent = parentNode;
+                node->number = parentNode->number + 1;
+                parentNode->children.add(node);
+            }
+            else
+            {
+                node->number = 1;
+            }
+
+            node->y = float(node->number);
+        }
+
+        this->updateLayout();
+    }
+
+    this->updateVisibleComponents();
+}
+
+void RevisionTreeComponent::flattenHistory(const VCS::Revision::Ptr revision, int parentIndex,
+    Array<VCS::Revision::Ptr> &outRevisions, Array<int> &outParentIndices) const
 {
-    this->deleteAllChildren();
+    const auto index = outRevisions.size();
+    outRevisions.add(revision);
+    outParentIndices.add(parentIndex);
+
+    for (const auto childRevision : revision->getChildren())
+    {
+        this->flattenHistory(childRevision, index, outRevisions, outParentIndices);
+    }
 }
 
 void RevisionTreeComponent::deselectAll(bool sendNotification)
@@ -107,37 +176,133 @@ VCS::Revision::Ptr RevisionTreeComponent::getSelectedRevision() const noexcept
 }
 
 //===----------------------------------------------------------------------===//
-// Buchheim tree layout functions
+// Visible components
 //===----------------------------------------------------------------------===//
 
-RevisionComponent *RevisionTreeComponent::initComponents(int depth,
-    const VCS::Revision::Ptr revision, RevisionComponent *parentRevisionComponent)
+void RevisionTreeComponent::parentHierarchyChanged()
 {
+    if (this->observedParent != nullptr)
+    {
+        this->observedParent->removeComponentListener(this);
+    }
+
+    if (this->observedViewport != nullptr)
+    {
+        this->observedViewport->removeComponentListener(this);
+    }
+
+    // scrolling moves the viewed component, which is the parent proxy,
+    // and resizing the viewport might not move or resize anything
+    this->observedParent = this->getParentComponent();
+    this->observedViewport = this->findParentComponentOfClass<Viewport>();
+
+    if (this->observedParent != nullptr)
+    {
+        this->observedParent->addComponentListener(this);
+    }
+
+    if (this->observedViewport != nullptr)
+    {
+        this->observedViewport->addComponentListener(this);
+    }
+
+    this->updateVisibleComponents();
+}
+
+void RevisionTreeComponent::moved()
+{
+    this->updateVisibleComponents();
+}
+
+void RevisionTreeComponent::componentMovedOrResized(Component &component,
+    bool wasMoved, bool wasResized)
+{
+    this->updateVisibleComponents();
+}
+
+void RevisionTreeComponent::updateVisibleComponents()
+{
+    // not displayed yet, so nothing is visible
+    if (this->observedViewport == nullptr)
+    {
+        return;
+    }
+
+    const auto visibleArea = this->getLocalArea(this->observedViewport,
+        this->observedViewport->getLocalBounds())
+        .expanded(RevisionComponent::defaultWidth, RevisionComponent::defaultHeight);
+
+    for (auto *node : this->nodes)
+    {
+        this->updateComponentsFor(node, visibleArea.intersects(node->bounds));
+
+        if (node->parent != nullptr)
+        {
+            const auto connectorArea = node->bounds.getUnion(node->parent->bounds);
+            if (!visibleArea.intersects(connectorArea))
+            {
+                node->parentConnector = nullptr;
+            }
+            else if (node->parentConnector == nullptr)
+            {
+                node->parentConnector = make<RevisionConnectorComponent>(node->parent->bounds, node->bounds);
+                this->addAndMakeVisible(node->parentConnector.get());
+                node->parentConnector->toBack();
+            }
+        }
+    }
+}
+
+void RevisionTreeComponent::updateComponentsFor(Node *node, bool isVisible)
+{
+    if (!isVisible)
+    {
+        node->component = nullptr;
+        return;
+    }
+
+    if (node->component != nullptr)
+    {
+        return;
+    }
+
 #if NO_NETWORK
     const auto state = VCS::Revision::SyncState::NoSync;
 #else
-    const auto state = this->vcs.getRevisionSyncState(revision);
+    const auto state = this->vcs.getRevisionSyncState(node->revision);
 #endif
-    const bool isHead = (this->vcs.getHead().getHeadingRevision() == revision);
+    const bool isHead = (this->vcs.getHead().getHeadingRevision() == node->revision);
+
+    node->component = make<RevisionComponent>(this->vcs, node->revision, state, isHead);
+    node->component->setBounds(node->bounds);
+    node->component->setSelected(this->selectedRevision == node->revision);
+    this->addAndMakeVisible(node->component.get());
+}
+
+//===----------------------------------------------------------------------===//
+// Buchheim tree layout functions
+//===----------------------------------------------------------------------===//
+
+void RevisionTreeComponent::updateLayout()
+{
+    auto *root = this->nodes.getFirst();
+    jassert(root != nullptr);
 
-    auto *revisionComponent = new RevisionComponent(this->vcs, revision, state, isHead);
-    revisionComponent->parent = parentRevisionComponent;
-    revisionComponent->y = float(depth);
-    revisionComponent->number = depth;
-    revisionComponent->ancestor = revisionComponent;
+    auto *dt = this->firstWalk(root);
 
-    this->addAndMakeVisible(revisionComponent);
+    float min = -1;
+    this->treeDepth = 0.f;
+    min = this->secondWalk(dt, min);
 
-    for (const auto childRevision : revision->getChildren())
+    if (min < 0)
     {
-        auto *childComponent = this->initComponents(depth + 1, childRevision, revisionComponent);
-        revisionComponent->children.add(childComponent);
+        this->thirdWalk(dt, -min);
     }
 
-    return revisionComponent;
+    this->postWalk();
 }
 
-RevisionComponent *RevisionTreeComponent::firstWalk(RevisionComponent *v, float distance)
+RevisionTreeComponent::Node *RevisionTreeComponent::firstWalk(Node *v, float distance)
 {
     if (v->children.size() == 0)
     {
@@ -180,20 +345,20 @@ RevisionComponent *RevisionTreeComponent::firstWalk(RevisionComponent *v, float
     return v;
 }
 
-RevisionComponent *RevisionTreeComponent::apportion(RevisionComponent *v,
-    RevisionComponent *default_ancestor, float distance)
+RevisionTreeComponent::Node *RevisionTreeComponent::apportion(Node *v,
+    Node *default_ancestor, float distance)
 {
-    RevisionComponent *w = v->getLeftBrother();
+    Node *w = v->getLeftBrother();
 
     if (w != nullptr)
     {
         //in buchheim notation:
         //i == inner; o == outer; r == right; l == left;
-        RevisionComponent *vir = v;
-        RevisionComponent *vor = v;
-        RevisionComponent *vil = w;
+        Node *vir = v;
+        Node *vor = v;
+        Node *vil = w;
 
-        RevisionComponent *vol = v->getLeftmostSibling();
+        Node *vol = v->getLeftmostSibling();
 
         float sir = v->mod;
         float sor = v->mod;
@@ -213,7 +378,7 @@ RevisionComponent *RevisionTreeComponent::apportion(RevisionComponent *v,
 
             if (shift > 0)
             {
-                RevisionComponent *a = ancestor(vil, v, default_ancestor);
+                Node *a = ancestor(vil, v, default_ancestor);
                 moveSubtree(a, v, shift);
                 sir = sir + shift;
                 sor = sor + shift;
@@ -245,7 +410,7 @@ RevisionComponent *RevisionTreeComponent::apportion(RevisionComponent *v,
     return default_ancestor;
 }
 
-void RevisionTreeComponent::moveSubtree(RevisionComponent *wl, RevisionComponent *wr, float shift)
+void RevisionTreeComponent::moveSubtree(Node *wl, Node *wr, float shift)
 {
     int subtrees = wr->number - wl->number;
     if (subtrees != 0)
@@ -263,7 +428,7 @@ void RevisionTreeComponent::moveSubtree(RevisionComponent *wl, RevisionComponent
     wr->mod += shift;
 }
 
-void RevisionTreeComponent::executeShifts(RevisionComponent *v)
+void RevisionTreeComponent::executeShifts(Node *v)
 {
     float shift = 0;
     float change = 0;
@@ -277,8 +442,8 @@ void RevisionTreeComponent::executeShifts(RevisionComponent *v)
     }
 }
 
-RevisionComponent *RevisionTreeComponent::ancestor(RevisionComponent *vil,
-    RevisionComponent *v, RevisionComponent *default_ancestor)
+RevisionTreeComponent::Node *RevisionTreeComponent::ancestor(Node *vil,
+    Node *v, Node *default_ancestor)
 {
     for (auto *child : v->children)
     {
@@ -291,7 +456,7 @@ RevisionComponent *RevisionTreeComponent::ancestor(RevisionComponent *vil,
     return default_ancestor;
 }
 
-float RevisionTreeComponent::secondWalk(RevisionComponent *v, float &min, float m, float depth)
+float RevisionTreeComponent::secondWalk(Node *v, float &min, float m, float depth)
 {
     v->x += m;
     v->y = depth;
@@ -310,7 +475,7 @@ float RevisionTreeComponent::secondWalk(RevisionComponent *v, float &min, float
     return min;
 }
 
-void RevisionTreeComponent::thirdWalk(RevisionComponent *v, float n)
+void RevisionTreeComponent::thirdWalk(Node *v, float n)
 {
     v->x += n;
 
@@ -320,24 +485,25 @@ void RevisionTreeComponent::thirdWalk(RevisionComponent *v, float n)
     }
 }
 
-void RevisionTreeComponent::postWalk(RevisionComponent *v)
+void RevisionTreeComponent::postWalk()
 {
-    const int vx = int(v->x * (v->getWidth() + 10));
-    const int vy = int((this->treeDepth - v->y) * (v->getHeight() + RevisionTreeComponent::connectorHeight));
+    int width = 1;
+    int height = 1;
 
-    const int newWidth = jmax(this->getWidth(), vx + v->getWidth());
-    const int newHeight = jmax(this->getHeight(), vy + v->getHeight());
+    constexpr auto w = RevisionComponent::defaultWidth;
+    constexpr auto h = RevisionComponent::defaultHeight;
 
-    this->setSize(newWidth, newHeight);
-    v->setTopLeftPosition(vx, vy);
-
-    for (auto *child : v->children)
+    for (auto *v : this->nodes)
     {
-        this->postWalk(child);
-        auto revisionConnector = make<RevisionConnectorComponent>(v, child);
-        revisionConnector->resizeToFit();
-        this->addAndMakeVisible(revisionConnector.release());
+        const int vx = int(v->x * (w + 10));
+        const int vy = int((this->treeDepth - v->y) * (h + RevisionTreeComponent::connectorHeight));
+
+        v->bounds = { vx, vy, w, h };
+        width = jmax(width, vx + w);
+        height = jmax(height, vy + h);
     }
+
+    this->setSize(width, height);
 }
 
 HistoryComponent *RevisionTreeComponent::findParentEditor() const
@@ -356,3 +522,48 @@ HistoryComponent *RevisionTreeComponent::findParentEditor() const
 
     return nullptr;
 }
+
+//===----------------------------------------------------------------------===//
+// Node
+//===----------------------------------------------------------------------===//
+
+RevisionTreeComponent::Node *RevisionTreeComponent::Node::getLeftmostSibling() const
+{
+    if (!this->leftmostSibling && this->parent)
+    {
+        if (this != this->parent->children.getFirst())
+        {
+            this->leftmostSibling = this->parent->children.getFirst();
+        }
+    }
+
+    return this->leftmostSibling;
+}
+
+RevisionTreeComponent::Node *RevisionTreeComponent::Node::getLeftBrother() const
+{
+    Node *n = nullptr;
+
+    if (this->parent)
+    {
+        for (auto i : this->parent->children)
+        {
+            if (i == this) { return n; }
+            n = i;
+        }
+    }
+
+    return n;
+}
+
+RevisionTreeComponent::Node *RevisionTreeComponent::Node::right() const
+{
+    if (this->children.size() > 0) { return this->children.getLast(); }
+    return this->wired;
+}
+
+RevisionTreeComponent::Node *RevisionTreeComponent::Node::left() const
+{
+    if (this->children.size() > 0) { return this->children.getFirst(); }
+    return this->wired;
+}
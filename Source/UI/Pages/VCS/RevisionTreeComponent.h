@@ -19,45 +19,113 @@
 
 class VersionControl;
 class RevisionComponent;
+class RevisionConnectorComponent;
 class HistoryComponent;
 
 #include "Revision.h"
 
-class RevisionTreeComponent final : public Component
+// The layout is computed for lightweight nodes, not for components,
+// and is only re-computed when the shape of the tree changes;
+// revision components and connectors are only created for the nodes
+// within the visible area of the parent viewport, so that the history
+// of any length is as cheap to display as the part of it on the screen
+class RevisionTreeComponent final :
+    public Component,
+    private ComponentListener
 {
 public:
 
     explicit RevisionTreeComponent(VersionControl &owner);
     ~RevisionTreeComponent() override;
 
+    void rebuild();
+
     void deselectAll(bool sendNotification = true);
     void selectComponent(RevisionComponent *revComponent, bool deselectOthers, bool sendNotification = true);
 
     VCS::Revision::Ptr getSelectedRevision() const noexcept;
 
+    //===------------------------------------------------------------------===//
+    // Component
+    //===------------------------------------------------------------------===//
+
     void handleCommandMessage(int commandId) override;
+    void parentHierarchyChanged() override;
+    void moved() override;
 
 private:
 
-    // Tree layout methods:
+    //===------------------------------------------------------------------===//
+    // ComponentListener
+    //===------------------------------------------------------------------===//
+
+    void componentMovedOrResized(Component &component,
+        bool wasMoved, bool wasResized) override;
+
+private:
+
+    struct Node final
+    {
+        VCS::Revision::Ptr revision;
+
+        // Helpers for tree traverse:
+
+        float x = 0.f;
+        float y = 0.f;
+        float mod = 0.f;
+        float shift = 0.f;
+        float change = 0.f;
+        int number = 0;
+
+        Node *parent = nullptr;
+        Node *ancestor = nullptr;
+        Node *wired = nullptr;
+
+        Array<Node *> children;
 
-    RevisionComponent *initComponents(int depth,
-        const VCS::Revision::Ptr revision, RevisionComponent *parentRevisionComponent);
+        Node *getLeftmostSibling() const;
+        Node *getLeftBrother() const;
+        Node *right() const;
+        Node *left() const;
+
+        mutable Node *leftmostSibling = nullptr;
+
+        // the layout result and the components, if visible:
+
+        Rectangle<int> bounds;
+        UniquePointer<RevisionComponent> component;
+        UniquePointer<RevisionConnectorComponent> parentConnector;
+    };
+
+    // all nodes in the depth-first order, the root goes first
+    OwnedArray<Node> nodes;
+
+    void flattenHistory(const VCS::Revision::Ptr revision, int parentIndex,
+        Array<VCS::Revision::Ptr> &outRevisions, Array<int> &outParentIndices) const;
+
+    void updateVisibleComponents();
+    void updateComponentsFor(Node *node, bool isVisible);
+
+    SafePointer<Component> observedParent;
+    SafePointer<Component> observedViewport;
+
+private:
+
+    // Tree layout methods:
 
-    RevisionComponent *firstWalk(RevisionComponent *v, float distance = 1.f);
+    void updateLayout();
 
-    RevisionComponent *apportion(RevisionComponent *v,
-        RevisionComponent *default_ancestor, float distance);
+    Node *firstWalk(Node *v, float distance = 1.f);
+    Node *apportion(Node *v, Node *default_ancestor, float distance);
 
-    void moveSubtree(RevisionComponent *wl, RevisionComponent *wr, float shift);
-    void executeShifts(RevisionComponent *v);
+    void moveSubtree(Node *wl, Node *wr, float shift);
+    void executeShifts(Node *v);
 
-    RevisionComponent *ancestor(RevisionComponent *vil,
-        RevisionComponent *v, RevisionComponent *default_ancestor);
+    Node *ancestor(Node *vil, Node *v, Node *default_ancestor);
 
-    float secondWalk(RevisionComponent *v, float &min, float m = 0.f, float depth = 0.f);
-    void thirdWalk(RevisionComponent *v, float n);
-    void postWalk(RevisionComponent *v);
+    float secondWalk(Node *v, float &min, float m = 0.f, float depth = 0.f);
+    void thirdWalk(Node *v, float n);
+    void postWalk();
 
     float treeDepth = 0.f;
 
@@ -224,6 +224,7 @@ void ChordPreviewTool::buildChord(const Chord::Ptr chord)
             App::Layout().showTooltip(tooltip);
         }
 
+        Array<Note> chordNotes;
         for (const auto &chordKey : chord->getScaleKeys())
         {
             const auto inScaleKey = scaleDegree + chordKey.getInScaleKey();
@@ -235,13 +236,12 @@ void ChordPreviewTool::buildChord(const Chord::Ptr chord)
                 Globals::Defaults::previewNoteLength, Globals::Defaults::previewNoteVelocity);
 
             this->sequence->insert(note, true);
-
-            this->roll.getTransport().previewKey(this->sequence->getTrackId(),
-                key + this->clip.getKey(),
-                note.getVelocity(),
-                note.getLength());
+            chordNotes.add(note);
         }
 
+        this->roll.getTransport().previewNotes(this->sequence->getTrackId(),
+            chordNotes, this->clip.getKey());
+
         this->hasMadeChanges = true;
     }
 }
@@ -412,6 +412,7 @@ void ScalePreviewTool::buildChord(Array<int> keys)
         this->stopSound();
         sequence->checkpoint();
 
+        Array<Note> chordNotes;
         for (int offset : keys)
         {
             const int key = jlimit(0, this->roll->getNumKeys(), this->targetKey + offset);
@@ -420,11 +421,11 @@ void ScalePreviewTool::buildChord(Array<int> keys)
                 Globals::Defaults::previewNoteVelocity);
 
             sequence->insert(note, true);
-
-            this->roll->getTransport().previewKey(this->sequence->getTrackId(),
-                key, note.getVelocity(), note.getLength());
+            chordNotes.add(note);
         }
 
+        this->roll->getTransport().previewNotes(this->sequence->getTrackId(), chordNotes);
+
         this->hasMadeChanges = true;
     }
 }
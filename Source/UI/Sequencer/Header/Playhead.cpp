@@ -62,7 +62,7 @@ void Playhead::onSeek(float beatPosition, double currentTimeMs, double totalTime
 
     this->triggerAsyncUpdate();
 
-    if (this->isTimerRunning())
+    if (this->isPlaying.get())
     {
         this->timerStartTime = Time::getMillisecondCounterHiRes();
         this->timerStartPosition = this->lastCorrectPosition;
@@ -73,7 +73,7 @@ void Playhead::onTempoChanged(double msPerQuarter)
 {
     this->msPerQuarterNote = jmax(msPerQuarter, 0.01);
         
-    if (this->isTimerRunning())
+    if (this->isPlaying.get())
     {
         this->timerStartTime = Time::getMillisecondCounterHiRes();
         this->timerStartPosition = this->lastCorrectPosition;
@@ -84,7 +84,8 @@ void Playhead::onPlay()
 {
     this->timerStartTime = Time::getMillisecondCounterHiRes();
     this->timerStartPosition = this->lastCorrectPosition;
-    this->startTimerHz(60);
+    this->isPlaying = true;
+    FrameScheduler::getInstance().startAnimation(this);
 }
 
 void Playhead::onRecord()
@@ -98,7 +99,8 @@ void Playhead::onStop()
     this->currentColour = this->playbackColour;
     this->repaint();
 
-    this->stopTimer();
+    this->isPlaying = false;
+    FrameScheduler::getInstance().stopAnimation(this);
 
     this->timerStartTime = 0.0;
     this->timerStartPosition = 0.0;
@@ -106,12 +108,12 @@ void Playhead::onStop()
 }
 
 //===----------------------------------------------------------------------===//
-// Timer
+// FrameScheduler::Client
 //===----------------------------------------------------------------------===//
 
-void Playhead::timerCallback()
+void Playhead::onFrame(double frameTimeMs)
 {
-    this->triggerAsyncUpdate();
+    this->tick();
 }
 
 //===----------------------------------------------------------------------===//
@@ -120,7 +122,7 @@ void Playhead::timerCallback()
 
 void Playhead::handleAsyncUpdate()
 {
-    if (this->isTimerRunning())
+    if (this->isPlaying.get())
     {
         this->tick();
     }
@@ -159,7 +161,7 @@ void Playhead::parentChanged()
     {
         this->setSize(this->getWidth(), this->getParentHeight());
         
-        if (this->isTimerRunning())
+        if (this->isPlaying.get())
         {
             this->tick();
         }
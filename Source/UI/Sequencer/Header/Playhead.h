@@ -21,12 +21,13 @@ class Transport;
 class RollBase;
 
 #include "TransportListener.h"
+#include "FrameScheduler.h"
 
 class Playhead final :
     public Component,
     public TransportListener,
     private AsyncUpdater,
-    private Timer
+    private FrameScheduler::Client
 {
 public:
 
@@ -73,12 +74,15 @@ protected:
 private:
 
     //===------------------------------------------------------------------===//
-    // Timer
+    // FrameScheduler::Client
     //===------------------------------------------------------------------===//
 
-    void timerCallback() override;
+    void onFrame(double frameTimeMs) override;
     void tick();
 
+    // the seeks and the tempo changes come from the player thread
+    Atomic<bool> isPlaying = false;
+
     void parentChanged();
 
     Atomic<float> timerStartPosition = 0.f;
@@ -0,0 +1,109 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Common.h"
+#include "FrameScheduler.h"
+
+FrameScheduler::Client::~Client()
+{
+    FrameScheduler::getInstance().removeClient(this);
+}
+
+FrameScheduler &FrameScheduler::getInstance()
+{
+    static FrameScheduler scheduler;
+    return scheduler;
+}
+
+void FrameScheduler::requestFrame(Client *client)
+{
+    jassert(MessageManager::existsAndIsLockedByCurrentThread());
+    this->pendingClients.addIfNotAlreadyThere(client);
+    this->startFramesIfNeeded();
+}
+
+void FrameScheduler::startAnimation(Client *client)
+{
+    jassert(MessageManager::existsAndIsLockedByCurrentThread());
+    this->animatedClients.addIfNotAlreadyThere(client);
+    this->startFramesIfNeeded();
+}
+
+void FrameScheduler::stopAnimation(Client *client)
+{
+    this->animatedClients.removeFirstMatchingValue(client);
+}
+
+bool FrameScheduler::isAnimating(const Client *client) const noexcept
+{
+    return this->animatedClients.contains(const_cast<Client *>(client));
+}
+
+void FrameScheduler::setPaused(bool shouldBePaused)
+{
+    this->isPaused = shouldBePaused;
+
+    if (this->isPaused)
+    {
+        this->stopTimer();
+    }
+    else
+    {
+        this->startFramesIfNeeded();
+    }
+}
+
+void FrameScheduler::startFramesIfNeeded()
+{
+    const bool hasClients = !this->pendingClients.isEmpty() || !this->animatedClients.isEmpty();
+    if (hasClients && !this->isPaused && !this->isTimerRunning())
+    {
+        this->startTimerHz(FrameScheduler::framesPerSecond);
+    }
+}
+
+void FrameScheduler::removeClient(Client *client)
+{
+    this->animatedClients.removeFirstMatchingValue(client);
+    this->pendingClients.removeFirstMatchingValue(client);
+    this->currentFrameClients.removeFirstMatchingValue(client);
+}
+
+void FrameScheduler::timerCallback()
+{
+    if (this->pendingClients.isEmpty() && this->animatedClients.isEmpty())
+    {
+        this->stopTimer();
+        return;
+    }
+
+    const auto frameTimeMs = Time::getMillisecondCounterHiRes();
+
+    this->currentFrameClients.clearQuick();
+    this->currentFrameClients.swapWith(this->pendingClients);
+    for (auto *client : this->animatedClients)
+    {
+        this->currentFrameClients.addIfNotAlreadyThere(client);
+    }
+
+    // the callbacks may request more frames, or delete other clients
+    while (!this->currentFrameClients.isEmpty())
+    {
+        auto *client = this->currentFrameClients.removeAndReturn(0);
+        client->onFrame(frameTimeMs);
+    }
+}
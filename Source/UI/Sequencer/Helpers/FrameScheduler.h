@@ -0,0 +1,72 @@
+/*
+    This file is part of Helio Workstation.
+
+    Helio is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Helio is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Helio. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+// Instead of running a timer or an async updater per component,
+// the sequencer's animations and batched updates all run on this single
+// frame clock: the clients' callbacks are all called together, once per
+// frame, so that the bounds changes and repaints they make are coalesced
+// into one repaint of the window per frame; JUCE doesn't provide vsync
+// callbacks for this, so the clock is a timer running at the display rate
+class FrameScheduler final : private Timer
+{
+public:
+
+    class Client
+    {
+    public:
+
+        virtual ~Client();
+        virtual void onFrame(double frameTimeMs) = 0;
+    };
+
+    static FrameScheduler &getInstance();
+
+    // the client will be called once on the next frame
+    void requestFrame(Client *client);
+
+    // the client will be called on every frame until stopped
+    void startAnimation(Client *client);
+    void stopAnimation(Client *client);
+    bool isAnimating(const Client *client) const noexcept;
+
+    // while paused, e.g. when the app is in background, no frames are
+    // produced at all, and all pending ones come in one frame when resumed
+    void setPaused(bool shouldBePaused);
+
+    static constexpr auto framesPerSecond = 60;
+
+private:
+
+    FrameScheduler() = default;
+
+    void removeClient(Client *client);
+    void startFramesIfNeeded();
+    void timerCallback() override;
+
+    bool isPaused = false;
+
+    Array<Client *> animatedClients;
+    Array<Client *> pendingClients;
+
+    // the clients to call within the current frame,
+    // which may be removed by other clients' callbacks
+    Array<Client *> currentFrameClients;
+
+    JUCE_DECLARE_NON_COPYABLE(FrameScheduler)
+};
@@ -476,9 +476,8 @@ void PatternOperations::quantize(const Lasso &selection,
         return;
     }
 
-    bool didCheckpoint = !shouldCheckpoint;
-
     FlatHashSet<String, StringHash> processedTracks;
+    Array<WeakReference<MidiTrack>> tracks;
 
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
@@ -489,11 +488,11 @@ void PatternOperations::quantize(const Lasso &selection,
             continue;
         }
 
-        const auto hasMadeChanges = SequencerOperations::quantize(track, bar, !didCheckpoint);
-        didCheckpoint = didCheckpoint || hasMadeChanges;
-
+        tracks.add(track);
         processedTracks.insert(track->getTrackId());
     }
+
+    SequencerOperations::quantize(tracks, bar, shouldCheckpoint);
 }
 
 void PatternOperations::mergeClips(ProjectNode &project, const Clip &targetClip,
@@ -568,98 +567,100 @@ void PatternOperations::mergeClips(ProjectNode &project, const Clip &targetClip,
         clipToMergeInto = newlyAddedTrack->getPattern()->getClips().getFirst();
     }
 
-    // actual merging
+    // actual merging: all the events are collected first and inserted as one group,
+    // and only then the source clips are deleted (or their entire tracks,
+    // if the clip has only one instance), so that the target is updated once
+    Array<Clip> mergedClips;
+
     if (auto *pianoTargetSequence = dynamic_cast<PianoSequence *>(targetSequence))
     {
+        Array<Note> notesToInsert;
         for (const auto &clip : sourceClips)
         {
             auto *sourceSequence = clip.getPattern()->getTrack()->getSequence();
-            if (auto *pianoSourceSequence = dynamic_cast<PianoSequence *>(sourceSequence))
+            if (dynamic_cast<PianoSequence *>(sourceSequence) == nullptr)
             {
-                if (!didCheckpoint)
-                {
-                    didCheckpoint = true;
-                    project.checkpoint();
-                }
+                jassertfalse; // please don't pass the clips that can't be merged
+                continue;
+            }
 
-                // copy notes to target sequence with corrected beats, keys and velocities
-                Array<Note> notesToInsert;
-                for (auto *event : *sourceSequence)
-                {
-                    auto *note = static_cast<Note *>(event);
-                    const auto deltaKey = clip.getKey() - clipToMergeInto->getKey();
-                    const auto deltaBeat = clip.getBeat() - clipToMergeInto->getBeat();
-                    const auto newVelocity = note->getVelocity() * (clip.getVelocity() / clipToMergeInto->getVelocity());
-                    notesToInsert.add(note->withDeltaBeat(deltaBeat)
-                        .withDeltaKey(deltaKey)
-                        .withVelocity(newVelocity)
-                        .withNewId(pianoTargetSequence));
-                }
+            // copy notes to target sequence with corrected beats, keys and velocities
+            const auto deltaKey = clip.getKey() - clipToMergeInto->getKey();
+            const auto deltaBeat = clip.getBeat() - clipToMergeInto->getBeat();
+            const auto velocityFactor = clip.getVelocity() / clipToMergeInto->getVelocity();
+            notesToInsert.ensureStorageAllocated(notesToInsert.size() + sourceSequence->size());
+            for (auto *event : *sourceSequence)
+            {
+                auto *note = static_cast<Note *>(event);
+                notesToInsert.add(note->withDeltaBeat(deltaBeat)
+                    .withDeltaKey(deltaKey)
+                    .withVelocity(note->getVelocity() * velocityFactor)
+                    .withNewId(pianoTargetSequence));
+            }
 
-                pianoTargetSequence->insertGroup(notesToInsert, true);
+            mergedClips.add(clip);
+        }
 
-                // delete the entire track if the clip has only one instance:
-                if (clip.getPattern()->size() == 1)
-                {
-                    project.removeTrack(*clip.getPattern()->getTrack());
-                }
-                else
-                {
-                    clip.getPattern()->remove(clip, true);
-                }
-            }
-            else
+        if (!mergedClips.isEmpty())
+        {
+            if (!didCheckpoint)
             {
-                jassertfalse; // please don't pass the clips that can't be merged
+                didCheckpoint = true;
+                project.checkpoint();
             }
+
+            pianoTargetSequence->insertGroup(notesToInsert, true);
         }
     }
     else if (auto *autoTargetSequence = dynamic_cast<AutomationSequence *>(targetSequence))
     {
+        Array<AutomationEvent> eventsToInsert;
         for (const auto &clip : sourceClips)
         {
             auto *sourceSequence = clip.getPattern()->getTrack()->getSequence();
-            if (auto *autoSourceSequence = dynamic_cast<AutomationSequence *>(sourceSequence))
+            auto *autoSourceSequence = dynamic_cast<AutomationSequence *>(sourceSequence);
+            if (autoSourceSequence == nullptr ||
+                autoTargetSequence->getTrack()->getTrackControllerNumber() !=
+                autoSourceSequence->getTrack()->getTrackControllerNumber())
             {
-                if (autoTargetSequence->getTrack()->getTrackControllerNumber() !=
-                    autoSourceSequence->getTrack()->getTrackControllerNumber())
-                {
-                    jassertfalse; // please don't pass the clips that can't be merged
-                    continue;
-                }
-
-                if (!didCheckpoint)
-                {
-                    didCheckpoint = true;
-                    project.checkpoint();
-                }
+                jassertfalse; // please don't pass the clips that can't be merged
+                continue;
+            }
 
-                // copy events to target sequence with corrected beats
-                Array<AutomationEvent> eventsToInsert;
-                for (auto *event : *sourceSequence)
-                {
-                    auto *ae = static_cast<AutomationEvent *>(event);
-                    const auto deltaBeat = clip.getBeat() - clipToMergeInto->getBeat();
-                    eventsToInsert.add(ae->withDeltaBeat(deltaBeat)
-                        .withNewId(autoTargetSequence));
-                }
+            // copy events to target sequence with corrected beats
+            const auto deltaBeat = clip.getBeat() - clipToMergeInto->getBeat();
+            eventsToInsert.ensureStorageAllocated(eventsToInsert.size() + sourceSequence->size());
+            for (auto *event : *sourceSequence)
+            {
+                auto *ae = static_cast<AutomationEvent *>(event);
+                eventsToInsert.add(ae->withDeltaBeat(deltaBeat)
+                    .withNewId(autoTargetSequence));
+            }
 
-                autoTargetSequence->insertGroup(eventsToInsert, true);
+            mergedClips.add(clip);
+        }
 
-                // delete the entire track if the clip has only one instance:
-                if (clip.getPattern()->size() == 1)
-                {
-                    project.removeTrack(*clip.getPattern()->getTrack());
-                }
-                else
-                {
-                    clip.getPattern()->remove(clip, true);
-                }
-            }
-            else
+        if (!mergedClips.isEmpty())
+        {
+            if (!didCheckpoint)
             {
-                jassertfalse; // please don't pass the clips that can't be merged
+                didCheckpoint = true;
+                project.checkpoint();
             }
+
+            autoTargetSequence->insertGroup(eventsToInsert, true);
+        }
+    }
+
+    for (const auto &clip : mergedClips)
+    {
+        if (clip.getPattern()->size() == 1)
+        {
+            project.removeTrack(*clip.getPattern()->getTrack());
+        }
+        else
+        {
+            clip.getPattern()->remove(clip, true);
         }
     }
 }
@@ -42,6 +42,7 @@
 #include "AutomationTrackActions.h"
 
 #include "ColourIDs.h"
+#include "ParallelTasks.h"
 
 // a big FIXME:
 // most of this code assumes every track has its own undo stack;
@@ -344,225 +345,106 @@ float SequencerOperations::findEndBeat(const WeakReference<Lasso> selection)
     return 0.f;
 }
 
-void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoint)
+struct NoteKeyAndBeatComparator final
 {
-    if (selection.getNumSelected() < 2)
+    static int compareElements(const Note &first, const Note &second) noexcept
     {
-        return;
+        const auto keyDiff = first.getKey() - second.getKey();
+        if (keyDiff != 0) { return keyDiff; }
+
+        const auto beatDiff = first.getBeat() - second.getBeat();
+        if (beatDiff != 0.f) { return (beatDiff > 0.f) - (beatDiff < 0.f); }
+
+        // the longest of the notes starting at the same beat goes first
+        const auto lengthDiff = second.getLength() - first.getLength();
+        if (lengthDiff != 0.f) { return (lengthDiff > 0.f) - (lengthDiff < 0.f); }
+
+        return (first.getId() > second.getId()) - (first.getId() < second.getId());
     }
+};
 
-    bool didCheckpoint = !shouldCheckpoint;
+// converts this         into this
+// ------------          ---
+//    ---------             ---
+//       ---------             ---------
 
-    // 1 convert this
-    //    ----
-    // ------------
-    // into this
-    //    ---------
-    // ------------
-    
-    // todo repeat while does any changes
-    
-    bool step1HasChanges = false;
-    
-    do
+// the notes of each key are swept in the order of their beats,
+// and each run of overlapping notes becomes a sequence of notes,
+// which last until the next one starts, or until the run ends;
+// from the notes starting at the same beat, only the longest one is kept
+static void findNoteOverlapsCleanup(Array<Note> &notes,
+    PianoChangeGroup &groupBefore, PianoChangeGroup &groupAfter,
+    PianoChangeGroup &removalGroup)
+{
+    NoteKeyAndBeatComparator comparator;
+    notes.sort(comparator);
+
+    int runStart = 0;
+    while (runStart < notes.size())
     {
-        PianoChangeGroup group1Before, group1After;
+        const auto &firstNote = notes.getReference(runStart);
+        auto runEndBeat = firstNote.getBeat() + firstNote.getLength();
 
-        for (int i = 0; i < selection.getNumSelected(); ++i)
+        int runEnd = runStart + 1;
+        while (runEnd < notes.size())
         {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            
-            // для каждой ноты найти ноту, которая полностью перекрывает ее на максимальную длину
-            
-            float deltaBeats = -FLT_MAX;
-            const Note *overlappingNote = nullptr;
-            
-            for (int j = 0; j < selection.getNumSelected(); ++j)
-            {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
-                
-                if (nc->getKey() == nc2->getKey() &&
-                    nc->getBeat() > nc2->getBeat() &&
-                    (nc->getBeat() + nc->getLength()) < (nc2->getBeat() + nc2->getLength()))
-                {
-                    const float currentDelta = (nc2->getBeat() + nc2->getLength()) - (nc->getBeat() + nc->getLength());
-                    
-                    if (deltaBeats < currentDelta)
-                    {
-                        deltaBeats = currentDelta;
-                        overlappingNote = &nc2->getNote();
-                    }
-                }
-            }
-            
-            if (overlappingNote != nullptr)
+            const auto &note = notes.getReference(runEnd);
+            if (note.getKey() != firstNote.getKey() || note.getBeat() >= runEndBeat)
             {
-                const float newLength = nc->getLength() + deltaBeats;
-                group1Before.add(nc->getNote());
-                group1After.add(nc->getNote().withLength(newLength));
+                break;
             }
+
+            runEndBeat = jmax(runEndBeat, note.getBeat() + note.getLength());
+            runEnd++;
         }
-        
-        step1HasChanges = applyPianoChanges(group1Before, group1After, didCheckpoint);
-    }
-    while (step1HasChanges);
-    
-    
-    // 1 convert this
-    //    -------------
-    // ------------
-    // into this
-    //    -------------
-    // ----------------
-    
-    bool step2HasChanges = false;
 
-    do
-    {
-        PianoChangeGroup group2Before, group2After;
-        
-        for (int i = 0; i < selection.getNumSelected(); ++i)
+        int i = runStart;
+        while (i < runEnd)
         {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            
-            // для каждой ноты найти ноту, которая полностью перекрывает ее на максимальную длину
-            
-            float deltaBeats = -FLT_MAX;
-            const NoteComponent *overlappingNote = nullptr;
-            
-            for (int j = 0; j < selection.getNumSelected(); ++j)
+            const auto &note = notes.getReference(i);
+
+            int next = i + 1;
+            while (next < runEnd && notes.getReference(next).getBeat() == note.getBeat())
             {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
-                
-                if (nc->getKey() == nc2->getKey() &&
-                    nc->getBeat() > nc2->getBeat() &&
-                    nc->getBeat() < (nc2->getBeat() + nc2->getLength()) &&
-                    (nc->getBeat() + nc->getLength()) > (nc2->getBeat() + nc2->getLength()))
-                {
-                    const float currentDelta = (nc->getBeat() + nc->getLength()) - (nc2->getBeat() + nc2->getLength());
-                    
-                    if (deltaBeats < currentDelta)
-                    {
-                        deltaBeats = currentDelta;
-                        overlappingNote = nc2;
-                    }
-                }
+                removalGroup.add(notes.getReference(next));
+                next++;
             }
-            
-            if (overlappingNote != nullptr)
+
+            const auto endBeat = next < runEnd ? notes.getReference(next).getBeat() : runEndBeat;
+            const auto newLength = endBeat - note.getBeat();
+            if (newLength != note.getLength())
             {
-                group2Before.add(overlappingNote->getNote());
-                group2After.add(overlappingNote->getNote().withDeltaLength(deltaBeats));
+                groupBefore.add(note);
+                groupAfter.add(note.withLength(newLength));
             }
+
+            i = next;
         }
-        
-        step2HasChanges = applyPianoChanges(group2Before, group2After, didCheckpoint);
+
+        runStart = runEnd;
     }
-    while (step2HasChanges);
-    
-    
-    // 3 convert this
-    // ------------       ---------
-    //    ---------    ------------
-    // into this
-    // ---                ---------
-    //    ---------    ---         
-    
-    bool step3HasChanges = false;
+}
 
-    do
+void SequencerOperations::cleanupOverlaps(Lasso &selection, bool shouldCheckpoint)
+{
+    if (selection.getNumSelected() < 2)
     {
-        PianoChangeGroup group3Before, group3After;
-        
-        for (int i = 0; i < selection.getNumSelected(); ++i)
-        {
-            const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-            
-            // для каждой ноты найти ноту, которая перекрывает ее максимально
-            
-            float overlappingBeats = -FLT_MAX;
-            const NoteComponent *overlappingNote = nullptr;
-            
-            for (int j = 0; j < selection.getNumSelected(); ++j)
-            {
-                auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
-                
-                if (nc->getKey() == nc2->getKey() &&
-                    nc->getBeat() < nc2->getBeat() &&
-                    (nc->getBeat() + nc->getLength()) >= (nc2->getBeat() + nc2->getLength()))
-                {
-                    // >0 : has overlap
-                    const float overlapsWith = (nc->getBeat() + nc->getLength()) - nc2->getBeat();
-                    
-                    if (overlapsWith > overlappingBeats)
-                    {
-                        overlappingBeats = overlapsWith;
-                        overlappingNote = nc2;
-                    }
-                }
-            }
-            
-            if (overlappingNote != nullptr)
-            {
-                const float newLength = nc->getLength() - overlappingBeats;
-                group3Before.add(nc->getNote());
-                group3After.add(nc->getNote().withLength(newLength));
-            }
-        }
-        
-        step3HasChanges = applyPianoChanges(group3Before, group3After, didCheckpoint);
+        return;
     }
-    while (step3HasChanges);
-    
-    
-    // remove duplicates
-    
-    FlatHashMap<MidiEvent::Id, Note> deferredRemoval;
-    FlatHashMap<MidiEvent::Id, Note> unremovableNotes;
-    
+
+    bool didCheckpoint = !shouldCheckpoint;
+
+    Array<Note> notes;
+    notes.ensureStorageAllocated(selection.getNumSelected());
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        const auto *nc = static_cast<NoteComponent *>(selection.getSelectedItem(i));
-        
-        for (int j = 0; j < selection.getNumSelected(); ++j)
-        {
-            if (i == j)
-            {
-                continue;
-            }
-            
-            const auto *nc2 = static_cast<NoteComponent *>(selection.getSelectedItem(j));
-            
-            // full overlap
-            //const bool isOverlappingNote = (nc->getKey() == nc2->getKey() &&
-            //                                nc->getBeat() >= nc2->getBeat() &&
-            //                                (nc->getBeat() + nc->getLength()) <= (nc2->getBeat() + nc2->getLength()));
-
-            // partial overlaps also
-            const bool isOverlappingNote = (nc->getKey() == nc2->getKey() &&
-                                            nc->getBeat() >= nc2->getBeat() &&
-                                            nc->getBeat() < (nc2->getBeat() + nc2->getLength()));
-            
-            const bool startsFromTheSameBeat = (nc->getKey() == nc2->getKey() &&
-                                                nc->getBeat() == nc2->getBeat());
-            
-            const bool isOriginalNote = unremovableNotes.contains(nc2->getNote().getId());
-            
-            if (! isOriginalNote &&
-                (isOverlappingNote || startsFromTheSameBeat))
-            {
-                unremovableNotes[nc->getNote().getId()] = nc->getNote();
-                deferredRemoval[nc2->getNote().getId()] = nc2->getNote();
-            }
-        }
-    }
-    
-    PianoChangeGroup removalGroup;
-    for (const auto &deferredRemovalIterator : deferredRemoval)
-    {
-        removalGroup.add(deferredRemovalIterator.second);
+        notes.add(selection.getItemAs<NoteComponent>(i)->getNote());
     }
 
+    PianoChangeGroup groupBefore, groupAfter, removalGroup;
+    findNoteOverlapsCleanup(notes, groupBefore, groupAfter, removalGroup);
+
+    applyPianoChanges(groupBefore, groupAfter, didCheckpoint);
     applyPianoRemovals(removalGroup, didCheckpoint);
 }
 
@@ -729,6 +611,7 @@ bool SequencerOperations::arpeggiate(Lasso &selection,
     const float selectionStartBeat = SequencerOperations::findStartBeat(sortedRemovals);
 
     // 3. arpeggiate every chord
+    Arpeggiator::ChordKeysCache chordKeysCache;
     int arpKeyIndex = 0;
     float arpBeatOffset = 0.f;
     const float arpSequenceLength = arp->getSequenceLength();
@@ -759,7 +642,7 @@ bool SequencerOperations::arpeggiate(Lasso &selection,
                 break;
             }
 
-            insertions.add(arp->mapArpKeyIntoChordSpace(temperament,
+            insertions.add(arp->mapArpKeyIntoChordSpace(chordKeysCache, temperament,
                 arpKeyIndex, beatOffset,
                 chord, chordScale, chordRoot,
                 isReversed, durationMultiplier, randomness));
@@ -1010,16 +893,25 @@ void SequencerOperations::copyToClipboard(Clipboard &clipboard, const Lasso &sel
 
     SerializedData trackRoot(Serialization::Clipboard::track);
 
-    // at the moment, copy-paste only works in the piano roll
+    // at the moment, copy-paste only works in the piano roll;
+    // the notes are packed into one binary property, like the sequences are saved,
+    // instead of a child tree per note, which was slow and heavy for large selections
+    Array<Note> notes;
+    notes.ensureStorageAllocated(selection.getNumSelected());
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
         if (const auto *noteComponent = dynamic_cast<NoteComponent *>(selection.getSelectedItem(i)))
         {
-            trackRoot.appendChild(noteComponent->getNote().serialize());
+            notes.add(noteComponent->getNote());
             firstBeat = jmin(firstBeat, noteComponent->getBeat());
         }
     }
 
+    // sorted notes make the packed beat and key deltas small
+    static Note comparator;
+    notes.sort(comparator);
+    Note::packNotes(trackRoot, notes);
+
     tree.appendChild(trackRoot);
 
     tree.setProperty(Serialization::Clipboard::firstBeat, firstBeat);
@@ -1081,11 +973,15 @@ void SequencerOperations::pasteFromClipboard(Clipboard &clipboard, ProjectNode &
         }
         else if (auto *pianoSequence = dynamic_cast<PianoSequence *>(selectedTrack->getSequence()))
         {
+            // older clipboard contents with a child tree per note are unpacked too
+            Array<Note> copiedNotes;
+            Note::unpackNotes(layerElement, copiedNotes);
+
             Array<Note> pastedNotes;
-            forEachChildWithType(layerElement, noteElement, Serialization::Midi::note)
+            pastedNotes.ensureStorageAllocated(copiedNotes.size());
+            for (const auto &note : copiedNotes)
             {
-                const auto &n = Note(pianoSequence).withParameters(noteElement).withNewId();
-                pastedNotes.add(n.withDeltaBeat(deltaBeat));
+                pastedNotes.add(note.withNewId(pianoSequence).withDeltaBeat(deltaBeat));
             }
 
             if (pastedNotes.size() > 0)
@@ -1512,150 +1408,159 @@ static inline void doQuantize(float &startBeat, float &length, float bar)
     length = jmax(minQuantizedBeat, endBeatRound - startBeat);
 }
 
-bool SequencerOperations::quantize(const Lasso &selection, float bar, bool shouldCheckpoint /*= true*/)
+// the notes which end up with the same key, beat and length after quantizing
+// are duplicates; they are looked up by hash instead of comparing each note
+// with all the notes quantized before it, which was way too slow for large tracks
+struct QuantizedNoteParams final
 {
-    if (selection.getNumSelected() == 0)
+    Note::Key key;
+    float beat;
+    float length;
+
+    inline bool operator== (const QuantizedNoteParams &other) const noexcept
     {
-        return false;
+        return this->key == other.key && this->beat == other.beat && this->length == other.length;
     }
+};
 
-    auto *sequence = getPianoSequence(selection);
-    jassert(sequence);
-
-    PianoChangeGroup removals;
-    PianoChangeGroup groupBefore, groupAfter;
-    for (int i = 0; i < selection.getNumSelected(); ++i)
+struct QuantizedNoteParamsHash final
+{
+    inline HashCode operator()(const QuantizedNoteParams &params) const noexcept
     {
-        const auto *nc = selection.getItemAs<NoteComponent>(i);
-        float startBeat = nc->getBeat();
-        float length = nc->getLength();
+        return static_cast<HashCode>(params.key) ^
+            (std::hash<float>()(params.beat) << 1) ^
+            (std::hash<float>()(params.length) << 2);
+    }
+};
 
-        doQuantize(startBeat, length, bar);
+using QuantizedNotes = FlatHashSet<QuantizedNoteParams, QuantizedNoteParamsHash>;
 
-        if (startBeat == nc->getBeat() && length == nc->getLength())
-        {
-            continue;
-        }
+static void doQuantize(const Note &note, float bar, QuantizedNotes &quantizedNotes,
+    PianoChangeGroup &removals, PianoChangeGroup &groupBefore, PianoChangeGroup &groupAfter)
+{
+    float startBeat = note.getBeat();
+    float length = note.getLength();
 
-        bool duplicateFound = false;
-        for (const auto &other : groupAfter)
-        {
-            if (nc->getKey() == other.getKey() &&
-                startBeat == other.getBeat() &&
-                length == other.getLength())
-            {
-                duplicateFound = true;
-                break;
-            }
-        }
+    doQuantize(startBeat, length, bar);
 
-        if (duplicateFound)
-        {
-            removals.add(nc->getNote());
-            continue;
-        }
+    if (startBeat == note.getBeat() && length == note.getLength())
+    {
+        return;
+    }
 
-        groupBefore.add(nc->getNote());
-        groupAfter.add(nc->getNote().withBeat(startBeat).withLength(length));
+    if (!quantizedNotes.insert({ note.getKey(), startBeat, length }).second)
+    {
+        removals.add(note);
+        return;
+    }
+
+    groupBefore.add(note);
+    groupAfter.add(note.withBeat(startBeat).withLength(length));
+}
+
+struct QuantizedSequence final
+{
+    PianoSequence *sequence = nullptr;
+    PianoChangeGroup removals;
+    PianoChangeGroup groupBefore, groupAfter;
+};
+
+// only reads the sequence, so that the sequences can be quantized in parallel
+static void collectQuantizeChanges(QuantizedSequence &result, float bar)
+{
+    QuantizedNotes quantizedNotes;
+    for (int i = 0; i < result.sequence->size(); ++i)
+    {
+        const auto *note = static_cast<Note *>(result.sequence->getUnchecked(i));
+        doQuantize(*note, bar, quantizedNotes, result.removals, result.groupBefore, result.groupAfter);
     }
+}
 
-    if (groupBefore.isEmpty() && removals.isEmpty())
+static bool applyQuantizeChanges(QuantizedSequence &result, bool &didCheckpoint)
+{
+    if (result.groupBefore.isEmpty() && result.removals.isEmpty())
     {
         return false;
     }
 
-    if (shouldCheckpoint)
+    if (!didCheckpoint)
     {
-        sequence->checkpoint();
+        result.sequence->checkpoint();
+        didCheckpoint = true;
     }
 
-    if (!groupBefore.isEmpty())
+    if (!result.groupBefore.isEmpty())
     {
-        sequence->changeGroup(groupBefore, groupAfter, true);
+        result.sequence->changeGroup(result.groupBefore, result.groupAfter, true);
     }
 
-    if (!removals.isEmpty())
+    if (!result.removals.isEmpty())
     {
-        sequence->removeGroup(removals, true);
+        result.sequence->removeGroup(result.removals, true);
     }
 
-    sequence->changeGroup(groupBefore, groupAfter, true);
     return true;
 }
 
-bool SequencerOperations::quantize(WeakReference<MidiTrack> track,
-    float bar, bool shouldCheckpoint /*= true*/)
+bool SequencerOperations::quantize(const Lasso &selection, float bar, bool shouldCheckpoint /*= true*/)
 {
-    if (track->getSequence()->size() == 0)
+    if (selection.getNumSelected() == 0)
     {
         return false;
     }
 
-    auto *sequence = dynamic_cast<PianoSequence *>(track->getSequence());
-    if (sequence == nullptr)
-    {
-        return false;
-    }
+    QuantizedSequence result;
+    result.sequence = getPianoSequence(selection);
+    jassert(result.sequence);
 
-    
-    PianoChangeGroup removals;
-    PianoChangeGroup groupBefore, groupAfter;
-    for (int i = 0; i < sequence->size(); ++i)
+    QuantizedNotes quantizedNotes;
+    for (int i = 0; i < selection.getNumSelected(); ++i)
     {
-        auto *note = static_cast<Note *>(sequence->getUnchecked(i));
-        float startBeat = note->getBeat();
-        float length = note->getLength();
+        const auto *nc = selection.getItemAs<NoteComponent>(i);
+        doQuantize(nc->getNote(), bar, quantizedNotes, result.removals, result.groupBefore, result.groupAfter);
+    }
 
-        doQuantize(startBeat, length, bar);
+    bool didCheckpoint = !shouldCheckpoint;
+    return applyQuantizeChanges(result, didCheckpoint);
+}
 
-        if (startBeat == note->getBeat() && length == note->getLength())
-        {
-            continue;
-        }
+bool SequencerOperations::quantize(WeakReference<MidiTrack> track,
+    float bar, bool shouldCheckpoint /*= true*/)
+{
+    return SequencerOperations::quantize(Array<WeakReference<MidiTrack>>({ track }), bar, shouldCheckpoint);
+}
 
-        bool duplicateFound = false;
-        for (const auto &other : groupAfter)
+bool SequencerOperations::quantize(const Array<WeakReference<MidiTrack>> &tracks,
+    float bar, bool shouldCheckpoint /*= true*/)
+{
+    OwnedArray<QuantizedSequence> results;
+    for (const auto &track : tracks)
+    {
+        if (auto *sequence = dynamic_cast<PianoSequence *>(track->getSequence()))
         {
-            if (note->getKey() == other.getKey() &&
-                startBeat == other.getBeat() &&
-                length == other.getLength())
+            if (sequence->size() > 0)
             {
-                duplicateFound = true;
-                break;
+                results.add(new QuantizedSequence())->sequence = sequence;
             }
         }
-
-        if (duplicateFound)
-        {
-            removals.add(*note);
-            continue;
-        }
-
-        groupBefore.add(*note);
-        groupAfter.add(note->withBeat(startBeat).withLength(length));
-    }
-
-    if (groupBefore.isEmpty() && removals.isEmpty())
-    {
-        return false;
-    }
-
-    if (shouldCheckpoint)
-    {
-        sequence->checkpoint();
     }
 
-    if (!groupBefore.isEmpty())
+    // the changes are computed in parallel, since the sequences
+    // are not modified until all of them are done, and then applied
+    // on this thread under one checkpoint:
+    ParallelTasks::run(results.size(), [&results, bar](int i)
     {
-        sequence->changeGroup(groupBefore, groupAfter, true);
-    }
+        collectQuantizeChanges(*results.getUnchecked(i), bar);
+    });
 
-    if (!removals.isEmpty())
+    bool hasMadeChanges = false;
+    bool didCheckpoint = !shouldCheckpoint;
+    for (auto *result : results)
     {
-        sequence->removeGroup(removals, true);
+        hasMadeChanges = applyQuantizeChanges(*result, didCheckpoint) || hasMadeChanges;
     }
 
-    return true;
+    return hasMadeChanges;
 }
 
 int SequencerOperations::findAbsoluteRootKey(const Temperament::Ptr temperament,
@@ -1667,17 +1572,32 @@ int SequencerOperations::findAbsoluteRootKey(const Temperament::Ptr temperament,
     return absRootKey;
 }
 
+// maps each chromatic key within the period of scale A
+// to the chromatic offset of the same scale degree in scale B, or -1
+// if the key is not in scale A, so that rescaling doesn't need
+// to look up the scale keys for each note
+static Array<int> makeRescaleTable(Scale::Ptr scaleA, Scale::Ptr scaleB)
+{
+    Array<int> table;
+    table.ensureStorageAllocated(scaleA->getBasePeriod());
+    for (int key = 0; key < scaleA->getBasePeriod(); ++key)
+    {
+        const auto inScaleKey = scaleA->getScaleKey(key);
+        table.add(inScaleKey >= 0 ? scaleB->getChromaticKey(inScaleKey, 0, false) : -1);
+    }
+
+    return table;
+}
+
 static inline void doRescaleLogic(PianoChangeGroup &groupBefore, PianoChangeGroup &groupAfter,
-    const Note &note, Note::Key keyOffset, Scale::Ptr scaleA, Scale::Ptr scaleB)
+    const Note &note, Note::Key keyOffset, const Array<int> &rescaleTable, int periodA, int periodB)
 {
     const auto noteKey = note.getKey() - keyOffset;
-    const auto periodNumber = noteKey / scaleA->getBasePeriod();
-    const auto inScaleKey = scaleA->getScaleKey(noteKey);
-    if (inScaleKey >= 0)
+    const auto periodNumber = noteKey / periodA;
+    const auto newScaleKey = rescaleTable.getUnchecked(((noteKey % periodA) + periodA) % periodA);
+    if (newScaleKey >= 0)
     {
-        const auto newChromaticKey = scaleB->getBasePeriod() * periodNumber
-            + scaleB->getChromaticKey(inScaleKey, 0, false) + keyOffset;
-
+        const auto newChromaticKey = periodB * periodNumber + newScaleKey + keyOffset;
         groupBefore.add(note);
         groupAfter.add(note.withKey(newChromaticKey));
     }
@@ -1694,12 +1614,15 @@ void SequencerOperations::rescale(Lasso &selection, Note::Key rootKey,
     auto *sequence = getPianoSequence(selection);
     jassert(sequence);
 
+    const auto rescaleTable = makeRescaleTable(scaleA, scaleB);
+
     PianoChangeGroup groupBefore, groupAfter;
     for (int i = 0; i < selection.getNumSelected(); ++i)
     {
         const auto *nc = selection.getItemAs<NoteComponent>(i);
         // todo clip key offset?
-        doRescaleLogic(groupBefore, groupAfter, nc->getNote(), rootKey, scaleA, scaleB);
+        doRescaleLogic(groupBefore, groupAfter, nc->getNote(), rootKey,
+            rescaleTable, scaleA->getBasePeriod(), scaleB->getBasePeriod());
     }
 
     if (groupBefore.size() == 0)
@@ -1721,6 +1644,8 @@ bool SequencerOperations::rescale(const ProjectNode &project, float startBeat, f
     bool hasMadeChanges = false;
     bool didCheckpoint = !shouldCheckpoint;
 
+    const auto rescaleTable = makeRescaleTable(scaleA, scaleB);
+
     const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
     for (const auto *track : pianoTracks)
     {
@@ -1731,22 +1656,25 @@ bool SequencerOperations::rescale(const ProjectNode &project, float startBeat, f
         // find events in between (only consider events of one clip!),
         // skipping clips of the same track if already processed any other:
 
-        FlatHashSet<MidiEvent::Id> usedClips;
+        const Clip *usedClip = nullptr;
 
         for (int i = 0; i < sequence->size(); ++i)
         {
             const auto *note = static_cast<Note *>(sequence->getUnchecked(i));
             for (const auto *clip : track->getPattern()->getClips())
             {
-                if (usedClips.contains(clip->getId()) || usedClips.size() == 0)
+                if (usedClip != nullptr && usedClip != clip)
                 {
-                    if ((note->getBeat() + clip->getBeat()) >= startBeat &&
-                        (note->getBeat() + clip->getBeat()) < endBeat)
-                    {
-                        const auto keyOffset = rootKey - clip->getKey();
-                        doRescaleLogic(groupBefore, groupAfter, *note, keyOffset, scaleA, scaleB);
-                        usedClips.insert(clip->getId());
-                    }
+                    continue;
+                }
+
+                if ((note->getBeat() + clip->getBeat()) >= startBeat &&
+                    (note->getBeat() + clip->getBeat()) < endBeat)
+                {
+                    const auto keyOffset = rootKey - clip->getKey();
+                    doRescaleLogic(groupBefore, groupAfter, *note, keyOffset,
+                        rescaleTable, scaleA->getBasePeriod(), scaleB->getBasePeriod());
+                    usedClip = clip;
                 }
             }
         }
@@ -1769,6 +1697,29 @@ bool SequencerOperations::rescale(const ProjectNode &project, float startBeat, f
     return hasMadeChanges;
 }
 
+// maps each chromatic key within the period of the source temperament's
+// chromatic map to the nearest key of the target temperament's chromatic map,
+// so that remapping doesn't need to search the scale keys for each note
+static Array<int> makeTemperamentRemapTable(const Scale::Ptr chromaticMapFrom,
+    const Scale::Ptr chromaticMapTo, bool restrictToOneOctave)
+{
+    Array<int> table;
+    table.ensureStorageAllocated(chromaticMapFrom->getBasePeriod());
+    for (int key = 0; key < chromaticMapFrom->getBasePeriod(); ++key)
+    {
+        const auto keyIndexInChromaticMap = chromaticMapFrom->getNearestScaleKey(key);
+        table.add(chromaticMapTo->getChromaticKey(keyIndexInChromaticMap, 0, restrictToOneOctave));
+    }
+
+    return table;
+}
+
+static inline int remapKey(const Array<int> &remapTable, int key)
+{
+    const auto period = remapTable.size();
+    return remapTable.getUnchecked(((key % period) + period) % period);
+}
+
 bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
     Temperament::Ptr temperament, bool shouldCheckpoint)
 {
@@ -1789,42 +1740,27 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
     const auto periodSizeBefore = currentTemperament->getPeriodSize();
     const auto periodSizeAfter = temperament->getPeriodSize();
 
-    // a helper to find a key signature at certain beat
-    // works similarly to findHarmonicContext, but simpler:
-    auto *keySignatures = project.getTimeline()->getKeySignatures()->getSequence();
-    const auto findRootKey = [keySignatures](float beat)
-    {
-        if (keySignatures->size() == 0)
-        {
-            return 0;
-        }
+    // all the keys are mapped the same way, depending only on their position
+    // within the period, so the mapping is computed once for the temperaments pair:
+    const auto rootKeysTable = makeTemperamentRemapTable(chromaticMapFrom, chromaticMapTo, true);
+    const auto relativeKeysTable = makeTemperamentRemapTable(chromaticMapFrom, chromaticMapTo, false);
 
-        const KeySignatureEvent *context = nullptr;
+    // root keys before and after remapping for each key signature,
+    // the rest is similar to findHarmonicContext, but simpler:
+    const auto *keySignatures = static_cast<KeySignaturesSequence *>
+        (project.getTimeline()->getKeySignatures()->getSequence());
 
-        for (int i = 0; i < keySignatures->size(); ++i)
-        {
-            auto *ks = keySignatures->getUnchecked(i);
-            if (context == nullptr || ks->getBeat() <= beat)
-            {
-                // take the first one no matter where it resides;
-                // if event is still before the sequence beat, update the context anyway:
-                context = static_cast<KeySignatureEvent *>(ks);
-            }
-            else if (ks->getBeat() >= beat)
-            {
-                // no need to look further
-                break;
-            }
-        }
-
-        if (context != nullptr)
-        {
-            // we've found the only context that doesn't change within a sequence:
-            return context->getRootKey();
-        }
+    Array<int> rootKeysBefore, rootKeysAfter;
+    rootKeysBefore.ensureStorageAllocated(keySignatures->size());
+    rootKeysAfter.ensureStorageAllocated(keySignatures->size());
+    for (int i = 0; i < keySignatures->size(); ++i)
+    {
+        const auto rootKey = static_cast<KeySignatureEvent *>(keySignatures->getUnchecked(i))->getRootKey();
+        rootKeysBefore.add(rootKey);
+        rootKeysAfter.add(remapKey(rootKeysTable, rootKey));
+    }
 
-        return 0;
-    };
+    const auto defaultRootKeyAfter = remapKey(rootKeysTable, 0);
 
     const auto pianoTracks = project.findChildrenOfType<PianoTrackNode>();
     for (const auto *track : pianoTracks)
@@ -1835,21 +1771,23 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
         auto *sequence = static_cast<PianoSequence *>(track->getSequence());
 
         Array<Note> notesBefore, notesAfter;
+        notesBefore.ensureStorageAllocated(sequence->size());
+        notesAfter.ensureStorageAllocated(sequence->size());
+
         for (int n = 0; n < sequence->size(); ++n)
         {
             const auto *note = static_cast<Note *>(sequence->getUnchecked(n));
 
-            const auto rootKeyBefore = findRootKey(note->getBeat());
-            const auto rootIndexInChromaticMap = chromaticMapFrom->getNearestScaleKey(rootKeyBefore);
-            const auto rootKeyAfter = chromaticMapTo->getChromaticKey(rootIndexInChromaticMap, 0, true);
+            const auto keySignatureIndex = keySignatures->indexOfKeySignatureAt(note->getBeat());
+            const auto rootKeyBefore = keySignatureIndex < 0 ? 0 : rootKeysBefore.getUnchecked(keySignatureIndex);
+            const auto rootKeyAfter = keySignatureIndex < 0 ? defaultRootKeyAfter : rootKeysAfter.getUnchecked(keySignatureIndex);
 
             const auto key = note->getKey() - rootKeyBefore;
             const auto periodNum = key / periodSizeBefore;
             const auto relativeKey = key % periodSizeBefore;
 
             // now we need to round relative key to the nearest one in chromaticMapFrom 
-            const auto keyIndexInChromaticMap = chromaticMapFrom->getNearestScaleKey(relativeKey);
-            const auto newRelativeKey = chromaticMapTo->getChromaticKey(keyIndexInChromaticMap, rootKeyAfter, false);
+            const auto newRelativeKey = remapKey(relativeKeysTable, relativeKey) + rootKeyAfter;
             const auto newKey = periodNum * periodSizeAfter + newRelativeKey;
 
             notesBefore.add(*note);
@@ -1871,8 +1809,7 @@ bool SequencerOperations::remapNotesToTemperament(const ProjectNode &project,
             const auto relativeKey = key % periodSizeBefore;
             const auto keySign = (key > 0) - (key < 0); // key offset can be negative
 
-            const auto keyIndexInChromaticMap = chromaticMapFrom->getNearestScaleKey(relativeKey);
-            const auto newRelativeKey = chromaticMapTo->getChromaticKey(keyIndexInChromaticMap, 0, false);
+            const auto newRelativeKey = remapKey(relativeKeysTable, relativeKey);
             const auto newKey = periodNum * periodSizeAfter + newRelativeKey * keySign;
 
             clipsBefore.add(*clip);
@@ -1915,6 +1852,14 @@ bool SequencerOperations::remapKeySignaturesToTemperament(KeySignaturesSequence
     bool hasMadeChanges = false;
     bool didCheckpoint = !shouldCheckpoint;
 
+    const auto keysTable = makeTemperamentRemapTable(currentTemperament->getChromaticMap(),
+        otherTemperament->getChromaticMap(), true);
+
+    // most of the key signatures in a project share a few scales,
+    // so each scale is converted and matched only once:
+    FlatHashMap<const Scale *, Scale::Ptr> remappedScales;
+    Array<KeySignatureEvent> signaturesBefore, signaturesAfter;
+
     for (int i = 0; i < keySignatures->size(); ++i)
     {
         // this will map the root key using temperaments' chromatic maps,
@@ -1925,54 +1870,60 @@ bool SequencerOperations::remapKeySignaturesToTemperament(KeySignaturesSequence
 
         auto originalScale = signature->getScale();
 
-        Array<int> newKeys;
-        for (const auto &k : originalScale->getKeys())
-        {
-            const auto keyIndexInChromaticMap = currentTemperament->
-                getChromaticMap()->getNearestScaleKey(k);
-
-            const auto newKey = otherTemperament->getChromaticMap()->
-                getChromaticKey(keyIndexInChromaticMap, 0, true);
-
-            newKeys.add(newKey);
-        }
-
-        // this will be the default one, if the equivalent is not found:
-        Scale::Ptr convertedScale(new Scale(originalScale->getUnlocalizedName(),
-            newKeys, otherTemperament->getPeriodSize()));
-
-        // but let's search for the most similar scale (if there are any):
-        Scale::Ptr similarScale = nullptr;
-        int minDifference = INT_MAX;
-        for (const auto s : availableScales)
+        auto remappedScale = remappedScales.find(originalScale.get());
+        if (remappedScale == remappedScales.end())
         {
-            if (s->getBasePeriod() != otherTemperament->getPeriodSize())
+            Array<int> newKeys;
+            for (const auto &k : originalScale->getKeys())
             {
-                continue;
+                newKeys.add(remapKey(keysTable, k));
             }
 
-            const auto diff = s->getDifferenceFrom(convertedScale);
-            if (diff < minDifference)
+            // this will be the default one, if the equivalent is not found:
+            Scale::Ptr convertedScale(new Scale(originalScale->getUnlocalizedName(),
+                newKeys, otherTemperament->getPeriodSize()));
+
+            // but let's search for the most similar scale (if there are any):
+            Scale::Ptr similarScale = nullptr;
+            int minDifference = INT_MAX;
+            for (const auto s : availableScales)
             {
-                minDifference = diff;
-                similarScale = s;
+                if (s->getBasePeriod() != otherTemperament->getPeriodSize())
+                {
+                    continue;
+                }
+
+                const auto diff = s->getDifferenceFrom(convertedScale);
+                if (diff < minDifference)
+                {
+                    minDifference = diff;
+                    similarScale = s;
+                }
             }
+
+            remappedScale = remappedScales.emplace(originalScale.get(),
+                similarScale != nullptr ? similarScale : convertedScale).first;
         }
 
-        const auto rootIndexInChromaticMap = currentTemperament->
-            getChromaticMap()->getNearestScaleKey(signature->getRootKey());
+        const auto newRootKey = remapKey(keysTable, signature->getRootKey());
 
-        const auto newRootKey = otherTemperament->getChromaticMap()->
-            getChromaticKey(rootIndexInChromaticMap, 0, true);
+        signaturesBefore.add(*signature);
+        signaturesAfter.add(signature->withRootKey(newRootKey)
+            .withScale(remappedScale->second));
+    }
 
+    // the changes are applied after all the scales are matched,
+    // so that the original scales are alive while they're used as cache keys
+    for (int i = 0; i < signaturesBefore.size(); ++i)
+    {
         if (!didCheckpoint)
         {
             keySignatures->checkpoint();
             didCheckpoint = true;
         }
 
-        keySignatures->change(*signature, signature->withRootKey(newRootKey)
-            .withScale(similarScale != nullptr ? similarScale : convertedScale), true);
+        keySignatures->change(signaturesBefore.getReference(i),
+            signaturesAfter.getReference(i), true);
 
         hasMadeChanges = true;
     }
@@ -1992,27 +1943,15 @@ bool SequencerOperations::findHarmonicContext(float startBeat, float endBeat,
             return false;
         }
 
-        const KeySignatureEvent *context = nullptr;
+        // Take the last one before the sequence start, or the first one no matter where it resides:
+        const auto contextIndex = keySignatures->indexOfKeySignatureAt(startBeat);
+        const auto *context = static_cast<KeySignatureEvent *>(keySignatures->getUnchecked(contextIndex));
 
-        for (int i = 0; i < keySignatures->size(); ++i)
+        // Harmonic context is already here and changes within a sequence:
+        if (contextIndex + 1 < keySignatures->size() &&
+            keySignatures->getUnchecked(contextIndex + 1)->getBeat() < endBeat)
         {
-            const auto event = keySignatures->getUnchecked(i);
-            if (context == nullptr || event->getBeat() <= startBeat)
-            {
-                // Take the first one no matter where it resides;
-                // If event is still before the sequence start, update the context anyway:
-                context = static_cast<KeySignatureEvent *>(event);
-            }
-            else if (event->getBeat() > startBeat && event->getBeat() < endBeat)
-            {
-                // Harmonic context is already here and changes within a sequence:
-                return false;
-            }
-            else if (event->getBeat() >= endBeat)
-            {
-                // No need to look further
-                break;
-            }
+            return false;
         }
 
         if (context != nullptr)
@@ -2101,23 +2040,17 @@ Clip &SequencerOperations::findClosestClip(Lasso &selection, WeakReference<MidiT
     const auto selectionStart = selectionFirstBeat + sourceClip.getBeat();
     const auto selectionEnd = selectionLastBeat + sourceClip.getBeat() + 1.f;
 
-    auto *result = track->getPattern()->getClips().getFirst();
     auto *targetSequence = static_cast<PianoSequence *>(track->getSequence());
 
-    outMinDistance = FLT_MAX;
-    for (auto *clip : track->getPattern()->getClips())
-    {
-        const auto targetStart = targetSequence->getFirstBeat() + clip->getBeat();
-        const auto targetEnd = targetSequence->getLastBeat() + clip->getBeat();
-        const float distance = fabs(targetStart - selectionStart + targetEnd - selectionEnd);
+    // the distance is |2 * clipBeat - (selection start + end - sequence start - end)|,
+    // so it's minimal for the clip closest to the half of that:
+    const auto sequenceMidBeatX2 = targetSequence->getFirstBeat() + targetSequence->getLastBeat();
+    const auto targetClipBeat = (selectionStart + selectionEnd - sequenceMidBeatX2) / 2.f;
 
-        if (outMinDistance > distance)
-        {
-            outMinDistance = distance;
-            result = clip;
-        }
-    }
+    auto *result = track->getPattern()->findClosestClip(targetClipBeat);
+    jassert(result != nullptr);
 
+    outMinDistance = fabs(sequenceMidBeatX2 + result->getBeat() * 2.f - selectionStart - selectionEnd);
     return *result;
 }
 
@@ -2652,6 +2585,99 @@ public:
 
         expectEquals({ "Duplicate 2" },
             SequencerOperations::generateNextNameForNewTrack("Duplicate", { "Duplicate", "Duplicate", "Track A", "Recording" }));
+
+        beginTest("Cleanup contained overlaps");
+        {
+            // a long note containing a shorter one is cut where the shorter one starts,
+            // and the shorter one is extended till the end of the long one
+            Array<Note> notes;
+            notes.add(makeNote(1, 60, 0.f, 8.f));
+            notes.add(makeNote(2, 60, 2.f, 1.f));
+
+            PianoChangeGroup before, after, removed;
+            findNoteOverlapsCleanup(notes, before, after, removed);
+
+            expectEquals(removed.size(), 0);
+            expectEquals(after.size(), 2);
+            expectNote(after, 1, 0.f, 2.f);
+            expectNote(after, 2, 2.f, 6.f);
+        }
+
+        beginTest("Cleanup chained overlaps");
+        {
+            // each note lasts until the next one starts,
+            // and the last one is left as is
+            Array<Note> notes;
+            notes.add(makeNote(3, 60, 2.f, 4.f));
+            notes.add(makeNote(1, 60, 0.f, 3.f));
+            notes.add(makeNote(2, 60, 1.f, 3.f));
+            // another key, not overlapping anything
+            notes.add(makeNote(4, 62, 1.f, 1.f));
+
+            PianoChangeGroup before, after, removed;
+            findNoteOverlapsCleanup(notes, before, after, removed);
+
+            expectEquals(removed.size(), 0);
+            expectEquals(before.size(), 2);
+            expectEquals(after.size(), 2);
+            expectNote(after, 1, 0.f, 1.f);
+            expectNote(after, 2, 1.f, 1.f);
+            expectNote(before, 1, 0.f, 3.f);
+        }
+
+        beginTest("Cleanup same beat overlaps");
+        {
+            // only the longest of the notes starting at the same beat is kept
+            Array<Note> notes;
+            notes.add(makeNote(1, 60, 0.f, 1.f));
+            notes.add(makeNote(2, 60, 0.f, 4.f));
+            notes.add(makeNote(3, 60, 0.f, 4.f));
+
+            PianoChangeGroup before, after, removed;
+            findNoteOverlapsCleanup(notes, before, after, removed);
+
+            expectEquals(after.size(), 0);
+            expectEquals(removed.size(), 2);
+            expectEquals(int(removed[0].getId()), 3);
+            expectEquals(int(removed[1].getId()), 1);
+        }
+
+        beginTest("Cleanup no overlaps");
+        {
+            Array<Note> notes;
+            notes.add(makeNote(1, 60, 0.f, 1.f));
+            notes.add(makeNote(2, 60, 1.f, 1.f));
+            notes.add(makeNote(3, 61, 0.f, 2.f));
+
+            PianoChangeGroup before, after, removed;
+            findNoteOverlapsCleanup(notes, before, after, removed);
+
+            expectEquals(before.size(), 0);
+            expectEquals(after.size(), 0);
+            expectEquals(removed.size(), 0);
+        }
+    }
+
+private:
+
+    static Note makeNote(Note::Id id, Note::Key key, float beat, float length)
+    {
+        return Note(Note::Compact{ id, beat, length, 1.f, key, 0 });
+    }
+
+    void expectNote(const PianoChangeGroup &group, Note::Id id, float beat, float length)
+    {
+        for (const auto &note : group)
+        {
+            if (note.getId() == id)
+            {
+                expectEquals(note.getBeat(), beat);
+                expectEquals(note.getLength(), length);
+                return;
+            }
+        }
+
+        expect(false, "note " + String(id) + " is missing");
     }
 };
 
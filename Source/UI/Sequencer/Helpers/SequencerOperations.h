@@ -99,6 +99,7 @@ struct SequencerOperations final
     static void applyTuplets(Lasso &selection, Note::Tuplet tuplet, bool shouldCheckpoint = true);
     static bool quantize(const Lasso &selection, float bar, bool shouldCheckpoint = true);
     static bool quantize(WeakReference<MidiTrack> track, float bar, bool shouldCheckpoint = true);
+    static bool quantize(const Array<WeakReference<MidiTrack>> &tracks, float bar, bool shouldCheckpoint = true);
 
     static int findAbsoluteRootKey(const Temperament::Ptr temperament,
         Note::Key relativeRoot, Note::Key keyToFindPeriodFor);
@@ -19,50 +19,187 @@
 #include "Lasso.h"
 
 Lasso::Lasso() :
-    SelectedItemSet(),
     random(Time::currentTimeMillis())
 {
     this->resetSelectionId();
 }
 
-Lasso::Lasso(const ItemArray &items) :
-    SelectedItemSet(items),
-    random(Time::currentTimeMillis())
+bool Lasso::isSelected(SelectableComponent *item) const noexcept
 {
-    this->resetSelectionId();
+    return this->indices.find(item) != this->indices.end();
 }
 
-Lasso::Lasso(const SelectedItemSet &other) :
-    SelectedItemSet(other),
-    random(Time::currentTimeMillis())
+int Lasso::getNumSelected() const noexcept
 {
-    this->resetSelectionId();
+    return this->items.size();
 }
 
-void Lasso::itemSelected(SelectableComponent *item)
+SelectableComponent *Lasso::getSelectedItem(int index) const noexcept
 {
-    this->resetSelectionId();
-    item->setSelected(true);
+    return this->items[index];
 }
 
-void Lasso::itemDeselected(SelectableComponent *item)
+const Lasso::ItemArray &Lasso::getItemArray() const noexcept
 {
-    this->resetSelectionId();
-    item->setSelected(false);
+    return this->items;
 }
 
-void Lasso::needsToCalculateSelectionBounds() noexcept
+void Lasso::addToSelection(SelectableComponent *item)
+{
+    if (this->addItem(item))
+    {
+        this->onSelectionChanged();
+    }
+}
+
+void Lasso::deselect(SelectableComponent *item)
+{
+    if (this->removeItem(item))
+    {
+        this->onSelectionChanged();
+    }
+}
+
+void Lasso::selectAll(const ItemArray &newItems)
+{
+    this->indices.reserve(this->items.size() + newItems.size());
+    this->items.ensureStorageAllocated(this->items.size() + newItems.size());
+
+    bool hasChanged = false;
+    for (auto *item : newItems)
+    {
+        hasChanged = this->addItem(item) || hasChanged;
+    }
+
+    if (hasChanged)
+    {
+        this->onSelectionChanged();
+    }
+}
+
+void Lasso::deselectAll()
+{
+    if (this->items.isEmpty())
+    {
+        return;
+    }
+
+    for (auto *item : this->items)
+    {
+        item->setSelected(false);
+    }
+
+    this->items.clearQuick();
+    this->indices.clear();
+    this->bounds = {};
+    this->boundsOutdated = false;
+    this->onSelectionChanged();
+}
+
+void Lasso::setSelection(const ItemArray &newItems)
+{
+    FlatHashSet<SelectableComponent *> newItemsSet;
+    newItemsSet.reserve(newItems.size());
+    for (auto *item : newItems)
+    {
+        newItemsSet.insert(item);
+    }
+
+    bool hasChanged = false;
+    for (int i = this->items.size(); --i >= 0;)
+    {
+        auto *item = this->items.getUnchecked(i);
+        if (newItemsSet.find(item) == newItemsSet.end())
+        {
+            hasChanged = this->removeItem(item) || hasChanged;
+        }
+    }
+
+    for (auto *item : newItems)
+    {
+        hasChanged = this->addItem(item) || hasChanged;
+    }
+
+    if (hasChanged)
+    {
+        this->onSelectionChanged();
+    }
+}
+
+bool Lasso::addItem(SelectableComponent *item)
 {
-    this->bounds = Rectangle<int>();
+    jassert(item != nullptr);
+    if (!this->indices.emplace(item, this->items.size()).second)
+    {
+        return false;
+    }
+
+    this->items.add(item);
+    item->setSelected(true);
 
-    for (int i = 0; i < this->getNumSelected(); ++i)
+    if (!this->boundsOutdated)
     {
-        this->bounds = this->bounds.getUnion(this->getSelectedItem(i)->getBounds());
+        this->bounds = this->bounds.getUnion(item->getBounds());
     }
+
+    return true;
+}
+
+bool Lasso::removeItem(SelectableComponent *item)
+{
+    const auto found = this->indices.find(item);
+    if (found == this->indices.end())
+    {
+        return false;
+    }
+
+    // the last item takes the removed one's place
+    const auto index = found->second;
+    this->indices.erase(found);
+    auto *lastItem = this->items.removeAndReturn(this->items.size() - 1);
+    if (lastItem != item)
+    {
+        this->items.setUnchecked(index, lastItem);
+        this->indices[lastItem] = index;
+    }
+
+    item->setSelected(false);
+
+    // the bounds only shrink if the item was touching their edges
+    const auto itemBounds = item->getBounds();
+    if (!this->boundsOutdated &&
+        !this->bounds.reduced(1).contains(itemBounds))
+    {
+        this->boundsOutdated = true;
+    }
+
+    return true;
+}
+
+void Lasso::onSelectionChanged()
+{
+    this->resetSelectionId();
+    this->sendChangeMessage();
+}
+
+void Lasso::needsToCalculateSelectionBounds() noexcept
+{
+    this->boundsOutdated = true;
 }
 
 Rectangle<int> Lasso::getSelectionBounds() const noexcept
 {
+    if (this->boundsOutdated)
+    {
+        this->bounds = {};
+        for (const auto *item : this->items)
+        {
+            this->bounds = this->bounds.getUnion(item->getBounds());
+        }
+
+        this->boundsOutdated = false;
+    }
+
     return this->bounds;
 }
 
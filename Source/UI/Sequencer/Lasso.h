@@ -21,19 +21,38 @@
 #include "MidiSequence.h"
 #include "UndoActionIDs.h"
 
-class Lasso final : public SelectedItemSet<SelectableComponent *>
+// The selection of the roll's components: the items are kept in an array,
+// indexed by a hash map, so that checking and changing the selection of any
+// item is O(1), which matters for the rolls with tens of thousands of notes;
+// the bulk operations only send one change message and regenerate the id once
+class Lasso final : public ChangeBroadcaster
 {
 public:
 
+    using ItemArray = Array<SelectableComponent *>;
+
     Lasso();
-    explicit Lasso(const ItemArray &items);
-    explicit Lasso(const SelectedItemSet &other);
 
-    void itemSelected(SelectableComponent *item) override;
-    void itemDeselected(SelectableComponent *item) override;
+    bool isSelected(SelectableComponent *item) const noexcept;
+    int getNumSelected() const noexcept;
+    SelectableComponent *getSelectedItem(int index) const noexcept;
+    const ItemArray &getItemArray() const noexcept;
+
+    void addToSelection(SelectableComponent *item);
+    // note that deselecting changes the order of the selected items
+    void deselect(SelectableComponent *item);
+
+    void selectAll(const ItemArray &items);
+    void deselectAll();
+
+    // deselects everything not in the items, and selects the rest
+    void setSelection(const ItemArray &items);
 
     int64 getId() const noexcept;
     bool shouldDisplayGhostNotes() const noexcept;
+
+    // the bounds are extended as the items are selected, and recalculated
+    // lazily after the items bounds might have changed, e.g. after dragging
     void needsToCalculateSelectionBounds() noexcept;
     Rectangle<int> getSelectionBounds() const noexcept;
 
@@ -80,7 +99,16 @@ public:
 
 private:
 
-    Rectangle<int> bounds;
+    ItemArray items;
+    FlatHashMap<SelectableComponent *, int> indices;
+
+    // these two return false if nothing has changed
+    bool addItem(SelectableComponent *item);
+    bool removeItem(SelectableComponent *item);
+    void onSelectionChanged();
+
+    mutable Rectangle<int> bounds;
+    mutable bool boundsOutdated = false;
     
     // A random id which is used to distinguish one selection from another
     // (collisions are still possible, but they are not critical,
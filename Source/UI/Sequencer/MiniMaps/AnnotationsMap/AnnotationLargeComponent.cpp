@@ -42,23 +42,26 @@ void AnnotationLargeComponent::paint(Graphics &g)
 
     g.fillRect(1.f, 0.f, float(this->getWidth() - 1), 3.f);
 
-    if (this->event.getDescription().isNotEmpty())
+    if (this->text.isNotEmpty())
     {
-        const Font labelFont(16.f, Font::plain);
         g.setColour(this->event.getColour().interpolatedWith(baseColour, 0.55f).withAlpha(0.9f));
 
-        GlyphArrangement arr;
-        arr.addFittedText(labelFont,
-            this->event.getDescription(),
-            2.f + this->boundsOffset.getX(),
-            0.f,
-            float(this->getWidth()) - 16.f,
-            float(this->getHeight()) - 8.f,
-            Justification::centredLeft,
-            1,
-            0.85f);
-
-        arr.draw(g);
+        // the text is only laid out again when the description or the size
+        // has changed, and not each time the component is scrolled or repainted
+        const Rectangle<float> textArea(2.f + this->boundsOffset.getX(), 0.f,
+            float(this->getWidth()) - 16.f, float(this->getHeight()) - 8.f);
+
+        if (this->textGlyphsArea != textArea)
+        {
+            this->textGlyphsArea = textArea;
+            this->textGlyphs.clear();
+            this->textGlyphs.addFittedText(this->font, this->text,
+                textArea.getX(), textArea.getY(),
+                textArea.getWidth(), textArea.getHeight(),
+                Justification::centredLeft, 1, 0.85f);
+        }
+
+        this->textGlyphs.draw(g);
     }
 }
 
@@ -201,6 +204,7 @@ void AnnotationLargeComponent::updateContent()
     {
         this->text = this->event.getDescription();
         this->textWidth = float(this->font.getStringWidth(this->event.getDescription()));
+        this->textGlyphsArea = {};
     }
 
     this->repaint();
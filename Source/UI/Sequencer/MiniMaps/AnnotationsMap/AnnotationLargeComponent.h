@@ -61,6 +61,9 @@ private:
     String text;
     float textWidth = 0.f;
 
+    GlyphArrangement textGlyphs;
+    Rectangle<float> textGlyphsArea;
+
     // workaround странного поведения juce
     // возможна ситуация, когда mousedown'а не было, а mouseup срабатывает
     bool mouseDownWasTriggered = false;
@@ -29,164 +29,6 @@
 #include "NoteComponent.h"
 #include "FineTuningValueIndicator.h"
 
-#define VELOCITY_MAP_BULK_REPAINT_START \
-    if (this->isEnabled()) { this->setVisible(false); }
-
-#define VELOCITY_MAP_BULK_REPAINT_END \
-    if (this->isEnabled()) { this->setVisible(true); }
-
-//===----------------------------------------------------------------------===//
-// Child level component
-//===----------------------------------------------------------------------===//
-
-class VelocityMapNoteComponent final : public Component
-{
-public:
-
-    VelocityMapNoteComponent(const Note &note, const Clip &clip) :
-        note(note),
-        clip(clip)
-    {
-        this->updateColour();
-        this->setInterceptsMouseClicks(true, false);
-        this->setMouseClickGrabsKeyboardFocus(false);
-        this->setPaintingIsUnclipped(true);
-        this->setMouseCursor(MouseCursor::UpDownResizeCursor);
-    }
-
-    inline float getBeat() const noexcept
-    {
-        return this->note.getBeat() + this->clip.getBeat();
-    }
-
-    inline float getLength() const noexcept
-    {
-        return this->note.getLength();
-    }
-
-    inline float getVelocity() const noexcept
-    {
-        return this->note.getVelocity() * this->clip.getVelocity();
-    }
-
-    Line<float> getStartLine() const noexcept
-    {
-        const float x = this->getX() + this->dx;
-        return { x, 0.f, x, float(Globals::UI::levelsMapHeight) };
-    }
-
-    Line<float> getEndLine() const noexcept
-    {
-        const float x = this->getX() + this->dx + this->getWidth() + this->dw;
-        return { x, 0.f, x, float(Globals::UI::levelsMapHeight) };
-    }
-
-    inline void updateColour()
-    {
-        const Colour baseColour(findDefaultColour(ColourIDs::Roll::noteFill));
-        this->mainColour = this->note.getTrackColour()
-            .interpolatedWith(baseColour, this->editable ? 0.35f : 0.5f)
-            .withAlpha(this->editable ? 0.75f : 0.065f);
-        this->paleColour = this->mainColour
-            .brighter(0.1f)
-            .withMultipliedAlpha(0.1f);
-    }
-
-    void setRealBounds(float x, int y, float w, int h) noexcept
-    {
-        this->dx = x - floorf(x);
-        this->dw = w - ceilf(w);
-        this->setBounds(int(floorf(x)), y, int(ceilf(w)), h);
-    }
-
-    bool isEditable() const noexcept
-    {
-        return this->editable;
-    }
-
-    void setEditable(bool editable)
-    {
-        if (this->editable == editable)
-        {
-            return;
-        }
-
-        this->editable = editable;
-
-        this->setEnabled(editable);
-        this->updateColour();
-
-        if (this->editable)
-        {
-            // toBack() and toFront() use indexOf(this) so calling them sucks
-            this->toFront(false);
-        }
-    }
-
-    //===------------------------------------------------------------------===//
-    // Component
-    //===------------------------------------------------------------------===//
-
-    void paint(Graphics &g) noexcept override
-    {
-        g.setColour(this->mainColour);
-        g.fillRect(this->dx, 1.f, 1.f, float(this->getHeight() - 1));
-        g.fillRect(this->dx + 1.f, 0.f, float(this->getWidth() - 2) + this->dw, 1.f);
-        g.fillRect(this->dx, 1.f, float(this->getWidth()) + this->dw, 2.f);
-
-        g.setColour(this->paleColour);
-        g.fillRect(this->dx, 0.f, float(this->getWidth()) + this->dw, float(this->getHeight()));
-    }
-
-    bool hitTest(int, int y) noexcept override
-    {
-        constexpr auto dragAreaSize = 5;
-        return this->editable && y <= dragAreaSize;
-    }
-
-    void mouseDown(const MouseEvent &e) override
-    {
-        if (e.mods.isLeftButtonDown())
-        {
-            this->note.getSequence()->checkpoint();
-            this->velocityAnchor = this->getVelocity();
-        }
-    }
-
-    void mouseDrag(const MouseEvent &e) override
-    {
-        const auto newVelocity = jlimit(0.f, 1.f, this->velocityAnchor -
-            float(e.getDistanceFromDragStartY()) / float(Globals::UI::levelsMapHeight));
-
-        static_cast<PianoSequence *>(this->note.getSequence())->
-            change(this->note, this->note.withVelocity(newVelocity), true);
-    }
-
-private:
-
-    friend class VelocityProjectMap;
-
-    VelocityProjectMap *getParentMap() const
-    {
-        jassert(this->getParentComponent());
-        return static_cast<VelocityProjectMap *>(this->getParentComponent());
-    }
-
-    const Note &note;
-    const Clip &clip;
-
-    Colour mainColour;
-    Colour paleColour;
-
-    float dx = 0.f;
-    float dw = 0.f;
-
-    float velocityAnchor = 0.f;
-    bool editable = true;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VelocityMapNoteComponent)
-};
-
 //===----------------------------------------------------------------------===//
 // Dragging helper
 //===----------------------------------------------------------------------===//
@@ -325,8 +167,6 @@ VelocityProjectMap::VelocityProjectMap(ProjectNode &parentProject, RollBase &par
     this->volumeBlendingIndicator->setSize(40, 40);
     this->addChildComponent(this->volumeBlendingIndicator.get());
 
-    this->reloadTrackMap();
-
     this->project.addListener(this);
     this->roll.getLassoSelection().addChangeListener(this);
 }
@@ -343,38 +183,126 @@ VelocityProjectMap::~VelocityProjectMap()
 
 void VelocityProjectMap::resized()
 {
-    VELOCITY_MAP_BULK_REPAINT_START
+    if (this->dragHelper != nullptr)
+    {
+        this->dragHelper->updateBounds();
+    }
 
-    for (const auto &c : this->patternMap)
+    this->repaint();
+}
+
+void VelocityProjectMap::paint(Graphics &g)
+{
+    const auto paintArea = g.getClipBounds().toFloat();
+    const auto paintStartBeat = this->getBeatByX(paintArea.getX() - 1.f);
+    const auto paintEndBeat = this->getBeatByX(paintArea.getRight() + 1.f);
+
+    const auto *activeTrack = this->activeClip.getPattern() != nullptr ?
+        this->activeClip.getPattern()->getTrack() : nullptr;
+
+    // the editable bars go on top of all others
+    for (const auto *track : this->project.getTracks())
     {
-        const auto sequenceMap = c.second.get();
-        for (const auto &e : *sequenceMap)
+        if (track->getPattern() == nullptr ||
+            dynamic_cast<const PianoSequence *>(track->getSequence()) == nullptr)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < track->getPattern()->size(); ++i)
         {
-            jassert(e.second.get());
-            this->applyNoteBounds(e.second.get());
+            const auto &clip = *track->getPattern()->getUnchecked(i);
+            this->paintBars(g, track, clip, false, paintStartBeat, paintEndBeat);
         }
     }
 
-    if (this->dragHelper != nullptr)
+    if (activeTrack != nullptr)
     {
-        this->dragHelper->updateBounds();
+        this->paintBars(g, activeTrack, this->activeClip, true, paintStartBeat, paintEndBeat);
+    }
+}
+
+void VelocityProjectMap::paintBars(Graphics &g, const MidiTrack *track,
+    const Clip &clip, bool editable, float paintStartBeat, float paintEndBeat)
+{
+    const auto *sequence = static_cast<const PianoSequence *>(track->getSequence());
+    const auto notes = sequence->getPackedNotes();
+
+    const auto startBeat = paintStartBeat - clip.getBeat();
+    const auto endBeat = paintEndBeat - clip.getBeat();
+
+    this->barsBatch.clear();
+    this->barsBackgroundBatch.clear();
+
+    const auto end = notes->indexOfFirstStartingFrom(endBeat);
+    for (int i = notes->indexOfFirstEndingAfter(startBeat); i < end; ++i)
+    {
+        const auto length = notes->lengths.getUnchecked(i);
+        const auto beat = notes->beats.getUnchecked(i);
+        if (beat + length < startBeat ||
+            this->isEditable(clip, notes->ids.getUnchecked(i)) != editable)
+        {
+            continue;
+        }
+
+        const auto bar = this->getBarBounds(beat + clip.getBeat(), length,
+            notes->velocities.getUnchecked(i) * clip.getVelocity());
+
+        const auto x = bar.getX();
+        const auto y = bar.getY();
+        const auto w = bar.getWidth();
+
+        this->barsBatch.addWithoutMerging({ x, y + 1.f, 1.f, bar.getHeight() - 1.f });
+        this->barsBatch.addWithoutMerging({ x + 1.f, y, w - 2.f, 1.f });
+        this->barsBatch.addWithoutMerging({ x, y + 1.f, w, 2.f });
+        this->barsBackgroundBatch.addWithoutMerging(bar);
+    }
+
+    if (this->barsBackgroundBatch.isEmpty())
+    {
+        return;
     }
 
-    VELOCITY_MAP_BULK_REPAINT_END
+    const Colour baseColour(findDefaultColour(ColourIDs::Roll::noteFill));
+    const auto mainColour = track->getTrackColour()
+        .interpolatedWith(baseColour, editable ? 0.35f : 0.5f)
+        .withAlpha(editable ? 0.75f : 0.065f);
+
+    g.setColour(mainColour);
+    g.fillRectList(this->barsBatch);
+
+    g.setColour(mainColour.brighter(0.1f).withMultipliedAlpha(0.1f));
+    g.fillRectList(this->barsBackgroundBatch);
+}
+
+void VelocityProjectMap::mouseMove(const MouseEvent &e)
+{
+    this->setMouseCursor(this->findEditableBarAt(e.position) != nullptr ?
+        MouseCursor::UpDownResizeCursor : MouseCursor::NormalCursor);
 }
 
 void VelocityProjectMap::mouseDown(const MouseEvent &e)
 {
-    if (e.mods.isLeftButtonDown())
+    if (!e.mods.isLeftButtonDown())
     {
-        this->volumeBlendingIndicator->toFront(false);
-        this->updateVolumeBlendingIndicator(e.getPosition());
+        return;
+    }
 
-        this->dragHelper = make<VelocityLevelDraggingHelper>(*this);
-        this->addAndMakeVisible(this->dragHelper.get());
-        this->dragHelper->setStartPosition(e.position);
-        this->dragHelper->setEndPosition(e.position);
+    this->draggedNote = this->findEditableBarAt(e.position);
+    if (this->draggedNote != nullptr)
+    {
+        this->draggedNote->getSequence()->checkpoint();
+        this->draggedNoteAnchor = this->draggedNote->getVelocity() * this->activeClip.getVelocity();
+        return;
     }
+
+    this->volumeBlendingIndicator->toFront(false);
+    this->updateVolumeBlendingIndicator(e.getPosition());
+
+    this->dragHelper = make<VelocityLevelDraggingHelper>(*this);
+    this->addAndMakeVisible(this->dragHelper.get());
+    this->dragHelper->setStartPosition(e.position);
+    this->dragHelper->setEndPosition(e.position);
 }
 
 constexpr float getVelocityByIntersection(const Point<float> &intersection)
@@ -384,7 +312,16 @@ constexpr float getVelocityByIntersection(const Point<float> &intersection)
 
 void VelocityProjectMap::mouseDrag(const MouseEvent &e)
 {
-    if (this->dragHelper != nullptr)
+    if (this->draggedNote != nullptr)
+    {
+        const auto newVelocity = jlimit(0.f, 1.f, this->draggedNoteAnchor -
+            float(e.getDistanceFromDragStartY()) / float(Globals::UI::levelsMapHeight));
+
+        const auto &note = *this->draggedNote;
+        static_cast<PianoSequence *>(note.getSequence())->
+            change(note, note.withVelocity(newVelocity), true);
+    }
+    else if (this->dragHelper != nullptr)
     {
         this->updateVolumeBlendingIndicator(e.getPosition());
         this->dragHelper->setEndPosition(e.position);
@@ -395,11 +332,14 @@ void VelocityProjectMap::mouseDrag(const MouseEvent &e)
 
 void VelocityProjectMap::mouseUp(const MouseEvent &e)
 {
+    this->draggedNote = nullptr;
+
     if (this->dragHelper != nullptr)
     {
         this->volumeBlendingIndicator->setVisible(false);
         this->dragHelper = nullptr;
-        this->dragIntersections.clear();
+        this->dragGroup.clearQuick();
+        this->dragGroupVelocities.clearQuick();
         this->dragChangedNotes.clearQuick();
         this->dragChanges.clearQuick();
         this->dragHasChanges = false;
@@ -427,28 +367,12 @@ void VelocityProjectMap::mouseWheelMove(const MouseEvent &e, const MouseWheelDet
 // ProjectListener
 //===----------------------------------------------------------------------===//
 
-#define forEachSequenceMapOfGivenTrack(map, child, track) \
-    for (const auto &child : map) \
-        if (child.first.getPattern()->getTrack() == track)
-
 void VelocityProjectMap::onChangeMidiEvent(const MidiEvent &e1, const MidiEvent &e2)
 {
     if (e1.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(e1);
-        const Note &newNote = static_cast<const Note &>(e2);
-        const auto *track = newNote.getSequence()->getTrack();
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-        {
-            auto &sequenceMap = *c.second.get();
-            if (auto *component = sequenceMap[note].release())
-            {
-                sequenceMap.erase(note);
-                sequenceMap[newNote] = UniquePointer<VelocityMapNoteComponent>(component);
-                this->triggerBatchRepaintFor(component);
-            }
-        }
+        this->repaintBarsOf(static_cast<const Note &>(e1));
+        this->repaintBarsOf(static_cast<const Note &>(e2));
     }
 }
 
@@ -456,28 +380,7 @@ void VelocityProjectMap::onAddMidiEvent(const MidiEvent &event)
 {
     if (event.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(event);
-        const auto *track = note.getSequence()->getTrack();
-
-        VELOCITY_MAP_BULK_REPAINT_START
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-        {
-            auto &componentsMap = *c.second.get();
-            const int i = track->getPattern()->indexOfSorted(&c.first);
-            jassert(i >= 0);
-
-            const auto *clip = track->getPattern()->getUnchecked(i);
-            const bool editable = this->activeClip == *clip;
-
-            auto *noteComponent = new VelocityMapNoteComponent(note, *clip);
-            noteComponent->setEditable(editable);
-            componentsMap[note] = UniquePointer<VelocityMapNoteComponent>(noteComponent);
-            this->addAndMakeVisible(noteComponent);
-            this->triggerBatchRepaintFor(noteComponent);
-        }
-
-        VELOCITY_MAP_BULK_REPAINT_END
+        this->repaintBarsOf(static_cast<const Note &>(event));
     }
 }
 
@@ -485,143 +388,60 @@ void VelocityProjectMap::onRemoveMidiEvent(const MidiEvent &event)
 {
     if (event.isTypeOf(MidiEvent::Type::Note))
     {
-        const Note &note = static_cast<const Note &>(event);
-        const auto *track = note.getSequence()->getTrack();
-
-        VELOCITY_MAP_BULK_REPAINT_START
-
-        forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+        const auto &note = static_cast<const Note &>(event);
+        if (this->draggedNote == &note)
         {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
-            {
-                sequenceMap.erase(note);
-            }
+            this->draggedNote = nullptr;
         }
 
-        VELOCITY_MAP_BULK_REPAINT_END
+        this->repaintBarsOf(note);
     }
 }
 
 void VelocityProjectMap::onAddClip(const Clip &clip)
 {
-    const SequenceMap *referenceMap = nullptr;
-    const auto *track = clip.getPattern()->getTrack();
-    if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
-
-    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
-    {
-        // Found a sequence map for the same track
-        referenceMap = c.second.get();
-        break;
-    }
-
-    if (referenceMap == nullptr)
-    {
-        jassertfalse;
-        return;
-    }
-
-    auto *sequenceMap = new SequenceMap();
-    this->patternMap[clip] = UniquePointer<SequenceMap>(sequenceMap);
-
-    VELOCITY_MAP_BULK_REPAINT_START
-
-    for (const auto &e : *referenceMap)
-    {
-        // reference the same note as neighbor components:
-        const auto &note = e.second.get()->note;
-        const bool editable = this->activeClip == clip;
-
-        auto *noteComponent = new VelocityMapNoteComponent(note, clip);
-        noteComponent->setEditable(editable);
-
-        (*sequenceMap)[note] = UniquePointer<VelocityMapNoteComponent>(noteComponent);
-        this->addAndMakeVisible(noteComponent);
-        this->applyNoteBounds(noteComponent);
-    }
-
-    VELOCITY_MAP_BULK_REPAINT_END
+    this->repaint();
 }
 
 void VelocityProjectMap::onChangeClip(const Clip &clip, const Clip &newClip)
 {
-    if (this->patternMap.contains(clip))
+    if (this->activeClip == clip)
     {
-        // Set new key for existing sequence map
-        auto *sequenceMap = this->patternMap[clip].release();
-        this->patternMap.erase(clip);
-        this->patternMap[newClip] = UniquePointer<SequenceMap>(sequenceMap);
-
-        // And update all components within it, as their beats should change
-        for (const auto &e : *sequenceMap)
-        {
-            this->batchRepaintList.add(e.second.get());
-        }
-
-        this->triggerAsyncUpdate();
+        this->activeClip = newClip;
     }
+
+    this->repaint();
 }
 
 void VelocityProjectMap::onRemoveClip(const Clip &clip)
 {
-    VELOCITY_MAP_BULK_REPAINT_START
-
-    if (this->patternMap.contains(clip))
-    {
-        this->patternMap.erase(clip);
-    }
-
-    VELOCITY_MAP_BULK_REPAINT_END
+    this->repaint();
 }
 
 void VelocityProjectMap::onChangeTrackProperties(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
-
-    VELOCITY_MAP_BULK_REPAINT_START
-
-    for (const auto &c : this->patternMap)
-    {
-        const auto &componentsMap = *c.second.get();
-        for (const auto &e : componentsMap)
-        {
-            e.second->updateColour();
-        }
-    }
-
-    VELOCITY_MAP_BULK_REPAINT_END
-
     this->repaint();
 }
 
 void VelocityProjectMap::onReloadProjectContent(const Array<MidiTrack *> &tracks,
     const ProjectMetadata *meta)
 {
-    this->reloadTrackMap();
+    this->draggedNote = nullptr;
+    this->repaint();
 }
 
 void VelocityProjectMap::onAddTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
-
-    VELOCITY_MAP_BULK_REPAINT_START
-    this->loadTrack(track);
-    VELOCITY_MAP_BULK_REPAINT_END
+    this->repaint();
 }
 
 void VelocityProjectMap::onRemoveTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
-
-    for (int i = 0; i < track->getPattern()->size(); ++i)
-    {
-        const auto &clip = *track->getPattern()->getUnchecked(i);
-        if (this->patternMap.contains(clip))
-        {
-            this->patternMap.erase(clip);
-        }
-    }
+    this->draggedNote = nullptr;
+    this->repaint();
 }
 
 void VelocityProjectMap::onChangeProjectBeatRange(float firstBeat, float lastBeat)
@@ -653,69 +473,122 @@ void VelocityProjectMap::onChangeViewEditableScope(MidiTrack *const, const Clip
     }
 
     this->activeClip = clip;
+    this->repaint();
+}
+
+void VelocityProjectMap::changeListenerCallback(ChangeBroadcaster *source)
+{
+    // for convenience, let's set selected items as editable
 
-    VELOCITY_MAP_BULK_REPAINT_START
+    jassert(dynamic_cast<Lasso *>(source));
+    const auto *selection = static_cast<Lasso *>(source);
 
-    for (const auto &c : this->patternMap)
+    this->selectedNotes.clear();
+
+    for (const auto *e : *selection)
     {
-        const bool editable = this->activeClip == c.first;
-        const auto &componentsMap = *c.second.get();
-        for (const auto &e : componentsMap)
-        {
-            e.second->setEditable(editable);
-        }
+        // assuming we've subscribed only on a piano roll's lasso changes
+        const auto *nc = static_cast<const NoteComponent *>(e);
+        this->selectedNotes.insert(nc->getNote().getId());
     }
 
-    VELOCITY_MAP_BULK_REPAINT_END
+    this->repaint();
 }
 
-void VelocityProjectMap::changeListenerCallback(ChangeBroadcaster *source)
+//===----------------------------------------------------------------------===//
+// Private
+//===----------------------------------------------------------------------===//
+
+bool VelocityProjectMap::isEditable(const Clip &clip, MidiEvent::Id noteId) const noexcept
 {
-    // for convenience, let's set selected items as editable
+    return this->activeClip == clip &&
+        (this->selectedNotes.empty() || this->selectedNotes.contains(noteId));
+}
 
-    jassert(dynamic_cast<Lasso *>(source));
-    const auto *selection = static_cast<Lasso *>(source);
+PianoSequence *VelocityProjectMap::getActiveSequence() const noexcept
+{
+    if (this->activeClip.getPattern() == nullptr)
+    {
+        return nullptr;
+    }
+
+    return dynamic_cast<PianoSequence *>(this->activeClip.getPattern()->getTrack()->getSequence());
+}
+
+float VelocityProjectMap::getXByBeat(float beat) const noexcept
+{
+    const float rollLengthInBeats = (this->rollLastBeat - this->rollFirstBeat);
+    return float(this->getWidth()) * ((beat - this->rollFirstBeat) / rollLengthInBeats);
+}
 
-    const auto activeMapIt = this->patternMap.find(this->activeClip);
-    if (activeMapIt == this->patternMap.end())
+float VelocityProjectMap::getBeatByX(float x) const noexcept
+{
+    const float rollLengthInBeats = (this->rollLastBeat - this->rollFirstBeat);
+    return this->rollFirstBeat + rollLengthInBeats * (x / float(jmax(1, this->getWidth())));
+}
+
+Rectangle<float> VelocityProjectMap::getBarBounds(float beat,
+    float length, float velocity) const noexcept
+{
+    const float x = this->getXByBeat(beat);
+    const float w = this->getXByBeat(beat + length) - x;
+
+    // at least 4 pixels are visible for 0 volume events:
+    const int h = jmax(4, int(this->getHeight() * velocity));
+    return { x, float(this->getHeight() - h), jmax(1.f, w), float(h) };
+}
+
+void VelocityProjectMap::repaintBarsOf(const Note &note)
+{
+    const auto *pattern = note.getSequence()->getTrack()->getPattern();
+    if (pattern == nullptr)
     {
-        jassertfalse;
         return;
     }
 
-    const auto *activeMap = activeMapIt->second.get();
+    for (int i = 0; i < pattern->size(); ++i)
+    {
+        const auto bar = this->getBarBounds(note.getBeat() +
+            pattern->getUnchecked(i)->getBeat(), note.getLength(), 0.f);
 
-    VELOCITY_MAP_BULK_REPAINT_START
+        this->repaint(int(floorf(bar.getX())) - 1, 0,
+            int(ceilf(bar.getWidth())) + 2, this->getHeight());
+    }
+}
+
+const Note *VelocityProjectMap::findEditableBarAt(const Point<float> &position) const
+{
+    constexpr auto dragAreaSize = 5.f;
 
-    if (selection->getNumSelected() == 0)
+    const auto *sequence = this->getActiveSequence();
+    if (sequence == nullptr)
     {
-        for (const auto &e : *activeMap)
-        {
-            e.second->setEditable(true);
-        }
+        return nullptr;
     }
-    else
+
+    Array<Note *> notes;
+    const auto beat = this->getBeatByX(position.x) - this->activeClip.getBeat();
+    const auto pixel = this->getBeatByX(1.f) - this->getBeatByX(0.f);
+    sequence->findNotesOverlappingRange(beat - pixel, beat + pixel, notes);
+
+    // the last one is the topmost one
+    for (int i = notes.size() - 1; i >= 0; --i)
     {
-        for (const auto &e : *activeMap)
-        {
-            e.second->setEditable(false);
-        }
+        const auto *note = notes.getUnchecked(i);
+        const auto bar = this->getBarBounds(note->getBeat() + this->activeClip.getBeat(),
+            note->getLength(), note->getVelocity() * this->activeClip.getVelocity());
 
-        for (const auto *e : *selection)
+        if (this->isEditable(this->activeClip, note->getId()) &&
+            position.x >= bar.getX() && position.x < bar.getRight() &&
+            position.y >= bar.getY() - 1.f && position.y <= bar.getY() + dragAreaSize)
         {
-            // assuming we've subscribed only on a piano roll's lasso changes
-            const auto *nc = static_cast<const NoteComponent *>(e);
-            activeMap->at(nc->getNote())->setEditable(true);
+            return note;
         }
     }
 
-    VELOCITY_MAP_BULK_REPAINT_END
+    return nullptr;
 }
 
-//===----------------------------------------------------------------------===//
-// Private
-//===----------------------------------------------------------------------===//
-
 void VelocityProjectMap::updateVolumeBlendingIndicator(const Point<int> &pos)
 {
     if (this->volumeBlendingAmount == 1.f && this->volumeBlendingIndicator->isVisible())
@@ -734,8 +607,11 @@ void VelocityProjectMap::updateVolumeBlendingIndicator(const Point<int> &pos)
 
 void VelocityProjectMap::applyVolumeChanges()
 {
-    const auto *activeMap = this->patternMap.at(this->activeClip).get();
-    jassert(activeMap);
+    auto *sequence = this->getActiveSequence();
+    if (sequence == nullptr)
+    {
+        return;
+    }
 
     // this is where things start looking a bit dirty:
     // to update notes velocities on the fly, we use undo/redo actions (as always),
@@ -746,7 +622,6 @@ void VelocityProjectMap::applyVolumeChanges()
     // which may - and will - change as the user drags the helper around,
     // so we are to track moments when the group changes and undo the current transaction
 
-    bool shouldUndo = false;
     Point<float> intersectionA;
     Point<float> intersectionB;
 
@@ -756,80 +631,90 @@ void VelocityProjectMap::applyVolumeChanges()
     const bool ascending = (dragLine.getStartX() <= dragLine.getEndX() && dragLine.getStartY() >= dragLine.getEndY())
         || (dragLine.getStartX() > dragLine.getEndX() && dragLine.getStartY() < dragLine.getEndY());
 
-    for (const auto &i : *activeMap)
+    // only the bars with the start or the end within the line's range
+    // can intersect it, so the candidates are found by a binary search
+    Array<Note *> candidates;
+    const auto clipBeat = this->activeClip.getBeat();
+    const auto lineStartX = jmin(dragLine.getStartX(), dragLine.getEndX());
+    const auto lineEndX = jmax(dragLine.getStartX(), dragLine.getEndX());
+    sequence->findNotesOverlappingRange(this->getBeatByX(lineStartX - 1.f) - clipBeat,
+        this->getBeatByX(lineEndX + 1.f) - clipBeat, candidates);
+
+    Array<const Note *> group;
+    Array<float> intersectionVelocities;
+
+    for (const auto *note : candidates)
     {
-        if (!i.second->isEditable())
+        if (!this->isEditable(this->activeClip, note->getId()))
         {
             continue;
         }
 
-        const bool ia = dragLine.intersects(i.second->getStartLine(), intersectionA);
-        const bool ib = dragLine.intersects(i.second->getEndLine(), intersectionB);
-        const bool hasIntersection = ia || ib;
+        const auto bar = this->getBarBounds(note->getBeat() + clipBeat, note->getLength(), 0.f);
+        const Line<float> startLine(bar.getX(), 0.f, bar.getX(), float(Globals::UI::levelsMapHeight));
+        const Line<float> endLine(bar.getRight(), 0.f, bar.getRight(), float(Globals::UI::levelsMapHeight));
+
+        const bool ia = dragLine.intersects(startLine, intersectionA);
+        const bool ib = dragLine.intersects(endLine, intersectionB);
+        if (!ia && !ib)
+        {
+            continue;
+        }
 
         float intersectionVelocity = 0.f;
         if (ascending)
         {
-            if (ia)
+            if (!ia)
             {
-                intersectionVelocity = getVelocityByIntersection(intersectionA);
-            }
-            else
-            {
-                dragLineExt.intersects(i.second->getStartLine(), intersectionA);
-                intersectionVelocity = getVelocityByIntersection(intersectionA);
+                dragLineExt.intersects(startLine, intersectionA);
             }
+
+            intersectionVelocity = getVelocityByIntersection(intersectionA);
         }
         else
         {
-            if (ib)
-            {
-                intersectionVelocity = getVelocityByIntersection(intersectionB);
-            }
-            else
+            if (!ib)
             {
-                dragLineExt.intersects(i.second->getEndLine(), intersectionB);
-                intersectionVelocity = getVelocityByIntersection(intersectionB);
+                dragLineExt.intersects(endLine, intersectionB);
             }
-        }
 
-        auto existingIntersection = this->dragIntersections.find(i.first);
-        if (hasIntersection && existingIntersection == this->dragIntersections.end())
-        {
-            // found new intersection
-            shouldUndo = true;
-            this->dragIntersections.emplace(i.first, intersectionVelocity);
+            intersectionVelocity = getVelocityByIntersection(intersectionB);
         }
-        else if (!hasIntersection && existingIntersection != this->dragIntersections.end())
+
+        group.add(note);
+        intersectionVelocities.add(intersectionVelocity);
+    }
+
+    // both are in the sequence order
+    const bool groupHasChanged = group != this->dragGroup;
+
+    if (groupHasChanged)
+    {
+        if (this->dragHasChanges)
         {
-            // lost existing intersection
-            shouldUndo = true;
-            this->dragIntersections.erase(existingIntersection);
+            sequence->undoCurrentTransactionOnly();
         }
-        else if (hasIntersection)
+
+        // after the undo, these are the velocities before dragging
+        this->dragGroup.swapWith(group);
+        this->dragGroupVelocities.clearQuick();
+        for (const auto *note : this->dragGroup)
         {
-            this->dragIntersections[i.first] = intersectionVelocity;
+            this->dragGroupVelocities.add(note->getVelocity());
         }
     }
 
-    // filling up arrays all the time on mouse drag - kinda sucks, nah?
     this->dragChangedNotes.clearQuick();
     this->dragChanges.clearQuick();
 
-    for (const auto &i : this->dragIntersections)
+    for (int i = 0; i < this->dragGroup.size(); ++i)
     {
-        const auto newVelocity = (i.second * this->volumeBlendingAmount) +
-            (i.first.getVelocity() * (1.f - this->volumeBlendingAmount));
-
-        this->dragChangedNotes.add(i.first);
-        this->dragChanges.add(i.first.withVelocity(newVelocity));
-    }
+        const auto &note = *this->dragGroup.getUnchecked(i);
+        const auto newVelocity = (intersectionVelocities.getUnchecked(i) * this->volumeBlendingAmount) +
+            (this->dragGroupVelocities.getUnchecked(i) * (1.f - this->volumeBlendingAmount));
 
-    auto *sequence = static_cast<PianoSequence *>(this->activeClip.getPattern()->getTrack()->getSequence());
-
-    if (shouldUndo && this->dragHasChanges)
-    {
-        sequence->undoCurrentTransactionOnly();
+        this->dragChangedNotes.add(note);
+        this->dragChanges.add(note.withVelocity(newVelocity));
     }
 
     if (!this->dragChangedNotes.isEmpty())
@@ -843,96 +728,3 @@ void VelocityProjectMap::applyVolumeChanges()
         sequence->changeGroup(this->dragChangedNotes, this->dragChanges, true);
     }
 }
-
-void VelocityProjectMap::reloadTrackMap()
-{
-    this->patternMap.clear();
-
-    VELOCITY_MAP_BULK_REPAINT_START
-
-    const auto &tracks = this->project.getTracks();
-    for (const auto *track : tracks)
-    {
-        if (dynamic_cast<const PianoSequence *>(track->getSequence()))
-        {
-            this->loadTrack(track);
-        }
-    }
-
-    VELOCITY_MAP_BULK_REPAINT_END
-}
-
-void VelocityProjectMap::loadTrack(const MidiTrack *const track)
-{
-    if (track->getPattern() == nullptr)
-    {
-        return;
-    }
-
-    for (int i = 0; i < track->getPattern()->size(); ++i)
-    {
-        const Clip *clip = track->getPattern()->getUnchecked(i);
-        const bool editable = this->activeClip == *clip;
-
-        auto *sequenceMap = new SequenceMap();
-        this->patternMap[*clip] = UniquePointer<SequenceMap>(sequenceMap);
-
-        for (int j = 0; j < track->getSequence()->size(); ++j)
-        {
-            const MidiEvent *event = track->getSequence()->getUnchecked(j);
-            if (event->isTypeOf(MidiEvent::Type::Note))
-            {
-                const auto *note = static_cast<const Note *>(event);
-                auto *noteComponent = new VelocityMapNoteComponent(*note, *clip);
-                noteComponent->setEditable(editable);
-                (*sequenceMap)[*note] = UniquePointer<VelocityMapNoteComponent>(noteComponent);
-                this->addAndMakeVisible(noteComponent);
-                this->applyNoteBounds(noteComponent);
-            }
-        }
-    }
-}
-
-void VelocityProjectMap::applyNoteBounds(VelocityMapNoteComponent *nc)
-{
-    const float rollLengthInBeats = (this->rollLastBeat - this->rollFirstBeat);
-    const float projectLengthInBeats = (this->projectLastBeat - this->projectFirstBeat);
-
-    const float beat = (nc->getBeat() - this->rollFirstBeat);
-    const float mapWidth = float(this->getWidth()) * (projectLengthInBeats / rollLengthInBeats);
-
-    const float x = (mapWidth * (beat / projectLengthInBeats));
-    const float w = (mapWidth * (nc->getLength() / projectLengthInBeats));
-
-    // at least 4 pixels are visible for 0 volume events:
-    const int h = jmax(4, int(this->getHeight() * nc->getVelocity()));
-    nc->setRealBounds(x, this->getHeight() - h, jmax(1.f, w), h);
-}
-
-void VelocityProjectMap::triggerBatchRepaintFor(VelocityMapNoteComponent *target)
-{
-    this->batchRepaintList.add(target);
-    this->triggerAsyncUpdate();
-}
-
-void VelocityProjectMap::handleAsyncUpdate()
-{
-    // batch repaint & resize stuff
-    if (this->batchRepaintList.size() > 0)
-    {
-        VELOCITY_MAP_BULK_REPAINT_START
-
-        for (int i = 0; i < this->batchRepaintList.size(); ++i)
-        {
-            // There are still many cases when a scheduled component is deleted at this time:
-            if (Component *component = this->batchRepaintList.getUnchecked(i))
-            {
-                this->applyNoteBounds(static_cast<VelocityMapNoteComponent *>(component));
-            }
-        }
-
-        VELOCITY_MAP_BULK_REPAINT_END
-
-        this->batchRepaintList.clearQuick();
-    }
-}
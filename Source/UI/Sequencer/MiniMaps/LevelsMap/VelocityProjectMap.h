@@ -24,14 +24,16 @@
 
 class RollBase;
 class ProjectNode;
-class VelocityMapNoteComponent;
+class PianoSequence;
 class VelocityLevelDraggingHelper;
 class FineTuningValueIndicator;
 
+// all the velocity bars are painted by the map itself, batched per clip,
+// straight from the sequences' packed notes, instead of being components;
+// the range lookups are done by the sequences' beat-sorted binary search
 class VelocityProjectMap final :
     public Component,
     public ProjectListener,
-    public AsyncUpdater, // triggers batch repaints for children
     public ChangeListener // subscribes on parent roll's lasso changes
 {
 public:
@@ -44,6 +46,8 @@ public:
     //===------------------------------------------------------------------===//
 
     void resized() override;
+    void paint(Graphics &g) override;
+    void mouseMove(const MouseEvent &e) override;
     void mouseDown(const MouseEvent &e) override;
     void mouseDrag(const MouseEvent &e) override;
     void mouseUp(const MouseEvent &e) override;
@@ -75,10 +79,6 @@ private:
 
     void changeListenerCallback(ChangeBroadcaster *source) override;
 
-    void applyNoteBounds(VelocityMapNoteComponent *nc);
-    void reloadTrackMap();
-    void loadTrack(const MidiTrack *const track);
-
     float projectFirstBeat = 0.f;
     float projectLastBeat = Globals::Defaults::projectLength;
 
@@ -90,12 +90,31 @@ private:
 
     Clip activeClip;
 
-    using SequenceMap = FlatHashMap<Note, UniquePointer<VelocityMapNoteComponent>, MidiEventHash>;
-    using PatternMap = FlatHashMap<Clip, UniquePointer<SequenceMap>, ClipHash>;
-    PatternMap patternMap;
+    // when the roll has a selection, only the selected notes are editable
+    FlatHashSet<MidiEvent::Id> selectedNotes;
+    bool isEditable(const Clip &clip, MidiEvent::Id noteId) const noexcept;
+    PianoSequence *getActiveSequence() const noexcept;
+
+    float getXByBeat(float beat) const noexcept;
+    float getBeatByX(float x) const noexcept;
+    Rectangle<float> getBarBounds(float beat, float length, float velocity) const noexcept;
+
+    void paintBars(Graphics &g, const MidiTrack *track, const Clip &clip,
+        bool editable, float paintStartBeat, float paintEndBeat);
+    void repaintBarsOf(const Note &note);
 
+    RectangleList<float> barsBatch;
+    RectangleList<float> barsBackgroundBatch;
+
+    // the bar dragged directly by its top edge
+    const Note *findEditableBarAt(const Point<float> &position) const;
+    const Note *draggedNote = nullptr;
+    float draggedNoteAnchor = 0.f;
+
+    // the bars crossed by the dragging helper line
     UniquePointer<VelocityLevelDraggingHelper> dragHelper;
-    FlatHashMap<Note, float, MidiEventHash> dragIntersections;
+    Array<const Note *> dragGroup;
+    Array<float> dragGroupVelocities;
     Array<Note> dragChangedNotes, dragChanges;
     bool dragHasChanges = false;
 
@@ -106,9 +125,5 @@ private:
 
     void applyVolumeChanges();
 
-    void triggerBatchRepaintFor(VelocityMapNoteComponent *target);
-    void handleAsyncUpdate() override;
-    Array<WeakReference<Component>> batchRepaintList;
-
     JUCE_LEAK_DETECTOR(VelocityProjectMap)
 };
@@ -48,6 +48,7 @@ PianoProjectMap::~PianoProjectMap()
 void PianoProjectMap::setBrightness(float brighness)
 {
     this->brightnessFactor = brighness;
+    this->invalidateAll();
     this->repaint();
 }
 
@@ -60,41 +61,168 @@ void PianoProjectMap::resized()
     this->componentHeight =
         static_cast<float>(this->getHeight()) /
         static_cast<float>(this->keyboardSize);
+
+    this->invalidateAll();
 }
 
 void PianoProjectMap::paint(Graphics &g)
 {
+    this->updateContentImageIfNeeded();
+    g.drawImageAt(this->contentImage, 0, 0);
+}
+
+//===----------------------------------------------------------------------===//
+// Content image
+//===----------------------------------------------------------------------===//
+
+void PianoProjectMap::invalidateStrip(Range<int> strip)
+{
+    this->invalidStrip = this->invalidStrip.isEmpty() ?
+        strip : this->invalidStrip.getUnionWith(strip);
+}
+
+void PianoProjectMap::invalidateNote(const Note &note)
+{
+    const auto *track = note.getSequence()->getTrack();
+    for (const auto &c : this->patternMap)
+    {
+        if (c.first.getPattern()->getTrack() == track)
+        {
+            const auto beat = note.getBeat() + c.first.getBeat();
+            const auto startX = int(floorf(this->getMapX(beat)));
+            const auto endX = int(ceilf(this->getMapX(beat + note.getLength())));
+            // the notes are at least a pixel wide, plus antialiasing
+            this->invalidateStrip({ startX - 1, jmax(startX + 1, endX) + 1 });
+        }
+    }
+}
+
+void PianoProjectMap::invalidateAll()
+{
+    this->invalidateStrip({ 0, jmax(1, this->getWidth()) });
+}
+
+void PianoProjectMap::updateContentImageIfNeeded()
+{
+    const auto width = this->getWidth();
+    const auto height = this->getHeight();
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    if (this->contentImage.getWidth() != width ||
+        this->contentImage.getHeight() != height)
+    {
+        this->contentImage = Image(Image::ARGB, width, height, true);
+        this->invalidStrip = { 0, width };
+    }
+
+    const auto strip = this->invalidStrip.getIntersectionWith({ 0, width });
+    this->invalidStrip = {};
+
+    if (strip.isEmpty())
+    {
+        return;
+    }
+
+    this->contentImage.clear({ strip.getStart(), 0, strip.getLength(), height });
+
     const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
-    const float projectLengthInBeats = this->projectLastBeat - this->projectFirstBeat;
-    const float mapWidth = float(this->getWidth()) * (projectLengthInBeats / rollLengthInBeats);
+    if (float(width) / rollLengthInBeats < PianoProjectMap::lowDetailBeatWidth)
+    {
+        this->renderStripLowDetail(strip);
+    }
+    else
+    {
+        this->renderStrip(strip);
+    }
+}
+
+void PianoProjectMap::renderStrip(Range<int> strip)
+{
+    Graphics g(this->contentImage);
+    g.reduceClipRegion(strip.getStart(), 0, strip.getLength(), this->getHeight());
+
+    const auto startX = float(strip.getStart());
+    const auto endX = float(strip.getEnd());
 
     for (const auto &c : this->patternMap)
     {
         const auto sequenceMap = c.second.get();
-        const bool isActiveClip = this->activeClip == c.first;
-
-        g.setColour(c.first.getTrackColour()
-            .interpolatedWith(this->baseColour, .4f)
-            .withAlpha(isActiveClip ? this->brightnessFactor * .9f : this->brightnessFactor * .65f)
-            .withMultipliedBrightness(this->brightnessFactor));
+        g.setColour(this->getClipColour(c.first));
 
         for (const auto &n : *sequenceMap)
         {
-            const auto key = jlimit(0, this->keyboardSize, n.getKey() + c.first.getKey());
-            const auto beat = n.getBeat() + c.first.getBeat() - this->rollFirstBeat;
-            const auto length = n.getLength();
+            const auto beat = n.getBeat() + c.first.getBeat();
+            const float x = this->getMapX(beat);
+            const float w = jmax(0.25f, this->getMapX(beat + n.getLength()) - x);
 
-            const float x = (mapWidth * (beat / projectLengthInBeats));
-            const float w = (mapWidth * (length / projectLengthInBeats));
+            if (x + w < startX || x > endX)
+            {
+                continue;
+            }
 
             // with rounding, it just looks better:
-            const int y = this->getHeight() - static_cast<int>(key * this->componentHeight);
+            const int y = this->getMapY(n.getKey() + c.first.getKey());
 
-            g.fillRect(x, static_cast<float>(y), jmax(0.25f, w), 1.0f);
+            g.fillRect(x, static_cast<float>(y), w, 1.0f);
         }
     }
 }
 
+void PianoProjectMap::renderStripLowDetail(Range<int> strip)
+{
+    const auto height = this->contentImage.getHeight();
+    Image::BitmapData data(this->contentImage, Image::BitmapData::writeOnly);
+
+    for (const auto &c : this->patternMap)
+    {
+        const auto pixel = this->getClipColour(c.first).getPixelARGB();
+
+        for (const auto &n : *c.second.get())
+        {
+            const int y = this->getMapY(n.getKey() + c.first.getKey());
+            if (y < 0 || y >= height)
+            {
+                continue;
+            }
+
+            const auto beat = n.getBeat() + c.first.getBeat();
+            const auto startX = int(this->getMapX(beat));
+            const auto endX = jmax(startX + 1, int(this->getMapX(beat + n.getLength())));
+
+            // at least one pixel per note, each pixel is only written once
+            const auto range = Range<int>(startX, endX).getIntersectionWith(strip);
+            for (int x = range.getStart(); x < range.getEnd(); ++x)
+            {
+                reinterpret_cast<PixelARGB *>(data.getPixelPointer(x, y))->set(pixel);
+            }
+        }
+    }
+}
+
+float PianoProjectMap::getMapX(float beat) const noexcept
+{
+    const float rollLengthInBeats = this->rollLastBeat - this->rollFirstBeat;
+    return float(this->getWidth()) * ((beat - this->rollFirstBeat) / rollLengthInBeats);
+}
+
+int PianoProjectMap::getMapY(int key) const noexcept
+{
+    const auto clampedKey = jlimit(0, this->keyboardSize, key);
+    return this->getHeight() - static_cast<int>(clampedKey * this->componentHeight);
+}
+
+Colour PianoProjectMap::getClipColour(const Clip &clip) const
+{
+    const bool isActiveClip = this->activeClip == clip;
+    return clip.getTrackColour()
+        .interpolatedWith(this->baseColour, .4f)
+        .withAlpha(isActiveClip ? this->brightnessFactor * .9f : this->brightnessFactor * .65f)
+        .withMultipliedBrightness(this->brightnessFactor);
+}
+
 //===----------------------------------------------------------------------===//
 // ProjectListener
 //===----------------------------------------------------------------------===//
@@ -121,6 +249,8 @@ void PianoProjectMap::onChangeMidiEvent(const MidiEvent &e1, const MidiEvent &e2
             }
         }
 
+        this->invalidateNote(note);
+        this->invalidateNote(newNote);
         this->triggerAsyncUpdate();
     }
 }
@@ -138,6 +268,7 @@ void PianoProjectMap::onAddMidiEvent(const MidiEvent &event)
             sequenceMap.insert(note);
         }
 
+        this->invalidateNote(note);
         this->triggerAsyncUpdate();
     }
 }
@@ -158,6 +289,7 @@ void PianoProjectMap::onRemoveMidiEvent(const MidiEvent &event)
             }
         }
 
+        this->invalidateNote(note);
         this->triggerAsyncUpdate();
     }
 }
@@ -189,6 +321,7 @@ void PianoProjectMap::onAddClip(const Clip &clip)
         sequenceMap->insert(note);
     }
 
+    this->invalidateAll();
     this->triggerAsyncUpdate();
 }
 
@@ -200,6 +333,7 @@ void PianoProjectMap::onChangeClip(const Clip &clip, const Clip &newClip)
         auto *sequenceMap = this->patternMap[clip].release();
         this->patternMap.erase(clip);
         this->patternMap[newClip] = UniquePointer<SequenceSet>(sequenceMap);
+        this->invalidateAll();
         this->triggerAsyncUpdate();
     }
 }
@@ -209,6 +343,7 @@ void PianoProjectMap::onRemoveClip(const Clip &clip)
     if (this->patternMap.contains(clip))
     {
         this->patternMap.erase(clip);
+        this->invalidateAll();
         this->triggerAsyncUpdate();
     }
 }
@@ -218,7 +353,7 @@ void PianoProjectMap::onChangeProjectInfo(const ProjectMetadata *info)
     if (this->keyboardSize != info->getKeyboardSize())
     {
         this->keyboardSize = info->getKeyboardSize();
-        this->resized(); // updates componenetHeight
+        this->resized(); // updates componenetHeight, invalidates the image
         this->triggerAsyncUpdate(); // repaints
     }
 }
@@ -226,6 +361,7 @@ void PianoProjectMap::onChangeProjectInfo(const ProjectMetadata *info)
 void PianoProjectMap::onChangeTrackProperties(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
+    this->invalidateAll();
     this->triggerAsyncUpdate();
 }
 
@@ -240,6 +376,7 @@ void PianoProjectMap::onAddTrack(MidiTrack *const track)
 {
     if (!dynamic_cast<const PianoSequence *>(track->getSequence())) { return; }
     this->loadTrack(track);
+    this->invalidateAll();
     this->triggerAsyncUpdate();
 }
 
@@ -256,6 +393,7 @@ void PianoProjectMap::onRemoveTrack(MidiTrack *const track)
         }
     }
 
+    this->invalidateAll();
     this->triggerAsyncUpdate();
 }
 
@@ -292,6 +430,7 @@ void PianoProjectMap::onChangeViewEditableScope(MidiTrack *const, const Clip &cl
     }
 
     this->activeClip = clip;
+    this->invalidateAll();
     this->triggerAsyncUpdate();
 }
 
@@ -312,6 +451,7 @@ void PianoProjectMap::reloadTrackMap()
         }
     }
 
+    this->invalidateAll();
     this->triggerAsyncUpdate();
 }
 
@@ -73,6 +73,27 @@ private:
     void reloadTrackMap();
     void loadTrack(const MidiTrack *const track);
 
+    // the notes are rendered into this image, which is only updated
+    // in the invalidated strips, so that repainting the map, e.g. when
+    // the scroller's screen range or the playhead move, is just a blit
+    Image contentImage;
+    Range<int> invalidStrip;
+    void invalidateStrip(Range<int> strip);
+    void invalidateNote(const Note &note);
+    void invalidateAll();
+    void updateContentImageIfNeeded();
+    void renderStrip(Range<int> strip);
+
+    // when zoomed out so far that the notes are thinner than a pixel,
+    // they are aggregated into the image's pixels directly,
+    // instead of filling a sub-pixel rectangle for each of them
+    static constexpr auto lowDetailBeatWidth = 2.f;
+    void renderStripLowDetail(Range<int> strip);
+
+    float getMapX(float beat) const noexcept;
+    int getMapY(int key) const noexcept;
+    Colour getClipColour(const Clip &clip) const;
+
     float projectFirstBeat = 0.f;
     float projectLastBeat = Globals::Defaults::projectLength;
 
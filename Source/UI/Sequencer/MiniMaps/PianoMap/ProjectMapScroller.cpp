@@ -249,7 +249,7 @@ void ProjectMapScroller::mouseDrag(const MouseEvent &event)
 
             this->roll->panByOffset(xOffset, this->rollViewportPositionAtDragStart.y);
 
-            this->triggerAsyncUpdate();
+            FrameScheduler::getInstance().requestFrame(this);
         }
     }
     else
@@ -281,7 +281,7 @@ void ProjectMapScroller::mouseUp(const MouseEvent &event)
         this->updateAllBounds();
         this->repaint();
 
-        this->startTimerHz(this->animationTimerFrequencyHz);
+        FrameScheduler::getInstance().startAnimation(this);
     }
 }
 
@@ -297,17 +297,17 @@ void ProjectMapScroller::mouseWheelMove(const MouseEvent &event, const MouseWhee
 
 void ProjectMapScroller::onMidiRollMoved(RollBase *targetRoll)
 {
-    if (this->isVisible() && this->roll == targetRoll && !this->isTimerRunning())
+    if (this->isVisible() && this->roll == targetRoll && !FrameScheduler::getInstance().isAnimating(this))
     {
-        this->triggerAsyncUpdate();
+        FrameScheduler::getInstance().requestFrame(this);
     }
 }
 
 void ProjectMapScroller::onMidiRollResized(RollBase *targetRoll)
 {
-    if (this->isVisible() && this->roll == targetRoll && !this->isTimerRunning())
+    if (this->isVisible() && this->roll == targetRoll && !FrameScheduler::getInstance().isAnimating(this))
     {
-        this->triggerAsyncUpdate();
+        FrameScheduler::getInstance().requestFrame(this);
     }
 }
 
@@ -317,11 +317,11 @@ void ProjectMapScroller::switchToRoll(SafePointer<RollBase> roll)
     this->oldAreaBounds = this->getIndicatorBounds();
     this->oldMapBounds = this->getMapBounds().toFloat();
     this->roll = roll;
-    this->startTimerHz(this->animationTimerFrequencyHz);
+    FrameScheduler::getInstance().startAnimation(this);
 }
 
 //===----------------------------------------------------------------------===//
-// Timer
+// Animation
 //===----------------------------------------------------------------------===//
 
 static Rectangle<float> lerpRectangle(const Rectangle<float> &r1,
@@ -354,12 +354,13 @@ static float getRectangleDistance(const Rectangle<float> &r1,
         fabs(r1.getHeight() - r2.getHeight());
 }
 
-void ProjectMapScroller::timerCallback()
+void ProjectMapScroller::animationStep()
 {
+    const auto factor = this->animationsEnabled ? 0.35f : 1.f;
     const auto mb = this->getMapBounds().toFloat();
-    const auto mbLerp = lerpRectangle(this->oldMapBounds, mb, 0.35f);
+    const auto mbLerp = lerpRectangle(this->oldMapBounds, mb, factor);
     const auto ib = this->getIndicatorBounds();
-    const auto ibLerp = lerpRectangle(this->oldAreaBounds, ib, 0.35f);
+    const auto ibLerp = lerpRectangle(this->oldAreaBounds, ib, factor);
     const bool shouldStop = getRectangleDistance(this->oldAreaBounds, ib) < 0.5f;
     const auto targetAreaBounds = shouldStop ? ib : ibLerp;
     const auto targetMapBounds = shouldStop ? mb : mbLerp;
@@ -378,17 +379,24 @@ void ProjectMapScroller::timerCallback()
 
     if (shouldStop)
     {
-        this->stopTimer();
+        FrameScheduler::getInstance().stopAnimation(this);
     }
 }
 
 //===----------------------------------------------------------------------===//
-// AsyncUpdater
+// FrameScheduler::Client
 //===----------------------------------------------------------------------===//
 
-void ProjectMapScroller::handleAsyncUpdate()
+void ProjectMapScroller::onFrame(double frameTimeMs)
 {
-    this->updateAllBounds();
+    if (FrameScheduler::getInstance().isAnimating(this))
+    {
+        this->animationStep();
+    }
+    else
+    {
+        this->updateAllBounds();
+    }
 }
 
 void ProjectMapScroller::updateAllBounds()
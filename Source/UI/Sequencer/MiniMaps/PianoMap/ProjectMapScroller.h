@@ -26,12 +26,12 @@ class Transport;
 #include "HelperRectangle.h"
 #include "RollListener.h"
 #include "ComponentFader.h"
+#include "FrameScheduler.h"
 
 class ProjectMapScroller final :
     public Component,
     public RollListener,
-    private AsyncUpdater,
-    private Timer
+    private FrameScheduler::Client
 {
 public:
 
@@ -59,7 +59,7 @@ public:
 
     void setAnimationsEnabled(bool enabled)
     {
-        this->animationTimerFrequencyHz = enabled ? 60 : 500;
+        this->animationsEnabled = enabled;
     }
 
     //===------------------------------------------------------------------===//
@@ -141,8 +141,8 @@ private:
 
 private:
     
-    void handleAsyncUpdate() override;
-    void timerCallback() override;
+    void onFrame(double frameTimeMs) override;
+    void animationStep();
     void updateAllBounds();
     
     Transport &transport;
@@ -172,6 +172,6 @@ private:
     const Colour borderLineDark;
     const Colour borderLineLight;
 
-    int animationTimerFrequencyHz = 60;
+    bool animationsEnabled = true;
 
 };
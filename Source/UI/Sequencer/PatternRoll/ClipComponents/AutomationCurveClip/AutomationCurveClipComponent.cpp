@@ -18,7 +18,6 @@
 #include "Common.h"
 #include "AutomationCurveClipComponent.h"
 #include "AutomationCurveEventComponent.h"
-#include "AutomationCurveEventsConnector.h"
 #include "AutomationCurveHelper.h"
 #include "ProjectNode.h"
 #include "MidiSequence.h"
@@ -41,7 +40,7 @@ AutomationCurveClipComponent::AutomationCurveClipComponent(ProjectNode &project,
 
     this->reloadTrack();
 
-    this->project.addListener(this);
+    this->project.addListener(this, sequence);
 }
 
 AutomationCurveClipComponent::~AutomationCurveClipComponent()
@@ -113,26 +112,63 @@ void AutomationCurveClipComponent::mouseUp(const MouseEvent &e)
     }
 }
 
+void AutomationCurveClipComponent::mouseMove(const MouseEvent &e)
+{
+    if (e.x != this->handlesCentreX)
+    {
+        this->handlesCentreX = e.x;
+        this->updateHandles();
+    }
+}
+
+void AutomationCurveClipComponent::mouseExit(const MouseEvent &e)
+{
+    // moving over one of the handles also counts as exiting
+    if (!this->isMouseOver(true))
+    {
+        this->handlesCentreX = -1;
+        this->updateHandles();
+    }
+}
+
+void AutomationCurveClipComponent::paint(Graphics &g)
+{
+    // Draw the frame, set the colour, etc:
+    ClipComponent::paint(g);
+
+    this->rebuildCurveIfNeeded();
+
+    const auto clipBounds = g.getClipBounds();
+    const float paintStartX = float(clipBounds.getX() - 1);
+    const float paintEndX = float(clipBounds.getRight() + 1);
+
+    this->curveBatch.clear();
+    for (const auto &p : this->curvePoints)
+    {
+        if (p.x < paintStartX) { continue; }
+        if (p.x > paintEndX) { break; }
+        this->curveBatch.addWithoutMerging({ p.x - 1.f, p.y - 0.75f, 2.f, 1.5f });
+    }
+
+    g.fillRectList(this->curveBatch);
+    g.fillPath(this->helpersPath);
+    g.fillPath(this->eventCentresPath);
+    g.fillPath(this->eventsPath);
+}
+
 void AutomationCurveClipComponent::resized()
 {
-    this->setVisible(false);
-    
-    // во избежание глюков - сначала обновляем позиции
-    for (int i = 0; i < this->eventComponents.size(); ++i)
+    this->curveNeedsRebuild = true;
+
+    for (auto *c : this->eventComponents)
     {
-        auto *c = this->eventComponents.getUnchecked(i);
         c->setBounds(this->getEventBounds(c));
     }
-    
-    // затем - зависимые элементы
-    for (int i = 0; i < this->eventComponents.size(); ++i)
+
+    for (auto *c : this->eventComponents)
     {
-        auto *c = this->eventComponents.getUnchecked(i);
-        c->updateConnector();
         c->updateHelper();
     }
-    
-    this->setVisible(true);
 }
 
 void AutomationCurveClipComponent::mouseWheelMove(const MouseEvent &event, const MouseWheelDetails &wheel)
@@ -204,18 +240,15 @@ void AutomationCurveClipComponent::getRowsColsByMousePosition(int x, int y, floa
     targetValue = jlimit(0.f, 1.f, targetValue);
 }
 
-AutomationCurveEventComponent *AutomationCurveClipComponent::getPreviousEventComponent(int indexOfSorted) const
+Rectangle<int> AutomationCurveClipComponent::getHelperBounds(const Point<int> &c1,
+    const Point<int> &c2, float curvature)
 {
-    const int indexOfPrevious = indexOfSorted - 1;
-    return isPositiveAndBelow(indexOfPrevious, this->eventComponents.size()) ?
-        this->eventComponents.getUnchecked(indexOfPrevious) : nullptr;
-}
-
-AutomationCurveEventComponent *AutomationCurveClipComponent::getNextEventComponent(int indexOfSorted) const
-{
-    const int indexOfNext = indexOfSorted + 1;
-    return isPositiveAndBelow(indexOfNext, this->eventComponents.size()) ?
-        this->eventComponents.getUnchecked(indexOfNext) : nullptr;
+    const int d = int(AutomationCurveClipComponent::helperComponentDiameter);
+    const auto y1 = float(jmin(c1.getY(), c2.getY()));
+    const auto y2 = float(jmax(c1.getY(), c2.getY()));
+    const auto y = y1 + (y2 - y1) * (1.f - curvature);
+    const int x = jmin(c1.getX(), c2.getX()) + int(float(c2.getX() - c1.getX()) / 2.f);
+    return { x - (d / 2), int(y + 0.5f - (float(d) / 2.f)), d, d };
 }
 
 //===----------------------------------------------------------------------===//
@@ -229,39 +262,23 @@ void AutomationCurveClipComponent::onChangeMidiEvent(const MidiEvent &oldEvent,
         const AutomationEvent &autoEvent = static_cast<const AutomationEvent &>(oldEvent);
         const AutomationEvent &newAutoEvent = static_cast<const AutomationEvent &>(newEvent);
 
-        if (auto *component = this->eventsHash[autoEvent])
+        const auto found = this->eventsHash.find(autoEvent);
+        if (found != this->eventsHash.end())
         {
-            // update links and connectors
-            this->eventComponents.sort(*component);
-            const int indexOfSorted = this->eventComponents.indexOfSorted(*component, component);
-            auto *previousEventComponent = this->getPreviousEventComponent(indexOfSorted);
-            auto *nextEventComponent = this->getNextEventComponent(indexOfSorted);
-            
-            component->setNextNeighbour(nextEventComponent);
-            //component->setVisible(false);
-            this->updateCurveComponent(component);
-            //component->setVisible(true);
-            
-            if (previousEventComponent)
-            {
-                previousEventComponent->setNextNeighbour(component);
-                
-                if (auto *oneMorePrevious = this->getPreviousEventComponent(indexOfSorted - 1))
-                {
-                    oneMorePrevious->setNextNeighbour(previousEventComponent);
-                }
-            }
-            
-            if (nextEventComponent)
+            auto *component = found->second;
+            this->eventsHash.erase(found);
+            this->eventsHash[newAutoEvent] = component;
+
+            // the handles follow the dragged event
+            if (this->isHandleInUse(component))
             {
-                nextEventComponent->setNextNeighbour(this->getNextEventComponent(indexOfSorted + 1));
+                this->handlesCentreX = this->getEventBounds(component).getCentreX();
             }
-            
-            this->eventsHash.erase(autoEvent);
-            this->eventsHash[newAutoEvent] = component;
-            
-            this->roll.triggerBatchRepaintFor(this);
         }
+
+        this->curveNeedsRebuild = true;
+        this->updateHandles();
+        this->roll.triggerBatchRepaintFor(this);
     }
 }
 
@@ -270,30 +287,26 @@ void AutomationCurveClipComponent::onAddMidiEvent(const MidiEvent &event)
     if (event.getSequence() == this->sequence)
     {
         const AutomationEvent &autoEvent = static_cast<const AutomationEvent &>(event);
-        
-        auto *component = new AutomationCurveEventComponent(*this, autoEvent);
-        this->addAndMakeVisible(component);
 
-        // update links and connectors
-        const int indexOfSorted = this->eventComponents.addSorted(*component, component);
-        auto *previousEventComponent = this->getPreviousEventComponent(indexOfSorted);
-        auto *nextEventComponent = this->getNextEventComponent(indexOfSorted);
+        this->curveNeedsRebuild = true;
 
-        component->setNextNeighbour(nextEventComponent);
-        this->updateCurveComponent(component);
-        component->toFront(false);
-        //this->eventAnimator.fadeIn(component, Globals::UI::fadeInShort);
-        
-        if (previousEventComponent)
+        if (this->addNewEventMode)
         {
-            previousEventComponent->setNextNeighbour(component);
+            const auto *autoSequence = autoEvent.getSequence();
+            this->handlesCentreX = this->getEventBounds(autoEvent.getBeat() - autoSequence->getFirstBeat(),
+                autoSequence->getLengthInBeats(), autoEvent.getControllerValue()).getCentreX();
         }
 
-        this->eventsHash[autoEvent] = component;
-                
+        this->updateHandles();
+
         if (this->addNewEventMode)
         {
-            this->draggingEvent = component;
+            const auto found = this->eventsHash.find(autoEvent);
+            if (found != this->eventsHash.end())
+            {
+                this->draggingEvent = found->second;
+            }
+
             this->addNewEventMode = false;
         }
 
@@ -306,27 +319,35 @@ void AutomationCurveClipComponent::onRemoveMidiEvent(const MidiEvent &event)
     if (event.getSequence() == this->sequence)
     {
         const AutomationEvent &autoEvent = static_cast<const AutomationEvent &>(event);
-        
-        if (auto *component = this->eventsHash[autoEvent])
+
+        // the component has to go before the event does,
+        // the rest of the handles are updated after that
+        const auto found = this->eventsHash.find(autoEvent);
+        if (found != this->eventsHash.end())
         {
-            //this->eventAnimator.fadeOut(component, Globals::UI::fadeOutShort);
-            this->removeChildComponent(component);
-            this->eventsHash.erase(autoEvent);
-            
-            // update links and connectors for neighbors
-            const int indexOfSorted = this->eventComponents.indexOfSorted(*component, component);
-            auto *previousEventComponent = this->getPreviousEventComponent(indexOfSorted);
-            auto *nextEventComponent = this->getNextEventComponent(indexOfSorted);
-            
-            if (previousEventComponent)
+            auto *component = found->second;
+            this->eventsHash.erase(found);
+
+            if (this->draggingEvent == component)
             {
-                previousEventComponent->setNextNeighbour(nextEventComponent);
+                this->draggingEvent = nullptr;
             }
-            
+
+            this->removeChildComponent(component);
             this->eventComponents.removeObject(component, true);
-            
-            this->roll.triggerBatchRepaintFor(this);
         }
+
+        this->curveNeedsRebuild = true;
+    }
+}
+
+void AutomationCurveClipComponent::onPostRemoveMidiEvent(MidiSequence *const sequence)
+{
+    if (sequence == this->sequence)
+    {
+        this->curveNeedsRebuild = true;
+        this->updateHandles();
+        this->roll.triggerBatchRepaintFor(this);
     }
 }
 
@@ -371,50 +392,194 @@ void AutomationCurveClipComponent::onRemoveTrack(MidiTrack *const track)
 void AutomationCurveClipComponent::updateCurveComponent(AutomationCurveEventComponent *component)
 {
     component->setBounds(this->getEventBounds(component));
-    component->updateConnector();
     component->updateHelper();
 }
 
 void AutomationCurveClipComponent::reloadTrack()
 {
-    for (int i = 0; i < this->eventComponents.size(); ++i)
+    for (auto *component : this->eventComponents)
     {
-        this->removeChildComponent(this->eventComponents.getUnchecked(i));
+        this->removeChildComponent(component);
     }
-    
+
+    this->draggingEvent = nullptr;
     this->eventComponents.clear();
     this->eventsHash.clear();
-    
-    this->setVisible(false);
-    
-    for (int j = 0; j < this->sequence->size(); ++j)
+
+    this->curveNeedsRebuild = true;
+    this->updateHandles();
+    this->roll.triggerBatchRepaintFor(this);
+}
+
+void AutomationCurveClipComponent::rebuildCurveIfNeeded()
+{
+    if (!this->curveNeedsRebuild)
     {
-        MidiEvent *event = this->sequence->getUnchecked(j);
-        
-        if (auto *autoEvent = dynamic_cast<AutomationEvent *>(event))
+        return;
+    }
+
+    this->curveNeedsRebuild = false;
+
+    this->curvePoints.clearQuick();
+    this->eventsPath.clear();
+    this->eventCentresPath.clear();
+    this->helpersPath.clear();
+
+    if (this->sequence == nullptr || this->getWidth() == 0)
+    {
+        return;
+    }
+
+    const auto *autoSequence = this->sequence.get();
+    const float sequenceLength = autoSequence->getLengthInBeats();
+    const float firstBeat = autoSequence->getFirstBeat();
+    const float h = float(this->getHeight());
+
+    const auto getEventBoundsAt = [&](int index)
+    {
+        const auto *e = static_cast<const AutomationEvent *>(autoSequence->getUnchecked(index));
+        return this->getEventBounds(e->getBeat() - firstBeat, sequenceLength, e->getControllerValue());
+    };
+
+    for (int i = 0; i < autoSequence->size(); ++i)
+    {
+        const auto &e1 = static_cast<const AutomationEvent &>(*autoSequence->getUnchecked(i));
+        const auto b1 = getEventBoundsAt(i);
+        const auto c1 = b1.getCentre().toFloat();
+
+        this->eventsPath.addEllipse(b1.toFloat().reduced(AutomationCurveClipComponent::eventCircleMargin));
+        this->eventCentresPath.addEllipse(c1.getX() - 2.f, c1.getY() - 2.f, 4.f, 4.f);
+
+        if (i == autoSequence->size() - 1)
         {
-            auto *component = new AutomationCurveEventComponent(*this, *autoEvent);
-            this->addAndMakeVisible(component);
-            
-            // update links and connectors
-            const int indexOfSorted = this->eventComponents.addSorted(*component, component);
-            auto *previousEventComponent = this->getPreviousEventComponent(indexOfSorted);
-            auto *nextEventComponent = this->getNextEventComponent(indexOfSorted);
-            
-            component->setNextNeighbour(nextEventComponent);
-            //this->updateCurveComponent(component);
-            component->toFront(false);
-            
-            if (previousEventComponent)
+            break;
+        }
+
+        const auto &e2 = static_cast<const AutomationEvent &>(*autoSequence->getUnchecked(i + 1));
+        const auto b2 = getEventBoundsAt(i + 1);
+
+        this->helpersPath.addEllipse(AutomationCurveClipComponent::getHelperBounds(b1.getCentre(),
+            b2.getCentre(), e1.getCurvature()).toFloat());
+
+        const float x1 = c1.getX();
+        const float x2 = float(b2.getCentreX());
+
+        float lastAppliedValue = e1.getControllerValue();
+        float interpolatedBeat = e1.getBeat();
+        while (interpolatedBeat < e2.getBeat())
+        {
+            const float factor = (interpolatedBeat - e1.getBeat()) / (e2.getBeat() - e1.getBeat());
+            const float interpolatedValue =
+                AutomationEvent::interpolateEvents(e1.getControllerValue(),
+                    e2.getControllerValue(), factor, e1.getCurvature());
+
+            const float controllerDelta = fabs(interpolatedValue - lastAppliedValue);
+            if (controllerDelta > AutomationEvent::curveInterpolationThreshold)
             {
-                previousEventComponent->setNextNeighbour(component);
+                this->curvePoints.add({ x1 + (x2 - x1) * factor, h * (1.f - interpolatedValue) });
+                lastAppliedValue = interpolatedValue;
             }
-            
-            this->eventsHash[*autoEvent] = component;
+
+            interpolatedBeat += AutomationEvent::curveInterpolationStepBeat;
         }
     }
+}
 
-    this->resized(); // Re-calculates children bounds
-    this->roll.triggerBatchRepaintFor(this);
-    this->setVisible(true);
+bool AutomationCurveClipComponent::isHandleInUse(AutomationCurveEventComponent *component) const
+{
+    return component == this->draggingEvent ||
+        component->isMouseButtonDown() ||
+        (component->helper != nullptr && component->helper->isMouseButtonDown());
+}
+
+void AutomationCurveClipComponent::updateHandles()
+{
+    Array<const AutomationEvent *> targetEvents;
+
+    if (this->sequence != nullptr && this->handlesCentreX >= 0)
+    {
+        const auto *autoSequence = this->sequence.get();
+        const float sequenceLength = autoSequence->getLengthInBeats();
+        const float firstBeat = autoSequence->getFirstBeat();
+        const float w = float(this->getWidth());
+        const int numEvents = autoSequence->size();
+
+        int firstIndex = numEvents;
+        int lastIndex = -1;
+        for (int i = 0; i < numEvents; ++i)
+        {
+            const auto beat = autoSequence->getUnchecked(i)->getBeat() - firstBeat;
+            const int x = int(w * (beat / sequenceLength));
+            if (x < this->handlesCentreX - AutomationCurveClipComponent::handlesRadius) { continue; }
+            if (x > this->handlesCentreX + AutomationCurveClipComponent::handlesRadius) { break; }
+            firstIndex = jmin(firstIndex, i);
+            lastIndex = i;
+        }
+
+        // with one more event on each side, so that the curvature
+        // helpers around the nearby events are interactive as well
+        if (lastIndex >= firstIndex)
+        {
+            for (int i = jmax(0, firstIndex - 1); i < jmin(numEvents, lastIndex + 2); ++i)
+            {
+                targetEvents.add(static_cast<const AutomationEvent *>(autoSequence->getUnchecked(i)));
+            }
+        }
+    }
+
+    for (int i = this->eventComponents.size(); --i >= 0;)
+    {
+        auto *component = this->eventComponents.getUnchecked(i);
+        if (!targetEvents.contains(&component->getEvent()) && !this->isHandleInUse(component))
+        {
+            this->eventsHash.erase(component->getEvent());
+            this->removeChildComponent(component);
+            this->eventComponents.remove(i, true);
+        }
+    }
+
+    for (const auto *event : targetEvents)
+    {
+        if (!this->eventsHash.contains(*event))
+        {
+            auto *component = new AutomationCurveEventComponent(*this, *event);
+            this->eventComponents.add(component);
+            this->eventsHash[*event] = component;
+            this->addAndMakeVisible(component);
+        }
+    }
+
+    this->linkHandles();
+}
+
+void AutomationCurveClipComponent::linkHandles()
+{
+    if (this->eventComponents.isEmpty())
+    {
+        return;
+    }
+
+    this->eventComponents.sort(*this->eventComponents.getFirst());
+
+    for (auto *component : this->eventComponents)
+    {
+        component->setBounds(this->getEventBounds(component));
+    }
+
+    // only the handles of the adjacent events are connected by a helper
+    const auto *autoSequence = this->sequence.get();
+    for (int i = 0; i < this->eventComponents.size(); ++i)
+    {
+        auto *component = this->eventComponents.getUnchecked(i);
+        auto *next = this->eventComponents[i + 1];
+        if (next != nullptr && autoSequence != nullptr &&
+            autoSequence->indexOfSorted(&next->getEvent()) !=
+                autoSequence->indexOfSorted(&component->getEvent()) + 1)
+        {
+            next = nullptr;
+        }
+
+        component->setNextNeighbour(next);
+        component->toFront(false);
+    }
 }
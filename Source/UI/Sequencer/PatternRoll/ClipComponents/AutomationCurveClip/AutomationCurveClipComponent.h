@@ -45,6 +45,9 @@ public:
     void mouseDown(const MouseEvent &e) override;
     void mouseDrag(const MouseEvent &e) override;
     void mouseUp(const MouseEvent &e) override;
+    void mouseMove(const MouseEvent &e) override;
+    void mouseExit(const MouseEvent &e) override;
+    void paint(Graphics &g) override;
     void resized() override;
     void mouseWheelMove(const MouseEvent &event, const MouseWheelDetails &wheel) override;
 
@@ -56,6 +59,7 @@ public:
         const MidiEvent &newEvent) override;
     void onAddMidiEvent(const MidiEvent &event) override;
     void onRemoveMidiEvent(const MidiEvent &event) override;
+    void onPostRemoveMidiEvent(MidiSequence *const sequence) override;
 
     // TODO! As a part of `automation editors` story
     void onAddClip(const Clip &clip) override {}
@@ -89,8 +93,11 @@ protected:
     static constexpr auto helperComponentDiameter = 20.f;
 #endif
 
-    AutomationCurveEventComponent *getPreviousEventComponent(int indexOfSorted) const;
-    AutomationCurveEventComponent *getNextEventComponent(int indexOfSorted) const;
+    static constexpr auto eventCircleMargin = 2.f;
+
+    // the curvature helper sits between the two events' centres
+    static Rectangle<int> getHelperBounds(const Point<int> &c1,
+        const Point<int> &c2, float curvature);
 
     friend class AutomationCurveEventComponent;
 
@@ -102,6 +109,25 @@ private:
     ProjectNode &project;
     WeakReference<MidiSequence> sequence;
 
+    // the whole curve, with all the events and the curvature helpers,
+    // is painted by this component, and is only rebuilt when the sequence
+    // or the size changes; the interactive components are only created
+    // for the few events around the mouse pointer, since the tempo and
+    // the controller tracks may have thousands of them
+    Array<Point<float>> curvePoints;
+    Path eventsPath;
+    Path eventCentresPath;
+    Path helpersPath;
+    RectangleList<float> curveBatch;
+    bool curveNeedsRebuild = true;
+    void rebuildCurveIfNeeded();
+
+    static constexpr auto handlesRadius = 48;
+    int handlesCentreX = -1;
+    void updateHandles();
+    void linkHandles();
+    bool isHandleInUse(AutomationCurveEventComponent *component) const;
+
     OwnedArray<AutomationCurveEventComponent> eventComponents;
     FlatHashMap<AutomationEvent, AutomationCurveEventComponent *, MidiEventHash> eventsHash;
 
@@ -20,7 +20,6 @@
 
 #include "AutomationCurveClipComponent.h"
 #include "AutomationCurveHelper.h"
-#include "AutomationCurveEventsConnector.h"
 #include "AutomationSequence.h"
 #include "MidiTrack.h"
 
@@ -41,7 +40,6 @@ AutomationCurveEventComponent::AutomationCurveEventComponent(AutomationCurveClip
     this->setInterceptsMouseClicks(true, false);
     this->setMouseClickGrabsKeyboardFocus(false);
     this->setPaintingIsUnclipped(true);
-    this->recreateConnector();
 }
 
 bool AutomationCurveEventComponent::isTempoCurve() const noexcept
@@ -49,9 +47,11 @@ bool AutomationCurveEventComponent::isTempoCurve() const noexcept
     return this->controllerNumber == MidiTrack::tempoController;
 }
 
+// the event's circle itself is painted by the clip,
+// this only adds the hover and the dragging indicators
 void AutomationCurveEventComponent::paint(Graphics &g)
 {
-    static constexpr auto circleMargin = 2.f;
+    static constexpr auto circleMargin = AutomationCurveClipComponent::eventCircleMargin;
     const auto centre = this->getLocalBounds().getCentre();
 
     if (this->draggingState)
@@ -85,11 +85,6 @@ void AutomationCurveEventComponent::paint(Graphics &g)
         g.fillRect(centre.x - 1.f, 0.f, 2.f, 1.f);
         g.fillRect(centre.x - 1.f, float(this->getHeight() - 1), 2.f, 1.f);
     }
-
-    g.fillEllipse(centre.x - 2.f, centre.y - 2.f, 4.f, 4.f);
-    g.fillEllipse(circleMargin, circleMargin,
-        float(this->getWidth()) - circleMargin * 2.f,
-        float(this->getHeight()) - circleMargin * 2.f);
 }
 
 bool AutomationCurveEventComponent::hitTest(int x, int y)
@@ -222,13 +217,6 @@ void AutomationCurveEventComponent::mouseUp(const MouseEvent &e)
     }
 }
 
-void AutomationCurveEventComponent::recreateConnector()
-{
-    this->connector = make<AutomationCurveEventsConnector>(this, this->nextEventHolder);
-    this->editor.addAndMakeVisible(this->connector.get());
-    this->updateConnector();
-}
-
 void AutomationCurveEventComponent::recreateHelper()
 {
     this->helper = make<AutomationCurveHelper>(this->event, this->editor, this, this->nextEventHolder);
@@ -236,21 +224,13 @@ void AutomationCurveEventComponent::recreateHelper()
     this->updateHelper();
 }
 
-void AutomationCurveEventComponent::updateConnector()
-{
-    this->connector->resizeToFit(this->event.getCurvature());
-}
-
 void AutomationCurveEventComponent::updateHelper()
 {
     if (this->helper && this->nextEventHolder)
     {
-        const float d = AutomationCurveClipComponent::helperComponentDiameter;
-        const Point<int> linePos(this->connector->getPosition());
-        const Point<float> lineCentre(this->connector->getCentrePoint());
-        Rectangle<int> bounds(linePos.getX() + int(lineCentre.getX()) - int(d / 2),
-            linePos.getY() + int(lineCentre.getY() + 0.5f - (d / 2.f)), int(d), int(d));
-        this->helper->setBounds(bounds);
+        this->helper->setBounds(AutomationCurveClipComponent::getHelperBounds(
+            this->getBounds().getCentre(), this->nextEventHolder->getBounds().getCentre(),
+            this->event.getCurvature()));
     }
 }
 
@@ -258,13 +238,11 @@ void AutomationCurveEventComponent::setNextNeighbour(AutomationCurveEventCompone
 {
     if (next == this->nextEventHolder)
     {
-        this->updateConnector();
         this->updateHelper();
         return;
     }
 
     this->nextEventHolder = next;
-    this->recreateConnector();
 
     if (this->nextEventHolder == nullptr)
     {
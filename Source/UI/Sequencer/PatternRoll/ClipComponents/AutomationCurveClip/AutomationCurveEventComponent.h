@@ -22,7 +22,6 @@
 #include "FineTuningValueIndicator.h"
 #include "ComponentFader.h"
 
-class AutomationCurveEventsConnector;
 class AutomationCurveHelper;
 class AutomationCurveClipComponent;
 
@@ -48,7 +47,6 @@ public:
         return this->event;
     };
 
-    void updateConnector();
     void updateHelper();
     void setNextNeighbour(AutomationCurveEventComponent *next);
 
@@ -93,10 +91,8 @@ private:
     const int controllerNumber;
     bool isTempoCurve() const noexcept;
 
-    void recreateConnector();
     void recreateHelper();
 
-    UniquePointer<AutomationCurveEventsConnector> connector;
     UniquePointer<AutomationCurveHelper> helper;
     SafePointer<AutomationCurveEventComponent> nextEventHolder;
 
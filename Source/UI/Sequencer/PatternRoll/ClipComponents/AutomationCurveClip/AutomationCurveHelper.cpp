@@ -36,10 +36,9 @@ AutomationCurveHelper::AutomationCurveHelper(const AutomationEvent &event,
     this->setPaintingIsUnclipped(true);
 }
 
+// the helper's circle itself is painted by the clip
 void AutomationCurveHelper::paint(Graphics &g)
 {
-    g.fillEllipse(0.f, 0.f, float(this->getWidth()), float(this->getHeight()));
-
     if (this->draggingState)
     {
         g.fillEllipse(0.f, 0.f, float(this->getWidth()), float(this->getHeight()));
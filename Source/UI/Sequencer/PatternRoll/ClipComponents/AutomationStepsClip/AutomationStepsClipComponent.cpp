@@ -38,7 +38,7 @@ AutomationStepsClipComponent::AutomationStepsClipComponent(ProjectNode &project,
 
     this->reloadTrack();
 
-    this->project.addListener(this);
+    this->project.addListener(this, sequence);
 }
 
 AutomationStepsClipComponent::~AutomationStepsClipComponent()
@@ -125,12 +125,12 @@ void ClipComponent::mouseDown(const MouseEvent &e)
     const auto &selection = this->roll.getLassoSelection();
     if (e.mods.isLeftButtonDown())
     {
-        this->dragger.startDraggingComponent(this, e);
-
         forEachSelectedClip(selection, clipComponent)
         {
             clipComponent->startDragging();
         }
+
+        this->dragOffsetX = e.position.x;
     }
     else if (e.mods.isMiddleButtonDown())
     {
@@ -171,7 +171,6 @@ void ClipComponent::mouseDrag(const MouseEvent &e)
     {
         float deltaBeat = 0.f;
         const bool eventChanged = this->getDraggingDelta(e, deltaBeat);
-        this->setFloatBounds(this->getRoll().getEventBounds(this));
 
         if (eventChanged)
         {
@@ -192,10 +191,12 @@ void ClipComponent::mouseDrag(const MouseEvent &e)
                 this->getRoll().updateHighlightedInstances();
             }
 
+            // the clips are only moved visually until the mouse is released,
+            // so that the transport, the thumbnails and the minimaps
+            // don't have to catch up with every mouse move
             forEachSelectedClip(selection, clipComponent)
             {
-                clipComponent->getClip().getPattern()->change(clipComponent->getClip(),
-                    clipComponent->continueDragging(deltaBeat), true);
+                clipComponent->updateDragPreview(deltaBeat);
             }
         }
     }
@@ -232,8 +233,6 @@ void ClipComponent::mouseUp(const MouseEvent &e)
 
     if (this->state == State::Dragging)
     {
-        this->setFloatBounds(this->getRoll().getEventBounds(this));
-
         forEachSelectedClip(selection, clipComponent)
         {
             clipComponent->endDragging();
@@ -422,6 +421,8 @@ void ClipComponent::startDragging()
     this->firstChangeDone = false;
     this->state = State::Dragging;
     this->anchor = this->getClip();
+    this->dragOffsetX = 0.f;
+    this->dragPreviewDeltaBeat = 0.f;
 }
 
 bool ClipComponent::isDragging() const noexcept
@@ -431,12 +432,14 @@ bool ClipComponent::isDragging() const noexcept
 
 bool ClipComponent::getDraggingDelta(const MouseEvent &e, float &deltaBeat)
 {
-    this->dragger.dragComponent(this, e, nullptr);
+    // the roll's coordinates don't depend on the preview transform,
+    // and the component itself stays where the model says it is
+    const auto x = e.getEventRelativeTo(&this->roll).position.x - this->dragOffsetX;
     const float newBeat =
         this->getRoll().getBeatForClipByXPosition(this->clip,
-            this->getX() + this->floatLocalBounds.getX() + 1);
+            float(int(x)) + this->floatLocalBounds.getX() + 1);
     deltaBeat = (newBeat - this->anchor.getBeat());
-    return this->getBeat() != newBeat;
+    return deltaBeat != this->dragPreviewDeltaBeat;
 }
 
 Clip ClipComponent::continueDragging(float deltaBeat)
@@ -445,9 +448,29 @@ Clip ClipComponent::continueDragging(float deltaBeat)
     return this->getClip().withBeat(newBeat);
 }
 
+void ClipComponent::updateDragPreview(float deltaBeat)
+{
+    this->dragPreviewDeltaBeat = deltaBeat;
+
+    const auto &roll = this->getRoll();
+    const auto deltaX = roll.getEventBounds(this->continueDragging(deltaBeat)).getX() -
+        roll.getEventBounds(this->clip).getX();
+
+    this->setTransform(AffineTransform::translation(deltaX, 0.f));
+}
+
 void ClipComponent::endDragging()
 {
     this->state = State::None;
+    this->setTransform({});
+
+    // the whole drag is applied to the model at once
+    if (this->dragPreviewDeltaBeat != 0.f)
+    {
+        const auto newClip = this->continueDragging(this->dragPreviewDeltaBeat);
+        this->dragPreviewDeltaBeat = 0.f;
+        this->clip.getPattern()->change(this->clip, newClip, true);
+    }
 }
 
 //===----------------------------------------------------------------------===//
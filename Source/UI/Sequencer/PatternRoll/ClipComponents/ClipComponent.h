@@ -86,8 +86,14 @@ protected:
     bool isDragging() const noexcept;
     bool getDraggingDelta(const MouseEvent &e, float &deltaBeat);
     Clip continueDragging(float deltaBeat);
+    void updateDragPreview(float deltaBeat);
     void endDragging();
 
+    // the mouse position within the dragged clip at the mouse down,
+    // and the beat offset shown by the transform, but not yet applied
+    float dragOffsetX = 0.f;
+    float dragPreviewDeltaBeat = 0.f;
+
     void startTuning();
     Clip continueTuning(const MouseEvent &e) const noexcept;
     Clip continueTuningLinear(float delta) const noexcept;
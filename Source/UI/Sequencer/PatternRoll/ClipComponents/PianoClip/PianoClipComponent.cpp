@@ -34,8 +34,8 @@ PianoClipComponent::PianoClipComponent(ProjectNode &project, MidiSequence *seque
     sequence(sequence)
 {
     this->setPaintingIsUnclipped(true);
-    this->reloadTrackMap();
-    this->project.addListener(this);
+    this->keyboardSize = this->project.getProjectInfo()->getKeyboardSize();
+    this->project.addListener(this, sequence);
 }
 
 PianoClipComponent::~PianoClipComponent()
@@ -52,18 +52,17 @@ void PianoClipComponent::paint(Graphics &g)
     // Draw the frame, set the colour, etc:
     ClipComponent::paint(g);
 
-    for (const auto &note : this->displayedNotes)
+    // the piano clips are only created for the piano sequences
+    const auto *pianoSequence = static_cast<const PianoSequence *>(this->sequence.get());
+    if (pianoSequence == nullptr)
     {
-        const auto *ns = note.getSequence();
-        const float sequenceLength = ns->getLengthInBeats();
-        const float beat = note.getBeat() - ns->getFirstBeat();
-        const auto key = jlimit(0, this->keyboardSize, note.getKey() + this->clip.getKey());
-        const float x = static_cast<float>(this->getWidth()) * (beat / sequenceLength);
-        const float w = static_cast<float>(this->getWidth()) * (note.getLength() / sequenceLength);
-        const float h = static_cast<float>(this->getHeight());
-        const int y = static_cast<int>(h - key * h / static_cast<float>(this->keyboardSize));
-        g.fillRect(x, static_cast<float>(y), jmax(0.25f, w), 1.f);
+        return;
     }
+
+    const auto thumbnail = this->getRoll().getPianoClipThumbnail(*pianoSequence,
+        this->clip.getKey(), this->keyboardSize, this->getWidth(), this->getHeight());
+
+    g.drawImageAt(thumbnail, 0, 0, true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -72,46 +71,24 @@ void PianoClipComponent::paint(Graphics &g)
 
 void PianoClipComponent::onChangeMidiEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent)
 {
-    if (oldEvent.isTypeOf(MidiEvent::Type::Note))
+    if (newEvent.getSequence() == this->sequence)
     {
-        const Note &note = static_cast<const Note &>(oldEvent);
-        const Note &newNote = static_cast<const Note &>(newEvent);
-        if (newNote.getSequence() != this->sequence) { return; }
-
-        if (this->displayedNotes.contains(note))
-        {
-            this->displayedNotes.erase(note);
-            this->displayedNotes.insert(newNote);
-        }
-
         this->roll.triggerBatchRepaintFor(this);
     }
 }
 
 void PianoClipComponent::onAddMidiEvent(const MidiEvent &event)
 {
-    if (event.isTypeOf(MidiEvent::Type::Note))
+    if (event.getSequence() == this->sequence)
     {
-        const Note &note = static_cast<const Note &>(event);
-        if (note.getSequence() != this->sequence) { return; }
-
-        this->displayedNotes.insert(note);
         this->roll.triggerBatchRepaintFor(this);
     }
 }
 
 void PianoClipComponent::onRemoveMidiEvent(const MidiEvent &event)
 {
-    if (event.isTypeOf(MidiEvent::Type::Note))
+    if (event.getSequence() == this->sequence)
     {
-        const Note &note = static_cast<const Note &>(event);
-        if (note.getSequence() != this->sequence) { return; }
-
-        if (this->displayedNotes.contains(note))
-        {
-            this->displayedNotes.erase(note);
-        }
-
         this->roll.triggerBatchRepaintFor(this);
     }
 }
@@ -134,10 +111,8 @@ void PianoClipComponent::onChangeTrackProperties(MidiTrack *const track)
 void PianoClipComponent::onReloadProjectContent(const Array<MidiTrack *> &tracks,
     const ProjectMetadata *meta)
 {
-    if (this->sequence != nullptr)
-    {
-        this->reloadTrackMap();
-    }
+    this->keyboardSize = this->project.getProjectInfo()->getKeyboardSize();
+    this->roll.triggerBatchRepaintFor(this);
 }
 
 void PianoClipComponent::onChangeProjectInfo(const ProjectMetadata *info)
@@ -154,51 +129,14 @@ void PianoClipComponent::onAddTrack(MidiTrack *const track)
     if (track->getSequence() == this->sequence &&
         track->getSequence()->size() > 0)
     {
-        this->reloadTrackMap();
         this->roll.triggerBatchRepaintFor(this);
     }
 }
 
-void PianoClipComponent::onRemoveTrack(MidiTrack *const track)
-{
-    if (track->getSequence() != this->sequence) { return; }
-
-    for (int i = 0; i < track->getSequence()->size(); ++i)
-    {
-        const Note &note = static_cast<const Note &>(*track->getSequence()->getUnchecked(i));
-        if (this->displayedNotes.contains(note))
-        {
-            this->displayedNotes.erase(note);
-        }
-    }
-}
-
 //===----------------------------------------------------------------------===//
 // Private
 //===----------------------------------------------------------------------===//
 
-void PianoClipComponent::reloadTrackMap()
-{
-    this->keyboardSize = this->project.getProjectInfo()->getKeyboardSize();
-
-    this->displayedNotes.clear();
-
-    for (auto *track : this->project.getTracks())
-    {
-        if (track->getSequence() != this->sequence) { continue; }
-
-        for (int j = 0; j < track->getSequence()->size(); ++j)
-        {
-            auto *event = track->getSequence()->getUnchecked(j);
-            if (event != nullptr && event->isTypeOf(MidiEvent::Type::Note))
-            {
-                auto *note = static_cast<Note *>(event);
-                this->displayedNotes.insert(*note);
-            }
-        }
-    }
-}
-
 void PianoClipComponent::setShowRecordingMode(bool isRecording)
 {
     this->flags.isRecordingTarget = isRecording;
@@ -55,7 +55,7 @@ public:
     void onRemoveClip(const Clip &clip) override {}
 
     void onAddTrack(MidiTrack *const track) override;
-    void onRemoveTrack(MidiTrack *const track) override;
+    void onRemoveTrack(MidiTrack *const track) override {}
     void onChangeTrackProperties(MidiTrack *const track) override;
 
     void onChangeProjectBeatRange(float firstBeat, float lastBeat) override {}
@@ -66,11 +66,8 @@ public:
 
 private:
 
-    void reloadTrackMap();
-
     ProjectNode &project;
     WeakReference<MidiSequence> sequence;
-    FlatHashSet<Note, MidiEventHash> displayedNotes;
 
     int keyboardSize = Globals::twelveToneKeyboardSize;
 
@@ -112,10 +112,13 @@ PatternRoll::PatternRoll(ProjectNode &parentProject,
 
 void PatternRoll::selectAll()
 {
+    Lasso::ItemArray items;
     for (const auto &e : this->clipComponents)
     {
-        this->selection.addToSelection(e.second.get());
+        items.add(e.second.get());
     }
+
+    this->selection.selectAll(items);
 }
 
 static ClipComponent *createClipComponentFor(MidiTrack *track,
@@ -147,6 +150,7 @@ void PatternRoll::reloadRollContent()
 {
     this->selection.deselectAll();
     this->clipComponents.clear();
+    this->pianoClipThumbnails.clear();
     this->tracks.clearQuick();
     this->rows.clearQuick();
 
@@ -313,6 +317,91 @@ float PatternRoll::getBeatByMousePosition(const Pattern *pattern, int x) const
     return this->getFloorBeatSnapByXPosition(x) - sequence->getFirstBeat();
 }
 
+//===----------------------------------------------------------------------===//
+// Clip thumbnails
+//===----------------------------------------------------------------------===//
+
+Image PatternRoll::getPianoClipThumbnail(const PianoSequence &sequence,
+    int keyOffset, int keyboardSize, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return {};
+    }
+
+    const auto notes = sequence.getPackedNotes();
+    const auto firstBeat = sequence.getFirstBeat();
+    const auto lengthInBeats = sequence.getLengthInBeats();
+
+    auto &thumbnails = this->pianoClipThumbnails[&sequence];
+
+    for (const auto &thumbnail : thumbnails)
+    {
+        if (thumbnail.notes == notes &&
+            thumbnail.firstBeat == firstBeat &&
+            thumbnail.lengthInBeats == lengthInBeats &&
+            thumbnail.keyOffset == keyOffset &&
+            thumbnail.keyboardSize == keyboardSize &&
+            thumbnail.width == width &&
+            thumbnail.height == height)
+        {
+            return thumbnail.image;
+        }
+    }
+
+    // the ones rendered for the previous versions won't be needed again
+    for (int i = thumbnails.size(); --i >= 0;)
+    {
+        if (thumbnails.getReference(i).notes != notes)
+        {
+            thumbnails.remove(i);
+        }
+    }
+
+    if (thumbnails.size() >= PatternRoll::maxThumbnailsPerSequence)
+    {
+        thumbnails.remove(0);
+    }
+
+    PianoClipThumbnail thumbnail;
+    thumbnail.notes = notes;
+    thumbnail.firstBeat = firstBeat;
+    thumbnail.lengthInBeats = lengthInBeats;
+    thumbnail.keyOffset = keyOffset;
+    thumbnail.keyboardSize = keyboardSize;
+    thumbnail.width = width;
+    thumbnail.height = height;
+    thumbnail.image = PatternRoll::renderPianoClipThumbnail(thumbnail);
+
+    thumbnails.add(thumbnail);
+    return thumbnail.image;
+}
+
+Image PatternRoll::renderPianoClipThumbnail(const PianoClipThumbnail &thumbnail)
+{
+    Image image(Image::SingleChannel, thumbnail.width, thumbnail.height, true);
+    Graphics g(image);
+    g.setColour(Colours::white);
+
+    const auto &notes = *thumbnail.notes;
+    const float w = float(thumbnail.width);
+    const float h = float(thumbnail.height);
+    const float keyboardSize = float(thumbnail.keyboardSize);
+
+    for (int i = 0; i < notes.size(); ++i)
+    {
+        const float beat = notes.beats.getUnchecked(i) - thumbnail.firstBeat;
+        const auto key = jlimit(0, thumbnail.keyboardSize,
+            notes.keys.getUnchecked(i) + thumbnail.keyOffset);
+        const float x = w * (beat / thumbnail.lengthInBeats);
+        const float noteWidth = w * (notes.lengths.getUnchecked(i) / thumbnail.lengthInBeats);
+        const int y = int(h - key * h / keyboardSize);
+        g.fillRect(x, float(y), jmax(0.25f, noteWidth), 1.f);
+    }
+
+    return image;
+}
+
 //===----------------------------------------------------------------------===//
 // ProjectListener
 //===----------------------------------------------------------------------===//
@@ -388,6 +477,11 @@ void PatternRoll::onRemoveTrack(MidiTrack *const track)
     this->tracks.removeAllInstancesOf(track);
     this->reloadRowsGrouping();
 
+    if (auto *pianoSequence = dynamic_cast<PianoSequence *>(track->getSequence()))
+    {
+        this->pianoClipThumbnails.erase(pianoSequence);
+    }
+
     if (Pattern *pattern = track->getPattern())
     {
         for (int i = 0; i < pattern->size(); ++i)
@@ -457,7 +551,7 @@ void PatternRoll::onReloadProjectContent(const Array<MidiTrack *> &tracks,
 }
 
 //===----------------------------------------------------------------------===//
-// LassoSource
+// Lasso
 //===----------------------------------------------------------------------===//
 
 void PatternRoll::selectEventsInRange(float startBeat, float endBeat, bool shouldClearAllOthers)
@@ -484,7 +578,9 @@ void PatternRoll::findLassoItemsInArea(Array<SelectableComponent *> &itemsFound,
     for (const auto &e : this->clipComponents)
     {
         const auto component = e.second.get();
-        if (rectangle.intersects(component->getBounds()) && component->isActive())
+        // not the component's bounds, which may be stale offscreen
+        if (rectangle.intersects(this->getEventBounds(component).getSmallestIntegerContainer()) &&
+            component->isActive())
         {
             jassert(!itemsFound.contains(component));
             itemsFound.add(component);
@@ -901,10 +997,12 @@ void PatternRoll::resized()
 
     ROLL_BATCH_REPAINT_START
 
+    this->offscreenEventComponents.clearQuick();
+    const auto layoutArea = this->getEventsLayoutArea();
+
     for (const auto &e : this->clipComponents)
     {
-        const auto c = e.second.get();
-        c->setFloatBounds(this->getEventBounds(c));
+        this->updateEventBoundsIfVisible(e.second.get(), layoutArea);
     }
 
     if (this->knifeToolHelper != nullptr)
@@ -936,14 +1034,12 @@ float PatternRoll::findNextAnchorBeat(float beat) const
     float result = this->getLastBeat();
     for (const auto *track : this->tracks)
     {
+        const auto *pattern = track->getPattern();
         const float sequenceStart = track->getSequence()->getFirstBeat();
-        for (const auto *clip : track->getPattern()->getClips())
+        const auto index = pattern->indexOfFirstClipStartingAfter(beat - sequenceStart);
+        if (index < pattern->size())
         {
-            const auto clipStart = clip->getBeat() + sequenceStart;
-            if (clipStart > beat)
-            {
-                result = jmin(clipStart, result);
-            }
+            result = jmin(pattern->getUnchecked(index)->getBeat() + sequenceStart, result);
         }
     }
 
@@ -955,14 +1051,12 @@ float PatternRoll::findPreviousAnchorBeat(float beat) const
     float result = this->getFirstBeat();
     for (const auto *track : this->tracks)
     {
+        const auto *pattern = track->getPattern();
         const float sequenceStart = track->getSequence()->getFirstBeat();
-        for (const auto *clip : track->getPattern()->getClips())
+        const auto index = pattern->indexOfFirstClipStartingFrom(beat - sequenceStart);
+        if (index > 0)
         {
-            const auto clipStart = clip->getBeat() + sequenceStart;
-            if (clipStart < beat)
-            {
-                result = jmax(clipStart, result);
-            }
+            result = jmax(pattern->getUnchecked(index - 1)->getBeat() + sequenceStart, result);
         }
     }
 
@@ -1015,7 +1109,7 @@ void PatternRoll::insertNewClipAt(const MouseEvent &e)
         if (trackKey == rowKey)
         {
             const float clickBeat = this->getBeatByMousePosition(track->getPattern(), e.x);
-            for (const auto *clip : track->getPattern()->getClips())
+            if (const auto *clip = track->getPattern()->findClosestClip(clickBeat))
             {
                 const auto clipStartDistance = fabs(clickBeat - clip->getBeat());
                 if (nearestClipdistance > clipStartDistance)
@@ -24,6 +24,7 @@ class MergingClipsConnector;
 #include "HelioTheme.h"
 #include "RollBase.h"
 #include "MidiTrack.h"
+#include "PianoSequence.h"
 #include "Pattern.h"
 #include "Clip.h"
 
@@ -49,6 +50,16 @@ public:
     float getBeatForClipByXPosition(const Clip &clip, float x) const;
     float getBeatByMousePosition(const Pattern *pattern, int x) const;
 
+    //===------------------------------------------------------------------===//
+    // Clip thumbnails
+    //===------------------------------------------------------------------===//
+
+    // the clips of the same sequence are often of the same size, e.g. when
+    // it is looped, so they share the rendered notes instead of each drawing
+    // all of them on every repaint; the image is an alpha mask to fill
+    Image getPianoClipThumbnail(const PianoSequence &sequence,
+        int keyOffset, int keyboardSize, int width, int height);
+
     //===------------------------------------------------------------------===//
     // ProjectListener
     //===------------------------------------------------------------------===//
@@ -65,7 +76,7 @@ public:
         const ProjectMetadata *meta) override;
 
     //===------------------------------------------------------------------===//
-    // LassoSource
+    // Lasso
     //===------------------------------------------------------------------===//
 
     void selectEventsInRange(float startBeat,
@@ -142,6 +153,25 @@ private:
     static Image renderRowsPattern(const HelioTheme &theme, int height);
     void repaintBackgroundsCache();
 
+    struct PianoClipThumbnail final
+    {
+        // the packed notes are rebuilt after any change of the sequence,
+        // so they work as its version; they are kept referenced here,
+        // so that the new versions can't be allocated at the same address
+        PianoSequence::PackedNotes::Ptr notes;
+        float firstBeat = 0.f;
+        float lengthInBeats = 0.f;
+        int keyOffset = 0;
+        int keyboardSize = 0;
+        int width = 0;
+        int height = 0;
+        Image image;
+    };
+
+    static constexpr auto maxThumbnailsPerSequence = 8;
+    FlatHashMap<const PianoSequence *, Array<PianoClipThumbnail>> pianoClipThumbnails;
+    static Image renderPianoClipThumbnail(const PianoClipThumbnail &thumbnail);
+
     void reloadRollContent();
     void insertNewClipAt(const MouseEvent &e);
 
@@ -47,22 +47,28 @@ PianoRoll &NoteComponent::getRoll() const noexcept
 // Accessors
 //===----------------------------------------------------------------------===//
 
+Colour NoteComponent::getInactiveColour(const Colour &trackColour)
+{
+    const auto base = findDefaultColour(ColourIDs::Roll::noteFill);
+    const auto colour = trackColour
+        .interpolatedWith(base, 0.15f)
+        .withMultipliedSaturationHSL(1.5f)
+        .withAlpha(0.25f);
+
+    return HelioTheme::getCurrentTheme().isDark() ?
+        colour.brighter(0.55f) : colour.darker(0.45f);
+}
+
 void NoteComponent::updateColours()
 {
     const bool ghost = this->flags.isGhost || !this->flags.isActive;
     const auto base = findDefaultColour(ColourIDs::Roll::noteFill);
 
-    this->colour = this->getNote().getTrackColour()
-        .interpolatedWith(base, ghost ? 0.15f : 0.4f)
-        .brighter(this->flags.isSelected ? 1.15f : 0.f)
-        .withMultipliedSaturationHSL(ghost ? 1.5f : 1.f)
-        .withAlpha(ghost ? 0.25f : 0.9f);
-
-    if (ghost)
-    {
-        this->colour = HelioTheme::getCurrentTheme().isDark() ?
-            this->colour.brighter(0.55f) : this->colour.darker(0.45f);
-    }
+    this->colour = ghost ? NoteComponent::getInactiveColour(this->getNote().getTrackColour()) :
+        this->getNote().getTrackColour()
+            .interpolatedWith(base, 0.4f)
+            .brighter(this->flags.isSelected ? 1.15f : 0.f)
+            .withAlpha(0.9f);
 
     this->colourLighter = this->colour.brighter(0.125f).withMultipliedAlpha(1.45f);
     this->colourDarker = this->colour.darker(0.175f).withMultipliedAlpha(1.45f);
@@ -309,7 +315,7 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
                 this->getRoll().setDefaultNoteLength(groupAfter.getLast().getLength());
             }
 
-            SequencerOperations::getPianoSequence(selection)->changeGroup(groupBefore, groupAfter, true);
+            this->previewGroupChange(selection, groupBefore, groupAfter);
         }
         else
         {
@@ -333,7 +339,7 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
                 this->getRoll().setDefaultNoteLength(groupAfter.getLast().getLength());
             }
                 
-            SequencerOperations::getPianoSequence(selection)->changeGroup(groupBefore, groupAfter, true);
+            this->previewGroupChange(selection, groupBefore, groupAfter);
         }
         else
         {
@@ -357,7 +363,7 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
                 this->getRoll().setDefaultNoteLength(groupAfter.getLast().getLength());
             }
 
-            SequencerOperations::getPianoSequence(selection)->changeGroup(groupBefore, groupAfter, true);
+            this->previewGroupChange(selection, groupBefore, groupAfter);
         }
         else
         {
@@ -380,7 +386,7 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
                 groupAfter.add(noteComponent->continueGroupScalingRight(groupScaleFactor));
             }
                 
-            SequencerOperations::getPianoSequence(selection)->changeGroup(groupBefore, groupAfter, true);
+            this->previewGroupChange(selection, groupBefore, groupAfter);
         }
         else
         {
@@ -403,7 +409,7 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
                 groupAfter.add(noteComponent->continueGroupScalingLeft(groupScaleFactor));
             }
                 
-            SequencerOperations::getPianoSequence(selection)->changeGroup(groupBefore, groupAfter, true);
+            this->previewGroupChange(selection, groupBefore, groupAfter);
         }
         else
         {
@@ -467,7 +473,7 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
                 groupAfter.add(noteComponent->continueDragging(deltaBeat, deltaKey, shouldSendMidi));
             }
                 
-            SequencerOperations::getPianoSequence(selection)->changeGroup(groupBefore, groupAfter, true);
+            this->previewGroupChange(selection, groupBefore, groupAfter);
         }
     }
     else if (this->state == State::Tuning)
@@ -482,12 +488,15 @@ void NoteComponent::mouseDrag(const MouseEvent &e)
             this->getRoll().setDefaultNoteVolume(groupAfter.getLast().getVelocity());
         }
 
-        SequencerOperations::getPianoSequence(selection)->changeGroup(groupBefore, groupAfter, true);
+        this->previewGroupChange(selection, groupBefore, groupAfter);
     }
 }
 
 void NoteComponent::mouseUp(const MouseEvent &e)
 {
+    // whatever has been changed during the drag is one undo action
+    this->commitGroupChange(this->roll.getLassoSelection());
+
     if (this->shouldGoQuickSelectLayerMode(e.mods))
     {
         return;
@@ -591,24 +600,26 @@ void NoteComponent::paint(Graphics &g) noexcept
     const float h = this->floatLocalBounds.getHeight();
     const float x = this->floatLocalBounds.getX();
     const float y = this->floatLocalBounds.getY();
-    
+
     g.setColour(this->colour);
-    g.fillRect(x + 0.5f, y + h / 6.f, 0.5f, h / 1.5f);
 
-    if (w >= 1.25f)
+    // zoomed out that far, the edges and the bevels would be sub-pixel,
+    // so the note is just a single rectangle
+    if (w < NoteComponent::lowDetailWidth)
     {
-        g.fillRect(x + w - 0.75f, y + h / 6.f, 0.5f, h / 1.5f);
-        g.fillRect(x + 0.75f, y + 0.75f, w - 1.25f, h - 1.5f);
+        g.fillRect(x + 0.5f, y + 0.75f, jmax(0.5f, w - 0.75f), h - 1.5f);
+        return;
     }
 
-    if (w >= 2.25f)
-    {
-        g.setColour(this->colourLighter);
-        g.fillRect(x + 1.25f, roundf(y), w - 2.25f, 1.f);
+    g.fillRect(x + 0.5f, y + h / 6.f, 0.5f, h / 1.5f);
+    g.fillRect(x + w - 0.75f, y + h / 6.f, 0.5f, h / 1.5f);
+    g.fillRect(x + 0.75f, y + 0.75f, w - 1.25f, h - 1.5f);
 
-        g.setColour(this->colourDarker);
-        g.fillRect(x + 1.25f, roundf(y + h - 1), w - 2.25f, 1.f);
-    }
+    g.setColour(this->colourLighter);
+    g.fillRect(x + 1.25f, roundf(y), w - 2.25f, 1.f);
+
+    g.setColour(this->colourDarker);
+    g.fillRect(x + 1.25f, roundf(y + h - 1), w - 2.25f, 1.f);
 
     if (w >= 6.f)
     {
@@ -1081,6 +1092,43 @@ void NoteComponent::checkpointIfNeeded()
     }
 }
 
+void NoteComponent::previewGroupChange(const Lasso &selection,
+    Array<Note> &groupBefore, Array<Note> &groupAfter)
+{
+    if (this->groupBeforeInteractiveChange.isEmpty())
+    {
+        this->groupBeforeInteractiveChange.addArray(groupBefore);
+    }
+
+    auto *sequence = SequencerOperations::getPianoSequence(selection);
+    sequence->previewGroupChange(groupBefore, groupAfter);
+    this->getRoll().onPreviewNoteChanges(groupAfter, sequence->getTrack());
+}
+
+void NoteComponent::commitGroupChange(const Lasso &selection)
+{
+    if (this->groupBeforeInteractiveChange.isEmpty())
+    {
+        return;
+    }
+
+    Array<Note> groupBefore, groupAfter;
+    groupBefore.swapWith(this->groupBeforeInteractiveChange);
+
+    forEachSelectedNote(selection, noteComponent)
+    {
+        groupAfter.add(noteComponent->getNote());
+    }
+
+    // the selection is not supposed to change while dragging
+    jassert(groupBefore.size() == groupAfter.size());
+    if (groupBefore.size() == groupAfter.size())
+    {
+        SequencerOperations::getPianoSequence(selection)->
+            commitGroupChange(groupBefore, groupAfter);
+    }
+}
+
 void NoteComponent::stopSound()
 {
     const auto &trackId = this->getNote().getSequence()->getTrackId();
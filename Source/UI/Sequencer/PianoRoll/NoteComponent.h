@@ -18,6 +18,7 @@
 #pragma once
 
 class PianoRoll;
+class Lasso;
 class MidiTrack;
 
 #include "MidiEventComponent.h"
@@ -57,6 +58,12 @@ public:
 
     void updateColours() override;
 
+    // the roll paints the inactive clips' notes by itself, in the same colour
+    static Colour getInactiveColour(const Colour &trackColour);
+
+    // narrower notes are painted as plain rectangles, without the bevels
+    static constexpr float lowDetailWidth = 2.25f;
+
     //===------------------------------------------------------------------===//
     // MidiEventComponent
     //===------------------------------------------------------------------===//
@@ -212,6 +219,12 @@ private:
     bool firstChangeDone = false;
     void checkpointIfNeeded();
 
+    // the drag steps are only previewed, and committed on mouse up
+    Array<Note> groupBeforeInteractiveChange;
+    void previewGroupChange(const Lasso &selection,
+        Array<Note> &groupBefore, Array<Note> &groupAfter);
+    void commitGroupChange(const Lasso &selection);
+
     bool shouldGoQuickSelectLayerMode(const ModifierKeys &modifiers) const;
 
     void stopSound();
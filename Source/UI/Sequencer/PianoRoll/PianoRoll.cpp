@@ -98,21 +98,22 @@ PianoRoll::PianoRoll(ProjectNode &project, Viewport &viewport, WeakReference<Aud
     this->noteNameGuides = make<NoteNameGuidesBar>(*this);
     this->addChildComponent(this->noteNameGuides.get());
     this->noteNameGuides->setVisible(noteNameGuidesEnabled);
+
+    this->project.getMidiRecorder().addListener(this);
 }
 
-PianoRoll::~PianoRoll() = default;
+PianoRoll::~PianoRoll()
+{
+    this->project.getMidiRecorder().removeListener(this);
+}
 
 void PianoRoll::reloadRollContent()
 {
     this->selection.deselectAll();
-    this->patternMap.clear();
 
     ROLL_BATCH_REPAINT_START
 
-    for (const auto *track : this->project.getTracks())
-    {
-        this->loadTrack(track);
-    }
+    this->loadActiveClip();
 
     this->updateBackgroundCachesAndRepaint();
     this->applyEditModeUpdates();
@@ -120,35 +121,222 @@ void PianoRoll::reloadRollContent()
     ROLL_BATCH_REPAINT_END
 }
 
-void PianoRoll::loadTrack(const MidiTrack *const track)
+void PianoRoll::loadActiveClip()
 {
-    if (track->getPattern() == nullptr)
+    this->patternMap.clear();
+    this->newNoteDragging = nullptr;
+
+    const auto *pattern = this->activeTrack == nullptr ?
+        nullptr : this->activeTrack->getPattern();
+
+    if (pattern == nullptr)
     {
         return;
     }
 
-    for (int i = 0; i < track->getPattern()->size(); ++i)
+    const int i = pattern->indexOfSorted(&this->activeClip);
+    if (i >= 0)
     {
-        const Clip *clip = track->getPattern()->getUnchecked(i);
+        this->loadClip(*pattern->getUnchecked(i));
+    }
+}
 
-        auto *sequenceMap = new SequenceMap();
-        this->patternMap[*clip] = UniquePointer<SequenceMap>(sequenceMap);
+void PianoRoll::loadClip(const Clip &clip)
+{
+    const auto *track = clip.getPattern()->getTrack();
+
+    auto *sequenceMap = new SequenceMap();
+    this->patternMap[clip] = UniquePointer<SequenceMap>(sequenceMap);
 
-        for (int j = 0; j < track->getSequence()->size(); ++j)
+    for (int j = 0; j < track->getSequence()->size(); ++j)
+    {
+        const MidiEvent *event = track->getSequence()->getUnchecked(j);
+        if (event->isTypeOf(MidiEvent::Type::Note))
         {
-            const MidiEvent *event = track->getSequence()->getUnchecked(j);
-            if (event->isTypeOf(MidiEvent::Type::Note))
+            const Note *note = static_cast<const Note *>(event);
+            auto *nc = new NoteComponent(*this, *note, clip);
+            (*sequenceMap)[*note] = UniquePointer<NoteComponent>(nc);
+            this->addAndMakeVisible(nc);
+            nc->setActive(true, true);
+            nc->setFloatBounds(this->getEventBounds(nc));
+        }
+    }
+}
+
+void PianoRoll::repaintInactiveNotesOf(const MidiTrack *track)
+{
+    const auto *pattern = track->getPattern();
+    if (pattern != nullptr && (track != this->activeTrack || pattern->size() > 1))
+    {
+        this->repaint(this->viewport.getViewArea());
+    }
+}
+
+void PianoRoll::paintInactiveNotes(Graphics &g) const
+{
+    const auto paintArea = g.getClipBounds().toFloat();
+    const auto paintStartBeat = this->getBeatByXPosition(paintArea.getX());
+    const auto paintEndBeat = this->getBeatByXPosition(paintArea.getRight());
+
+    // all the notes of a track are filled with a few calls, one per colour,
+    // which both renderers handle as batches, instead of a few calls per note
+    RectangleList<float> bodies, tops, bottoms;
+
+    for (const auto *track : this->project.getTracks())
+    {
+        const auto *sequence = dynamic_cast<const PianoSequence *>(track->getSequence());
+        if (sequence == nullptr || sequence->isEmpty() || track->getPattern() == nullptr)
+        {
+            continue;
+        }
+
+        bodies.clear();
+        tops.clear();
+        bottoms.clear();
+
+        const auto notes = sequence->getPackedNotes();
+
+        for (int c = 0; c < track->getPattern()->size(); ++c)
+        {
+            const auto *clip = track->getPattern()->getUnchecked(c);
+            if (track == this->activeTrack && *clip == this->activeClip)
+            {
+                continue;
+            }
+
+            const auto startBeat = paintStartBeat - clip->getBeat();
+            const auto endBeat = paintEndBeat - clip->getBeat();
+
+            for (int i = notes->indexOfFirstEndingAfter(startBeat); i < notes->size(); ++i)
             {
-                const Note *note = static_cast<const Note *>(event);
-                auto *nc = new NoteComponent(*this, *note, *clip);
-                (*sequenceMap)[*note] = UniquePointer<NoteComponent>(nc);
-                const bool isActive = nc->belongsTo(this->activeTrack, this->activeClip);
-                nc->setActive(isActive, true);
-                this->addAndMakeVisible(nc);
-                nc->setFloatBounds(this->getEventBounds(nc));
+                const auto beat = notes->beats.getUnchecked(i);
+                const auto length = notes->lengths.getUnchecked(i);
+                if (beat >= endBeat)
+                {
+                    break;
+                }
+
+                if (beat + length <= startBeat)
+                {
+                    continue;
+                }
+
+                const auto bounds = this->getEventBounds(notes->keys.getUnchecked(i) +
+                    clip->getKey(), beat + clip->getBeat(), length);
+
+                if (bounds.getY() > paintArea.getBottom() || bounds.getBottom() < paintArea.getY())
+                {
+                    continue;
+                }
+
+                // the same as NoteComponent::paint does for the inactive notes
+                const float x = bounds.getX();
+                const float y = bounds.getY();
+                const float w = bounds.getWidth() - .5f;
+                const float h = bounds.getHeight();
+
+                if (w < NoteComponent::lowDetailWidth)
+                {
+                    bodies.addWithoutMerging({ x + 0.5f, y + 0.75f, jmax(0.5f, w - 0.75f), h - 1.5f });
+                    continue;
+                }
+
+                bodies.addWithoutMerging({ x + 0.5f, y + h / 6.f, 0.5f, h / 1.5f });
+                bodies.addWithoutMerging({ x + w - 0.75f, y + h / 6.f, 0.5f, h / 1.5f });
+                bodies.addWithoutMerging({ x + 0.75f, y + 0.75f, w - 1.25f, h - 1.5f });
+
+                tops.addWithoutMerging({ x + 1.25f, roundf(y), w - 2.25f, 1.f });
+                bottoms.addWithoutMerging({ x + 1.25f, roundf(y + h - 1), w - 2.25f, 1.f });
+            }
+        }
+
+        if (bodies.isEmpty())
+        {
+            continue;
+        }
+
+        const auto colour = NoteComponent::getInactiveColour(track->getTrackColour());
+
+        g.setColour(colour);
+        g.fillRectList(bodies);
+
+        g.setColour(colour.brighter(0.125f).withMultipliedAlpha(1.45f));
+        g.fillRectList(tops);
+
+        g.setColour(colour.darker(0.175f).withMultipliedAlpha(1.45f));
+        g.fillRectList(bottoms);
+    }
+}
+
+void PianoRoll::findActiveNoteComponentsInArea(const Rectangle<float> &area,
+    Array<NoteComponent *> &outComponents) const
+{
+    const auto activeMap = this->patternMap.find(this->activeClip);
+    const auto *sequence = this->activeTrack == nullptr ? nullptr :
+        dynamic_cast<const PianoSequence *>(this->activeTrack->getSequence());
+
+    if (activeMap == this->patternMap.end() || sequence == nullptr)
+    {
+        return;
+    }
+
+    // a pixel of slack on both sides, just to be safe with the rounding
+    const auto clipBeat = this->activeClip.getBeat();
+    const auto startBeat = this->getBeatByXPosition(area.getX() - 1.f) - clipBeat;
+    const auto endBeat = this->getBeatByXPosition(area.getRight() + 1.f) - clipBeat;
+
+    Array<Note *> notes;
+    sequence->findNotesOverlappingRange(startBeat, endBeat, notes);
+
+    const auto &sequenceMap = *activeMap->second.get();
+    for (const auto *note : notes)
+    {
+        const auto found = sequenceMap.find(*note);
+        // not the component's bounds, which may be stale offscreen
+        if (found != sequenceMap.end() &&
+            this->getEventBounds(found->second.get()).intersects(area))
+        {
+            outComponents.add(found->second.get());
+        }
+    }
+}
+
+const Clip *PianoRoll::findInactiveClipAt(const Point<float> &position) const
+{
+    const auto targetBeat = this->getBeatByXPosition(position.getX());
+    const auto targetKey = int((this->getHeight() - position.getY()) / this->rowHeight);
+
+    for (const auto *track : this->project.getTracks())
+    {
+        const auto *sequence = dynamic_cast<const PianoSequence *>(track->getSequence());
+        if (sequence == nullptr || sequence->isEmpty() || track->getPattern() == nullptr)
+        {
+            continue;
+        }
+
+        const auto notes = sequence->getPackedNotes();
+        for (int c = 0; c < track->getPattern()->size(); ++c)
+        {
+            const auto *clip = track->getPattern()->getUnchecked(c);
+            if (track == this->activeTrack && *clip == this->activeClip)
+            {
+                continue;
+            }
+
+            const auto beat = targetBeat - clip->getBeat();
+            for (int i = notes->indexOfFirstEndingAfter(beat);
+                i < notes->size() && notes->beats.getUnchecked(i) <= beat; ++i)
+            {
+                if (notes->keys.getUnchecked(i) + clip->getKey() == targetKey &&
+                    notes->beats.getUnchecked(i) + notes->lengths.getUnchecked(i) > beat)
+                {
+                    return clip;
+                }
             }
         }
     }
+
+    return nullptr;
 }
 
 void PianoRoll::updateClipRangeIndicator() const
@@ -200,14 +388,7 @@ void PianoRoll::updateSize()
 
 void PianoRoll::selectAll()
 {
-    forEachEventComponent(this->patternMap, e)
-    {
-        auto *childComponent = e.second.get();
-        if (childComponent->belongsTo(this->activeTrack, activeClip))
-        {
-            this->selectEvent(childComponent, false);
-        }
-    }
+    this->selectNotesIf([](const Note &) { return true; }, false);
 }
 
 void PianoRoll::setChildrenInteraction(bool interceptsMouse, MouseCursor cursor)
@@ -470,6 +651,25 @@ void PianoRoll::moveDragHelpers(const float deltaBeat, const int deltaKey)
     this->draggingHelper->setBounds(selectionTranslated.withLeft(vX).withWidth(vW));
 }
 
+void PianoRoll::onPreviewNoteChanges(const Array<Note> &notes, const MidiTrack *track)
+{
+    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    {
+        auto &sequenceMap = *c.second.get();
+        for (const auto &note : notes)
+        {
+            const auto found = sequenceMap.find(note);
+            if (found != sequenceMap.end())
+            {
+                this->triggerBatchRepaintFor(found->second.get());
+            }
+        }
+    }
+
+    this->repaintInactiveNotesOf(track);
+    this->selection.onSelectableItemChanged();
+}
+
 //===----------------------------------------------------------------------===//
 // ProjectListener
 //===----------------------------------------------------------------------===//
@@ -484,20 +684,10 @@ void PianoRoll::onChangeMidiEvent(const MidiEvent &oldEvent, const MidiEvent &ne
 
         forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
         {
-            auto &sequenceMap = *c.second.get();
-            if (auto *component = sequenceMap[note].release())
-            {
-                // Pass ownership to another key:
-                sequenceMap.erase(note);
-                // Hitting this assert means that a track somehow contains events
-                // with duplicate id's. This should never, ever happen.
-                jassert(!sequenceMap.contains(newNote));
-                // Always erase before updating, as it may happen both events have the same hash code:
-                sequenceMap[newNote] = UniquePointer<NoteComponent>(component);
-                // Schedule to be repainted later:
-                this->triggerBatchRepaintFor(component);
-            }
+            this->updateNoteComponent(note, newNote, *c.second.get());
         }
+
+        this->repaintInactiveNotesOf(track);
     }
     else if (oldEvent.isTypeOf(MidiEvent::Type::KeySignature))
     {
@@ -509,6 +699,8 @@ void PianoRoll::onChangeMidiEvent(const MidiEvent &oldEvent, const MidiEvent &ne
             this->removeBackgroundCacheFor(oldKey);
             this->updateBackgroundCacheFor(newKey);
         }
+
+        this->backgroundTiles.clear(); // the key might have been moved
         this->repaint();
     }
 
@@ -524,40 +716,10 @@ void PianoRoll::onAddMidiEvent(const MidiEvent &event)
 
         forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
         {
-            auto &sequenceMap = *c.second.get();
-            const auto *targetParams = &c.first;
-            const int i = track->getPattern()->indexOfSorted(targetParams);
-            jassert(i >= 0);
-            
-            const Clip *realClip = track->getPattern()->getUnchecked(i);
-            auto *component = new NoteComponent(*this, note, *realClip);
-            sequenceMap[note] = UniquePointer<NoteComponent>(component);
-            this->addAndMakeVisible(component);
-
-            this->fader.fadeIn(component, Globals::UI::fadeInLong);
-
-            // TODO check this in a more elegant way
-            // (needed not to break shift+drag note copying)
-            const bool isCurrentlyDraggingNote = this->draggingHelper->isVisible();
-
-            const bool isActive = component->belongsTo(this->activeTrack, this->activeClip);
-            component->setActive(isActive, true);
-
-            this->triggerBatchRepaintFor(component);
-
-            // arpeggiators preview cannot work without that:
-            if (isActive && !isCurrentlyDraggingNote)
-            {
-                this->selectEvent(component, false);
-            }
-
-            if (this->addNewNoteMode && isActive)
-            {
-                this->newNoteDragging = component;
-                this->addNewNoteMode = false;
-                this->selectEvent(this->newNoteDragging, true); // clear prev selection
-            }
+            this->addNoteComponent(note, *this->findRealClip(c.first, track), *c.second.get());
         }
+
+        this->repaintInactiveNotesOf(track);
     }
     else if (event.isTypeOf(MidiEvent::Type::KeySignature))
     {
@@ -582,15 +744,10 @@ void PianoRoll::onRemoveMidiEvent(const MidiEvent &event)
 
         forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
         {
-            auto &sequenceMap = *c.second.get();
-            if (sequenceMap.contains(note))
-            {
-                NoteComponent *deletedComponent = sequenceMap[note].get();
-                this->fader.fadeOut(deletedComponent, Globals::UI::fadeOutLong);
-                this->selection.deselect(deletedComponent);
-                sequenceMap.erase(note);
-            }
+            this->removeNoteComponent(note, *c.second.get());
         }
+
+        this->repaintInactiveNotesOf(track);
     }
     else if (event.isTypeOf(MidiEvent::Type::KeySignature))
     {
@@ -602,42 +759,161 @@ void PianoRoll::onRemoveMidiEvent(const MidiEvent &event)
     RollBase::onRemoveMidiEvent(event);
 }
 
-void PianoRoll::onAddClip(const Clip &clip)
+void PianoRoll::onAddMidiEvents(const Array<const MidiEvent *> &events)
 {
-    const SequenceMap *referenceMap = nullptr;
-    const auto *track = clip.getPattern()->getTrack();
+    if (!events.getFirst()->isTypeOf(MidiEvent::Type::Note))
+    {
+        RollBase::onAddMidiEvents(events);
+        return;
+    }
+
+    const auto *track = events.getFirst()->getSequence()->getTrack();
 
     forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
     {
-        // Found a sequence map for the same track
-        referenceMap = c.second.get();
-        break;
+        auto &sequenceMap = *c.second.get();
+        const auto *realClip = this->findRealClip(c.first, track);
+        for (const auto *event : events)
+        {
+            this->addNoteComponent(static_cast<const Note &>(*event), *realClip, sequenceMap);
+        }
     }
 
-    if (referenceMap == nullptr)
+    this->repaintInactiveNotesOf(track);
+}
+
+void PianoRoll::onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+    const Array<const MidiEvent *> &newEvents)
+{
+    if (!oldEvents.getFirst()->isTypeOf(MidiEvent::Type::Note))
     {
-        jassertfalse;
+        RollBase::onChangeMidiEvents(oldEvents, newEvents);
         return;
     }
 
-    auto *sequenceMap = new SequenceMap();
-    this->patternMap[clip] = UniquePointer<SequenceMap>(sequenceMap);
+    const auto *track = newEvents.getFirst()->getSequence()->getTrack();
 
-    for (const auto &e : *referenceMap)
+    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    {
+        auto &sequenceMap = *c.second.get();
+        for (int i = 0; i < oldEvents.size(); ++i)
+        {
+            this->updateNoteComponent(static_cast<const Note &>(*oldEvents.getUnchecked(i)),
+                static_cast<const Note &>(*newEvents.getUnchecked(i)), sequenceMap);
+        }
+    }
+
+    this->repaintInactiveNotesOf(track);
+
+    if (this->isEnabled())
+    {
+        this->selection.onSelectableItemChanged();
+    }
+}
+
+void PianoRoll::onRemoveMidiEvents(const Array<const MidiEvent *> &events)
+{
+    if (!events.getFirst()->isTypeOf(MidiEvent::Type::Note))
+    {
+        RollBase::onRemoveMidiEvents(events);
+        return;
+    }
+
+    this->hideDragHelpers();
+    this->hideAllGhostNotes(); // Avoids crash
+
+    const auto *track = events.getFirst()->getSequence()->getTrack();
+
+    forEachSequenceMapOfGivenTrack(this->patternMap, c, track)
+    {
+        auto &sequenceMap = *c.second.get();
+        for (const auto *event : events)
+        {
+            this->removeNoteComponent(static_cast<const Note &>(*event), sequenceMap);
+        }
+    }
+
+    this->repaintInactiveNotesOf(track);
+}
+
+void PianoRoll::addNoteComponent(const Note &note, const Clip &clip, SequenceMap &sequenceMap)
+{
+    auto *component = new NoteComponent(*this, note, clip);
+    sequenceMap[note] = UniquePointer<NoteComponent>(component);
+    this->addAndMakeVisible(component);
+
+    this->fader.fadeIn(component, Globals::UI::fadeInLong);
+
+    // TODO check this in a more elegant way
+    // (needed not to break shift+drag note copying)
+    const bool isCurrentlyDraggingNote = this->draggingHelper->isVisible();
+
+    const bool isActive = component->belongsTo(this->activeTrack, this->activeClip);
+    component->setActive(isActive, true);
+
+    this->triggerBatchRepaintFor(component);
+
+    // arpeggiators preview cannot work without that:
+    if (isActive && !isCurrentlyDraggingNote)
+    {
+        this->selectEvent(component, false);
+    }
+
+    if (this->addNewNoteMode && isActive)
     {
-        // reference the same note as neighbor components:
-        const auto &note = e.second.get()->getNote();
-        auto *component = new NoteComponent(*this, note, clip);
-        (*sequenceMap)[note] = UniquePointer<NoteComponent>(component);
-        this->addAndMakeVisible(component);
+        this->newNoteDragging = component;
+        this->addNewNoteMode = false;
+        this->selectEvent(this->newNoteDragging, true); // clear prev selection
+    }
+}
 
-        const bool isActive = component->belongsTo(this->activeTrack, this->activeClip);
-        component->setActive(isActive);
+void PianoRoll::updateNoteComponent(const Note &oldNote, const Note &newNote, SequenceMap &sequenceMap)
+{
+    if (auto *component = sequenceMap[oldNote].release())
+    {
+        // Pass ownership to another key:
+        sequenceMap.erase(oldNote);
+        // Hitting this assert means that a track somehow contains events
+        // with duplicate id's. This should never, ever happen.
+        jassert(!sequenceMap.contains(newNote));
+        // Always erase before updating, as it may happen both events have the same hash code:
+        sequenceMap[newNote] = UniquePointer<NoteComponent>(component);
+        // Schedule to be repainted later:
+        this->triggerBatchRepaintFor(component);
+    }
+}
 
-        this->batchRepaintList.add(component);
+void PianoRoll::removeNoteComponent(const Note &note, SequenceMap &sequenceMap)
+{
+    if (sequenceMap.contains(note))
+    {
+        NoteComponent *deletedComponent = sequenceMap[note].get();
+        this->fader.fadeOut(deletedComponent, Globals::UI::fadeOutLong);
+        this->selection.deselect(deletedComponent);
+        sequenceMap.erase(note);
     }
+}
+
+const Clip *PianoRoll::findRealClip(const Clip &clip, const MidiTrack *track) const
+{
+    const int i = track->getPattern()->indexOfSorted(&clip);
+    jassert(i >= 0);
+    return track->getPattern()->getUnchecked(i);
+}
 
-    this->triggerAsyncUpdate();
+void PianoRoll::onAddClip(const Clip &clip)
+{
+    const auto *track = clip.getPattern()->getTrack();
+    if (track == this->activeTrack && clip == this->activeClip)
+    {
+        ROLL_BATCH_REPAINT_START
+        this->loadClip(clip);
+        ROLL_BATCH_REPAINT_END
+    }
+    else
+    {
+        this->repaint(this->viewport.getViewArea());
+    }
 }
 
 void PianoRoll::onChangeClip(const Clip &clip, const Clip &newClip)
@@ -665,7 +941,11 @@ void PianoRoll::onChangeClip(const Clip &clip, const Clip &newClip)
         }
 
         // Schedule batch repaint
-        this->triggerAsyncUpdate();
+        FrameScheduler::getInstance().requestFrame(this);
+    }
+    else
+    {
+        this->repaint(this->viewport.getViewArea());
     }
 
     RollBase::onChangeClip(clip, newClip);
@@ -680,6 +960,8 @@ void PianoRoll::onRemoveClip(const Clip &clip)
         this->patternMap.erase(clip);
     }
 
+    this->repaint(this->viewport.getViewArea());
+
     ROLL_BATCH_REPAINT_END
 }
 
@@ -710,7 +992,11 @@ void PianoRoll::onAddTrack(MidiTrack *const track)
 {
     ROLL_BATCH_REPAINT_START
 
-    this->loadTrack(track);
+    if (track == this->activeTrack)
+    {
+        this->loadActiveClip();
+    }
+
     this->applyEditModeUpdates();
 
     for (int j = 0; j < track->getSequence()->size(); ++j)
@@ -824,14 +1110,17 @@ void PianoRoll::onChangeViewEditableScope(MidiTrack *const newActiveTrack,
     float focusMaxBeat = -FLT_MAX;
     bool hasComponentsToFocusOn = false;
 
+    ROLL_BATCH_REPAINT_START
+    this->loadActiveClip();
+    this->applyEditModeUpdates();
+    ROLL_BATCH_REPAINT_END
+
     forEachEventComponent(this->patternMap, e)
     {
-        auto *nc = e.second.get();
-        const bool isActive = nc->belongsTo(this->activeTrack, this->activeClip);
+        const auto *nc = e.second.get();
         const auto key = nc->getKey() + this->activeClip.getKey();
-        nc->setActive(isActive, true);
 
-        if (shouldFocus && isActive)
+        if (shouldFocus)
         {
             hasComponentsToFocusOn = true;
             focusMinKey = jmin(focusMinKey, key);
@@ -862,6 +1151,7 @@ void PianoRoll::onChangeViewEditableScope(MidiTrack *const newActiveTrack,
     }
     else
     {
+        // the previously active clip is now painted by the roll
         this->repaint(this->viewport.getViewArea());
     }
 
@@ -869,34 +1159,112 @@ void PianoRoll::onChangeViewEditableScope(MidiTrack *const newActiveTrack,
 }
 
 //===----------------------------------------------------------------------===//
-// LassoSource
+// Lasso
 //===----------------------------------------------------------------------===//
 
 void PianoRoll::selectEventsInRange(float startBeat, float endBeat, bool shouldClearAllOthers)
 {
-    if (shouldClearAllOthers)
+    // only the active clip's notes are selectable
+    const auto activeMap = this->patternMap.find(this->activeClip);
+    const auto *sequence = this->activeTrack == nullptr ? nullptr :
+        dynamic_cast<const PianoSequence *>(this->activeTrack->getSequence());
+
+    Lasso::ItemArray items;
+    if (activeMap != this->patternMap.end() && sequence != nullptr)
     {
-        this->selection.deselectAll();
+        Array<Note *> notes;
+        const auto clipBeat = this->activeClip.getBeat();
+        sequence->findNotesStartingInRange(startBeat - clipBeat, endBeat - clipBeat, notes);
+
+        auto &sequenceMap = *activeMap->second.get();
+        for (const auto *note : notes)
+        {
+            const auto found = sequenceMap.find(*note);
+            if (found != sequenceMap.end() && found->second->isActive())
+            {
+                items.add(found->second.get());
+            }
+        }
     }
 
-    forEachEventComponent(this->patternMap, e)
+    this->applyBulkSelection(items, shouldClearAllOthers);
+}
+
+void PianoRoll::selectNotesIf(const Function<bool(const Note &)> &predicate, bool shouldClearAllOthers)
+{
+    Lasso::ItemArray items;
+
+    const auto activeMap = this->patternMap.find(this->activeClip);
+    if (activeMap != this->patternMap.end())
     {
-        auto *component = e.second.get();
-        if (component->isActive() &&
-            (component->getNote().getBeat() + component->getClip().getBeat()) >= startBeat &&
-            (component->getNote().getBeat() + component->getClip().getBeat()) < endBeat)
+        for (const auto &e : *activeMap->second.get())
         {
-            this->selectEvent(component, false);
+            if (e.second->isActive() && predicate(e.first))
+            {
+                items.add(e.second.get());
+            }
         }
     }
+
+    this->applyBulkSelection(items, shouldClearAllOthers);
+}
+
+void PianoRoll::selectNotesWithKey(int key, bool shouldClearAllOthers)
+{
+    this->selectNotesIf([key](const Note &note)
+    {
+        return note.getKey() == key;
+    }, shouldClearAllOthers);
+}
+
+void PianoRoll::selectNotesInVelocityRange(float minVelocity,
+    float maxVelocity, bool shouldClearAllOthers)
+{
+    this->selectNotesIf([minVelocity, maxVelocity](const Note &note)
+    {
+        return note.getVelocity() >= minVelocity && note.getVelocity() <= maxVelocity;
+    }, shouldClearAllOthers);
+}
+
+void PianoRoll::invertSelection()
+{
+    Lasso::ItemArray items;
+
+    const auto activeMap = this->patternMap.find(this->activeClip);
+    if (activeMap != this->patternMap.end())
+    {
+        for (const auto &e : *activeMap->second.get())
+        {
+            if (e.second->isActive() && !this->selection.isSelected(e.second.get()))
+            {
+                items.add(e.second.get());
+            }
+        }
+    }
+
+    this->selection.setSelection(items);
+}
+
+void PianoRoll::applyBulkSelection(const Lasso::ItemArray &items, bool shouldClearAllOthers)
+{
+    if (shouldClearAllOthers)
+    {
+        this->selection.setSelection(items);
+    }
+    else
+    {
+        this->selection.selectAll(items);
+    }
 }
 
 void PianoRoll::findLassoItemsInArea(Array<SelectableComponent *> &itemsFound, const Rectangle<int> &rectangle)
 {
-    forEachEventComponent(this->patternMap, e)
+    Array<NoteComponent *> components;
+    this->findActiveNoteComponentsInArea(rectangle.toFloat(), components);
+
+    for (auto *component : components)
     {
-        auto *component = e.second.get();
-        if (rectangle.intersects(component->getBounds()) && component->isActive())
+        if (component->isActive())
         {
             jassert(!itemsFound.contains(component));
             itemsFound.add(component);
@@ -914,6 +1282,44 @@ float PianoRoll::getLassoEndBeat() const
     return this->activeClip.getBeat() + SequencerOperations::findEndBeat(this->selection);
 }
 
+//===----------------------------------------------------------------------===//
+// MidiRecorder::Listener
+//===----------------------------------------------------------------------===//
+
+void PianoRoll::onChangeRecordedNotes(const Array<Note> &notesBefore,
+    const Array<Note> &notesAfter)
+{
+    const auto *clip = this->project.getMidiRecorder().getRecordingClip();
+    if (clip == nullptr)
+    {
+        return;
+    }
+
+    // only repaint the affected areas, which are tiny, instead of
+    // going through all the note components via the project listeners
+    for (const auto &note : notesBefore)
+    {
+        this->repaint(this->getRecordedNoteBounds(*clip, note).getSmallestIntegerContainer());
+    }
+
+    for (const auto &note : notesAfter)
+    {
+        this->repaint(this->getRecordedNoteBounds(*clip, note).getSmallestIntegerContainer());
+    }
+}
+
+void PianoRoll::onClearRecordedNotes()
+{
+    // the recorded notes have just been committed, or discarded
+    this->repaint(this->viewport.getViewArea());
+}
+
+Rectangle<float> PianoRoll::getRecordedNoteBounds(const Clip &clip, const Note &note) const
+{
+    return this->getEventBounds(note.getKey() + clip.getKey(),
+        note.getBeat() + clip.getBeat(), note.getLength());
+}
+
 //===----------------------------------------------------------------------===//
 // Component
 //===----------------------------------------------------------------------===//
@@ -925,6 +1331,26 @@ void PianoRoll::mouseDown(const MouseEvent &e)
         return;
     }
     
+    // the inactive notes are not components, so the roll
+    // does the quick clip switching on alt- or right-click instead of them
+    if ((e.mods.isAltDown() || e.mods.isRightButtonDown()) &&
+        !this->isUsingSpaceDraggingMode())
+    {
+        if (const auto *clip = this->findInactiveClipAt(e.position))
+        {
+            RollBase::mouseDown(e);
+
+            const bool zoomToScope = e.mods.isAnyModifierKeyDown();
+            this->project.setEditableScope(*clip, zoomToScope);
+            if (zoomToScope)
+            {
+                this->zoomOutImpulse(0.5f);
+            }
+
+            return;
+        }
+    }
+
     if (! this->isUsingSpaceDraggingMode())
     {
         this->setInterceptsMouseClicks(true, false);
@@ -1343,10 +1769,12 @@ void PianoRoll::resized()
 
     ROLL_BATCH_REPAINT_START
 
+    this->offscreenEventComponents.clearQuick();
+    const auto layoutArea = this->getEventsLayoutArea();
+
     forEachEventComponent(this->patternMap, e)
     {
-        const auto component = e.second.get();
-        component->setFloatBounds(this->getEventBounds(component));
+        this->updateEventBoundsIfVisible(e.second.get(), layoutArea);
     }
 
     for (const auto component : this->ghostNotes)
@@ -1365,18 +1793,59 @@ void PianoRoll::resized()
     ROLL_BATCH_REPAINT_END
 }
 
+// the notes being recorded are not in the sequence yet,
+// so they are painted over the note components as simple rectangles
+void PianoRoll::paintOverChildren(Graphics &g)
+{
+    const auto &recorder = this->project.getMidiRecorder();
+    const auto *clip = recorder.getRecordingClip();
+    const auto &notes = recorder.getRecordedNotes();
+    if (clip == nullptr || notes.isEmpty())
+    {
+        return;
+    }
+
+    const auto *track = clip->getPattern()->getTrack();
+    const auto colour = track->getTrackColour().withMultipliedAlpha(0.75f);
+    const auto clipArea = g.getClipBounds().toFloat();
+
+    for (const auto &note : notes)
+    {
+        const auto bounds = this->getRecordedNoteBounds(*clip, note);
+        if (bounds.intersects(clipArea))
+        {
+            g.setColour(colour);
+            g.fillRect(bounds.reduced(0.5f, 1.f));
+            g.setColour(colour.brighter(0.5f));
+            g.drawRect(bounds.reduced(0.5f, 1.f), 1.f);
+        }
+    }
+}
+
 void PianoRoll::paint(Graphics &g)
 {
     jassert(this->defaultHighlighting != nullptr); // trying to paint before the content is ready
 
-    const auto *keysSequence = this->project.getTimeline()->getKeySignatures()->getSequence();
-    const int paintStartX = this->viewport.getViewPositionX();
-    const int paintEndX = paintStartX + this->viewport.getViewWidth();
+    // the grid is painted from the tiles, but the snaps are still needed
+    this->computeAllSnapLines();
+
+    BackgroundTilesKey key;
+    key.timeSignaturesVersion = this->project.getTimeline()->getTimeSignaturesAggregator()->getVersion();
+    key.beatWidth = this->beatWidth;
+    key.firstBeat = this->firstBeat;
+    key.projectFirstBeat = this->projectFirstBeat;
+    key.rowHeight = this->rowHeight;
+
+    if (!(key == this->backgroundTilesKey))
+    {
+        this->backgroundTilesKey = key;
+        this->backgroundTiles.clear();
+    }
 
     static constexpr auto paintOffsetY = Globals::UI::rollHeaderHeight;
 
-    int prevBeatX = paintStartX;
-    const HighlightingScheme *prevScheme = nullptr;
+    const int paintStartX = this->viewport.getViewPositionX();
+    const int paintEndX = paintStartX + this->viewport.getViewWidth();
     const int y = this->viewport.getViewPositionY();
     const int h = this->viewport.getViewHeight();
 
@@ -1384,7 +1853,32 @@ void PianoRoll::paint(Graphics &g)
     const auto numPeriodsToSkip = (y - paintOffsetY) / periodHeight;
     const auto paintStartY = paintOffsetY + numPeriodsToSkip * periodHeight;
 
-    g.setImageResamplingQuality(Graphics::lowResamplingQuality);
+    const auto firstColumn = paintStartX / PianoRoll::backgroundTileWidth;
+    const auto lastColumn = (paintEndX - 1) / PianoRoll::backgroundTileWidth;
+
+    for (int column = firstColumn; column <= lastColumn; ++column)
+    {
+        const auto tile = this->getBackgroundTile(column);
+        const auto tileX = column * PianoRoll::backgroundTileWidth;
+
+        // all periods look the same, so each tile is blitted once per period
+        for (int i = paintStartY; i < y + h; i += periodHeight)
+        {
+            g.drawImageAt(tile, tileX, i);
+        }
+    }
+
+    this->removeBackgroundTilesOutside(firstColumn, lastColumn);
+
+    this->paintInactiveNotes(g);
+}
+
+void PianoRoll::paintRows(Graphics &g, int paintStartX, int paintEndX, int periodHeight) const
+{
+    const auto *keysSequence = this->project.getTimeline()->getKeySignatures()->getSequence();
+
+    int prevBeatX = paintStartX;
+    const HighlightingScheme *prevScheme = nullptr;
 
     for (int nextKeyIdx = 0; this->scalesHighlightingEnabled && nextKeyIdx < keysSequence->size(); ++nextKeyIdx)
     {
@@ -1394,33 +1888,17 @@ void PianoRoll::paint(Graphics &g)
         jassert(index >= 0);
 
         const auto *s = (prevScheme == nullptr) ? this->backgroundsCache.getUnchecked(index) : prevScheme;
-        const auto fillImage = s->getUnchecked(this->rowHeight);
 
         if (beatX >= paintStartX)
         {
-            /*
-                You might be thinking: why the do we need this ugly loop here?
-                Given a tiled texture, we can just fill it all at once with a single fillRect()?
-
-                Well yes, but actually no.
-                OpenGmotherfuckingL does suck real hard, and it can't seem to do
-                texture tiling correctly unless the stars are well aligned (they are not),
-                so there is always some weird offset, and it's getting weirder at each next tile.
-
-                For horizontal tiling, we don't care, but for vertical tiling, this means that
-                sequencer rows are messed up, so we have to say explicitly where to fill each period.
-            */
-
-            for (int i = paintStartY; i < y + h; i += periodHeight)
-            {
-                g.setFillType({ fillImage, AffineTransform::translation(0.f, float(i)) });
-                g.fillRect(prevBeatX, i, beatX - prevBeatX, periodHeight);
-            }
+            // tiling is fine here, since this is a software image,
+            // and the tiles are rendered one period high anyway
+            g.setFillType({ s->getUnchecked(this->rowHeight), {} });
+            g.fillRect(prevBeatX, 0, beatX - prevBeatX, periodHeight);
         }
 
         if (beatX >= paintEndX)
         {
-            RollBase::paint(g);
             return;
         }
 
@@ -1431,16 +1909,64 @@ void PianoRoll::paint(Graphics &g)
     if (prevBeatX < paintEndX)
     {
         const auto *s = (prevScheme == nullptr) ? this->defaultHighlighting.get() : prevScheme;
-        const auto fillImage = s->getUnchecked(this->rowHeight);
+        g.setFillType({ s->getUnchecked(this->rowHeight), {} });
+        g.fillRect(prevBeatX, 0, paintEndX - prevBeatX, periodHeight);
+    }
+}
 
-        // just because we cannot rely on OpenGL tiling:
-        for (int i = paintStartY; i < y + h; i += periodHeight)
+Image PianoRoll::getBackgroundTile(int column)
+{
+    const auto found = this->backgroundTiles.find(column);
+    if (found != this->backgroundTiles.end())
+    {
+        return found->second;
+    }
+
+    auto tile = this->renderBackgroundTile(column);
+    this->backgroundTiles[column] = tile;
+    return tile;
+}
+
+Image PianoRoll::renderBackgroundTile(int column)
+{
+    const auto periodHeight = this->rowHeight * this->getPeriodSize();
+    const auto tileX = column * PianoRoll::backgroundTileWidth;
+
+    Image tile(Image::RGB, PianoRoll::backgroundTileWidth, periodHeight, false);
+    Graphics g(tile);
+    g.setOrigin(-tileX, 0);
+    g.setImageResamplingQuality(Graphics::lowResamplingQuality);
+
+    this->paintRows(g, tileX, tileX + PianoRoll::backgroundTileWidth, periodHeight);
+
+    Array<float> bars, beats, snaps;
+    this->computeGridLines(float(tileX),
+        float(tileX + PianoRoll::backgroundTileWidth), bars, beats, snaps);
+
+    this->paintGridLines(g, bars, beats, snaps, 0.f, float(periodHeight));
+
+    return tile;
+}
+
+// keeps the tiles of a few screens around the visible ones
+void PianoRoll::removeBackgroundTilesOutside(int firstColumn, int lastColumn)
+{
+    const auto margin = lastColumn - firstColumn + 1;
+    if (int(this->backgroundTiles.size()) <= margin * 3)
+    {
+        return;
+    }
+
+    for (auto it = this->backgroundTiles.begin(); it != this->backgroundTiles.end();)
+    {
+        if (it->first < firstColumn - margin || it->first > lastColumn + margin)
         {
-            g.setFillType({ fillImage, AffineTransform::translation(0.f, float(i)) });
-            g.fillRect(prevBeatX, i, paintEndX - prevBeatX, periodHeight);
+            it = this->backgroundTiles.erase(it);
+        }
+        else
+        {
+            ++it;
         }
-
-        RollBase::paint(g);
     }
 }
 
@@ -1476,16 +2002,40 @@ void PianoRoll::switchToClipInViewport() const
 
     FlatHashMap<Clip, int, ClipHash> visibilityWeights;
 
-    forEachEventComponent(this->patternMap, e)
+    const auto viewStartBeat = this->getBeatByXPosition(float(fullArea.getX()));
+    const auto viewEndBeat = this->getBeatByXPosition(float(fullArea.getRight()));
+
+    for (const auto *track : this->project.getTracks())
     {
-        auto *nc = e.second.get();
-        if (nc->getBounds().intersects(centreArea))
+        const auto *sequence = dynamic_cast<const PianoSequence *>(track->getSequence());
+        if (sequence == nullptr || sequence->isEmpty() || track->getPattern() == nullptr)
         {
-            visibilityWeights[nc->getClip()] += 4;
+            continue;
         }
-        else if (nc->getBounds().intersects(fullArea))
+
+        const auto notes = sequence->getPackedNotes();
+        for (int c = 0; c < track->getPattern()->size(); ++c)
         {
-            visibilityWeights[nc->getClip()] += 1;
+            const auto *clip = track->getPattern()->getUnchecked(c);
+            const auto startBeat = viewStartBeat - clip->getBeat();
+            const auto endBeat = viewEndBeat - clip->getBeat();
+
+            for (int i = notes->indexOfFirstEndingAfter(startBeat);
+                i < notes->size() && notes->beats.getUnchecked(i) < endBeat; ++i)
+            {
+                const auto bounds = this->getEventBounds(notes->keys.getUnchecked(i) + clip->getKey(),
+                    notes->beats.getUnchecked(i) + clip->getBeat(),
+                    notes->lengths.getUnchecked(i)).getSmallestIntegerContainer();
+
+                if (bounds.intersects(centreArea))
+                {
+                    visibilityWeights[*clip] += 4;
+                }
+                else if (bounds.intersects(fullArea))
+                {
+                    visibilityWeights[*clip] += 1;
+                }
+            }
         }
     }
 
@@ -1533,9 +2083,11 @@ void PianoRoll::startErasingEvents(const Point<float> &mousePosition)
 
 void PianoRoll::continueErasingEvents(const Point<float> &mousePosition)
 {
-    forEachEventComponent(this->patternMap, it)
+    Array<NoteComponent *> components;
+    this->findActiveNoteComponentsInArea(Rectangle<float>(1.f, 1.f).withCentre(mousePosition), components);
+
+    for (auto *nc : components)
     {
-        auto *nc = it.second.get();
         if (!nc->isActive() || !nc->isVisible())
         {
             continue;
@@ -1595,12 +2147,35 @@ void PianoRoll::continueCuttingEvents(const Point<float> &mousePosition)
         this->knifeToolHelper->setEndPosition(mousePosition);
         this->knifeToolHelper->updateBounds();
 
+        const auto knifeLine = this->knifeToolHelper->getLine();
+
+        Array<NoteComponent *> components;
+        this->findActiveNoteComponentsInArea(Rectangle<float>(knifeLine.getStart(),
+            knifeLine.getEnd()).expanded(1.f), components);
+
+        // the notes cut before might now be out of the line's bounds
+        Array<Note> cutNotes;
+        Array<float> cutBeats;
+        this->knifeToolHelper->getCutPoints(cutNotes, cutBeats);
+        for (const auto &note : cutNotes)
+        {
+            bool isCandidate = false;
+            for (const auto *nc : components)
+            {
+                isCandidate = isCandidate || nc->getNote() == note;
+            }
+
+            if (!isCandidate)
+            {
+                this->knifeToolHelper->removeCutPointIfExists(note);
+            }
+        }
+
         bool addsPoint;
         Point<float> intersection;
-        forEachEventComponent(this->patternMap, e)
+        for (auto *nc : components)
         {
             addsPoint = false;
-            auto *nc = e.second.get();
             if (!nc->isActive())
             {
                 continue;
@@ -1639,6 +2214,7 @@ void PianoRoll::endCuttingEventsIfNeeded()
         this->knifeToolHelper->getCutPoints(notes, beats);
         Array<Note> cutEventsToTheRight = SequencerOperations::cutNotes(notes, beats);
         // Now select all the new notes:
+        Lasso::ItemArray items;
         forEachSequenceMapOfGivenTrack(this->patternMap, c, this->activeTrack)
         {
             auto &sequenceMap = *c.second.get();
@@ -1646,11 +2222,13 @@ void PianoRoll::endCuttingEventsIfNeeded()
             {
                 if (auto *component = sequenceMap[note].get())
                 {
-                    this->selectEvent(component, false);
+                    items.add(component);
                 }
             }
         }
 
+        this->selection.selectAll(items);
+
         this->knifeToolHelper = nullptr;
     }
 }
@@ -1663,10 +2241,12 @@ void PianoRoll::startMergingEvents(const Point<float> &mousePosition)
 {
     this->deselectAll();
 
+    Array<NoteComponent *> components;
+    this->findActiveNoteComponentsInArea(Rectangle<float>(1.f, 1.f).withCentre(mousePosition), components);
+
     NoteComponent *targetNote = nullptr;
-    forEachEventComponent(this->patternMap, e)
+    for (auto *nc : components)
     {
-        auto *nc = e.second.get();
         if (nc->isActive() &&
             nc->getBounds().contains(mousePosition.toInt()))
         {
@@ -1689,10 +2269,12 @@ void PianoRoll::continueMergingEvents(const Point<float> &mousePosition)
         return;
     }
 
+    Array<NoteComponent *> components;
+    this->findActiveNoteComponentsInArea(Rectangle<float>(1.f, 1.f).withCentre(mousePosition), components);
+
     NoteComponent *targetNote = nullptr;
-    forEachEventComponent(this->patternMap, e)
+    for (auto *nc : components)
     {
-        auto *nc = e.second.get();
         if (nc->isActive() &&
             nc->getBounds().contains(mousePosition.toInt()) &&
             this->mergeToolHelper->canMergeInto(nc))
@@ -1730,7 +2312,7 @@ void PianoRoll::endMergingEvents()
 // RollBase
 //===----------------------------------------------------------------------===//
 
-void PianoRoll::handleAsyncUpdate()
+void PianoRoll::onFrame(double frameTimeMs)
 {
 #if PIANOROLL_HAS_NOTE_RESIZERS
     // resizers for the mobile version
@@ -1772,7 +2354,7 @@ void PianoRoll::handleAsyncUpdate()
     }
 #endif
 
-    RollBase::handleAsyncUpdate();
+    RollBase::onFrame(frameTimeMs);
 }
 
 void PianoRoll::changeListenerCallback(ChangeBroadcaster *source)
@@ -1783,6 +2365,8 @@ void PianoRoll::changeListenerCallback(ChangeBroadcaster *source)
 
 void PianoRoll::updateChildrenBounds()
 {
+    TRACE_ZONE("PianoRoll::updateChildrenBounds");
+
 #if PIANOROLL_HAS_NOTE_RESIZERS
     if (this->noteResizerLeft != nullptr)
     {
@@ -1911,6 +2495,7 @@ void PianoRoll::updateBackgroundCachesAndRepaint()
     this->defaultHighlighting->renderBackgroundCache(this->temperament);
 
     this->backgroundsCache.clear();
+    this->backgroundTiles.clear();
 
     for (const auto *track : this->project.getTracks())
     {
@@ -1933,6 +2518,8 @@ void PianoRoll::updateBackgroundCachesAndRepaint()
 
 void PianoRoll::updateBackgroundCacheFor(const KeySignatureEvent &key)
 {
+    this->backgroundTiles.clear();
+
     int duplicateSchemeIndex = this->binarySearchForHighlightingScheme(&key);
     if (duplicateSchemeIndex < 0)
     {
@@ -1944,6 +2531,8 @@ void PianoRoll::updateBackgroundCacheFor(const KeySignatureEvent &key)
 
 void PianoRoll::removeBackgroundCacheFor(const KeySignatureEvent &key)
 {
+    this->backgroundTiles.clear();
+
     const auto keySignatures = this->project.getTimeline()->getKeySignatures()->getSequence();
     for (int i = 0; i < keySignatures->size(); ++i)
     {
@@ -2025,6 +2614,7 @@ void PianoRoll::showChordTool(ToolType type, Point<int> position)
 void PianoRoll::onScalesHighlightingFlagChanged(bool enabled)
 {
     this->scalesHighlightingEnabled = enabled;
+    this->backgroundTiles.clear();
     this->repaint();
 }
 
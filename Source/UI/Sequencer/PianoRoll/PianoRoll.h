@@ -35,8 +35,11 @@ class NoteNameGuidesBar;
 #include "HighlightingScheme.h"
 #include "CommandPaletteModel.h"
 #include "MidiTrack.h"
+#include "MidiRecorder.h"
 
-class PianoRoll final : public RollBase, public CommandPaletteModel
+class PianoRoll final : public RollBase,
+                        public CommandPaletteModel,
+                        private MidiRecorder::Listener
 {
 public:
 
@@ -93,6 +96,11 @@ public:
     void hideDragHelpers();
     void moveDragHelpers(const float deltaBeat, const int deltaKey);
 
+    // the lightweight channel for the interactive edits in progress:
+    // the notes are already changed in place, so only their components
+    // are updated, and nobody else is notified until the edit is committed
+    void onPreviewNoteChanges(const Array<Note> &notes, const MidiTrack *track);
+
     //===------------------------------------------------------------------===//
     // ProjectListener
     //===------------------------------------------------------------------===//
@@ -100,6 +108,10 @@ public:
     void onChangeMidiEvent(const MidiEvent &oldEvent, const MidiEvent &newEvent) override;
     void onAddMidiEvent(const MidiEvent &event) override;
     void onRemoveMidiEvent(const MidiEvent &event) override;
+    void onAddMidiEvents(const Array<const MidiEvent *> &events) override;
+    void onChangeMidiEvents(const Array<const MidiEvent *> &oldEvents,
+        const Array<const MidiEvent *> &newEvents) override;
+    void onRemoveMidiEvents(const Array<const MidiEvent *> &events) override;
 
     void onAddClip(const Clip &clip) override;
     void onChangeClip(const Clip &oldClip, const Clip &newClip) override;
@@ -126,7 +138,7 @@ public:
     void onNoteNameGuidesFlagChanged(bool enabled) override;
 
     //===------------------------------------------------------------------===//
-    // LassoSource
+    // Lasso
     //===------------------------------------------------------------------===//
 
     void selectEventsInRange(float startBeat,
@@ -135,6 +147,14 @@ public:
     void findLassoItemsInArea(Array<SelectableComponent *> &itemsFound,
         const Rectangle<int> &rectangle) override;
 
+    // the bulk selection helpers look up the active clip's notes
+    // in one pass and change the selection at once, so that there's
+    // only one change message, no matter how many notes are selected
+    void selectNotesIf(const Function<bool(const Note &)> &predicate, bool shouldClearAllOthers);
+    void selectNotesWithKey(int key, bool shouldClearAllOthers);
+    void selectNotesInVelocityRange(float minVelocity, float maxVelocity, bool shouldClearAllOthers);
+    void invertSelection();
+
     float getLassoStartBeat() const;
     float getLassoEndBeat() const;
 
@@ -149,12 +169,13 @@ public:
     void handleCommandMessage(int commandId) override;
     void resized() override;
     void paint(Graphics &g) override;
+    void paintOverChildren(Graphics &g) override;
     
     //===------------------------------------------------------------------===//
     // RollBase's legacy
     //===------------------------------------------------------------------===//
     
-    void handleAsyncUpdate() override;
+    void onFrame(double frameTimeMs) override;
     void changeListenerCallback(ChangeBroadcaster *source) override;
 
     //===------------------------------------------------------------------===//
@@ -181,6 +202,18 @@ protected:
     float findNextAnchorBeat(float beat) const override;
     float findPreviousAnchorBeat(float beat) const override;
 
+private:
+
+    //===------------------------------------------------------------------===//
+    // MidiRecorder::Listener
+    //===------------------------------------------------------------------===//
+
+    void onChangeRecordedNotes(const Array<Note> &notesBefore,
+        const Array<Note> &notesAfter) override;
+    void onClearRecordedNotes() override;
+
+    Rectangle<float> getRecordedNoteBounds(const Clip &clip, const Note &note) const;
+
 private:
 
     WeakReference<MidiTrack> activeTrack = nullptr;
@@ -191,7 +224,21 @@ private:
 private:
 
     void reloadRollContent();
-    void loadTrack(const MidiTrack *const track);
+
+    // only the active clip's notes are real components, which can be
+    // selected and edited; all the other clips are painted by the roll
+    // in one pass, right from the sequences' packed notes
+    void loadActiveClip();
+    void loadClip(const Clip &clip);
+    void paintInactiveNotes(Graphics &g) const;
+    void repaintInactiveNotesOf(const MidiTrack *track);
+    const Clip *findInactiveClipAt(const Point<float> &position) const;
+
+    // the active clip's components intersecting the area, found with
+    // the sequence's interval lookups instead of checking all components,
+    // used for the lasso, the knife, the merging and the erasing tools
+    void findActiveNoteComponentsInArea(const Rectangle<float> &area,
+        Array<NoteComponent *> &outComponents) const;
 
     void updateSize();
     void updateChildrenBounds() override;
@@ -249,6 +296,37 @@ private:
     UniquePointer<HighlightingScheme> defaultHighlighting;
     int binarySearchForHighlightingScheme(const KeySignatureEvent *const e) const noexcept;
     friend class ThemeSettingsItem; // to be able to call renderRowsPattern
+
+    // the rows and the grid lines are rendered together into tiles
+    // of one period height, so that scrolling just blits the images
+    static constexpr auto backgroundTileWidth = 256;
+    FlatHashMap<int, Image> backgroundTiles;
+    Image getBackgroundTile(int column);
+    Image renderBackgroundTile(int column);
+    void paintRows(Graphics &g, int paintStartX, int paintEndX, int periodHeight) const;
+    void removeBackgroundTilesOutside(int firstColumn, int lastColumn);
+
+    // the tiles are re-rendered when any of these changes,
+    // or when the key signatures change, or the theme, or the temperament
+    struct BackgroundTilesKey final
+    {
+        int timeSignaturesVersion = -1;
+        float beatWidth = 0.f;
+        float firstBeat = 0.f;
+        float projectFirstBeat = 0.f;
+        int rowHeight = 0;
+
+        bool operator==(const BackgroundTilesKey &other) const noexcept
+        {
+            return this->timeSignaturesVersion == other.timeSignaturesVersion &&
+                this->beatWidth == other.beatWidth &&
+                this->firstBeat == other.firstBeat &&
+                this->projectFirstBeat == other.projectFirstBeat &&
+                this->rowHeight == other.rowHeight;
+        }
+    };
+
+    BackgroundTilesKey backgroundTilesKey;
     
     bool scalesHighlightingEnabled = true;
 
@@ -272,7 +350,16 @@ private:
 
     using SequenceMap = FlatHashMap<Note, UniquePointer<NoteComponent>, MidiEventHash>;
     using PatternMap = FlatHashMap<Clip, UniquePointer<SequenceMap>, ClipHash>;
-    PatternMap patternMap;
+    PatternMap patternMap; // only has the active clip, see loadActiveClip
+
+    // the note events are applied to each clip of the track,
+    // the group events visit each clip once for all notes
+    void addNoteComponent(const Note &note, const Clip &clip, SequenceMap &sequenceMap);
+    void updateNoteComponent(const Note &oldNote, const Note &newNote, SequenceMap &sequenceMap);
+    void removeNoteComponent(const Note &note, SequenceMap &sequenceMap);
+
+    void applyBulkSelection(const Lasso::ItemArray &items, bool shouldClearAllOthers);
+    const Clip *findRealClip(const Clip &clip, const MidiTrack *track) const;
 
 private:
 
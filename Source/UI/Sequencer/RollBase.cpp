@@ -697,22 +697,53 @@ float RollBase::getMinVisibleBeatForCurrentZoomLevel() const
 
 void RollBase::computeAllSnapLines()
 {
-    static constexpr auto minBarWidth = 14;
-    static constexpr auto minBeatWidth = 8;
+    auto *timeSignatureAggregator = this->project.getTimeline()->getTimeSignaturesAggregator();
 
-    constexpr auto beatsPerBar = float(Globals::beatsPerBar);
+    SnapLinesKey key;
+    key.timeSignaturesVersion = timeSignatureAggregator->getVersion();
+    key.beatWidth = this->beatWidth;
+    key.firstBeat = this->firstBeat;
+    key.projectFirstBeat = this->projectFirstBeat;
+    key.viewX = this->viewport.getViewPositionX();
+    key.viewWidth = this->viewport.getViewWidth();
+
+    if (key == this->snapLinesKey)
+    {
+        this->allSnaps.removeLast(this->allSnaps.size() - this->numGridSnaps);
+        return;
+    }
+
+    this->snapLinesKey = key;
 
     this->visibleBars.clearQuick();
     this->visibleBeats.clearQuick();
     this->visibleSnaps.clearQuick();
     this->allSnaps.clearQuick();
 
-    auto *timeSignatureAggregator = this->project.getTimeline()->getTimeSignaturesAggregator();
-    const auto *orderedTimeSignatures = timeSignatureAggregator->getSequence();
-
     const float paintStartX = float(this->viewport.getViewPositionX());
     const float paintEndX = float(paintStartX + this->viewport.getViewWidth());
 
+    this->computeGridLines(paintStartX, paintEndX,
+        this->visibleBars, this->visibleBeats, this->visibleSnaps);
+
+    this->allSnaps.addArray(this->visibleBars);
+    this->allSnaps.addArray(this->visibleBeats);
+    this->allSnaps.addArray(this->visibleSnaps);
+
+    this->numGridSnaps = this->allSnaps.size();
+}
+
+void RollBase::computeGridLines(float paintStartX, float paintEndX,
+    Array<float> &bars, Array<float> &beats, Array<float> &snaps) const
+{
+    static constexpr auto minBarWidth = 14;
+    static constexpr auto minBeatWidth = 8;
+
+    constexpr auto beatsPerBar = float(Globals::beatsPerBar);
+
+    auto *timeSignatureAggregator = this->project.getTimeline()->getTimeSignaturesAggregator();
+    const auto *orderedTimeSignatures = timeSignatureAggregator->getSequence();
+
     const float barWidth = float(this->beatWidth * beatsPerBar);
     const float firstBar = this->firstBeat / beatsPerBar;
     const float paintStartBar = floorf(paintStartX / barWidth + firstBar);
@@ -768,8 +799,7 @@ void RollBase::computeAllSnapLines()
         {
             if (canDrawBarLine)
             {
-                this->visibleBars.add(barStartX);
-                this->allSnaps.add(barStartX);
+                bars.add(barStartX);
             }
 
             // the beat lines
@@ -781,15 +811,13 @@ void RollBase::computeAllSnapLines()
                 // snap lines and beat lines
                 for (float k = beatStartX + snapWidth; k < (nextBeatStartX - 1); k += snapWidth)
                 {
-                    this->visibleSnaps.add(k);
-                    this->allSnaps.add(k);
+                    snaps.add(k);
                 }
 
                 if (j >= beatStep && // don't draw the first one as it is a bar line
                     (nextBeatStartX - beatStartX) > minBeatWidth)
                 {
-                    this->visibleBeats.add(beatStartX);
-                    this->allSnaps.add(beatStartX);
+                    beats.add(beatStartX);
                 }
             }
         }
@@ -825,8 +853,7 @@ void RollBase::computeAllSnapLines()
         {
             if (canDrawBarLine)
             {
-                this->visibleBars.add(barStartX);
-                this->allSnaps.add(barStartX);
+                bars.add(barStartX);
             }
 
             // the beat lines
@@ -856,15 +883,13 @@ void RollBase::computeAllSnapLines()
                 // snap lines and beat lines
                 for (float k = beatStartX + snapWidth; k < (nextBeatStartX - 1); k += snapWidth)
                 {
-                    this->visibleSnaps.add(k);
-                    this->allSnaps.add(k);
+                    snaps.add(k);
                 }
 
                 if (j >= beatStep && // don't draw the first one as it is a bar line
                     (nextBeatStartX - beatStartX) > minBeatWidth)
                 {
-                    this->visibleBeats.add(beatStartX);
-                    this->allSnaps.add(beatStartX);
+                    beats.add(beatStartX);
                 }
             }
         }
@@ -905,7 +930,7 @@ bool RollBase::isUsingSpaceDraggingMode() const
 }
 
 //===----------------------------------------------------------------------===//
-// LassoSource
+// Lasso
 //===----------------------------------------------------------------------===//
 
 Lasso &RollBase::getLassoSelection()
@@ -1515,34 +1540,43 @@ void RollBase::resized()
 
 void RollBase::paint(Graphics &g)
 {
+    TRACE_ZONE("RollBase::paint");
+
     this->computeAllSnapLines();
 
-    const float y = float(this->viewport.getViewPositionY());
-    const float h = float(this->viewport.getViewHeight());
+    this->paintGridLines(g, this->visibleBars, this->visibleBeats, this->visibleSnaps,
+        float(this->viewport.getViewPositionY()), float(this->viewport.getViewHeight()));
+}
 
-    g.setColour(this->barLineColour);
-    for (const auto &f : this->visibleBars)
+void RollBase::paintGridLines(Graphics &g, const Array<float> &bars,
+    const Array<float> &beats, const Array<float> &snaps, float y, float h)
+{
+    // each kind of lines is filled in one call, which both renderers
+    // handle as a single batch, instead of a call per line
+    const auto fillLines = [&g, y, h](RectangleList<float> &batch,
+        const Array<float> &lines, float offset)
     {
-        g.fillRect(floorf(f), y, 1.f, h);
-    }
+        batch.clear();
+        batch.ensureStorageAllocated(lines.size());
+        for (const auto &f : lines)
+        {
+            batch.addWithoutMerging({ floorf(f + offset), y, 1.f, h });
+        }
+
+        g.fillRectList(batch);
+    };
+
+    g.setColour(this->barLineColour);
+    fillLines(this->linesBatch, bars, 0.f);
 
     g.setColour(this->barLineBevelColour);
-    for (const auto &f : this->visibleBars)
-    {
-        g.fillRect(floorf(f + 1.f), y, 1.f, h);
-    }
+    fillLines(this->linesBatch, bars, 1.f);
 
     g.setColour(this->beatLineColour);
-    for (const auto &f : this->visibleBeats)
-    {
-        g.fillRect(floorf(f), y, 1.f, h);
-    }
+    fillLines(this->linesBatch, beats, 0.f);
 
     g.setColour(this->snapLineColour);
-    for (const auto &f : this->visibleSnaps)
-    {
-        g.fillRect(floorf(f), y, 1.f, h);
-    }
+    fillLines(this->linesBatch, snaps, 0.f);
 }
 
 //===----------------------------------------------------------------------===//
@@ -1551,17 +1585,21 @@ void RollBase::paint(Graphics &g)
 
 void RollBase::onPlayheadMoved(int playheadX)
 {
-    if (this->shouldFollowPlayhead)
-    {
-        const int viewHalfWidth = this->viewport.getViewWidth() / 2;
-        const int viewportCentreX = this->viewport.getViewPositionX() + viewHalfWidth;
-        const double offset = double(playheadX) - double(viewportCentreX);
-        // Smoothness should depend on zoom level (TODO it smarter):
-        const double smoothCoefficient = (this->beatWidth > 75) ? 0.915 : 0.975;
-        const double smoothThreshold = (this->beatWidth > 75) ? 128.0 : 5.0;
-        const double newOffset = (abs(offset) < smoothThreshold) ? 0.0 : offset * smoothCoefficient;
-        const int newViewPosX = playheadX - viewHalfWidth - int(round(newOffset));
-        this->viewport.setViewPosition(newViewPosX, this->viewport.getViewPositionY());
+    // while scrolling to the playhead, the view is moved on each frame anyway
+    if (!this->shouldFollowPlayhead || FrameScheduler::getInstance().isAnimating(this))
+    {
+        return;
+    }
+
+    // otherwise, the playhead moves across the still view,
+    // which only repaints the narrow strips it leaves and enters
+    const int viewX = this->viewport.getViewPositionX();
+    const int viewWidth = this->viewport.getViewWidth();
+    const int pageEndX = viewX + int(float(viewWidth) * RollBase::followPlayheadPageEnd);
+    if (playheadX < viewX || playheadX > pageEndX)
+    {
+        const int pageStartOffset = int(float(viewWidth) * RollBase::followPlayheadPageStart);
+        this->viewport.setViewPosition(playheadX - pageStartOffset, this->viewport.getViewPositionY());
         this->updateChildrenPositions();
     }
 }
@@ -1643,11 +1681,11 @@ void RollBase::onUiAnimationsFlagChanged(bool enabled)
 #if PLATFORM_DESKTOP
     this->smoothPanController->setAnimationsEnabled(enabled);
     this->smoothZoomController->setAnimationsEnabled(enabled);
-    this->scrollToPlayheadTimerMs = enabled ? 7 : 1;
+    this->scrollToPlayheadStepMs = enabled ? 7 : 1;
 #elif PLATFORM_MOBILE
     this->smoothPanController->setAnimationsEnabled(false);
     this->smoothZoomController->setAnimationsEnabled(false);
-    this->scrollToPlayheadTimerMs = 1;
+    this->scrollToPlayheadStepMs = 1;
 #endif
 }
 
@@ -1707,7 +1745,7 @@ void RollBase::stopFollowingPlayhead()
     }
 
 #if ROLL_VIEW_FOLLOWS_PLAYHEAD
-    this->stopTimer();
+    FrameScheduler::getInstance().stopAnimation(this);
     this->shouldFollowPlayhead = false;
 #endif
 }
@@ -1716,7 +1754,7 @@ void RollBase::scrollToPlayheadPosition()
 {
 #if ROLL_VIEW_FOLLOWS_PLAYHEAD
     this->startFollowingPlayhead();
-    this->startTimer(this->scrollToPlayheadTimerMs);
+    FrameScheduler::getInstance().startAnimation(this);
 #else
     const int playheadX = this->getXPositionByBeat(this->lastTransportBeat.get());
     this->viewport.setViewPosition(playheadX -
@@ -1727,10 +1765,10 @@ void RollBase::scrollToPlayheadPosition()
 }
 
 //===----------------------------------------------------------------------===//
-// AsyncUpdater
+// FrameScheduler::Client
 //===----------------------------------------------------------------------===//
 
-void RollBase::handleAsyncUpdate()
+void RollBase::onFrame(double frameTimeMs)
 {
     // batch repaint & resize stuff
     if (this->batchRepaintList.size() > 0)
@@ -1761,22 +1799,32 @@ void RollBase::handleAsyncUpdate()
     }
 
 #if ROLL_VIEW_FOLLOWS_PLAYHEAD
-    if (this->isTimerRunning())
+    if (FrameScheduler::getInstance().isAnimating(this))
     {
+        // the offset used to decrease by 0.9 each step, now there are
+        // several steps per frame, depending on the animation speed:
+        static constexpr auto frameMs = 1000.0 / double(FrameScheduler::framesPerSecond);
+        const auto factor = pow(0.9, frameMs / double(this->scrollToPlayheadStepMs));
+
         const int playheadX = this->getPlayheadPositionByBeat(this->lastTransportBeat.get(), double(this->getWidth()));
-        const int newX = playheadX - int(this->playheadOffset.get() * 0.9) - (this->viewport.getViewWidth() / 2);
+        const int newX = playheadX - int(this->playheadOffset.get() * factor) - (this->viewport.getViewWidth() / 2);
         const bool stuckFollowingPlayhead = newX == this->viewport.getViewPositionX() ||
             newX < 0 || newX > (this->getWidth() - this->viewport.getViewWidth());
 
         if (stuckFollowingPlayhead)
         {
-            this->stopTimer();
+            FrameScheduler::getInstance().stopAnimation(this);
         }
         else
         {
             this->viewport.setViewPosition(newX, this->viewport.getViewPositionY());
             this->playheadOffset = this->findPlayheadOffsetFromViewCentre();
             this->updateChildrenPositions();
+
+            if (fabs(this->playheadOffset.get()) < 0.1)
+            {
+                FrameScheduler::getInstance().stopAnimation(this);
+            }
         }
     }
 #endif
@@ -1792,21 +1840,51 @@ double RollBase::findPlayheadOffsetFromViewCentre() const
 void RollBase::triggerBatchRepaintFor(FloatBoundsComponent *target)
 {
     this->batchRepaintList.add(target);
-    this->triggerAsyncUpdate();
+    FrameScheduler::getInstance().requestFrame(this);
 }
 
-//===----------------------------------------------------------------------===//
-// Timer
-//===----------------------------------------------------------------------===//
+Rectangle<int> RollBase::getEventsLayoutArea() const
+{
+    // with a margin, so that panning doesn't have to catch up every frame
+    const auto viewArea = this->viewport.getViewArea();
+    return viewArea.expanded(viewArea.getWidth() / 2, viewArea.getHeight() / 2);
+}
 
-void RollBase::hiResTimerCallback()
+void RollBase::updateEventBoundsIfVisible(FloatBoundsComponent *component,
+    const Rectangle<int> &layoutArea)
 {
-    if (fabs(this->playheadOffset.get()) < 0.1)
+    // the stale bounds also count: the component must not
+    // stay visible at its old position after zooming
+    const auto bounds = this->getEventBounds(component);
+    if (component->getBounds().intersects(layoutArea) ||
+        bounds.getSmallestIntegerContainer().intersects(layoutArea))
+    {
+        component->setFloatBounds(bounds);
+    }
+    else
     {
-        this->stopTimer();
+        this->offscreenEventComponents.add(component);
     }
+}
 
-    this->triggerAsyncUpdate();
+void RollBase::updateOffscreenEventBounds()
+{
+    if (this->offscreenEventComponents.isEmpty())
+    {
+        return;
+    }
+
+    Array<SafePointer<FloatBoundsComponent>> components;
+    components.swapWith(this->offscreenEventComponents);
+
+    const auto layoutArea = this->getEventsLayoutArea();
+    for (auto &component : components)
+    {
+        if (component != nullptr)
+        {
+            this->updateEventBoundsIfVisible(component, layoutArea);
+        }
+    }
 }
 
 //===----------------------------------------------------------------------===//
@@ -2024,6 +2102,8 @@ void RollBase::updateChildrenPositions()
 {
     ROLL_BATCH_REPAINT_START
 
+    this->updateOffscreenEventBounds();
+
     const int &viewHeight = this->viewport.getViewHeight();
     const int &viewX = this->viewport.getViewPositionX();
     const int &viewY = this->viewport.getViewPositionY();
@@ -52,6 +52,7 @@ class TimelineWarningMarker;
 #include "HeadlineContextMenuController.h"
 #include "TimeSignaturesAggregator.h"
 #include "Temperament.h"
+#include "FrameScheduler.h"
 
 #if PLATFORM_MOBILE
 #   define ROLL_LISTENS_LONG_TAP 1
@@ -71,13 +72,11 @@ class RollBase :
     public SmoothZoomListener,
     public MultiTouchListener,
     public ProjectListener,
-    public LassoSource<SelectableComponent *>,
     public Playhead::Listener, // for smooth scrolling to seek position
     protected UserInterfaceFlags::Listener, // global UI options
     protected ChangeListener, // listens to RollEditMode,
     protected TransportListener, // for positioning the playhead component and auto-scrolling
-    protected AsyncUpdater, // coalesce multiple transport events ^^ into a single async view change
-    protected HighResolutionTimer, // for smooth scrolling to seek position,
+    protected FrameScheduler::Client, // for batch repaints and smooth scrolling to seek position
     protected TimeSignaturesAggregator::Listener, // when the editable scope changes, active time signatures may change
     protected AudioMonitor::ClippingListener // for displaying clipping indicator components
 {
@@ -222,13 +221,16 @@ public:
     void stopFollowingPlayhead();
     
     //===------------------------------------------------------------------===//
-    // LassoSource
+    // Lasso
     //===------------------------------------------------------------------===//
 
     virtual void selectEventsInRange(float startBeat,
         float endBeat, bool shouldClearAllOthers) = 0;
 
-    Lasso &getLassoSelection() override;
+    virtual void findLassoItemsInArea(Array<SelectableComponent *> &itemsFound,
+        const Rectangle<int> &area) = 0;
+
+    Lasso &getLassoSelection();
     void selectEvent(SelectableComponent *event, bool shouldClearAllOthers);
     void deselectEvent(SelectableComponent *event);
     void deselectAll();
@@ -315,23 +317,24 @@ protected:
 
     Atomic<double> playheadOffset = 0.0;
     bool shouldFollowPlayhead = false;
-    int scrollToPlayheadTimerMs = 7;
+    // the smooth scrolling speed, as if it made a step each this many ms
+    int scrollToPlayheadStepMs = 7;
+
+    // once caught up, the view follows the playhead in pages,
+    // because every scroll step means repainting the whole roll:
+    // when the playhead goes past the page end, it is moved to the page start
+    static constexpr auto followPlayheadPageStart = 0.25f;
+    static constexpr auto followPlayheadPageEnd = 0.85f;
 
     //===------------------------------------------------------------------===//
-    // AsyncUpdater
+    // FrameScheduler::Client
     //===------------------------------------------------------------------===//
     
-    void handleAsyncUpdate() override;
+    void onFrame(double frameTimeMs) override;
 
     double findPlayheadOffsetFromViewCentre() const;
     friend class RollHeader;
     
-    //===------------------------------------------------------------------===//
-    // Timer
-    //===------------------------------------------------------------------===//
-
-    void hiResTimerCallback() override;
-    
 protected:
     
     // These two methods are supposed to layout non-midi-event children
@@ -427,6 +430,33 @@ protected:
     // contains all three above so that it' easier to iterate them
     Array<float> allSnaps;
 
+    // the grid lines only depend on these, so they are only recomputed
+    // when zooming, scrolling or changing the time signatures,
+    // and not on every repaint, e.g. when dragging notes around
+    struct SnapLinesKey final
+    {
+        int timeSignaturesVersion = -1;
+        float beatWidth = 0.f;
+        float firstBeat = 0.f;
+        float projectFirstBeat = 0.f;
+        int viewX = 0;
+        int viewWidth = 0;
+
+        bool operator==(const SnapLinesKey &other) const noexcept
+        {
+            return this->timeSignaturesVersion == other.timeSignaturesVersion &&
+                this->beatWidth == other.beatWidth &&
+                this->firstBeat == other.firstBeat &&
+                this->projectFirstBeat == other.projectFirstBeat &&
+                this->viewX == other.viewX &&
+                this->viewWidth == other.viewWidth;
+        }
+    };
+
+    SnapLinesKey snapLinesKey;
+    // subclasses may add more snaps after the grid ones
+    int numGridSnaps = 0;
+
     const Colour barLineColour;
     const Colour barLineBevelColour;
     const Colour beatLineColour;
@@ -434,6 +464,17 @@ protected:
 
     virtual void computeAllSnapLines();
 
+    // computes the grid lines within the given range of x positions,
+    // which is the visible area, or the area of a cached background tile
+    void computeGridLines(float paintStartX, float paintEndX,
+        Array<float> &bars, Array<float> &beats, Array<float> &snaps) const;
+
+    void paintGridLines(Graphics &g, const Array<float> &bars,
+        const Array<float> &beats, const Array<float> &snaps, float y, float h);
+
+    // reused in each paint call, not to reallocate it
+    RectangleList<float> linesBatch;
+
 protected:
 
     UniquePointer<LongTapController> longTapController;
@@ -444,6 +485,15 @@ protected:
 
     Array<SafePointer<FloatBoundsComponent>> batchRepaintList;
 
+    // on zooming or resizing, only the event components in the viewport
+    // or near it are laid out; the rest are left as they are, until
+    // they are scrolled into view, see updateChildrenPositions
+    Array<SafePointer<FloatBoundsComponent>> offscreenEventComponents;
+    Rectangle<int> getEventsLayoutArea() const;
+    void updateEventBoundsIfVisible(FloatBoundsComponent *component,
+        const Rectangle<int> &layoutArea);
+    void updateOffscreenEventBounds();
+
 protected:
     
     void changeListenerCallback(ChangeBroadcaster *source) override;
@@ -16,8 +16,8 @@
 */
 
 #include "Common.h"
-#include "Lasso.h"
 #include "SelectionComponent.h"
+#include "RollBase.h"
 #include "ColourIDs.h"
 
 SelectionComponent::SelectionComponent() :
@@ -31,8 +31,7 @@ SelectionComponent::SelectionComponent() :
     this->setInterceptsMouseClicks(false, false);
 }
 
-void SelectionComponent::beginLasso(const Point<float> &position,
-    LassoSource<SelectableComponent *> *lassoSource)
+void SelectionComponent::beginLasso(const Point<float> &position, RollBase *lassoSource)
 {
     jassert(lassoSource != nullptr);
     jassert(this->getParentComponent() != nullptr);
@@ -60,18 +59,28 @@ void SelectionComponent::dragLasso(const MouseEvent &e)
         this->itemsInLasso.clearQuick();
         this->source->findLassoItemsInArea(this->itemsInLasso, this->getBounds());
 
+        // the lasso ignores the duplicates
         if (e.mods.isShiftDown())
         {
-            this->itemsInLasso.removeValuesIn(this->originalSelection);
             this->itemsInLasso.addArray(this->originalSelection);
         }
         else if (e.mods.isAltDown())
         {
-            this->originalSelection.removeValuesIn(this->itemsInLasso);
+            FlatHashSet<SelectableComponent *> itemsInLassoSet;
+            for (auto *item : this->itemsInLasso)
+            {
+                itemsInLassoSet.insert(item);
+            }
+
+            this->originalSelection.removeIf([&itemsInLassoSet](SelectableComponent *item)
+            {
+                return itemsInLassoSet.find(item) != itemsInLassoSet.end();
+            });
+
             this->itemsInLasso = this->originalSelection;
         }
 
-        this->source->getLassoSelection() = Lasso(this->itemsInLasso);
+        this->source->getLassoSelection().setSelection(this->itemsInLasso);
     }
 }
 
@@ -17,6 +17,8 @@
 
 #pragma once
 
+class RollBase;
+
 #include "SelectableComponent.h"
 
 class SelectionComponent final : public Component, private Timer
@@ -25,8 +27,7 @@ public:
 
     SelectionComponent();
 
-    void beginLasso(const Point<float> &position,
-        LassoSource<SelectableComponent *> *lassoSource);
+    void beginLasso(const Point<float> &position, RollBase *lassoSource);
     void dragLasso(const MouseEvent &e);
     void endLasso();
     bool isDragging() const;
@@ -37,7 +38,7 @@ public:
 private:
 
     Array<SelectableComponent *> originalSelection;
-    LassoSource<SelectableComponent *> *source = nullptr;
+    RollBase *source = nullptr;
 
     Point<double> startPosition { 0, 0 };
     Point<double> endPosition { 0, 0 };
@@ -521,6 +521,7 @@ SequencerLayout::SequencerLayout(ProjectNode &parentProject) :
     this->sequencerLayout->addShadowAtTheStart();
     this->sequencerLayout->addShadowAtTheEnd();
     this->sequencerLayout->addFixedPage(this->rollToolsSidebar.get());
+    this->sequencerLayout->setLiveResizeEnabled(true);
 
     this->addAndMakeVisible(this->sequencerLayout.get());
 
@@ -616,9 +617,6 @@ RollBase *SequencerLayout::getRoll() const noexcept
 void SequencerLayout::resized()
 {
     this->sequencerLayout->setBounds(this->getLocalBounds());
-
-    // a hack for themes changing
-    this->rollToolsSidebar->resized();
 }
 
 void SequencerLayout::proceedToRenderDialog(RenderFormat format)
@@ -122,8 +122,11 @@ void SequencerSidebarRight::resized()
     this->transportControl->setBounds(0,
         this->getHeight() - transportControlSize,
         this->getWidth(), transportControlSize);
+}
 
-    // a hack for themes changing:
+void SequencerSidebarRight::lookAndFeelChanged()
+{
+    // the rows are not rebuilt on every resize, only when the theme changes
     this->listBox->updateContent();
     this->annotationsButton->resized();
 }
@@ -45,6 +45,7 @@ public:
 
     void paint(Graphics& g) override;
     void resized() override;
+    void lookAndFeelChanged() override;
 
 private:
 
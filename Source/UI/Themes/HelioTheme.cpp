@@ -727,143 +727,165 @@ void HelioTheme::updateFont(const Font &font)
 #endif
 }
 
+void HelioTheme::setPaletteColour(int colourId, Colour colour)
+{
+    this->setColour(colourId, colour);
+
+    const auto index = colourId - HelioTheme::paletteFirstId;
+    if (isPositiveAndBelow(index, HelioTheme::paletteSize))
+    {
+        this->palette[index] = { colour, true };
+    }
+}
+
+Colour findThemeColour(int colourId) noexcept
+{
+    auto &lookAndFeel = LookAndFeel::getDefaultLookAndFeel();
+    if (const auto *theme = dynamic_cast<const HelioTheme *>(&lookAndFeel))
+    {
+        return theme->findPaletteColour(colourId);
+    }
+
+    return lookAndFeel.findColour(colourId);
+}
+
 void HelioTheme::initColours(const ::ColourScheme::Ptr s)
 {
     // JUCE component colour id's:
 
     // Sliders
-    this->setColour(Slider::rotarySliderOutlineColourId, s->getTextColour().contrasting(0.9f).withMultipliedAlpha(0.5f));
-    this->setColour(Slider::rotarySliderFillColourId, s->getTextColour());
-    this->setColour(Slider::thumbColourId, s->getTextColour());
-    this->setColour(Slider::trackColourId, s->getTextColour().withMultipliedAlpha(0.5f));
+    this->setPaletteColour(Slider::rotarySliderOutlineColourId, s->getTextColour().contrasting(0.9f).withMultipliedAlpha(0.5f));
+    this->setPaletteColour(Slider::rotarySliderFillColourId, s->getTextColour());
+    this->setPaletteColour(Slider::thumbColourId, s->getTextColour());
+    this->setPaletteColour(Slider::trackColourId, s->getTextColour().withMultipliedAlpha(0.5f));
 
     // Labels
-    this->setColour(Label::textColourId, s->getTextColour());
-    this->setColour(Label::outlineColourId, s->getTextColour().contrasting());
+    this->setPaletteColour(Label::textColourId, s->getTextColour());
+    this->setPaletteColour(Label::outlineColourId, s->getTextColour().contrasting());
 
     // MainWindow
-    this->setColour(ResizableWindow::backgroundColourId, s->getPrimaryGradientColourA().brighter(0.045f));
-    this->setColour(ScrollBar::backgroundColourId, Colours::transparentBlack);
-    this->setColour(ScrollBar::thumbColourId, s->getPanelFillColour().withAlpha(1.f));
+    this->setPaletteColour(ResizableWindow::backgroundColourId, s->getPrimaryGradientColourA().brighter(0.045f));
+    this->setPaletteColour(ScrollBar::backgroundColourId, Colours::transparentBlack);
+    this->setPaletteColour(ScrollBar::thumbColourId, s->getPanelFillColour().withAlpha(1.f));
 
     // TextButton
-    this->setColour(TextButton::buttonColourId, s->getPanelFillColour());
-    this->setColour(TextButton::buttonOnColourId, s->getPanelBorderColour());
-    this->setColour(TextButton::textColourOnId, s->getTextColour().withMultipliedAlpha(0.75f));
-    this->setColour(TextButton::textColourOffId, s->getTextColour().withMultipliedAlpha(0.5f));
+    this->setPaletteColour(TextButton::buttonColourId, s->getPanelFillColour());
+    this->setPaletteColour(TextButton::buttonOnColourId, s->getPanelBorderColour());
+    this->setPaletteColour(TextButton::textColourOnId, s->getTextColour().withMultipliedAlpha(0.75f));
+    this->setPaletteColour(TextButton::textColourOffId, s->getTextColour().withMultipliedAlpha(0.5f));
 
     // TextEditor
-    this->setColour(TextEditor::textColourId, s->getTextColour());
-    this->setColour(TextEditor::backgroundColourId, s->getPrimaryGradientColourA().darker(0.055f));
-    this->setColour(TextEditor::outlineColourId, s->getPanelBorderColour().withAlpha(0.075f));
-    this->setColour(TextEditor::highlightedTextColourId, s->getTextColour());
-    this->setColour(TextEditor::focusedOutlineColourId, s->getTextColour().contrasting().withAlpha(0.2f));
-    this->setColour(TextEditor::shadowColourId, s->getPrimaryGradientColourA().darker(0.05f));
-    this->setColour(TextEditor::highlightColourId, s->getTextColour().contrasting().withAlpha(0.25f));
-    this->setColour(CaretComponent::caretColourId, s->getTextColour().withAlpha(0.35f));
+    this->setPaletteColour(TextEditor::textColourId, s->getTextColour());
+    this->setPaletteColour(TextEditor::backgroundColourId, s->getPrimaryGradientColourA().darker(0.055f));
+    this->setPaletteColour(TextEditor::outlineColourId, s->getPanelBorderColour().withAlpha(0.075f));
+    this->setPaletteColour(TextEditor::highlightedTextColourId, s->getTextColour());
+    this->setPaletteColour(TextEditor::focusedOutlineColourId, s->getTextColour().contrasting().withAlpha(0.2f));
+    this->setPaletteColour(TextEditor::shadowColourId, s->getPrimaryGradientColourA().darker(0.05f));
+    this->setPaletteColour(TextEditor::highlightColourId, s->getTextColour().contrasting().withAlpha(0.25f));
+    this->setPaletteColour(CaretComponent::caretColourId, s->getTextColour().withAlpha(0.35f));
 
     // TableListBox
-    this->setColour(ListBox::textColourId, s->getTextColour());
-    this->setColour(ListBox::backgroundColourId, Colours::transparentBlack);
-    this->setColour(TableHeaderComponent::backgroundColourId, Colours::transparentBlack);
-    this->setColour(TableHeaderComponent::outlineColourId, s->getPanelBorderColour().withAlpha(0.05f));
-    this->setColour(TableHeaderComponent::highlightColourId, s->getPrimaryGradientColourA().brighter(0.04f));
-    this->setColour(TableHeaderComponent::textColourId, s->getTextColour().withMultipliedAlpha(0.75f));
+    this->setPaletteColour(ListBox::textColourId, s->getTextColour());
+    this->setPaletteColour(ListBox::backgroundColourId, Colours::transparentBlack);
+    this->setPaletteColour(TableHeaderComponent::backgroundColourId, Colours::transparentBlack);
+    this->setPaletteColour(TableHeaderComponent::outlineColourId, s->getPanelBorderColour().withAlpha(0.05f));
+    this->setPaletteColour(TableHeaderComponent::highlightColourId, s->getPrimaryGradientColourA().brighter(0.04f));
+    this->setPaletteColour(TableHeaderComponent::textColourId, s->getTextColour().withMultipliedAlpha(0.75f));
 
     // Check boxes, radio buttons
-    this->setColour(ToggleButton::textColourId, s->getTextColour());
-    this->setColour(ToggleButton::tickColourId, s->getTextColour());
-    this->setColour(ToggleButton::tickDisabledColourId, s->getTextColour().withMultipliedAlpha(0.65f));
+    this->setPaletteColour(ToggleButton::textColourId, s->getTextColour());
+    this->setPaletteColour(ToggleButton::tickColourId, s->getTextColour());
+    this->setPaletteColour(ToggleButton::tickDisabledColourId, s->getTextColour().withMultipliedAlpha(0.65f));
 
     // Helio colours:
 
     // Lasso
-    this->setColour(ColourIDs::SelectionComponent::fill, s->getLassoFillColour().withAlpha(0.2f));
-    this->setColour(ColourIDs::SelectionComponent::outline, s->getLassoBorderColour().withAlpha(0.75f));
+    this->setPaletteColour(ColourIDs::SelectionComponent::fill, s->getLassoFillColour().withAlpha(0.2f));
+    this->setPaletteColour(ColourIDs::SelectionComponent::outline, s->getLassoBorderColour().withAlpha(0.75f));
     // Similar things for the roll header tools
-    this->setColour(ColourIDs::RollHeader::selection, s->getLassoBorderColour().withAlpha(0.8f));
-    this->setColour(ColourIDs::RollHeader::soundProbe, s->getLassoBorderColour().withMultipliedBrightness(1.1f).withAlpha(0.75f));
-    this->setColour(ColourIDs::RollHeader::timeDistance, s->getTextColour().withAlpha(0.4f));
+    this->setPaletteColour(ColourIDs::RollHeader::selection, s->getLassoBorderColour().withAlpha(0.8f));
+    this->setPaletteColour(ColourIDs::RollHeader::soundProbe, s->getLassoBorderColour().withMultipliedBrightness(1.1f).withAlpha(0.75f));
+    this->setPaletteColour(ColourIDs::RollHeader::timeDistance, s->getTextColour().withAlpha(0.4f));
 
     // A hack for icon base colors
-    this->setColour(ColourIDs::Icons::fill, s->getIconBaseColour());
-    this->setColour(ColourIDs::Icons::shadow, s->getIconShadowColour());
+    this->setPaletteColour(ColourIDs::Icons::fill, s->getIconBaseColour());
+    this->setPaletteColour(ColourIDs::Icons::shadow, s->getIconShadowColour());
 
     // Panels
-    this->setColour(ColourIDs::BackgroundA::fill, s->getPrimaryGradientColourA());
-    this->setColour(ColourIDs::BackgroundB::fill, s->getPrimaryGradientColourA().darker(0.025f));
-    this->setColour(ColourIDs::BackgroundC::fill, s->getSecondaryGradientColourA());
+    this->setPaletteColour(ColourIDs::BackgroundA::fill, s->getPrimaryGradientColourA());
+    this->setPaletteColour(ColourIDs::BackgroundB::fill, s->getPrimaryGradientColourA().darker(0.025f));
+    this->setPaletteColour(ColourIDs::BackgroundC::fill, s->getSecondaryGradientColourA());
 
-    this->setColour(ColourIDs::Panel::fill, s->getPanelFillColour());
-    this->setColour(ColourIDs::Panel::border, s->getPanelBorderColour().withAlpha(0.225f));
+    this->setPaletteColour(ColourIDs::Panel::fill, s->getPanelFillColour());
+    this->setPaletteColour(ColourIDs::Panel::border, s->getPanelBorderColour().withAlpha(0.225f));
 
-    this->setColour(ColourIDs::TrackScroller::borderLineDark, s->getPrimaryGradientColourA().darker(0.4f));
-    this->setColour(ColourIDs::TrackScroller::borderLineLight, Colours::white.withAlpha(0.055f));
-    this->setColour(ColourIDs::TrackScroller::screenRangeFill, s->getIconBaseColour().withMultipliedAlpha(0.55f));
-    this->setColour(ColourIDs::TrackScroller::scrollerFill, s->getIconBaseColour().withMultipliedAlpha(0.55f));
+    this->setPaletteColour(ColourIDs::TrackScroller::borderLineDark, s->getPrimaryGradientColourA().darker(0.4f));
+    this->setPaletteColour(ColourIDs::TrackScroller::borderLineLight, Colours::white.withAlpha(0.055f));
+    this->setPaletteColour(ColourIDs::TrackScroller::screenRangeFill, s->getIconBaseColour().withMultipliedAlpha(0.55f));
+    this->setPaletteColour(ColourIDs::TrackScroller::scrollerFill, s->getIconBaseColour().withMultipliedAlpha(0.55f));
 
     // InstrumentEditor
-    this->setColour(ColourIDs::Instrument::midiIn, Colours::white.withAlpha(0.1f));
-    this->setColour(ColourIDs::Instrument::midiOut, Colours::white.withAlpha(0.1f));
-    this->setColour(ColourIDs::Instrument::audioIn, Colours::white.withAlpha(0.15f));
-    this->setColour(ColourIDs::Instrument::audioOut, Colours::white.withAlpha(0.15f));
-    this->setColour(ColourIDs::Instrument::midiConnector, Colours::black.withAlpha(0.35f));
-    this->setColour(ColourIDs::Instrument::audioConnector, Colours::white.withAlpha(0.25f));
-    this->setColour(ColourIDs::Instrument::shadowPin, Colours::black.withAlpha(0.1f));
-    this->setColour(ColourIDs::Instrument::shadowConnector, Colours::black.withAlpha(0.2f));
+    this->setPaletteColour(ColourIDs::Instrument::midiIn, Colours::white.withAlpha(0.1f));
+    this->setPaletteColour(ColourIDs::Instrument::midiOut, Colours::white.withAlpha(0.1f));
+    this->setPaletteColour(ColourIDs::Instrument::audioIn, Colours::white.withAlpha(0.15f));
+    this->setPaletteColour(ColourIDs::Instrument::audioOut, Colours::white.withAlpha(0.15f));
+    this->setPaletteColour(ColourIDs::Instrument::midiConnector, Colours::black.withAlpha(0.35f));
+    this->setPaletteColour(ColourIDs::Instrument::audioConnector, Colours::white.withAlpha(0.25f));
+    this->setPaletteColour(ColourIDs::Instrument::shadowPin, Colours::black.withAlpha(0.1f));
+    this->setPaletteColour(ColourIDs::Instrument::shadowConnector, Colours::black.withAlpha(0.2f));
 
     // Borders
-    this->setColour(ColourIDs::Common::borderLineLight, Colours::white.withAlpha(0.065f));
-    this->setColour(ColourIDs::Common::borderLineDark, Colours::black.withAlpha(0.3f));
-    this->setColour(ColourIDs::ColourButton::outline, s->getTextColour());
+    this->setPaletteColour(ColourIDs::Common::borderLineLight, Colours::white.withAlpha(0.065f));
+    this->setPaletteColour(ColourIDs::Common::borderLineDark, Colours::black.withAlpha(0.3f));
+    this->setPaletteColour(ColourIDs::ColourButton::outline, s->getTextColour());
 
     // CallOutBox
-    this->setColour(ColourIDs::Callout::fill, s->getPrimaryGradientColourB().darker(0.025f));
-    this->setColour(ColourIDs::Callout::frame, s->getPrimaryGradientColourB().darker(0.25f));
+    this->setPaletteColour(ColourIDs::Callout::fill, s->getPrimaryGradientColourB().darker(0.025f));
+    this->setPaletteColour(ColourIDs::Callout::frame, s->getPrimaryGradientColourB().darker(0.25f));
 
     // Rolls
-    this->setColour(ColourIDs::Roll::blackKey, s->getBlackKeyColour().withMultipliedBrightness(0.95f));
-    this->setColour(ColourIDs::Roll::blackKeyAlt, s->getBlackKeyColour());
-    this->setColour(ColourIDs::Roll::whiteKey, s->getWhiteKeyColour());
-    this->setColour(ColourIDs::Roll::whiteKeyAlt, s->getWhiteKeyColour().withMultipliedBrightness(1.05f));
-    this->setColour(ColourIDs::Roll::rowLine, s->getRowColour());
-    this->setColour(ColourIDs::Roll::barLine, s->getBarColour().withAlpha(0.8f));
-    this->setColour(ColourIDs::Roll::barLineBevel, Colours::white.withAlpha(0.015f));
-    this->setColour(ColourIDs::Roll::beatLine, s->getBarColour().withAlpha(0.4f));
-    this->setColour(ColourIDs::Roll::snapLine, s->getBarColour().withAlpha(0.1f));
+    this->setPaletteColour(ColourIDs::Roll::blackKey, s->getBlackKeyColour().withMultipliedBrightness(0.95f));
+    this->setPaletteColour(ColourIDs::Roll::blackKeyAlt, s->getBlackKeyColour());
+    this->setPaletteColour(ColourIDs::Roll::whiteKey, s->getWhiteKeyColour());
+    this->setPaletteColour(ColourIDs::Roll::whiteKeyAlt, s->getWhiteKeyColour().withMultipliedBrightness(1.05f));
+    this->setPaletteColour(ColourIDs::Roll::rowLine, s->getRowColour());
+    this->setPaletteColour(ColourIDs::Roll::barLine, s->getBarColour().withAlpha(0.8f));
+    this->setPaletteColour(ColourIDs::Roll::barLineBevel, Colours::white.withAlpha(0.015f));
+    this->setPaletteColour(ColourIDs::Roll::beatLine, s->getBarColour().withAlpha(0.4f));
+    this->setPaletteColour(ColourIDs::Roll::snapLine, s->getBarColour().withAlpha(0.1f));
 
     const auto headerFill = s->getPrimaryGradientColourB().darker(0.025f);
-    this->setColour(ColourIDs::Roll::headerFill, headerFill);
-    this->setColour(ColourIDs::Roll::headerSnaps, headerFill.contrasting().interpolatedWith(headerFill, 0.63f));
-    this->setColour(ColourIDs::Roll::headerRecording, headerFill.interpolatedWith(Colours::red, 0.55f));
-
-    this->setColour(ColourIDs::Roll::playheadShade, Colours::black.withAlpha(0.1f));
-    this->setColour(ColourIDs::Roll::playheadPlayback, s->getLassoBorderColour().withAlpha(0.75f));
-    this->setColour(ColourIDs::Roll::playheadRecording, s->getLassoBorderColour().interpolatedWith(Colours::red, 0.75f).withAlpha(0.55f));
-    this->setColour(ColourIDs::Roll::trackHeaderFill, s->getWhiteKeyColour());
-    this->setColour(ColourIDs::Roll::trackHeaderBorder, Colours::white.withAlpha(0.08f));
-
-    this->setColour(ColourIDs::Roll::noteFill, s->getTextColour().interpolatedWith(Colours::white, 0.5f));
-    this->setColour(ColourIDs::Roll::noteNameFill, s->getBlackKeyColour().darker(0.4f).withAlpha(0.95f));
-    this->setColour(ColourIDs::Roll::noteNameBorder, s->getTextColour().withAlpha(0.4f));
-    this->setColour(ColourIDs::Roll::noteNameShadow, s->getTextColour().withAlpha(0.25f));
-
-    this->setColour(ColourIDs::TransportControl::recordInactive, Colours::transparentBlack);
-    this->setColour(ColourIDs::TransportControl::recordHighlight, Colours::red.withAlpha(0.35f));
-    this->setColour(ColourIDs::TransportControl::recordActive, s->getPrimaryGradientColourB().darker(0.05f).interpolatedWith(Colours::red, 0.5f));
-    this->setColour(ColourIDs::TransportControl::playInactive, Colours::white.withAlpha(0.035f));
-    this->setColour(ColourIDs::TransportControl::playHighlight, Colours::white.withAlpha(0.075f));
-    this->setColour(ColourIDs::TransportControl::playActive, Colours::white.withAlpha(0.1f));
-
-    this->setColour(ColourIDs::HelperRectangle::fill, s->getLassoFillColour().withAlpha(0.08f));
-    this->setColour(ColourIDs::HelperRectangle::outline, s->getLassoBorderColour().withAlpha(0.3f));
-
-    this->setColour(ColourIDs::Logo::fill, s->getTextColour().withMultipliedAlpha(0.25f));
-    this->setColour(ColourIDs::AudioMonitor::foreground, s->getTextColour());
-
-    this->setColour(ColourIDs::VersionControl::connector, s->getTextColour().withAlpha(0.2f));
-    this->setColour(ColourIDs::VersionControl::outline, s->getTextColour().withAlpha(0.3f));
-    this->setColour(ColourIDs::VersionControl::highlight, s->getTextColour().withAlpha(0.02f));
+    this->setPaletteColour(ColourIDs::Roll::headerFill, headerFill);
+    this->setPaletteColour(ColourIDs::Roll::headerSnaps, headerFill.contrasting().interpolatedWith(headerFill, 0.63f));
+    this->setPaletteColour(ColourIDs::Roll::headerRecording, headerFill.interpolatedWith(Colours::red, 0.55f));
+
+    this->setPaletteColour(ColourIDs::Roll::playheadShade, Colours::black.withAlpha(0.1f));
+    this->setPaletteColour(ColourIDs::Roll::playheadPlayback, s->getLassoBorderColour().withAlpha(0.75f));
+    this->setPaletteColour(ColourIDs::Roll::playheadRecording, s->getLassoBorderColour().interpolatedWith(Colours::red, 0.75f).withAlpha(0.55f));
+    this->setPaletteColour(ColourIDs::Roll::trackHeaderFill, s->getWhiteKeyColour());
+    this->setPaletteColour(ColourIDs::Roll::trackHeaderBorder, Colours::white.withAlpha(0.08f));
+
+    this->setPaletteColour(ColourIDs::Roll::noteFill, s->getTextColour().interpolatedWith(Colours::white, 0.5f));
+    this->setPaletteColour(ColourIDs::Roll::noteNameFill, s->getBlackKeyColour().darker(0.4f).withAlpha(0.95f));
+    this->setPaletteColour(ColourIDs::Roll::noteNameBorder, s->getTextColour().withAlpha(0.4f));
+    this->setPaletteColour(ColourIDs::Roll::noteNameShadow, s->getTextColour().withAlpha(0.25f));
+
+    this->setPaletteColour(ColourIDs::TransportControl::recordInactive, Colours::transparentBlack);
+    this->setPaletteColour(ColourIDs::TransportControl::recordHighlight, Colours::red.withAlpha(0.35f));
+    this->setPaletteColour(ColourIDs::TransportControl::recordActive, s->getPrimaryGradientColourB().darker(0.05f).interpolatedWith(Colours::red, 0.5f));
+    this->setPaletteColour(ColourIDs::TransportControl::playInactive, Colours::white.withAlpha(0.035f));
+    this->setPaletteColour(ColourIDs::TransportControl::playHighlight, Colours::white.withAlpha(0.075f));
+    this->setPaletteColour(ColourIDs::TransportControl::playActive, Colours::white.withAlpha(0.1f));
+
+    this->setPaletteColour(ColourIDs::HelperRectangle::fill, s->getLassoFillColour().withAlpha(0.08f));
+    this->setPaletteColour(ColourIDs::HelperRectangle::outline, s->getLassoBorderColour().withAlpha(0.3f));
+
+    this->setPaletteColour(ColourIDs::Logo::fill, s->getTextColour().withMultipliedAlpha(0.25f));
+    this->setPaletteColour(ColourIDs::AudioMonitor::foreground, s->getTextColour());
+
+    this->setPaletteColour(ColourIDs::VersionControl::connector, s->getTextColour().withAlpha(0.2f));
+    this->setPaletteColour(ColourIDs::VersionControl::outline, s->getTextColour().withAlpha(0.3f));
+    this->setPaletteColour(ColourIDs::VersionControl::highlight, s->getTextColour().withAlpha(0.02f));
 
     // bright text probably means dark theme:
     this->isDarkTheme = s->getTextColour().getPerceivedBrightness() > 0.5f;
@@ -872,10 +894,18 @@ void HelioTheme::initColours(const ::ColourScheme::Ptr s)
     this->bgCacheA = {};
     this->bgCacheB = {};
     this->bgCacheC = {};
+    this->shadowsCache.clear();
 
     PanelBackgroundA::redrawBgCache(*this);
     PanelBackgroundB::redrawBgCache(*this);
     PanelBackgroundC::redrawBgCache(*this);
 
-    Icons::clearPrerenderedCache();
+    // the icons are rendered with the default theme's colours, so the
+    // other theme instances, like the previews, should not reset them
+    auto *defaultTheme = dynamic_cast<HelioTheme *>(&LookAndFeel::getDefaultLookAndFeel());
+    if (defaultTheme == nullptr || defaultTheme == this)
+    {
+        Icons::clearPrerenderedCache();
+        Icons::prerenderCommonIcons();
+    }
 }
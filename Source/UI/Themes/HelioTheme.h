@@ -139,11 +139,30 @@ public:
     inline Image &getBgCacheC() noexcept { return this->bgCacheC; }
     inline const Image &getBgCacheC() const noexcept { return this->bgCacheC; }
 
+    // the shadow components of the same kind and size share their images
+    inline Image &getShadowCache(uint64 key) { return this->shadowsCache[key]; }
+
     inline bool isDark() const noexcept
     {
         return this->isDarkTheme;
     }
 
+    // The app's own colours are also kept in a flat array indexed by their
+    // ids, which is filled in initColours, so that findDefaultColour, called
+    // in lots of paint methods, doesn't search the look-and-feel's colours;
+    // the rest of the ids are still looked up by findColour
+    inline Colour findPaletteColour(int colourId) const noexcept
+    {
+        const auto index = colourId - HelioTheme::paletteFirstId;
+        if (isPositiveAndBelow(index, HelioTheme::paletteSize) &&
+            this->palette[index].isSpecified)
+        {
+            return this->palette[index].colour;
+        }
+
+        return this->findColour(colourId);
+    }
+
 protected:
     
     const Image backgroundNoise;
@@ -156,8 +175,23 @@ protected:
     Image bgCacheB;
     Image bgCacheC;
 
+    FlatHashMap<uint64, Image> shadowsCache;
+
     bool isDarkTheme = false;
 
+    // see ColourIDs.h, all of them are in this range
+    static constexpr auto paletteFirstId = 0x2000000;
+    static constexpr auto paletteSize = 0x2000;
+
+    struct PaletteColour final
+    {
+        Colour colour;
+        bool isSpecified = false;
+    };
+
+    HeapBlock<PaletteColour> palette { HelioTheme::paletteSize, true };
+    void setPaletteColour(int colourId, Colour colour);
+
     JUCE_LEAK_DETECTOR(HelioTheme);
 
 };
@@ -253,9 +253,58 @@ Path Icons::getPathByName(Icons::Id id)
 
 static FlatHashMap<uint32, Image> prerenderedSVGs;
 
+// the icons rendered with the colours of other themes, e.g. for the previews
+struct ThemedIconKey final
+{
+    Icons::Id id;
+    int size;
+    uint32 baseColour;
+    uint32 shadeColour;
+
+    bool operator== (const ThemedIconKey &other) const noexcept
+    {
+        return this->id == other.id && this->size == other.size &&
+            this->baseColour == other.baseColour && this->shadeColour == other.shadeColour;
+    }
+};
+
+struct ThemedIconKeyHash final
+{
+    size_t operator()(const ThemedIconKey &key) const noexcept
+    {
+        return (size_t(key.id) * 1000 + size_t(key.size)) ^
+            (size_t(key.baseColour) * 31) ^ (size_t(key.shadeColour) * 17);
+    }
+};
+
+static FlatHashMap<ThemedIconKey, Image, ThemedIconKeyHash> prerenderedThemedSVGs;
+
 void Icons::clearPrerenderedCache()
 {
     prerenderedSVGs.clear();
+    prerenderedThemedSVGs.clear();
+}
+
+// renders all icons of the size used in the menus and the tree panels
+// in advance, so that opening the first big menu doesn't stall; this is
+// deferred, so that several theme updates in a row only render them once
+void Icons::prerenderCommonIcons()
+{
+    static bool isPending = false;
+    if (isPending)
+    {
+        return;
+    }
+
+    isPending = true;
+    MessageManager::callAsync([]()
+    {
+        isPending = false;
+        for (const auto &it : builtInImages)
+        {
+            Icons::findByName(it.first, Globals::UI::headlineIconSize);
+        }
+    });
 }
 
 static float getScaleFactor()
@@ -292,7 +341,17 @@ Image Icons::renderForTheme(const LookAndFeel &lf, Icons::Id id, int maxSize)
 
     const Colour iconBaseColour(lf.findColour(ColourIDs::Icons::fill));
     const Colour iconShadeColour(lf.findColour(ColourIDs::Icons::shadow));
+
+    const ThemedIconKey iconKey{ id, fixedSize, iconBaseColour.getARGB(), iconShadeColour.getARGB() };
+    const auto found = prerenderedThemedSVGs.find(iconKey);
+    if (found != prerenderedThemedSVGs.end())
+    {
+        return found->second;
+    }
+
     const Image prerenderedImage(renderVector(id, fixedSize, iconBaseColour, iconShadeColour));
+    prerenderedThemedSVGs[iconKey] = prerenderedImage;
+
     return prerenderedImage;
 }
 
@@ -26,6 +26,7 @@ public:
     static void initBuiltInImages();
     static void clearBuiltInImages();
     static void clearPrerenderedCache();
+    static void prerenderCommonIcons();
 
     static Image findByName(Icons::Id id, int maxSize);
     static Image renderForTheme(const LookAndFeel &lf, Icons::Id id, int maxSize);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "ColourIDs.h"
+#include "HelioTheme.h"
 
 enum class ShadowType : int8
 {
@@ -64,6 +65,32 @@ public:
 
 protected:
 
+    enum class Direction : uint8
+    {
+        Downwards,
+        Upwards,
+        Leftwards,
+        Rightwards
+    };
+
+    // all shadows of the same direction, colour and depth share one image,
+    // kept by the theme, so that the resizes and the page switches
+    // don't keep rendering the new ones
+    template <typename RenderFn>
+    Image getSharedImage(Direction direction, int depth, RenderFn render) const
+    {
+        const auto key = (uint64(direction) << 56) |
+            (uint64(this->shadowColour.getARGB()) << 24) | uint64(depth & 0xffffff);
+
+        auto &sharedImage = HelioTheme::getCurrentTheme().getShadowCache(key);
+        if (!sharedImage.isValid())
+        {
+            sharedImage = render();
+        }
+
+        return sharedImage;
+    }
+
     static constexpr auto cachedImageSize = 32;
     // a way to fix OpenGL non-pow-of-2 texture artifacts
     static constexpr auto cachedImageMargin = 4;
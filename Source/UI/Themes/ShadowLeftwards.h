@@ -27,22 +27,27 @@ public:
 
     void resized()
     {
-        if (this->cachedImage.getWidth() != this->getWidth())
+        const int depth = this->getWidth();
+        if (this->cachedImage.getWidth() != depth + ShadowComponent::cachedImageMargin)
         {
-            const float w = float(this->getWidth());
-            this->cachedImage = Image(Image::ARGB,
-                this->getWidth() + ShadowComponent::cachedImageMargin,
-                ShadowComponent::cachedImageSize, true);
+            this->cachedImage = this->getSharedImage(Direction::Leftwards, depth, [this, depth]()
+            {
+                const float w = float(depth);
+                Image image(Image::ARGB, depth + ShadowComponent::cachedImageMargin,
+                    ShadowComponent::cachedImageSize, true);
 
-            Graphics g(this->cachedImage);
+                Graphics g(image);
 
-            g.setGradientFill(ColourGradient(this->shadowColour,
-                w, 0.f, Colours::transparentBlack, 0.f, 0.f, false));
-            g.fillRect(this->cachedImage.getBounds());
+                g.setGradientFill(ColourGradient(this->shadowColour,
+                    w, 0.f, Colours::transparentBlack, 0.f, 0.f, false));
+                g.fillRect(image.getBounds());
 
-            g.setGradientFill(ColourGradient(this->shadowColour,
-                w, 0.f, Colours::transparentBlack, w / 2.5f, 0.f, false));
-            g.fillRect(this->cachedImage.getBounds());
+                g.setGradientFill(ColourGradient(this->shadowColour,
+                    w, 0.f, Colours::transparentBlack, w / 2.5f, 0.f, false));
+                g.fillRect(image.getBounds());
+
+                return image;
+            });
         }
     }
 
@@ -36,21 +36,27 @@ public:
 
     void resized()
     {
-        if (this->cachedImage.getWidth() != this->getWidth())
+        const int depth = this->getWidth();
+        if (this->cachedImage.getWidth() != depth + ShadowComponent::cachedImageMargin)
         {
-            this->cachedImage = Image(Image::ARGB,
-                this->getWidth() + ShadowComponent::cachedImageMargin,
-                ShadowComponent::cachedImageSize, true);
+            this->cachedImage = this->getSharedImage(Direction::Rightwards, depth, [this, depth]()
+            {
+                const float w = float(depth);
+                Image image(Image::ARGB, depth + ShadowComponent::cachedImageMargin,
+                    ShadowComponent::cachedImageSize, true);
 
-            Graphics g(this->cachedImage);
+                Graphics g(image);
 
-            g.setGradientFill(ColourGradient(this->shadowColour,
-                0.f, 0.f, Colours::transparentBlack, float(this->getWidth()), 0.f, false));
-            g.fillRect(this->cachedImage.getBounds());
+                g.setGradientFill(ColourGradient(this->shadowColour,
+                    0.f, 0.f, Colours::transparentBlack, w, 0.f, false));
+                g.fillRect(image.getBounds());
 
-            g.setGradientFill(ColourGradient(this->shadowColour,
-                0.f, 0.f, Colours::transparentBlack, float(this->getWidth()) / 2.5f, 0.f, false));
-            g.fillRect(this->cachedImage.getBounds());
+                g.setGradientFill(ColourGradient(this->shadowColour,
+                    0.f, 0.f, Colours::transparentBlack, w / 2.5f, 0.f, false));
+                g.fillRect(image.getBounds());
+
+                return image;
+            });
         }
     }
 
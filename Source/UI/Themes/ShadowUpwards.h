@@ -33,21 +33,27 @@ public:
 
     void resized() override
     {
-        if (this->cachedImage.getHeight() != this->getHeight())
+        const int depth = this->getHeight();
+        if (this->cachedImage.getHeight() != depth + ShadowComponent::cachedImageMargin)
         {
-            const float h = float(this->getHeight());
-            this->cachedImage = Image(Image::ARGB, ShadowComponent::cachedImageSize,
-                this->getHeight() + ShadowComponent::cachedImageMargin, true);
+            this->cachedImage = this->getSharedImage(Direction::Upwards, depth, [this, depth]()
+            {
+                const float h = float(depth);
+                Image image(Image::ARGB, ShadowComponent::cachedImageSize,
+                    depth + ShadowComponent::cachedImageMargin, true);
 
-            Graphics g(this->cachedImage);
+                Graphics g(image);
 
-            g.setGradientFill(ColourGradient(this->shadowColour,
-                0.f, h, Colours::transparentBlack, 0.f, 0.f, false));
-            g.fillRect(this->cachedImage.getBounds());
+                g.setGradientFill(ColourGradient(this->shadowColour,
+                    0.f, h, Colours::transparentBlack, 0.f, 0.f, false));
+                g.fillRect(image.getBounds());
 
-            g.setGradientFill(ColourGradient(this->shadowColour,
-                0.f, h, Colours::transparentBlack, 0.f, h / 2.5f, false));
-            g.fillRect(this->cachedImage.getBounds());
+                g.setGradientFill(ColourGradient(this->shadowColour,
+                    0.f, h, Colours::transparentBlack, 0.f, h / 2.5f, false));
+                g.fillRect(image.getBounds());
+
+                return image;
+            });
         }
     }
 